@@ -0,0 +1,763 @@
+/**
+ * Auto-generated Google Benchmark suite
+ * Measures ns/message, bytes/sec and heap allocations per operation for every model.
+ *
+ * JSON results for comparing generator versions:
+ *   cmake --build <build-dir> --target bench_json
+ */
+
+#include "protocol.hpp"
+#include "dynamic_codec.hpp"
+
+#include <benchmark/benchmark.h>
+
+#include <atomic>
+#include <cmath>
+#include <cstdlib>
+#include <new>
+#include <vector>
+
+using namespace binaryprotocol;
+
+// Counts every heap allocation so benchmarks can report allocs/op
+namespace {
+std::atomic<uint64_t> g_allocations{0};
+} // namespace
+
+void* operator new(std::size_t size) {
+    g_allocations.fetch_add(1, std::memory_order_relaxed);
+    if (void* memory = std::malloc(size == 0 ? 1 : size)) {
+        return memory;
+    }
+    throw std::bad_alloc();
+}
+
+// Kept out of line so GCC does not pair the inlined free() with operator new
+// and raise a spurious -Wmismatched-new-delete
+[[gnu::noinline]] void operator delete(void* memory) noexcept { std::free(memory); }
+[[gnu::noinline]] void operator delete(void* memory, std::size_t) noexcept { std::free(memory); }
+
+namespace {
+
+/// Reports the heap allocations made while the benchmark loop ran
+class AllocationCounter {
+public:
+    explicit AllocationCounter(benchmark::State& state)
+        : state_(state), start_(g_allocations.load(std::memory_order_relaxed)) {}
+
+    ~AllocationCounter() {
+        const double allocations = static_cast<double>(g_allocations.load(std::memory_order_relaxed) - start_);
+        state_.counters["allocs/op"] = benchmark::Counter(allocations, benchmark::Counter::kAvgIterations);
+    }
+
+private:
+    benchmark::State& state_;
+    uint64_t start_;
+};
+
+template<typename T>
+struct BenchTraits;
+
+template<typename T>
+void setThroughput(benchmark::State& state, const T& sample) {
+    state.SetItemsProcessed(state.iterations());
+    state.SetBytesProcessed(state.iterations() * static_cast<int64_t>(encodedSize(sample)));
+}
+
+/// serialize(): allocates a fresh vector per message
+template<typename T>
+void BM_Serialize(benchmark::State& state) {
+    const T sample = BenchTraits<T>::make(state);
+    {
+        AllocationCounter allocations(state);
+        for (auto _ : state) {
+            std::vector<uint8_t> bytes = serialize(sample);
+            benchmark::DoNotOptimize(bytes.data());
+        }
+    }
+    setThroughput(state, sample);
+}
+
+/// serializeInto(): caller-provided buffer
+template<typename T>
+void BM_SerializeInto(benchmark::State& state) {
+    const T sample = BenchTraits<T>::make(state);
+    std::vector<uint8_t> buffer(encodedSize(sample));
+    {
+        AllocationCounter allocations(state);
+        for (auto _ : state) {
+            benchmark::DoNotOptimize(serializeInto(sample, buffer));
+            benchmark::ClobberMemory();
+        }
+    }
+    setThroughput(state, sample);
+}
+
+/// serialize(message, writer): one long-lived writer cleared per message
+template<typename T>
+void BM_SerializeWriter(benchmark::State& state) {
+    const T sample = BenchTraits<T>::make(state);
+    BinaryWriter writer;
+    writer.reserve(encodedSize(sample));
+    {
+        AllocationCounter allocations(state);
+        for (auto _ : state) {
+            writer.clear();
+            benchmark::DoNotOptimize(serialize(sample, writer));
+            benchmark::ClobberMemory();
+        }
+    }
+    setThroughput(state, sample);
+}
+
+/// serializeGather(): fixed fields inline, variable-length fields referenced in place
+template<typename T>
+void BM_SerializeGather(benchmark::State& state) {
+    const T sample = BenchTraits<T>::make(state);
+    GatherList list;
+    {
+        AllocationCounter allocations(state);
+        for (auto _ : state) {
+            list.clear();
+            serializeGather(sample, list);
+            benchmark::DoNotOptimize(list.segments().data());
+            benchmark::ClobberMemory();
+        }
+    }
+    setThroughput(state, sample);
+}
+
+template<typename T>
+void BM_Deserialize(benchmark::State& state) {
+    const T sample = BenchTraits<T>::make(state);
+    const std::vector<uint8_t> bytes = serialize(sample);
+    {
+        AllocationCounter allocations(state);
+        for (auto _ : state) {
+            T result = BenchTraits<T>::decode(bytes.data(), bytes.size());
+            benchmark::DoNotOptimize(result);
+        }
+    }
+    setThroughput(state, sample);
+}
+
+/// Zero-copy view decode of variable-length models
+template<typename T>
+void BM_View(benchmark::State& state) {
+    const T sample = BenchTraits<T>::make(state);
+    const std::vector<uint8_t> bytes = serialize(sample);
+    {
+        AllocationCounter allocations(state);
+        for (auto _ : state) {
+            auto result = BenchTraits<T>::view(bytes.data(), bytes.size());
+            benchmark::DoNotOptimize(result);
+        }
+    }
+    setThroughput(state, sample);
+}
+
+/// The table-driven codec on the built-in descriptor; compare with BM_SerializeInto and BM_Deserialize
+const dynamic::Schema& builtinSchema() {
+    static const dynamic::Schema schema = dynamic::Schema::load(dynamic::builtinSchemaDescriptor());
+    return schema;
+}
+
+template<typename T>
+void BM_DynamicEncode(benchmark::State& state) {
+    const T sample = BenchTraits<T>::make(state);
+    const std::vector<uint8_t> bytes = serialize(sample);
+    const dynamic::Model& model = *builtinSchema().model(BenchTraits<T>::NAME);
+    dynamic::Record record;
+    if (model.decodeInto(bytes, record)) {
+        state.SkipWithError("sample does not decode");
+        return;
+    }
+    std::vector<uint8_t> buffer(bytes.size());
+    {
+        AllocationCounter allocations(state);
+        for (auto _ : state) {
+            benchmark::DoNotOptimize(model.encodeInto(record, buffer));
+            benchmark::ClobberMemory();
+        }
+    }
+    setThroughput(state, sample);
+}
+
+/// Decodes into one reused Record, so only the first iteration allocates
+template<typename T>
+void BM_DynamicDecode(benchmark::State& state) {
+    const T sample = BenchTraits<T>::make(state);
+    const std::vector<uint8_t> bytes = serialize(sample);
+    const dynamic::Model& model = *builtinSchema().model(BenchTraits<T>::NAME);
+    dynamic::Record record(model);
+    {
+        AllocationCounter allocations(state);
+        for (auto _ : state) {
+            benchmark::DoNotOptimize(model.decodeInto(bytes, record));
+            benchmark::ClobberMemory();
+        }
+    }
+    setThroughput(state, sample);
+}
+
+template<>
+struct BenchTraits<ProtocolHeader> {
+    static constexpr Endian ENDIAN = Endian::Little;
+    static constexpr const char* NAME = "ProtocolHeader";
+
+    static ProtocolHeader make([[maybe_unused]] const benchmark::State& state) {
+        ProtocolHeader sample{};
+        sample.magic = 11;
+        sample.version = 48;
+        sample.command_id = 85;
+        sample.payload_length = 22;
+        sample.sequence_id = 59;
+        sample.checksum = 96;
+        return sample;
+    }
+
+    static ProtocolHeader decode(const uint8_t* data, size_t size) { return deserializeProtocolHeader(data, size); }
+};
+
+template<>
+struct BenchTraits<PingCommand> {
+    static constexpr Endian ENDIAN = Endian::Little;
+    static constexpr const char* NAME = "PingCommand";
+
+    static PingCommand make([[maybe_unused]] const benchmark::State& state) {
+        PingCommand sample{};
+        sample.timestamp = 1700000000000;
+        return sample;
+    }
+
+    static PingCommand decode(const uint8_t* data, size_t size) { return deserializePingCommand(data, size); }
+};
+
+template<>
+struct BenchTraits<PingResponse> {
+    static constexpr Endian ENDIAN = Endian::Little;
+    static constexpr const char* NAME = "PingResponse";
+
+    static PingResponse make([[maybe_unused]] const benchmark::State& state) {
+        PingResponse sample{};
+        sample.request_timestamp = 1700000000000;
+        sample.response_timestamp = 1700000000001;
+        return sample;
+    }
+
+    static PingResponse decode(const uint8_t* data, size_t size) { return deserializePingResponse(data, size); }
+};
+
+template<>
+struct BenchTraits<GetDeviceInfoCommand> {
+    static constexpr Endian ENDIAN = Endian::Little;
+    static constexpr const char* NAME = "GetDeviceInfoCommand";
+
+    static GetDeviceInfoCommand make([[maybe_unused]] const benchmark::State& state) {
+        GetDeviceInfoCommand sample{};
+        sample.include_details = true;
+        return sample;
+    }
+
+    static GetDeviceInfoCommand decode(const uint8_t* data, size_t size) { return deserializeGetDeviceInfoCommand(data, size); }
+};
+
+template<>
+struct BenchTraits<DeviceInfoResponse> {
+    static constexpr Endian ENDIAN = Endian::Little;
+    static constexpr const char* NAME = "DeviceInfoResponse";
+
+    static DeviceInfoResponse make([[maybe_unused]] const benchmark::State& state) {
+        DeviceInfoResponse sample{};
+        sample.status = static_cast<DeviceStatus>(1);
+        sample.device_name.fill('a');
+        sample.firmware_version.fill('a');
+        sample.uptime_seconds = 22;
+        sample.temperature = 59;
+        sample.battery_level = 96;
+        return sample;
+    }
+
+    static DeviceInfoResponse decode(const uint8_t* data, size_t size) { return deserializeDeviceInfoResponse(data, size); }
+};
+
+template<>
+struct BenchTraits<SendDataCommand> {
+    static constexpr Endian ENDIAN = Endian::Little;
+    static constexpr const char* NAME = "SendDataCommand";
+
+    static SendDataCommand make([[maybe_unused]] const benchmark::State& state) {
+        const size_t n = static_cast<size_t>(state.range(0));
+        SendDataCommand sample{};
+        sample.channel = 11;
+        sample.priority = 48;
+        sample.data.assign(n, 0x5A);
+        return sample;
+    }
+
+    static SendDataCommand decode(const uint8_t* data, size_t size) { return deserializeSendDataCommand(data, size); }
+    static SendDataCommandView view(const uint8_t* data, size_t size) { return viewSendDataCommand(data, size); }
+};
+
+template<>
+struct BenchTraits<SendDataResponse> {
+    static constexpr Endian ENDIAN = Endian::Little;
+    static constexpr const char* NAME = "SendDataResponse";
+
+    static SendDataResponse make([[maybe_unused]] const benchmark::State& state) {
+        SendDataResponse sample{};
+        sample.success = true;
+        sample.error_code = static_cast<ErrorCode>(1);
+        sample.bytes_written = 85;
+        return sample;
+    }
+
+    static SendDataResponse decode(const uint8_t* data, size_t size) { return deserializeSendDataResponse(data, size); }
+};
+
+template<>
+struct BenchTraits<SetConfigCommand> {
+    static constexpr Endian ENDIAN = Endian::Little;
+    static constexpr const char* NAME = "SetConfigCommand";
+
+    static SetConfigCommand make([[maybe_unused]] const benchmark::State& state) {
+        const size_t n = static_cast<size_t>(state.range(0));
+        SetConfigCommand sample{};
+        sample.config_id = 11;
+        sample.value_type = 48;
+        sample.value.assign(n, 0x5A);
+        return sample;
+    }
+
+    static SetConfigCommand decode(const uint8_t* data, size_t size) { return deserializeSetConfigCommand(data, size); }
+    static SetConfigCommandView view(const uint8_t* data, size_t size) { return viewSetConfigCommand(data, size); }
+};
+
+template<>
+struct BenchTraits<SetConfigResponse> {
+    static constexpr Endian ENDIAN = Endian::Little;
+    static constexpr const char* NAME = "SetConfigResponse";
+
+    static SetConfigResponse make([[maybe_unused]] const benchmark::State& state) {
+        SetConfigResponse sample{};
+        sample.success = true;
+        sample.error_code = static_cast<ErrorCode>(1);
+        return sample;
+    }
+
+    static SetConfigResponse decode(const uint8_t* data, size_t size) { return deserializeSetConfigResponse(data, size); }
+};
+
+template<>
+struct BenchTraits<BatchCommand> {
+    static constexpr Endian ENDIAN = Endian::Little;
+    static constexpr const char* NAME = "BatchCommand";
+
+    static BatchCommand make([[maybe_unused]] const benchmark::State& state) {
+        const size_t n = static_cast<size_t>(state.range(0));
+        BatchCommand sample{};
+        sample.command_count = 11;
+        sample.commands.assign(n, 0x5A);
+        return sample;
+    }
+
+    static BatchCommand decode(const uint8_t* data, size_t size) { return deserializeBatchCommand(data, size); }
+    static BatchCommandView view(const uint8_t* data, size_t size) { return viewBatchCommand(data, size); }
+};
+
+template<>
+struct BenchTraits<BatchResponse> {
+    static constexpr Endian ENDIAN = Endian::Little;
+    static constexpr const char* NAME = "BatchResponse";
+
+    static BatchResponse make([[maybe_unused]] const benchmark::State& state) {
+        const size_t n = static_cast<size_t>(state.range(0));
+        BatchResponse sample{};
+        sample.success_count = 11;
+        sample.failure_count = 48;
+        sample.results.assign(n, 0x5A);
+        return sample;
+    }
+
+    static BatchResponse decode(const uint8_t* data, size_t size) { return deserializeBatchResponse(data, size); }
+    static BatchResponseView view(const uint8_t* data, size_t size) { return viewBatchResponse(data, size); }
+};
+
+template<>
+struct BenchTraits<Vector3D> {
+    static constexpr Endian ENDIAN = Endian::Little;
+    static constexpr const char* NAME = "Vector3D";
+
+    static Vector3D make([[maybe_unused]] const benchmark::State& state) {
+        Vector3D sample{};
+        sample.x = 1.25f;
+        sample.y = 2.25f;
+        sample.z = 3.25f;
+        return sample;
+    }
+
+    static Vector3D decode(const uint8_t* data, size_t size) { return deserializeVector3D(data, size); }
+};
+
+template<>
+struct BenchTraits<SensorData> {
+    static constexpr Endian ENDIAN = Endian::Little;
+    static constexpr const char* NAME = "SensorData";
+
+    static SensorData make([[maybe_unused]] const benchmark::State& state) {
+        SensorData sample{};
+        sample.timestamp = 1700000000000;
+        sample.sensor_id = 48;
+        sample.position.x = 1.25f;
+        sample.position.y = 2.25f;
+        sample.position.z = 3.25f;
+        sample.temperature = 4.25f;
+        sample.humidity = 5.25f;
+        return sample;
+    }
+
+    static SensorData decode(const uint8_t* data, size_t size) { return deserializeSensorData(data, size); }
+};
+
+template<>
+struct BenchTraits<SensorDataResponse> {
+    static constexpr Endian ENDIAN = Endian::Little;
+    static constexpr const char* NAME = "SensorDataResponse";
+
+    static SensorDataResponse make([[maybe_unused]] const benchmark::State& state) {
+        const size_t n = static_cast<size_t>(state.range(0));
+        SensorDataResponse sample{};
+        sample.sensor_count = 11;
+        sample.sensors.assign(n, BenchTraits<SensorData>::make(state));
+        return sample;
+    }
+
+    static SensorDataResponse decode(const uint8_t* data, size_t size) { return deserializeSensorDataResponse(data, size); }
+    static SensorDataResponseView view(const uint8_t* data, size_t size) { return viewSensorDataResponse(data, size); }
+};
+
+// Field-by-field reference codec, the baseline for the bulk memcpy path
+
+void referenceEncode(BasicSpanWriter<Endian::Little>& writer, const ProtocolHeader& data) {
+    writer.writeUint16(data.magic);
+    writer.writeUint8(data.version);
+    writer.writeUint8(data.command_id);
+    writer.writeUint32(data.payload_length);
+    writer.writeUint32(data.sequence_id);
+    writer.writeUint16(data.checksum);
+}
+
+void referenceDecode(BasicBinaryReader<Endian::Little>& reader, ProtocolHeader& result) {
+    result.magic = reader.readUint16();
+    result.version = reader.readUint8();
+    result.command_id = reader.readUint8();
+    result.payload_length = reader.readUint32();
+    result.sequence_id = reader.readUint32();
+    result.checksum = reader.readUint16();
+}
+
+void referenceEncode(BasicSpanWriter<Endian::Little>& writer, const PingCommand& data) {
+    writer.writeUint64(data.timestamp);
+}
+
+void referenceDecode(BasicBinaryReader<Endian::Little>& reader, PingCommand& result) {
+    result.timestamp = reader.readUint64();
+}
+
+void referenceEncode(BasicSpanWriter<Endian::Little>& writer, const PingResponse& data) {
+    writer.writeUint64(data.request_timestamp);
+    writer.writeUint64(data.response_timestamp);
+}
+
+void referenceDecode(BasicBinaryReader<Endian::Little>& reader, PingResponse& result) {
+    result.request_timestamp = reader.readUint64();
+    result.response_timestamp = reader.readUint64();
+}
+
+void referenceEncode(BasicSpanWriter<Endian::Little>& writer, const DeviceInfoResponse& data) {
+    writer.writeUint8(static_cast<uint8_t>(data.status));
+    writer.writeFixedString(data.device_name);
+    writer.writeFixedString(data.firmware_version);
+    writer.writeUint32(data.uptime_seconds);
+    writer.writeInt16(data.temperature);
+    writer.writeUint8(data.battery_level);
+}
+
+void referenceDecode(BasicBinaryReader<Endian::Little>& reader, DeviceInfoResponse& result) {
+    result.status = static_cast<DeviceStatus>(reader.readUint8());
+    result.device_name = reader.readFixedString<32>();
+    result.firmware_version = reader.readFixedString<16>();
+    result.uptime_seconds = reader.readUint32();
+    result.temperature = reader.readInt16();
+    result.battery_level = reader.readUint8();
+}
+
+void referenceEncode(BasicSpanWriter<Endian::Little>& writer, const Vector3D& data) {
+    writer.writeFloat32(data.x);
+    writer.writeFloat32(data.y);
+    writer.writeFloat32(data.z);
+}
+
+void referenceDecode(BasicBinaryReader<Endian::Little>& reader, Vector3D& result) {
+    result.x = reader.readFloat32();
+    result.y = reader.readFloat32();
+    result.z = reader.readFloat32();
+}
+
+void referenceEncode(BasicSpanWriter<Endian::Little>& writer, const SensorData& data) {
+    writer.writeUint64(data.timestamp);
+    writer.writeUint8(data.sensor_id);
+    referenceEncode(writer, data.position);
+    writer.writeFloat32(data.temperature);
+    writer.writeFloat32(data.humidity);
+}
+
+void referenceDecode(BasicBinaryReader<Endian::Little>& reader, SensorData& result) {
+    result.timestamp = reader.readUint64();
+    result.sensor_id = reader.readUint8();
+    referenceDecode(reader, result.position);
+    result.temperature = reader.readFloat32();
+    result.humidity = reader.readFloat32();
+}
+
+template<typename T>
+void BM_SerializeFieldwise(benchmark::State& state) {
+    const T sample = BenchTraits<T>::make(state);
+    std::array<uint8_t, T::ENCODED_SIZE> buffer{};
+    for (auto _ : state) {
+        BasicSpanWriter<BenchTraits<T>::ENDIAN> writer(buffer);
+        referenceEncode(writer, sample);
+        benchmark::DoNotOptimize(buffer.data());
+        benchmark::ClobberMemory();
+    }
+    setThroughput(state, sample);
+}
+
+template<typename T>
+void BM_DeserializeFieldwise(benchmark::State& state) {
+    const T sample = BenchTraits<T>::make(state);
+    const std::vector<uint8_t> bytes = serialize(sample);
+    for (auto _ : state) {
+        BasicBinaryReader<BenchTraits<T>::ENDIAN> reader(bytes.data(), bytes.size());
+        T result{};
+        referenceDecode(reader, result);
+        benchmark::DoNotOptimize(result);
+    }
+    setThroughput(state, sample);
+}
+
+/// Correlated time series for comparing the fixed layout with @compact
+template<typename T>
+struct SeriesTraits;
+
+template<typename T, bool Compact>
+void encodeSeries(const T& sample, std::vector<uint8_t>& out) {
+    out.clear();
+    if constexpr (Compact) {
+        serializeCompact(sample, out);
+    } else {
+        out.resize(encodedSize(sample));
+        serializeInto(sample, out);
+    }
+}
+
+/// items/s counts rows; wire_bytes is the encoded message size
+template<typename T>
+void setSeriesCounters(benchmark::State& state, const T& sample, size_t wireBytes) {
+    state.SetItemsProcessed(state.iterations() * static_cast<int64_t>(SeriesTraits<T>::rows(sample)));
+    state.SetBytesProcessed(state.iterations() * static_cast<int64_t>(wireBytes));
+    state.counters["wire_bytes"] = static_cast<double>(wireBytes);
+}
+
+template<typename T, bool Compact>
+void BM_SeriesEncode(benchmark::State& state) {
+    const T sample = SeriesTraits<T>::make(state);
+    std::vector<uint8_t> buffer;
+    encodeSeries<T, Compact>(sample, buffer);
+    {
+        AllocationCounter allocations(state);
+        for (auto _ : state) {
+            encodeSeries<T, Compact>(sample, buffer);
+            benchmark::DoNotOptimize(buffer.data());
+            benchmark::ClobberMemory();
+        }
+    }
+    setSeriesCounters(state, sample, buffer.size());
+}
+
+template<typename T, bool Compact>
+void BM_SeriesDecode(benchmark::State& state) {
+    const T sample = SeriesTraits<T>::make(state);
+    std::vector<uint8_t> bytes;
+    encodeSeries<T, Compact>(sample, bytes);
+    {
+        AllocationCounter allocations(state);
+        for (auto _ : state) {
+            T result = Compact
+                ? SeriesTraits<T>::decodeCompact(bytes.data(), bytes.size())
+                : BenchTraits<T>::decode(bytes.data(), bytes.size());
+            benchmark::DoNotOptimize(result);
+        }
+    }
+    setSeriesCounters(state, sample, bytes.size());
+}
+
+template<>
+struct SeriesTraits<SensorDataResponse> {
+    static SensorDataResponse make(const benchmark::State& state) {
+        SensorDataResponse sample = BenchTraits<SensorDataResponse>::make(state);
+        for (size_t i = 0; i < sample.sensors.size(); i++) {
+            auto& row = sample.sensors[i];
+            row.timestamp += static_cast<uint64_t>(i * 1000 + (i * 7919) % 13);
+            row.sensor_id = static_cast<uint8_t>(row.sensor_id + i % 4);
+            row.position.x = static_cast<float>(row.position.x + 0.5 * std::sin(static_cast<double>(i) * 0.05) + 0.001 * static_cast<double>((i * 7919) % 101));
+            row.position.y = static_cast<float>(row.position.y + 0.5 * std::sin(static_cast<double>(i) * 0.05) + 0.001 * static_cast<double>((i * 7919) % 101));
+            row.position.z = static_cast<float>(row.position.z + 0.5 * std::sin(static_cast<double>(i) * 0.05) + 0.001 * static_cast<double>((i * 7919) % 101));
+            row.temperature = static_cast<float>(row.temperature + 0.5 * std::sin(static_cast<double>(i) * 0.05) + 0.001 * static_cast<double>((i * 7919) % 101));
+            row.humidity = static_cast<float>(row.humidity + 0.5 * std::sin(static_cast<double>(i) * 0.05) + 0.001 * static_cast<double>((i * 7919) % 101));
+        }
+        return sample;
+    }
+
+    static size_t rows(const SensorDataResponse& sample) { return sample.sensors.size(); }
+    static SensorDataResponse decodeCompact(const uint8_t* data, size_t size) { return deserializeCompactSensorDataResponse(data, size); }
+};
+
+template<typename Checksum>
+void BM_Checksum(benchmark::State& state) {
+    std::vector<uint8_t> data(static_cast<size_t>(state.range(0)));
+    for (size_t i = 0; i < data.size(); ++i) {
+        data[i] = static_cast<uint8_t>(i * 131);
+    }
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(Checksum::compute(data));
+    }
+    state.SetBytesProcessed(state.iterations() * state.range(0));
+}
+
+void BM_VerifyFrame(benchmark::State& state) {
+    std::vector<uint8_t> frame(ProtocolHeader::ENCODED_SIZE + static_cast<size_t>(state.range(0)), 0x5A);
+    sealFrame(frame);
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(verifyFrame(frame));
+    }
+    state.SetBytesProcessed(state.iterations() * static_cast<int64_t>(frame.size()));
+}
+
+} // namespace
+
+BENCHMARK_TEMPLATE(BM_Serialize, ProtocolHeader);
+BENCHMARK_TEMPLATE(BM_SerializeInto, ProtocolHeader);
+BENCHMARK_TEMPLATE(BM_SerializeWriter, ProtocolHeader);
+BENCHMARK_TEMPLATE(BM_Deserialize, ProtocolHeader);
+BENCHMARK_TEMPLATE(BM_DynamicEncode, ProtocolHeader);
+BENCHMARK_TEMPLATE(BM_DynamicDecode, ProtocolHeader);
+BENCHMARK_TEMPLATE(BM_Serialize, PingCommand);
+BENCHMARK_TEMPLATE(BM_SerializeInto, PingCommand);
+BENCHMARK_TEMPLATE(BM_SerializeWriter, PingCommand);
+BENCHMARK_TEMPLATE(BM_Deserialize, PingCommand);
+BENCHMARK_TEMPLATE(BM_DynamicEncode, PingCommand);
+BENCHMARK_TEMPLATE(BM_DynamicDecode, PingCommand);
+BENCHMARK_TEMPLATE(BM_Serialize, PingResponse);
+BENCHMARK_TEMPLATE(BM_SerializeInto, PingResponse);
+BENCHMARK_TEMPLATE(BM_SerializeWriter, PingResponse);
+BENCHMARK_TEMPLATE(BM_Deserialize, PingResponse);
+BENCHMARK_TEMPLATE(BM_DynamicEncode, PingResponse);
+BENCHMARK_TEMPLATE(BM_DynamicDecode, PingResponse);
+BENCHMARK_TEMPLATE(BM_Serialize, GetDeviceInfoCommand);
+BENCHMARK_TEMPLATE(BM_SerializeInto, GetDeviceInfoCommand);
+BENCHMARK_TEMPLATE(BM_SerializeWriter, GetDeviceInfoCommand);
+BENCHMARK_TEMPLATE(BM_Deserialize, GetDeviceInfoCommand);
+BENCHMARK_TEMPLATE(BM_DynamicEncode, GetDeviceInfoCommand);
+BENCHMARK_TEMPLATE(BM_DynamicDecode, GetDeviceInfoCommand);
+BENCHMARK_TEMPLATE(BM_Serialize, DeviceInfoResponse);
+BENCHMARK_TEMPLATE(BM_SerializeInto, DeviceInfoResponse);
+BENCHMARK_TEMPLATE(BM_SerializeWriter, DeviceInfoResponse);
+BENCHMARK_TEMPLATE(BM_Deserialize, DeviceInfoResponse);
+BENCHMARK_TEMPLATE(BM_DynamicEncode, DeviceInfoResponse);
+BENCHMARK_TEMPLATE(BM_DynamicDecode, DeviceInfoResponse);
+BENCHMARK_TEMPLATE(BM_Serialize, SendDataCommand)->Arg(0)->Arg(64)->Arg(1024)->Arg(16384);
+BENCHMARK_TEMPLATE(BM_SerializeInto, SendDataCommand)->Arg(0)->Arg(64)->Arg(1024)->Arg(16384);
+BENCHMARK_TEMPLATE(BM_SerializeWriter, SendDataCommand)->Arg(0)->Arg(64)->Arg(1024)->Arg(16384);
+BENCHMARK_TEMPLATE(BM_Deserialize, SendDataCommand)->Arg(0)->Arg(64)->Arg(1024)->Arg(16384);
+BENCHMARK_TEMPLATE(BM_DynamicEncode, SendDataCommand)->Arg(0)->Arg(64)->Arg(1024)->Arg(16384);
+BENCHMARK_TEMPLATE(BM_DynamicDecode, SendDataCommand)->Arg(0)->Arg(64)->Arg(1024)->Arg(16384);
+BENCHMARK_TEMPLATE(BM_View, SendDataCommand)->Arg(0)->Arg(64)->Arg(1024)->Arg(16384);
+BENCHMARK_TEMPLATE(BM_SerializeGather, SendDataCommand)->Arg(0)->Arg(64)->Arg(1024)->Arg(16384);
+BENCHMARK_TEMPLATE(BM_Serialize, SendDataResponse);
+BENCHMARK_TEMPLATE(BM_SerializeInto, SendDataResponse);
+BENCHMARK_TEMPLATE(BM_SerializeWriter, SendDataResponse);
+BENCHMARK_TEMPLATE(BM_Deserialize, SendDataResponse);
+BENCHMARK_TEMPLATE(BM_DynamicEncode, SendDataResponse);
+BENCHMARK_TEMPLATE(BM_DynamicDecode, SendDataResponse);
+BENCHMARK_TEMPLATE(BM_Serialize, SetConfigCommand)->Arg(0)->Arg(64);
+BENCHMARK_TEMPLATE(BM_SerializeInto, SetConfigCommand)->Arg(0)->Arg(64);
+BENCHMARK_TEMPLATE(BM_SerializeWriter, SetConfigCommand)->Arg(0)->Arg(64);
+BENCHMARK_TEMPLATE(BM_Deserialize, SetConfigCommand)->Arg(0)->Arg(64);
+BENCHMARK_TEMPLATE(BM_DynamicEncode, SetConfigCommand)->Arg(0)->Arg(64);
+BENCHMARK_TEMPLATE(BM_DynamicDecode, SetConfigCommand)->Arg(0)->Arg(64);
+BENCHMARK_TEMPLATE(BM_View, SetConfigCommand)->Arg(0)->Arg(64);
+BENCHMARK_TEMPLATE(BM_SerializeGather, SetConfigCommand)->Arg(0)->Arg(64);
+BENCHMARK_TEMPLATE(BM_Serialize, SetConfigResponse);
+BENCHMARK_TEMPLATE(BM_SerializeInto, SetConfigResponse);
+BENCHMARK_TEMPLATE(BM_SerializeWriter, SetConfigResponse);
+BENCHMARK_TEMPLATE(BM_Deserialize, SetConfigResponse);
+BENCHMARK_TEMPLATE(BM_DynamicEncode, SetConfigResponse);
+BENCHMARK_TEMPLATE(BM_DynamicDecode, SetConfigResponse);
+BENCHMARK_TEMPLATE(BM_Serialize, BatchCommand)->Arg(0)->Arg(64)->Arg(1024)->Arg(16384);
+BENCHMARK_TEMPLATE(BM_SerializeInto, BatchCommand)->Arg(0)->Arg(64)->Arg(1024)->Arg(16384);
+BENCHMARK_TEMPLATE(BM_SerializeWriter, BatchCommand)->Arg(0)->Arg(64)->Arg(1024)->Arg(16384);
+BENCHMARK_TEMPLATE(BM_Deserialize, BatchCommand)->Arg(0)->Arg(64)->Arg(1024)->Arg(16384);
+BENCHMARK_TEMPLATE(BM_DynamicEncode, BatchCommand)->Arg(0)->Arg(64)->Arg(1024)->Arg(16384);
+BENCHMARK_TEMPLATE(BM_DynamicDecode, BatchCommand)->Arg(0)->Arg(64)->Arg(1024)->Arg(16384);
+BENCHMARK_TEMPLATE(BM_View, BatchCommand)->Arg(0)->Arg(64)->Arg(1024)->Arg(16384);
+BENCHMARK_TEMPLATE(BM_SerializeGather, BatchCommand)->Arg(0)->Arg(64)->Arg(1024)->Arg(16384);
+BENCHMARK_TEMPLATE(BM_Serialize, BatchResponse)->Arg(0)->Arg(64)->Arg(1024)->Arg(16384);
+BENCHMARK_TEMPLATE(BM_SerializeInto, BatchResponse)->Arg(0)->Arg(64)->Arg(1024)->Arg(16384);
+BENCHMARK_TEMPLATE(BM_SerializeWriter, BatchResponse)->Arg(0)->Arg(64)->Arg(1024)->Arg(16384);
+BENCHMARK_TEMPLATE(BM_Deserialize, BatchResponse)->Arg(0)->Arg(64)->Arg(1024)->Arg(16384);
+BENCHMARK_TEMPLATE(BM_DynamicEncode, BatchResponse)->Arg(0)->Arg(64)->Arg(1024)->Arg(16384);
+BENCHMARK_TEMPLATE(BM_DynamicDecode, BatchResponse)->Arg(0)->Arg(64)->Arg(1024)->Arg(16384);
+BENCHMARK_TEMPLATE(BM_View, BatchResponse)->Arg(0)->Arg(64)->Arg(1024)->Arg(16384);
+BENCHMARK_TEMPLATE(BM_SerializeGather, BatchResponse)->Arg(0)->Arg(64)->Arg(1024)->Arg(16384);
+BENCHMARK_TEMPLATE(BM_Serialize, Vector3D);
+BENCHMARK_TEMPLATE(BM_SerializeInto, Vector3D);
+BENCHMARK_TEMPLATE(BM_SerializeWriter, Vector3D);
+BENCHMARK_TEMPLATE(BM_Deserialize, Vector3D);
+BENCHMARK_TEMPLATE(BM_DynamicEncode, Vector3D);
+BENCHMARK_TEMPLATE(BM_DynamicDecode, Vector3D);
+BENCHMARK_TEMPLATE(BM_Serialize, SensorData);
+BENCHMARK_TEMPLATE(BM_SerializeInto, SensorData);
+BENCHMARK_TEMPLATE(BM_SerializeWriter, SensorData);
+BENCHMARK_TEMPLATE(BM_Deserialize, SensorData);
+BENCHMARK_TEMPLATE(BM_DynamicEncode, SensorData);
+BENCHMARK_TEMPLATE(BM_DynamicDecode, SensorData);
+BENCHMARK_TEMPLATE(BM_Serialize, SensorDataResponse)->Arg(1)->Arg(16)->Arg(64)->Arg(255);
+BENCHMARK_TEMPLATE(BM_SerializeInto, SensorDataResponse)->Arg(1)->Arg(16)->Arg(64)->Arg(255);
+BENCHMARK_TEMPLATE(BM_SerializeWriter, SensorDataResponse)->Arg(1)->Arg(16)->Arg(64)->Arg(255);
+BENCHMARK_TEMPLATE(BM_Deserialize, SensorDataResponse)->Arg(1)->Arg(16)->Arg(64)->Arg(255);
+BENCHMARK_TEMPLATE(BM_DynamicEncode, SensorDataResponse)->Arg(1)->Arg(16)->Arg(64)->Arg(255);
+BENCHMARK_TEMPLATE(BM_DynamicDecode, SensorDataResponse)->Arg(1)->Arg(16)->Arg(64)->Arg(255);
+BENCHMARK_TEMPLATE(BM_View, SensorDataResponse)->Arg(1)->Arg(16)->Arg(64)->Arg(255);
+BENCHMARK_TEMPLATE(BM_SerializeGather, SensorDataResponse)->Arg(1)->Arg(16)->Arg(64)->Arg(255);
+BENCHMARK_TEMPLATE(BM_SeriesEncode, SensorDataResponse, false)->Arg(1)->Arg(16)->Arg(64)->Arg(255);
+BENCHMARK_TEMPLATE(BM_SeriesDecode, SensorDataResponse, false)->Arg(1)->Arg(16)->Arg(64)->Arg(255);
+BENCHMARK_TEMPLATE(BM_SeriesEncode, SensorDataResponse, true)->Arg(1)->Arg(16)->Arg(64)->Arg(255);
+BENCHMARK_TEMPLATE(BM_SeriesDecode, SensorDataResponse, true)->Arg(1)->Arg(16)->Arg(64)->Arg(255);
+BENCHMARK_TEMPLATE(BM_SerializeFieldwise, ProtocolHeader);
+BENCHMARK_TEMPLATE(BM_DeserializeFieldwise, ProtocolHeader);
+BENCHMARK_TEMPLATE(BM_SerializeFieldwise, PingCommand);
+BENCHMARK_TEMPLATE(BM_DeserializeFieldwise, PingCommand);
+BENCHMARK_TEMPLATE(BM_SerializeFieldwise, PingResponse);
+BENCHMARK_TEMPLATE(BM_DeserializeFieldwise, PingResponse);
+BENCHMARK_TEMPLATE(BM_SerializeFieldwise, DeviceInfoResponse);
+BENCHMARK_TEMPLATE(BM_DeserializeFieldwise, DeviceInfoResponse);
+BENCHMARK_TEMPLATE(BM_SerializeFieldwise, Vector3D);
+BENCHMARK_TEMPLATE(BM_DeserializeFieldwise, Vector3D);
+BENCHMARK_TEMPLATE(BM_SerializeFieldwise, SensorData);
+BENCHMARK_TEMPLATE(BM_DeserializeFieldwise, SensorData);
+BENCHMARK_TEMPLATE(BM_Checksum, Crc16Ccitt)->Arg(64)->Arg(1024)->Arg(65536);
+BENCHMARK_TEMPLATE(BM_Checksum, Crc32c)->Arg(64)->Arg(1024)->Arg(65536);
+BENCHMARK(BM_VerifyFrame)->Arg(64)->Arg(1024)->Arg(65536);
+
+BENCHMARK_MAIN();
\ No newline at end of file
@@ -0,0 +1,323 @@
+/**
+ * Auto-generated capture file implementation
+ */
+
+#include "capture.hpp"
+
+#include <algorithm>
+#include <array>
+#include <cerrno>
+#include <cstring>
+#include <stdexcept>
+#include <system_error>
+#include <utility>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace binaryprotocol {
+
+namespace {
+
+constexpr std::array<uint8_t, 8> FILE_MAGIC = {'T', 'B', 'S', 'C', 'A', 'P', '0', '1'};
+constexpr std::array<uint8_t, 8> TRAILER_MAGIC = {'T', 'B', 'S', 'I', 'D', 'X', '0', '1'};
+constexpr size_t HEADER_SIZE = ProtocolHeader::ENCODED_SIZE;
+
+template<Endian E>
+std::optional<uint64_t> loadTimestamp(std::span<const uint8_t> payload, size_t offset) {
+    if (payload.size() < offset + sizeof(uint64_t)) return std::nullopt;
+    return detail::load<E, uint64_t>(payload.data() + offset);
+}
+
+void encodeIndexEntry(uint8_t* out, const CaptureIndexEntry& entry) {
+    detail::store<Endian::Little>(out, entry.timestamp);
+    detail::store<Endian::Little>(out + 8, entry.offset);
+    detail::store<Endian::Little>(out + 16, entry.sequenceId);
+    detail::store<Endian::Little>(out + 20, uint32_t{0});
+}
+
+CaptureIndexEntry decodeIndexEntry(const uint8_t* in) {
+    return {
+        detail::load<Endian::Little, uint64_t>(in),
+        detail::load<Endian::Little, uint64_t>(in + 8),
+        detail::load<Endian::Little, uint32_t>(in + 16),
+    };
+}
+
+/// Size of the complete record at offset, or 0 if it is truncated
+size_t recordSize(const uint8_t* data, size_t offset, size_t end) {
+    const size_t available = end - offset;
+    if (available < CAPTURE_RECORD_HEADER_SIZE + HEADER_SIZE) return 0;
+    const ProtocolHeader header = deserializeProtocolHeader(data + offset + CAPTURE_RECORD_HEADER_SIZE, HEADER_SIZE);
+    const size_t size = CAPTURE_RECORD_HEADER_SIZE + HEADER_SIZE + header.payload_length;
+    return size <= available ? size : 0;
+}
+
+} // namespace
+
+std::optional<uint64_t> messageTimestamp(uint8_t commandId, std::span<const uint8_t> payload) {
+    switch (commandId) {
+    case PingCommand::COMMAND_ID: {
+        return loadTimestamp<Endian::Little>(payload, 0);
+    }
+    case SensorDataResponse::COMMAND_ID: {
+        if (payload.size() < 1 + sizeof(uint16_t) ||
+            detail::load<Endian::Little, uint16_t>(payload.data() + 1) < 29) {
+            return std::nullopt;
+        }
+        return loadTimestamp<Endian::Little>(payload, 3);
+    }
+    default:
+        return std::nullopt;
+    }
+}
+
+// ============================================
+// CaptureWriter
+// ============================================
+
+CaptureWriter::CaptureWriter(const std::string& path, CaptureOptions options) : options_(options) {
+    if (options_.indexInterval == 0) BINARY_PROTOCOL_THROW(std::invalid_argument("Capture index interval must be positive"));
+    fd_ = ::open(path.c_str(), O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, 0644);
+    if (fd_ < 0) BINARY_PROTOCOL_THROW(std::system_error(errno, std::generic_category(), "Failed to open capture file " + path));
+
+    buffer_.reserve(options_.bufferSize);
+    std::span<uint8_t> fileHeader = buffer_.allocate(CAPTURE_FILE_HEADER_SIZE);
+    std::memcpy(fileHeader.data(), FILE_MAGIC.data(), FILE_MAGIC.size());
+    detail::store<Endian::Little>(fileHeader.data() + 8, CAPTURE_VERSION);
+    detail::store<Endian::Little>(fileHeader.data() + 12, uint32_t{0});
+}
+
+CaptureWriter::~CaptureWriter() {
+    if (fd_ < 0) return;
+#if BINARY_PROTOCOL_EXCEPTIONS
+    try {
+        close();
+    } catch (...) {
+        // Destructors must not throw; an unclosed file is still readable
+        if (fd_ >= 0) ::close(fd_);
+    }
+#else
+    close();
+#endif
+}
+
+void CaptureWriter::append(std::span<const uint8_t> frame, std::optional<uint64_t> timestamp) {
+    if (frame.size() < HEADER_SIZE) BINARY_PROTOCOL_THROW(std::runtime_error("Captured frame shorter than ProtocolHeader"));
+    // Readers step from record to record by payload_length, so a mismatch would misparse the rest of the file
+    const ProtocolHeader header = deserializeProtocolHeader(frame.data(), HEADER_SIZE);
+    if (frame.size() != HEADER_SIZE + header.payload_length) {
+        BINARY_PROTOCOL_THROW(std::runtime_error("Captured frame size does not match its payload_length"));
+    }
+    std::span<uint8_t> out = beginRecord(frame.size());
+    std::memcpy(out.data(), frame.data(), frame.size());
+    finishRecord(out, timestamp);
+}
+
+std::span<uint8_t> CaptureWriter::beginRecord(size_t frameSize) {
+    if (fd_ < 0) BINARY_PROTOCOL_THROW(std::runtime_error("Capture file is closed"));
+    const size_t size = CAPTURE_RECORD_HEADER_SIZE + frameSize;
+    if (buffer_.size() > 0 && buffer_.size() + size > options_.bufferSize) {
+        flush();
+    }
+    return buffer_.allocate(size).subspan(CAPTURE_RECORD_HEADER_SIZE);
+}
+
+void CaptureWriter::finishRecord(std::span<const uint8_t> frame, std::optional<uint64_t> timestamp) {
+    const ProtocolHeader header = deserializeProtocolHeader(frame.data(), frame.size());
+    if (!timestamp) {
+        timestamp = messageTimestamp(header.command_id, frame.subspan(HEADER_SIZE));
+    }
+    lastTimestamp_ = std::max(lastTimestamp_, timestamp.value_or(lastTimestamp_));
+
+    // The record header sits directly in front of the frame in the buffer
+    const size_t record = static_cast<size_t>(frame.data() - buffer_.view().data()) - CAPTURE_RECORD_HEADER_SIZE;
+    buffer_.patch<uint64_t>(record, lastTimestamp_);
+    if (records_ % options_.indexInterval == 0) {
+        index_.push_back({lastTimestamp_, written_ + record, header.sequence_id});
+    }
+    records_++;
+}
+
+void CaptureWriter::flush() {
+    if (fd_ < 0 || buffer_.size() == 0) return;
+    writeAll(buffer_.view());
+    written_ += buffer_.size();
+    buffer_.clear();
+}
+
+void CaptureWriter::close() {
+    if (fd_ < 0) return;
+    flush();
+
+    const uint64_t indexOffset = written_;
+    std::vector<uint8_t> footer(index_.size() * CAPTURE_INDEX_ENTRY_SIZE + CAPTURE_TRAILER_SIZE);
+    for (size_t i = 0; i < index_.size(); i++) {
+        encodeIndexEntry(footer.data() + i * CAPTURE_INDEX_ENTRY_SIZE, index_[i]);
+    }
+    uint8_t* trailer = footer.data() + index_.size() * CAPTURE_INDEX_ENTRY_SIZE;
+    detail::store<Endian::Little>(trailer, indexOffset);
+    detail::store<Endian::Little>(trailer + 8, static_cast<uint64_t>(index_.size()));
+    std::memcpy(trailer + 16, TRAILER_MAGIC.data(), TRAILER_MAGIC.size());
+    writeAll(footer);
+
+    const int fd = fd_;
+    fd_ = -1;
+    if (::close(fd) != 0) BINARY_PROTOCOL_THROW(std::system_error(errno, std::generic_category(), "Failed to close capture file"));
+}
+
+void CaptureWriter::writeAll(std::span<const uint8_t> bytes) {
+    while (!bytes.empty()) {
+        const ssize_t n = ::write(fd_, bytes.data(), bytes.size());
+        if (n < 0) {
+            if (errno == EINTR) continue;
+            BINARY_PROTOCOL_THROW(std::system_error(errno, std::generic_category(), "Failed to write capture file"));
+        }
+        bytes = bytes.subspan(static_cast<size_t>(n));
+    }
+}
+
+// ============================================
+// CaptureReader
+// ============================================
+
+void CaptureReader::Iterator::load() {
+    if (position_ == end_) return;
+    if (recordSize(position_, 0, static_cast<size_t>(end_ - position_)) == 0) {
+        BINARY_PROTOCOL_THROW(std::runtime_error("Truncated capture record"));
+    }
+    const ProtocolHeader header = deserializeProtocolHeader(position_ + CAPTURE_RECORD_HEADER_SIZE, HEADER_SIZE);
+    const uint8_t* frame = position_ + CAPTURE_RECORD_HEADER_SIZE;
+    frame_ = {
+        detail::load<Endian::Little, uint64_t>(position_),
+        header,
+        {frame + HEADER_SIZE, header.payload_length},
+        {frame, HEADER_SIZE + header.payload_length},
+    };
+}
+
+CaptureReader::CaptureReader(const std::string& path) {
+    const int fd = ::open(path.c_str(), O_RDONLY | O_CLOEXEC);
+    if (fd < 0) BINARY_PROTOCOL_THROW(std::system_error(errno, std::generic_category(), "Failed to open capture file " + path));
+
+    struct stat info {};
+    if (::fstat(fd, &info) != 0) {
+        const int error = errno;
+        ::close(fd);
+        BINARY_PROTOCOL_THROW(std::system_error(error, std::generic_category(), "Failed to stat capture file " + path));
+    }
+    size_ = static_cast<size_t>(info.st_size);
+    if (size_ < CAPTURE_FILE_HEADER_SIZE) {
+        ::close(fd);
+        BINARY_PROTOCOL_THROW(std::runtime_error("Not a capture file: " + path));
+    }
+
+    void* mapped = ::mmap(nullptr, size_, PROT_READ, MAP_SHARED, fd, 0);
+    const int error = errno;
+    ::close(fd);
+    if (mapped == MAP_FAILED) BINARY_PROTOCOL_THROW(std::system_error(error, std::generic_category(), "Failed to map capture file " + path));
+    data_ = static_cast<const uint8_t*>(mapped);
+    ::madvise(mapped, size_, MADV_SEQUENTIAL);
+
+    if (std::memcmp(data_, FILE_MAGIC.data(), FILE_MAGIC.size()) != 0 ||
+        detail::load<Endian::Little, uint32_t>(data_ + 8) != CAPTURE_VERSION) {
+        ::munmap(mapped, size_);
+        BINARY_PROTOCOL_THROW(std::runtime_error("Not a capture file: " + path));
+    }
+
+#if BINARY_PROTOCOL_EXCEPTIONS
+    try {
+        if (!loadStoredIndex()) rebuildIndex();
+    } catch (...) {
+        // The destructor does not run for a constructor that throws
+        ::munmap(mapped, size_);
+        throw;
+    }
+#else
+    if (!loadStoredIndex()) rebuildIndex();
+#endif
+}
+
+CaptureReader::~CaptureReader() {
+    if (data_) ::munmap(const_cast<uint8_t*>(data_), size_);
+}
+
+bool CaptureReader::loadStoredIndex() {
+    // A stored index is trusted only if the trailer is intact and every entry points at a record
+    if (size_ < CAPTURE_FILE_HEADER_SIZE + CAPTURE_TRAILER_SIZE) return false;
+    const uint8_t* trailer = data_ + size_ - CAPTURE_TRAILER_SIZE;
+    const uint64_t indexOffset = detail::load<Endian::Little, uint64_t>(trailer);
+    const uint64_t entries = detail::load<Endian::Little, uint64_t>(trailer + 8);
+    if (std::memcmp(trailer + 16, TRAILER_MAGIC.data(), TRAILER_MAGIC.size()) != 0 ||
+        indexOffset < CAPTURE_FILE_HEADER_SIZE || indexOffset > size_ - CAPTURE_TRAILER_SIZE ||
+        entries > (size_ - CAPTURE_TRAILER_SIZE - indexOffset) / CAPTURE_INDEX_ENTRY_SIZE ||
+        indexOffset + entries * CAPTURE_INDEX_ENTRY_SIZE != size_ - CAPTURE_TRAILER_SIZE) {
+        return false;
+    }
+
+    std::vector<CaptureIndexEntry> index;
+    index.reserve(entries);
+    for (uint64_t i = 0; i < entries; i++) {
+        const CaptureIndexEntry entry = decodeIndexEntry(data_ + indexOffset + i * CAPTURE_INDEX_ENTRY_SIZE);
+        if (entry.offset < CAPTURE_FILE_HEADER_SIZE || entry.offset >= indexOffset ||
+            recordSize(data_, entry.offset, indexOffset) == 0) {
+            return false;
+        }
+        const ProtocolHeader header = deserializeProtocolHeader(data_ + entry.offset + CAPTURE_RECORD_HEADER_SIZE, HEADER_SIZE);
+        if (entry.timestamp != detail::load<Endian::Little, uint64_t>(data_ + entry.offset) ||
+            entry.sequenceId != header.sequence_id) {
+            return false;
+        }
+        if (!index.empty()) {
+            const CaptureIndexEntry& previous = index.back();
+            if (entry.offset <= previous.offset || entry.timestamp < previous.timestamp ||
+                entry.sequenceId < previous.sequenceId) {
+                return false;
+            }
+        }
+        index.push_back(entry);
+    }
+    index_ = std::move(index);
+    recordsEnd_ = indexOffset;
+    storedIndex_ = true;
+    return true;
+}
+
+void CaptureReader::rebuildIndex() {
+    size_t offset = CAPTURE_FILE_HEADER_SIZE;
+    uint64_t records = 0;
+    while (const size_t size = recordSize(data_, offset, size_)) {
+        if (records % CaptureOptions{}.indexInterval == 0) {
+            const ProtocolHeader header = deserializeProtocolHeader(data_ + offset + CAPTURE_RECORD_HEADER_SIZE, HEADER_SIZE);
+            index_.push_back({detail::load<Endian::Little, uint64_t>(data_ + offset), offset, header.sequence_id});
+        }
+        offset += size;
+        records++;
+    }
+    recordsEnd_ = offset;
+}
+
+CaptureReader::Iterator CaptureReader::seekSequence(uint32_t sequenceId) const {
+    // Start from the last stride that begins before sequenceId and step within it
+    auto stride = std::lower_bound(index_.begin(), index_.end(), sequenceId,
+        [](const CaptureIndexEntry& entry, uint32_t value) { return entry.sequenceId < value; });
+    Iterator it = stride == index_.begin() ? begin() : at(std::prev(stride)->offset);
+    const Iterator last = end();
+    while (it != last && it->header.sequence_id < sequenceId) ++it;
+    return it;
+}
+
+CaptureReader::Iterator CaptureReader::seekTime(uint64_t timestamp) const {
+    // Strides are keyed by their first timestamp; equal timestamps may span several,
+    // so start from the last stride that begins strictly earlier
+    auto stride = std::lower_bound(index_.begin(), index_.end(), timestamp,
+        [](const CaptureIndexEntry& entry, uint64_t value) { return entry.timestamp < value; });
+    Iterator it = stride == index_.begin() ? begin() : at(std::prev(stride)->offset);
+    const Iterator last = end();
+    while (it != last && it->timestamp < timestamp) ++it;
+    return it;
+}
+
+} // namespace binaryprotocol
\ No newline at end of file
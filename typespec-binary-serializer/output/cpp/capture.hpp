@@ -0,0 +1,188 @@
+/**
+ * Auto-generated capture file writer and reader
+ * Records ProtocolHeader-framed traffic to disk and replays it through mmap.
+ */
+
+#ifndef BINARY_PROTOCOL_CAPTURE_HPP
+#define BINARY_PROTOCOL_CAPTURE_HPP
+
+#include "protocol.hpp"
+
+#include <cstdint>
+#include <optional>
+#include <span>
+#include <string>
+#include <vector>
+
+namespace binaryprotocol {
+
+/*
+ * Capture file layout (file-level integers are little-endian):
+ *
+ *   file header  "TBSCAP01", u32 version, u32 reserved
+ *   records      [u64 timestamp][ProtocolHeader][payload], back to back
+ *   index        CaptureIndexEntry every indexInterval records
+ *   trailer      u64 index offset, u64 entry count, "TBSIDX01"
+ *
+ * The index and trailer are written by CaptureWriter::close(). A file without
+ * them (the writer did not close) stays readable: the reader rebuilds the index
+ * with one scan and ignores a truncated final record.
+ */
+inline constexpr uint32_t CAPTURE_VERSION = 1;
+inline constexpr size_t CAPTURE_FILE_HEADER_SIZE = 16;
+inline constexpr size_t CAPTURE_RECORD_HEADER_SIZE = 8;
+inline constexpr size_t CAPTURE_INDEX_ENTRY_SIZE = 24;
+inline constexpr size_t CAPTURE_TRAILER_SIZE = 24;
+
+/// Sparse index entry pointing at the record that starts a stride
+struct CaptureIndexEntry {
+    uint64_t timestamp;
+    /// File offset of the record
+    uint64_t offset;
+    uint32_t sequenceId;
+};
+
+struct CaptureOptions {
+    /// Records between sparse index entries
+    uint32_t indexInterval = 256;
+    /// Bytes buffered before they are written to the file
+    size_t bufferSize = 1 << 20;
+};
+
+/// Timestamp carried by the message itself, if its type has one
+std::optional<uint64_t> messageTimestamp(uint8_t commandId, std::span<const uint8_t> payload);
+
+/**
+ * Append-only capture writer.
+ *
+ * Records are encoded into one reused buffer and written in large chunks.
+ * A record's timestamp is the explicit argument if given, otherwise
+ * messageTimestamp(), otherwise the previous record's timestamp. One earlier
+ * than the previous record's (a late message, another device's clock) is
+ * raised to it, so that timestamps stay non-decreasing for seekTime().
+ */
+class CaptureWriter {
+public:
+    explicit CaptureWriter(const std::string& path, CaptureOptions options = {});
+    ~CaptureWriter();
+
+    CaptureWriter(const CaptureWriter&) = delete;
+    CaptureWriter& operator=(const CaptureWriter&) = delete;
+
+    /// Appends an encoded frame: ProtocolHeader followed by exactly payload_length bytes
+    void append(std::span<const uint8_t> frame, std::optional<uint64_t> timestamp = std::nullopt);
+
+    /// Encodes header and message straight into the write buffer; magic, command_id and payload_length are filled in
+    template<typename T>
+    void append(ProtocolHeader header, const T& message, std::optional<uint64_t> timestamp = std::nullopt) {
+        checkLengthPrefixes(message);
+        const size_t payloadSize = encodedSize(message);
+        header.magic = ProtocolHeader::MAGIC;
+        header.command_id = MessageTraits<T>::COMMAND_ID;
+        header.payload_length = static_cast<decltype(header.payload_length)>(payloadSize);
+        std::span<uint8_t> frame = beginRecord(ProtocolHeader::ENCODED_SIZE + payloadSize);
+        serializeInto(header, frame);
+        serializeInto(message, frame.subspan(ProtocolHeader::ENCODED_SIZE));
+        sealFrame(frame);
+        finishRecord(frame, timestamp);
+    }
+
+    /// Writes buffered records to the file
+    void flush();
+
+    /// Flushes and writes the index and trailer; further appends throw
+    void close();
+
+    uint64_t records() const { return records_; }
+
+private:
+    std::span<uint8_t> beginRecord(size_t frameSize);
+    void finishRecord(std::span<const uint8_t> frame, std::optional<uint64_t> timestamp);
+    void writeAll(std::span<const uint8_t> bytes);
+
+    int fd_ = -1;
+    CaptureOptions options_;
+    BinaryWriter buffer_;
+    std::vector<CaptureIndexEntry> index_;
+    /// Bytes already written to the file
+    uint64_t written_ = 0;
+    uint64_t records_ = 0;
+    uint64_t lastTimestamp_ = 0;
+};
+
+/// A recorded frame; spans borrow from the mapped file
+struct CapturedFrame {
+    uint64_t timestamp;
+    ProtocolHeader header;
+    std::span<const uint8_t> payload;
+    /// ProtocolHeader and payload as captured
+    std::span<const uint8_t> bytes;
+};
+
+/**
+ * Read-only view of a capture file through mmap.
+ *
+ * Iteration decodes only each ProtocolHeader; payloads are handed out in place.
+ * seekSequence() and seekTime() binary-search the sparse index and then step
+ * over at most one index stride of headers, assuming sequence IDs and
+ * timestamps are non-decreasing as written.
+ */
+class CaptureReader {
+public:
+    class Iterator {
+    public:
+        Iterator(const uint8_t* position, const uint8_t* end) : position_(position), end_(end) { load(); }
+        const CapturedFrame& operator*() const { return frame_; }
+        const CapturedFrame* operator->() const { return &frame_; }
+        Iterator& operator++() {
+            position_ = frame_.bytes.data() + frame_.bytes.size();
+            load();
+            return *this;
+        }
+        bool operator==(const Iterator& other) const { return position_ == other.position_; }
+        bool operator!=(const Iterator& other) const { return position_ != other.position_; }
+
+    private:
+        void load();
+
+        const uint8_t* position_;
+        const uint8_t* end_;
+        CapturedFrame frame_{};
+    };
+
+    explicit CaptureReader(const std::string& path);
+    ~CaptureReader();
+
+    CaptureReader(const CaptureReader&) = delete;
+    CaptureReader& operator=(const CaptureReader&) = delete;
+
+    Iterator begin() const { return Iterator(data_ + CAPTURE_FILE_HEADER_SIZE, data_ + recordsEnd_); }
+    Iterator end() const { return Iterator(data_ + recordsEnd_, data_ + recordsEnd_); }
+
+    /// First record whose sequence_id is >= sequenceId
+    Iterator seekSequence(uint32_t sequenceId) const;
+
+    /// First record whose timestamp is >= timestamp
+    Iterator seekTime(uint64_t timestamp) const;
+
+    std::span<const CaptureIndexEntry> index() const { return index_; }
+
+    /// False when the file had no trailer and the index was rebuilt by scanning
+    bool hasStoredIndex() const { return storedIndex_; }
+
+private:
+    Iterator at(uint64_t offset) const { return Iterator(data_ + offset, data_ + recordsEnd_); }
+    bool loadStoredIndex();
+    void rebuildIndex();
+
+    const uint8_t* data_ = nullptr;
+    size_t size_ = 0;
+    /// Offset one past the last complete record
+    size_t recordsEnd_ = 0;
+    std::vector<CaptureIndexEntry> index_;
+    bool storedIndex_ = false;
+};
+
+} // namespace binaryprotocol
+
+#endif // BINARY_PROTOCOL_CAPTURE_HPP
\ No newline at end of file
@@ -0,0 +1,197 @@
+/**
+ * Auto-generated checksum algorithms
+ * Table-driven (slicing-by-8) CRCs usable in constant expressions, with a
+ * hardware CRC32C path on x86-64 (SSE4.2) and AArch64 (CRC extension).
+ */
+
+#ifndef BINARY_PROTOCOL_CHECKSUM_HPP
+#define BINARY_PROTOCOL_CHECKSUM_HPP
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <span>
+#include <type_traits>
+
+#if defined(__x86_64__) && (defined(__GNUC__) || defined(__clang__))
+#include <nmmintrin.h>
+#define BINARY_PROTOCOL_CRC32C_SSE42 1
+#elif defined(__aarch64__) && defined(__ARM_FEATURE_CRC32)
+#include <arm_acle.h>
+#define BINARY_PROTOCOL_CRC32C_ARMV8 1
+#endif
+
+namespace binaryprotocol {
+
+namespace detail {
+
+// Row k maps a byte followed by k zero bytes, so eight input bytes fold in one step
+constexpr std::array<std::array<uint16_t, 256>, 8> makeCrc16CcittTables() {
+    std::array<std::array<uint16_t, 256>, 8> tables{};
+    for (uint32_t i = 0; i < 256; ++i) {
+        uint16_t crc = static_cast<uint16_t>(i << 8);
+        for (int bit = 0; bit < 8; ++bit) {
+            crc = static_cast<uint16_t>((crc & 0x8000) ? (crc << 1) ^ 0x1021 : crc << 1);
+        }
+        tables[0][i] = crc;
+    }
+    for (size_t k = 1; k < 8; ++k) {
+        for (size_t i = 0; i < 256; ++i) {
+            const uint16_t prev = tables[k - 1][i];
+            tables[k][i] = static_cast<uint16_t>((prev << 8) ^ tables[0][prev >> 8]);
+        }
+    }
+    return tables;
+}
+
+inline constexpr auto kCrc16CcittTables = makeCrc16CcittTables();
+
+// Reflected Castagnoli polynomial
+constexpr std::array<std::array<uint32_t, 256>, 8> makeCrc32cTables() {
+    std::array<std::array<uint32_t, 256>, 8> tables{};
+    for (uint32_t i = 0; i < 256; ++i) {
+        uint32_t crc = i;
+        for (int bit = 0; bit < 8; ++bit) {
+            crc = (crc & 1) ? (crc >> 1) ^ 0x82F63B78u : crc >> 1;
+        }
+        tables[0][i] = crc;
+    }
+    for (size_t k = 1; k < 8; ++k) {
+        for (size_t i = 0; i < 256; ++i) {
+            const uint32_t prev = tables[k - 1][i];
+            tables[k][i] = (prev >> 8) ^ tables[0][prev & 0xFF];
+        }
+    }
+    return tables;
+}
+
+inline constexpr auto kCrc32cTables = makeCrc32cTables();
+
+constexpr uint32_t crc32cSoftware(uint32_t crc, const uint8_t* p, size_t n) {
+    const auto& t = kCrc32cTables;
+    while (n >= 8) {
+        const uint32_t lo = crc ^ (static_cast<uint32_t>(p[0]) | static_cast<uint32_t>(p[1]) << 8 |
+                                   static_cast<uint32_t>(p[2]) << 16 | static_cast<uint32_t>(p[3]) << 24);
+        crc = t[7][lo & 0xFF] ^ t[6][(lo >> 8) & 0xFF] ^ t[5][(lo >> 16) & 0xFF] ^ t[4][lo >> 24] ^
+              t[3][p[4]] ^ t[2][p[5]] ^ t[1][p[6]] ^ t[0][p[7]];
+        p += 8;
+        n -= 8;
+    }
+    while (n-- > 0) {
+        crc = (crc >> 8) ^ t[0][(crc ^ *p++) & 0xFF];
+    }
+    return crc;
+}
+
+#if defined(BINARY_PROTOCOL_CRC32C_SSE42)
+__attribute__((target("sse4.2")))
+inline uint32_t crc32cHardware(uint32_t crc, const uint8_t* p, size_t n) {
+    uint64_t state = crc;
+    while (n >= 8) {
+        uint64_t word;
+        std::memcpy(&word, p, 8);
+        state = _mm_crc32_u64(state, word);
+        p += 8;
+        n -= 8;
+    }
+    uint32_t tail = static_cast<uint32_t>(state);
+    while (n-- > 0) {
+        tail = _mm_crc32_u8(tail, *p++);
+    }
+    return tail;
+}
+
+inline bool hasHardwareCrc32c() {
+    static const bool supported = __builtin_cpu_supports("sse4.2");
+    return supported;
+}
+#elif defined(BINARY_PROTOCOL_CRC32C_ARMV8)
+inline uint32_t crc32cHardware(uint32_t crc, const uint8_t* p, size_t n) {
+    while (n >= 8) {
+        uint64_t word;
+        std::memcpy(&word, p, 8);
+        crc = __crc32cd(crc, word);
+        p += 8;
+        n -= 8;
+    }
+    while (n-- > 0) {
+        crc = __crc32cb(crc, *p++);
+    }
+    return crc;
+}
+
+inline bool hasHardwareCrc32c() { return true; }
+#endif
+
+} // namespace detail
+
+/**
+ * CRC-16/CCITT-FALSE: poly 0x1021, init 0xFFFF, no reflection, no final XOR.
+ * Supports incremental updates; value() is the checksum of everything fed so far.
+ */
+class Crc16Ccitt {
+public:
+    using value_type = uint16_t;
+    static constexpr value_type INIT = 0xFFFF;
+    /// Checksum of the ASCII string "123456789"
+    static constexpr value_type CHECK = 0x29B1;
+
+    constexpr void update(std::span<const uint8_t> data) { state_ = step(state_, data.data(), data.size()); }
+    constexpr value_type value() const { return state_; }
+    constexpr void reset() { state_ = INIT; }
+
+    static constexpr value_type compute(std::span<const uint8_t> data) { return step(INIT, data.data(), data.size()); }
+
+private:
+    static constexpr uint16_t step(uint16_t crc, const uint8_t* p, size_t n) {
+        const auto& t = detail::kCrc16CcittTables;
+        while (n >= 8) {
+            crc ^= static_cast<uint16_t>(p[0] << 8 | p[1]);
+            crc = t[7][crc >> 8] ^ t[6][crc & 0xFF] ^ t[5][p[2]] ^ t[4][p[3]] ^
+                  t[3][p[4]] ^ t[2][p[5]] ^ t[1][p[6]] ^ t[0][p[7]];
+            p += 8;
+            n -= 8;
+        }
+        while (n-- > 0) {
+            crc = static_cast<uint16_t>((crc << 8) ^ t[0][((crc >> 8) ^ *p++) & 0xFF]);
+        }
+        return crc;
+    }
+
+    value_type state_ = INIT;
+};
+
+/**
+ * CRC-32C (Castagnoli): reflected poly 0x1EDC6F41, init and final XOR 0xFFFFFFFF.
+ * Uses the CPU's crc32 instruction when available at run time.
+ */
+class Crc32c {
+public:
+    using value_type = uint32_t;
+    static constexpr value_type INIT = 0xFFFFFFFF;
+    /// Checksum of the ASCII string "123456789"
+    static constexpr value_type CHECK = 0xE3069283;
+
+    constexpr void update(std::span<const uint8_t> data) { state_ = step(state_, data.data(), data.size()); }
+    constexpr value_type value() const { return ~state_; }
+    constexpr void reset() { state_ = INIT; }
+
+    static constexpr value_type compute(std::span<const uint8_t> data) { return ~step(INIT, data.data(), data.size()); }
+
+private:
+    static constexpr uint32_t step(uint32_t crc, const uint8_t* p, size_t n) {
+#if defined(BINARY_PROTOCOL_CRC32C_SSE42) || defined(BINARY_PROTOCOL_CRC32C_ARMV8)
+        if (!std::is_constant_evaluated() && detail::hasHardwareCrc32c()) {
+            return detail::crc32cHardware(crc, p, n);
+        }
+#endif
+        return detail::crc32cSoftware(crc, p, n);
+    }
+
+    value_type state_ = INIT;
+};
+
+} // namespace binaryprotocol
+
+#endif // BINARY_PROTOCOL_CHECKSUM_HPP
\ No newline at end of file
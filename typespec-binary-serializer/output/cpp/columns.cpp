@@ -0,0 +1,421 @@
+/**
+ * Auto-generated columnar container and column file implementation
+ */
+
+#include "columns.hpp"
+
+#include <cerrno>
+#include <system_error>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace binaryprotocol {
+
+namespace {
+
+constexpr std::array<uint8_t, 8> FILE_MAGIC = {'T', 'B', 'S', 'C', 'O', 'L', '0', '1'};
+constexpr std::array<uint8_t, 8> CHUNK_MAGIC = {'T', 'B', 'S', 'C', 'H', 'K', '0', '1'};
+constexpr std::array<uint8_t, 8> TRAILER_MAGIC = {'T', 'B', 'S', 'C', 'I', 'X', '0', '1'};
+constexpr uint32_t BYTE_ORDER_TAG = 0x01020304;
+constexpr size_t FILE_HEADER_SIZE = COLUMN_ALIGNMENT;
+constexpr size_t CHUNK_HEADER_SIZE = COLUMN_ALIGNMENT;
+constexpr size_t DIRECTORY_ENTRY_SIZE = 16;
+constexpr size_t TRAILER_SIZE = 24;
+
+constexpr uint64_t alignUp(uint64_t value) {
+    return (value + COLUMN_ALIGNMENT - 1) / COLUMN_ALIGNMENT * COLUMN_ALIGNMENT;
+}
+
+template<typename T>
+std::span<const uint8_t> columnBytes(std::span<const T> column) {
+    return {reinterpret_cast<const uint8_t*>(column.data()), column.size_bytes()};
+}
+
+} // namespace
+
+namespace detail {
+
+// ============================================
+// ColumnFileWriter
+// ============================================
+
+ColumnFileWriter::ColumnFileWriter(const std::string& path, uint64_t layoutId, std::span<const size_t> columnSizes)
+    : columnSizes_(columnSizes.begin(), columnSizes.end()) {
+    fd_ = ::open(path.c_str(), O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, 0644);
+    if (fd_ < 0) BINARY_PROTOCOL_THROW(std::system_error(errno, std::generic_category(), "Failed to open column file " + path));
+
+    std::array<uint8_t, FILE_HEADER_SIZE> header{};
+    std::memcpy(header.data(), FILE_MAGIC.data(), FILE_MAGIC.size());
+    std::memcpy(header.data() + 8, &COLUMN_FILE_VERSION, sizeof(uint32_t));
+    std::memcpy(header.data() + 12, &BYTE_ORDER_TAG, sizeof(uint32_t));
+    std::memcpy(header.data() + 16, &layoutId, sizeof(uint64_t));
+    const uint32_t columnCount = static_cast<uint32_t>(columnSizes_.size());
+    std::memcpy(header.data() + 24, &columnCount, sizeof(uint32_t));
+    writeAll(header);
+}
+
+ColumnFileWriter::~ColumnFileWriter() {
+    if (fd_ >= 0) ::close(fd_);
+}
+
+void ColumnFileWriter::writeChunk(uint64_t rows, std::span<const std::span<const uint8_t>> columns) {
+    if (fd_ < 0) BINARY_PROTOCOL_THROW(std::runtime_error("Column file is closed"));
+    if (columns.size() != columnSizes_.size()) BINARY_PROTOCOL_THROW(std::invalid_argument("Column count mismatch"));
+
+    chunks_.push_back({written_, rows});
+    std::array<uint8_t, CHUNK_HEADER_SIZE> header{};
+    std::memcpy(header.data(), &rows, sizeof(uint64_t));
+    std::memcpy(header.data() + 8, CHUNK_MAGIC.data(), CHUNK_MAGIC.size());
+    writeAll(header);
+    for (size_t i = 0; i < columns.size(); i++) {
+        if (columns[i].size() != rows * columnSizes_[i]) BINARY_PROTOCOL_THROW(std::invalid_argument("Column length mismatch"));
+        writeAll(columns[i]);
+        padToAlignment();
+    }
+    rows_ += rows;
+}
+
+void ColumnFileWriter::close() {
+    if (fd_ < 0) return;
+
+    const uint64_t directoryOffset = written_;
+    std::vector<uint8_t> footer(chunks_.size() * DIRECTORY_ENTRY_SIZE + TRAILER_SIZE);
+    for (size_t i = 0; i < chunks_.size(); i++) {
+        std::memcpy(footer.data() + i * DIRECTORY_ENTRY_SIZE, &chunks_[i].offset, sizeof(uint64_t));
+        std::memcpy(footer.data() + i * DIRECTORY_ENTRY_SIZE + 8, &chunks_[i].rows, sizeof(uint64_t));
+    }
+    uint8_t* trailer = footer.data() + chunks_.size() * DIRECTORY_ENTRY_SIZE;
+    const uint64_t chunkCount = chunks_.size();
+    std::memcpy(trailer, &directoryOffset, sizeof(uint64_t));
+    std::memcpy(trailer + 8, &chunkCount, sizeof(uint64_t));
+    std::memcpy(trailer + 16, TRAILER_MAGIC.data(), TRAILER_MAGIC.size());
+    writeAll(footer);
+
+    const int fd = fd_;
+    fd_ = -1;
+    if (::close(fd) != 0) BINARY_PROTOCOL_THROW(std::system_error(errno, std::generic_category(), "Failed to close column file"));
+}
+
+void ColumnFileWriter::writeAll(std::span<const uint8_t> bytes) {
+    written_ += bytes.size();
+    while (!bytes.empty()) {
+        const ssize_t n = ::write(fd_, bytes.data(), bytes.size());
+        if (n < 0) {
+            if (errno == EINTR) continue;
+            BINARY_PROTOCOL_THROW(std::system_error(errno, std::generic_category(), "Failed to write column file"));
+        }
+        bytes = bytes.subspan(static_cast<size_t>(n));
+    }
+}
+
+void ColumnFileWriter::padToAlignment() {
+    static constexpr std::array<uint8_t, COLUMN_ALIGNMENT> zeros{};
+    writeAll(std::span<const uint8_t>(zeros).first(alignUp(written_) - written_));
+}
+
+// ============================================
+// ColumnFile
+// ============================================
+
+ColumnFile::ColumnFile(const std::string& path, uint64_t layoutId, std::span<const size_t> columnSizes)
+    : columnSizes_(columnSizes.begin(), columnSizes.end()) {
+    const int fd = ::open(path.c_str(), O_RDONLY | O_CLOEXEC);
+    if (fd < 0) BINARY_PROTOCOL_THROW(std::system_error(errno, std::generic_category(), "Failed to open column file " + path));
+
+    struct stat info {};
+    if (::fstat(fd, &info) != 0) {
+        const int error = errno;
+        ::close(fd);
+        BINARY_PROTOCOL_THROW(std::system_error(error, std::generic_category(), "Failed to stat column file " + path));
+    }
+    size_ = static_cast<size_t>(info.st_size);
+    if (size_ < FILE_HEADER_SIZE) {
+        ::close(fd);
+        BINARY_PROTOCOL_THROW(std::runtime_error("Not a column file: " + path));
+    }
+
+    void* mapped = ::mmap(nullptr, size_, PROT_READ, MAP_SHARED, fd, 0);
+    const int error = errno;
+    ::close(fd);
+    if (mapped == MAP_FAILED) BINARY_PROTOCOL_THROW(std::system_error(error, std::generic_category(), "Failed to map column file " + path));
+    data_ = static_cast<const uint8_t*>(mapped);
+
+    uint32_t version;
+    uint32_t byteOrder;
+    uint64_t fileLayout;
+    uint32_t columnCount;
+    std::memcpy(&version, data_ + 8, sizeof(uint32_t));
+    std::memcpy(&byteOrder, data_ + 12, sizeof(uint32_t));
+    std::memcpy(&fileLayout, data_ + 16, sizeof(uint64_t));
+    std::memcpy(&columnCount, data_ + 24, sizeof(uint32_t));
+    const char* problem = nullptr;
+    if (std::memcmp(data_, FILE_MAGIC.data(), FILE_MAGIC.size()) != 0 || version != COLUMN_FILE_VERSION) {
+        problem = "Not a column file: ";
+    } else if (byteOrder != BYTE_ORDER_TAG) {
+        problem = "Column file was written with a different byte order: ";
+    } else if (fileLayout != layoutId || columnCount != columnSizes_.size()) {
+        problem = "Column file holds a different column layout: ";
+    }
+    if (problem) {
+        ::munmap(mapped, size_);
+        BINARY_PROTOCOL_THROW(std::runtime_error(problem + path));
+    }
+
+    // A stored directory is trusted only if the trailer is intact and every chunk checks out
+    if (size_ >= FILE_HEADER_SIZE + TRAILER_SIZE) {
+        const uint8_t* trailer = data_ + size_ - TRAILER_SIZE;
+        uint64_t directoryOffset;
+        uint64_t chunkCount;
+        std::memcpy(&directoryOffset, trailer, sizeof(uint64_t));
+        std::memcpy(&chunkCount, trailer + 8, sizeof(uint64_t));
+        if (std::memcmp(trailer + 16, TRAILER_MAGIC.data(), TRAILER_MAGIC.size()) == 0 &&
+            directoryOffset >= FILE_HEADER_SIZE &&
+            chunkCount <= (size_ - TRAILER_SIZE - directoryOffset) / DIRECTORY_ENTRY_SIZE &&
+            directoryOffset + chunkCount * DIRECTORY_ENTRY_SIZE == size_ - TRAILER_SIZE) {
+            bool valid = true;
+            for (uint64_t i = 0; i < chunkCount && valid; i++) {
+                ColumnChunk chunk;
+                std::memcpy(&chunk.offset, data_ + directoryOffset + i * DIRECTORY_ENTRY_SIZE, sizeof(uint64_t));
+                uint64_t rows = 0;
+                valid = chunk.offset % COLUMN_ALIGNMENT == 0 && chunkSize(chunk.offset, directoryOffset, rows) != 0;
+                chunk.rows = rows;
+                chunks_.push_back(chunk);
+                rows_ += rows;
+            }
+            if (valid) {
+                storedIndex_ = true;
+                return;
+            }
+            chunks_.clear();
+            rows_ = 0;
+        }
+    }
+    scanChunks();
+}
+
+ColumnFile::~ColumnFile() {
+    if (data_) ::munmap(const_cast<uint8_t*>(data_), size_);
+}
+
+const uint8_t* ColumnFile::column(size_t chunk, size_t column) const {
+    const ColumnChunk& entry = chunks_[chunk];
+    uint64_t offset = entry.offset + CHUNK_HEADER_SIZE;
+    for (size_t i = 0; i < column; i++) {
+        offset += alignUp(entry.rows * columnSizes_[i]);
+    }
+    return data_ + offset;
+}
+
+uint64_t ColumnFile::chunkSize(uint64_t offset, uint64_t limit, uint64_t& rows) const {
+    if (offset > limit || limit - offset < CHUNK_HEADER_SIZE) return 0;
+    if (std::memcmp(data_ + offset + 8, CHUNK_MAGIC.data(), CHUNK_MAGIC.size()) != 0) return 0;
+    std::memcpy(&rows, data_ + offset, sizeof(uint64_t));
+
+    uint64_t size = CHUNK_HEADER_SIZE;
+    for (size_t column : columnSizes_) {
+        if (rows > (limit - offset - size) / column) return 0;
+        size += alignUp(rows * column);
+        if (size > limit - offset) return 0;
+    }
+    return size;
+}
+
+void ColumnFile::scanChunks() {
+    uint64_t offset = FILE_HEADER_SIZE;
+    uint64_t rows = 0;
+    while (const uint64_t size = chunkSize(offset, size_, rows)) {
+        chunks_.push_back({offset, rows});
+        rows_ += rows;
+        offset += size;
+    }
+}
+
+} // namespace detail
+
+// ============================================
+// SensorDataColumns
+// ============================================
+
+void SensorDataColumns::reserve(size_t rows) {
+    timestamp_.reserve(rows);
+    sensor_id_.reserve(rows);
+    position_x_.reserve(rows);
+    position_y_.reserve(rows);
+    position_z_.reserve(rows);
+    temperature_.reserve(rows);
+    humidity_.reserve(rows);
+}
+
+void SensorDataColumns::clear() {
+    timestamp_.clear();
+    sensor_id_.clear();
+    position_x_.clear();
+    position_y_.clear();
+    position_z_.clear();
+    temperature_.clear();
+    humidity_.clear();
+    size_ = 0;
+}
+
+SensorDataColumnsView SensorDataColumns::view() const {
+    SensorDataColumnsView view;
+    view.rows = size_;
+    view.timestamp = timestamp_.view();
+    view.sensor_id = sensor_id_.view();
+    view.position_x = position_x_.view();
+    view.position_y = position_y_.view();
+    view.position_z = position_z_.view();
+    view.temperature = temperature_.view();
+    view.humidity = humidity_.view();
+    return view;
+}
+
+SensorData SensorDataColumns::row(size_t index) const {
+    SensorData row{};
+    row.timestamp = timestamp_[index];
+    row.sensor_id = sensor_id_[index];
+    row.position.x = position_x_[index];
+    row.position.y = position_y_[index];
+    row.position.z = position_z_[index];
+    row.temperature = temperature_[index];
+    row.humidity = humidity_[index];
+    return row;
+}
+
+void SensorDataColumns::append(const SensorData& row) {
+    timestamp_.push_back(row.timestamp);
+    sensor_id_.push_back(row.sensor_id);
+    position_x_.push_back(row.position.x);
+    position_y_.push_back(row.position.y);
+    position_z_.push_back(row.position.z);
+    temperature_.push_back(row.temperature);
+    humidity_.push_back(row.humidity);
+    size_++;
+}
+
+void SensorDataColumns::append(std::span<const SensorData> rows) {
+    reserve(size_ + rows.size());
+    {
+        uint64_t* out = timestamp_.extend(rows.size());
+        for (size_t i = 0; i < rows.size(); i++) out[i] = rows[i].timestamp;
+    }
+    {
+        uint8_t* out = sensor_id_.extend(rows.size());
+        for (size_t i = 0; i < rows.size(); i++) out[i] = rows[i].sensor_id;
+    }
+    {
+        float* out = position_x_.extend(rows.size());
+        for (size_t i = 0; i < rows.size(); i++) out[i] = rows[i].position.x;
+    }
+    {
+        float* out = position_y_.extend(rows.size());
+        for (size_t i = 0; i < rows.size(); i++) out[i] = rows[i].position.y;
+    }
+    {
+        float* out = position_z_.extend(rows.size());
+        for (size_t i = 0; i < rows.size(); i++) out[i] = rows[i].position.z;
+    }
+    {
+        float* out = temperature_.extend(rows.size());
+        for (size_t i = 0; i < rows.size(); i++) out[i] = rows[i].temperature;
+    }
+    {
+        float* out = humidity_.extend(rows.size());
+        for (size_t i = 0; i < rows.size(); i++) out[i] = rows[i].humidity;
+    }
+    size_ += rows.size();
+}
+
+DecodeResult<size_t> SensorDataColumns::appendEncoded(std::span<const uint8_t> bytes) {
+    if (bytes.size() % SensorData::ENCODED_SIZE != 0) return DecodeError::BadArrayLength;
+    const size_t rows = bytes.size() / SensorData::ENCODED_SIZE;
+    const uint8_t* in = bytes.data();
+    reserve(size_ + rows);
+    // One strided pass per column keeps each inner loop a single load/store stream
+    {
+        uint64_t* out = timestamp_.extend(rows);
+        for (size_t i = 0; i < rows; i++) {
+            out[i] = detail::load<Endian::Little, uint64_t>(in + i * SensorData::ENCODED_SIZE);
+        }
+    }
+    {
+        uint8_t* out = sensor_id_.extend(rows);
+        for (size_t i = 0; i < rows; i++) {
+            out[i] = detail::load<Endian::Little, uint8_t>(in + i * SensorData::ENCODED_SIZE + 8);
+        }
+    }
+    {
+        float* out = position_x_.extend(rows);
+        for (size_t i = 0; i < rows; i++) {
+            out[i] = std::bit_cast<float>(detail::load<Endian::Little, uint32_t>(in + i * SensorData::ENCODED_SIZE + 9));
+        }
+    }
+    {
+        float* out = position_y_.extend(rows);
+        for (size_t i = 0; i < rows; i++) {
+            out[i] = std::bit_cast<float>(detail::load<Endian::Little, uint32_t>(in + i * SensorData::ENCODED_SIZE + 13));
+        }
+    }
+    {
+        float* out = position_z_.extend(rows);
+        for (size_t i = 0; i < rows; i++) {
+            out[i] = std::bit_cast<float>(detail::load<Endian::Little, uint32_t>(in + i * SensorData::ENCODED_SIZE + 17));
+        }
+    }
+    {
+        float* out = temperature_.extend(rows);
+        for (size_t i = 0; i < rows; i++) {
+            out[i] = std::bit_cast<float>(detail::load<Endian::Little, uint32_t>(in + i * SensorData::ENCODED_SIZE + 21));
+        }
+    }
+    {
+        float* out = humidity_.extend(rows);
+        for (size_t i = 0; i < rows; i++) {
+            out[i] = std::bit_cast<float>(detail::load<Endian::Little, uint32_t>(in + i * SensorData::ENCODED_SIZE + 25));
+        }
+    }
+    size_ += rows;
+    return rows;
+}
+
+DecodeResult<size_t> SensorDataColumns::appendSensorDataResponse(std::span<const uint8_t> payload) {
+    // Only the fields up to sensors are read; the rest of the payload is not validated
+    if (payload.size() < 3) return DecodeError::Truncated;
+    const size_t length = detail::load<Endian::Little, uint16_t>(payload.data() + 1);
+    if (payload.size() - 3 < length) return DecodeError::LengthOverflow;
+    return appendEncoded(payload.subspan(3, length));
+}
+
+void SensorDataColumnWriter::flush() {
+    if (pending_.empty()) return;
+    const std::array<std::span<const uint8_t>, SensorDataColumns::COLUMN_COUNT> columns = {
+        columnBytes(pending_.timestamp()),
+        columnBytes(pending_.sensor_id()),
+        columnBytes(pending_.position_x()),
+        columnBytes(pending_.position_y()),
+        columnBytes(pending_.position_z()),
+        columnBytes(pending_.temperature()),
+        columnBytes(pending_.humidity()),
+    };
+    file_.writeChunk(pending_.size(), columns);
+    pending_.clear();
+}
+
+SensorDataColumnsView SensorDataColumnFile::chunk(size_t index) const {
+    const detail::ColumnChunk& chunk = file_.chunks()[index];
+    SensorDataColumnsView view;
+    view.rows = chunk.rows;
+    view.timestamp = {reinterpret_cast<const uint64_t*>(file_.column(index, 0)), chunk.rows};
+    view.sensor_id = {reinterpret_cast<const uint8_t*>(file_.column(index, 1)), chunk.rows};
+    view.position_x = {reinterpret_cast<const float*>(file_.column(index, 2)), chunk.rows};
+    view.position_y = {reinterpret_cast<const float*>(file_.column(index, 3)), chunk.rows};
+    view.position_z = {reinterpret_cast<const float*>(file_.column(index, 4)), chunk.rows};
+    view.temperature = {reinterpret_cast<const float*>(file_.column(index, 5)), chunk.rows};
+    view.humidity = {reinterpret_cast<const float*>(file_.column(index, 6)), chunk.rows};
+    return view;
+}
+
+} // namespace binaryprotocol
\ No newline at end of file
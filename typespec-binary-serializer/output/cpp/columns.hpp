@@ -0,0 +1,300 @@
+/**
+ * Auto-generated columnar (structure-of-arrays) containers and column files
+ */
+
+#ifndef BINARY_PROTOCOL_COLUMNS_HPP
+#define BINARY_PROTOCOL_COLUMNS_HPP
+
+#include "protocol.hpp"
+
+#include <algorithm>
+#include <array>
+#include <cstdint>
+#include <cstring>
+#include <new>
+#include <span>
+#include <stdexcept>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace binaryprotocol {
+
+inline constexpr size_t COLUMN_ALIGNMENT = 64;
+
+/*
+ * Column file layout (values in native byte order, which is checked on open):
+ *
+ *   file header  "TBSCOL01", u32 version, u32 byte-order tag, u64 layout ID,
+ *                u32 column count, padded to 64 bytes
+ *   chunks       u64 rows, "TBSCHK01", padded to 64 bytes, then every
+ *                column, each padded to 64 bytes
+ *   directory    ColumnChunk per chunk
+ *   trailer      u64 directory offset, u64 chunk count, "TBSCIX01"
+ *
+ * The directory and trailer are written by close(). Without them the reader
+ * finds the chunks by walking their headers and ignores a truncated last one.
+ */
+inline constexpr uint32_t COLUMN_FILE_VERSION = 1;
+
+namespace detail {
+
+/**
+ * Column storage aligned to COLUMN_ALIGNMENT. Capacity grows by at least half
+ * and is rounded up to whole CHUNK_ROWS, so appending a stream of small
+ * payloads reallocates rarely.
+ */
+template<typename T>
+class AlignedColumn {
+    static_assert(std::is_trivially_copyable_v<T>, "Column values must be trivially copyable");
+
+public:
+    static constexpr size_t CHUNK_ROWS = 4096;
+
+    AlignedColumn() = default;
+    AlignedColumn(AlignedColumn&& other) noexcept
+        : data_(std::exchange(other.data_, nullptr)),
+          size_(std::exchange(other.size_, 0)),
+          capacity_(std::exchange(other.capacity_, 0)) {}
+    AlignedColumn& operator=(AlignedColumn&& other) noexcept {
+        std::swap(data_, other.data_);
+        std::swap(size_, other.size_);
+        std::swap(capacity_, other.capacity_);
+        return *this;
+    }
+    AlignedColumn(const AlignedColumn&) = delete;
+    AlignedColumn& operator=(const AlignedColumn&) = delete;
+    ~AlignedColumn() { release(data_); }
+
+    size_t size() const { return size_; }
+    size_t capacity() const { return capacity_; }
+    std::span<const T> view() const { return {data_, size_}; }
+    const T& operator[](size_t index) const { return data_[index]; }
+
+    void reserve(size_t rows) {
+        if (rows <= capacity_) return;
+        const size_t wanted = std::max(rows, capacity_ + capacity_ / 2);
+        const size_t capacity = (wanted + CHUNK_ROWS - 1) / CHUNK_ROWS * CHUNK_ROWS;
+        T* data = static_cast<T*>(::operator new(capacity * sizeof(T), std::align_val_t{COLUMN_ALIGNMENT}));
+        if (size_ != 0) std::memcpy(data, data_, size_ * sizeof(T));
+        release(data_);
+        data_ = data;
+        capacity_ = capacity;
+    }
+
+    /// Grows the column by rows values, left for the caller to fill
+    T* extend(size_t rows) {
+        reserve(size_ + rows);
+        T* out = data_ + size_;
+        size_ += rows;
+        return out;
+    }
+
+    void push_back(T value) { *extend(1) = value; }
+    void clear() { size_ = 0; }
+
+private:
+    static void release(T* data) {
+        if (data) ::operator delete(data, std::align_val_t{COLUMN_ALIGNMENT});
+    }
+
+    T* data_ = nullptr;
+    size_t size_ = 0;
+    size_t capacity_ = 0;
+};
+
+struct ColumnChunk {
+    /// File offset of the chunk header
+    uint64_t offset;
+    uint64_t rows;
+};
+
+/// Type-independent part of the column file writer
+class ColumnFileWriter {
+public:
+    ColumnFileWriter(const std::string& path, uint64_t layoutId, std::span<const size_t> columnSizes);
+    ~ColumnFileWriter();
+
+    ColumnFileWriter(const ColumnFileWriter&) = delete;
+    ColumnFileWriter& operator=(const ColumnFileWriter&) = delete;
+
+    /// Writes one chunk; columns[i] holds rows values of columnSizes[i] bytes
+    void writeChunk(uint64_t rows, std::span<const std::span<const uint8_t>> columns);
+    void close();
+
+    bool isOpen() const { return fd_ >= 0; }
+    uint64_t rows() const { return rows_; }
+
+private:
+    void writeAll(std::span<const uint8_t> bytes);
+    void padToAlignment();
+
+    int fd_ = -1;
+    std::vector<size_t> columnSizes_;
+    std::vector<ColumnChunk> chunks_;
+    uint64_t written_ = 0;
+    uint64_t rows_ = 0;
+};
+
+/// Type-independent part of the column file reader
+class ColumnFile {
+public:
+    ColumnFile(const std::string& path, uint64_t layoutId, std::span<const size_t> columnSizes);
+    ~ColumnFile();
+
+    ColumnFile(const ColumnFile&) = delete;
+    ColumnFile& operator=(const ColumnFile&) = delete;
+
+    std::span<const ColumnChunk> chunks() const { return chunks_; }
+    uint64_t rows() const { return rows_; }
+    bool hasStoredIndex() const { return storedIndex_; }
+
+    /// First value of a column in a chunk, aligned to COLUMN_ALIGNMENT
+    const uint8_t* column(size_t chunk, size_t column) const;
+
+private:
+    /// Size of the complete chunk at offset, or 0 if it is truncated or not a chunk
+    uint64_t chunkSize(uint64_t offset, uint64_t limit, uint64_t& rows) const;
+    void scanChunks();
+
+    const uint8_t* data_ = nullptr;
+    size_t size_ = 0;
+    std::vector<size_t> columnSizes_;
+    std::vector<ColumnChunk> chunks_;
+    uint64_t rows_ = 0;
+    bool storedIndex_ = false;
+};
+
+} // namespace detail
+
+/// Columns of SensorData rows; spans borrow from the container or the mapped file
+struct SensorDataColumnsView {
+    size_t rows = 0;
+    std::span<const uint64_t> timestamp;
+    std::span<const uint8_t> sensor_id;
+    std::span<const float> position_x;
+    std::span<const float> position_y;
+    std::span<const float> position_z;
+    std::span<const float> temperature;
+    std::span<const float> humidity;
+};
+
+/**
+ * SensorData rows stored column by column. Every column starts on a
+ * COLUMN_ALIGNMENT boundary and holds naturally aligned values, so analytics
+ * loops over one column vectorise without gathers.
+ */
+class SensorDataColumns {
+public:
+    static constexpr size_t COLUMN_COUNT = 7;
+    static constexpr uint64_t LAYOUT_ID = 0xF54F52F3FAA9119FULL;
+    /// Bytes per value of each column, in declaration order
+    static constexpr std::array<size_t, COLUMN_COUNT> COLUMN_SIZES = {sizeof(uint64_t), sizeof(uint8_t), sizeof(float), sizeof(float), sizeof(float), sizeof(float), sizeof(float)};
+
+    size_t size() const { return size_; }
+    bool empty() const { return size_ == 0; }
+    void reserve(size_t rows);
+    void clear();
+
+    std::span<const uint64_t> timestamp() const { return timestamp_.view(); }
+    std::span<const uint8_t> sensor_id() const { return sensor_id_.view(); }
+    std::span<const float> position_x() const { return position_x_.view(); }
+    std::span<const float> position_y() const { return position_y_.view(); }
+    std::span<const float> position_z() const { return position_z_.view(); }
+    std::span<const float> temperature() const { return temperature_.view(); }
+    std::span<const float> humidity() const { return humidity_.view(); }
+
+    SensorDataColumnsView view() const;
+    SensorData row(size_t index) const;
+
+    void append(const SensorData& row);
+    void append(std::span<const SensorData> rows);
+
+    /// Appends encoded SensorData elements (a multiple of SensorData::ENCODED_SIZE bytes) one column at a time
+    DecodeResult<size_t> appendEncoded(std::span<const uint8_t> bytes);
+
+    /// Appends the sensors of an encoded SensorDataResponse payload
+    DecodeResult<size_t> appendSensorDataResponse(std::span<const uint8_t> payload);
+
+private:
+    size_t size_ = 0;
+    detail::AlignedColumn<uint64_t> timestamp_;
+    detail::AlignedColumn<uint8_t> sensor_id_;
+    detail::AlignedColumn<float> position_x_;
+    detail::AlignedColumn<float> position_y_;
+    detail::AlignedColumn<float> position_z_;
+    detail::AlignedColumn<float> temperature_;
+    detail::AlignedColumn<float> humidity_;
+};
+
+/**
+ * Streams SensorData rows to a column file. Rows are collected in a
+ * SensorDataColumns and written as one chunk every rowsPerChunk rows.
+ */
+class SensorDataColumnWriter {
+public:
+    explicit SensorDataColumnWriter(const std::string& path, size_t rowsPerChunk = 1 << 16)
+        : file_(path, SensorDataColumns::LAYOUT_ID, SensorDataColumns::COLUMN_SIZES), rowsPerChunk_(rowsPerChunk) {
+        if (rowsPerChunk_ == 0) BINARY_PROTOCOL_THROW(std::invalid_argument("rowsPerChunk must be positive"));
+    }
+    ~SensorDataColumnWriter() {
+        if (!file_.isOpen()) return;
+#if BINARY_PROTOCOL_EXCEPTIONS
+        try {
+            close();
+        } catch (...) {
+            // Destructors must not throw; chunks already written stay readable
+        }
+#else
+        close();
+#endif
+    }
+
+    void append(const SensorData& row) {
+        pending_.append(row);
+        if (pending_.size() >= rowsPerChunk_) flush();
+    }
+
+    DecodeResult<size_t> appendSensorDataResponse(std::span<const uint8_t> payload) {
+        DecodeResult<size_t> rows = pending_.appendSensorDataResponse(payload);
+        if (pending_.size() >= rowsPerChunk_) flush();
+        return rows;
+    }
+
+    /// Writes the pending rows as a chunk
+    void flush();
+
+    /// Flushes and writes the chunk directory; later flushes throw
+    void close() {
+        flush();
+        file_.close();
+    }
+
+    uint64_t rows() const { return file_.rows() + pending_.size(); }
+
+private:
+    detail::ColumnFileWriter file_;
+    SensorDataColumns pending_;
+    size_t rowsPerChunk_;
+};
+
+/// Read-only, memory-mapped SensorData column file
+class SensorDataColumnFile {
+public:
+    explicit SensorDataColumnFile(const std::string& path)
+        : file_(path, SensorDataColumns::LAYOUT_ID, SensorDataColumns::COLUMN_SIZES) {}
+
+    size_t chunkCount() const { return file_.chunks().size(); }
+    uint64_t rows() const { return file_.rows(); }
+    /// False when the file had no directory and its chunks were found by scanning
+    bool hasStoredIndex() const { return file_.hasStoredIndex(); }
+
+    SensorDataColumnsView chunk(size_t index) const;
+
+private:
+    detail::ColumnFile file_;
+};
+
+} // namespace binaryprotocol
+
+#endif // BINARY_PROTOCOL_COLUMNS_HPP
\ No newline at end of file
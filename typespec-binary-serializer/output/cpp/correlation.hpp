@@ -0,0 +1,423 @@
+/**
+ * Auto-generated request/response correlation
+ * A response carries its request's command ID with RESPONSE_FLAG set and the
+ * request's sequence_id.
+ */
+
+#ifndef BINARY_PROTOCOL_CORRELATION_HPP
+#define BINARY_PROTOCOL_CORRELATION_HPP
+
+#include "protocol.hpp"
+
+#include <algorithm>
+#include <array>
+#include <bit>
+#include <chrono>
+#include <cstdint>
+#include <limits>
+#include <optional>
+#include <stdexcept>
+#include <utility>
+#include <vector>
+
+namespace binaryprotocol {
+
+/// Set in the command ID of every response
+inline constexpr uint8_t RESPONSE_FLAG = 0x80;
+
+/// True for command IDs that have a paired response message
+constexpr bool expectsResponse(uint8_t commandId) {
+    switch (commandId) {
+    case PingCommand::COMMAND_ID:
+    case GetDeviceInfoCommand::COMMAND_ID:
+    case SendDataCommand::COMMAND_ID:
+    case SetConfigCommand::COMMAND_ID:
+    case BatchCommand::COMMAND_ID:
+        return true;
+    default:
+        return false;
+    }
+}
+
+/// Response message type of a command
+template<typename Command>
+struct ResponseOf;
+
+template<>
+struct ResponseOf<PingCommand> {
+    using type = PingResponse;
+};
+
+template<>
+struct ResponseOf<GetDeviceInfoCommand> {
+    using type = DeviceInfoResponse;
+};
+
+template<>
+struct ResponseOf<SendDataCommand> {
+    using type = SendDataResponse;
+};
+
+template<>
+struct ResponseOf<SetConfigCommand> {
+    using type = SetConfigResponse;
+};
+
+template<>
+struct ResponseOf<BatchCommand> {
+    using type = BatchResponse;
+};
+
+using SequenceId = decltype(ProtocolHeader::sequence_id);
+
+enum class TrackResult : uint8_t {
+    Tracked,
+    /// A request with the same sequence_id is still in flight
+    DuplicateSequence,
+    /// capacity() requests are already in flight
+    Full,
+    /// The command has no paired response
+    NoResponse,
+};
+
+struct CorrelatorStats {
+    uint64_t tracked = 0;
+    uint64_t matched = 0;
+    uint64_t timedOut = 0;
+    /// Responses with no request in flight under their sequence_id (late, duplicate or unsolicited)
+    uint64_t unmatched = 0;
+    /// Responses whose sequence_id is in flight for a different command
+    uint64_t mismatched = 0;
+};
+
+/// A request that got no response in time; error is always ErrorCode::Timeout
+template<typename Context>
+struct ExpiredRequest {
+    SequenceId sequenceId;
+    uint8_t commandId;
+    ErrorCode error;
+    Context context;
+};
+
+/**
+ * In-flight requests of one connection, keyed by sequence_id. Not thread-safe.
+ *
+ * Requests live in a pool allocated once by the constructor. A linearly probed
+ * index, at most half full and with backward-shift deletion so no tombstones
+ * build up, finds them by sequence_id; each one is also linked into a bucket
+ * of a 4-level, 256-slot hierarchical timing wheel. track(), match(), cancel()
+ * and the expiry of each request are O(1) regardless of how many are in flight.
+ */
+template<typename Context>
+class Correlator {
+public:
+    using Clock = std::chrono::steady_clock;
+
+    /// capacity: most requests in flight at once; tick: timeout resolution
+    explicit Correlator(size_t capacity,
+                        Clock::duration tick = std::chrono::milliseconds(1),
+                        Clock::time_point start = Clock::now());
+
+    /// Starts tracking a request sent with header; it expires timeout after now, rounded up to a tick
+    TrackResult track(const ProtocolHeader& header, Clock::duration timeout, Context context,
+                      Clock::time_point now = Clock::now());
+
+    /// Completes the request answered by a response header; nullopt for non-responses and if nothing matches
+    std::optional<Context> match(const ProtocolHeader& header);
+
+    /// Stops tracking a request without completing it
+    std::optional<Context> cancel(SequenceId sequenceId);
+
+    /// Expires every request due at now, calling onTimeout(ExpiredRequest<Context>&&) for each
+    template<typename OnTimeout>
+    size_t expire(Clock::time_point now, OnTimeout&& onTimeout);
+
+    /// Stops tracking everything, calling onRequest(sequenceId, commandId, Context&&) for each request
+    template<typename OnRequest>
+    size_t cancelAll(OnRequest&& onRequest);
+
+    bool contains(SequenceId sequenceId) const { return find(sequenceId) != NO_SLOT; }
+    size_t size() const { return size_; }
+    size_t capacity() const { return entries_.size(); }
+    const CorrelatorStats& stats() const { return stats_; }
+
+private:
+    static constexpr uint32_t NONE = std::numeric_limits<uint32_t>::max();
+    static constexpr size_t NO_SLOT = std::numeric_limits<size_t>::max();
+    static constexpr unsigned WHEEL_BITS = 8;
+    static constexpr unsigned WHEEL_LEVELS = 4;
+    static constexpr uint64_t WHEEL_SLOTS = uint64_t{1} << WHEEL_BITS;
+    /// Longest timeout in ticks; longer ones are clamped
+    static constexpr uint64_t MAX_TIMEOUT_TICKS = (uint64_t{1} << (WHEEL_BITS * WHEEL_LEVELS)) - 1;
+
+    struct Entry {
+        uint64_t deadline = 0;
+        /// Wheel bucket neighbours; next also links the free list
+        uint32_t prev = NONE;
+        uint32_t next = NONE;
+        uint32_t bucket = 0;
+        SequenceId sequenceId = 0;
+        uint8_t commandId = 0;
+        std::optional<Context> context;
+    };
+
+    struct Slot {
+        SequenceId sequenceId = 0;
+        /// NONE when the slot is empty
+        uint32_t entry = NONE;
+    };
+
+    size_t home(SequenceId sequenceId) const {
+        return static_cast<size_t>((uint64_t{sequenceId} * 0x9E3779B97F4A7C15ULL) >> shift_);
+    }
+
+    size_t find(SequenceId sequenceId) const;
+    void erase(size_t slot);
+    void link(uint32_t index);
+    void unlink(uint32_t index);
+    void release(uint32_t index);
+    void cascade(unsigned level);
+    uint64_t tickOf(Clock::time_point time) const;
+
+    Clock::time_point start_;
+    Clock::duration tick_;
+    /// Last tick the wheel has processed
+    uint64_t now_ = 0;
+
+    std::vector<Entry> entries_;
+    uint32_t free_ = NONE;
+    size_t size_ = 0;
+
+    std::vector<Slot> slots_;
+    size_t mask_ = 0;
+    unsigned shift_ = 0;
+
+    /// Level l, slot s at index l * WHEEL_SLOTS + s
+    std::array<uint32_t, WHEEL_LEVELS * WHEEL_SLOTS> buckets_;
+    CorrelatorStats stats_;
+};
+
+template<typename Context>
+Correlator<Context>::Correlator(size_t capacity, Clock::duration tick, Clock::time_point start)
+    : start_(start), tick_(tick) {
+    if (capacity == 0 || capacity >= NONE) {
+        BINARY_PROTOCOL_THROW(std::invalid_argument("Correlator capacity must be between 1 and 2^32 - 2"));
+    }
+    if (tick <= Clock::duration::zero()) {
+        BINARY_PROTOCOL_THROW(std::invalid_argument("Correlator tick must be positive"));
+    }
+    entries_.resize(capacity);
+    for (size_t i = 0; i + 1 < capacity; i++) {
+        entries_[i].next = static_cast<uint32_t>(i + 1);
+    }
+    free_ = 0;
+
+    const size_t tableSize = std::bit_ceil(capacity * 2);
+    slots_.resize(tableSize);
+    mask_ = tableSize - 1;
+    shift_ = 64 - static_cast<unsigned>(std::countr_zero(tableSize));
+    buckets_.fill(NONE);
+}
+
+template<typename Context>
+TrackResult Correlator<Context>::track(const ProtocolHeader& header, Clock::duration timeout, Context context,
+                                       Clock::time_point now) {
+    if (!expectsResponse(header.command_id)) return TrackResult::NoResponse;
+
+    size_t slot = home(header.sequence_id);
+    while (slots_[slot].entry != NONE) {
+        if (slots_[slot].sequenceId == header.sequence_id) return TrackResult::DuplicateSequence;
+        slot = (slot + 1) & mask_;
+    }
+    if (free_ == NONE) return TrackResult::Full;
+
+    const uint32_t index = free_;
+    Entry& entry = entries_[index];
+    free_ = entry.next;
+
+    const uint64_t ticks = timeout <= Clock::duration::zero()
+        ? 1
+        : static_cast<uint64_t>((timeout + tick_ - Clock::duration(1)) / tick_);
+    // Never behind the wheel, so a late track() still expires on the next expire()
+    const uint64_t deadline = std::max(tickOf(now) + ticks, now_ + 1);
+    entry.deadline = std::min(deadline, now_ + MAX_TIMEOUT_TICKS);
+    entry.sequenceId = header.sequence_id;
+    entry.commandId = header.command_id;
+    entry.context.emplace(std::move(context));
+
+    slots_[slot] = {header.sequence_id, index};
+    link(index);
+    size_++;
+    stats_.tracked++;
+    return TrackResult::Tracked;
+}
+
+template<typename Context>
+std::optional<Context> Correlator<Context>::match(const ProtocolHeader& header) {
+    if ((header.command_id & RESPONSE_FLAG) == 0) return std::nullopt;
+
+    const size_t slot = find(header.sequence_id);
+    if (slot == NO_SLOT) {
+        stats_.unmatched++;
+        return std::nullopt;
+    }
+    const uint32_t index = slots_[slot].entry;
+    if ((entries_[index].commandId | RESPONSE_FLAG) != header.command_id) {
+        stats_.mismatched++;
+        return std::nullopt;
+    }
+
+    std::optional<Context> context = std::move(entries_[index].context);
+    erase(slot);
+    unlink(index);
+    release(index);
+    stats_.matched++;
+    return context;
+}
+
+template<typename Context>
+std::optional<Context> Correlator<Context>::cancel(SequenceId sequenceId) {
+    const size_t slot = find(sequenceId);
+    if (slot == NO_SLOT) return std::nullopt;
+
+    const uint32_t index = slots_[slot].entry;
+    std::optional<Context> context = std::move(entries_[index].context);
+    erase(slot);
+    unlink(index);
+    release(index);
+    return context;
+}
+
+template<typename Context>
+template<typename OnTimeout>
+size_t Correlator<Context>::expire(Clock::time_point now, OnTimeout&& onTimeout) {
+    const uint64_t target = tickOf(now);
+    size_t expired = 0;
+    while (now_ < target) {
+        if (size_ == 0) {
+            now_ = target;
+            break;
+        }
+        now_++;
+        // Move the next span of each coarser level down, coarsest first
+        for (unsigned level = WHEEL_LEVELS - 1; level > 0; level--) {
+            if ((now_ & ((uint64_t{1} << (WHEEL_BITS * level)) - 1)) == 0) cascade(level);
+        }
+
+        // Unlinked one at a time so onTimeout may track, match or cancel other requests
+        const size_t bucket = static_cast<size_t>(now_ & (WHEEL_SLOTS - 1));
+        while (buckets_[bucket] != NONE) {
+            const uint32_t index = buckets_[bucket];
+            Entry& entry = entries_[index];
+            ExpiredRequest<Context> request{entry.sequenceId, entry.commandId, ErrorCode::Timeout, std::move(*entry.context)};
+            erase(find(entry.sequenceId));
+            unlink(index);
+            release(index);
+            stats_.timedOut++;
+            expired++;
+            onTimeout(std::move(request));
+        }
+    }
+    return expired;
+}
+
+template<typename Context>
+template<typename OnRequest>
+size_t Correlator<Context>::cancelAll(OnRequest&& onRequest) {
+    size_t cancelled = 0;
+    for (size_t bucket = 0; bucket < buckets_.size(); bucket++) {
+        while (buckets_[bucket] != NONE) {
+            const uint32_t index = buckets_[bucket];
+            Entry& entry = entries_[index];
+            const SequenceId sequenceId = entry.sequenceId;
+            const uint8_t commandId = entry.commandId;
+            Context context = std::move(*entry.context);
+            erase(find(sequenceId));
+            unlink(index);
+            release(index);
+            cancelled++;
+            onRequest(sequenceId, commandId, std::move(context));
+        }
+    }
+    return cancelled;
+}
+
+template<typename Context>
+size_t Correlator<Context>::find(SequenceId sequenceId) const {
+    for (size_t slot = home(sequenceId); slots_[slot].entry != NONE; slot = (slot + 1) & mask_) {
+        if (slots_[slot].sequenceId == sequenceId) return slot;
+    }
+    return NO_SLOT;
+}
+
+template<typename Context>
+void Correlator<Context>::erase(size_t slot) {
+    // Backward-shift deletion: pull later members of the probe run into the gap
+    for (size_t next = (slot + 1) & mask_; slots_[next].entry != NONE; next = (next + 1) & mask_) {
+        const size_t wanted = home(slots_[next].sequenceId);
+        if (((next - wanted) & mask_) >= ((next - slot) & mask_)) {
+            slots_[slot] = slots_[next];
+            slot = next;
+        }
+    }
+    slots_[slot].entry = NONE;
+}
+
+template<typename Context>
+void Correlator<Context>::link(uint32_t index) {
+    Entry& entry = entries_[index];
+    // The level is the highest 8-bit digit in which the deadline differs from now
+    const uint64_t differing = entry.deadline ^ now_;
+    unsigned level = 0;
+    while (level + 1 < WHEEL_LEVELS && (differing >> (WHEEL_BITS * (level + 1))) != 0) {
+        level++;
+    }
+    entry.bucket = static_cast<uint32_t>(level * WHEEL_SLOTS + ((entry.deadline >> (WHEEL_BITS * level)) & (WHEEL_SLOTS - 1)));
+
+    uint32_t& head = buckets_[entry.bucket];
+    entry.prev = NONE;
+    entry.next = head;
+    if (head != NONE) entries_[head].prev = index;
+    head = index;
+}
+
+template<typename Context>
+void Correlator<Context>::unlink(uint32_t index) {
+    Entry& entry = entries_[index];
+    if (entry.prev != NONE) {
+        entries_[entry.prev].next = entry.next;
+    } else {
+        buckets_[entry.bucket] = entry.next;
+    }
+    if (entry.next != NONE) entries_[entry.next].prev = entry.prev;
+}
+
+template<typename Context>
+void Correlator<Context>::release(uint32_t index) {
+    Entry& entry = entries_[index];
+    entry.context.reset();
+    entry.next = free_;
+    free_ = index;
+    size_--;
+}
+
+template<typename Context>
+void Correlator<Context>::cascade(unsigned level) {
+    const size_t bucket = level * WHEEL_SLOTS + static_cast<size_t>((now_ >> (WHEEL_BITS * level)) & (WHEEL_SLOTS - 1));
+    uint32_t index = buckets_[bucket];
+    buckets_[bucket] = NONE;
+    while (index != NONE) {
+        const uint32_t next = entries_[index].next;
+        link(index);
+        index = next;
+    }
+}
+
+template<typename Context>
+uint64_t Correlator<Context>::tickOf(Clock::time_point time) const {
+    return time <= start_ ? 0 : static_cast<uint64_t>((time - start_) / tick_);
+}
+
+} // namespace binaryprotocol
+
+#endif // BINARY_PROTOCOL_CORRELATION_HPP
\ No newline at end of file
@@ -0,0 +1,317 @@
+/**
+ * Auto-generated table-driven codec for schemas loaded at runtime
+ *
+ *     dynamic::Schema schema = dynamic::Schema::load(descriptor);  // a .tbsd file, or builtinSchemaDescriptor()
+ *     const dynamic::Model& model = *schema.model("SensorDataResponse");
+ *     const dynamic::Field& count = *model.field("sensor_count");
+ *     dynamic::Record record;
+ *     if (auto error = model.decodeInto(bytes, record)) { ... }
+ *     uint8_t n = record.get<uint8_t>(count);
+ *
+ * Loading compiles every model into a flat list of plan operations. Runs of
+ * adjacent fixed-size fields already in host byte order collapse into one
+ * copy, so a record's fixed part mirrors the wire layout and a fixed-size
+ * model decodes as a single memcpy plus fixups (byte swaps, bool
+ * normalization, enum checks). Variable-length data lives in the record's
+ * arena, in host byte order.
+ */
+
+#ifndef BINARY_PROTOCOL_DYNAMIC_CODEC_HPP
+#define BINARY_PROTOCOL_DYNAMIC_CODEC_HPP
+
+#include "protocol.hpp"
+
+#include <array>
+#include <cstdint>
+#include <cstring>
+#include <memory>
+#include <optional>
+#include <span>
+#include <string>
+#include <string_view>
+#include <type_traits>
+#include <vector>
+
+namespace binaryprotocol::dynamic {
+
+/// Descriptor of the schema this library was generated from
+std::span<const uint8_t> builtinSchemaDescriptor();
+
+enum class FieldType : uint8_t {
+    UInt8, UInt16, UInt32, UInt64,
+    Int8, Int16, Int32, Int64,
+    Float32, Float64, Bool,
+    /// Held as its base integer type
+    Enum,
+    /// Fixed-size text, NUL-padded
+    FixedString,
+    FixedBytes,
+    /// Nested fixed-size model; its members are fields too, named "outer.inner"
+    Model,
+    String,
+    Bytes,
+    Array,
+};
+
+class Model;
+
+struct Field {
+    /// Field name, or "outer.inner" for members of nested models
+    std::string path;
+    FieldType type;
+    /// Offset in a record; String, Bytes and Array hold a Slice there
+    uint32_t slot;
+    /// Bytes at the slot; for String, Bytes and Array, bytes per element
+    uint32_t size;
+    /// Element type of an Array
+    FieldType elementType = FieldType::UInt8;
+    /// Nested model, or the element model of an Array of models
+    const Model* model = nullptr;
+
+    bool variable() const { return type >= FieldType::String; }
+};
+
+/// Location of a variable-length value in a record's arena
+struct Slice {
+    uint32_t offset;
+    uint32_t length;
+};
+
+namespace detail {
+
+enum class OpCode : uint8_t {
+    /// The segment needs size input bytes
+    Need,
+    /// size bytes are identical on the wire and in the record
+    Copy,
+    /// A width-byte scalar in the opposite byte order
+    Swap,
+    /// Any non-zero byte is true
+    Bool,
+    /// A width-byte value must be a member of enum table index
+    Enum,
+    /// A width-byte length prefix and that many bytes; ends the segment
+    Var,
+    /// A width-byte length prefix and size-byte elements fixed up by array plan index; ends the segment
+    Array,
+    /// Var whose bytes are batch entries [command_id u8][length u16][payload], framing checked on decode
+    Batch,
+};
+
+/// One plan step; wire is relative to the current segment, slot to the record (or element)
+struct Op {
+    OpCode code;
+    uint8_t width = 0;
+    bool bigEndian = false;
+    uint16_t index = 0;
+    uint32_t wire = 0;
+    uint32_t slot = 0;
+    uint32_t size = 0;
+};
+
+struct EnumTable {
+    uint8_t width = 1;
+    /// Membership of single-byte values
+    std::array<bool, 256> small{};
+    /// Sorted members of wider enums
+    std::vector<uint64_t> values;
+
+    bool contains(uint64_t value) const;
+};
+
+struct ArrayPlan {
+    uint32_t elementSize = 0;
+    /// Per-element fixups (Swap, Bool, Enum); empty when elements are copied verbatim
+    std::vector<Op> ops;
+};
+
+[[noreturn]] void fieldMismatch(const Field& field);
+
+template<typename T>
+void checkScalar(const Field& field) {
+    static_assert(std::is_arithmetic_v<T>, "Fields are read as arithmetic types (enums as their base integer)");
+    if (field.type >= FieldType::FixedString || field.size != sizeof(T)) fieldMismatch(field);
+}
+
+} // namespace detail
+
+/// A fixed-size element of an Array of models; invalidated when its record's arena grows
+class ElementRef {
+public:
+    ElementRef(const Model* model, uint8_t* data) : model_(model), data_(data) {}
+
+    const Model* model() const { return model_; }
+
+    template<typename T>
+    T get(const Field& field) const {
+        detail::checkScalar<T>(field);
+        check(field);
+        T value;
+        std::memcpy(&value, data_ + field.slot, sizeof(T));
+        return value;
+    }
+
+    template<typename T>
+    void set(const Field& field, T value) {
+        detail::checkScalar<T>(field);
+        check(field);
+        if constexpr (std::is_same_v<T, bool>) {
+            data_[field.slot] = value ? 1 : 0;
+        } else {
+            std::memcpy(data_ + field.slot, &value, sizeof(T));
+        }
+    }
+
+    /// Bytes of a FixedString, FixedBytes or nested Model field
+    std::span<uint8_t> bytes(const Field& field) const;
+
+private:
+    void check(const Field& field) const;
+
+    const Model* model_;
+    uint8_t* data_;
+};
+
+/**
+ * A message of a runtime-loaded model: the fixed part at the model's slots in
+ * host byte order, followed by an arena for variable-length values. Reusing
+ * one Record across decodes keeps its storage.
+ */
+class Record {
+public:
+    Record() = default;
+    explicit Record(const Model& model) { reset(model); }
+
+    /// Zeroes the fixed part for model and empties the arena, keeping capacity
+    void reset(const Model& model);
+
+    const Model* model() const { return model_; }
+
+    /// Scalar, bool or enum field; T must have the field's size
+    template<typename T>
+    T get(const Field& field) const {
+        detail::checkScalar<T>(field);
+        check(field);
+        T value;
+        std::memcpy(&value, storage_.data() + field.slot, sizeof(T));
+        return value;
+    }
+
+    template<typename T>
+    void set(const Field& field, T value) {
+        detail::checkScalar<T>(field);
+        check(field);
+        if constexpr (std::is_same_v<T, bool>) {
+            storage_[field.slot] = value ? 1 : 0;
+        } else {
+            std::memcpy(storage_.data() + field.slot, &value, sizeof(T));
+        }
+    }
+
+    /// Bytes of any non-scalar field; for an Array, its elements in host byte order
+    std::span<const uint8_t> bytes(const Field& field) const;
+    /// String or Bytes value; a FixedString ends at its first NUL
+    std::string_view string(const Field& field) const;
+    /// Replaces a String, Bytes or Array value (appended to the arena), or fills a fixed one and zeroes the rest
+    void setBytes(const Field& field, std::span<const uint8_t> data);
+    void setString(const Field& field, std::string_view text);
+
+    size_t count(const Field& array) const;
+    /// Element of an Array of scalars
+    template<typename T>
+    T at(const Field& array, size_t index) const {
+        static_assert(std::is_arithmetic_v<T>, "Array elements are read as arithmetic types");
+        if (array.type != FieldType::Array || array.model != nullptr || array.size != sizeof(T)) detail::fieldMismatch(array);
+        T value;
+        std::memcpy(&value, elementData(array, index), sizeof(T));
+        return value;
+    }
+    /// Element of an Array of models
+    ElementRef element(const Field& array, size_t index);
+    /// Replaces an array with count zeroed elements and returns their bytes
+    std::span<uint8_t> resize(const Field& array, size_t count);
+
+private:
+    friend class Model;
+
+    void check(const Field& field) const;
+    Slice slice(const Field& field) const;
+    void assign(const Field& field, Slice slice);
+    uint8_t* elementData(const Field& array, size_t index) const;
+
+    const Model* model_ = nullptr;
+    std::vector<uint8_t> storage_;
+};
+
+/**
+ * One model of a loaded schema: its fields and the plan that decodes and
+ * encodes it.
+ */
+class Model {
+public:
+    const std::string& name() const { return name_; }
+    std::optional<uint8_t> commandId() const { return commandId_; }
+    /// Wire size of a fixed-size model
+    std::optional<size_t> fixedSize() const { return fixedSize_; }
+    /// Bytes of a record's fixed part
+    size_t recordSize() const { return recordSize_; }
+
+    std::span<const Field> fields() const { return fields_; }
+    /// Field by name, or "outer.inner" inside nested models; nullptr if absent
+    const Field* field(std::string_view path) const;
+
+    /// Decodes bytes into out, which is reset to this model first
+    std::optional<DecodeError> decodeInto(std::span<const uint8_t> bytes, Record& out) const;
+    DecodeResult<Record> tryDecode(std::span<const uint8_t> bytes) const;
+
+    size_t encodedSize(const Record& record) const;
+    /// Encodes record, which must belong to this model, and returns the bytes written
+    size_t encodeInto(const Record& record, std::span<uint8_t> out) const;
+    /// Appends the encoding of record to out
+    void encode(const Record& record, std::vector<uint8_t>& out) const;
+
+private:
+    friend class Schema;
+    friend class Planner;
+
+    bool decodeElements(const detail::ArrayPlan& plan, const uint8_t* in, uint8_t* out, size_t count) const;
+    void encodeElements(const detail::ArrayPlan& plan, const uint8_t* in, uint8_t* out, size_t count) const;
+
+    std::string name_;
+    std::optional<uint8_t> commandId_;
+    std::optional<size_t> fixedSize_;
+    size_t recordSize_ = 0;
+    /// Wire bytes of all fixed fields and length prefixes
+    size_t fixedWireSize_ = 0;
+    std::vector<Field> fields_;
+    std::vector<detail::Op> ops_;
+    std::vector<detail::ArrayPlan> arrays_;
+    const std::vector<detail::EnumTable>* enums_ = nullptr;
+};
+
+/**
+ * A schema loaded from a binary descriptor (written by "tbs descriptor").
+ * Models stay valid while the Schema lives.
+ */
+class Schema {
+public:
+    /// Parses a descriptor and plans every model; throws std::runtime_error if it is malformed
+    static Schema load(std::span<const uint8_t> descriptor);
+
+    const Model* model(std::string_view name) const;
+    const Model* command(uint8_t commandId) const { return commands_[commandId]; }
+    std::span<const std::unique_ptr<Model>> models() const { return models_; }
+
+private:
+    friend class Planner;
+
+    Schema() = default;
+
+    std::vector<std::unique_ptr<Model>> models_;
+    std::unique_ptr<std::vector<detail::EnumTable>> enums_;
+    std::array<const Model*, 256> commands_{};
+};
+
+} // namespace binaryprotocol::dynamic
+
+#endif // BINARY_PROTOCOL_DYNAMIC_CODEC_HPP
\ No newline at end of file
@@ -0,0 +1,99 @@
+/**
+ * Auto-generated incremental frame decoder implementation
+ */
+
+#include "frame_decoder.hpp"
+#include "instrumentation.hpp"
+
+#include <algorithm>
+#include <cstring>
+
+namespace binaryprotocol {
+
+FrameDecoder::FrameDecoder(size_t maxPayload)
+    : maxPayload_(maxPayload) {
+    pending_.reserve(HEADER_SIZE + maxPayload_);
+}
+
+FrameDecoder::Probe FrameDecoder::probe(std::span<const uint8_t> bytes) const {
+    // Reject a bad magic number as soon as its bytes are available
+    using detail::FRAME_MAGIC_BYTES;
+    using detail::FRAME_MAGIC_OFFSET;
+    const size_t magicAvailable = std::min(bytes.size() - std::min(bytes.size(), FRAME_MAGIC_OFFSET), FRAME_MAGIC_BYTES.size());
+    if (std::memcmp(bytes.data() + FRAME_MAGIC_OFFSET, FRAME_MAGIC_BYTES.data(), magicAvailable) != 0) {
+        BINARY_PROTOCOL_FRAME_ERROR(BadMagic);
+        return {ProbeStatus::Invalid, 0};
+    }
+    if (bytes.size() < HEADER_SIZE) {
+        return {ProbeStatus::NeedMore, 0};
+    }
+
+    const ProtocolHeader header = deserializeProtocolHeader(bytes.data(), HEADER_SIZE);
+    if (header.magic != ProtocolHeader::MAGIC) {
+        BINARY_PROTOCOL_FRAME_ERROR(BadMagic);
+        return {ProbeStatus::Invalid, 0};
+    }
+    if (header.payload_length > maxPayload_) {
+        BINARY_PROTOCOL_FRAME_ERROR(OversizedPayload);
+        return {ProbeStatus::Invalid, 0};
+    }
+
+    const size_t frameSize = HEADER_SIZE + header.payload_length;
+    if (bytes.size() < frameSize) {
+        return {ProbeStatus::NeedMore, 0};
+    }
+    return {ProbeStatus::Complete, frameSize};
+}
+
+Frame FrameDecoder::frameAt(std::span<const uint8_t> bytes, size_t frameSize) const {
+    Frame frame;
+    frame.header = deserializeProtocolHeader(bytes.data(), HEADER_SIZE);
+    frame.payload = bytes.subspan(HEADER_SIZE, frameSize - HEADER_SIZE);
+    frame.bytes = bytes.first(frameSize);
+    return frame;
+}
+
+size_t detail::findFrameMagic(std::span<const uint8_t> bytes, size_t from) {
+    size_t offset = from + FRAME_MAGIC_OFFSET;
+    while (offset < bytes.size()) {
+        const auto* hit = static_cast<const uint8_t*>(
+            std::memchr(bytes.data() + offset, FRAME_MAGIC_BYTES[0], bytes.size() - offset));
+        if (hit == nullptr) {
+            offset = bytes.size();
+            break;
+        }
+        offset = static_cast<size_t>(hit - bytes.data());
+        const size_t available = std::min(bytes.size() - offset, FRAME_MAGIC_BYTES.size());
+        if (std::memcmp(hit, FRAME_MAGIC_BYTES.data(), available) == 0) {
+            break;
+        }
+        offset++;
+    }
+
+    // A frame starts FRAME_MAGIC_OFFSET bytes before its magic number
+    return offset - FRAME_MAGIC_OFFSET;
+}
+
+size_t FrameDecoder::resync(std::span<const uint8_t> bytes) {
+    stats_.resyncs++;
+
+    // The current position is known bad; look for the next magic start
+    const size_t frameStart = detail::findFrameMagic(bytes, 1);
+    stats_.discardedBytes += frameStart;
+    return frameStart;
+}
+
+size_t FrameDecoder::pendingNeed() const {
+    if (pending_.size() < HEADER_SIZE) {
+        return HEADER_SIZE - pending_.size();
+    }
+    const ProtocolHeader header = deserializeProtocolHeader(pending_.data(), HEADER_SIZE);
+    return HEADER_SIZE + header.payload_length - pending_.size();
+}
+
+void FrameDecoder::resyncPending() {
+    const size_t skip = resync(pending_);
+    pending_.erase(pending_.begin(), pending_.begin() + static_cast<std::ptrdiff_t>(skip));
+}
+
+} // namespace binaryprotocol
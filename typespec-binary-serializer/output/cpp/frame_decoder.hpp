@@ -0,0 +1,136 @@
+/**
+ * Auto-generated incremental frame decoder
+ * Reassembles ProtocolHeader-framed messages from arbitrary stream chunks.
+ */
+
+#ifndef BINARY_PROTOCOL_FRAME_DECODER_HPP
+#define BINARY_PROTOCOL_FRAME_DECODER_HPP
+
+#include "protocol.hpp"
+
+#include <algorithm>
+#include <array>
+#include <cstdint>
+#include <span>
+#include <vector>
+
+namespace binaryprotocol {
+
+/**
+ * A complete frame. The payload borrows either the caller's chunk or the
+ * decoder's reassembly buffer and is only valid inside the frame callback.
+ */
+struct Frame {
+    ProtocolHeader header;
+    std::span<const uint8_t> payload;
+    /// Header and payload as received
+    std::span<const uint8_t> bytes;
+};
+
+struct FrameDecoderStats {
+    uint64_t frames = 0;
+    /// Times the decoder lost sync (bad magic or oversized payload_length)
+    uint64_t resyncs = 0;
+    /// Bytes skipped while searching for the next magic number
+    uint64_t discardedBytes = 0;
+};
+
+namespace detail {
+
+/// ProtocolHeader::magic as it appears on the wire, FRAME_MAGIC_OFFSET bytes into a frame
+inline constexpr std::array<uint8_t, 2> FRAME_MAGIC_BYTES = {0xCD, 0xAB};
+inline constexpr size_t FRAME_MAGIC_OFFSET = 0;
+
+/**
+ * Offset of the first frame start at or after from whose magic number matches.
+ * A magic number cut off by the end of bytes counts as a match, since the rest
+ * may still arrive; with no match, the offset past which bytes cannot hold one.
+ */
+size_t findFrameMagic(std::span<const uint8_t> bytes, size_t from);
+
+} // namespace detail
+
+/**
+ * Incremental decoder for ProtocolHeader-framed byte streams.
+ *
+ * Complete frames inside a chunk are handed out in place; only the trailing
+ * partial frame of a chunk is copied, into a reassembly buffer whose size is
+ * bounded by HEADER_SIZE + maxPayload and allocated once up front.
+ */
+class FrameDecoder {
+public:
+    static constexpr size_t HEADER_SIZE = ProtocolHeader::ENCODED_SIZE;
+    static constexpr size_t DEFAULT_MAX_PAYLOAD = 64 * 1024;
+
+    explicit FrameDecoder(size_t maxPayload = DEFAULT_MAX_PAYLOAD);
+
+    /// Consume a chunk, invoking onFrame(const Frame&) for every complete frame
+    template<typename Handler>
+    void feed(std::span<const uint8_t> chunk, Handler&& onFrame);
+
+    /// Drop any partially buffered frame
+    void reset() { pending_.clear(); }
+
+    size_t buffered() const { return pending_.size(); }
+    size_t maxPayload() const { return maxPayload_; }
+    const FrameDecoderStats& stats() const { return stats_; }
+
+private:
+    enum class ProbeStatus { Complete, NeedMore, Invalid };
+
+    struct Probe {
+        ProbeStatus status;
+        size_t frameSize;
+    };
+
+    Probe probe(std::span<const uint8_t> bytes) const;
+    Frame frameAt(std::span<const uint8_t> bytes, size_t frameSize) const;
+    /// Offset of the next possible frame start after a sync loss
+    size_t resync(std::span<const uint8_t> bytes);
+    /// Bytes the pending frame still needs before it can be probed again
+    size_t pendingNeed() const;
+    void resyncPending();
+
+    size_t maxPayload_;
+    std::vector<uint8_t> pending_;
+    FrameDecoderStats stats_;
+};
+
+template<typename Handler>
+void FrameDecoder::feed(std::span<const uint8_t> chunk, Handler&& onFrame) {
+    // Finish the frame left over from the previous chunk, copying only the
+    // bytes it still needs
+    while (!pending_.empty() && !chunk.empty()) {
+        const size_t take = std::min(pendingNeed(), chunk.size());
+        pending_.insert(pending_.end(), chunk.begin(), chunk.begin() + take);
+        chunk = chunk.subspan(take);
+
+        const Probe result = probe(pending_);
+        if (result.status == ProbeStatus::Complete) {
+            stats_.frames++;
+            onFrame(frameAt(pending_, result.frameSize));
+            pending_.clear();
+        } else if (result.status == ProbeStatus::Invalid) {
+            resyncPending();
+        }
+    }
+
+    // Hand out complete frames straight from the caller's chunk
+    while (!chunk.empty()) {
+        const Probe result = probe(chunk);
+        if (result.status == ProbeStatus::Complete) {
+            stats_.frames++;
+            onFrame(frameAt(chunk, result.frameSize));
+            chunk = chunk.subspan(result.frameSize);
+        } else if (result.status == ProbeStatus::NeedMore) {
+            pending_.assign(chunk.begin(), chunk.end());
+            return;
+        } else {
+            chunk = chunk.subspan(resync(chunk));
+        }
+    }
+}
+
+} // namespace binaryprotocol
+
+#endif // BINARY_PROTOCOL_FRAME_DECODER_HPP
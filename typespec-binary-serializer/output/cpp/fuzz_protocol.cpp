@@ -0,0 +1,32 @@
+/**
+ * Auto-generated libFuzzer target, built once per model:
+ *
+ *     clang++ -fsanitize=fuzzer,address,undefined -DBINARY_PROTOCOL_FUZZ_MODEL=SensorDataResponse ...
+ *
+ * (cmake -DBINARY_PROTOCOL_BUILD_FUZZERS=ON builds fuzz_<Model> for every model plus fuzz_frames.)
+ */
+
+#include "test_codec.hpp"
+
+#include <cstdio>
+#include <cstdlib>
+
+#if !defined(BINARY_PROTOCOL_FUZZ_MODEL) && !defined(BINARY_PROTOCOL_FUZZ_FRAMES)
+#error "Define BINARY_PROTOCOL_FUZZ_MODEL to the model to fuzz (or BINARY_PROTOCOL_FUZZ_FRAMES)"
+#endif
+
+extern "C" int LLVMFuzzerTestOneInput(const uint8_t* data, size_t size) {
+    using namespace binaryprotocol;
+#if defined(BINARY_PROTOCOL_FUZZ_FRAMES)
+    const char* failure = testing::checkFrames(data, size);
+    const char* name = "frames";
+#else
+    const char* failure = testing::checkDecode<BINARY_PROTOCOL_FUZZ_MODEL>(data, size);
+    const char* name = testing::CodecTraits<BINARY_PROTOCOL_FUZZ_MODEL>::NAME;
+#endif
+    if (failure) {
+        std::fprintf(stderr, "%s: %s\n", name, failure);
+        std::abort();
+    }
+    return 0;
+}
\ No newline at end of file
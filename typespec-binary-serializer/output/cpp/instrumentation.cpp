@@ -0,0 +1,182 @@
+/**
+ * Auto-generated encode/decode instrumentation implementation
+ */
+
+#include "instrumentation.hpp"
+
+#if BINARY_PROTOCOL_INSTRUMENTATION
+
+#include <atomic>
+#include <cmath>
+#include <new>
+
+namespace binaryprotocol::instrumentation {
+
+namespace {
+
+struct CommandInfo {
+    uint8_t commandId;
+    const char* name;
+};
+
+constexpr std::array<CommandInfo, COMMAND_COUNT> COMMANDS = {{
+    {PingCommand::COMMAND_ID, MessageTraits<PingCommand>::NAME},
+    {PingResponse::COMMAND_ID, MessageTraits<PingResponse>::NAME},
+    {GetDeviceInfoCommand::COMMAND_ID, MessageTraits<GetDeviceInfoCommand>::NAME},
+    {DeviceInfoResponse::COMMAND_ID, MessageTraits<DeviceInfoResponse>::NAME},
+    {SendDataCommand::COMMAND_ID, MessageTraits<SendDataCommand>::NAME},
+    {SendDataResponse::COMMAND_ID, MessageTraits<SendDataResponse>::NAME},
+    {SetConfigCommand::COMMAND_ID, MessageTraits<SetConfigCommand>::NAME},
+    {SetConfigResponse::COMMAND_ID, MessageTraits<SetConfigResponse>::NAME},
+    {BatchCommand::COMMAND_ID, MessageTraits<BatchCommand>::NAME},
+    {BatchResponse::COMMAND_ID, MessageTraits<BatchResponse>::NAME},
+    {SensorDataResponse::COMMAND_ID, MessageTraits<SensorDataResponse>::NAME},
+}};
+
+struct OperationCounters {
+    std::atomic<uint64_t> calls{0};
+    std::atomic<uint64_t> bytes{0};
+    std::atomic<uint64_t> failures{0};
+    std::atomic<uint64_t> totalNanos{0};
+    std::array<std::atomic<uint64_t>, LatencyHistogram::BUCKETS> latency{};
+};
+
+struct alignas(64) CommandCounters {
+    std::array<OperationCounters, OPERATION_COUNT> operations;
+    std::array<std::atomic<uint64_t>, DECODE_ERROR_COUNT> decodeErrors{};
+};
+
+/**
+ * Counters written by one thread at a time. The owner updates with plain
+ * relaxed load/store pairs instead of read-modify-write operations, which
+ * keeps the hot path free of locked instructions; snapshot() reads them with
+ * relaxed loads. Slots are padded so two threads never share a cache line.
+ */
+struct alignas(64) ThreadSlot {
+    std::array<CommandCounters, COMMAND_COUNT> commands;
+    alignas(64) std::array<std::atomic<uint64_t>, FRAME_ERROR_COUNT> frameErrors{};
+    std::atomic<bool> inUse{true};
+    ThreadSlot* next = nullptr;
+};
+
+/// Every slot ever created; slots are never freed, so their totals survive their threads
+std::atomic<ThreadSlot*> slots{nullptr};
+
+inline void bump(std::atomic<uint64_t>& counter, uint64_t amount) noexcept {
+    counter.store(counter.load(std::memory_order_relaxed) + amount, std::memory_order_relaxed);
+}
+
+/// nullptr if a new slot cannot be allocated; callers run inside noexcept probes
+ThreadSlot* acquireSlot() noexcept {
+    for (ThreadSlot* slot = slots.load(std::memory_order_acquire); slot != nullptr; slot = slot->next) {
+        bool idle = false;
+        if (slot->inUse.compare_exchange_strong(idle, true, std::memory_order_acquire)) return slot;
+    }
+    ThreadSlot* slot = new (std::nothrow) ThreadSlot();
+    if (!slot) return nullptr;
+    slot->next = slots.load(std::memory_order_relaxed);
+    while (!slots.compare_exchange_weak(slot->next, slot, std::memory_order_release, std::memory_order_relaxed)) {
+    }
+    return slot;
+}
+
+/// Hands the slot back for reuse when the owning thread exits
+struct SlotLease {
+    ThreadSlot* slot = nullptr;
+    ~SlotLease() {
+        if (slot) slot->inUse.store(false, std::memory_order_release);
+    }
+};
+
+/// The calling thread's slot, or nullptr while none can be allocated (the sample is then dropped)
+ThreadSlot* currentSlot() noexcept {
+    thread_local SlotLease lease;
+    if (!lease.slot) lease.slot = acquireSlot();
+    return lease.slot;
+}
+
+} // namespace
+
+uint64_t LatencyHistogram::count() const {
+    uint64_t total = 0;
+    for (uint64_t bucket : counts) total += bucket;
+    return total;
+}
+
+uint64_t LatencyHistogram::percentile(double percent) const {
+    const uint64_t total = count();
+    if (total == 0) return 0;
+    const double wanted = std::ceil(percent / 100.0 * static_cast<double>(total));
+    const uint64_t rank = wanted < 1.0 ? 1 : static_cast<uint64_t>(wanted);
+    uint64_t seen = 0;
+    for (size_t bucket = 0; bucket < BUCKETS; bucket++) {
+        seen += counts[bucket];
+        if (seen >= rank) {
+            return bucket + 1 < BUCKETS ? bucketLowerBound(bucket + 1) - 1 : UINT64_MAX;
+        }
+    }
+    return UINT64_MAX;
+}
+
+void Probe::finish() noexcept {
+    const auto elapsed = std::chrono::steady_clock::now() - start_;
+    const uint64_t nanos = static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(elapsed).count());
+
+    ThreadSlot* slot = currentSlot();
+    if (!slot) return;
+    CommandCounters& command = slot->commands[command_];
+    OperationCounters& counters = command.operations[static_cast<size_t>(operation_)];
+    bump(counters.calls, 1);
+    bump(counters.totalNanos, nanos);
+    bump(counters.latency[LatencyHistogram::bucketOf(nanos)], 1);
+    if (error_ != 0) {
+        bump(counters.failures, 1);
+        bump(command.decodeErrors[error_ - 1], 1);
+    } else if (std::uncaught_exceptions() > exceptions_) {
+        bump(counters.failures, 1);
+    } else {
+        bump(counters.bytes, bytes_);
+    }
+}
+
+void countFrameError(FrameError error) noexcept {
+    if (ThreadSlot* slot = currentSlot()) bump(slot->frameErrors[static_cast<size_t>(error)], 1);
+}
+
+Snapshot snapshot() {
+    Snapshot result;
+    result.commands.resize(COMMAND_COUNT);
+    for (size_t i = 0; i < COMMAND_COUNT; i++) {
+        result.commands[i].commandId = COMMANDS[i].commandId;
+        result.commands[i].name = COMMANDS[i].name;
+    }
+
+    for (const ThreadSlot* slot = slots.load(std::memory_order_acquire); slot != nullptr; slot = slot->next) {
+        result.slots++;
+        for (size_t i = 0; i < COMMAND_COUNT; i++) {
+            CommandStats& stats = result.commands[i];
+            for (size_t op = 0; op < OPERATION_COUNT; op++) {
+                const OperationCounters& counters = slot->commands[i].operations[op];
+                OperationStats& out = stats.operations[op];
+                out.calls += counters.calls.load(std::memory_order_relaxed);
+                out.bytes += counters.bytes.load(std::memory_order_relaxed);
+                out.failures += counters.failures.load(std::memory_order_relaxed);
+                out.totalNanos += counters.totalNanos.load(std::memory_order_relaxed);
+                for (size_t bucket = 0; bucket < LatencyHistogram::BUCKETS; bucket++) {
+                    out.latency.counts[bucket] += counters.latency[bucket].load(std::memory_order_relaxed);
+                }
+            }
+            for (size_t error = 0; error < DECODE_ERROR_COUNT; error++) {
+                stats.decodeErrors[error] += slot->commands[i].decodeErrors[error].load(std::memory_order_relaxed);
+            }
+        }
+        for (size_t error = 0; error < FRAME_ERROR_COUNT; error++) {
+            result.frameErrors[error] += slot->frameErrors[error].load(std::memory_order_relaxed);
+        }
+    }
+    return result;
+}
+
+} // namespace binaryprotocol::instrumentation
+
+#endif // BINARY_PROTOCOL_INSTRUMENTATION
\ No newline at end of file
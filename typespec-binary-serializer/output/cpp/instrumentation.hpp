@@ -0,0 +1,189 @@
+/**
+ * Auto-generated encode/decode instrumentation
+ *
+ * Build with BINARY_PROTOCOL_INSTRUMENTATION=1 (the CMake option of the same
+ * name) to count calls, bytes, failures and latency per COMMAND_ID. Otherwise
+ * the probes expand to nothing and this header declares no API.
+ */
+
+#ifndef BINARY_PROTOCOL_INSTRUMENTATION_HPP
+#define BINARY_PROTOCOL_INSTRUMENTATION_HPP
+
+#include "protocol.hpp"
+
+#ifndef BINARY_PROTOCOL_INSTRUMENTATION
+#define BINARY_PROTOCOL_INSTRUMENTATION 0
+#endif
+
+#if BINARY_PROTOCOL_INSTRUMENTATION
+
+#include <array>
+#include <bit>
+#include <chrono>
+#include <cstdint>
+#include <exception>
+#include <vector>
+
+namespace binaryprotocol::instrumentation {
+
+enum class Operation : uint8_t {
+    Encode,
+    Decode,
+};
+
+/// Framing problems seen by FrameDecoder and verifyFrame()
+enum class FrameError : uint8_t {
+    BadMagic,
+    OversizedPayload,
+    ChecksumMismatch,
+};
+
+inline constexpr size_t OPERATION_COUNT = 2;
+inline constexpr size_t DECODE_ERROR_COUNT = 6;
+inline constexpr size_t FRAME_ERROR_COUNT = 3;
+inline constexpr size_t COMMAND_COUNT = 11;
+
+/// Dense index of each message's COMMAND_ID; NO_COMMAND for IDs outside the protocol
+inline constexpr uint8_t NO_COMMAND = 0xFF;
+inline constexpr std::array<uint8_t, 256> COMMAND_INDEX = [] {
+    std::array<uint8_t, 256> index{};
+    index.fill(NO_COMMAND);
+    index[PingCommand::COMMAND_ID] = 0;
+    index[PingResponse::COMMAND_ID] = 1;
+    index[GetDeviceInfoCommand::COMMAND_ID] = 2;
+    index[DeviceInfoResponse::COMMAND_ID] = 3;
+    index[SendDataCommand::COMMAND_ID] = 4;
+    index[SendDataResponse::COMMAND_ID] = 5;
+    index[SetConfigCommand::COMMAND_ID] = 6;
+    index[SetConfigResponse::COMMAND_ID] = 7;
+    index[BatchCommand::COMMAND_ID] = 8;
+    index[BatchResponse::COMMAND_ID] = 9;
+    index[SensorDataResponse::COMMAND_ID] = 10;
+    return index;
+}();
+
+/**
+ * Latency histogram in nanoseconds with HDR-style log-linear buckets:
+ * exact below SUB_BUCKETS, then SUB_BUCKETS buckets per power of two up to
+ * 2^MAX_EXPONENT ns, so a recorded value is off by at most 1/SUB_BUCKETS.
+ */
+struct LatencyHistogram {
+    static constexpr unsigned SUB_BUCKET_BITS = 3;
+    static constexpr uint64_t SUB_BUCKETS = uint64_t{1} << SUB_BUCKET_BITS;
+    static constexpr unsigned MAX_EXPONENT = 36;
+    static constexpr size_t BUCKETS = (MAX_EXPONENT - SUB_BUCKET_BITS + 1) * SUB_BUCKETS;
+
+    static constexpr size_t bucketOf(uint64_t nanos) {
+        if (nanos < SUB_BUCKETS) return static_cast<size_t>(nanos);
+        const unsigned exponent = static_cast<unsigned>(std::bit_width(nanos)) - 1;
+        if (exponent >= MAX_EXPONENT) return BUCKETS - 1;
+        const uint64_t mantissa = (nanos >> (exponent - SUB_BUCKET_BITS)) & (SUB_BUCKETS - 1);
+        return static_cast<size_t>((exponent - SUB_BUCKET_BITS + 1) * SUB_BUCKETS + mantissa);
+    }
+
+    /// Smallest value that falls into bucket
+    static constexpr uint64_t bucketLowerBound(size_t bucket) {
+        if (bucket < SUB_BUCKETS) return bucket;
+        const unsigned exponent = static_cast<unsigned>(bucket / SUB_BUCKETS) - 1 + SUB_BUCKET_BITS;
+        return (SUB_BUCKETS + bucket % SUB_BUCKETS) << (exponent - SUB_BUCKET_BITS);
+    }
+
+    std::array<uint64_t, BUCKETS> counts{};
+
+    uint64_t count() const;
+    /// Upper bound of the bucket holding the given percentile (0-100); 0 when empty
+    uint64_t percentile(double percent) const;
+};
+
+static_assert(LatencyHistogram::bucketOf(UINT64_MAX) < LatencyHistogram::BUCKETS);
+static_assert(LatencyHistogram::bucketOf((uint64_t{1} << LatencyHistogram::MAX_EXPONENT) - 1) == LatencyHistogram::BUCKETS - 1);
+
+struct OperationStats {
+    uint64_t calls = 0;
+    /// Encoded bytes of successful calls
+    uint64_t bytes = 0;
+    /// Calls that threw or returned a DecodeError
+    uint64_t failures = 0;
+    uint64_t totalNanos = 0;
+    LatencyHistogram latency;
+};
+
+struct CommandStats {
+    uint8_t commandId;
+    const char* name;
+    std::array<OperationStats, OPERATION_COUNT> operations;
+    /// tryDeserialize failures by DecodeError
+    std::array<uint64_t, DECODE_ERROR_COUNT> decodeErrors{};
+
+    const OperationStats& encode() const { return operations[static_cast<size_t>(Operation::Encode)]; }
+    const OperationStats& decode() const { return operations[static_cast<size_t>(Operation::Decode)]; }
+};
+
+/**
+ * Totals since process start. Counters only grow, so the activity over an
+ * interval is the difference of two snapshots.
+ */
+struct Snapshot {
+    std::vector<CommandStats> commands;
+    std::array<uint64_t, FRAME_ERROR_COUNT> frameErrors{};
+    /// Per-thread slots summed (a slot is reused after its thread exits)
+    size_t slots = 0;
+};
+
+/// Sums every thread's slot without stopping the threads that update them
+Snapshot snapshot();
+
+void countFrameError(FrameError error) noexcept;
+
+/**
+ * Times one encode or decode call and records it in the calling thread's
+ * slot when it goes out of scope. A call that leaves by exception, or whose
+ * result went through fail(), counts as a failure.
+ */
+class Probe {
+public:
+    Probe(Operation operation, uint8_t commandId, size_t bytes) noexcept
+        : start_(std::chrono::steady_clock::now()),
+          bytes_(bytes),
+          exceptions_(std::uncaught_exceptions()),
+          operation_(operation),
+          command_(COMMAND_INDEX[commandId]) {}
+    ~Probe() { finish(); }
+
+    Probe(const Probe&) = delete;
+    Probe& operator=(const Probe&) = delete;
+
+    DecodeError fail(DecodeError error) noexcept {
+        error_ = static_cast<uint8_t>(static_cast<uint8_t>(error) + 1);
+        return error;
+    }
+
+private:
+    void finish() noexcept;
+
+    std::chrono::steady_clock::time_point start_;
+    size_t bytes_;
+    int exceptions_;
+    Operation operation_;
+    uint8_t command_;
+    /// DecodeError + 1, or 0 while the call has not failed
+    uint8_t error_ = 0;
+};
+
+} // namespace binaryprotocol::instrumentation
+
+#define BINARY_PROTOCOL_PROBE(operation, commandId, bytes) \
+    ::binaryprotocol::instrumentation::Probe binaryProtocolProbe(::binaryprotocol::instrumentation::Operation::operation, commandId, bytes)
+#define BINARY_PROTOCOL_PROBE_FAIL(error) binaryProtocolProbe.fail(error)
+#define BINARY_PROTOCOL_FRAME_ERROR(kind) \
+    ::binaryprotocol::instrumentation::countFrameError(::binaryprotocol::instrumentation::FrameError::kind)
+
+#else
+
+#define BINARY_PROTOCOL_PROBE(operation, commandId, bytes) ((void)0)
+#define BINARY_PROTOCOL_PROBE_FAIL(error) (error)
+#define BINARY_PROTOCOL_FRAME_ERROR(kind) ((void)0)
+
+#endif // BINARY_PROTOCOL_INSTRUMENTATION
+
+#endif // BINARY_PROTOCOL_INSTRUMENTATION_HPP
\ No newline at end of file
@@ -0,0 +1,344 @@
+/**
+ * Auto-generated lock-free message rings
+ * Encoded messages are stored inline as [length u32][bytes], 8-byte aligned, in one
+ * contiguous cache-line-aligned region. Producers encode straight into reserved space
+ * and consumers receive zero-copy views.
+ */
+
+#ifndef BINARY_PROTOCOL_MESSAGE_RING_HPP
+#define BINARY_PROTOCOL_MESSAGE_RING_HPP
+
+#include "protocol.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <bit>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <limits>
+#include <memory>
+#include <new>
+#include <optional>
+#include <span>
+#include <stdexcept>
+
+namespace binaryprotocol {
+
+namespace detail {
+
+inline constexpr size_t kCacheLineSize = 64;
+inline constexpr size_t kRingRecordAlignment = 8;
+inline constexpr size_t kRingRecordHeaderSize = sizeof(uint32_t);
+/// Record header marking the unused tail of the region; the next record starts at offset 0
+inline constexpr uint32_t kRingWrapMarker = 0xFFFFFFFFu;
+/// Set in the header of a committed MPSC record, so that zero means "not yet written"
+inline constexpr uint32_t kRingCommittedBit = 0x80000000u;
+
+constexpr size_t ringRecordSize(size_t payloadSize) {
+    return (kRingRecordHeaderSize + payloadSize + kRingRecordAlignment - 1) & ~(kRingRecordAlignment - 1);
+}
+
+/// Records are limited to half the ring so that one always fits after a wrap
+inline void checkRingRecord(size_t record, size_t capacity) {
+    if (record > capacity / 2) BINARY_PROTOCOL_THROW(std::length_error("Message larger than half the ring capacity"));
+}
+
+struct RingStorageDeleter {
+    void operator()(uint8_t* memory) const {
+        ::operator delete(memory, std::align_val_t{kCacheLineSize});
+    }
+};
+
+using RingStorage = std::unique_ptr<uint8_t[], RingStorageDeleter>;
+
+inline RingStorage allocateRing(size_t capacity) {
+    if (capacity < kCacheLineSize || !std::has_single_bit(capacity)) {
+        BINARY_PROTOCOL_THROW(std::invalid_argument("Ring capacity must be a power of two of at least 64 bytes"));
+    }
+    auto* memory = static_cast<uint8_t*>(::operator new(capacity, std::align_val_t{kCacheLineSize}));
+    std::memset(memory, 0, capacity);
+    return RingStorage(memory);
+}
+
+} // namespace detail
+
+/**
+ * Single-producer single-consumer message ring.
+ *
+ * Producer writes are staged until publish(), and consume() hands out every
+ * visible message before releasing the space, so a batch of messages costs one
+ * release store on each side.
+ */
+class SpscMessageRing {
+public:
+    /// capacity is the size of the inline region in bytes and must be a power of two
+    explicit SpscMessageRing(size_t capacity)
+        : storage_(detail::allocateRing(capacity)), capacity_(capacity), mask_(capacity - 1) {}
+
+    SpscMessageRing(const SpscMessageRing&) = delete;
+    SpscMessageRing& operator=(const SpscMessageRing&) = delete;
+
+    // ---- Producer ----
+
+    /// Reserves space for one message of exactly size bytes; empty if the ring is full.
+    /// Throws std::length_error for messages that can never fit.
+    std::optional<std::span<uint8_t>> tryReserve(size_t size) {
+        const size_t record = detail::ringRecordSize(size);
+        const size_t offset = staged_ & mask_;
+        const size_t skip = offset + record > capacity_ ? capacity_ - offset : 0;
+        detail::checkRingRecord(record, capacity_);
+        if (staged_ + skip + record - cachedTail_ > capacity_) {
+            cachedTail_ = tail_.value.load(std::memory_order_acquire);
+            if (staged_ + skip + record - cachedTail_ > capacity_) return std::nullopt;
+        }
+        if (skip > 0) {
+            storeHeader(offset, detail::kRingWrapMarker);
+            staged_ += skip;
+        }
+        uint8_t* base = storage_.get() + (staged_ & mask_);
+        storeHeader(staged_ & mask_, static_cast<uint32_t>(size));
+        staged_ += record;
+        return std::span<uint8_t>(base + detail::kRingRecordHeaderSize, size);
+    }
+
+    /// Stages an encoded message; false if the ring is full
+    template<typename T>
+    bool tryPush(const T& message) {
+        checkLengthPrefixes(message);
+        const std::optional<std::span<uint8_t>> slot = tryReserve(encodedSize(message));
+        if (!slot) return false;
+        serializeInto(message, *slot);
+        return true;
+    }
+
+    /// Stages a copy of already encoded bytes, e.g. Frame::bytes
+    bool tryPushBytes(std::span<const uint8_t> bytes) {
+        const std::optional<std::span<uint8_t>> slot = tryReserve(bytes.size());
+        if (!slot) return false;
+        if (!bytes.empty()) std::memcpy(slot->data(), bytes.data(), bytes.size());
+        return true;
+    }
+
+    /// Makes every staged message visible to the consumer
+    void publish() { head_.value.store(staged_, std::memory_order_release); }
+
+    // ---- Consumer ----
+
+    /**
+     * Calls onMessage(std::span<const uint8_t>) for up to maxMessages published
+     * messages, then releases their space. Views are valid only inside the callback.
+     */
+    template<typename F>
+    size_t consume(F&& onMessage, size_t maxMessages = std::numeric_limits<size_t>::max()) {
+        const size_t head = head_.value.load(std::memory_order_acquire);
+        size_t position = consumed_;
+        size_t count = 0;
+        while (position != head && count < maxMessages) {
+            const size_t offset = position & mask_;
+            const uint32_t header = loadHeader(offset);
+            if (header == detail::kRingWrapMarker) {
+                position += capacity_ - offset;
+                continue;
+            }
+            onMessage(std::span<const uint8_t>(storage_.get() + offset + detail::kRingRecordHeaderSize, header));
+            position += detail::ringRecordSize(header);
+            ++count;
+        }
+        if (position != consumed_) {
+            consumed_ = position;
+            tail_.value.store(position, std::memory_order_release);
+        }
+        return count;
+    }
+
+    size_t capacity() const { return capacity_; }
+
+private:
+    struct alignas(detail::kCacheLineSize) Cursor {
+        std::atomic<size_t> value{0};
+    };
+
+    void storeHeader(size_t offset, uint32_t value) { std::memcpy(storage_.get() + offset, &value, sizeof(value)); }
+    uint32_t loadHeader(size_t offset) const {
+        uint32_t value;
+        std::memcpy(&value, storage_.get() + offset, sizeof(value));
+        return value;
+    }
+
+    detail::RingStorage storage_;
+    size_t capacity_;
+    size_t mask_;
+
+    Cursor head_;
+    Cursor tail_;
+    // Producer-local state
+    alignas(detail::kCacheLineSize) size_t staged_ = 0;
+    size_t cachedTail_ = 0;
+    // Consumer-local state
+    alignas(detail::kCacheLineSize) size_t consumed_ = 0;
+};
+
+/**
+ * Multi-producer single-consumer message ring.
+ *
+ * Producers claim space with one CAS on the head cursor and publish each record by
+ * storing its header with release semantics, so slow producers never block others
+ * from reserving. tryPush() with several messages claims space for all of them at once.
+ * The consumer zeroes consumed space before handing it back, which keeps unwritten
+ * headers reading as zero.
+ */
+class MpscMessageRing {
+public:
+    /// A claimed record; the payload becomes visible to the consumer on commit()
+    class Reservation {
+    public:
+        std::span<uint8_t> data() const { return {header_ + detail::kRingRecordHeaderSize, size_}; }
+
+        void commit() {
+            std::atomic_ref<uint32_t>(*reinterpret_cast<uint32_t*>(header_))
+                .store(static_cast<uint32_t>(size_) | detail::kRingCommittedBit, std::memory_order_release);
+        }
+
+    private:
+        friend class MpscMessageRing;
+        Reservation(uint8_t* header, size_t size) : header_(header), size_(size) {}
+
+        uint8_t* header_;
+        size_t size_;
+    };
+
+    /// capacity is the size of the inline region in bytes and must be a power of two
+    explicit MpscMessageRing(size_t capacity)
+        : storage_(detail::allocateRing(capacity)), capacity_(capacity), mask_(capacity - 1) {}
+
+    MpscMessageRing(const MpscMessageRing&) = delete;
+    MpscMessageRing& operator=(const MpscMessageRing&) = delete;
+
+    // ---- Producers (any thread) ----
+
+    /// Claims space for one message of exactly size bytes; empty if the ring is full.
+    /// Throws std::length_error for messages that can never fit.
+    std::optional<Reservation> tryReserve(size_t size) {
+        const std::optional<size_t> position = claim(detail::ringRecordSize(size));
+        if (!position) return std::nullopt;
+        return Reservation(storage_.get() + (*position & mask_), size);
+    }
+
+    /// Encodes and publishes the messages, claiming space for all of them with one CAS
+    template<typename... Ts>
+    bool tryPush(const Ts&... messages) {
+        // A claimed record that is never committed would stall the consumer, so reject before claiming
+        (checkLengthPrefixes(messages), ...);
+        const size_t total = (detail::ringRecordSize(encodedSize(messages)) + ...);
+        const std::optional<size_t> position = claim(total);
+        if (!position) return false;
+        uint8_t* cursor = storage_.get() + (*position & mask_);
+        (emplace(cursor, messages), ...);
+        return true;
+    }
+
+    /// Publishes a copy of already encoded bytes, e.g. Frame::bytes
+    bool tryPushBytes(std::span<const uint8_t> bytes) {
+        std::optional<Reservation> slot = tryReserve(bytes.size());
+        if (!slot) return false;
+        if (!bytes.empty()) std::memcpy(slot->data().data(), bytes.data(), bytes.size());
+        slot->commit();
+        return true;
+    }
+
+    // ---- Consumer (one thread) ----
+
+    /**
+     * Calls onMessage(std::span<const uint8_t>) for up to maxMessages committed
+     * messages in order, stopping at the first record that is claimed but not yet
+     * committed. Views are valid only inside the callback.
+     */
+    template<typename F>
+    size_t consume(F&& onMessage, size_t maxMessages = std::numeric_limits<size_t>::max()) {
+        size_t position = consumed_;
+        size_t count = 0;
+        // Space read in this call is zeroed only by release(), so a full ring must not wrap onto it
+        while (count < maxMessages && position - consumed_ < capacity_) {
+            const size_t offset = position & mask_;
+            const uint32_t header = headerAt(offset).load(std::memory_order_acquire);
+            if (header == 0) break;
+            if (header == detail::kRingWrapMarker) {
+                position += capacity_ - offset;
+                continue;
+            }
+            const size_t size = header & ~detail::kRingCommittedBit;
+            onMessage(std::span<const uint8_t>(storage_.get() + offset + detail::kRingRecordHeaderSize, size));
+            position += detail::ringRecordSize(size);
+            ++count;
+        }
+        release(position);
+        return count;
+    }
+
+    size_t capacity() const { return capacity_; }
+
+private:
+    struct alignas(detail::kCacheLineSize) Cursor {
+        std::atomic<size_t> value{0};
+    };
+
+    std::atomic_ref<uint32_t> headerAt(size_t offset) const {
+        return std::atomic_ref<uint32_t>(*reinterpret_cast<uint32_t*>(storage_.get() + offset));
+    }
+
+    /// Claims record bytes, prefixed by a wrap marker when they would straddle the end
+    std::optional<size_t> claim(size_t record) {
+        detail::checkRingRecord(record, capacity_);
+        size_t head = head_.value.load(std::memory_order_relaxed);
+        for (;;) {
+            const size_t offset = head & mask_;
+            const size_t skip = offset + record > capacity_ ? capacity_ - offset : 0;
+            const size_t tail = tail_.value.load(std::memory_order_acquire);
+            if (head + skip + record - tail > capacity_) return std::nullopt;
+            if (head_.value.compare_exchange_weak(head, head + skip + record, std::memory_order_relaxed)) {
+                if (skip > 0) {
+                    headerAt(offset).store(detail::kRingWrapMarker, std::memory_order_release);
+                }
+                return head + skip;
+            }
+        }
+    }
+
+    template<typename T>
+    static void emplace(uint8_t*& cursor, const T& message) {
+        const size_t size = encodedSize(message);
+        Reservation slot(cursor, size);
+        serializeInto(message, slot.data());
+        slot.commit();
+        cursor += detail::ringRecordSize(size);
+    }
+
+    /// Zeroes consumed space so stale headers never look committed, then hands it back
+    void release(size_t position) {
+        if (position == consumed_) return;
+        size_t from = consumed_ & mask_;
+        size_t remaining = position - consumed_;
+        while (remaining > 0) {
+            const size_t chunk = std::min(remaining, capacity_ - from);
+            std::memset(storage_.get() + from, 0, chunk);
+            remaining -= chunk;
+            from = 0;
+        }
+        consumed_ = position;
+        tail_.value.store(position, std::memory_order_release);
+    }
+
+    detail::RingStorage storage_;
+    size_t capacity_;
+    size_t mask_;
+
+    Cursor head_;
+    Cursor tail_;
+    // Consumer-local state
+    alignas(detail::kCacheLineSize) size_t consumed_ = 0;
+};
+
+} // namespace binaryprotocol
+
+#endif // BINARY_PROTOCOL_MESSAGE_RING_HPP
\ No newline at end of file
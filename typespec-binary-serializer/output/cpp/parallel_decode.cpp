@@ -0,0 +1,262 @@
+/**
+ * Auto-generated parallel decoder implementation
+ */
+
+#include "parallel_decode.hpp"
+
+#include <algorithm>
+#include <queue>
+#include <stdexcept>
+
+namespace binaryprotocol {
+
+namespace {
+
+constexpr size_t HEADER_SIZE = ProtocolHeader::ENCODED_SIZE;
+
+constexpr uint64_t pack(uint64_t begin, uint64_t end) { return begin << 32 | end; }
+
+} // namespace
+
+// ============================================
+// WorkStealingPool
+// ============================================
+
+WorkStealingPool::WorkStealingPool(unsigned threads)
+    : workers_(threads != 0 ? threads : std::max(1u, std::thread::hardware_concurrency())),
+      ranges_(std::make_unique<Range[]>(workers_)) {
+    threads_.reserve(workers_ - 1);
+    for (unsigned worker = 1; worker < workers_; worker++) {
+        threads_.emplace_back([this, worker] { workerLoop(worker); });
+    }
+}
+
+WorkStealingPool::~WorkStealingPool() {
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        stop_ = true;
+    }
+    wake_.notify_all();
+    for (std::thread& thread : threads_) {
+        thread.join();
+    }
+}
+
+void WorkStealingPool::run(size_t count, const std::function<void(size_t, unsigned)>& task) {
+    if (count == 0) return;
+    if (count > UINT32_MAX) BINARY_PROTOCOL_THROW(std::length_error("Too many tasks for WorkStealingPool"));
+
+    for (unsigned worker = 0; worker < workers_; worker++) {
+        const uint64_t begin = count * worker / workers_;
+        const uint64_t end = count * (worker + 1) / workers_;
+        ranges_[worker].bounds.store(pack(begin, end), std::memory_order_relaxed);
+    }
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        task_ = &task;
+        running_ = workers_ - 1;
+        generation_++;
+    }
+    wake_.notify_all();
+
+    drain(0);
+
+    std::unique_lock<std::mutex> lock(mutex_);
+    done_.wait(lock, [this] { return running_ == 0; });
+    task_ = nullptr;
+}
+
+void WorkStealingPool::workerLoop(unsigned worker) {
+    uint64_t seen = 0;
+    for (;;) {
+        {
+            std::unique_lock<std::mutex> lock(mutex_);
+            wake_.wait(lock, [&] { return stop_ || generation_ != seen; });
+            if (stop_) return;
+            seen = generation_;
+        }
+        drain(worker);
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            if (--running_ == 0) done_.notify_one();
+        }
+    }
+}
+
+void WorkStealingPool::drain(unsigned worker) {
+    size_t index;
+    for (;;) {
+        while (take(worker, index)) {
+            (*task_)(index, worker);
+        }
+        if (!steal(worker)) return;
+    }
+}
+
+bool WorkStealingPool::take(unsigned worker, size_t& index) {
+    std::atomic<uint64_t>& bounds = ranges_[worker].bounds;
+    uint64_t current = bounds.load(std::memory_order_acquire);
+    for (;;) {
+        const uint64_t begin = current >> 32;
+        const uint64_t end = current & UINT32_MAX;
+        if (begin >= end) return false;
+        if (bounds.compare_exchange_weak(current, pack(begin + 1, end), std::memory_order_acq_rel)) {
+            index = begin;
+            return true;
+        }
+    }
+}
+
+bool WorkStealingPool::steal(unsigned thief) {
+    for (unsigned step = 1; step < workers_; step++) {
+        std::atomic<uint64_t>& bounds = ranges_[(thief + step) % workers_].bounds;
+        uint64_t current = bounds.load(std::memory_order_acquire);
+        for (;;) {
+            const uint64_t begin = current >> 32;
+            const uint64_t end = current & UINT32_MAX;
+            if (begin >= end) break;
+            // Take the back half, leaving the victim the tasks next to the ones it is running
+            const uint64_t split = end - (end - begin + 1) / 2;
+            if (bounds.compare_exchange_weak(current, pack(begin, split), std::memory_order_acq_rel)) {
+                ranges_[thief].bounds.store(pack(split, end), std::memory_order_release);
+                return true;
+            }
+        }
+    }
+    return false;
+}
+
+// ============================================
+// Frame scan
+// ============================================
+
+FrameScan scanFrames(std::span<const uint8_t> buffer, uint32_t maxPayload) {
+    FrameScan scan;
+    size_t offset = 0;
+    while (buffer.size() - offset >= HEADER_SIZE) {
+        const ProtocolHeader header = deserializeProtocolHeader(buffer.data() + offset, HEADER_SIZE);
+        if (header.magic != ProtocolHeader::MAGIC || header.payload_length > maxPayload) {
+            // Same search as FrameDecoder's resync; a magic number cut off at the end leaves a trailing partial frame
+            const size_t next = detail::findFrameMagic(buffer, offset + 1);
+            scan.skippedBytes += next - offset;
+            offset = next;
+            continue;
+        }
+        const size_t size = HEADER_SIZE + header.payload_length;
+        if (size > buffer.size() - offset) break;
+        scan.frames.push_back({header, offset});
+        offset += size;
+    }
+    scan.end = offset;
+    return scan;
+}
+
+// ============================================
+// ParallelDecoder
+// ============================================
+
+ParallelDecoder::ParallelDecoder(ParallelDecodeOptions options)
+    : options_(options), pool_(options.threads), workers_(pool_.size()) {
+    if (options_.framesPerBatch == 0) BINARY_PROTOCOL_THROW(std::invalid_argument("framesPerBatch must be positive"));
+}
+
+void ParallelDecoder::decodeRange(std::span<const uint8_t> buffer, std::span<const FrameRef> frames,
+                                  std::vector<DecodedFrame>& out, ParallelDecodeStats& stats) const {
+    for (const FrameRef& ref : frames) {
+        if (options_.verifyChecksums && !verifyFrame(buffer.subspan(ref.offset, HEADER_SIZE + ref.header.payload_length))) {
+            stats.corrupt++;
+            continue;
+        }
+        const std::span<const uint8_t> payload = buffer.subspan(ref.offset + HEADER_SIZE, ref.header.payload_length);
+        DecodeResult<Message> message = tryDecodeMessage(ref.header.command_id, payload);
+        if (!message) {
+            stats.malformed++;
+            continue;
+        }
+        out.push_back({ref.header, std::move(*message)});
+        stats.frames++;
+    }
+}
+
+ParallelDecodeStats ParallelDecoder::decode(std::span<const uint8_t> buffer, const BatchFn& fn, DeliveryOrder order) {
+    const FrameScan scan = scanFrames(buffer, options_.maxPayload);
+    const std::span<const FrameRef> frames = scan.frames;
+    const size_t batch = options_.framesPerBatch;
+    const size_t taskCount = (frames.size() + batch - 1) / batch;
+
+    for (WorkerState& worker : workers_) {
+        worker.stats = {};
+    }
+
+    if (order == DeliveryOrder::Unordered) {
+        pool_.run(taskCount, [&](size_t task, unsigned index) {
+            WorkerState& worker = workers_[index];
+            worker.batch.clear();
+            decodeRange(buffer, frames.subspan(task * batch, std::min(batch, frames.size() - task * batch)),
+                        worker.batch, worker.stats);
+            if (!worker.batch.empty()) fn(worker.batch);
+        });
+    } else {
+        tasks_.resize(taskCount);
+        pool_.run(taskCount, [&](size_t task, unsigned index) {
+            std::vector<DecodedFrame>& out = tasks_[task];
+            out.clear();
+            decodeRange(buffer, frames.subspan(task * batch, std::min(batch, frames.size() - task * batch)),
+                        out, workers_[index].stats);
+            // Usually already in order; sorting here keeps the merge on the caller cheap
+            auto bySequence = [](const DecodedFrame& a, const DecodedFrame& b) {
+                return a.header.sequence_id < b.header.sequence_id;
+            };
+            if (!std::is_sorted(out.begin(), out.end(), bySequence)) {
+                std::stable_sort(out.begin(), out.end(), bySequence);
+            }
+        });
+        deliverInSequence(fn);
+    }
+
+    ParallelDecodeStats total;
+    for (const WorkerState& worker : workers_) {
+        total.frames += worker.stats.frames;
+        total.malformed += worker.stats.malformed;
+        total.corrupt += worker.stats.corrupt;
+    }
+    total.skippedBytes = scan.skippedBytes;
+    total.trailingBytes = buffer.size() - scan.end;
+    return total;
+}
+
+void ParallelDecoder::deliverInSequence(const BatchFn& fn) {
+    // k-way merge of the per-task results; ties keep task (file) order
+    struct Cursor {
+        decltype(ProtocolHeader::sequence_id) sequence;
+        size_t task;
+        size_t position;
+        bool operator>(const Cursor& other) const {
+            return sequence != other.sequence ? sequence > other.sequence : task > other.task;
+        }
+    };
+    std::priority_queue<Cursor, std::vector<Cursor>, std::greater<Cursor>> heap;
+    for (size_t task = 0; task < tasks_.size(); task++) {
+        if (!tasks_[task].empty()) heap.push({tasks_[task][0].header.sequence_id, task, 0});
+    }
+
+    std::vector<DecodedFrame>& staging = workers_[0].batch;
+    staging.clear();
+    while (!heap.empty()) {
+        const Cursor cursor = heap.top();
+        heap.pop();
+        std::vector<DecodedFrame>& source = tasks_[cursor.task];
+        staging.push_back(std::move(source[cursor.position]));
+        if (cursor.position + 1 < source.size()) {
+            heap.push({source[cursor.position + 1].header.sequence_id, cursor.task, cursor.position + 1});
+        }
+        if (staging.size() == options_.framesPerBatch) {
+            fn(staging);
+            staging.clear();
+        }
+    }
+    if (!staging.empty()) fn(staging);
+    staging.clear();
+}
+
+} // namespace binaryprotocol
\ No newline at end of file
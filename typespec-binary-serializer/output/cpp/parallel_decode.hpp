@@ -0,0 +1,159 @@
+/**
+ * Auto-generated parallel decoder for large ProtocolHeader-framed buffers
+ */
+
+#ifndef BINARY_PROTOCOL_PARALLEL_DECODE_HPP
+#define BINARY_PROTOCOL_PARALLEL_DECODE_HPP
+
+#include "frame_decoder.hpp"
+#include "protocol.hpp"
+
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <span>
+#include <thread>
+#include <vector>
+
+namespace binaryprotocol {
+
+/**
+ * Fixed set of worker threads running index-range jobs with work stealing.
+ *
+ * run() splits [0, count) evenly over the workers. Each worker takes tasks
+ * from the front of its own range; a worker that runs dry steals the back
+ * half of another worker's range. Ranges are single atomic words, so taking
+ * and stealing are one CAS each and the pool never locks per task.
+ */
+class WorkStealingPool {
+public:
+    /// threads == 0 uses std::thread::hardware_concurrency(); the caller of run() counts as one
+    explicit WorkStealingPool(unsigned threads = 0);
+    ~WorkStealingPool();
+
+    WorkStealingPool(const WorkStealingPool&) = delete;
+    WorkStealingPool& operator=(const WorkStealingPool&) = delete;
+
+    unsigned size() const { return workers_; }
+
+    /// Runs task(index, worker) for every index in [0, count) and returns when all are done.
+    /// worker is in [0, size()) and unique among concurrently running tasks; task must not throw.
+    void run(size_t count, const std::function<void(size_t, unsigned)>& task);
+
+private:
+    // [begin, end) packed as begin << 32 | end
+    struct alignas(64) Range {
+        std::atomic<uint64_t> bounds{0};
+    };
+
+    void workerLoop(unsigned worker);
+    void drain(unsigned worker);
+    bool take(unsigned worker, size_t& index);
+    bool steal(unsigned thief);
+
+    unsigned workers_;
+    std::unique_ptr<Range[]> ranges_;
+    std::vector<std::thread> threads_;
+
+    std::mutex mutex_;
+    std::condition_variable wake_;
+    std::condition_variable done_;
+    const std::function<void(size_t, unsigned)>* task_ = nullptr;
+    uint64_t generation_ = 0;
+    unsigned running_ = 0;
+    bool stop_ = false;
+};
+
+/// Location of one frame found by the header scan
+struct FrameRef {
+    ProtocolHeader header;
+    /// Offset of the frame (its ProtocolHeader) in the scanned buffer
+    uint64_t offset;
+};
+
+struct FrameScan {
+    std::vector<FrameRef> frames;
+    /// Bytes skipped while resynchronising after a bad magic number or oversized payload_length
+    uint64_t skippedBytes = 0;
+    /// Offset just past the last complete frame; a trailing partial frame is not included
+    uint64_t end = 0;
+};
+
+/// Sequential pass over headers only, following payload_length from frame to frame
+FrameScan scanFrames(std::span<const uint8_t> buffer, uint32_t maxPayload = FrameDecoder::DEFAULT_MAX_PAYLOAD);
+
+struct DecodedFrame {
+    ProtocolHeader header;
+    Message message;
+};
+
+enum class DeliveryOrder : uint8_t {
+    /// Batches go to the callback on worker threads as soon as they are decoded
+    Unordered,
+    /// Frames go to the callback on the calling thread in ascending sequence_id
+    Sequence,
+};
+
+struct ParallelDecodeOptions {
+    /// Worker threads including the caller; 0 uses std::thread::hardware_concurrency()
+    unsigned threads = 0;
+    /// Frames per task, and the largest batch handed to the callback
+    size_t framesPerBatch = 1024;
+    /// Larger payload_length values are treated as corruption and skipped by resynchronising
+    uint32_t maxPayload = FrameDecoder::DEFAULT_MAX_PAYLOAD;
+    /// Drop frames whose checksum does not match (counted as corrupt)
+    bool verifyChecksums = true;
+};
+
+struct ParallelDecodeStats {
+    uint64_t frames = 0;
+    /// Frames whose payload failed tryDecodeMessage()
+    uint64_t malformed = 0;
+    /// Frames dropped by checksum verification
+    uint64_t corrupt = 0;
+    uint64_t skippedBytes = 0;
+    /// Bytes of an incomplete final frame
+    uint64_t trailingBytes = 0;
+};
+
+/**
+ * Decodes every frame of a large buffer (a capture, an uploaded log) on a
+ * work-stealing pool. Each worker decodes into its own reusable batch, so
+ * workers share nothing but the read-only input. Payloads are decoded with
+ * tryDecodeMessage(), so malformed frames are counted instead of thrown.
+ */
+class ParallelDecoder {
+public:
+    using BatchFn = std::function<void(std::span<DecodedFrame>)>;
+
+    explicit ParallelDecoder(ParallelDecodeOptions options = {});
+
+    /// Decodes buffer and passes the frames to fn in batches; see DeliveryOrder for where fn runs
+    ParallelDecodeStats decode(std::span<const uint8_t> buffer, const BatchFn& fn,
+                               DeliveryOrder order = DeliveryOrder::Unordered);
+
+    unsigned threads() const { return pool_.size(); }
+
+private:
+    struct alignas(64) WorkerState {
+        std::vector<DecodedFrame> batch;
+        ParallelDecodeStats stats;
+    };
+
+    void decodeRange(std::span<const uint8_t> buffer, std::span<const FrameRef> frames,
+                     std::vector<DecodedFrame>& out, ParallelDecodeStats& stats) const;
+    void deliverInSequence(const BatchFn& fn);
+
+    ParallelDecodeOptions options_;
+    WorkStealingPool pool_;
+    std::vector<WorkerState> workers_;
+    /// Per-task results kept for ordered delivery
+    std::vector<std::vector<DecodedFrame>> tasks_;
+};
+
+} // namespace binaryprotocol
+
+#endif // BINARY_PROTOCOL_PARALLEL_DECODE_HPP
\ No newline at end of file
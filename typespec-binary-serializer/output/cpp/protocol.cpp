@@ -3,243 +3,504 @@
  */
 
 #include "protocol.hpp"
+#include "instrumentation.hpp"
 
 namespace binaryprotocol {
 
-// BinaryWriter implementation
-void BinaryWriter::writeUint8(uint8_t value) {
-    buffer_.push_back(value);
-}
-
-void BinaryWriter::writeUint16(uint16_t value) {
-    buffer_.push_back(value & 0xFF);
-    buffer_.push_back((value >> 8) & 0xFF);
-}
-
-void BinaryWriter::writeUint32(uint32_t value) {
-    buffer_.push_back(value & 0xFF);
-    buffer_.push_back((value >> 8) & 0xFF);
-    buffer_.push_back((value >> 16) & 0xFF);
-    buffer_.push_back((value >> 24) & 0xFF);
-}
+namespace {
 
-void BinaryWriter::writeUint64(uint64_t value) {
-    for (int i = 0; i < 8; i++) {
-        buffer_.push_back((value >> (i * 8)) & 0xFF);
+// Fixed-stride SensorData array codec; callers validate the byte length
+void encodeSensorDataArray(std::span<const SensorData> elements, uint8_t* out) {
+    for (const SensorData& element : elements) {
+        detail::store<Endian::Little>(out + 0, element.timestamp);
+        detail::store<Endian::Little>(out + 8, element.sensor_id);
+        detail::store<Endian::Little>(out + 9, std::bit_cast<uint32_t>(float{element.position.x}));
+        detail::store<Endian::Little>(out + 13, std::bit_cast<uint32_t>(float{element.position.y}));
+        detail::store<Endian::Little>(out + 17, std::bit_cast<uint32_t>(float{element.position.z}));
+        detail::store<Endian::Little>(out + 21, std::bit_cast<uint32_t>(float{element.temperature}));
+        detail::store<Endian::Little>(out + 25, std::bit_cast<uint32_t>(float{element.humidity}));
+        out += SensorData::ENCODED_SIZE;
     }
 }
 
-void BinaryWriter::writeInt8(int8_t value) {
-    writeUint8(static_cast<uint8_t>(value));
-}
-
-void BinaryWriter::writeInt16(int16_t value) {
-    writeUint16(static_cast<uint16_t>(value));
+void decodeSensorDataArray(const uint8_t* in, std::span<SensorData> elements) {
+    for (SensorData& element : elements) {
+        element.timestamp = detail::load<Endian::Little, uint64_t>(in + 0);
+        element.sensor_id = detail::load<Endian::Little, uint8_t>(in + 8);
+        element.position.x = std::bit_cast<float>(detail::load<Endian::Little, uint32_t>(in + 9));
+        element.position.y = std::bit_cast<float>(detail::load<Endian::Little, uint32_t>(in + 13));
+        element.position.z = std::bit_cast<float>(detail::load<Endian::Little, uint32_t>(in + 17));
+        element.temperature = std::bit_cast<float>(detail::load<Endian::Little, uint32_t>(in + 21));
+        element.humidity = std::bit_cast<float>(detail::load<Endian::Little, uint32_t>(in + 25));
+        in += SensorData::ENCODED_SIZE;
+    }
 }
 
-void BinaryWriter::writeInt32(int32_t value) {
-    writeUint32(static_cast<uint32_t>(value));
+constexpr bool isValidEndian(uint8_t value) {
+    switch (value) {
+    case 0:
+    case 1:
+        return true;
+    default:
+        return false;
+    }
 }
 
-void BinaryWriter::writeInt64(int64_t value) {
-    writeUint64(static_cast<uint64_t>(value));
+constexpr bool isValidDeviceStatus(uint8_t value) {
+    switch (value) {
+    case 0:
+    case 1:
+    case 2:
+    case 3:
+        return true;
+    default:
+        return false;
+    }
 }
 
-void BinaryWriter::writeFloat32(float value) {
-    uint32_t bits;
-    std::memcpy(&bits, &value, sizeof(bits));
-    writeUint32(bits);
+constexpr bool isValidErrorCode(uint8_t value) {
+    switch (value) {
+    case 0:
+    case 1:
+    case 2:
+    case 3:
+    case 4:
+    case 255:
+        return true;
+    default:
+        return false;
+    }
 }
 
-void BinaryWriter::writeFloat64(double value) {
-    uint64_t bits;
-    std::memcpy(&bits, &value, sizeof(bits));
-    writeUint64(bits);
-}
+/**
+ * Compact SensorData array: varint element count, then one column per field.
+ * Integer columns hold zigzag varint deltas from the previous element; float
+ * columns hold the varint of the IEEE bits XORed with the previous element's,
+ * so repeated or slowly changing readings take one or a few bytes.
+ */
+constexpr size_t COMPACT_SENSORDATA_MAX_SIZE = 37;
 
-void BinaryWriter::writeBool(bool value) {
-    writeUint8(value ? 1 : 0);
+constexpr size_t compactSensorDataArrayBound(size_t count) {
+    return detail::MAX_VARINT_SIZE + count * COMPACT_SENSORDATA_MAX_SIZE;
 }
 
-void BinaryWriter::writeBytes(const uint8_t* data, size_t size) {
-    buffer_.insert(buffer_.end(), data, data + size);
+/// Encodes rows at out, which needs compactSensorDataArrayBound(rows.size()) bytes; returns the end
+uint8_t* encodeCompactSensorDataArray(const std::vector<SensorData>& rows, uint8_t* out) {
+    out = detail::writeVarint(out, rows.size());
+    {
+        uint64_t previous = 0;
+        for (const auto& row : rows) {
+            const uint64_t value = static_cast<uint64_t>(row.timestamp);
+            out = detail::writeVarint(out, detail::zigzag(static_cast<int64_t>(value - previous)));
+            previous = value;
+        }
+    }
+    {
+        uint64_t previous = 0;
+        for (const auto& row : rows) {
+            const uint64_t value = static_cast<uint64_t>(row.sensor_id);
+            out = detail::writeVarint(out, detail::zigzag(static_cast<int64_t>(value - previous)));
+            previous = value;
+        }
+    }
+    {
+        uint32_t previous = 0;
+        for (const auto& row : rows) {
+            const uint32_t bits = std::bit_cast<uint32_t>(float{row.position.x});
+            out = detail::writeVarint(out, bits ^ previous);
+            previous = bits;
+        }
+    }
+    {
+        uint32_t previous = 0;
+        for (const auto& row : rows) {
+            const uint32_t bits = std::bit_cast<uint32_t>(float{row.position.y});
+            out = detail::writeVarint(out, bits ^ previous);
+            previous = bits;
+        }
+    }
+    {
+        uint32_t previous = 0;
+        for (const auto& row : rows) {
+            const uint32_t bits = std::bit_cast<uint32_t>(float{row.position.z});
+            out = detail::writeVarint(out, bits ^ previous);
+            previous = bits;
+        }
+    }
+    {
+        uint32_t previous = 0;
+        for (const auto& row : rows) {
+            const uint32_t bits = std::bit_cast<uint32_t>(float{row.temperature});
+            out = detail::writeVarint(out, bits ^ previous);
+            previous = bits;
+        }
+    }
+    {
+        uint32_t previous = 0;
+        for (const auto& row : rows) {
+            const uint32_t bits = std::bit_cast<uint32_t>(float{row.humidity});
+            out = detail::writeVarint(out, bits ^ previous);
+            previous = bits;
+        }
+    }
+    return out;
 }
 
-void BinaryWriter::writeBytes(const std::vector<uint8_t>& data) {
-    buffer_.insert(buffer_.end(), data.begin(), data.end());
+std::optional<DecodeError> decodeCompactSensorDataArray(std::span<const uint8_t> bytes, std::vector<SensorData>& out) {
+    const uint8_t* in = bytes.data();
+    const uint8_t* const end = in + bytes.size();
+    uint64_t value;
+    if (!detail::readVarint(in, end, value)) return DecodeError::Truncated;
+    // Every element takes at least one byte per column
+    if (value > static_cast<uint64_t>(end - in) / 7) return DecodeError::BadArrayLength;
+    const size_t count = static_cast<size_t>(value);
+    out.resize(count);
+    {
+        uint64_t previous = 0;
+        for (size_t i = 0; i < count; i++) {
+            if (!detail::readVarint(in, end, value)) return DecodeError::BadVarint;
+            previous += static_cast<uint64_t>(detail::unzigzag(value));
+            out[i].timestamp = previous;
+        }
+    }
+    {
+        uint64_t previous = 0;
+        for (size_t i = 0; i < count; i++) {
+            if (!detail::readVarint(in, end, value)) return DecodeError::BadVarint;
+            previous += static_cast<uint64_t>(detail::unzigzag(value));
+            if (previous > std::numeric_limits<uint8_t>::max()) return DecodeError::BadVarint;
+            out[i].sensor_id = static_cast<uint8_t>(previous);
+        }
+    }
+    {
+        uint32_t previous = 0;
+        for (size_t i = 0; i < count; i++) {
+            if (!detail::readVarint(in, end, value)) return DecodeError::BadVarint;
+            if (value > std::numeric_limits<uint32_t>::max()) return DecodeError::BadVarint;
+            previous ^= static_cast<uint32_t>(value);
+            out[i].position.x = std::bit_cast<float>(previous);
+        }
+    }
+    {
+        uint32_t previous = 0;
+        for (size_t i = 0; i < count; i++) {
+            if (!detail::readVarint(in, end, value)) return DecodeError::BadVarint;
+            if (value > std::numeric_limits<uint32_t>::max()) return DecodeError::BadVarint;
+            previous ^= static_cast<uint32_t>(value);
+            out[i].position.y = std::bit_cast<float>(previous);
+        }
+    }
+    {
+        uint32_t previous = 0;
+        for (size_t i = 0; i < count; i++) {
+            if (!detail::readVarint(in, end, value)) return DecodeError::BadVarint;
+            if (value > std::numeric_limits<uint32_t>::max()) return DecodeError::BadVarint;
+            previous ^= static_cast<uint32_t>(value);
+            out[i].position.z = std::bit_cast<float>(previous);
+        }
+    }
+    {
+        uint32_t previous = 0;
+        for (size_t i = 0; i < count; i++) {
+            if (!detail::readVarint(in, end, value)) return DecodeError::BadVarint;
+            if (value > std::numeric_limits<uint32_t>::max()) return DecodeError::BadVarint;
+            previous ^= static_cast<uint32_t>(value);
+            out[i].temperature = std::bit_cast<float>(previous);
+        }
+    }
+    {
+        uint32_t previous = 0;
+        for (size_t i = 0; i < count; i++) {
+            if (!detail::readVarint(in, end, value)) return DecodeError::BadVarint;
+            if (value > std::numeric_limits<uint32_t>::max()) return DecodeError::BadVarint;
+            previous ^= static_cast<uint32_t>(value);
+            out[i].humidity = std::bit_cast<float>(previous);
+        }
+    }
+    if (in != end) return DecodeError::BadArrayLength;
+    return std::nullopt;
 }
 
-// BinaryReader implementation
-BinaryReader::BinaryReader(const uint8_t* data, size_t size)
-    : data_(data), size_(size), offset_(0) {}
-
-uint8_t BinaryReader::readUint8() {
-    if (offset_ + 1 > size_) throw std::runtime_error("Buffer underflow");
-    return data_[offset_++];
-}
+} // namespace
 
-uint16_t BinaryReader::readUint16() {
-    if (offset_ + 2 > size_) throw std::runtime_error("Buffer underflow");
-    uint16_t value = data_[offset_] | (data_[offset_ + 1] << 8);
-    offset_ += 2;
-    return value;
+SensorDataArrayView::SensorDataArrayView(std::span<const uint8_t> bytes)
+    : bytes_(bytes) {
+    if (bytes.size() % SensorData::ENCODED_SIZE != 0) {
+        BINARY_PROTOCOL_THROW(std::runtime_error("Invalid SensorData array length"));
+    }
 }
 
-uint32_t BinaryReader::readUint32() {
-    if (offset_ + 4 > size_) throw std::runtime_error("Buffer underflow");
-    uint32_t value = data_[offset_] | (data_[offset_ + 1] << 8) |
-                     (data_[offset_ + 2] << 16) | (data_[offset_ + 3] << 24);
-    offset_ += 4;
-    return value;
+SensorData SensorDataArrayView::operator[](size_t index) const {
+    const uint8_t* element = bytes_.data() + index * SensorData::ENCODED_SIZE;
+    return deserializeSensorData(element, SensorData::ENCODED_SIZE);
 }
 
-uint64_t BinaryReader::readUint64() {
-    if (offset_ + 8 > size_) throw std::runtime_error("Buffer underflow");
-    uint64_t value = 0;
-    for (int i = 0; i < 8; i++) {
-        value |= static_cast<uint64_t>(data_[offset_ + i]) << (i * 8);
+size_t serializeInto(const ProtocolHeader& data, std::span<uint8_t> out) {
+    const size_t size = encodedSize(data);
+    if (out.size() < size) BINARY_PROTOCOL_THROW(std::runtime_error("Buffer overflow"));
+    if constexpr (kNativeEndian == Endian::Little) {
+        std::memcpy(out.data(), &data, size);
+    } else {
+        SpanWriter writer(out);
+        writer.writeUint16(data.magic);
+        writer.writeUint8(data.version);
+        writer.writeUint8(data.command_id);
+        writer.writeUint32(data.payload_length);
+        writer.writeUint32(data.sequence_id);
+        writer.writeUint16(data.checksum);
     }
-    offset_ += 8;
-    return value;
-}
-
-int8_t BinaryReader::readInt8() {
-    return static_cast<int8_t>(readUint8());
+    return size;
 }
 
-int16_t BinaryReader::readInt16() {
-    return static_cast<int16_t>(readUint16());
+std::vector<uint8_t> serialize(const ProtocolHeader& data) {
+    std::vector<uint8_t> buffer(encodedSize(data));
+    serializeInto(data, buffer);
+    return buffer;
 }
 
-int32_t BinaryReader::readInt32() {
-    return static_cast<int32_t>(readUint32());
+ProtocolHeader deserializeProtocolHeader(const uint8_t* data, size_t size) {
+    if constexpr (kNativeEndian == Endian::Little) {
+        if (size < ProtocolHeader::ENCODED_SIZE) BINARY_PROTOCOL_THROW(std::runtime_error("Buffer underflow"));
+        ProtocolHeader result;
+        std::memcpy(&result, data, ProtocolHeader::ENCODED_SIZE);
+        return result;
+    } else {
+        BinaryReader reader(data, size);
+        ProtocolHeader result{};
+        result.magic = reader.readUint16();
+        result.version = reader.readUint8();
+        result.command_id = reader.readUint8();
+        result.payload_length = reader.readUint32();
+        result.sequence_id = reader.readUint32();
+        result.checksum = reader.readUint16();
+        return result;
+    }
 }
 
-int64_t BinaryReader::readInt64() {
-    return static_cast<int64_t>(readUint64());
+DecodeResult<ProtocolHeader> tryDeserializeProtocolHeader(const uint8_t* data, size_t size) {
+    if (size < ProtocolHeader::ENCODED_SIZE) return DecodeError::Truncated;
+    ProtocolHeader result;
+    if constexpr (kNativeEndian == Endian::Little) {
+        std::memcpy(&result, data, ProtocolHeader::ENCODED_SIZE);
+    } else {
+        result.magic = detail::load<Endian::Little, uint16_t>(data + 0);
+        result.version = detail::load<Endian::Little, uint8_t>(data + 2);
+        result.command_id = detail::load<Endian::Little, uint8_t>(data + 3);
+        result.payload_length = detail::load<Endian::Little, uint32_t>(data + 4);
+        result.sequence_id = detail::load<Endian::Little, uint32_t>(data + 8);
+        result.checksum = detail::load<Endian::Little, uint16_t>(data + 12);
+    }
+    return result;
 }
 
-float BinaryReader::readFloat32() {
-    uint32_t bits = readUint32();
-    float value;
-    std::memcpy(&value, &bits, sizeof(value));
-    return value;
+size_t serializeInto(const PingCommand& data, std::span<uint8_t> out) {
+    BINARY_PROTOCOL_PROBE(Encode, PingCommand::COMMAND_ID, encodedSize(data));
+    const size_t size = encodedSize(data);
+    if (out.size() < size) BINARY_PROTOCOL_THROW(std::runtime_error("Buffer overflow"));
+    if constexpr (kNativeEndian == Endian::Little) {
+        std::memcpy(out.data(), &data, size);
+    } else {
+        SpanWriter writer(out);
+        writer.writeUint64(data.timestamp);
+    }
+    return size;
 }
 
-double BinaryReader::readFloat64() {
-    uint64_t bits = readUint64();
-    double value;
-    std::memcpy(&value, &bits, sizeof(value));
-    return value;
+std::vector<uint8_t> serialize(const PingCommand& data) {
+    std::vector<uint8_t> buffer(encodedSize(data));
+    serializeInto(data, buffer);
+    return buffer;
 }
 
-bool BinaryReader::readBool() {
-    return readUint8() != 0;
+PingCommand deserializePingCommand(const uint8_t* data, size_t size) {
+    BINARY_PROTOCOL_PROBE(Decode, PingCommand::COMMAND_ID, size);
+    if constexpr (kNativeEndian == Endian::Little) {
+        if (size < PingCommand::ENCODED_SIZE) BINARY_PROTOCOL_THROW(std::runtime_error("Buffer underflow"));
+        PingCommand result;
+        std::memcpy(&result, data, PingCommand::ENCODED_SIZE);
+        return result;
+    } else {
+        BinaryReader reader(data, size);
+        PingCommand result{};
+        result.timestamp = reader.readUint64();
+        return result;
+    }
 }
 
-std::vector<uint8_t> BinaryReader::readBytes(size_t length) {
-    if (offset_ + length > size_) throw std::runtime_error("Buffer underflow");
-    std::vector<uint8_t> result(data_ + offset_, data_ + offset_ + length);
-    offset_ += length;
+DecodeResult<PingCommand> tryDeserializePingCommand(const uint8_t* data, size_t size) {
+    BINARY_PROTOCOL_PROBE(Decode, PingCommand::COMMAND_ID, size);
+    if (size < PingCommand::ENCODED_SIZE) return BINARY_PROTOCOL_PROBE_FAIL(DecodeError::Truncated);
+    PingCommand result;
+    if constexpr (kNativeEndian == Endian::Little) {
+        std::memcpy(&result, data, PingCommand::ENCODED_SIZE);
+    } else {
+        result.timestamp = detail::load<Endian::Little, uint64_t>(data + 0);
+    }
     return result;
 }
 
-std::vector<uint8_t> serialize(const ProtocolHeader& data) {
-    BinaryWriter writer;
-    writer.writeUint16(data.magic);
-    writer.writeUint8(data.version);
-    writer.writeUint8(data.command_id);
-    writer.writeUint32(data.payload_length);
-    writer.writeUint32(data.sequence_id);
-    writer.writeUint16(data.checksum);
-    return writer.data();
+size_t serializeInto(const PingResponse& data, std::span<uint8_t> out) {
+    BINARY_PROTOCOL_PROBE(Encode, PingResponse::COMMAND_ID, encodedSize(data));
+    const size_t size = encodedSize(data);
+    if (out.size() < size) BINARY_PROTOCOL_THROW(std::runtime_error("Buffer overflow"));
+    if constexpr (kNativeEndian == Endian::Little) {
+        std::memcpy(out.data(), &data, size);
+    } else {
+        SpanWriter writer(out);
+        writer.writeUint64(data.request_timestamp);
+        writer.writeUint64(data.response_timestamp);
+    }
+    return size;
 }
 
-ProtocolHeader deserializeProtocolHeader(const uint8_t* data, size_t size) {
-    BinaryReader reader(data, size);
-    ProtocolHeader result{};
-    result.magic = reader.readUint16();
-    result.version = reader.readUint8();
-    result.command_id = reader.readUint8();
-    result.payload_length = reader.readUint32();
-    result.sequence_id = reader.readUint32();
-    result.checksum = reader.readUint16();
-    return result;
+std::vector<uint8_t> serialize(const PingResponse& data) {
+    std::vector<uint8_t> buffer(encodedSize(data));
+    serializeInto(data, buffer);
+    return buffer;
 }
 
-std::vector<uint8_t> serialize(const PingCommand& data) {
-    BinaryWriter writer;
-    writer.writeUint64(data.timestamp);
-    return writer.data();
+PingResponse deserializePingResponse(const uint8_t* data, size_t size) {
+    BINARY_PROTOCOL_PROBE(Decode, PingResponse::COMMAND_ID, size);
+    if constexpr (kNativeEndian == Endian::Little) {
+        if (size < PingResponse::ENCODED_SIZE) BINARY_PROTOCOL_THROW(std::runtime_error("Buffer underflow"));
+        PingResponse result;
+        std::memcpy(&result, data, PingResponse::ENCODED_SIZE);
+        return result;
+    } else {
+        BinaryReader reader(data, size);
+        PingResponse result{};
+        result.request_timestamp = reader.readUint64();
+        result.response_timestamp = reader.readUint64();
+        return result;
+    }
 }
 
-PingCommand deserializePingCommand(const uint8_t* data, size_t size) {
-    BinaryReader reader(data, size);
-    PingCommand result{};
-    result.timestamp = reader.readUint64();
+DecodeResult<PingResponse> tryDeserializePingResponse(const uint8_t* data, size_t size) {
+    BINARY_PROTOCOL_PROBE(Decode, PingResponse::COMMAND_ID, size);
+    if (size < PingResponse::ENCODED_SIZE) return BINARY_PROTOCOL_PROBE_FAIL(DecodeError::Truncated);
+    PingResponse result;
+    if constexpr (kNativeEndian == Endian::Little) {
+        std::memcpy(&result, data, PingResponse::ENCODED_SIZE);
+    } else {
+        result.request_timestamp = detail::load<Endian::Little, uint64_t>(data + 0);
+        result.response_timestamp = detail::load<Endian::Little, uint64_t>(data + 8);
+    }
     return result;
 }
 
-std::vector<uint8_t> serialize(const PingResponse& data) {
-    BinaryWriter writer;
-    writer.writeUint64(data.request_timestamp);
-    writer.writeUint64(data.response_timestamp);
-    return writer.data();
-}
-
-PingResponse deserializePingResponse(const uint8_t* data, size_t size) {
-    BinaryReader reader(data, size);
-    PingResponse result{};
-    result.request_timestamp = reader.readUint64();
-    result.response_timestamp = reader.readUint64();
-    return result;
+size_t serializeInto(const GetDeviceInfoCommand& data, std::span<uint8_t> out) {
+    BINARY_PROTOCOL_PROBE(Encode, GetDeviceInfoCommand::COMMAND_ID, encodedSize(data));
+    const size_t size = encodedSize(data);
+    if (out.size() < size) BINARY_PROTOCOL_THROW(std::runtime_error("Buffer overflow"));
+    SpanWriter writer(out);
+    writer.writeBool(data.include_details);
+    return size;
 }
 
 std::vector<uint8_t> serialize(const GetDeviceInfoCommand& data) {
-    BinaryWriter writer;
-    writer.writeBool(data.include_details);
-    return writer.data();
+    std::vector<uint8_t> buffer(encodedSize(data));
+    serializeInto(data, buffer);
+    return buffer;
 }
 
 GetDeviceInfoCommand deserializeGetDeviceInfoCommand(const uint8_t* data, size_t size) {
+    BINARY_PROTOCOL_PROBE(Decode, GetDeviceInfoCommand::COMMAND_ID, size);
     BinaryReader reader(data, size);
     GetDeviceInfoCommand result{};
     result.include_details = reader.readBool();
     return result;
 }
 
+DecodeResult<GetDeviceInfoCommand> tryDeserializeGetDeviceInfoCommand(const uint8_t* data, size_t size) {
+    BINARY_PROTOCOL_PROBE(Decode, GetDeviceInfoCommand::COMMAND_ID, size);
+    if (size < GetDeviceInfoCommand::ENCODED_SIZE) return BINARY_PROTOCOL_PROBE_FAIL(DecodeError::Truncated);
+    GetDeviceInfoCommand result{};
+    result.include_details = data[0] != 0;
+    return result;
+}
+
+size_t serializeInto(const DeviceInfoResponse& data, std::span<uint8_t> out) {
+    BINARY_PROTOCOL_PROBE(Encode, DeviceInfoResponse::COMMAND_ID, encodedSize(data));
+    const size_t size = encodedSize(data);
+    if (out.size() < size) BINARY_PROTOCOL_THROW(std::runtime_error("Buffer overflow"));
+    if constexpr (kNativeEndian == Endian::Little) {
+        std::memcpy(out.data(), &data, size);
+    } else {
+        SpanWriter writer(out);
+        writer.writeUint8(static_cast<uint8_t>(data.status));
+        writer.writeFixedString(data.device_name);
+        writer.writeFixedString(data.firmware_version);
+        writer.writeUint32(data.uptime_seconds);
+        writer.writeInt16(data.temperature);
+        writer.writeUint8(data.battery_level);
+    }
+    return size;
+}
+
 std::vector<uint8_t> serialize(const DeviceInfoResponse& data) {
-    BinaryWriter writer;
-    writer.writeUint8(static_cast<uint8_t>(data.status));
-    writer.writeFixedString(data.device_name);
-    writer.writeFixedString(data.firmware_version);
-    writer.writeUint32(data.uptime_seconds);
-    writer.writeInt16(data.temperature);
-    writer.writeUint8(data.battery_level);
-    return writer.data();
+    std::vector<uint8_t> buffer(encodedSize(data));
+    serializeInto(data, buffer);
+    return buffer;
 }
 
 DeviceInfoResponse deserializeDeviceInfoResponse(const uint8_t* data, size_t size) {
-    BinaryReader reader(data, size);
-    DeviceInfoResponse result{};
-    result.status = static_cast<DeviceStatus>(reader.readUint8());
-    result.device_name = reader.readFixedString<32>();
-    result.firmware_version = reader.readFixedString<16>();
-    result.uptime_seconds = reader.readUint32();
-    result.temperature = reader.readInt16();
-    result.battery_level = reader.readUint8();
+    BINARY_PROTOCOL_PROBE(Decode, DeviceInfoResponse::COMMAND_ID, size);
+    if constexpr (kNativeEndian == Endian::Little) {
+        if (size < DeviceInfoResponse::ENCODED_SIZE) BINARY_PROTOCOL_THROW(std::runtime_error("Buffer underflow"));
+        DeviceInfoResponse result;
+        std::memcpy(&result, data, DeviceInfoResponse::ENCODED_SIZE);
+        return result;
+    } else {
+        BinaryReader reader(data, size);
+        DeviceInfoResponse result{};
+        result.status = static_cast<DeviceStatus>(reader.readUint8());
+        result.device_name = reader.readFixedString<32>();
+        result.firmware_version = reader.readFixedString<16>();
+        result.uptime_seconds = reader.readUint32();
+        result.temperature = reader.readInt16();
+        result.battery_level = reader.readUint8();
+        return result;
+    }
+}
+
+DecodeResult<DeviceInfoResponse> tryDeserializeDeviceInfoResponse(const uint8_t* data, size_t size) {
+    BINARY_PROTOCOL_PROBE(Decode, DeviceInfoResponse::COMMAND_ID, size);
+    if (size < DeviceInfoResponse::ENCODED_SIZE) return BINARY_PROTOCOL_PROBE_FAIL(DecodeError::Truncated);
+    if (!isValidDeviceStatus(data[0])) return BINARY_PROTOCOL_PROBE_FAIL(DecodeError::BadEnumValue);
+    DeviceInfoResponse result;
+    if constexpr (kNativeEndian == Endian::Little) {
+        std::memcpy(&result, data, DeviceInfoResponse::ENCODED_SIZE);
+    } else {
+        result.status = static_cast<DeviceStatus>(data[0]);
+        std::memcpy(result.device_name.data(), data + 1, 32);
+        std::memcpy(result.firmware_version.data(), data + 33, 16);
+        result.uptime_seconds = detail::load<Endian::Little, uint32_t>(data + 49);
+        result.temperature = static_cast<int16_t>(detail::load<Endian::Little, uint16_t>(data + 53));
+        result.battery_level = detail::load<Endian::Little, uint8_t>(data + 55);
+    }
     return result;
 }
 
-std::vector<uint8_t> serialize(const SendDataCommand& data) {
-    BinaryWriter writer;
+size_t serializeInto(const SendDataCommand& data, std::span<uint8_t> out) {
+    BINARY_PROTOCOL_PROBE(Encode, SendDataCommand::COMMAND_ID, encodedSize(data));
+    checkLengthPrefixes(data);
+    const size_t size = encodedSize(data);
+    if (out.size() < size) BINARY_PROTOCOL_THROW(std::runtime_error("Buffer overflow"));
+    SpanWriter writer(out);
     writer.writeUint8(data.channel);
     writer.writeUint8(data.priority);
     writer.writeLengthPrefixedBytes<uint16_t>(data.data);
-    return writer.data();
+    return size;
+}
+
+std::vector<uint8_t> serialize(const SendDataCommand& data) {
+    std::vector<uint8_t> buffer(encodedSize(data));
+    serializeInto(data, buffer);
+    return buffer;
 }
 
 SendDataCommand deserializeSendDataCommand(const uint8_t* data, size_t size) {
+    BINARY_PROTOCOL_PROBE(Decode, SendDataCommand::COMMAND_ID, size);
     BinaryReader reader(data, size);
     SendDataCommand result{};
     result.channel = reader.readUint8();
@@ -248,15 +509,59 @@ SendDataCommand deserializeSendDataCommand(const uint8_t* data, size_t size) {
     return result;
 }
 
-std::vector<uint8_t> serialize(const SendDataResponse& data) {
-    BinaryWriter writer;
+DecodeResult<SendDataCommand> tryDeserializeSendDataCommand(const uint8_t* data, size_t size) {
+    BINARY_PROTOCOL_PROBE(Decode, SendDataCommand::COMMAND_ID, size);
+    const uint8_t* in = data;
+    size_t remaining = size;
+    SendDataCommand result{};
+    if (remaining < 4) return BINARY_PROTOCOL_PROBE_FAIL(DecodeError::Truncated);
+    result.channel = detail::load<Endian::Little, uint8_t>(in + 0);
+    result.priority = detail::load<Endian::Little, uint8_t>(in + 1);
+    const size_t dataLength = detail::load<Endian::Little, uint16_t>(in + 2);
+    in += 4;
+    remaining -= 4;
+    if (remaining < dataLength) return BINARY_PROTOCOL_PROBE_FAIL(DecodeError::LengthOverflow);
+    result.data.assign(in, in + dataLength);
+    return result;
+}
+
+SendDataCommandView viewSendDataCommand(const uint8_t* data, size_t size) {
+    BinaryReader reader(data, size);
+    SendDataCommandView result{};
+    result.channel = reader.readUint8();
+    result.priority = reader.readUint8();
+    result.data = reader.readLengthPrefixedView<uint16_t>();
+    return result;
+}
+
+void serializeGather(const SendDataCommand& data, GatherList& out) {
+    checkLengthPrefixes(data);
+    uint8_t* p = out.allocate(4).data();
+    detail::store<Endian::Little>(p + 0, data.channel);
+    detail::store<Endian::Little>(p + 1, data.priority);
+    detail::store<Endian::Little>(p + 2, static_cast<uint16_t>(data.data.size()));
+    out.appendBytes(data.data);
+}
+
+size_t serializeInto(const SendDataResponse& data, std::span<uint8_t> out) {
+    BINARY_PROTOCOL_PROBE(Encode, SendDataResponse::COMMAND_ID, encodedSize(data));
+    const size_t size = encodedSize(data);
+    if (out.size() < size) BINARY_PROTOCOL_THROW(std::runtime_error("Buffer overflow"));
+    SpanWriter writer(out);
     writer.writeBool(data.success);
     writer.writeUint8(static_cast<uint8_t>(data.error_code));
     writer.writeUint32(data.bytes_written);
-    return writer.data();
+    return size;
+}
+
+std::vector<uint8_t> serialize(const SendDataResponse& data) {
+    std::vector<uint8_t> buffer(encodedSize(data));
+    serializeInto(data, buffer);
+    return buffer;
 }
 
 SendDataResponse deserializeSendDataResponse(const uint8_t* data, size_t size) {
+    BINARY_PROTOCOL_PROBE(Decode, SendDataResponse::COMMAND_ID, size);
     BinaryReader reader(data, size);
     SendDataResponse result{};
     result.success = reader.readBool();
@@ -265,15 +570,37 @@ SendDataResponse deserializeSendDataResponse(const uint8_t* data, size_t size) {
     return result;
 }
 
-std::vector<uint8_t> serialize(const SetConfigCommand& data) {
-    BinaryWriter writer;
+DecodeResult<SendDataResponse> tryDeserializeSendDataResponse(const uint8_t* data, size_t size) {
+    BINARY_PROTOCOL_PROBE(Decode, SendDataResponse::COMMAND_ID, size);
+    if (size < SendDataResponse::ENCODED_SIZE) return BINARY_PROTOCOL_PROBE_FAIL(DecodeError::Truncated);
+    if (!isValidErrorCode(data[1])) return BINARY_PROTOCOL_PROBE_FAIL(DecodeError::BadEnumValue);
+    SendDataResponse result{};
+    result.success = data[0] != 0;
+    result.error_code = static_cast<ErrorCode>(data[1]);
+    result.bytes_written = detail::load<Endian::Little, uint32_t>(data + 2);
+    return result;
+}
+
+size_t serializeInto(const SetConfigCommand& data, std::span<uint8_t> out) {
+    BINARY_PROTOCOL_PROBE(Encode, SetConfigCommand::COMMAND_ID, encodedSize(data));
+    checkLengthPrefixes(data);
+    const size_t size = encodedSize(data);
+    if (out.size() < size) BINARY_PROTOCOL_THROW(std::runtime_error("Buffer overflow"));
+    SpanWriter writer(out);
     writer.writeUint8(data.config_id);
     writer.writeUint8(data.value_type);
     writer.writeLengthPrefixedBytes<uint8_t>(data.value);
-    return writer.data();
+    return size;
+}
+
+std::vector<uint8_t> serialize(const SetConfigCommand& data) {
+    std::vector<uint8_t> buffer(encodedSize(data));
+    serializeInto(data, buffer);
+    return buffer;
 }
 
 SetConfigCommand deserializeSetConfigCommand(const uint8_t* data, size_t size) {
+    BINARY_PROTOCOL_PROBE(Decode, SetConfigCommand::COMMAND_ID, size);
     BinaryReader reader(data, size);
     SetConfigCommand result{};
     result.config_id = reader.readUint8();
@@ -282,14 +609,58 @@ SetConfigCommand deserializeSetConfigCommand(const uint8_t* data, size_t size) {
     return result;
 }
 
-std::vector<uint8_t> serialize(const SetConfigResponse& data) {
-    BinaryWriter writer;
+DecodeResult<SetConfigCommand> tryDeserializeSetConfigCommand(const uint8_t* data, size_t size) {
+    BINARY_PROTOCOL_PROBE(Decode, SetConfigCommand::COMMAND_ID, size);
+    const uint8_t* in = data;
+    size_t remaining = size;
+    SetConfigCommand result{};
+    if (remaining < 3) return BINARY_PROTOCOL_PROBE_FAIL(DecodeError::Truncated);
+    result.config_id = detail::load<Endian::Little, uint8_t>(in + 0);
+    result.value_type = detail::load<Endian::Little, uint8_t>(in + 1);
+    const size_t valueLength = detail::load<Endian::Little, uint8_t>(in + 2);
+    in += 3;
+    remaining -= 3;
+    if (remaining < valueLength) return BINARY_PROTOCOL_PROBE_FAIL(DecodeError::LengthOverflow);
+    result.value.assign(in, in + valueLength);
+    return result;
+}
+
+SetConfigCommandView viewSetConfigCommand(const uint8_t* data, size_t size) {
+    BinaryReader reader(data, size);
+    SetConfigCommandView result{};
+    result.config_id = reader.readUint8();
+    result.value_type = reader.readUint8();
+    result.value = reader.readLengthPrefixedView<uint8_t>();
+    return result;
+}
+
+void serializeGather(const SetConfigCommand& data, GatherList& out) {
+    checkLengthPrefixes(data);
+    uint8_t* p = out.allocate(3).data();
+    detail::store<Endian::Little>(p + 0, data.config_id);
+    detail::store<Endian::Little>(p + 1, data.value_type);
+    detail::store<Endian::Little>(p + 2, static_cast<uint8_t>(data.value.size()));
+    out.appendBytes(data.value);
+}
+
+size_t serializeInto(const SetConfigResponse& data, std::span<uint8_t> out) {
+    BINARY_PROTOCOL_PROBE(Encode, SetConfigResponse::COMMAND_ID, encodedSize(data));
+    const size_t size = encodedSize(data);
+    if (out.size() < size) BINARY_PROTOCOL_THROW(std::runtime_error("Buffer overflow"));
+    SpanWriter writer(out);
     writer.writeBool(data.success);
     writer.writeUint8(static_cast<uint8_t>(data.error_code));
-    return writer.data();
+    return size;
+}
+
+std::vector<uint8_t> serialize(const SetConfigResponse& data) {
+    std::vector<uint8_t> buffer(encodedSize(data));
+    serializeInto(data, buffer);
+    return buffer;
 }
 
 SetConfigResponse deserializeSetConfigResponse(const uint8_t* data, size_t size) {
+    BINARY_PROTOCOL_PROBE(Decode, SetConfigResponse::COMMAND_ID, size);
     BinaryReader reader(data, size);
     SetConfigResponse result{};
     result.success = reader.readBool();
@@ -297,14 +668,35 @@ SetConfigResponse deserializeSetConfigResponse(const uint8_t* data, size_t size)
     return result;
 }
 
-std::vector<uint8_t> serialize(const BatchCommand& data) {
-    BinaryWriter writer;
+DecodeResult<SetConfigResponse> tryDeserializeSetConfigResponse(const uint8_t* data, size_t size) {
+    BINARY_PROTOCOL_PROBE(Decode, SetConfigResponse::COMMAND_ID, size);
+    if (size < SetConfigResponse::ENCODED_SIZE) return BINARY_PROTOCOL_PROBE_FAIL(DecodeError::Truncated);
+    if (!isValidErrorCode(data[1])) return BINARY_PROTOCOL_PROBE_FAIL(DecodeError::BadEnumValue);
+    SetConfigResponse result{};
+    result.success = data[0] != 0;
+    result.error_code = static_cast<ErrorCode>(data[1]);
+    return result;
+}
+
+size_t serializeInto(const BatchCommand& data, std::span<uint8_t> out) {
+    BINARY_PROTOCOL_PROBE(Encode, BatchCommand::COMMAND_ID, encodedSize(data));
+    checkLengthPrefixes(data);
+    const size_t size = encodedSize(data);
+    if (out.size() < size) BINARY_PROTOCOL_THROW(std::runtime_error("Buffer overflow"));
+    SpanWriter writer(out);
     writer.writeUint8(data.command_count);
     writer.writeLengthPrefixedBytes<uint16_t>(data.commands);
-    return writer.data();
+    return size;
+}
+
+std::vector<uint8_t> serialize(const BatchCommand& data) {
+    std::vector<uint8_t> buffer(encodedSize(data));
+    serializeInto(data, buffer);
+    return buffer;
 }
 
 BatchCommand deserializeBatchCommand(const uint8_t* data, size_t size) {
+    BINARY_PROTOCOL_PROBE(Decode, BatchCommand::COMMAND_ID, size);
     BinaryReader reader(data, size);
     BatchCommand result{};
     result.command_count = reader.readUint8();
@@ -312,15 +704,58 @@ BatchCommand deserializeBatchCommand(const uint8_t* data, size_t size) {
     return result;
 }
 
-std::vector<uint8_t> serialize(const BatchResponse& data) {
-    BinaryWriter writer;
+DecodeResult<BatchCommand> tryDeserializeBatchCommand(const uint8_t* data, size_t size) {
+    BINARY_PROTOCOL_PROBE(Decode, BatchCommand::COMMAND_ID, size);
+    const uint8_t* in = data;
+    size_t remaining = size;
+    BatchCommand result{};
+    if (remaining < 3) return BINARY_PROTOCOL_PROBE_FAIL(DecodeError::Truncated);
+    result.command_count = detail::load<Endian::Little, uint8_t>(in + 0);
+    const size_t commandsLength = detail::load<Endian::Little, uint16_t>(in + 1);
+    in += 3;
+    remaining -= 3;
+    if (remaining < commandsLength) return BINARY_PROTOCOL_PROBE_FAIL(DecodeError::LengthOverflow);
+    if (BatchCommandEntries({in, commandsLength}).validate()) return BINARY_PROTOCOL_PROBE_FAIL(DecodeError::Truncated);
+    result.commands.assign(in, in + commandsLength);
+    return result;
+}
+
+BatchCommandView viewBatchCommand(const uint8_t* data, size_t size) {
+    BinaryReader reader(data, size);
+    BatchCommandView result{};
+    result.command_count = reader.readUint8();
+    result.commands = reader.readLengthPrefixedView<uint16_t>();
+    return result;
+}
+
+void serializeGather(const BatchCommand& data, GatherList& out) {
+    checkLengthPrefixes(data);
+    uint8_t* p = out.allocate(3).data();
+    detail::store<Endian::Little>(p + 0, data.command_count);
+    detail::store<Endian::Little>(p + 1, static_cast<uint16_t>(data.commands.size()));
+    out.appendBytes(data.commands);
+}
+
+size_t serializeInto(const BatchResponse& data, std::span<uint8_t> out) {
+    BINARY_PROTOCOL_PROBE(Encode, BatchResponse::COMMAND_ID, encodedSize(data));
+    checkLengthPrefixes(data);
+    const size_t size = encodedSize(data);
+    if (out.size() < size) BINARY_PROTOCOL_THROW(std::runtime_error("Buffer overflow"));
+    SpanWriter writer(out);
     writer.writeUint8(data.success_count);
     writer.writeUint8(data.failure_count);
     writer.writeLengthPrefixedBytes<uint16_t>(data.results);
-    return writer.data();
+    return size;
+}
+
+std::vector<uint8_t> serialize(const BatchResponse& data) {
+    std::vector<uint8_t> buffer(encodedSize(data));
+    serializeInto(data, buffer);
+    return buffer;
 }
 
 BatchResponse deserializeBatchResponse(const uint8_t* data, size_t size) {
+    BINARY_PROTOCOL_PROBE(Decode, BatchResponse::COMMAND_ID, size);
     BinaryReader reader(data, size);
     BatchResponse result{};
     result.success_count = reader.readUint8();
@@ -329,63 +764,312 @@ BatchResponse deserializeBatchResponse(const uint8_t* data, size_t size) {
     return result;
 }
 
+DecodeResult<BatchResponse> tryDeserializeBatchResponse(const uint8_t* data, size_t size) {
+    BINARY_PROTOCOL_PROBE(Decode, BatchResponse::COMMAND_ID, size);
+    const uint8_t* in = data;
+    size_t remaining = size;
+    BatchResponse result{};
+    if (remaining < 4) return BINARY_PROTOCOL_PROBE_FAIL(DecodeError::Truncated);
+    result.success_count = detail::load<Endian::Little, uint8_t>(in + 0);
+    result.failure_count = detail::load<Endian::Little, uint8_t>(in + 1);
+    const size_t resultsLength = detail::load<Endian::Little, uint16_t>(in + 2);
+    in += 4;
+    remaining -= 4;
+    if (remaining < resultsLength) return BINARY_PROTOCOL_PROBE_FAIL(DecodeError::LengthOverflow);
+    if (BatchResponseEntries({in, resultsLength}).validate()) return BINARY_PROTOCOL_PROBE_FAIL(DecodeError::Truncated);
+    result.results.assign(in, in + resultsLength);
+    return result;
+}
+
+BatchResponseView viewBatchResponse(const uint8_t* data, size_t size) {
+    BinaryReader reader(data, size);
+    BatchResponseView result{};
+    result.success_count = reader.readUint8();
+    result.failure_count = reader.readUint8();
+    result.results = reader.readLengthPrefixedView<uint16_t>();
+    return result;
+}
+
+void serializeGather(const BatchResponse& data, GatherList& out) {
+    checkLengthPrefixes(data);
+    uint8_t* p = out.allocate(4).data();
+    detail::store<Endian::Little>(p + 0, data.success_count);
+    detail::store<Endian::Little>(p + 1, data.failure_count);
+    detail::store<Endian::Little>(p + 2, static_cast<uint16_t>(data.results.size()));
+    out.appendBytes(data.results);
+}
+
+size_t serializeInto(const Vector3D& data, std::span<uint8_t> out) {
+    const size_t size = encodedSize(data);
+    if (out.size() < size) BINARY_PROTOCOL_THROW(std::runtime_error("Buffer overflow"));
+    if constexpr (kNativeEndian == Endian::Little) {
+        std::memcpy(out.data(), &data, size);
+    } else {
+        SpanWriter writer(out);
+        writer.writeFloat32(data.x);
+        writer.writeFloat32(data.y);
+        writer.writeFloat32(data.z);
+    }
+    return size;
+}
+
 std::vector<uint8_t> serialize(const Vector3D& data) {
-    BinaryWriter writer;
-    writer.writeFloat32(data.x);
-    writer.writeFloat32(data.y);
-    writer.writeFloat32(data.z);
-    return writer.data();
+    std::vector<uint8_t> buffer(encodedSize(data));
+    serializeInto(data, buffer);
+    return buffer;
 }
 
 Vector3D deserializeVector3D(const uint8_t* data, size_t size) {
-    BinaryReader reader(data, size);
-    Vector3D result{};
-    result.x = reader.readFloat32();
-    result.y = reader.readFloat32();
-    result.z = reader.readFloat32();
+    if constexpr (kNativeEndian == Endian::Little) {
+        if (size < Vector3D::ENCODED_SIZE) BINARY_PROTOCOL_THROW(std::runtime_error("Buffer underflow"));
+        Vector3D result;
+        std::memcpy(&result, data, Vector3D::ENCODED_SIZE);
+        return result;
+    } else {
+        BinaryReader reader(data, size);
+        Vector3D result{};
+        result.x = reader.readFloat32();
+        result.y = reader.readFloat32();
+        result.z = reader.readFloat32();
+        return result;
+    }
+}
+
+DecodeResult<Vector3D> tryDeserializeVector3D(const uint8_t* data, size_t size) {
+    if (size < Vector3D::ENCODED_SIZE) return DecodeError::Truncated;
+    Vector3D result;
+    if constexpr (kNativeEndian == Endian::Little) {
+        std::memcpy(&result, data, Vector3D::ENCODED_SIZE);
+    } else {
+        result.x = std::bit_cast<float>(detail::load<Endian::Little, uint32_t>(data + 0));
+        result.y = std::bit_cast<float>(detail::load<Endian::Little, uint32_t>(data + 4));
+        result.z = std::bit_cast<float>(detail::load<Endian::Little, uint32_t>(data + 8));
+    }
     return result;
 }
 
-std::vector<uint8_t> serialize(const SensorData& data) {
-    BinaryWriter writer;
-    writer.writeUint64(data.timestamp);
-    writer.writeUint8(data.sensor_id);
-    {
-        auto nested = serialize(data.position);
-        writer.writeBytes(nested);
+size_t serializeInto(const SensorData& data, std::span<uint8_t> out) {
+    const size_t size = encodedSize(data);
+    if (out.size() < size) BINARY_PROTOCOL_THROW(std::runtime_error("Buffer overflow"));
+    if constexpr (kNativeEndian == Endian::Little) {
+        std::memcpy(out.data(), &data, size);
+    } else {
+        SpanWriter writer(out);
+        writer.writeUint64(data.timestamp);
+        writer.writeUint8(data.sensor_id);
+        writer.skip(serializeInto(data.position, writer.remaining()));
+        writer.writeFloat32(data.temperature);
+        writer.writeFloat32(data.humidity);
     }
-    writer.writeFloat32(data.temperature);
-    writer.writeFloat32(data.humidity);
-    return writer.data();
+    return size;
+}
+
+std::vector<uint8_t> serialize(const SensorData& data) {
+    std::vector<uint8_t> buffer(encodedSize(data));
+    serializeInto(data, buffer);
+    return buffer;
 }
 
 SensorData deserializeSensorData(const uint8_t* data, size_t size) {
-    BinaryReader reader(data, size);
-    SensorData result{};
-    result.timestamp = reader.readUint64();
-    result.sensor_id = reader.readUint8();
-    {
-        auto nested = reader.readBytes(12);
-        result.position = deserializeVector3D(nested.data(), nested.size());
+    if constexpr (kNativeEndian == Endian::Little) {
+        if (size < SensorData::ENCODED_SIZE) BINARY_PROTOCOL_THROW(std::runtime_error("Buffer underflow"));
+        SensorData result;
+        std::memcpy(&result, data, SensorData::ENCODED_SIZE);
+        return result;
+    } else {
+        BinaryReader reader(data, size);
+        SensorData result{};
+        result.timestamp = reader.readUint64();
+        result.sensor_id = reader.readUint8();
+        result.position = deserializeVector3D(reader.current(), reader.remaining());
+        reader.skip(12);
+        result.temperature = reader.readFloat32();
+        result.humidity = reader.readFloat32();
+        return result;
+    }
+}
+
+DecodeResult<SensorData> tryDeserializeSensorData(const uint8_t* data, size_t size) {
+    if (size < SensorData::ENCODED_SIZE) return DecodeError::Truncated;
+    SensorData result;
+    if constexpr (kNativeEndian == Endian::Little) {
+        std::memcpy(&result, data, SensorData::ENCODED_SIZE);
+    } else {
+        result.timestamp = detail::load<Endian::Little, uint64_t>(data + 0);
+        result.sensor_id = detail::load<Endian::Little, uint8_t>(data + 8);
+        result.position.x = std::bit_cast<float>(detail::load<Endian::Little, uint32_t>(data + 9));
+        result.position.y = std::bit_cast<float>(detail::load<Endian::Little, uint32_t>(data + 13));
+        result.position.z = std::bit_cast<float>(detail::load<Endian::Little, uint32_t>(data + 17));
+        result.temperature = std::bit_cast<float>(detail::load<Endian::Little, uint32_t>(data + 21));
+        result.humidity = std::bit_cast<float>(detail::load<Endian::Little, uint32_t>(data + 25));
     }
-    result.temperature = reader.readFloat32();
-    result.humidity = reader.readFloat32();
     return result;
 }
 
-std::vector<uint8_t> serialize(const SensorDataResponse& data) {
-    BinaryWriter writer;
+size_t serializeInto(const SensorDataResponse& data, std::span<uint8_t> out) {
+    BINARY_PROTOCOL_PROBE(Encode, SensorDataResponse::COMMAND_ID, encodedSize(data));
+    checkLengthPrefixes(data);
+    const size_t size = encodedSize(data);
+    if (out.size() < size) BINARY_PROTOCOL_THROW(std::runtime_error("Buffer overflow"));
+    SpanWriter writer(out);
     writer.writeUint8(data.sensor_count);
-    writer.writeLengthPrefixedBytes<uint16_t>(data.sensors);
-    return writer.data();
+    writer.writeUint16(static_cast<uint16_t>(data.sensors.size() * SensorData::ENCODED_SIZE));
+    if constexpr (kNativeEndian == Endian::Little) {
+        writer.writeBytes({reinterpret_cast<const uint8_t*>(data.sensors.data()), data.sensors.size() * SensorData::ENCODED_SIZE});
+    } else {
+        encodeSensorDataArray(data.sensors, writer.remaining().data());
+        writer.skip(data.sensors.size() * SensorData::ENCODED_SIZE);
+    }
+    return size;
+}
+
+std::vector<uint8_t> serialize(const SensorDataResponse& data) {
+    std::vector<uint8_t> buffer(encodedSize(data));
+    serializeInto(data, buffer);
+    return buffer;
 }
 
 SensorDataResponse deserializeSensorDataResponse(const uint8_t* data, size_t size) {
+    BINARY_PROTOCOL_PROBE(Decode, SensorDataResponse::COMMAND_ID, size);
     BinaryReader reader(data, size);
     SensorDataResponse result{};
     result.sensor_count = reader.readUint8();
-    result.sensors = reader.readLengthPrefixedBytes<uint16_t>();
+    {
+        const std::span<const uint8_t> bytes = reader.readLengthPrefixedView<uint16_t>();
+        if (bytes.size() % SensorData::ENCODED_SIZE != 0) {
+            BINARY_PROTOCOL_THROW(std::runtime_error("Invalid SensorData array length"));
+        }
+        result.sensors.resize(bytes.size() / SensorData::ENCODED_SIZE);
+        if constexpr (kNativeEndian == Endian::Little) {
+            if (!bytes.empty()) {
+                std::memcpy(result.sensors.data(), bytes.data(), bytes.size());
+            }
+        } else {
+            decodeSensorDataArray(bytes.data(), result.sensors);
+        }
+    }
+    return result;
+}
+
+DecodeResult<SensorDataResponse> tryDeserializeSensorDataResponse(const uint8_t* data, size_t size) {
+    BINARY_PROTOCOL_PROBE(Decode, SensorDataResponse::COMMAND_ID, size);
+    const uint8_t* in = data;
+    size_t remaining = size;
+    SensorDataResponse result{};
+    if (remaining < 3) return BINARY_PROTOCOL_PROBE_FAIL(DecodeError::Truncated);
+    result.sensor_count = detail::load<Endian::Little, uint8_t>(in + 0);
+    const size_t sensorsLength = detail::load<Endian::Little, uint16_t>(in + 1);
+    in += 3;
+    remaining -= 3;
+    if (remaining < sensorsLength) return BINARY_PROTOCOL_PROBE_FAIL(DecodeError::LengthOverflow);
+    if (sensorsLength % SensorData::ENCODED_SIZE != 0) return BINARY_PROTOCOL_PROBE_FAIL(DecodeError::BadArrayLength);
+    result.sensors.resize(sensorsLength / SensorData::ENCODED_SIZE);
+    if constexpr (kNativeEndian == Endian::Little) {
+        if (sensorsLength != 0) {
+            std::memcpy(result.sensors.data(), in, sensorsLength);
+        }
+    } else {
+        decodeSensorDataArray(in, result.sensors);
+    }
     return result;
 }
 
+SensorDataResponseView viewSensorDataResponse(const uint8_t* data, size_t size) {
+    BinaryReader reader(data, size);
+    SensorDataResponseView result{};
+    result.sensor_count = reader.readUint8();
+    result.sensors = SensorDataArrayView(reader.readLengthPrefixedView<uint16_t>());
+    return result;
+}
+
+void serializeGather(const SensorDataResponse& data, GatherList& out) {
+    checkLengthPrefixes(data);
+    uint8_t* p = out.allocate(3).data();
+    detail::store<Endian::Little>(p + 0, data.sensor_count);
+    detail::store<Endian::Little>(p + 1, static_cast<uint16_t>(data.sensors.size() * SensorData::ENCODED_SIZE));
+    if constexpr (kNativeEndian == Endian::Little) {
+        out.appendBytes({reinterpret_cast<const uint8_t*>(data.sensors.data()), data.sensors.size() * SensorData::ENCODED_SIZE});
+    } else {
+        if (!data.sensors.empty()) {
+            encodeSensorDataArray(data.sensors, out.spill(data.sensors.size() * SensorData::ENCODED_SIZE).data());
+        }
+    }
+}
+
+void serializeCompact(const SensorDataResponse& data, std::vector<uint8_t>& out) {
+    const size_t start = out.size();
+    out.resize(start + 3 + compactSensorDataArrayBound(data.sensors.size()));
+    uint8_t* const message = out.data() + start;
+    detail::store<Endian::Little>(message + 0, data.sensor_count);
+    uint8_t* const block = message + 3;
+    const size_t length = static_cast<size_t>(encodeCompactSensorDataArray(data.sensors, block) - block);
+    if (length > std::numeric_limits<uint16_t>::max()) {
+        out.resize(start);
+        BINARY_PROTOCOL_THROW(std::length_error("Compact encoding of sensors exceeds the uint16 length prefix"));
+    }
+    detail::store<Endian::Little>(message + 1, static_cast<uint16_t>(length));
+    out.resize(start + 3 + length);
+}
+
+std::vector<uint8_t> serializeCompact(const SensorDataResponse& data) {
+    std::vector<uint8_t> buffer;
+    serializeCompact(data, buffer);
+    return buffer;
+}
+
+SensorDataResponse deserializeCompactSensorDataResponse(const uint8_t* data, size_t size) {
+    DecodeResult<SensorDataResponse> result = tryDeserializeCompactSensorDataResponse(data, size);
+    if (!result) BINARY_PROTOCOL_THROW(std::runtime_error(toString(result.error())));
+    return std::move(result).value();
+}
+
+DecodeResult<SensorDataResponse> tryDeserializeCompactSensorDataResponse(const uint8_t* data, size_t size) {
+    if (size < 3) return DecodeError::Truncated;
+    SensorDataResponse result{};
+    result.sensor_count = detail::load<Endian::Little, uint8_t>(data + 0);
+    const size_t length = detail::load<Endian::Little, uint16_t>(data + 1);
+    if (size - 3 < length) return DecodeError::LengthOverflow;
+    if (const auto error = decodeCompactSensorDataArray({data + 3, length}, result.sensors)) return *error;
+    return result;
+}
+
+FrameChecksum::value_type computeFrameChecksum(const ProtocolHeader& header, std::span<const uint8_t> payload) {
+    std::array<uint8_t, ProtocolHeader::ENCODED_SIZE> bytes;
+    serializeInto(header, bytes);
+    return detail::frameChecksum(bytes.data(), payload);
+}
+
+void sealFrame(ProtocolHeader& header, std::span<const uint8_t> payload) {
+    header.payload_length = static_cast<decltype(ProtocolHeader::payload_length)>(payload.size());
+    header.checksum = computeFrameChecksum(header, payload);
+}
+
+bool verifyFrame(const ProtocolHeader& header, std::span<const uint8_t> payload) {
+    if (header.payload_length != payload.size()) return false;
+    if (header.checksum != computeFrameChecksum(header, payload)) {
+        BINARY_PROTOCOL_FRAME_ERROR(ChecksumMismatch);
+        return false;
+    }
+    return true;
+}
+
+void sealFrame(std::span<uint8_t> frame) {
+    if (frame.size() < ProtocolHeader::ENCODED_SIZE) BINARY_PROTOCOL_THROW(std::runtime_error("Frame shorter than header"));
+    const std::span<const uint8_t> payload = frame.subspan(ProtocolHeader::ENCODED_SIZE);
+    detail::store<Endian::Little>(frame.data() + 4, static_cast<decltype(ProtocolHeader::payload_length)>(payload.size()));
+    detail::store<Endian::Little>(frame.data() + 12, detail::frameChecksum(frame.data(), payload));
+}
+
+bool verifyFrame(std::span<const uint8_t> frame) {
+    if (frame.size() < ProtocolHeader::ENCODED_SIZE) return false;
+    const std::span<const uint8_t> payload = frame.subspan(ProtocolHeader::ENCODED_SIZE);
+    if (detail::load<Endian::Little, decltype(ProtocolHeader::payload_length)>(frame.data() + 4) != payload.size()) return false;
+    if (detail::load<Endian::Little, FrameChecksum::value_type>(frame.data() + 12) !=
+        detail::frameChecksum(frame.data(), payload)) {
+        BINARY_PROTOCOL_FRAME_ERROR(ChecksumMismatch);
+        return false;
+    }
+    return true;
+}
+
 } // namespace binaryprotocol
\ No newline at end of file
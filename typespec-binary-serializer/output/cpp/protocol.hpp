@@ -1,18 +1,54 @@
 /**
  * Auto-generated binary protocol types
  * Generated from: src/schema/commands.tsp
- * Generated at: 2025-12-05T14:13:04.015Z
+ * Generated at: 2026-10-16T12:44:19.072Z
  */
 
 #ifndef BINARY_PROTOCOL_HPP
 #define BINARY_PROTOCOL_HPP
 
+#include <algorithm>
+#include <bit>
 #include <cstdint>
+#include <cstdio>
+#include <cstdlib>
 #include <cstring>
+#include <limits>
+#include <memory>
+#include <memory_resource>
 #include <string>
 #include <vector>
 #include <array>
+#include <optional>
+#include <span>
 #include <stdexcept>
+#include <type_traits>
+#include <utility>
+#include <variant>
+
+#include "checksum.hpp"
+
+#if defined(__BMI2__)
+#include <immintrin.h>
+#endif
+
+#if __has_include(<sys/uio.h>)
+#include <sys/uio.h>
+#define BINARY_PROTOCOL_HAS_IOVEC 1
+#else
+#define BINARY_PROTOCOL_HAS_IOVEC 0
+#endif
+
+// Every throw site goes through BINARY_PROTOCOL_THROW. Without exceptions
+// (-fno-exceptions) it aborts with the message instead; use the
+// tryDeserialize functions to handle malformed input in such builds.
+#if defined(__cpp_exceptions) || defined(__EXCEPTIONS) || defined(_CPPUNWIND)
+#define BINARY_PROTOCOL_EXCEPTIONS 1
+#define BINARY_PROTOCOL_THROW(exception) throw exception
+#else
+#define BINARY_PROTOCOL_EXCEPTIONS 0
+#define BINARY_PROTOCOL_THROW(exception) ::binaryprotocol::detail::abortWith((exception).what())
+#endif
 
 namespace binaryprotocol {
 
@@ -60,9 +96,15 @@ struct ProtocolHeader {
     uint32_t payload_length;
     uint32_t sequence_id;
     uint16_t checksum;
+
+    static constexpr size_t ENCODED_SIZE = 14;
+    static constexpr uint16_t MAGIC = 0xABCD;
+
+    bool operator==(const ProtocolHeader&) const = default;
 };
 #pragma pack(pop)
 static_assert(sizeof(ProtocolHeader) == 14, "Size mismatch for ProtocolHeader");
+static_assert(std::is_trivially_copyable_v<ProtocolHeader>, "ProtocolHeader must be trivially copyable");
 
 // Command ID: 0x01
 #pragma pack(push, 1)
@@ -70,9 +112,13 @@ struct PingCommand {
     uint64_t timestamp;
 
     static constexpr uint8_t COMMAND_ID = 0x01;
+    static constexpr size_t ENCODED_SIZE = 8;
+
+    bool operator==(const PingCommand&) const = default;
 };
 #pragma pack(pop)
 static_assert(sizeof(PingCommand) == 8, "Size mismatch for PingCommand");
+static_assert(std::is_trivially_copyable_v<PingCommand>, "PingCommand must be trivially copyable");
 
 // Command ID: 0x81
 #pragma pack(push, 1)
@@ -81,9 +127,13 @@ struct PingResponse {
     uint64_t response_timestamp;
 
     static constexpr uint8_t COMMAND_ID = 0x81;
+    static constexpr size_t ENCODED_SIZE = 16;
+
+    bool operator==(const PingResponse&) const = default;
 };
 #pragma pack(pop)
 static_assert(sizeof(PingResponse) == 16, "Size mismatch for PingResponse");
+static_assert(std::is_trivially_copyable_v<PingResponse>, "PingResponse must be trivially copyable");
 
 // Command ID: 0x02
 #pragma pack(push, 1)
@@ -91,6 +141,9 @@ struct GetDeviceInfoCommand {
     bool include_details;
 
     static constexpr uint8_t COMMAND_ID = 0x02;
+    static constexpr size_t ENCODED_SIZE = 1;
+
+    bool operator==(const GetDeviceInfoCommand&) const = default;
 };
 #pragma pack(pop)
 static_assert(sizeof(GetDeviceInfoCommand) == 1, "Size mismatch for GetDeviceInfoCommand");
@@ -106,20 +159,36 @@ struct DeviceInfoResponse {
     uint8_t battery_level;
 
     static constexpr uint8_t COMMAND_ID = 0x82;
+    static constexpr size_t ENCODED_SIZE = 56;
+
+    bool operator==(const DeviceInfoResponse&) const = default;
 };
 #pragma pack(pop)
 static_assert(sizeof(DeviceInfoResponse) == 56, "Size mismatch for DeviceInfoResponse");
+static_assert(std::is_trivially_copyable_v<DeviceInfoResponse>, "DeviceInfoResponse must be trivially copyable");
 
 // Command ID: 0x03
-#pragma pack(push, 1)
 struct SendDataCommand {
     uint8_t channel;
     uint8_t priority;
     std::vector<uint8_t> data;
 
     static constexpr uint8_t COMMAND_ID = 0x03;
+
+    bool operator==(const SendDataCommand&) const = default;
+};
+
+/**
+ * Zero-copy view of SendDataCommand.
+ * Variable-length fields borrow from the receive buffer, which must outlive the view.
+ */
+struct SendDataCommandView {
+    uint8_t channel;
+    uint8_t priority;
+    std::span<const uint8_t> data;
+
+    static constexpr uint8_t COMMAND_ID = SendDataCommand::COMMAND_ID;
 };
-#pragma pack(pop)
 
 // Command ID: 0x83
 #pragma pack(push, 1)
@@ -129,20 +198,35 @@ struct SendDataResponse {
     uint32_t bytes_written;
 
     static constexpr uint8_t COMMAND_ID = 0x83;
+    static constexpr size_t ENCODED_SIZE = 6;
+
+    bool operator==(const SendDataResponse&) const = default;
 };
 #pragma pack(pop)
 static_assert(sizeof(SendDataResponse) == 6, "Size mismatch for SendDataResponse");
 
 // Command ID: 0x04
-#pragma pack(push, 1)
 struct SetConfigCommand {
     uint8_t config_id;
     uint8_t value_type;
     std::vector<uint8_t> value;
 
     static constexpr uint8_t COMMAND_ID = 0x04;
+
+    bool operator==(const SetConfigCommand&) const = default;
+};
+
+/**
+ * Zero-copy view of SetConfigCommand.
+ * Variable-length fields borrow from the receive buffer, which must outlive the view.
+ */
+struct SetConfigCommandView {
+    uint8_t config_id;
+    uint8_t value_type;
+    std::span<const uint8_t> value;
+
+    static constexpr uint8_t COMMAND_ID = SetConfigCommand::COMMAND_ID;
 };
-#pragma pack(pop)
 
 // Command ID: 0x84
 #pragma pack(push, 1)
@@ -151,39 +235,70 @@ struct SetConfigResponse {
     ErrorCode error_code;
 
     static constexpr uint8_t COMMAND_ID = 0x84;
+    static constexpr size_t ENCODED_SIZE = 2;
+
+    bool operator==(const SetConfigResponse&) const = default;
 };
 #pragma pack(pop)
 static_assert(sizeof(SetConfigResponse) == 2, "Size mismatch for SetConfigResponse");
 
 // Command ID: 0x10
-#pragma pack(push, 1)
 struct BatchCommand {
     uint8_t command_count;
     std::vector<uint8_t> commands;
 
     static constexpr uint8_t COMMAND_ID = 0x10;
+
+    bool operator==(const BatchCommand&) const = default;
+};
+
+/**
+ * Zero-copy view of BatchCommand.
+ * Variable-length fields borrow from the receive buffer, which must outlive the view.
+ */
+struct BatchCommandView {
+    uint8_t command_count;
+    std::span<const uint8_t> commands;
+
+    static constexpr uint8_t COMMAND_ID = BatchCommand::COMMAND_ID;
 };
-#pragma pack(pop)
 
 // Command ID: 0x90
-#pragma pack(push, 1)
 struct BatchResponse {
     uint8_t success_count;
     uint8_t failure_count;
     std::vector<uint8_t> results;
 
     static constexpr uint8_t COMMAND_ID = 0x90;
+
+    bool operator==(const BatchResponse&) const = default;
+};
+
+/**
+ * Zero-copy view of BatchResponse.
+ * Variable-length fields borrow from the receive buffer, which must outlive the view.
+ */
+struct BatchResponseView {
+    uint8_t success_count;
+    uint8_t failure_count;
+    std::span<const uint8_t> results;
+
+    static constexpr uint8_t COMMAND_ID = BatchResponse::COMMAND_ID;
 };
-#pragma pack(pop)
 
 #pragma pack(push, 1)
 struct Vector3D {
     float x;
     float y;
     float z;
+
+    static constexpr size_t ENCODED_SIZE = 12;
+
+    bool operator==(const Vector3D&) const = default;
 };
 #pragma pack(pop)
 static_assert(sizeof(Vector3D) == 12, "Size mismatch for Vector3D");
+static_assert(std::is_trivially_copyable_v<Vector3D>, "Vector3D must be trivially copyable");
 
 #pragma pack(push, 1)
 struct SensorData {
@@ -192,48 +307,270 @@ struct SensorData {
     Vector3D position;
     float temperature;
     float humidity;
+
+    static constexpr size_t ENCODED_SIZE = 29;
+
+    bool operator==(const SensorData&) const = default;
 };
 #pragma pack(pop)
 static_assert(sizeof(SensorData) == 29, "Size mismatch for SensorData");
+static_assert(std::is_trivially_copyable_v<SensorData>, "SensorData must be trivially copyable");
+
+/**
+ * Lazily decoded, non-owning view over an encoded SensorData array.
+ * Elements are decoded on access; the underlying buffer must outlive the view.
+ */
+class SensorDataArrayView {
+public:
+    class Iterator {
+    public:
+        Iterator(const SensorDataArrayView* view, size_t index) : view_(view), index_(index) {}
+        SensorData operator*() const { return (*view_)[index_]; }
+        Iterator& operator++() { ++index_; return *this; }
+        bool operator==(const Iterator& other) const { return index_ == other.index_; }
+        bool operator!=(const Iterator& other) const { return index_ != other.index_; }
+
+    private:
+        const SensorDataArrayView* view_;
+        size_t index_;
+    };
+
+    SensorDataArrayView() = default;
+    explicit SensorDataArrayView(std::span<const uint8_t> bytes);
+
+    size_t size() const { return bytes_.size() / SensorData::ENCODED_SIZE; }
+    bool empty() const { return bytes_.empty(); }
+    SensorData operator[](size_t index) const;
+    std::span<const uint8_t> bytes() const { return bytes_; }
+
+    Iterator begin() const { return Iterator(this, 0); }
+    Iterator end() const { return Iterator(this, size()); }
+
+private:
+    std::span<const uint8_t> bytes_;
+};
 
 // Command ID: 0x85
-#pragma pack(push, 1)
 struct SensorDataResponse {
     uint8_t sensor_count;
     std::vector<SensorData> sensors;
 
     static constexpr uint8_t COMMAND_ID = 0x85;
+
+    bool operator==(const SensorDataResponse&) const = default;
 };
-#pragma pack(pop)
 
 /**
- * Binary data writer
+ * Zero-copy view of SensorDataResponse.
+ * Variable-length fields borrow from the receive buffer, which must outlive the view.
+ */
+struct SensorDataResponseView {
+    uint8_t sensor_count;
+    SensorDataArrayView sensors;
+
+    static constexpr uint8_t COMMAND_ID = SensorDataResponse::COMMAND_ID;
+};
+
+// ============================================
+// No-throw decoding
+// ============================================
+
+namespace detail {
+
+[[noreturn]] inline void abortWith(const char* message) noexcept {
+    std::fputs(message, stderr);
+    std::fputc('\n', stderr);
+    std::abort();
+}
+
+} // namespace detail
+
+enum class DecodeError : uint8_t {
+    /// Input ends inside a fixed-size field or length prefix
+    Truncated,
+    /// An enum field holds a value that is not a member of the enum
+    BadEnumValue,
+    /// A length prefix claims more bytes than remain
+    LengthOverflow,
+    /// An array's byte length is not a multiple of its element size
+    BadArrayLength,
+    /// The command ID does not belong to any message
+    UnknownCommand,
+    /// A compact-encoded varint is over-long or out of range for its field
+    BadVarint,
+};
+
+constexpr const char* toString(DecodeError error) {
+    switch (error) {
+    case DecodeError::Truncated: return "Truncated input";
+    case DecodeError::BadEnumValue: return "Invalid enum value";
+    case DecodeError::LengthOverflow: return "Length prefix exceeds input";
+    case DecodeError::BadArrayLength: return "Invalid array length";
+    case DecodeError::UnknownCommand: return "Unknown command ID";
+    case DecodeError::BadVarint: return "Invalid varint";
+    }
+    return "Unknown decode error";
+}
+
+/**
+ * Value or DecodeError returned by the tryDeserialize functions.
+ * Mirrors the std::expected interface so it can be swapped for it once C++23 is required.
+ */
+template<typename T>
+class DecodeResult {
+public:
+    DecodeResult(T value) : storage_(std::in_place_index<0>, std::move(value)) {}
+    DecodeResult(DecodeError error) : storage_(std::in_place_index<1>, error) {}
+
+    bool has_value() const noexcept { return storage_.index() == 0; }
+    explicit operator bool() const noexcept { return has_value(); }
+
+    /// Checked access; throws (or aborts without exceptions) on an error
+    T& value() & { check(); return *std::get_if<0>(&storage_); }
+    const T& value() const& { check(); return *std::get_if<0>(&storage_); }
+    T&& value() && { check(); return std::move(*std::get_if<0>(&storage_)); }
+
+    T& operator*() & noexcept { return *std::get_if<0>(&storage_); }
+    const T& operator*() const& noexcept { return *std::get_if<0>(&storage_); }
+    T* operator->() noexcept { return std::get_if<0>(&storage_); }
+    const T* operator->() const noexcept { return std::get_if<0>(&storage_); }
+
+    DecodeError error() const noexcept { return *std::get_if<1>(&storage_); }
+
+    template<typename U>
+    T value_or(U&& fallback) const& {
+        return has_value() ? **this : static_cast<T>(std::forward<U>(fallback));
+    }
+
+private:
+    void check() const {
+        if (!has_value()) BINARY_PROTOCOL_THROW(std::runtime_error(toString(error())));
+    }
+
+    std::variant<T, DecodeError> storage_;
+};
+
+/// Byte order of the host, resolved at compile time
+inline constexpr Endian kNativeEndian =
+    std::endian::native == std::endian::little ? Endian::Little : Endian::Big;
+
+namespace detail {
+
+template<typename T>
+constexpr T byteswap(T value) {
+    static_assert(std::is_unsigned_v<T>, "byteswap requires an unsigned type");
+#if defined(__GNUC__) || defined(__clang__)
+    if constexpr (sizeof(T) == 1) {
+        return value;
+    } else if constexpr (sizeof(T) == 2) {
+        return __builtin_bswap16(value);
+    } else if constexpr (sizeof(T) == 4) {
+        return __builtin_bswap32(value);
+    } else {
+        return __builtin_bswap64(value);
+    }
+#else
+    T result = 0;
+    for (size_t i = 0; i < sizeof(T); i++) {
+        result = static_cast<T>((result << 8) | ((value >> (i * 8)) & 0xFF));
+    }
+    return result;
+#endif
+}
+
+/// Convert between host and wire byte order; a no-op when they match
+template<Endian E, typename T>
+constexpr T toWire(T value) {
+    if constexpr (E == kNativeEndian) {
+        return value;
+    } else {
+        return byteswap(value);
+    }
+}
+
+// memcpy is not usable in constant evaluation; copy byte-wise there instead
+template<Endian E, typename T>
+constexpr void store(uint8_t* out, T value) {
+    value = toWire<E>(value);
+    if (std::is_constant_evaluated()) {
+        const auto bytes = std::bit_cast<std::array<uint8_t, sizeof(T)>>(value);
+        for (size_t i = 0; i < sizeof(T); i++) {
+            out[i] = bytes[i];
+        }
+    } else {
+        std::memcpy(out, &value, sizeof(T));
+    }
+}
+
+template<Endian E, typename T>
+constexpr T load(const uint8_t* in) {
+    if (std::is_constant_evaluated()) {
+        std::array<uint8_t, sizeof(T)> bytes{};
+        for (size_t i = 0; i < sizeof(T); i++) {
+            bytes[i] = in[i];
+        }
+        return toWire<E>(std::bit_cast<T>(bytes));
+    }
+    T value;
+    std::memcpy(&value, in, sizeof(T));
+    return toWire<E>(value);
+}
+
+} // namespace detail
+
+/**
+ * Growable binary data writer.
+ * The buffer is allocated through Alloc (e.g. std::pmr::polymorphic_allocator
+ * for arena backing) or borrowed from the caller. clear() keeps the capacity,
+ * so one writer per thread can encode any number of messages without
+ * reallocating once it has grown to the largest message.
  */
-class BinaryWriter {
+template<Endian E, typename Alloc = std::allocator<uint8_t>>
+class BasicBinaryWriter {
 public:
-    void writeUint8(uint8_t value);
-    void writeUint16(uint16_t value);
-    void writeUint32(uint32_t value);
-    void writeUint64(uint64_t value);
-    void writeInt8(int8_t value);
-    void writeInt16(int16_t value);
-    void writeInt32(int32_t value);
-    void writeInt64(int64_t value);
-    void writeFloat32(float value);
-    void writeFloat64(double value);
-    void writeBool(bool value);
+    using buffer_type = std::vector<uint8_t, Alloc>;
+
+    BasicBinaryWriter() : buffer_(&owned_) {}
+    explicit BasicBinaryWriter(const Alloc& alloc) : owned_(alloc), buffer_(&owned_) {}
+    /// Appends to a caller-owned buffer, which must outlive the writer
+    explicit BasicBinaryWriter(buffer_type& external) : buffer_(&external) {}
+
+    BasicBinaryWriter(BasicBinaryWriter&& other) noexcept
+        : owned_(std::move(other.owned_)), buffer_(other.buffer_ == &other.owned_ ? &owned_ : other.buffer_) {
+        other.buffer_ = &other.owned_;
+    }
+    BasicBinaryWriter(const BasicBinaryWriter&) = delete;
+    BasicBinaryWriter& operator=(const BasicBinaryWriter&) = delete;
+    BasicBinaryWriter& operator=(BasicBinaryWriter&&) = delete;
+
+    void writeUint8(uint8_t value) { buffer_->push_back(value); }
+    void writeUint16(uint16_t value) { append(value); }
+    void writeUint32(uint32_t value) { append(value); }
+    void writeUint64(uint64_t value) { append(value); }
+    void writeInt8(int8_t value) { writeUint8(static_cast<uint8_t>(value)); }
+    void writeInt16(int16_t value) { append(static_cast<uint16_t>(value)); }
+    void writeInt32(int32_t value) { append(static_cast<uint32_t>(value)); }
+    void writeInt64(int64_t value) { append(static_cast<uint64_t>(value)); }
+    void writeFloat32(float value) { append(std::bit_cast<uint32_t>(value)); }
+    void writeFloat64(double value) { append(std::bit_cast<uint64_t>(value)); }
+    void writeBool(bool value) { writeUint8(value ? 1 : 0); }
 
     template<size_t N>
     void writeFixedString(const std::array<char, N>& value) {
-        buffer_.insert(buffer_.end(), value.begin(), value.end());
+        buffer_->insert(buffer_->end(), value.begin(), value.end());
+    }
+
+    void writeBytes(const uint8_t* data, size_t size) {
+        buffer_->insert(buffer_->end(), data, data + size);
     }
 
-    void writeBytes(const uint8_t* data, size_t size);
-    void writeBytes(const std::vector<uint8_t>& data);
+    void writeBytes(const std::vector<uint8_t>& data) {
+        buffer_->insert(buffer_->end(), data.begin(), data.end());
+    }
 
     template<size_t N>
     void writeBytes(const std::array<uint8_t, N>& data) {
-        buffer_.insert(buffer_.end(), data.begin(), data.end());
+        buffer_->insert(buffer_->end(), data.begin(), data.end());
     }
 
     template<typename LengthT>
@@ -248,50 +585,167 @@ public:
         writeBytes(data);
     }
 
-    const std::vector<uint8_t>& data() const { return buffer_; }
-    size_t size() const { return buffer_.size(); }
+    /// Grows the buffer by size bytes and returns them for in-place encoding
+    std::span<uint8_t> allocate(size_t size) {
+        const size_t offset = buffer_->size();
+        buffer_->resize(offset + size);
+        return {buffer_->data() + offset, size};
+    }
+
+    /// Overwrites an already written value, e.g. a length known only after the body
+    template<typename T, Endian Order = E>
+    void patch(size_t offset, T value) {
+        if (offset + sizeof(T) > buffer_->size()) BINARY_PROTOCOL_THROW(std::runtime_error("Patch out of range"));
+        detail::store<Order>(buffer_->data() + offset, value);
+    }
+
+    void reserve(size_t capacity) { buffer_->reserve(capacity); }
+    /// Drops the written bytes but keeps the capacity
+    void clear() { buffer_->clear(); }
+    /// Same as clear(); mirrors FrameDecoder::reset()
+    void reset() { clear(); }
+
+    /// Moves the written bytes out; the writer starts over with an empty buffer
+    buffer_type release() {
+        buffer_type result = std::move(*buffer_);
+        buffer_->clear();
+        return result;
+    }
+
+    const buffer_type& data() const { return *buffer_; }
+    std::span<const uint8_t> view() const { return {buffer_->data(), buffer_->size()}; }
+    size_t size() const { return buffer_->size(); }
+    size_t capacity() const { return buffer_->capacity(); }
 
 private:
-    std::vector<uint8_t> buffer_;
+    template<typename T>
+    void append(T value) {
+        const size_t offset = buffer_->size();
+        buffer_->resize(offset + sizeof(T));
+        detail::store<E>(buffer_->data() + offset, value);
+    }
+
+    buffer_type owned_;
+    buffer_type* buffer_;
 };
 
+using BinaryWriter = BasicBinaryWriter<Endian::Little>;
+using PmrBinaryWriter = BasicBinaryWriter<Endian::Little, std::pmr::polymorphic_allocator<uint8_t>>;
+
+/**
+ * Binary data writer over a caller-owned buffer.
+ * Performs no bounds checks and never allocates; serializeInto() validates
+ * the total encoded size once before any field is written.
+ */
+template<Endian E>
+class BasicSpanWriter {
+public:
+    explicit BasicSpanWriter(std::span<uint8_t> buffer) : buffer_(buffer) {}
+
+    void writeUint8(uint8_t value) { buffer_[offset_++] = value; }
+    void writeUint16(uint16_t value) { put(value); }
+    void writeUint32(uint32_t value) { put(value); }
+    void writeUint64(uint64_t value) { put(value); }
+    void writeInt8(int8_t value) { writeUint8(static_cast<uint8_t>(value)); }
+    void writeInt16(int16_t value) { put(static_cast<uint16_t>(value)); }
+    void writeInt32(int32_t value) { put(static_cast<uint32_t>(value)); }
+    void writeInt64(int64_t value) { put(static_cast<uint64_t>(value)); }
+    void writeFloat32(float value) { put(std::bit_cast<uint32_t>(value)); }
+    void writeFloat64(double value) { put(std::bit_cast<uint64_t>(value)); }
+    void writeBool(bool value) { writeUint8(value ? 1 : 0); }
+
+    template<size_t N>
+    void writeFixedString(const std::array<char, N>& value) {
+        std::memcpy(buffer_.data() + offset_, value.data(), N);
+        offset_ += N;
+    }
+
+    void writeBytes(std::span<const uint8_t> data) {
+        if (!data.empty()) {
+            std::memcpy(buffer_.data() + offset_, data.data(), data.size());
+        }
+        offset_ += data.size();
+    }
+
+    template<typename LengthT>
+    void writeLengthPrefixedBytes(std::span<const uint8_t> data) {
+        if constexpr (sizeof(LengthT) == 1) {
+            writeUint8(static_cast<uint8_t>(data.size()));
+        } else if constexpr (sizeof(LengthT) == 2) {
+            writeUint16(static_cast<uint16_t>(data.size()));
+        } else if constexpr (sizeof(LengthT) == 4) {
+            writeUint32(static_cast<uint32_t>(data.size()));
+        }
+        writeBytes(data);
+    }
+
+    /// Unwritten tail of the buffer, used to encode nested models in place
+    std::span<uint8_t> remaining() const { return buffer_.subspan(offset_); }
+    void skip(size_t length) { offset_ += length; }
+
+    size_t position() const { return offset_; }
+
+private:
+    template<typename T>
+    void put(T value) {
+        detail::store<E>(buffer_.data() + offset_, value);
+        offset_ += sizeof(T);
+    }
+
+    std::span<uint8_t> buffer_;
+    size_t offset_ = 0;
+};
+
+using SpanWriter = BasicSpanWriter<Endian::Little>;
+
 /**
  * Binary data reader
  */
-class BinaryReader {
+template<Endian E>
+class BasicBinaryReader {
 public:
-    BinaryReader(const uint8_t* data, size_t size);
-
-    uint8_t readUint8();
-    uint16_t readUint16();
-    uint32_t readUint32();
-    uint64_t readUint64();
-    int8_t readInt8();
-    int16_t readInt16();
-    int32_t readInt32();
-    int64_t readInt64();
-    float readFloat32();
-    double readFloat64();
-    bool readBool();
+    BasicBinaryReader(const uint8_t* data, size_t size)
+        : data_(data), size_(size), offset_(0) {}
+
+    uint8_t readUint8() {
+        if (offset_ + 1 > size_) BINARY_PROTOCOL_THROW(std::runtime_error("Buffer underflow"));
+        return data_[offset_++];
+    }
+
+    uint16_t readUint16() { return take<uint16_t>(); }
+    uint32_t readUint32() { return take<uint32_t>(); }
+    uint64_t readUint64() { return take<uint64_t>(); }
+    int8_t readInt8() { return static_cast<int8_t>(readUint8()); }
+    int16_t readInt16() { return static_cast<int16_t>(take<uint16_t>()); }
+    int32_t readInt32() { return static_cast<int32_t>(take<uint32_t>()); }
+    int64_t readInt64() { return static_cast<int64_t>(take<uint64_t>()); }
+    float readFloat32() { return std::bit_cast<float>(take<uint32_t>()); }
+    double readFloat64() { return std::bit_cast<double>(take<uint64_t>()); }
+    bool readBool() { return readUint8() != 0; }
 
     template<size_t N>
     std::array<char, N> readFixedString() {
         std::array<char, N> result{};
         if (offset_ + N > size_) {
-            throw std::runtime_error("Buffer underflow");
+            BINARY_PROTOCOL_THROW(std::runtime_error("Buffer underflow"));
         }
         std::memcpy(result.data(), data_ + offset_, N);
         offset_ += N;
         return result;
     }
 
-    std::vector<uint8_t> readBytes(size_t length);
+    std::vector<uint8_t> readBytes(size_t length) {
+        if (offset_ + length > size_) BINARY_PROTOCOL_THROW(std::runtime_error("Buffer underflow"));
+        std::vector<uint8_t> result(data_ + offset_, data_ + offset_ + length);
+        offset_ += length;
+        return result;
+    }
 
     template<size_t N>
     std::array<uint8_t, N> readFixedBytes() {
         std::array<uint8_t, N> result{};
         if (offset_ + N > size_) {
-            throw std::runtime_error("Buffer underflow");
+            BINARY_PROTOCOL_THROW(std::runtime_error("Buffer underflow"));
         }
         std::memcpy(result.data(), data_ + offset_, N);
         offset_ += N;
@@ -300,54 +754,1053 @@ public:
 
     template<typename LengthT>
     std::vector<uint8_t> readLengthPrefixedBytes() {
-        size_t length;
-        if constexpr (sizeof(LengthT) == 1) {
-            length = readUint8();
-        } else if constexpr (sizeof(LengthT) == 2) {
-            length = readUint16();
-        } else if constexpr (sizeof(LengthT) == 4) {
-            length = readUint32();
-        }
-        return readBytes(length);
+        return readBytes(readLength<LengthT>());
     }
 
+    /// Borrow the next length bytes without copying
+    std::span<const uint8_t> readBytesView(size_t length) {
+        if (offset_ + length > size_) BINARY_PROTOCOL_THROW(std::runtime_error("Buffer underflow"));
+        std::span<const uint8_t> result(data_ + offset_, length);
+        offset_ += length;
+        return result;
+    }
+
+    template<typename LengthT>
+    std::span<const uint8_t> readLengthPrefixedView() {
+        return readBytesView(readLength<LengthT>());
+    }
+
+    void skip(size_t length) {
+        if (offset_ + length > size_) BINARY_PROTOCOL_THROW(std::runtime_error("Buffer underflow"));
+        offset_ += length;
+    }
+
+    const uint8_t* current() const { return data_ + offset_; }
     size_t position() const { return offset_; }
     size_t remaining() const { return size_ - offset_; }
 
 private:
+    template<typename T>
+    T take() {
+        if (offset_ + sizeof(T) > size_) BINARY_PROTOCOL_THROW(std::runtime_error("Buffer underflow"));
+        T value = detail::load<E, T>(data_ + offset_);
+        offset_ += sizeof(T);
+        return value;
+    }
+
+    template<typename LengthT>
+    size_t readLength() {
+        if constexpr (sizeof(LengthT) == 1) {
+            return readUint8();
+        } else if constexpr (sizeof(LengthT) == 2) {
+            return readUint16();
+        } else {
+            return readUint32();
+        }
+    }
+
     const uint8_t* data_;
     size_t size_;
     size_t offset_ = 0;
 };
 
+using BinaryReader = BasicBinaryReader<Endian::Little>;
+
+// ============================================
+// Scatter-gather encoding
+// ============================================
+
+/**
+ * Encoded message(s) as a list of segments for writev/sendmsg.
+ *
+ * Fixed fields and length prefixes are encoded into an inline buffer;
+ * variable-length fields of at least INLINE_COPY_LIMIT bytes are referenced
+ * in place, so the encoded messages must outlive the list. Several messages
+ * or frames can be appended before the list is written out; clear() reuses it.
+ */
+class GatherList {
+public:
+    static constexpr size_t MAX_SEGMENTS = 16;
+    static constexpr size_t INLINE_CAPACITY = 256;
+    /// Shorter fields are copied, since another segment costs more than the copy
+    static constexpr size_t INLINE_COPY_LIMIT = 64;
+
+    GatherList() = default;
+    // Segments point into this object's inline buffer
+    GatherList(const GatherList&) = delete;
+    GatherList& operator=(const GatherList&) = delete;
+
+    std::span<const std::span<const uint8_t>> segments() const { return {segments_.data(), count_}; }
+    /// Total encoded bytes across all segments
+    size_t size() const { return size_; }
+
+    void clear() {
+        count_ = 0;
+        size_ = 0;
+        inlineUsed_ = 0;
+        spill_.clear();
+    }
+
+    /// Encoded bytes in the inline buffer, extending the previous segment when contiguous
+    std::span<uint8_t> allocate(size_t n) {
+        if (n > INLINE_CAPACITY - inlineUsed_) BINARY_PROTOCOL_THROW(std::length_error("GatherList inline buffer full"));
+        uint8_t* bytes = inline_.data() + inlineUsed_;
+        inlineUsed_ += n;
+        append({bytes, n});
+        return {bytes, n};
+    }
+
+    /// Variable-length field: referenced in place unless it is short enough to copy
+    void appendBytes(std::span<const uint8_t> bytes) {
+        if (bytes.empty()) return;
+        if (bytes.size() < INLINE_COPY_LIMIT && bytes.size() <= INLINE_CAPACITY - inlineUsed_) {
+            std::memcpy(allocate(bytes.size()).data(), bytes.data(), bytes.size());
+        } else {
+            append(bytes);
+        }
+    }
+
+    /// Owned storage for fields that have to be converted (e.g. arrays in a foreign byte order)
+    std::span<uint8_t> spill(size_t n) {
+        std::vector<uint8_t>& buffer = spill_.emplace_back(n);
+        append({buffer.data(), n});
+        return buffer;
+    }
+
+    /// Calls fn with every byte range from the given offset onwards
+    template<typename Fn>
+    void visit(size_t from, Fn&& fn) const {
+        for (std::span<const uint8_t> segment : segments()) {
+            if (from >= segment.size()) {
+                from -= segment.size();
+                continue;
+            }
+            fn(segment.subspan(from));
+            from = 0;
+        }
+    }
+
+#if BINARY_PROTOCOL_HAS_IOVEC
+    /// Fills iov (room for segments().size() entries) for writev/sendmsg; returns the count
+    size_t toIovec(struct iovec* iov) const {
+        for (size_t i = 0; i < count_; i++) {
+            iov[i].iov_base = const_cast<uint8_t*>(segments_[i].data());
+            iov[i].iov_len = segments_[i].size();
+        }
+        return count_;
+    }
+#endif
+
+private:
+    void append(std::span<const uint8_t> bytes) {
+        size_ += bytes.size();
+        if (count_ > 0) {
+            std::span<const uint8_t>& last = segments_[count_ - 1];
+            if (last.data() + last.size() == bytes.data()) {
+                last = {last.data(), last.size() + bytes.size()};
+                return;
+            }
+        }
+        if (count_ == MAX_SEGMENTS) BINARY_PROTOCOL_THROW(std::length_error("GatherList has too many segments"));
+        segments_[count_++] = bytes;
+    }
+
+    std::array<uint8_t, INLINE_CAPACITY> inline_{};
+    size_t inlineUsed_ = 0;
+    std::array<std::span<const uint8_t>, MAX_SEGMENTS> segments_{};
+    size_t count_ = 0;
+    size_t size_ = 0;
+    std::vector<std::vector<uint8_t>> spill_;
+};
+
+/// Appends a message to the list; fixed-size messages are encoded inline
+template<typename T>
+    requires requires(const T& message, std::span<uint8_t> out) { serializeInto(message, out); }
+void serializeGather(const T& data, GatherList& out) {
+    serializeInto(data, out.allocate(encodedSize(data)));
+}
+
+// ============================================
+// Compact encoding (@compact)
+// ============================================
+
+#ifndef BINARY_PROTOCOL_VARINT_SWAR
+#define BINARY_PROTOCOL_VARINT_SWAR 0
+#endif
+
+namespace detail {
+
+/// Longest LEB128 encoding of a 64-bit value
+inline constexpr size_t MAX_VARINT_SIZE = 10;
+
+constexpr uint64_t zigzag(int64_t value) {
+    return (static_cast<uint64_t>(value) << 1) ^ static_cast<uint64_t>(value >> 63);
+}
+
+constexpr int64_t unzigzag(uint64_t value) {
+    return static_cast<int64_t>(value >> 1) ^ -static_cast<int64_t>(value & 1);
+}
+
+/// Writes value as LEB128 and returns the end; out needs MAX_VARINT_SIZE bytes of room
+inline uint8_t* writeVarint(uint8_t* out, uint64_t value) {
+    while (value >= 0x80) {
+        *out++ = static_cast<uint8_t>(value | 0x80);
+        value >>= 7;
+    }
+    *out++ = static_cast<uint8_t>(value);
+    return out;
+}
+
+/// Byte-at-a-time LEB128 decode; false if truncated or longer than 64 bits
+inline bool readVarintBytes(const uint8_t*& in, const uint8_t* end, uint64_t& value) {
+    uint64_t result = 0;
+    for (unsigned shift = 0; shift < 64 && in != end; shift += 7) {
+        const uint8_t byte = *in++;
+        if (shift == 63 && byte > 1) return false;
+        result |= static_cast<uint64_t>(byte & 0x7F) << shift;
+        if (byte < 0x80) {
+            value = result;
+            return true;
+        }
+    }
+    return false;
+}
+
+#if BINARY_PROTOCOL_VARINT_SWAR
+/// Packs the 7-bit groups of up to 8 little-endian varint bytes
+inline uint64_t packVarintGroups(uint64_t word) {
+#if defined(__BMI2__)
+    return _pext_u64(word, 0x7F7F7F7F7F7F7F7FULL);
+#else
+    word &= 0x7F7F7F7F7F7F7F7FULL;
+    word = (word & 0x007F007F007F007FULL) | ((word & 0x7F007F007F007F00ULL) >> 1);
+    word = (word & 0x00003FFF00003FFFULL) | ((word & 0x3FFF00003FFF0000ULL) >> 2);
+    return (word & 0x000000000FFFFFFFULL) | ((word & 0x0FFFFFFF00000000ULL) >> 4);
+#endif
+}
+#endif
+
+/**
+ * Reads one LEB128 value; false if it is truncated or longer than 64 bits.
+ *
+ * The byte loop is fastest when neighbouring values have similar lengths, as
+ * delta-encoded columns usually do, because the branch predictor runs ahead.
+ * With BINARY_PROTOCOL_VARINT_SWAR the first 8 bytes are decoded without
+ * per-byte branches instead: one load finds the terminating byte from the
+ * continuation bits and the 7-bit groups are packed with PEXT (BMI2) or SWAR
+ * shifts. Its cost is constant, so it only wins when lengths vary at random.
+ */
+inline bool readVarint(const uint8_t*& in, const uint8_t* end, uint64_t& value) {
+#if BINARY_PROTOCOL_VARINT_SWAR
+    if (end - in >= 8) {
+        const uint64_t word = load<Endian::Little, uint64_t>(in);
+        const uint64_t stops = ~word & 0x8080808080808080ULL;
+        if (stops != 0) {
+            // Every bit up to the terminating byte's top bit
+            value = packVarintGroups(word & (stops ^ (stops - 1)));
+            in += static_cast<size_t>(std::countr_zero(stops) + 1) / 8;
+            return true;
+        }
+    }
+#endif
+    return readVarintBytes(in, end, value);
+}
+
+} // namespace detail
+
+constexpr size_t encodedSize(const ProtocolHeader&) { return ProtocolHeader::ENCODED_SIZE; }
+constexpr size_t encodedSize(const PingCommand&) { return PingCommand::ENCODED_SIZE; }
+constexpr size_t encodedSize(const PingResponse&) { return PingResponse::ENCODED_SIZE; }
+constexpr size_t encodedSize(const GetDeviceInfoCommand&) { return GetDeviceInfoCommand::ENCODED_SIZE; }
+constexpr size_t encodedSize(const DeviceInfoResponse&) { return DeviceInfoResponse::ENCODED_SIZE; }
+constexpr size_t encodedSize(const SendDataCommand& data) { return 4 + data.data.size(); }
+constexpr size_t encodedSize(const SendDataResponse&) { return SendDataResponse::ENCODED_SIZE; }
+constexpr size_t encodedSize(const SetConfigCommand& data) { return 3 + data.value.size(); }
+constexpr size_t encodedSize(const SetConfigResponse&) { return SetConfigResponse::ENCODED_SIZE; }
+constexpr size_t encodedSize(const BatchCommand& data) { return 3 + data.commands.size(); }
+constexpr size_t encodedSize(const BatchResponse& data) { return 4 + data.results.size(); }
+constexpr size_t encodedSize(const Vector3D&) { return Vector3D::ENCODED_SIZE; }
+constexpr size_t encodedSize(const SensorData&) { return SensorData::ENCODED_SIZE; }
+constexpr size_t encodedSize(const SensorDataResponse& data) { return 3 + data.sensors.size() * 29; }
+
+/// Throws std::length_error when a variable-length field does not fit its length prefix.
+/// Encoders call this before writing anything, so a rejected message leaves no partial output.
+constexpr void checkLengthPrefixes(const ProtocolHeader&) {}
+constexpr void checkLengthPrefixes(const PingCommand&) {}
+constexpr void checkLengthPrefixes(const PingResponse&) {}
+constexpr void checkLengthPrefixes(const GetDeviceInfoCommand&) {}
+constexpr void checkLengthPrefixes(const DeviceInfoResponse&) {}
+constexpr void checkLengthPrefixes(const SendDataCommand& data) {
+    if (data.data.size() > std::numeric_limits<uint16_t>::max()) {
+        BINARY_PROTOCOL_THROW(std::length_error("SendDataCommand.data exceeds its uint16 length prefix"));
+    }
+}
+constexpr void checkLengthPrefixes(const SendDataResponse&) {}
+constexpr void checkLengthPrefixes(const SetConfigCommand& data) {
+    if (data.value.size() > std::numeric_limits<uint8_t>::max()) {
+        BINARY_PROTOCOL_THROW(std::length_error("SetConfigCommand.value exceeds its uint8 length prefix"));
+    }
+}
+constexpr void checkLengthPrefixes(const SetConfigResponse&) {}
+constexpr void checkLengthPrefixes(const BatchCommand& data) {
+    if (data.commands.size() > std::numeric_limits<uint16_t>::max()) {
+        BINARY_PROTOCOL_THROW(std::length_error("BatchCommand.commands exceeds its uint16 length prefix"));
+    }
+}
+constexpr void checkLengthPrefixes(const BatchResponse& data) {
+    if (data.results.size() > std::numeric_limits<uint16_t>::max()) {
+        BINARY_PROTOCOL_THROW(std::length_error("BatchResponse.results exceeds its uint16 length prefix"));
+    }
+}
+constexpr void checkLengthPrefixes(const Vector3D&) {}
+constexpr void checkLengthPrefixes(const SensorData&) {}
+constexpr void checkLengthPrefixes(const SensorDataResponse& data) {
+    if (data.sensors.size() * 29 > std::numeric_limits<uint16_t>::max()) {
+        BINARY_PROTOCOL_THROW(std::length_error("SensorDataResponse.sensors exceeds its uint16 length prefix"));
+    }
+}
+
+size_t serializeInto(const ProtocolHeader& data, std::span<uint8_t> out);
 std::vector<uint8_t> serialize(const ProtocolHeader& data);
 ProtocolHeader deserializeProtocolHeader(const uint8_t* data, size_t size);
+DecodeResult<ProtocolHeader> tryDeserializeProtocolHeader(const uint8_t* data, size_t size);
+size_t serializeInto(const PingCommand& data, std::span<uint8_t> out);
 std::vector<uint8_t> serialize(const PingCommand& data);
 PingCommand deserializePingCommand(const uint8_t* data, size_t size);
+DecodeResult<PingCommand> tryDeserializePingCommand(const uint8_t* data, size_t size);
+size_t serializeInto(const PingResponse& data, std::span<uint8_t> out);
 std::vector<uint8_t> serialize(const PingResponse& data);
 PingResponse deserializePingResponse(const uint8_t* data, size_t size);
+DecodeResult<PingResponse> tryDeserializePingResponse(const uint8_t* data, size_t size);
+size_t serializeInto(const GetDeviceInfoCommand& data, std::span<uint8_t> out);
 std::vector<uint8_t> serialize(const GetDeviceInfoCommand& data);
 GetDeviceInfoCommand deserializeGetDeviceInfoCommand(const uint8_t* data, size_t size);
+DecodeResult<GetDeviceInfoCommand> tryDeserializeGetDeviceInfoCommand(const uint8_t* data, size_t size);
+size_t serializeInto(const DeviceInfoResponse& data, std::span<uint8_t> out);
 std::vector<uint8_t> serialize(const DeviceInfoResponse& data);
 DeviceInfoResponse deserializeDeviceInfoResponse(const uint8_t* data, size_t size);
+DecodeResult<DeviceInfoResponse> tryDeserializeDeviceInfoResponse(const uint8_t* data, size_t size);
+size_t serializeInto(const SendDataCommand& data, std::span<uint8_t> out);
 std::vector<uint8_t> serialize(const SendDataCommand& data);
 SendDataCommand deserializeSendDataCommand(const uint8_t* data, size_t size);
+DecodeResult<SendDataCommand> tryDeserializeSendDataCommand(const uint8_t* data, size_t size);
+SendDataCommandView viewSendDataCommand(const uint8_t* data, size_t size);
+void serializeGather(const SendDataCommand& data, GatherList& out);
+size_t serializeInto(const SendDataResponse& data, std::span<uint8_t> out);
 std::vector<uint8_t> serialize(const SendDataResponse& data);
 SendDataResponse deserializeSendDataResponse(const uint8_t* data, size_t size);
+DecodeResult<SendDataResponse> tryDeserializeSendDataResponse(const uint8_t* data, size_t size);
+size_t serializeInto(const SetConfigCommand& data, std::span<uint8_t> out);
 std::vector<uint8_t> serialize(const SetConfigCommand& data);
 SetConfigCommand deserializeSetConfigCommand(const uint8_t* data, size_t size);
+DecodeResult<SetConfigCommand> tryDeserializeSetConfigCommand(const uint8_t* data, size_t size);
+SetConfigCommandView viewSetConfigCommand(const uint8_t* data, size_t size);
+void serializeGather(const SetConfigCommand& data, GatherList& out);
+size_t serializeInto(const SetConfigResponse& data, std::span<uint8_t> out);
 std::vector<uint8_t> serialize(const SetConfigResponse& data);
 SetConfigResponse deserializeSetConfigResponse(const uint8_t* data, size_t size);
+DecodeResult<SetConfigResponse> tryDeserializeSetConfigResponse(const uint8_t* data, size_t size);
+size_t serializeInto(const BatchCommand& data, std::span<uint8_t> out);
 std::vector<uint8_t> serialize(const BatchCommand& data);
 BatchCommand deserializeBatchCommand(const uint8_t* data, size_t size);
+DecodeResult<BatchCommand> tryDeserializeBatchCommand(const uint8_t* data, size_t size);
+BatchCommandView viewBatchCommand(const uint8_t* data, size_t size);
+void serializeGather(const BatchCommand& data, GatherList& out);
+size_t serializeInto(const BatchResponse& data, std::span<uint8_t> out);
 std::vector<uint8_t> serialize(const BatchResponse& data);
 BatchResponse deserializeBatchResponse(const uint8_t* data, size_t size);
+DecodeResult<BatchResponse> tryDeserializeBatchResponse(const uint8_t* data, size_t size);
+BatchResponseView viewBatchResponse(const uint8_t* data, size_t size);
+void serializeGather(const BatchResponse& data, GatherList& out);
+size_t serializeInto(const Vector3D& data, std::span<uint8_t> out);
 std::vector<uint8_t> serialize(const Vector3D& data);
 Vector3D deserializeVector3D(const uint8_t* data, size_t size);
+DecodeResult<Vector3D> tryDeserializeVector3D(const uint8_t* data, size_t size);
+size_t serializeInto(const SensorData& data, std::span<uint8_t> out);
 std::vector<uint8_t> serialize(const SensorData& data);
 SensorData deserializeSensorData(const uint8_t* data, size_t size);
+DecodeResult<SensorData> tryDeserializeSensorData(const uint8_t* data, size_t size);
+size_t serializeInto(const SensorDataResponse& data, std::span<uint8_t> out);
 std::vector<uint8_t> serialize(const SensorDataResponse& data);
 SensorDataResponse deserializeSensorDataResponse(const uint8_t* data, size_t size);
+DecodeResult<SensorDataResponse> tryDeserializeSensorDataResponse(const uint8_t* data, size_t size);
+SensorDataResponseView viewSensorDataResponse(const uint8_t* data, size_t size);
+void serializeGather(const SensorDataResponse& data, GatherList& out);
+
+/// SensorDataResponse with sensors compact-encoded (@compact); not wire-compatible with serialize()
+void serializeCompact(const SensorDataResponse& data, std::vector<uint8_t>& out);
+std::vector<uint8_t> serializeCompact(const SensorDataResponse& data);
+SensorDataResponse deserializeCompactSensorDataResponse(const uint8_t* data, size_t size);
+DecodeResult<SensorDataResponse> tryDeserializeCompactSensorDataResponse(const uint8_t* data, size_t size);
+
+/**
+ * Appends the encoded message to writer and returns the number of bytes written.
+ * The message is encoded in place in the writer's buffer, so a long-lived writer
+ * that is cleared between messages encodes without allocating.
+ */
+template<typename T, Endian E, typename Alloc>
+    requires requires(const T& message, std::span<uint8_t> out) { serializeInto(message, out); }
+size_t serialize(const T& data, BasicBinaryWriter<E, Alloc>& writer) {
+    checkLengthPrefixes(data);
+    return serializeInto(data, writer.allocate(encodedSize(data)));
+}
+
+// ============================================
+// Compile-time encoding
+// ============================================
+
+constexpr std::array<uint8_t, ProtocolHeader::ENCODED_SIZE> serializeToArray(const ProtocolHeader& data) {
+    std::array<uint8_t, ProtocolHeader::ENCODED_SIZE> out{};
+    detail::store<Endian::Little>(out.data() + 0, data.magic);
+    detail::store<Endian::Little>(out.data() + 2, data.version);
+    detail::store<Endian::Little>(out.data() + 3, data.command_id);
+    detail::store<Endian::Little>(out.data() + 4, data.payload_length);
+    detail::store<Endian::Little>(out.data() + 8, data.sequence_id);
+    detail::store<Endian::Little>(out.data() + 12, data.checksum);
+    return out;
+}
+
+constexpr std::array<uint8_t, PingCommand::ENCODED_SIZE> serializeToArray(const PingCommand& data) {
+    std::array<uint8_t, PingCommand::ENCODED_SIZE> out{};
+    detail::store<Endian::Little>(out.data() + 0, data.timestamp);
+    return out;
+}
+
+constexpr std::array<uint8_t, PingResponse::ENCODED_SIZE> serializeToArray(const PingResponse& data) {
+    std::array<uint8_t, PingResponse::ENCODED_SIZE> out{};
+    detail::store<Endian::Little>(out.data() + 0, data.request_timestamp);
+    detail::store<Endian::Little>(out.data() + 8, data.response_timestamp);
+    return out;
+}
+
+constexpr std::array<uint8_t, GetDeviceInfoCommand::ENCODED_SIZE> serializeToArray(const GetDeviceInfoCommand& data) {
+    std::array<uint8_t, GetDeviceInfoCommand::ENCODED_SIZE> out{};
+    out.data()[0] = data.include_details ? 1 : 0;
+    return out;
+}
+
+constexpr std::array<uint8_t, DeviceInfoResponse::ENCODED_SIZE> serializeToArray(const DeviceInfoResponse& data) {
+    std::array<uint8_t, DeviceInfoResponse::ENCODED_SIZE> out{};
+    out.data()[0] = static_cast<uint8_t>(data.status);
+    std::copy_n(data.device_name.data(), 32, out.data() + 1);
+    std::copy_n(data.firmware_version.data(), 16, out.data() + 33);
+    detail::store<Endian::Little>(out.data() + 49, data.uptime_seconds);
+    detail::store<Endian::Little>(out.data() + 53, static_cast<uint16_t>(data.temperature));
+    detail::store<Endian::Little>(out.data() + 55, data.battery_level);
+    return out;
+}
+
+/// N must equal encodedSize(data); the message owns vectors, so call this inside a constexpr lambda
+template<size_t N>
+constexpr std::array<uint8_t, N> serializeToArray(const SendDataCommand& data) {
+    checkLengthPrefixes(data);
+    if (encodedSize(data) != N) BINARY_PROTOCOL_THROW(std::length_error("serializeToArray size does not match encodedSize"));
+    std::array<uint8_t, N> out{};
+    uint8_t* p = out.data();
+    detail::store<Endian::Little>(p + 0, data.channel);
+    detail::store<Endian::Little>(p + 1, data.priority);
+    detail::store<Endian::Little>(p + 2, static_cast<uint16_t>(data.data.size()));
+    p += 4;
+    p = std::copy(data.data.begin(), data.data.end(), p);
+    return out;
+}
+
+constexpr std::array<uint8_t, SendDataResponse::ENCODED_SIZE> serializeToArray(const SendDataResponse& data) {
+    std::array<uint8_t, SendDataResponse::ENCODED_SIZE> out{};
+    out.data()[0] = data.success ? 1 : 0;
+    out.data()[1] = static_cast<uint8_t>(data.error_code);
+    detail::store<Endian::Little>(out.data() + 2, data.bytes_written);
+    return out;
+}
+
+/// N must equal encodedSize(data); the message owns vectors, so call this inside a constexpr lambda
+template<size_t N>
+constexpr std::array<uint8_t, N> serializeToArray(const SetConfigCommand& data) {
+    checkLengthPrefixes(data);
+    if (encodedSize(data) != N) BINARY_PROTOCOL_THROW(std::length_error("serializeToArray size does not match encodedSize"));
+    std::array<uint8_t, N> out{};
+    uint8_t* p = out.data();
+    detail::store<Endian::Little>(p + 0, data.config_id);
+    detail::store<Endian::Little>(p + 1, data.value_type);
+    detail::store<Endian::Little>(p + 2, static_cast<uint8_t>(data.value.size()));
+    p += 3;
+    p = std::copy(data.value.begin(), data.value.end(), p);
+    return out;
+}
+
+constexpr std::array<uint8_t, SetConfigResponse::ENCODED_SIZE> serializeToArray(const SetConfigResponse& data) {
+    std::array<uint8_t, SetConfigResponse::ENCODED_SIZE> out{};
+    out.data()[0] = data.success ? 1 : 0;
+    out.data()[1] = static_cast<uint8_t>(data.error_code);
+    return out;
+}
+
+/// N must equal encodedSize(data); the message owns vectors, so call this inside a constexpr lambda
+template<size_t N>
+constexpr std::array<uint8_t, N> serializeToArray(const BatchCommand& data) {
+    checkLengthPrefixes(data);
+    if (encodedSize(data) != N) BINARY_PROTOCOL_THROW(std::length_error("serializeToArray size does not match encodedSize"));
+    std::array<uint8_t, N> out{};
+    uint8_t* p = out.data();
+    detail::store<Endian::Little>(p + 0, data.command_count);
+    detail::store<Endian::Little>(p + 1, static_cast<uint16_t>(data.commands.size()));
+    p += 3;
+    p = std::copy(data.commands.begin(), data.commands.end(), p);
+    return out;
+}
+
+/// N must equal encodedSize(data); the message owns vectors, so call this inside a constexpr lambda
+template<size_t N>
+constexpr std::array<uint8_t, N> serializeToArray(const BatchResponse& data) {
+    checkLengthPrefixes(data);
+    if (encodedSize(data) != N) BINARY_PROTOCOL_THROW(std::length_error("serializeToArray size does not match encodedSize"));
+    std::array<uint8_t, N> out{};
+    uint8_t* p = out.data();
+    detail::store<Endian::Little>(p + 0, data.success_count);
+    detail::store<Endian::Little>(p + 1, data.failure_count);
+    detail::store<Endian::Little>(p + 2, static_cast<uint16_t>(data.results.size()));
+    p += 4;
+    p = std::copy(data.results.begin(), data.results.end(), p);
+    return out;
+}
+
+constexpr std::array<uint8_t, Vector3D::ENCODED_SIZE> serializeToArray(const Vector3D& data) {
+    std::array<uint8_t, Vector3D::ENCODED_SIZE> out{};
+    detail::store<Endian::Little>(out.data() + 0, std::bit_cast<uint32_t>(float{data.x}));
+    detail::store<Endian::Little>(out.data() + 4, std::bit_cast<uint32_t>(float{data.y}));
+    detail::store<Endian::Little>(out.data() + 8, std::bit_cast<uint32_t>(float{data.z}));
+    return out;
+}
+
+constexpr std::array<uint8_t, SensorData::ENCODED_SIZE> serializeToArray(const SensorData& data) {
+    std::array<uint8_t, SensorData::ENCODED_SIZE> out{};
+    detail::store<Endian::Little>(out.data() + 0, data.timestamp);
+    detail::store<Endian::Little>(out.data() + 8, data.sensor_id);
+    detail::store<Endian::Little>(out.data() + 9, std::bit_cast<uint32_t>(float{data.position.x}));
+    detail::store<Endian::Little>(out.data() + 13, std::bit_cast<uint32_t>(float{data.position.y}));
+    detail::store<Endian::Little>(out.data() + 17, std::bit_cast<uint32_t>(float{data.position.z}));
+    detail::store<Endian::Little>(out.data() + 21, std::bit_cast<uint32_t>(float{data.temperature}));
+    detail::store<Endian::Little>(out.data() + 25, std::bit_cast<uint32_t>(float{data.humidity}));
+    return out;
+}
+
+/// N must equal encodedSize(data); the message owns vectors, so call this inside a constexpr lambda
+template<size_t N>
+constexpr std::array<uint8_t, N> serializeToArray(const SensorDataResponse& data) {
+    checkLengthPrefixes(data);
+    if (encodedSize(data) != N) BINARY_PROTOCOL_THROW(std::length_error("serializeToArray size does not match encodedSize"));
+    std::array<uint8_t, N> out{};
+    uint8_t* p = out.data();
+    detail::store<Endian::Little>(p + 0, data.sensor_count);
+    detail::store<Endian::Little>(p + 1, static_cast<uint16_t>(data.sensors.size() * SensorData::ENCODED_SIZE));
+    p += 3;
+    for (const SensorData& element : data.sensors) {
+        detail::store<Endian::Little>(p + 0, element.timestamp);
+        detail::store<Endian::Little>(p + 8, element.sensor_id);
+        detail::store<Endian::Little>(p + 9, std::bit_cast<uint32_t>(float{element.position.x}));
+        detail::store<Endian::Little>(p + 13, std::bit_cast<uint32_t>(float{element.position.y}));
+        detail::store<Endian::Little>(p + 17, std::bit_cast<uint32_t>(float{element.position.z}));
+        detail::store<Endian::Little>(p + 21, std::bit_cast<uint32_t>(float{element.temperature}));
+        detail::store<Endian::Little>(p + 25, std::bit_cast<uint32_t>(float{element.humidity}));
+        p += SensorData::ENCODED_SIZE;
+    }
+    return out;
+}
+
+/**
+ * Compile-time metadata for every message with a COMMAND_ID
+ */
+template<typename T>
+struct MessageTraits;
+
+template<>
+struct MessageTraits<PingCommand> {
+    static constexpr uint8_t COMMAND_ID = PingCommand::COMMAND_ID;
+    static constexpr const char* NAME = "PingCommand";
+    static PingCommand decode(const uint8_t* data, size_t size) { return deserializePingCommand(data, size); }
+    static DecodeResult<PingCommand> tryDecode(const uint8_t* data, size_t size) { return tryDeserializePingCommand(data, size); }
+};
+
+template<>
+struct MessageTraits<PingResponse> {
+    static constexpr uint8_t COMMAND_ID = PingResponse::COMMAND_ID;
+    static constexpr const char* NAME = "PingResponse";
+    static PingResponse decode(const uint8_t* data, size_t size) { return deserializePingResponse(data, size); }
+    static DecodeResult<PingResponse> tryDecode(const uint8_t* data, size_t size) { return tryDeserializePingResponse(data, size); }
+};
+
+template<>
+struct MessageTraits<GetDeviceInfoCommand> {
+    static constexpr uint8_t COMMAND_ID = GetDeviceInfoCommand::COMMAND_ID;
+    static constexpr const char* NAME = "GetDeviceInfoCommand";
+    static GetDeviceInfoCommand decode(const uint8_t* data, size_t size) { return deserializeGetDeviceInfoCommand(data, size); }
+    static DecodeResult<GetDeviceInfoCommand> tryDecode(const uint8_t* data, size_t size) { return tryDeserializeGetDeviceInfoCommand(data, size); }
+};
+
+template<>
+struct MessageTraits<DeviceInfoResponse> {
+    static constexpr uint8_t COMMAND_ID = DeviceInfoResponse::COMMAND_ID;
+    static constexpr const char* NAME = "DeviceInfoResponse";
+    static DeviceInfoResponse decode(const uint8_t* data, size_t size) { return deserializeDeviceInfoResponse(data, size); }
+    static DecodeResult<DeviceInfoResponse> tryDecode(const uint8_t* data, size_t size) { return tryDeserializeDeviceInfoResponse(data, size); }
+};
+
+template<>
+struct MessageTraits<SendDataCommand> {
+    static constexpr uint8_t COMMAND_ID = SendDataCommand::COMMAND_ID;
+    static constexpr const char* NAME = "SendDataCommand";
+    static SendDataCommand decode(const uint8_t* data, size_t size) { return deserializeSendDataCommand(data, size); }
+    static DecodeResult<SendDataCommand> tryDecode(const uint8_t* data, size_t size) { return tryDeserializeSendDataCommand(data, size); }
+};
+
+template<>
+struct MessageTraits<SendDataResponse> {
+    static constexpr uint8_t COMMAND_ID = SendDataResponse::COMMAND_ID;
+    static constexpr const char* NAME = "SendDataResponse";
+    static SendDataResponse decode(const uint8_t* data, size_t size) { return deserializeSendDataResponse(data, size); }
+    static DecodeResult<SendDataResponse> tryDecode(const uint8_t* data, size_t size) { return tryDeserializeSendDataResponse(data, size); }
+};
+
+template<>
+struct MessageTraits<SetConfigCommand> {
+    static constexpr uint8_t COMMAND_ID = SetConfigCommand::COMMAND_ID;
+    static constexpr const char* NAME = "SetConfigCommand";
+    static SetConfigCommand decode(const uint8_t* data, size_t size) { return deserializeSetConfigCommand(data, size); }
+    static DecodeResult<SetConfigCommand> tryDecode(const uint8_t* data, size_t size) { return tryDeserializeSetConfigCommand(data, size); }
+};
+
+template<>
+struct MessageTraits<SetConfigResponse> {
+    static constexpr uint8_t COMMAND_ID = SetConfigResponse::COMMAND_ID;
+    static constexpr const char* NAME = "SetConfigResponse";
+    static SetConfigResponse decode(const uint8_t* data, size_t size) { return deserializeSetConfigResponse(data, size); }
+    static DecodeResult<SetConfigResponse> tryDecode(const uint8_t* data, size_t size) { return tryDeserializeSetConfigResponse(data, size); }
+};
+
+template<>
+struct MessageTraits<BatchCommand> {
+    static constexpr uint8_t COMMAND_ID = BatchCommand::COMMAND_ID;
+    static constexpr const char* NAME = "BatchCommand";
+    static BatchCommand decode(const uint8_t* data, size_t size) { return deserializeBatchCommand(data, size); }
+    static DecodeResult<BatchCommand> tryDecode(const uint8_t* data, size_t size) { return tryDeserializeBatchCommand(data, size); }
+};
+
+template<>
+struct MessageTraits<BatchResponse> {
+    static constexpr uint8_t COMMAND_ID = BatchResponse::COMMAND_ID;
+    static constexpr const char* NAME = "BatchResponse";
+    static BatchResponse decode(const uint8_t* data, size_t size) { return deserializeBatchResponse(data, size); }
+    static DecodeResult<BatchResponse> tryDecode(const uint8_t* data, size_t size) { return tryDeserializeBatchResponse(data, size); }
+};
+
+template<>
+struct MessageTraits<SensorDataResponse> {
+    static constexpr uint8_t COMMAND_ID = SensorDataResponse::COMMAND_ID;
+    static constexpr const char* NAME = "SensorDataResponse";
+    static SensorDataResponse decode(const uint8_t* data, size_t size) { return deserializeSensorDataResponse(data, size); }
+    static DecodeResult<SensorDataResponse> tryDecode(const uint8_t* data, size_t size) { return tryDeserializeSensorDataResponse(data, size); }
+};
+
+/// Every command and response of the protocol
+using Message = std::variant<
+    PingCommand,
+    PingResponse,
+    GetDeviceInfoCommand,
+    DeviceInfoResponse,
+    SendDataCommand,
+    SendDataResponse,
+    SetConfigCommand,
+    SetConfigResponse,
+    BatchCommand,
+    BatchResponse,
+    SensorDataResponse
+>;
+
+namespace detail {
+
+template<typename Visitor>
+using DispatchFn = bool (*)(std::span<const uint8_t>, Visitor&);
+
+template<typename T, typename Visitor>
+bool dispatchAs(std::span<const uint8_t> payload, Visitor& visitor) {
+    visitor(MessageTraits<T>::decode(payload.data(), payload.size()));
+    return true;
+}
+
+template<typename Visitor>
+bool dispatchUnknown(std::span<const uint8_t>, Visitor&) {
+    return false;
+}
+
+template<typename Visitor, typename... Ts>
+constexpr std::array<DispatchFn<Visitor>, 256> makeDispatchTable() {
+    std::array<DispatchFn<Visitor>, 256> table{};
+    table.fill(&dispatchUnknown<Visitor>);
+    ((table[MessageTraits<Ts>::COMMAND_ID] = &dispatchAs<Ts, Visitor>), ...);
+    return table;
+}
+
+template<typename Visitor, typename Variant>
+struct DispatchTable;
+
+/// One 256-entry jump table per visitor type, built at compile time
+template<typename Visitor, typename... Ts>
+struct DispatchTable<Visitor, std::variant<Ts...>> {
+    static constexpr std::array<DispatchFn<Visitor>, 256> entries = makeDispatchTable<Visitor, Ts...>();
+};
+
+} // namespace detail
+
+/**
+ * Decode payload as the message selected by commandId and pass it to visitor,
+ * which must accept every Message alternative (a generic lambda works).
+ * Returns false for command IDs that are not part of the protocol.
+ */
+template<typename Visitor>
+bool dispatch(uint8_t commandId, std::span<const uint8_t> payload, Visitor&& visitor) {
+    using Table = detail::DispatchTable<std::remove_reference_t<Visitor>, Message>;
+    return Table::entries[commandId](payload, visitor);
+}
+
+template<typename Visitor>
+bool dispatch(const ProtocolHeader& header, std::span<const uint8_t> payload, Visitor&& visitor) {
+    return dispatch(header.command_id, payload, std::forward<Visitor>(visitor));
+}
+
+/// Decode payload into the Message alternative selected by commandId
+inline std::optional<Message> decodeMessage(uint8_t commandId, std::span<const uint8_t> payload) {
+    std::optional<Message> result;
+    dispatch(commandId, payload, [&result](auto&& message) { result.emplace(std::move(message)); });
+    return result;
+}
+
+namespace detail {
+
+using TryDecodeFn = DecodeResult<Message> (*)(std::span<const uint8_t>);
+
+template<typename T>
+DecodeResult<Message> tryDecodeAs(std::span<const uint8_t> payload) {
+    DecodeResult<T> result = MessageTraits<T>::tryDecode(payload.data(), payload.size());
+    if (!result) return result.error();
+    return Message(std::in_place_type<T>, std::move(*result));
+}
+
+inline DecodeResult<Message> tryDecodeUnknown(std::span<const uint8_t>) {
+    return DecodeError::UnknownCommand;
+}
+
+template<typename... Ts>
+constexpr std::array<TryDecodeFn, 256> makeTryDecodeTable(std::type_identity<std::variant<Ts...>>) {
+    std::array<TryDecodeFn, 256> table{};
+    table.fill(&tryDecodeUnknown);
+    ((table[MessageTraits<Ts>::COMMAND_ID] = &tryDecodeAs<Ts>), ...);
+    return table;
+}
+
+inline constexpr std::array<TryDecodeFn, 256> kTryDecodeTable = makeTryDecodeTable(std::type_identity<Message>{});
+
+} // namespace detail
+
+/// No-throw decodeMessage(); unknown command IDs yield DecodeError::UnknownCommand
+inline DecodeResult<Message> tryDecodeMessage(uint8_t commandId, std::span<const uint8_t> payload) {
+    return detail::kTryDecodeTable[commandId](payload);
+}
+
+// ============================================
+// Batches
+// ============================================
+
+/// Each sub-message of a batch field is [command_id u8][length u16][payload]
+inline constexpr size_t BATCH_ENTRY_HEADER_SIZE = 3;
+
+/// One sub-message of a batch field; payload borrows from the batch bytes
+struct BatchEntry {
+    uint8_t commandId;
+    std::span<const uint8_t> payload;
+
+    template<typename T>
+    T as() const {
+        if (commandId != MessageTraits<T>::COMMAND_ID) BINARY_PROTOCOL_THROW(std::runtime_error("Batch entry command ID mismatch"));
+        return MessageTraits<T>::decode(payload.data(), payload.size());
+    }
+
+    /// as() for untrusted input: UnknownCommand when the entry holds another command
+    template<typename T>
+    DecodeResult<T> tryAs() const {
+        if (commandId != MessageTraits<T>::COMMAND_ID) return DecodeError::UnknownCommand;
+        return MessageTraits<T>::tryDecode(payload.data(), payload.size());
+    }
+
+    std::optional<Message> decode() const { return decodeMessage(commandId, payload); }
+};
+
+/**
+ * Walks the sub-messages of a batch field in place.
+ * Entry headers are validated as the iterator reaches them; a truncated entry throws.
+ * tryDeserialize runs validate() first, so entries of a batch it accepted never throw.
+ */
+template<Endian E>
+class BasicBatchEntries {
+public:
+    class Iterator {
+    public:
+        Iterator(const uint8_t* position, const uint8_t* end) : position_(position), end_(end) { load(); }
+        const BatchEntry& operator*() const { return entry_; }
+        const BatchEntry* operator->() const { return &entry_; }
+        Iterator& operator++() {
+            position_ = entry_.payload.data() + entry_.payload.size();
+            load();
+            return *this;
+        }
+        bool operator==(const Iterator& other) const { return position_ == other.position_; }
+        bool operator!=(const Iterator& other) const { return position_ != other.position_; }
+
+    private:
+        void load() {
+            if (position_ == end_) return;
+            const size_t available = static_cast<size_t>(end_ - position_);
+            if (available < BATCH_ENTRY_HEADER_SIZE) BINARY_PROTOCOL_THROW(std::runtime_error("Truncated batch entry"));
+            const size_t length = detail::load<E, uint16_t>(position_ + 1);
+            if (available - BATCH_ENTRY_HEADER_SIZE < length) BINARY_PROTOCOL_THROW(std::runtime_error("Truncated batch entry"));
+            entry_ = {position_[0], {position_ + BATCH_ENTRY_HEADER_SIZE, length}};
+        }
+
+        const uint8_t* position_;
+        const uint8_t* end_;
+        BatchEntry entry_{};
+    };
+
+    explicit BasicBatchEntries(std::span<const uint8_t> bytes) : bytes_(bytes) {}
+
+    Iterator begin() const { return Iterator(bytes_.data(), bytes_.data() + bytes_.size()); }
+    Iterator end() const { return Iterator(bytes_.data() + bytes_.size(), bytes_.data() + bytes_.size()); }
+    std::span<const uint8_t> bytes() const { return bytes_; }
+
+    /// Checks the framing of every entry without decoding payloads
+    std::optional<DecodeError> validate() const {
+        const uint8_t* position = bytes_.data();
+        const uint8_t* const end = position + bytes_.size();
+        while (position != end) {
+            const size_t available = static_cast<size_t>(end - position);
+            if (available < BATCH_ENTRY_HEADER_SIZE) return DecodeError::Truncated;
+            const size_t length = detail::load<E, uint16_t>(position + 1);
+            if (available - BATCH_ENTRY_HEADER_SIZE < length) return DecodeError::Truncated;
+            position += BATCH_ENTRY_HEADER_SIZE + length;
+        }
+        return std::nullopt;
+    }
+
+private:
+    std::span<const uint8_t> bytes_;
+};
+
+namespace detail {
+
+/// Batch results without a success field count as successes
+template<typename T>
+constexpr bool batchResultSucceeded(const T& result) {
+    if constexpr (requires { result.success; }) {
+        return result.success;
+    } else {
+        return true;
+    }
+}
+
+} // namespace detail
+
+/**
+ * Builds a BatchCommand in place at the end of a writer's buffer.
+ * Sub-messages are encoded straight into commands; finish() back-patches
+ * command_count and the length prefix.
+ */
+template<Endian E, typename Alloc>
+class BatchCommandBuilder {
+public:
+    explicit BatchCommandBuilder(BasicBinaryWriter<E, Alloc>& writer) : writer_(writer), start_(writer.size()) {
+        writer_.allocate(BODY_OFFSET);
+    }
+
+    template<typename T>
+    BatchCommandBuilder& add(const T& message) {
+        checkLengthPrefixes(message);
+        const size_t size = encodedSize(message);
+        if (bodySize_ + BATCH_ENTRY_HEADER_SIZE + size > std::numeric_limits<uint16_t>::max() ||
+            size > std::numeric_limits<uint16_t>::max()) {
+            BINARY_PROTOCOL_THROW(std::runtime_error("BatchCommand too large"));
+        }
+        if (command_count_ == std::numeric_limits<decltype(BatchCommand::command_count)>::max()) {
+            BINARY_PROTOCOL_THROW(std::runtime_error("Too many BatchCommand entries"));
+        }
+        ++command_count_;
+        std::span<uint8_t> out = writer_.allocate(BATCH_ENTRY_HEADER_SIZE + size);
+        out[0] = MessageTraits<T>::COMMAND_ID;
+        detail::store<Endian::Little>(out.data() + 1, static_cast<uint16_t>(size));
+        serializeInto(message, out.subspan(BATCH_ENTRY_HEADER_SIZE));
+        bodySize_ += BATCH_ENTRY_HEADER_SIZE + size;
+        return *this;
+    }
+
+    /// Writes the counts and length prefix; returns the encoded BatchCommand size
+    size_t finish() {
+        writer_.template patch<decltype(BatchCommand::command_count), Endian::Little>(start_ + 0, command_count_);
+        writer_.template patch<uint16_t, Endian::Little>(start_ + 1, static_cast<uint16_t>(bodySize_));
+        return BODY_OFFSET + bodySize_;
+    }
+
+    decltype(BatchCommand::command_count) command_count() const { return command_count_; }
+
+private:
+    static constexpr size_t BODY_OFFSET = 3;
+
+    BasicBinaryWriter<E, Alloc>& writer_;
+    size_t start_;
+    size_t bodySize_ = 0;
+    decltype(BatchCommand::command_count) command_count_ = 0;
+};
+
+using BatchCommandEntries = BasicBatchEntries<Endian::Little>;
+
+/**
+ * Builds a BatchResponse in place at the end of a writer's buffer.
+ * Sub-messages are encoded straight into results; finish() back-patches
+ * success_count, failure_count and the length prefix.
+ */
+template<Endian E, typename Alloc>
+class BatchResponseBuilder {
+public:
+    explicit BatchResponseBuilder(BasicBinaryWriter<E, Alloc>& writer) : writer_(writer), start_(writer.size()) {
+        writer_.allocate(BODY_OFFSET);
+    }
+
+    template<typename T>
+    BatchResponseBuilder& add(const T& message) {
+        checkLengthPrefixes(message);
+        const size_t size = encodedSize(message);
+        if (bodySize_ + BATCH_ENTRY_HEADER_SIZE + size > std::numeric_limits<uint16_t>::max() ||
+            size > std::numeric_limits<uint16_t>::max()) {
+            BINARY_PROTOCOL_THROW(std::runtime_error("BatchResponse too large"));
+        }
+        decltype(BatchResponse::success_count)& counter = detail::batchResultSucceeded(message) ? success_count_ : failure_count_;
+        if (counter == std::numeric_limits<decltype(BatchResponse::success_count)>::max()) {
+            BINARY_PROTOCOL_THROW(std::runtime_error("Too many BatchResponse entries"));
+        }
+        ++counter;
+        std::span<uint8_t> out = writer_.allocate(BATCH_ENTRY_HEADER_SIZE + size);
+        out[0] = MessageTraits<T>::COMMAND_ID;
+        detail::store<Endian::Little>(out.data() + 1, static_cast<uint16_t>(size));
+        serializeInto(message, out.subspan(BATCH_ENTRY_HEADER_SIZE));
+        bodySize_ += BATCH_ENTRY_HEADER_SIZE + size;
+        return *this;
+    }
+
+    /// Writes the counts and length prefix; returns the encoded BatchResponse size
+    size_t finish() {
+        writer_.template patch<decltype(BatchResponse::success_count), Endian::Little>(start_ + 0, success_count_);
+        writer_.template patch<decltype(BatchResponse::failure_count), Endian::Little>(start_ + 1, failure_count_);
+        writer_.template patch<uint16_t, Endian::Little>(start_ + 2, static_cast<uint16_t>(bodySize_));
+        return BODY_OFFSET + bodySize_;
+    }
+
+    decltype(BatchResponse::success_count) success_count() const { return success_count_; }
+    decltype(BatchResponse::failure_count) failure_count() const { return failure_count_; }
+
+private:
+    static constexpr size_t BODY_OFFSET = 4;
+
+    BasicBinaryWriter<E, Alloc>& writer_;
+    size_t start_;
+    size_t bodySize_ = 0;
+    decltype(BatchResponse::success_count) success_count_ = 0;
+    decltype(BatchResponse::failure_count) failure_count_ = 0;
+};
+
+using BatchResponseEntries = BasicBatchEntries<Endian::Little>;
+
+// ============================================
+// Frame checksum
+// ============================================
+
+/// Selected by @checksum(crc16_ccitt) on ProtocolHeader::checksum
+using FrameChecksum = Crc16Ccitt;
+
+namespace detail {
+
+/// Checksum of an encoded ProtocolHeader (skipping checksum) and its payload
+constexpr FrameChecksum::value_type frameChecksum(const uint8_t* header, std::span<const uint8_t> payload) {
+    FrameChecksum checksum;
+    checksum.update({header, 12});
+    checksum.update(payload);
+    return checksum.value();
+}
+
+} // namespace detail
+
+/**
+ * Checksum over the encoded ProtocolHeader (with checksum itself excluded)
+ * followed by the payload.
+ */
+FrameChecksum::value_type computeFrameChecksum(const ProtocolHeader& header, std::span<const uint8_t> payload);
+
+/// Sets payload_length and checksum for the given payload
+void sealFrame(ProtocolHeader& header, std::span<const uint8_t> payload);
+
+bool verifyFrame(const ProtocolHeader& header, std::span<const uint8_t> payload);
+
+/// In-place variants over an encoded frame (header followed by payload), e.g. Frame::bytes
+void sealFrame(std::span<uint8_t> frame);
+
+bool verifyFrame(std::span<const uint8_t> frame);
+
+// ============================================
+// Compile-time frames
+// ============================================
+
+/**
+ * Frame around an encoded payload, usable as a constant expression.
+ * magic, command_id and payload_length are filled in and checksum is computed.
+ */
+template<typename T, size_t N>
+constexpr std::array<uint8_t, ProtocolHeader::ENCODED_SIZE + N> makeFrame(ProtocolHeader header, const std::array<uint8_t, N>& payload) {
+    header.magic = ProtocolHeader::MAGIC;
+    header.command_id = MessageTraits<T>::COMMAND_ID;
+    header.payload_length = static_cast<decltype(header.payload_length)>(N);
+    std::array<uint8_t, ProtocolHeader::ENCODED_SIZE + N> frame{};
+    const std::array<uint8_t, ProtocolHeader::ENCODED_SIZE> encodedHeader = serializeToArray(header);
+    std::copy(encodedHeader.begin(), encodedHeader.end(), frame.begin());
+    std::copy(payload.begin(), payload.end(), frame.begin() + ProtocolHeader::ENCODED_SIZE);
+    detail::store<Endian::Little>(frame.data() + 12,
+        detail::frameChecksum(frame.data(), {frame.data() + ProtocolHeader::ENCODED_SIZE, N}));
+    return frame;
+}
+
+/// Frame for a fixed-size message, e.g. constexpr auto heartbeat = makeFrame(ProtocolHeader{}, PingCommand{});
+template<typename T>
+    requires requires { T::ENCODED_SIZE; MessageTraits<T>::COMMAND_ID; }
+constexpr auto makeFrame(const ProtocolHeader& header, const T& message) {
+    return makeFrame<T>(header, serializeToArray(message));
+}
+
+/**
+ * Appends a frame: ProtocolHeader in the inline buffer followed by the message
+ * segments. magic, command_id and payload_length are filled in, and checksum
+ * is computed over the segments without copying them.
+ */
+template<typename T>
+    requires requires { MessageTraits<T>::COMMAND_ID; }
+void serializeGather(ProtocolHeader header, const T& message, GatherList& out) {
+    const size_t start = out.size();
+    const std::span<uint8_t> head = out.allocate(ProtocolHeader::ENCODED_SIZE);
+    serializeGather(message, out);
+    header.magic = ProtocolHeader::MAGIC;
+    header.command_id = MessageTraits<T>::COMMAND_ID;
+    header.payload_length = static_cast<decltype(header.payload_length)>(out.size() - start - ProtocolHeader::ENCODED_SIZE);
+    serializeInto(header, head);
+    FrameChecksum checksum;
+    checksum.update(head.first(12));
+    checksum.update(head.subspan(14));
+    out.visit(start + ProtocolHeader::ENCODED_SIZE, [&](std::span<const uint8_t> bytes) { checksum.update(bytes); });
+    detail::store<Endian::Little>(head.data() + 12, checksum.value());
+}
 
 } // namespace binaryprotocol
 
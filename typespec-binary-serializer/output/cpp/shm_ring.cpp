@@ -0,0 +1,274 @@
+/**
+ * Auto-generated shared-memory broadcast ring implementation
+ */
+
+#include "shm_ring.hpp"
+
+#include <algorithm>
+#include <array>
+#include <bit>
+#include <cerrno>
+#include <cstring>
+#include <stdexcept>
+#include <system_error>
+#include <utility>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace binaryprotocol {
+
+namespace {
+
+/// "TBSSHM01", stored as one word so that readers can wait for it atomically
+constexpr uint64_t RING_MAGIC = std::bit_cast<uint64_t>(std::array<char, 8>{'T', 'B', 'S', 'S', 'H', 'M', '0', '1'});
+constexpr size_t MAGIC_OFFSET = 0;
+constexpr size_t VERSION_OFFSET = 8;
+constexpr size_t SLOT_COUNT_OFFSET = 12;
+constexpr size_t SLOT_SIZE_OFFSET = 16;
+/// Separate cache line from the read-mostly fields above
+constexpr size_t PUBLISHED_OFFSET = 64;
+constexpr size_t SLOT_LENGTH_OFFSET = 8;
+
+[[noreturn]] void throwErrno(int error, const std::string& what) {
+    BINARY_PROTOCOL_THROW(std::system_error(error, std::generic_category(), what));
+}
+
+size_t regionSize(uint32_t slotCount, uint32_t slotSize) {
+    return SHM_RING_HEADER_SIZE + static_cast<size_t>(slotCount) * detail::shmSlotStride(slotSize);
+}
+
+/// Maps fd, closing it first when closeFd is set; the mapping keeps the region alive
+detail::ShmMapping mapRegion(int fd, size_t size, int protection, bool closeFd) {
+    void* mapped = ::mmap(nullptr, size, protection, MAP_SHARED, fd, 0);
+    const int error = errno;
+    if (closeFd) ::close(fd);
+    if (mapped == MAP_FAILED) throwErrno(error, "Failed to map shared-memory ring");
+    return detail::ShmMapping(static_cast<uint8_t*>(mapped), size);
+}
+
+detail::ShmMapping mapReadOnly(int fd, bool closeFd) {
+    struct stat info {};
+    if (::fstat(fd, &info) != 0) {
+        const int error = errno;
+        if (closeFd) ::close(fd);
+        throwErrno(error, "Failed to stat shared-memory ring");
+    }
+    const size_t size = static_cast<size_t>(info.st_size);
+    if (size < SHM_RING_HEADER_SIZE) {
+        if (closeFd) ::close(fd);
+        BINARY_PROTOCOL_THROW(std::runtime_error("Not a shared-memory ring"));
+    }
+    return mapRegion(fd, size, PROT_READ, closeFd);
+}
+
+} // namespace
+
+// ============================================
+// Mapping
+// ============================================
+
+detail::ShmMapping::~ShmMapping() {
+    if (data_ != nullptr) ::munmap(data_, size_);
+}
+
+detail::ShmMapping::ShmMapping(ShmMapping&& other) noexcept
+    : data_(std::exchange(other.data_, nullptr)), size_(std::exchange(other.size_, 0)) {}
+
+detail::ShmMapping& detail::ShmMapping::operator=(ShmMapping&& other) noexcept {
+    if (this != &other) {
+        if (data_ != nullptr) ::munmap(data_, size_);
+        data_ = std::exchange(other.data_, nullptr);
+        size_ = std::exchange(other.size_, 0);
+    }
+    return *this;
+}
+
+// ============================================
+// Writer
+// ============================================
+
+ShmRingWriter ShmRingWriter::create(const std::string& name, ShmRingOptions options) {
+    const int fd = ::shm_open(name.c_str(), O_RDWR | O_CREAT | O_TRUNC | O_CLOEXEC, 0600);
+    if (fd < 0) throwErrno(errno, "Failed to create shared memory " + name);
+    return createFromFd(fd, options);
+}
+
+ShmRingWriter ShmRingWriter::createAnonymous(ShmRingOptions options) {
+    const int fd = ::memfd_create("binaryprotocol-shm-ring", MFD_CLOEXEC);
+    if (fd < 0) throwErrno(errno, "Failed to create memfd");
+    return createFromFd(fd, options);
+}
+
+void ShmRingWriter::unlink(const std::string& name) {
+    if (::shm_unlink(name.c_str()) != 0 && errno != ENOENT) throwErrno(errno, "Failed to unlink shared memory " + name);
+}
+
+ShmRingWriter ShmRingWriter::createFromFd(int fd, ShmRingOptions options) {
+    if (options.slotCount == 0 || !std::has_single_bit(options.slotCount)) {
+        ::close(fd);
+        BINARY_PROTOCOL_THROW(std::invalid_argument("Shared-memory ring slot count must be a power of two"));
+    }
+    if (options.slotSize < ProtocolHeader::ENCODED_SIZE) {
+        ::close(fd);
+        BINARY_PROTOCOL_THROW(std::invalid_argument("Shared-memory ring slots must hold at least a ProtocolHeader"));
+    }
+    const size_t size = regionSize(options.slotCount, options.slotSize);
+    if (::ftruncate(fd, static_cast<off_t>(size)) != 0) {
+        const int error = errno;
+        ::close(fd);
+        throwErrno(error, "Failed to size shared-memory ring");
+    }
+    void* mapped = ::mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    if (mapped == MAP_FAILED) {
+        const int error = errno;
+        ::close(fd);
+        throwErrno(error, "Failed to map shared-memory ring");
+    }
+    return ShmRingWriter(fd, detail::ShmMapping(static_cast<uint8_t*>(mapped), size), options);
+}
+
+ShmRingWriter::ShmRingWriter(int fd, detail::ShmMapping mapping, ShmRingOptions options)
+    : fd_(fd), mapping_(std::move(mapping)), slotCount_(options.slotCount), slotSize_(options.slotSize),
+      stride_(detail::shmSlotStride(options.slotSize)) {
+    // The region starts zeroed: no frame published, every slot state 0 (empty)
+    uint8_t* base = mapping_.data();
+    std::memcpy(base + VERSION_OFFSET, &SHM_RING_VERSION, sizeof(SHM_RING_VERSION));
+    std::memcpy(base + SLOT_COUNT_OFFSET, &slotCount_, sizeof(slotCount_));
+    std::memcpy(base + SLOT_SIZE_OFFSET, &slotSize_, sizeof(slotSize_));
+    // Readers treat the region as initialized once they see the magic
+    detail::shmWord(base + MAGIC_OFFSET).store(RING_MAGIC, std::memory_order_release);
+}
+
+ShmRingWriter::~ShmRingWriter() {
+    if (fd_ >= 0) ::close(fd_);
+}
+
+ShmRingWriter::ShmRingWriter(ShmRingWriter&& other) noexcept
+    : fd_(std::exchange(other.fd_, -1)), mapping_(std::move(other.mapping_)), slotCount_(other.slotCount_),
+      slotSize_(other.slotSize_), stride_(other.stride_), next_(other.next_) {}
+
+ShmRingWriter& ShmRingWriter::operator=(ShmRingWriter&& other) noexcept {
+    if (this != &other) {
+        if (fd_ >= 0) ::close(fd_);
+        fd_ = std::exchange(other.fd_, -1);
+        mapping_ = std::move(other.mapping_);
+        slotCount_ = other.slotCount_;
+        slotSize_ = other.slotSize_;
+        stride_ = other.stride_;
+        next_ = other.next_;
+    }
+    return *this;
+}
+
+std::span<uint8_t> ShmRingWriter::beginSlot(size_t frameSize) {
+    if (frameSize > slotSize_) BINARY_PROTOCOL_THROW(std::length_error("Frame larger than the shared-memory ring slot size"));
+    uint8_t* slot = mapping_.data() + SHM_RING_HEADER_SIZE + (next_ & (slotCount_ - 1)) * stride_;
+    detail::shmWord(slot).store(SHM_SLOT_WRITING, std::memory_order_relaxed);
+    // Orders the state change before the frame bytes that follow
+    std::atomic_thread_fence(std::memory_order_release);
+    return {slot + SHM_SLOT_HEADER_SIZE, frameSize};
+}
+
+uint64_t ShmRingWriter::commitSlot(size_t frameSize) {
+    uint8_t* slot = mapping_.data() + SHM_RING_HEADER_SIZE + (next_ & (slotCount_ - 1)) * stride_;
+    const uint32_t length = static_cast<uint32_t>(frameSize);
+    std::memcpy(slot + SLOT_LENGTH_OFFSET, &length, sizeof(length));
+    const uint64_t sequence = next_++;
+    detail::shmWord(slot).store(sequence + 1, std::memory_order_release);
+    detail::shmWord(mapping_.data() + PUBLISHED_OFFSET).store(next_, std::memory_order_release);
+    return sequence;
+}
+
+uint64_t ShmRingWriter::publishFrame(std::span<const uint8_t> frame) {
+    const std::span<uint8_t> slot = beginSlot(frame.size());
+    if (!frame.empty()) std::memcpy(slot.data(), frame.data(), frame.size());
+    return commitSlot(frame.size());
+}
+
+// ============================================
+// Reader
+// ============================================
+
+ShmRingReader ShmRingReader::open(const std::string& name) {
+    const int fd = ::shm_open(name.c_str(), O_RDONLY | O_CLOEXEC, 0);
+    if (fd < 0) throwErrno(errno, "Failed to open shared memory " + name);
+    return ShmRingReader(mapReadOnly(fd, true));
+}
+
+ShmRingReader ShmRingReader::fromFd(int fd) {
+    return ShmRingReader(mapReadOnly(fd, false));
+}
+
+ShmRingReader::ShmRingReader(detail::ShmMapping mapping) : mapping_(std::move(mapping)) {
+    const uint8_t* base = mapping_.data();
+    const bool magic = detail::shmWord(base + MAGIC_OFFSET).load(std::memory_order_acquire) == RING_MAGIC;
+    uint32_t version;
+    std::memcpy(&version, base + VERSION_OFFSET, sizeof(version));
+    std::memcpy(&slotCount_, base + SLOT_COUNT_OFFSET, sizeof(slotCount_));
+    std::memcpy(&slotSize_, base + SLOT_SIZE_OFFSET, sizeof(slotSize_));
+    if (!magic || version != SHM_RING_VERSION || slotCount_ == 0 || !std::has_single_bit(slotCount_)
+        || mapping_.size() < regionSize(slotCount_, slotSize_)) {
+        BINARY_PROTOCOL_THROW(std::runtime_error("Not a shared-memory ring"));
+    }
+    stride_ = detail::shmSlotStride(slotSize_);
+    position_ = published();
+}
+
+uint64_t ShmRingReader::published() const {
+    return detail::shmWord(mapping_.data() + PUBLISHED_OFFSET).load(std::memory_order_acquire);
+}
+
+uint64_t ShmRingReader::oldest() const {
+    const uint64_t end = published();
+    // The slot of frame end may already be in the middle of being rewritten
+    return end < slotCount_ ? 0 : end - slotCount_ + 1;
+}
+
+ShmRead ShmRingReader::read(uint64_t sequence) const {
+    if (sequence >= published()) return {ShmReadStatus::Pending};
+    const uint8_t* slot = mapping_.data() + SHM_RING_HEADER_SIZE + (sequence & (slotCount_ - 1)) * stride_;
+    if (detail::shmWord(slot).load(std::memory_order_acquire) != sequence + 1) return {ShmReadStatus::Overrun};
+
+    uint32_t length;
+    std::memcpy(&length, slot + SLOT_LENGTH_OFFSET, sizeof(length));
+    const uint8_t* frame = slot + SHM_SLOT_HEADER_SIZE;
+    ShmRead result{ShmReadStatus::Ok};
+    result.frame.sequence = sequence;
+    if (length >= ProtocolHeader::ENCODED_SIZE && length <= slotSize_) {
+        result.frame.header = deserializeProtocolHeader(frame, ProtocolHeader::ENCODED_SIZE);
+    }
+    result.frame.bytes = {frame, length};
+    // Checked against the slot so that a torn header never points past it
+    if (length < ProtocolHeader::ENCODED_SIZE || length > slotSize_
+        || result.frame.header.payload_length > length - ProtocolHeader::ENCODED_SIZE || !valid(result.frame)) {
+        return {ShmReadStatus::Overrun};
+    }
+    result.frame.payload = {frame + ProtocolHeader::ENCODED_SIZE, result.frame.header.payload_length};
+    return result;
+}
+
+bool ShmRingReader::valid(const ShmFrame& frame) const {
+    // Orders every earlier read of the frame before the state is checked again
+    std::atomic_thread_fence(std::memory_order_acquire);
+    const uint8_t* slot = mapping_.data() + SHM_RING_HEADER_SIZE + (frame.sequence & (slotCount_ - 1)) * stride_;
+    return detail::shmWord(slot).load(std::memory_order_relaxed) == frame.sequence + 1;
+}
+
+ShmRead ShmRingReader::next() {
+    const ShmRead result = read(position_);
+    if (result.status == ShmReadStatus::Ok) {
+        position_++;
+        stats_.frames++;
+    } else if (result.status == ShmReadStatus::Overrun) {
+        const uint64_t resume = std::max(oldest(), position_ + 1);
+        stats_.overruns++;
+        stats_.lostFrames += resume - position_;
+        position_ = resume;
+    }
+    return result;
+}
+
+} // namespace binaryprotocol
\ No newline at end of file
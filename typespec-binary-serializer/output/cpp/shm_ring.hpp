@@ -0,0 +1,231 @@
+/**
+ * Auto-generated shared-memory broadcast ring for ProtocolHeader-framed messages
+ *
+ * One writer process encodes each frame straight into a slot of a memfd or
+ * shm_open region; any number of reader processes map the region read-only
+ * and read frames in place by ring sequence number. Fan-out to N readers
+ * costs one encode and no copies, and a slow reader never blocks the writer:
+ * it detects that its frame was overwritten and skips ahead.
+ *
+ *     // writer                                    // each reader
+ *     auto ring = ShmRingWriter::create("/telemetry");  ShmRingReader reader = ShmRingReader::open("/telemetry");
+ *     ring.publish(ProtocolHeader{}, response);             while (auto read = reader.next()) {
+ *                                                          auto view = viewSensorDataResponse(read.frame.payload.data(), ...);
+ *                                                          ...
+ *                                                          if (!reader.valid(read.frame)) { ... discard, it was overwritten }
+ *                                                      }
+ */
+
+#ifndef BINARY_PROTOCOL_SHM_RING_HPP
+#define BINARY_PROTOCOL_SHM_RING_HPP
+
+#include "protocol.hpp"
+
+#include <atomic>
+#include <cstdint>
+#include <span>
+#include <string>
+
+namespace binaryprotocol {
+
+/*
+ * Region layout (host byte order; every process shares the host):
+ *
+ *   header  "TBSSHM01", u32 version, u32 slot count, u32 slot size, u32 reserved,
+ *           then on its own cache line u64 published (frames ever published)
+ *   slots   slot count x stride (16 + slot size, rounded up to 64):
+ *           u64 state, u32 frame length, u32 reserved, frame bytes
+ *
+ * Frame s lives in slot s % slot count. The writer sets the slot's state to
+ * SHM_SLOT_WRITING before touching its bytes and to s + 1 once the frame is
+ * complete, then advances published. A reader owns frame s only while the
+ * state reads s + 1 both before and after it looks at the bytes (a seqlock),
+ * so views must be checked with ShmRingReader::valid() before they are trusted.
+ */
+inline constexpr uint32_t SHM_RING_VERSION = 1;
+inline constexpr size_t SHM_RING_HEADER_SIZE = 128;
+inline constexpr size_t SHM_SLOT_HEADER_SIZE = 16;
+inline constexpr uint64_t SHM_SLOT_WRITING = ~uint64_t{0};
+
+static_assert(std::atomic_ref<uint64_t>::is_always_lock_free, "Shared-memory rings need lock-free 64-bit atomics");
+
+struct ShmRingOptions {
+    /// Frames kept before the oldest is overwritten; a power of two
+    uint32_t slotCount = 1024;
+    /// Largest frame (ProtocolHeader and payload) a slot holds
+    uint32_t slotSize = 4096;
+};
+
+struct ShmFrame {
+    /// Ring sequence number, counting every frame the writer published
+    uint64_t sequence;
+    ProtocolHeader header;
+    std::span<const uint8_t> payload;
+    /// ProtocolHeader and payload as published
+    std::span<const uint8_t> bytes;
+};
+
+enum class ShmReadStatus : uint8_t {
+    Ok,
+    /// The frame has not been published yet
+    Pending,
+    /// The writer has already reused the frame's slot
+    Overrun,
+};
+
+struct ShmRead {
+    ShmReadStatus status;
+    /// Set when status is Ok
+    ShmFrame frame{};
+
+    explicit operator bool() const { return status == ShmReadStatus::Ok; }
+};
+
+struct ShmReaderStats {
+    uint64_t frames = 0;
+    /// Times next() found its frame overwritten and skipped ahead
+    uint64_t overruns = 0;
+    /// Frames skipped because of overruns
+    uint64_t lostFrames = 0;
+};
+
+namespace detail {
+
+/// A mapped ring region; unmapped on destruction
+class ShmMapping {
+public:
+    ShmMapping() = default;
+    ShmMapping(uint8_t* data, size_t size) : data_(data), size_(size) {}
+    ~ShmMapping();
+
+    ShmMapping(ShmMapping&& other) noexcept;
+    ShmMapping& operator=(ShmMapping&& other) noexcept;
+
+    uint8_t* data() const { return data_; }
+    size_t size() const { return size_; }
+
+private:
+    uint8_t* data_ = nullptr;
+    size_t size_ = 0;
+};
+
+constexpr size_t shmSlotStride(uint32_t slotSize) {
+    return (SHM_SLOT_HEADER_SIZE + slotSize + 63) & ~size_t{63};
+}
+
+inline std::atomic_ref<uint64_t> shmWord(const uint8_t* address) {
+    // Readers map the region read-only; they only ever load through this reference
+    return std::atomic_ref<uint64_t>(*reinterpret_cast<uint64_t*>(const_cast<uint8_t*>(address)));
+}
+
+} // namespace detail
+
+/**
+ * The single writer of a ring. Frames are encoded in place, sealed and
+ * published with a release store; publish() never waits for readers.
+ */
+class ShmRingWriter {
+public:
+    /// Creates (or replaces) the POSIX shared-memory object name, e.g. "/telemetry"
+    static ShmRingWriter create(const std::string& name, ShmRingOptions options = {});
+    /// Creates an anonymous memfd region; hand fd() to readers by fork() or SCM_RIGHTS
+    static ShmRingWriter createAnonymous(ShmRingOptions options = {});
+    /// Removes a shared-memory object name; mapped rings stay usable
+    static void unlink(const std::string& name);
+
+    ~ShmRingWriter();
+    ShmRingWriter(ShmRingWriter&& other) noexcept;
+    ShmRingWriter& operator=(ShmRingWriter&& other) noexcept;
+
+    /// Encodes a frame into the next slot and returns its ring sequence number.
+    /// magic, command_id and payload_length are filled in and the frame is sealed.
+    template<typename T>
+    uint64_t publish(ProtocolHeader header, const T& message);
+
+    /// Publishes an already framed message, e.g. one handed out by FrameDecoder
+    uint64_t publishFrame(std::span<const uint8_t> frame);
+
+    uint64_t published() const { return next_; }
+    uint32_t slotCount() const { return slotCount_; }
+    uint32_t slotSize() const { return slotSize_; }
+    /// Region file descriptor, kept open for sharing with readers
+    int fd() const { return fd_; }
+
+private:
+    ShmRingWriter(int fd, detail::ShmMapping mapping, ShmRingOptions options);
+    static ShmRingWriter createFromFd(int fd, ShmRingOptions options);
+
+    /// Marks the next slot as being written and returns its frame bytes
+    std::span<uint8_t> beginSlot(size_t frameSize);
+    uint64_t commitSlot(size_t frameSize);
+
+    int fd_ = -1;
+    detail::ShmMapping mapping_;
+    uint32_t slotCount_ = 0;
+    uint32_t slotSize_ = 0;
+    size_t stride_ = 0;
+    uint64_t next_ = 0;
+};
+
+/**
+ * One reader of a ring, usually in another process. The region is mapped
+ * read-only; frames are handed out in place and stay intact until the writer
+ * wraps around to their slot.
+ */
+class ShmRingReader {
+public:
+    /// Attaches to a ring created with ShmRingWriter::create(name)
+    static ShmRingReader open(const std::string& name);
+    /// Attaches to a ring through a descriptor received from the writer; fd stays owned by the caller
+    static ShmRingReader fromFd(int fd);
+
+    /// Reads the frame at the reader's position and advances past it. On an
+    /// overrun the position jumps to the oldest frame still in the ring.
+    ShmRead next();
+
+    /// Reads any frame still in the ring without moving the position
+    ShmRead read(uint64_t sequence) const;
+
+    /// True while frame's slot still holds it; check after reading through views
+    bool valid(const ShmFrame& frame) const;
+
+    uint64_t position() const { return position_; }
+    void seek(uint64_t sequence) { position_ = sequence; }
+    /// Skips to the next frame to be published
+    void seekLatest() { position_ = published(); }
+
+    uint64_t published() const;
+    /// Oldest frame that is not being overwritten
+    uint64_t oldest() const;
+    uint32_t slotCount() const { return slotCount_; }
+    const ShmReaderStats& stats() const { return stats_; }
+
+private:
+    explicit ShmRingReader(detail::ShmMapping mapping);
+
+    detail::ShmMapping mapping_;
+    uint32_t slotCount_ = 0;
+    uint32_t slotSize_ = 0;
+    size_t stride_ = 0;
+    uint64_t position_ = 0;
+    ShmReaderStats stats_;
+};
+
+template<typename T>
+uint64_t ShmRingWriter::publish(ProtocolHeader header, const T& message) {
+    checkLengthPrefixes(message);
+    const size_t payloadSize = encodedSize(message);
+    const std::span<uint8_t> frame = beginSlot(ProtocolHeader::ENCODED_SIZE + payloadSize);
+
+    header.magic = ProtocolHeader::MAGIC;
+    header.command_id = MessageTraits<T>::COMMAND_ID;
+    header.payload_length = static_cast<decltype(header.payload_length)>(payloadSize);
+    serializeInto(header, frame.first(ProtocolHeader::ENCODED_SIZE));
+    serializeInto(message, frame.subspan(ProtocolHeader::ENCODED_SIZE));
+    sealFrame(frame);
+    return commitSlot(frame.size());
+}
+
+} // namespace binaryprotocol
+
+#endif // BINARY_PROTOCOL_SHM_RING_HPP
\ No newline at end of file
@@ -0,0 +1,304 @@
+/**
+ * Auto-generated capture file test
+ *
+ *     test_capture [--iterations N] [--seed S]
+ *
+ * Writes N random frames through both CaptureWriter::append overloads, with
+ * timestamps that sometimes run backwards, and reads them back: iteration must
+ * return every record intact and seekTime()/seekSequence() must agree with a
+ * linear scan. Damaged copies of the file (truncated before the trailer, a
+ * trailer or index entries pointing outside the records) must be read by
+ * scanning instead of trusting the stored index.
+ */
+
+#include "capture.hpp"
+#include "test_codec.hpp"
+
+#include <algorithm>
+#include <cinttypes>
+#include <cstdio>
+#include <cstdlib>
+#include <filesystem>
+#include <fstream>
+#include <iterator>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include <unistd.h>
+
+using namespace binaryprotocol;
+using namespace binaryprotocol::testing;
+
+namespace {
+
+using Sequence = decltype(ProtocolHeader::sequence_id);
+
+struct Options {
+    uint64_t iterations = 2000;
+    uint64_t seed = 1;
+};
+
+bool fail(const char* test, const char* check, const Options& options, uint64_t iteration) {
+    std::fprintf(stderr, "FAIL %s: %s (seed %" PRIu64 ", iteration %" PRIu64 ")\n", test, check, options.seed, iteration);
+    return false;
+}
+
+/// Larger payloads are redrawn so the files stay small
+constexpr size_t MAX_TEST_PAYLOAD = 1024;
+
+/// What the reader should return for one record
+struct Record {
+    uint64_t timestamp;
+    Sequence sequence;
+    std::vector<uint8_t> frame;
+};
+
+/// File in the temporary directory, removed when the test is done with it
+class TempFile {
+public:
+    explicit TempFile(std::string_view name)
+        : path_((std::filesystem::temp_directory_path()
+                 / ("binary_protocol_" + std::to_string(::getpid()) + "_" + std::string(name) + ".cap")).string()) {}
+    ~TempFile() { std::remove(path_.c_str()); }
+
+    TempFile(const TempFile&) = delete;
+    TempFile& operator=(const TempFile&) = delete;
+
+    const std::string& path() const { return path_; }
+
+private:
+    std::string path_;
+};
+
+std::vector<uint8_t> readFile(const std::string& path) {
+    std::ifstream in(path, std::ios::binary);
+    return {std::istreambuf_iterator<char>(in), std::istreambuf_iterator<char>()};
+}
+
+void writeFile(const std::string& path, std::span<const uint8_t> bytes) {
+    std::ofstream out(path, std::ios::binary | std::ios::trunc);
+    out.write(reinterpret_cast<const char*>(bytes.data()), static_cast<std::streamsize>(bytes.size()));
+}
+
+/// Frame as the typed CaptureWriter::append encodes it
+std::vector<uint8_t> frameOf(ProtocolHeader header, const Message& message) {
+    return std::visit([&](const auto& value) {
+        const std::vector<uint8_t> payload = serialize(value);
+        header.magic = ProtocolHeader::MAGIC;
+        header.command_id = MessageTraits<std::decay_t<decltype(value)>>::COMMAND_ID;
+        header.payload_length = static_cast<decltype(header.payload_length)>(payload.size());
+        sealFrame(header, payload);
+        std::vector<uint8_t> frame = serialize(header);
+        frame.insert(frame.end(), payload.begin(), payload.end());
+        return frame;
+    }, message);
+}
+
+std::vector<Record> writeCapture(const std::string& path, Random& rng, uint64_t count, uint32_t indexInterval) {
+    CaptureWriter writer(path, {.indexInterval = indexInterval, .bufferSize = 4096});
+    std::vector<Record> records;
+    uint64_t clock = 1000;
+    uint64_t last = 0;
+    Sequence sequence = 0;
+    for (uint64_t i = 0; i < count; i++) {
+        Message message;
+        std::vector<uint8_t> frame;
+        ProtocolHeader header{};
+        header.sequence_id = sequence;
+        do {
+            message = randomMessage(rng);
+            frame = frameOf(header, message);
+        } while (frame.size() > ProtocolHeader::ENCODED_SIZE + MAX_TEST_PAYLOAD);
+        const uint8_t commandId = deserializeProtocolHeader(frame.data(), ProtocolHeader::ENCODED_SIZE).command_id;
+        const std::span<const uint8_t> payload = std::span<const uint8_t>(frame).subspan(ProtocolHeader::ENCODED_SIZE);
+
+        // Mostly advancing, sometimes late, and sometimes left to the writer when the message carries none
+        std::optional<uint64_t> timestamp;
+        const uint64_t choice = rng.below(8);
+        if (choice == 0 && !messageTimestamp(commandId, payload)) {
+            timestamp = std::nullopt;
+        } else if (choice == 1) {
+            timestamp = clock - rng.below(200);
+        } else {
+            clock += rng.below(20);
+            timestamp = clock;
+        }
+        last = std::max(last, timestamp.value_or(last));
+
+        if (rng.boolean()) {
+            std::visit([&](const auto& value) { writer.append(header, value, timestamp); }, message);
+        } else {
+            writer.append(frame, timestamp);
+        }
+        records.push_back({last, sequence, std::move(frame)});
+        sequence += static_cast<Sequence>(rng.below(3));
+    }
+    writer.close();
+    return records;
+}
+
+/// Iterator at records[index] of reader, or end() past the last record
+bool isAt(const CaptureReader& reader, const CaptureReader::Iterator& it, std::span<const uint8_t* const> positions, size_t index) {
+    return index == positions.size() ? it == reader.end() : it != reader.end() && it->bytes.data() == positions[index];
+}
+
+/// Every record intact and in order; exact also requires nothing after them
+bool checkRecords(const char* test, const CaptureReader& reader, const std::vector<Record>& records, bool exact,
+                  const Options& options, std::vector<const uint8_t*>& positions) {
+    positions.clear();
+    for (const CapturedFrame& frame : reader) {
+        if (positions.size() < records.size()) {
+            const Record& record = records[positions.size()];
+            if (frame.timestamp != record.timestamp) return fail(test, "record timestamp differs", options, positions.size());
+            if (!std::ranges::equal(frame.bytes, record.frame)) return fail(test, "record bytes differ", options, positions.size());
+        } else if (exact) {
+            return fail(test, "records after the last one written", options, positions.size());
+        }
+        positions.push_back(frame.bytes.data());
+    }
+    if (positions.size() < records.size()) return fail(test, "records missing", options, positions.size());
+    positions.resize(records.size());
+    return true;
+}
+
+/// seekTime() and seekSequence() against a linear scan of records
+bool checkSeeks(const char* test, const CaptureReader& reader, const std::vector<Record>& records,
+                std::span<const uint8_t* const> positions, Random& rng, const Options& options) {
+    const uint64_t lastTimestamp = records.empty() ? 0 : records.back().timestamp;
+    const uint64_t lastSequence = records.empty() ? 0 : records.back().sequence;
+    for (uint64_t i = 0; i < 200; i++) {
+        const uint64_t timestamp = rng.below(lastTimestamp + 2);
+        const size_t byTime = static_cast<size_t>(std::ranges::find_if(records,
+            [&](const Record& record) { return record.timestamp >= timestamp; }) - records.begin());
+        if (!isAt(reader, reader.seekTime(timestamp), positions, byTime)) return fail(test, "seekTime disagrees with a linear scan", options, i);
+
+        const Sequence sequence = static_cast<Sequence>(rng.below(lastSequence + 2));
+        const size_t bySequence = static_cast<size_t>(std::ranges::find_if(records,
+            [&](const Record& record) { return record.sequence >= sequence; }) - records.begin());
+        if (!isAt(reader, reader.seekSequence(sequence), positions, bySequence)) return fail(test, "seekSequence disagrees with a linear scan", options, i);
+    }
+    return true;
+}
+
+bool runRoundTrip(const Options& options, uint32_t indexInterval) {
+    const std::string name = "round trip, index interval " + std::to_string(indexInterval);
+    Random rng(options.seed + indexInterval);
+    TempFile file("round_trip");
+    const std::vector<Record> records = writeCapture(file.path(), rng, options.iterations, indexInterval);
+
+    CaptureReader reader(file.path());
+    if (!reader.hasStoredIndex()) return fail(name.c_str(), "stored index rejected", options, 0);
+    std::vector<const uint8_t*> positions;
+    return checkRecords(name.c_str(), reader, records, true, options, positions)
+        && checkSeeks(name.c_str(), reader, records, positions, rng, options);
+}
+
+/// Records written with earlier timestamps than their predecessors are raised to them
+bool runLateTimestamps(const Options& options) {
+    TempFile file("late");
+    {
+        CaptureWriter writer(file.path(), {.indexInterval = 2});
+        Sequence sequence = 0;
+        for (const uint64_t timestamp : {100, 200, 50, 60, 300, 310}) {
+            ProtocolHeader header{};
+            header.sequence_id = sequence++;
+            writer.append(frameOf(header, Message{}), timestamp);
+        }
+    }
+    CaptureReader reader(file.path());
+    const uint64_t expected[] = {100, 200, 200, 200, 300, 310};
+    size_t index = 0;
+    for (const CapturedFrame& frame : reader) {
+        if (index == std::size(expected) || frame.timestamp != expected[index]) return fail("late timestamps", "timestamp not clamped", options, index);
+        index++;
+    }
+    const CaptureReader::Iterator it = reader.seekTime(150);
+    if (it == reader.end() || it->timestamp != 200 || it->header.sequence_id != 1) {
+        return fail("late timestamps", "seekTime(150) did not find the first record at 200", options, 0);
+    }
+    return true;
+}
+
+/// Damaged copies of a good file must be read by scanning, never by trusting the damage
+bool runDamaged(const Options& options) {
+    Random rng(options.seed ^ 0xDA);
+    TempFile original("original");
+    const std::vector<Record> records = writeCapture(original.path(), rng, std::max<uint64_t>(options.iterations, 4), 2);
+    const std::vector<uint8_t> bytes = readFile(original.path());
+    const size_t trailer = bytes.size() - CAPTURE_TRAILER_SIZE;
+    const uint64_t indexOffset = detail::load<Endian::Little, uint64_t>(bytes.data() + trailer);
+    std::vector<const uint8_t*> positions;
+
+    // Cut inside the last record: no trailer, and the partial record is dropped
+    {
+        TempFile file("truncated");
+        writeFile(file.path(), std::span<const uint8_t>(bytes).first(static_cast<size_t>(indexOffset) - 1));
+        CaptureReader reader(file.path());
+        const std::vector<Record> complete(records.begin(), records.end() - 1);
+        if (reader.hasStoredIndex()) return fail("truncated", "index trusted without a trailer", options, 0);
+        if (!checkRecords("truncated", reader, complete, true, options, positions)) return false;
+        if (!checkSeeks("truncated", reader, complete, positions, rng, options)) return false;
+    }
+
+    struct Damage {
+        const char* name;
+        size_t offset;
+        uint64_t value;
+    };
+    const size_t secondEntry = static_cast<size_t>(indexOffset) + CAPTURE_INDEX_ENTRY_SIZE;
+    const Damage damages[] = {
+        // entries * CAPTURE_INDEX_ENTRY_SIZE wraps around to fit exactly
+        {"trailer past the index", trailer, bytes.size() - 8},
+        {"entry inside the index", secondEntry + 8, indexOffset + 8},
+        {"entry beyond the file", secondEntry + 8, uint64_t{1} << 62},
+        {"entry inside a record", secondEntry + 8, detail::load<Endian::Little, uint64_t>(bytes.data() + secondEntry + 8) + 1},
+        {"entry timestamp", secondEntry, ~uint64_t{0}},
+    };
+    for (const Damage& damage : damages) {
+        std::vector<uint8_t> damaged = bytes;
+        detail::store<Endian::Little>(damaged.data() + damage.offset, damage.value);
+        if (damage.offset == trailer) {
+            detail::store<Endian::Little>(damaged.data() + trailer + 8, (~uint64_t{0} - 15) / CAPTURE_INDEX_ENTRY_SIZE);
+        }
+        TempFile file("damaged");
+        writeFile(file.path(), damaged);
+        CaptureReader reader(file.path());
+        if (reader.hasStoredIndex()) return fail(damage.name, "damaged index trusted", options, 0);
+        // The scan also reads the index bytes as records, so only the written ones are compared
+        if (!checkRecords(damage.name, reader, records, false, options, positions)) return false;
+        for (uint64_t i = 0; i < 64; i++) {
+            (void)reader.seekSequence(static_cast<Sequence>(rng.next()));
+            (void)reader.seekTime(rng.next());
+        }
+    }
+    return true;
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    Options options;
+    for (int i = 1; i < argc; i++) {
+        const std::string_view arg = argv[i];
+        if (arg == "--iterations" && i + 1 < argc) {
+            options.iterations = std::strtoull(argv[++i], nullptr, 10);
+        } else if (arg == "--seed" && i + 1 < argc) {
+            options.seed = std::strtoull(argv[++i], nullptr, 10);
+        } else {
+            std::fprintf(stderr, "usage: %s [--iterations N] [--seed S]\n", argv[0]);
+            return 2;
+        }
+    }
+
+    bool ok = true;
+    for (const uint32_t indexInterval : {1u, 7u, 256u}) {
+        ok = runRoundTrip(options, indexInterval) && ok;
+    }
+    Options empty = options;
+    empty.iterations = 0;
+    ok = runRoundTrip(empty, 1) && ok;
+    ok = runLateTimestamps(options) && ok;
+    ok = runDamaged(options) && ok;
+    return ok ? 0 : 1;
+}
@@ -0,0 +1,661 @@
+/**
+ * Auto-generated codec checks shared by test_roundtrip and the fuzz targets
+ *
+ * checkRoundTrip() encodes a value through every encoder and decodes it through
+ * every decoder, requiring identical bytes and equal values throughout.
+ * checkDecode() takes arbitrary bytes and requires that whatever tryDeserialize
+ * accepts re-encodes to a fixpoint that every other decoder agrees on. Both also
+ * run the bytes through the table-driven dynamic codec, which must accept and
+ * reject exactly the same inputs and re-encode them byte for byte.
+ */
+
+#ifndef BINARY_PROTOCOL_TEST_CODEC_HPP
+#define BINARY_PROTOCOL_TEST_CODEC_HPP
+
+#include "dynamic_codec.hpp"
+#include "protocol.hpp"
+#include "frame_decoder.hpp"
+
+#include <algorithm>
+#include <bit>
+#include <cstdint>
+#include <cstring>
+#include <functional>
+#include <initializer_list>
+#include <limits>
+#include <span>
+#include <type_traits>
+#include <vector>
+
+namespace binaryprotocol::testing {
+
+/// xoshiro256** seeded through splitmix64; deterministic for a given seed on every platform
+class Random {
+public:
+    explicit Random(uint64_t seed) {
+        for (uint64_t& word : state_) {
+            seed += 0x9E3779B97F4A7C15ull;
+            uint64_t z = seed;
+            z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ull;
+            z = (z ^ (z >> 27)) * 0x94D049BB133111EBull;
+            word = z ^ (z >> 31);
+        }
+    }
+
+    uint64_t next() {
+        const uint64_t result = std::rotl(state_[1] * 5, 7) * 9;
+        const uint64_t t = state_[1] << 17;
+        state_[2] ^= state_[0];
+        state_[3] ^= state_[1];
+        state_[1] ^= state_[2];
+        state_[0] ^= state_[3];
+        state_[2] ^= t;
+        state_[3] = std::rotl(state_[3], 45);
+        return result;
+    }
+
+    /// Uniform in [0, bound)
+    uint64_t below(uint64_t bound) { return bound == 0 ? 0 : next() % bound; }
+
+    bool boolean() { return (next() & 1) != 0; }
+
+    template<typename T>
+    T integer() { return static_cast<T>(next()); }
+
+    /// Any bit pattern except NaN, so values compare equal to themselves
+    template<typename T>
+    T real() {
+        using Bits = std::conditional_t<sizeof(T) == 4, uint32_t, uint64_t>;
+        const T value = std::bit_cast<T>(static_cast<Bits>(next()));
+        return value == value ? value : T(0);
+    }
+
+    /// Mostly short lengths, sometimes the limit itself
+    size_t length(size_t limit) {
+        switch (next() % 8) {
+        case 0: return 0;
+        case 1: return limit;
+        case 2: return static_cast<size_t>(below(limit + 1));
+        default: return static_cast<size_t>(below(std::min<size_t>(limit, 64) + 1));
+        }
+    }
+
+    template<typename T>
+    T pick(std::initializer_list<T> values) { return values.begin()[below(values.size())]; }
+
+    template<typename Container>
+    void fill(Container& bytes) {
+        for (auto& byte : bytes) byte = static_cast<std::remove_reference_t<decltype(byte)>>(next());
+    }
+
+private:
+    uint64_t state_[4];
+};
+
+/// Batch field bytes framed as tryDeserialize requires: entries with random command IDs and payloads
+template<Endian E>
+std::vector<uint8_t> randomBatch(Random& rng, size_t limit) {
+    std::vector<uint8_t> bytes;
+    for (uint64_t entries = rng.below(8); entries > 0; entries--) {
+        const size_t length = rng.length(std::min<size_t>(limit, std::numeric_limits<uint16_t>::max()));
+        if (bytes.size() + BATCH_ENTRY_HEADER_SIZE + length > limit) break;
+        const size_t offset = bytes.size();
+        bytes.resize(offset + BATCH_ENTRY_HEADER_SIZE + length);
+        bytes[offset] = rng.integer<uint8_t>();
+        detail::store<E>(bytes.data() + offset + 1, static_cast<uint16_t>(length));
+        std::span<uint8_t> payload = std::span<uint8_t>(bytes).subspan(offset + BATCH_ENTRY_HEADER_SIZE);
+        rng.fill(payload);
+    }
+    return bytes;
+}
+
+/**
+ * Deep comparison between an owning value, a view or a re-decoded copy.
+ * Floats and models compare by their encoding so NaN payloads from fuzz
+ * inputs still match themselves.
+ */
+template<typename A, typename B>
+bool matches(const A& a, const B& b) {
+    if constexpr (std::is_floating_point_v<A> && std::is_same_v<A, B>) {
+        using Bits = std::conditional_t<sizeof(A) == 4, uint32_t, uint64_t>;
+        return std::bit_cast<Bits>(a) == std::bit_cast<Bits>(b);
+    } else if constexpr (std::is_same_v<A, B> && requires { serializeToArray(a); }) {
+        return serializeToArray(a) == serializeToArray(b);
+    } else if constexpr (std::is_same_v<A, B> && requires { serialize(a); }) {
+        return serialize(a) == serialize(b);
+    } else if constexpr (std::is_integral_v<A> && std::is_integral_v<B> && sizeof(A) == 1 && sizeof(B) == 1) {
+        return static_cast<uint8_t>(a) == static_cast<uint8_t>(b);
+    } else if constexpr (requires { a.size(); a.begin(); b.size(); b[0]; } && !std::is_same_v<A, B>) {
+        // View (span or ArrayView) against its owning container
+        if (a.size() != b.size()) return false;
+        size_t index = 0;
+        for (auto&& element : a) {
+            if (!matches(element, b[index++])) return false;
+        }
+        return true;
+    } else if constexpr (requires { a.size(); a[0]; b[0]; }) {
+        if (a.size() != b.size()) return false;
+        for (size_t i = 0; i < a.size(); i++) {
+            if (!matches(a[i], b[i])) return false;
+        }
+        return true;
+    } else {
+        return a == b;
+    }
+}
+
+/// Per-model entry points and random instances
+template<typename T>
+struct CodecTraits;
+
+template<>
+struct CodecTraits<ProtocolHeader> {
+    static constexpr const char* NAME = "ProtocolHeader";
+    static constexpr bool HAS_COMMAND = false;
+    static constexpr bool HAS_VIEW = false;
+    static constexpr bool HAS_COMPACT = false;
+
+    static ProtocolHeader decode(const uint8_t* data, size_t size) { return deserializeProtocolHeader(data, size); }
+    static DecodeResult<ProtocolHeader> tryDecode(const uint8_t* data, size_t size) { return tryDeserializeProtocolHeader(data, size); }
+
+    static ProtocolHeader random([[maybe_unused]] Random& rng) {
+        ProtocolHeader value{};
+        value.magic = rng.integer<uint16_t>();
+        value.version = rng.integer<uint8_t>();
+        value.command_id = rng.integer<uint8_t>();
+        value.payload_length = rng.integer<uint32_t>();
+        value.sequence_id = rng.integer<uint32_t>();
+        value.checksum = rng.integer<uint16_t>();
+        return value;
+    }
+};
+
+template<>
+struct CodecTraits<PingCommand> {
+    static constexpr const char* NAME = "PingCommand";
+    static constexpr bool HAS_COMMAND = true;
+    static constexpr bool HAS_VIEW = false;
+    static constexpr bool HAS_COMPACT = false;
+
+    static PingCommand decode(const uint8_t* data, size_t size) { return deserializePingCommand(data, size); }
+    static DecodeResult<PingCommand> tryDecode(const uint8_t* data, size_t size) { return tryDeserializePingCommand(data, size); }
+
+    static PingCommand random([[maybe_unused]] Random& rng) {
+        PingCommand value{};
+        value.timestamp = rng.integer<uint64_t>();
+        return value;
+    }
+};
+
+template<>
+struct CodecTraits<PingResponse> {
+    static constexpr const char* NAME = "PingResponse";
+    static constexpr bool HAS_COMMAND = true;
+    static constexpr bool HAS_VIEW = false;
+    static constexpr bool HAS_COMPACT = false;
+
+    static PingResponse decode(const uint8_t* data, size_t size) { return deserializePingResponse(data, size); }
+    static DecodeResult<PingResponse> tryDecode(const uint8_t* data, size_t size) { return tryDeserializePingResponse(data, size); }
+
+    static PingResponse random([[maybe_unused]] Random& rng) {
+        PingResponse value{};
+        value.request_timestamp = rng.integer<uint64_t>();
+        value.response_timestamp = rng.integer<uint64_t>();
+        return value;
+    }
+};
+
+template<>
+struct CodecTraits<GetDeviceInfoCommand> {
+    static constexpr const char* NAME = "GetDeviceInfoCommand";
+    static constexpr bool HAS_COMMAND = true;
+    static constexpr bool HAS_VIEW = false;
+    static constexpr bool HAS_COMPACT = false;
+
+    static GetDeviceInfoCommand decode(const uint8_t* data, size_t size) { return deserializeGetDeviceInfoCommand(data, size); }
+    static DecodeResult<GetDeviceInfoCommand> tryDecode(const uint8_t* data, size_t size) { return tryDeserializeGetDeviceInfoCommand(data, size); }
+
+    static GetDeviceInfoCommand random([[maybe_unused]] Random& rng) {
+        GetDeviceInfoCommand value{};
+        value.include_details = rng.boolean();
+        return value;
+    }
+};
+
+template<>
+struct CodecTraits<DeviceInfoResponse> {
+    static constexpr const char* NAME = "DeviceInfoResponse";
+    static constexpr bool HAS_COMMAND = true;
+    static constexpr bool HAS_VIEW = false;
+    static constexpr bool HAS_COMPACT = false;
+
+    static DeviceInfoResponse decode(const uint8_t* data, size_t size) { return deserializeDeviceInfoResponse(data, size); }
+    static DecodeResult<DeviceInfoResponse> tryDecode(const uint8_t* data, size_t size) { return tryDeserializeDeviceInfoResponse(data, size); }
+
+    static DeviceInfoResponse random([[maybe_unused]] Random& rng) {
+        DeviceInfoResponse value{};
+        value.status = rng.pick({DeviceStatus::Offline, DeviceStatus::Online, DeviceStatus::Busy, DeviceStatus::Error});
+        rng.fill(value.device_name);
+        rng.fill(value.firmware_version);
+        value.uptime_seconds = rng.integer<uint32_t>();
+        value.temperature = rng.integer<int16_t>();
+        value.battery_level = rng.integer<uint8_t>();
+        return value;
+    }
+};
+
+template<>
+struct CodecTraits<SendDataCommand> {
+    static constexpr const char* NAME = "SendDataCommand";
+    static constexpr bool HAS_COMMAND = true;
+    static constexpr bool HAS_VIEW = true;
+    static constexpr bool HAS_COMPACT = false;
+
+    static SendDataCommand decode(const uint8_t* data, size_t size) { return deserializeSendDataCommand(data, size); }
+    static DecodeResult<SendDataCommand> tryDecode(const uint8_t* data, size_t size) { return tryDeserializeSendDataCommand(data, size); }
+    static SendDataCommandView view(const uint8_t* data, size_t size) { return viewSendDataCommand(data, size); }
+
+    static bool viewMatches(const SendDataCommandView& view, const SendDataCommand& value) {
+        return matches(view.channel, value.channel)
+            && matches(view.priority, value.priority)
+            && matches(view.data, value.data);
+    }
+
+    static SendDataCommand random([[maybe_unused]] Random& rng) {
+        SendDataCommand value{};
+        value.channel = rng.integer<uint8_t>();
+        value.priority = rng.integer<uint8_t>();
+        value.data.resize(rng.length(65535));
+        rng.fill(value.data);
+        return value;
+    }
+
+    /// A random value with one variable-length field one element past its length prefix
+    static SendDataCommand oversized(Random& rng) {
+        SendDataCommand value = random(rng);
+        value.data.resize(65536);
+        return value;
+    }
+};
+
+template<>
+struct CodecTraits<SendDataResponse> {
+    static constexpr const char* NAME = "SendDataResponse";
+    static constexpr bool HAS_COMMAND = true;
+    static constexpr bool HAS_VIEW = false;
+    static constexpr bool HAS_COMPACT = false;
+
+    static SendDataResponse decode(const uint8_t* data, size_t size) { return deserializeSendDataResponse(data, size); }
+    static DecodeResult<SendDataResponse> tryDecode(const uint8_t* data, size_t size) { return tryDeserializeSendDataResponse(data, size); }
+
+    static SendDataResponse random([[maybe_unused]] Random& rng) {
+        SendDataResponse value{};
+        value.success = rng.boolean();
+        value.error_code = rng.pick({ErrorCode::None, ErrorCode::InvalidCommand, ErrorCode::InvalidParameter, ErrorCode::Timeout, ErrorCode::DeviceError, ErrorCode::Unknown});
+        value.bytes_written = rng.integer<uint32_t>();
+        return value;
+    }
+};
+
+template<>
+struct CodecTraits<SetConfigCommand> {
+    static constexpr const char* NAME = "SetConfigCommand";
+    static constexpr bool HAS_COMMAND = true;
+    static constexpr bool HAS_VIEW = true;
+    static constexpr bool HAS_COMPACT = false;
+
+    static SetConfigCommand decode(const uint8_t* data, size_t size) { return deserializeSetConfigCommand(data, size); }
+    static DecodeResult<SetConfigCommand> tryDecode(const uint8_t* data, size_t size) { return tryDeserializeSetConfigCommand(data, size); }
+    static SetConfigCommandView view(const uint8_t* data, size_t size) { return viewSetConfigCommand(data, size); }
+
+    static bool viewMatches(const SetConfigCommandView& view, const SetConfigCommand& value) {
+        return matches(view.config_id, value.config_id)
+            && matches(view.value_type, value.value_type)
+            && matches(view.value, value.value);
+    }
+
+    static SetConfigCommand random([[maybe_unused]] Random& rng) {
+        SetConfigCommand value{};
+        value.config_id = rng.integer<uint8_t>();
+        value.value_type = rng.integer<uint8_t>();
+        value.value.resize(rng.length(255));
+        rng.fill(value.value);
+        return value;
+    }
+
+    /// A random value with one variable-length field one element past its length prefix
+    static SetConfigCommand oversized(Random& rng) {
+        SetConfigCommand value = random(rng);
+        value.value.resize(256);
+        return value;
+    }
+};
+
+template<>
+struct CodecTraits<SetConfigResponse> {
+    static constexpr const char* NAME = "SetConfigResponse";
+    static constexpr bool HAS_COMMAND = true;
+    static constexpr bool HAS_VIEW = false;
+    static constexpr bool HAS_COMPACT = false;
+
+    static SetConfigResponse decode(const uint8_t* data, size_t size) { return deserializeSetConfigResponse(data, size); }
+    static DecodeResult<SetConfigResponse> tryDecode(const uint8_t* data, size_t size) { return tryDeserializeSetConfigResponse(data, size); }
+
+    static SetConfigResponse random([[maybe_unused]] Random& rng) {
+        SetConfigResponse value{};
+        value.success = rng.boolean();
+        value.error_code = rng.pick({ErrorCode::None, ErrorCode::InvalidCommand, ErrorCode::InvalidParameter, ErrorCode::Timeout, ErrorCode::DeviceError, ErrorCode::Unknown});
+        return value;
+    }
+};
+
+template<>
+struct CodecTraits<BatchCommand> {
+    static constexpr const char* NAME = "BatchCommand";
+    static constexpr bool HAS_COMMAND = true;
+    static constexpr bool HAS_VIEW = true;
+    static constexpr bool HAS_COMPACT = false;
+
+    static BatchCommand decode(const uint8_t* data, size_t size) { return deserializeBatchCommand(data, size); }
+    static DecodeResult<BatchCommand> tryDecode(const uint8_t* data, size_t size) { return tryDeserializeBatchCommand(data, size); }
+    static BatchCommandView view(const uint8_t* data, size_t size) { return viewBatchCommand(data, size); }
+
+    static bool viewMatches(const BatchCommandView& view, const BatchCommand& value) {
+        return matches(view.command_count, value.command_count)
+            && matches(view.commands, value.commands);
+    }
+
+    static BatchCommand random([[maybe_unused]] Random& rng) {
+        BatchCommand value{};
+        value.command_count = rng.integer<uint8_t>();
+        value.commands = randomBatch<Endian::Little>(rng, 65535);
+        return value;
+    }
+
+    /// A random value with one variable-length field one element past its length prefix
+    static BatchCommand oversized(Random& rng) {
+        BatchCommand value = random(rng);
+        value.commands.resize(65536);
+        return value;
+    }
+};
+
+template<>
+struct CodecTraits<BatchResponse> {
+    static constexpr const char* NAME = "BatchResponse";
+    static constexpr bool HAS_COMMAND = true;
+    static constexpr bool HAS_VIEW = true;
+    static constexpr bool HAS_COMPACT = false;
+
+    static BatchResponse decode(const uint8_t* data, size_t size) { return deserializeBatchResponse(data, size); }
+    static DecodeResult<BatchResponse> tryDecode(const uint8_t* data, size_t size) { return tryDeserializeBatchResponse(data, size); }
+    static BatchResponseView view(const uint8_t* data, size_t size) { return viewBatchResponse(data, size); }
+
+    static bool viewMatches(const BatchResponseView& view, const BatchResponse& value) {
+        return matches(view.success_count, value.success_count)
+            && matches(view.failure_count, value.failure_count)
+            && matches(view.results, value.results);
+    }
+
+    static BatchResponse random([[maybe_unused]] Random& rng) {
+        BatchResponse value{};
+        value.success_count = rng.integer<uint8_t>();
+        value.failure_count = rng.integer<uint8_t>();
+        value.results = randomBatch<Endian::Little>(rng, 65535);
+        return value;
+    }
+
+    /// A random value with one variable-length field one element past its length prefix
+    static BatchResponse oversized(Random& rng) {
+        BatchResponse value = random(rng);
+        value.results.resize(65536);
+        return value;
+    }
+};
+
+template<>
+struct CodecTraits<Vector3D> {
+    static constexpr const char* NAME = "Vector3D";
+    static constexpr bool HAS_COMMAND = false;
+    static constexpr bool HAS_VIEW = false;
+    static constexpr bool HAS_COMPACT = false;
+
+    static Vector3D decode(const uint8_t* data, size_t size) { return deserializeVector3D(data, size); }
+    static DecodeResult<Vector3D> tryDecode(const uint8_t* data, size_t size) { return tryDeserializeVector3D(data, size); }
+
+    static Vector3D random([[maybe_unused]] Random& rng) {
+        Vector3D value{};
+        value.x = rng.real<float>();
+        value.y = rng.real<float>();
+        value.z = rng.real<float>();
+        return value;
+    }
+};
+
+template<>
+struct CodecTraits<SensorData> {
+    static constexpr const char* NAME = "SensorData";
+    static constexpr bool HAS_COMMAND = false;
+    static constexpr bool HAS_VIEW = false;
+    static constexpr bool HAS_COMPACT = false;
+
+    static SensorData decode(const uint8_t* data, size_t size) { return deserializeSensorData(data, size); }
+    static DecodeResult<SensorData> tryDecode(const uint8_t* data, size_t size) { return tryDeserializeSensorData(data, size); }
+
+    static SensorData random([[maybe_unused]] Random& rng) {
+        SensorData value{};
+        value.timestamp = rng.integer<uint64_t>();
+        value.sensor_id = rng.integer<uint8_t>();
+        value.position = CodecTraits<Vector3D>::random(rng);
+        value.temperature = rng.real<float>();
+        value.humidity = rng.real<float>();
+        return value;
+    }
+};
+
+template<>
+struct CodecTraits<SensorDataResponse> {
+    static constexpr const char* NAME = "SensorDataResponse";
+    static constexpr bool HAS_COMMAND = true;
+    static constexpr bool HAS_VIEW = true;
+    static constexpr bool HAS_COMPACT = true;
+
+    static SensorDataResponse decode(const uint8_t* data, size_t size) { return deserializeSensorDataResponse(data, size); }
+    static DecodeResult<SensorDataResponse> tryDecode(const uint8_t* data, size_t size) { return tryDeserializeSensorDataResponse(data, size); }
+    static SensorDataResponseView view(const uint8_t* data, size_t size) { return viewSensorDataResponse(data, size); }
+
+    static bool viewMatches(const SensorDataResponseView& view, const SensorDataResponse& value) {
+        return matches(view.sensor_count, value.sensor_count)
+            && matches(view.sensors, value.sensors);
+    }
+    static DecodeResult<SensorDataResponse> tryDecodeCompact(const uint8_t* data, size_t size) { return tryDeserializeCompactSensorDataResponse(data, size); }
+
+    static SensorDataResponse random([[maybe_unused]] Random& rng) {
+        SensorDataResponse value{};
+        value.sensor_count = rng.integer<uint8_t>();
+        value.sensors.resize(rng.length(2259));
+        for (auto& element : value.sensors) element = CodecTraits<SensorData>::random(rng);
+        return value;
+    }
+
+    /// A random value with one variable-length field one element past its length prefix
+    static SensorDataResponse oversized(Random& rng) {
+        SensorDataResponse value = random(rng);
+        value.sensors.resize(2260);
+        return value;
+    }
+};
+
+/// A random instance of a random message type
+inline Message randomMessage(Random& rng) {
+    switch (rng.below(11)) {
+    case 0: return CodecTraits<PingCommand>::random(rng);
+    case 1: return CodecTraits<PingResponse>::random(rng);
+    case 2: return CodecTraits<GetDeviceInfoCommand>::random(rng);
+    case 3: return CodecTraits<DeviceInfoResponse>::random(rng);
+    case 4: return CodecTraits<SendDataCommand>::random(rng);
+    case 5: return CodecTraits<SendDataResponse>::random(rng);
+    case 6: return CodecTraits<SetConfigCommand>::random(rng);
+    case 7: return CodecTraits<SetConfigResponse>::random(rng);
+    case 8: return CodecTraits<BatchCommand>::random(rng);
+    case 9: return CodecTraits<BatchResponse>::random(rng);
+    default: return CodecTraits<SensorDataResponse>::random(rng);
+    }
+}
+
+// ============================================
+// Checks
+// ============================================
+
+/// builtinSchemaDescriptor() loaded once into the table-driven codec
+inline const dynamic::Schema& dynamicSchema() {
+    static const dynamic::Schema schema = dynamic::Schema::load(dynamic::builtinSchemaDescriptor());
+    return schema;
+}
+
+/// The dynamic codec must agree with the generated tryDecode result for the same bytes
+template<typename T>
+const char* checkDynamic(const uint8_t* data, size_t size, const DecodeResult<T>& generated) {
+    static const dynamic::Model* const model = dynamicSchema().model(CodecTraits<T>::NAME);
+    if (!model) return "model missing from builtinSchemaDescriptor()";
+    const DecodeResult<dynamic::Record> record = model->tryDecode({data, size});
+    if (record.has_value() != generated.has_value()) return "dynamic tryDecode disagrees with tryDeserialize";
+    if (!record) return record.error() == generated.error() ? nullptr : "dynamic tryDecode reports a different error";
+
+    const std::vector<uint8_t> expected = serialize(*generated);
+    if (model->encodedSize(*record) != expected.size()) return "dynamic encodedSize != encodedSize";
+    std::vector<uint8_t> encoded;
+    model->encode(*record, encoded);
+    if (encoded != expected) return "dynamic encode != serialize";
+    return nullptr;
+}
+
+/// Returns the name of the first failed check, or nullptr
+template<typename T>
+const char* checkRoundTrip(const T& value, std::vector<uint8_t>& scratch) {
+    using Traits = CodecTraits<T>;
+    const std::vector<uint8_t> bytes = serialize(value);
+    if (bytes.size() != encodedSize(value)) return "serialize size != encodedSize";
+
+    // Reference encodings built independently of serializeInto()
+    if constexpr (requires { serializeToArray(value); }) {
+        const auto reference = serializeToArray(value);
+        if (!std::ranges::equal(reference, bytes)) return "serialize != serializeToArray";
+    } else {
+        GatherList list;
+        serializeGather(value, list);
+        scratch.clear();
+        for (std::span<const uint8_t> segment : list.segments()) {
+            scratch.insert(scratch.end(), segment.begin(), segment.end());
+        }
+        if (scratch != bytes) return "serialize != serializeGather";
+    }
+
+    // serializeInto() must write exactly encodedSize() bytes
+    scratch.assign(bytes.size() + 1, 0xA5);
+    if (serializeInto(value, std::span<uint8_t>(scratch.data(), bytes.size())) != bytes.size()) return "serializeInto size";
+    if (scratch.back() != 0xA5) return "serializeInto wrote past encodedSize";
+    scratch.pop_back();
+    if (scratch != bytes) return "serializeInto != serialize";
+
+    BinaryWriter writer;
+    writer.writeUint8(0xA5);
+    serialize(value, writer);
+    if (!std::ranges::equal(writer.view().subspan(1), bytes)) return "serialize(writer) != serialize";
+
+    const DecodeResult<T> decoded = Traits::tryDecode(bytes.data(), bytes.size());
+    if (!decoded) return "tryDeserialize rejected a valid encoding";
+    if (!(*decoded == value)) return "tryDeserialize != original";
+    if (const char* failure = checkDynamic<T>(bytes.data(), bytes.size(), decoded)) return failure;
+    if (!(Traits::decode(bytes.data(), bytes.size()) == value)) return "deserialize != original";
+    if constexpr (Traits::HAS_VIEW) {
+        if (!Traits::viewMatches(Traits::view(bytes.data(), bytes.size()), value)) return "view != original";
+    }
+    if constexpr (Traits::HAS_COMMAND) {
+        const DecodeResult<Message> message = tryDecodeMessage(T::COMMAND_ID, bytes);
+        if (!message || !std::holds_alternative<T>(*message) || !(std::get<T>(*message) == value)) return "tryDecodeMessage != original";
+    }
+
+    // Every strict prefix is truncated
+    if (!bytes.empty()) {
+        const size_t cut = static_cast<size_t>(std::hash<size_t>{}(bytes.size() * 31 + bytes.front()) % bytes.size());
+        if (Traits::tryDecode(bytes.data(), cut)) return "tryDeserialize accepted a truncated encoding";
+    }
+
+    if constexpr (Traits::HAS_COMPACT) {
+        // A @compact row is at most twice its fixed size, so this always fits the length prefix
+        if (2 * bytes.size() + detail::MAX_VARINT_SIZE <= std::numeric_limits<uint16_t>::max()) {
+            const std::vector<uint8_t> compact = serializeCompact(value);
+            const DecodeResult<T> expanded = Traits::tryDecodeCompact(compact.data(), compact.size());
+            if (!expanded) return "tryDeserializeCompact rejected a valid encoding";
+            if (!(*expanded == value)) return "compact round trip != original";
+        }
+    }
+    return nullptr;
+}
+
+/// Invariants for arbitrary input bytes; returns the name of the first failed check, or nullptr
+template<typename T>
+const char* checkDecode(const uint8_t* data, size_t size) {
+    using Traits = CodecTraits<T>;
+    const DecodeResult<T> decoded = Traits::tryDecode(data, size);
+    if (const char* failure = checkDynamic<T>(data, size, decoded)) return failure;
+    if (decoded) {
+        // Accepted input re-encodes to a canonical form that decodes to the same value
+        const std::vector<uint8_t> bytes = serialize(*decoded);
+        const DecodeResult<T> again = Traits::tryDecode(bytes.data(), bytes.size());
+        if (!again) return "tryDeserialize rejected its own re-encoding";
+        if (serialize(*again) != bytes) return "re-encoding is not a fixpoint";
+        if (!matches(*again, *decoded)) return "re-decoded value differs";
+        if (!matches(Traits::decode(data, size), *decoded)) return "deserialize disagrees with tryDeserialize";
+        if constexpr (Traits::HAS_VIEW) {
+            if (!Traits::viewMatches(Traits::view(data, size), *decoded)) return "view disagrees with tryDeserialize";
+        }
+    }
+    if constexpr (Traits::HAS_COMPACT) {
+        const DecodeResult<T> expanded = Traits::tryDecodeCompact(data, size);
+        if (expanded && 2 * encodedSize(*expanded) + detail::MAX_VARINT_SIZE <= std::numeric_limits<uint16_t>::max()) {
+            const std::vector<uint8_t> compact = serializeCompact(*expanded);
+            const DecodeResult<T> again = Traits::tryDecodeCompact(compact.data(), compact.size());
+            if (!again) return "tryDeserializeCompact rejected its own re-encoding";
+            if (!matches(*again, *expanded)) return "compact re-decoded value differs";
+        }
+    }
+    return nullptr;
+}
+
+/**
+ * FrameDecoder must yield the same frames however the stream is chunked.
+ * The first input byte seeds the chunk sizes.
+ */
+inline const char* checkFrames(const uint8_t* data, size_t size) {
+    if (size == 0) return nullptr;
+    const std::span<const uint8_t> stream(data + 1, size - 1);
+    const size_t maxPayload = 4096;
+
+    std::vector<std::vector<uint8_t>> whole;
+    FrameDecoder oneShot(maxPayload);
+    oneShot.feed(stream, [&](const Frame& frame) {
+        whole.emplace_back(frame.bytes.begin(), frame.bytes.end());
+        if (frame.payload.size() != frame.header.payload_length) return;
+        (void)tryDecodeMessage(frame.header.command_id, frame.payload);
+        (void)verifyFrame(frame.bytes);
+    });
+
+    std::vector<std::vector<uint8_t>> chunked;
+    FrameDecoder incremental(maxPayload);
+    Random chunks(data[0]);
+    for (size_t offset = 0; offset < stream.size();) {
+        const size_t take = std::min<size_t>(stream.size() - offset, 1 + chunks.below(32));
+        incremental.feed(stream.subspan(offset, take), [&](const Frame& frame) {
+            chunked.emplace_back(frame.bytes.begin(), frame.bytes.end());
+        });
+        offset += take;
+    }
+    if (whole != chunked) return "chunked FrameDecoder output differs";
+    return nullptr;
+}
+
+} // namespace binaryprotocol::testing
+
+#endif // BINARY_PROTOCOL_TEST_CODEC_HPP
\ No newline at end of file
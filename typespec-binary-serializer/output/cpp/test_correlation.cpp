@@ -0,0 +1,264 @@
+/**
+ * Auto-generated request/response correlation test
+ *
+ *     test_correlation [--iterations N] [--seed S]
+ *
+ * Runs random track/match/cancel/expire sequences against a std::map reference
+ * model: with one slot, with many, with occasional huge timeouts and clock jumps,
+ * and with sparse sequence_ids. Then checks that expire() callbacks may call back
+ * into the correlator and that a large population expires exactly on time.
+ */
+
+#include "correlation.hpp"
+#include "test_codec.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <cinttypes>
+#include <cstdio>
+#include <cstdlib>
+#include <iterator>
+#include <map>
+#include <memory>
+#include <string_view>
+
+using namespace binaryprotocol;
+using namespace binaryprotocol::testing;
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+using std::chrono::milliseconds;
+
+/// Every command ID of the protocol
+constexpr uint8_t COMMANDS[] = {
+    PingCommand::COMMAND_ID,
+    PingResponse::COMMAND_ID,
+    GetDeviceInfoCommand::COMMAND_ID,
+    DeviceInfoResponse::COMMAND_ID,
+    SendDataCommand::COMMAND_ID,
+    SendDataResponse::COMMAND_ID,
+    SetConfigCommand::COMMAND_ID,
+    SetConfigResponse::COMMAND_ID,
+    BatchCommand::COMMAND_ID,
+    BatchResponse::COMMAND_ID,
+    SensorDataResponse::COMMAND_ID,
+};
+
+/// Command IDs with a paired response
+constexpr uint8_t REQUESTS[] = {
+    PingCommand::COMMAND_ID,
+    GetDeviceInfoCommand::COMMAND_ID,
+    SendDataCommand::COMMAND_ID,
+    SetConfigCommand::COMMAND_ID,
+    BatchCommand::COMMAND_ID,
+};
+
+const Clock::time_point START = Clock::time_point{} + std::chrono::hours(1);
+
+struct Options {
+    uint64_t iterations = 100000;
+    uint64_t seed = 1;
+};
+
+bool fail(const char* test, const char* check, const Options& options, uint64_t iteration) {
+    std::fprintf(stderr, "FAIL %s: %s (seed %" PRIu64 ", iteration %" PRIu64 ")\n", test, check, options.seed, iteration);
+    return false;
+}
+
+ProtocolHeader headerOf(uint8_t commandId, SequenceId sequenceId) {
+    ProtocolHeader header{};
+    header.command_id = commandId;
+    header.sequence_id = sequenceId;
+    return header;
+}
+
+bool hasResponse(uint8_t commandId) {
+    return std::ranges::find(REQUESTS, commandId) != std::end(REQUESTS);
+}
+
+struct Round {
+    const char* name;
+    size_t capacity;
+    /// Sometimes track with a timeout of days and jump the clock by hours
+    bool longTimeouts;
+    /// Spacing of sequence_ids, so large ones spread over the whole index
+    SequenceId stride;
+};
+
+/// A request in flight in the reference model
+struct Pending {
+    /// Tick at which it expires
+    uint64_t deadline;
+    uint8_t commandId;
+    uint64_t context;
+};
+
+bool runModel(const Round& round, const Options& options) {
+    using Context = std::unique_ptr<uint64_t>;
+    Random rng(options.seed ^ std::hash<std::string_view>{}(round.name));
+    Correlator<Context> correlator(round.capacity, milliseconds(1), START);
+    std::map<SequenceId, Pending> model;
+    CorrelatorStats expected;
+    uint64_t now = 0;
+    const char* failure = nullptr;
+
+    for (uint64_t i = 0; i < options.iterations; i++) {
+        const uint64_t op = rng.below(10);
+        const SequenceId sequence = static_cast<SequenceId>(rng.below(3000) * round.stride);
+        const auto found = model.find(sequence);
+        if (op < 5) {
+            const uint8_t command = COMMANDS[rng.below(std::size(COMMANDS))];
+            const uint64_t timeout = round.longTimeouts && rng.below(50) == 0 ? rng.below(100000000) : rng.below(700);
+            const TrackResult result = correlator.track(headerOf(command, sequence), milliseconds(timeout),
+                                                        std::make_unique<uint64_t>(i), START + milliseconds(now));
+            const TrackResult want = !hasResponse(command) ? TrackResult::NoResponse
+                : found != model.end() ? TrackResult::DuplicateSequence
+                : model.size() == round.capacity ? TrackResult::Full
+                : TrackResult::Tracked;
+            if (result != want) return fail(round.name, "track result differs from the model", options, i);
+            if (want == TrackResult::Tracked) {
+                model[sequence] = {now + std::max<uint64_t>(timeout, 1), command, i};
+                expected.tracked++;
+            }
+        } else if (op < 7) {
+            // Mostly the response to the tracked request, otherwise any response
+            const uint8_t command = found != model.end() && rng.below(4) != 0
+                ? found->second.commandId
+                : REQUESTS[rng.below(std::size(REQUESTS))];
+            const std::optional<Context> context = correlator.match(headerOf(command | RESPONSE_FLAG, sequence));
+            if (found != model.end() && command == found->second.commandId) {
+                if (!context || **context != found->second.context) return fail(round.name, "match missed a tracked request", options, i);
+                model.erase(found);
+                expected.matched++;
+            } else if (context) {
+                return fail(round.name, "match completed the wrong request", options, i);
+            }
+        } else if (op < 8) {
+            const std::optional<Context> context = correlator.cancel(sequence);
+            if (found != model.end()) {
+                if (!context || **context != found->second.context) return fail(round.name, "cancel missed a tracked request", options, i);
+                model.erase(found);
+            } else if (context) {
+                return fail(round.name, "cancel returned an untracked request", options, i);
+            }
+        } else {
+            now += round.longTimeouts && rng.below(100) == 0 ? rng.below(5000000) : rng.below(40);
+            correlator.expire(START + milliseconds(now), [&](ExpiredRequest<Context>&& request) {
+                const auto it = model.find(request.sequenceId);
+                if (it == model.end() || it->second.deadline > now) {
+                    failure = "expired a request before its deadline";
+                } else if (request.commandId != it->second.commandId || *request.context != it->second.context
+                           || request.error != ErrorCode::Timeout) {
+                    failure = "expired request differs from the model";
+                } else {
+                    model.erase(it);
+                    expected.timedOut++;
+                }
+            });
+            if (failure) return fail(round.name, failure, options, i);
+            for (const auto& [id, pending] : model) {
+                if (pending.deadline <= now) return fail(round.name, "request outlived its deadline", options, i);
+            }
+        }
+        if (correlator.size() != model.size()) return fail(round.name, "size differs from the model", options, i);
+    }
+
+    const CorrelatorStats& stats = correlator.stats();
+    if (stats.tracked != expected.tracked || stats.matched != expected.matched || stats.timedOut != expected.timedOut) {
+        return fail(round.name, "stats differ from the model", options, options.iterations);
+    }
+
+    const size_t inFlight = model.size();
+    const size_t cancelled = correlator.cancelAll([&](SequenceId id, uint8_t commandId, Context&& context) {
+        const auto it = model.find(id);
+        if (it == model.end() || commandId != it->second.commandId || *context != it->second.context) {
+            failure = "cancelAll returned a request the model does not have";
+        } else {
+            model.erase(it);
+        }
+    });
+    if (failure) return fail(round.name, failure, options, options.iterations);
+    if (cancelled != inFlight || !model.empty() || correlator.size() != 0) {
+        return fail(round.name, "cancelAll left requests in flight", options, options.iterations);
+    }
+    return true;
+}
+
+/// The first expiry cancels every other request due in the same tick and tracks a new one
+bool runReentrant(const Options& options) {
+    const uint8_t command = REQUESTS[0];
+    Correlator<uint64_t> correlator(16, milliseconds(1), START);
+    for (SequenceId id = 0; id < 8; id++) {
+        correlator.track(headerOf(command, id), milliseconds(5), id, START);
+    }
+
+    bool ok = true;
+    const size_t expired = correlator.expire(START + milliseconds(5), [&](ExpiredRequest<uint64_t>&& request) {
+        for (SequenceId id = 0; id < 8; id++) {
+            if (id != request.sequenceId) ok = correlator.cancel(id).has_value() && ok;
+        }
+        ok = correlator.track(headerOf(command, 100), milliseconds(1), 100, START + milliseconds(5)) == TrackResult::Tracked && ok;
+    });
+    if (!ok || expired != 1 || correlator.size() != 1) return fail("reentrant", "callback could not modify the correlator", options, 0);
+    if (correlator.expire(START + milliseconds(6), [](ExpiredRequest<uint64_t>&&) {}) != 1) {
+        return fail("reentrant", "request tracked from a callback did not expire", options, 1);
+    }
+    return correlator.size() == 0 || fail("reentrant", "requests left after expiry", options, 1);
+}
+
+/// Many requests in flight: half are answered, the rest expire together
+bool runScale(const Options& options) {
+    const uint8_t command = REQUESTS[0];
+    const SequenceId count = 100000;
+    Correlator<uint64_t> correlator(count, milliseconds(1), START);
+    for (SequenceId id = 0; id < count; id++) {
+        if (correlator.track(headerOf(command, id * 7), milliseconds(1000 + id % 5000), id, START) != TrackResult::Tracked) {
+            return fail("scale", "track refused a request below capacity", options, id);
+        }
+    }
+    for (SequenceId id = 0; id < count; id += 2) {
+        const std::optional<uint64_t> context = correlator.match(headerOf(command | RESPONSE_FLAG, id * 7));
+        if (!context || *context != id) return fail("scale", "match missed a tracked request", options, id);
+    }
+    // The unanswered (odd) requests due last are those with id % 5000 == 4999
+    const size_t last = count / 5000;
+    if (correlator.expire(START + milliseconds(5998), [](ExpiredRequest<uint64_t>&&) {}) != count / 2 - last) {
+        return fail("scale", "expired the wrong number of requests", options, 0);
+    }
+    if (correlator.expire(START + milliseconds(5999), [](ExpiredRequest<uint64_t>&&) {}) != last || correlator.size() != 0) {
+        return fail("scale", "did not expire at the last deadline", options, 0);
+    }
+    return true;
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    Options options;
+    for (int i = 1; i < argc; i++) {
+        const std::string_view arg = argv[i];
+        if (arg == "--iterations" && i + 1 < argc) {
+            options.iterations = std::strtoull(argv[++i], nullptr, 10);
+        } else if (arg == "--seed" && i + 1 < argc) {
+            options.seed = std::strtoull(argv[++i], nullptr, 10);
+        } else {
+            std::fprintf(stderr, "usage: %s [--iterations N] [--seed S]\n", argv[0]);
+            return 2;
+        }
+    }
+
+    const Round rounds[] = {
+        {"one slot", 1, false, 1},
+        {"many", 1000, false, 1},
+        {"long timeouts", 1000, true, 1},
+        {"sparse", 1000, false, 65536},
+    };
+    bool ok = true;
+    for (const Round& round : rounds) {
+        ok = runModel(round, options) && ok;
+    }
+    ok = runReentrant(options) && ok;
+    ok = runScale(options) && ok;
+    return ok ? 0 : 1;
+}
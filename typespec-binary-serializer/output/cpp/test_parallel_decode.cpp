@@ -0,0 +1,220 @@
+/**
+ * Auto-generated parallel decoder regression test
+ *
+ *     test_parallel_decode [--iterations N] [--seed S]
+ *
+ * Builds a buffer of N random frames in shuffled sequence_id order, with garbage,
+ * an unknown command, a corrupt frame, and a partial final frame mixed in, and decodes it
+ * with several thread counts. Every frame must arrive once and intact, the stats
+ * must account for everything else, and DeliveryOrder::Sequence must deliver in
+ * ascending sequence_id. Configure with -DBINARY_PROTOCOL_SANITIZE=thread to run
+ * the worker pool under ThreadSanitizer. A scan of garbage that ends in a cut-off
+ * magic number must leave those bytes as a trailing partial frame.
+ *
+ * Headers whose payload_length exceeds the default maxPayload are mixed in too;
+ * the scan must skip them rather than wait for a payload that never comes.
+ */
+
+#include "parallel_decode.hpp"
+#include "test_codec.hpp"
+
+#include <algorithm>
+#include <cinttypes>
+#include <cstdio>
+#include <cstdlib>
+#include <limits>
+#include <mutex>
+#include <numeric>
+#include <string_view>
+#include <vector>
+
+using namespace binaryprotocol;
+using namespace binaryprotocol::testing;
+
+namespace {
+
+struct Options {
+    uint64_t iterations = 20000;
+    uint64_t seed = 1;
+};
+
+bool fail(const char* check, const Options& options, unsigned threads) {
+    std::fprintf(stderr, "FAIL parallel decode: %s (seed %" PRIu64 ", %u threads)\n", check, options.seed, threads);
+    return false;
+}
+
+/// Larger payloads are redrawn so the buffer stays a few megabytes
+constexpr size_t MAX_TEST_PAYLOAD = 1024;
+
+std::vector<uint8_t> encode(const Message& message, uint8_t& commandId) {
+    return std::visit([&](const auto& value) {
+        commandId = MessageTraits<std::decay_t<decltype(value)>>::COMMAND_ID;
+        return serialize(value);
+    }, message);
+}
+
+void appendFrame(std::vector<uint8_t>& buffer, uint8_t commandId, uint32_t sequence, std::span<const uint8_t> payload) {
+    ProtocolHeader header{};
+    header.magic = ProtocolHeader::MAGIC;
+    header.command_id = commandId;
+    header.sequence_id = sequence;
+    header.payload_length = static_cast<decltype(header.payload_length)>(payload.size());
+    sealFrame(header, payload);
+    const std::vector<uint8_t> encoded = serialize(header);
+    buffer.insert(buffer.end(), encoded.begin(), encoded.end());
+    buffer.insert(buffer.end(), payload.begin(), payload.end());
+}
+
+struct Capture {
+    std::vector<uint8_t> bytes;
+    /// Message of each decodable frame, indexed by sequence_id
+    std::vector<Message> messages;
+    uint64_t skippedBytes = 0;
+    /// Offset of the partial final frame
+    uint64_t end = 0;
+};
+
+Capture buildCapture(const Options& options) {
+    Capture capture;
+    Random rng(options.seed);
+    const uint32_t frames = static_cast<uint32_t>(options.iterations);
+    std::vector<uint32_t> order(frames);
+    std::iota(order.begin(), order.end(), 0u);
+    // Swap neighbours so sequence_id runs out of order across batch boundaries
+    for (uint32_t i = 0; i + 1 < frames; i += 1 + static_cast<uint32_t>(rng.below(8))) std::swap(order[i], order[i + 1]);
+
+    capture.messages.resize(frames);
+    std::vector<uint8_t> payload;
+    uint8_t commandId = 0;
+    for (uint32_t i = 0; i < frames; i++) {
+        const uint32_t sequence = order[i];
+        do {
+            capture.messages[sequence] = randomMessage(rng);
+            payload = encode(capture.messages[sequence], commandId);
+        } while (payload.size() > MAX_TEST_PAYLOAD);
+        appendFrame(capture.bytes, commandId, sequence, payload);
+
+        if (i % 1000 == 500) {
+            // No byte of the magic number, so the resync skips exactly these
+            capture.bytes.insert(capture.bytes.end(), {0x01, 0x02, 0x03, 0x04, 0x05});
+            capture.skippedBytes += 5;
+        }
+
+        if (i % 1000 == 900) {
+            // A header claiming more than maxPayload is skipped instead of swallowing the frames behind it
+            ProtocolHeader oversized{};
+            oversized.magic = ProtocolHeader::MAGIC;
+            oversized.payload_length = std::numeric_limits<decltype(oversized.payload_length)>::max();
+            const std::vector<uint8_t> encoded = serialize(oversized);
+            capture.bytes.insert(capture.bytes.end(), encoded.begin(), encoded.end());
+            capture.skippedBytes += encoded.size();
+        }
+    }
+
+    // A command ID outside the protocol is malformed
+    appendFrame(capture.bytes, 0x00, frames, {});
+
+    // A frame whose checksum no longer matches is dropped as corrupt
+    const size_t corrupt = capture.bytes.size();
+    appendFrame(capture.bytes, commandId, frames + 1, payload);
+    capture.bytes[corrupt + 12] ^= 1;
+
+    capture.end = capture.bytes.size();
+    appendFrame(capture.bytes, commandId, frames + 2, payload);
+    capture.bytes.pop_back();
+    return capture;
+}
+
+bool statsMatch(const ParallelDecodeStats& stats, const Capture& capture) {
+    return stats.frames == capture.messages.size()
+        && stats.malformed == 1
+        && stats.corrupt == 1
+        && stats.skippedBytes == capture.skippedBytes
+        && stats.trailingBytes == capture.bytes.size() - capture.end;
+}
+
+/// The header-only scan that partitions the work for every thread count
+bool checkScan(const Capture& capture, const Options& options) {
+    const FrameScan scan = scanFrames(capture.bytes);
+    if (scan.frames.size() != capture.messages.size() + 2) return fail("scanFrames miscounted frames", options, 0);
+    if (scan.skippedBytes != capture.skippedBytes) return fail("scanFrames miscounted skipped bytes", options, 0);
+    if (scan.end != capture.end) return fail("scanFrames did not stop at the partial frame", options, 0);
+
+    // Garbage ending in a cut-off magic number: the frame it may start is trailing, not skipped
+    std::vector<uint8_t> tail(ProtocolHeader::ENCODED_SIZE, 0x01);
+    tail.insert(tail.end(), detail::FRAME_MAGIC_BYTES.begin(), detail::FRAME_MAGIC_BYTES.end() - 1);
+    const FrameScan cut = scanFrames(tail);
+    const size_t frameStart = ProtocolHeader::ENCODED_SIZE - detail::FRAME_MAGIC_OFFSET;
+    if (!cut.frames.empty() || cut.skippedBytes != frameStart || cut.end != frameStart) {
+        return fail("scanFrames skipped the start of a cut-off frame", options, 0);
+    }
+    return true;
+}
+
+bool runDecode(const Capture& capture, const Options& options, unsigned threads) {
+    constexpr size_t BATCH = 256;
+    ParallelDecoder decoder({.threads = threads, .framesPerBatch = BATCH});
+    const size_t frames = capture.messages.size();
+
+    // Unordered: batches arrive on the worker threads
+    std::mutex mutex;
+    std::vector<uint32_t> seen(frames, 0);
+    const char* failure = nullptr;
+    ParallelDecodeStats stats = decoder.decode(capture.bytes, [&](std::span<DecodedFrame> batch) {
+        std::lock_guard lock(mutex);
+        if (batch.size() > BATCH) failure = "batch larger than framesPerBatch";
+        for (const DecodedFrame& frame : batch) {
+            const uint32_t sequence = frame.header.sequence_id;
+            if (sequence >= frames || seen[sequence]++ != 0) failure = "frame delivered twice or from outside the buffer";
+            else if (!(frame.message == capture.messages[sequence])) failure = "decoded message differs";
+        }
+    });
+    if (failure) return fail(failure, options, threads);
+    if (static_cast<size_t>(std::ranges::count(seen, 1u)) != frames) return fail("frame lost", options, threads);
+    if (!statsMatch(stats, capture)) return fail("unordered stats do not account for the buffer", options, threads);
+
+    // Sequence: twice, so the second pass reuses the per-task buffers
+    for (int pass = 0; pass < 2; pass++) {
+        uint32_t next = 0;
+        stats = decoder.decode(capture.bytes, [&](std::span<DecodedFrame> batch) {
+            if (batch.size() > BATCH) failure = "batch larger than framesPerBatch";
+            for (const DecodedFrame& frame : batch) {
+                if (frame.header.sequence_id != next) failure = "sequence delivery out of order";
+                else if (!(frame.message == capture.messages[next])) failure = "decoded message differs";
+                next++;
+            }
+        }, DeliveryOrder::Sequence);
+        if (failure) return fail(failure, options, threads);
+        if (next != frames) return fail("sequence delivery lost frames", options, threads);
+        if (!statsMatch(stats, capture)) return fail("sequence stats do not account for the buffer", options, threads);
+    }
+
+    bool called = false;
+    stats = decoder.decode({}, [&](std::span<DecodedFrame>) { called = true; });
+    if (called || stats.frames != 0) return fail("empty buffer produced frames", options, threads);
+    return true;
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    Options options;
+    for (int i = 1; i < argc; i++) {
+        const std::string_view arg = argv[i];
+        if (arg == "--iterations" && i + 1 < argc) {
+            options.iterations = std::strtoull(argv[++i], nullptr, 10);
+        } else if (arg == "--seed" && i + 1 < argc) {
+            options.seed = std::strtoull(argv[++i], nullptr, 10);
+        } else {
+            std::fprintf(stderr, "usage: %s [--iterations N] [--seed S]\n", argv[0]);
+            return 2;
+        }
+    }
+
+    const Capture capture = buildCapture(options);
+    bool ok = checkScan(capture, options);
+    for (const unsigned threads : {1u, 3u, 8u}) {
+        ok = runDecode(capture, options, threads) && ok;
+    }
+    return ok ? 0 : 1;
+}
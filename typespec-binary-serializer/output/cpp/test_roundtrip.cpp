@@ -0,0 +1,292 @@
+/**
+ * Auto-generated randomized round-trip stress test
+ *
+ *     test_roundtrip [--iterations N] [--seed S] [--model NAME]
+ *
+ * For every model: N random instances through checkRoundTrip(), values with a
+ * field past its length prefix through checkOversized(), N / 4 mutated encodings
+ * through checkDecode(), then the serializeInto/tryDeserialize round trip timed
+ * over a batch of the instances. Both checks compare the dynamic codec against
+ * the generated one; "descriptor" feeds Schema::load() damaged descriptors.
+ * Exits non-zero on the first failure and prints the seed and bytes needed to
+ * reproduce it.
+ */
+
+#include "test_codec.hpp"
+
+#include <chrono>
+#include <cinttypes>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <optional>
+#include <stdexcept>
+#include <string_view>
+
+using namespace binaryprotocol;
+using namespace binaryprotocol::testing;
+
+namespace {
+
+struct Options {
+    uint64_t iterations = 100000;
+    uint64_t seed = 1;
+    const char* model = nullptr;
+};
+
+void dump(std::span<const uint8_t> bytes) {
+    const size_t shown = std::min<size_t>(bytes.size(), 256);
+    for (size_t i = 0; i < shown; i++) {
+        std::fprintf(stderr, "%02x%s", bytes[i], (i + 1) % 32 == 0 ? "\n" : " ");
+    }
+    std::fprintf(stderr, "%s(%zu bytes)\n", shown % 32 == 0 ? "" : "\n", bytes.size());
+}
+
+bool fail(const char* model, const char* check, const Options& options, uint64_t iteration, std::span<const uint8_t> bytes) {
+    std::fprintf(stderr, "FAIL %s: %s (seed %" PRIu64 ", iteration %" PRIu64 ")\n", model, check, options.seed, iteration);
+    dump(bytes);
+    return false;
+}
+
+/// Flips, overwrites, truncates or extends a valid encoding
+void mutate(std::vector<uint8_t>& bytes, Random& rng) {
+    const uint64_t edits = 1 + rng.below(4);
+    for (uint64_t e = 0; e < edits; e++) {
+        switch (rng.below(4)) {
+        case 0:
+            if (!bytes.empty()) bytes[rng.below(bytes.size())] ^= static_cast<uint8_t>(1u << rng.below(8));
+            break;
+        case 1:
+            if (!bytes.empty()) bytes[rng.below(bytes.size())] = rng.integer<uint8_t>();
+            break;
+        case 2:
+            bytes.resize(rng.below(bytes.size() + 1));
+            break;
+        default:
+            bytes.push_back(rng.integer<uint8_t>());
+            break;
+        }
+    }
+}
+
+#if defined(__cpp_exceptions)
+/// Every encoder must reject a field longer than its length prefix before writing anything
+template<typename T>
+const char* checkOversized(const T& value) {
+    const auto rejects = [](auto&& encode) {
+        try {
+            encode();
+        } catch (const std::length_error&) {
+            return true;
+        }
+        return false;
+    };
+    std::vector<uint8_t> buffer(encodedSize(value));
+    if (!rejects([&] { serializeInto(value, buffer); })) {
+        return "serializeInto accepted a field longer than its length prefix";
+    }
+    BinaryWriter writer;
+    if (!rejects([&] { serialize(value, writer); }) || writer.size() != 0) {
+        return "serialize(writer) did not reject a field longer than its length prefix up front";
+    }
+    if constexpr (CodecTraits<T>::HAS_VIEW) {
+        GatherList gather;
+        if (!rejects([&] { serializeGather(value, gather); }) || gather.size() != 0) {
+            return "serializeGather did not reject a field longer than its length prefix up front";
+        }
+    }
+    return nullptr;
+}
+#endif
+
+template<typename T>
+bool runModel(const Options& options) {
+    const char* name = CodecTraits<T>::NAME;
+    Random rng(options.seed ^ std::hash<std::string_view>{}(name));
+    std::vector<uint8_t> scratch;
+
+    for (uint64_t i = 0; i < options.iterations; i++) {
+        const T value = CodecTraits<T>::random(rng);
+        if (const char* failure = checkRoundTrip(value, scratch)) {
+            return fail(name, failure, options, i, serialize(value));
+        }
+    }
+
+#if defined(__cpp_exceptions)
+    if constexpr (requires { CodecTraits<T>::oversized(rng); }) {
+        for (uint64_t i = 0; i < 8; i++) {
+            if (const char* failure = checkOversized(CodecTraits<T>::oversized(rng))) {
+                return fail(name, failure, options, i, {});
+            }
+        }
+    }
+#endif
+
+    for (uint64_t i = 0; i < options.iterations / 4; i++) {
+        std::vector<uint8_t> bytes = serialize(CodecTraits<T>::random(rng));
+        mutate(bytes, rng);
+        if (const char* failure = checkDecode<T>(bytes.data(), bytes.size())) {
+            return fail(name, failure, options, i, bytes);
+        }
+    }
+
+    // Throughput of the hot path alone, over a batch that fits in cache
+    std::vector<T> batch;
+    size_t batchBytes = 0;
+    for (size_t i = 0; i < 256; i++) {
+        batch.push_back(CodecTraits<T>::random(rng));
+        batchBytes += encodedSize(batch.back());
+    }
+    const uint64_t rounds = std::max<uint64_t>(1, options.iterations / batch.size());
+    scratch.resize(batchBytes);
+    uint64_t checksum = 0;
+    const auto start = std::chrono::steady_clock::now();
+    for (uint64_t round = 0; round < rounds; round++) {
+        size_t offset = 0;
+        for (const T& value : batch) {
+            const size_t size = serializeInto(value, std::span<uint8_t>(scratch).subspan(offset));
+            const DecodeResult<T> decoded = CodecTraits<T>::tryDecode(scratch.data() + offset, size);
+            checksum += decoded.has_value();
+            offset += size;
+        }
+    }
+    const double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    if (checksum != rounds * batch.size()) {
+        return fail(name, "tryDeserialize rejected a valid encoding while timing", options, 0, {});
+    }
+
+    const double messages = static_cast<double>(rounds * batch.size());
+    std::printf("%-24s %10.2f M round trips/s %10.1f MB/s\n", name,
+        messages / seconds / 1e6, static_cast<double>(rounds * batchBytes) / seconds / 1e6);
+    return true;
+}
+
+bool runFrames(const Options& options) {
+    Random rng(options.seed);
+    std::vector<uint8_t> stream;
+    for (uint64_t i = 0; i < options.iterations / 16; i++) {
+        stream.assign(1, rng.integer<uint8_t>());
+        const uint64_t frames = rng.below(8);
+        for (uint64_t f = 0; f < frames; f++) {
+            ProtocolHeader header = CodecTraits<ProtocolHeader>::random(rng);
+            header.magic = ProtocolHeader::MAGIC;
+            std::vector<uint8_t> payload(rng.length(512));
+            rng.fill(payload);
+            header.payload_length = static_cast<decltype(header.payload_length)>(payload.size());
+            const std::vector<uint8_t> head = serialize(header);
+            stream.insert(stream.end(), head.begin(), head.end());
+            stream.insert(stream.end(), payload.begin(), payload.end());
+        }
+        if (rng.boolean()) mutate(stream, rng);
+        if (const char* failure = checkFrames(stream.data(), stream.size())) {
+            return fail("frames", failure, options, i, stream);
+        }
+    }
+    std::printf("%-24s ok\n", "frames");
+    return true;
+}
+
+#if defined(__cpp_exceptions)
+/// Schema::load() rejects malformed descriptors, and whatever damaged one it accepts decodes arbitrary bytes safely
+bool runDescriptor(const Options& options) {
+    Random rng(options.seed);
+    const std::span<const uint8_t> descriptor = dynamic::builtinSchemaDescriptor();
+    const auto rejects = [](std::span<const uint8_t> bytes) {
+        try {
+            (void)dynamic::Schema::load(bytes);
+        } catch (const std::runtime_error&) {
+            return true;
+        }
+        return false;
+    };
+
+    for (size_t size = 0; size < descriptor.size(); size++) {
+        if (!rejects(descriptor.first(size))) {
+            return fail("descriptor", "Schema::load accepted a truncated descriptor", options, size, descriptor.first(size));
+        }
+    }
+    std::vector<uint8_t> bytes(descriptor.begin(), descriptor.end());
+    bytes.push_back(0);
+    if (!rejects(bytes)) return fail("descriptor", "Schema::load accepted trailing bytes", options, 0, bytes);
+    // Magic and version
+    for (const size_t offset : {size_t{0}, size_t{4}}) {
+        bytes.assign(descriptor.begin(), descriptor.end());
+        bytes[offset] ^= 0xFF;
+        if (!rejects(bytes)) return fail("descriptor", "Schema::load accepted a bad magic or version", options, offset, bytes);
+    }
+
+    std::vector<uint8_t> input;
+    for (uint64_t i = 0; i < options.iterations / 16; i++) {
+        bytes.assign(descriptor.begin(), descriptor.end());
+        for (uint64_t edits = 1 + rng.below(3); edits > 0; edits--) {
+            bytes[rng.below(bytes.size())] = rng.integer<uint8_t>();
+        }
+        std::optional<dynamic::Schema> schema;
+        try {
+            schema.emplace(dynamic::Schema::load(bytes));
+        } catch (const std::runtime_error&) {
+            continue;
+        }
+        for (const auto& model : schema->models()) {
+            input.resize(rng.length(256));
+            rng.fill(input);
+            dynamic::Record record;
+            (void)model->decodeInto(input, record);
+        }
+    }
+    std::printf("%-24s ok\n", "descriptor");
+    return true;
+}
+#endif
+
+struct ModelRun {
+    const char* name;
+    bool (*run)(const Options&);
+};
+
+constexpr ModelRun MODELS[] = {
+    {"ProtocolHeader", runModel<ProtocolHeader>},
+    {"PingCommand", runModel<PingCommand>},
+    {"PingResponse", runModel<PingResponse>},
+    {"GetDeviceInfoCommand", runModel<GetDeviceInfoCommand>},
+    {"DeviceInfoResponse", runModel<DeviceInfoResponse>},
+    {"SendDataCommand", runModel<SendDataCommand>},
+    {"SendDataResponse", runModel<SendDataResponse>},
+    {"SetConfigCommand", runModel<SetConfigCommand>},
+    {"SetConfigResponse", runModel<SetConfigResponse>},
+    {"BatchCommand", runModel<BatchCommand>},
+    {"BatchResponse", runModel<BatchResponse>},
+    {"Vector3D", runModel<Vector3D>},
+    {"SensorData", runModel<SensorData>},
+    {"SensorDataResponse", runModel<SensorDataResponse>},
+    {"frames", runFrames},
+#if defined(__cpp_exceptions)
+    {"descriptor", runDescriptor},
+#endif
+};
+
+} // namespace
+
+int main(int argc, char** argv) {
+    Options options;
+    for (int i = 1; i < argc; i++) {
+        const std::string_view arg = argv[i];
+        if (arg == "--iterations" && i + 1 < argc) {
+            options.iterations = std::strtoull(argv[++i], nullptr, 10);
+        } else if (arg == "--seed" && i + 1 < argc) {
+            options.seed = std::strtoull(argv[++i], nullptr, 10);
+        } else if (arg == "--model" && i + 1 < argc) {
+            options.model = argv[++i];
+        } else {
+            std::fprintf(stderr, "usage: %s [--iterations N] [--seed S] [--model NAME]\n", argv[0]);
+            return 2;
+        }
+    }
+
+    bool ok = true;
+    for (const ModelRun& model : MODELS) {
+        if (options.model && std::strcmp(options.model, model.name) != 0) continue;
+        ok = model.run(options) && ok;
+    }
+    return ok ? 0 : 1;
+}
\ No newline at end of file
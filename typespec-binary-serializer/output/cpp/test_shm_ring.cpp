@@ -0,0 +1,286 @@
+/**
+ * Auto-generated shared-memory ring test
+ *
+ *     test_shm_ring [--iterations N] [--seed S]
+ *
+ * Publishes random frames through publish() and publishFrame() into memfd
+ * rings and reads them back through readers attached with fromFd(). Readers
+ * that keep up see every frame in order and intact; a reader the writer laps
+ * must report Overrun, skip to the oldest frame left and count the overrun and
+ * the frames lost, as predicted by a model of which slots still hold their
+ * frame. valid() must turn false exactly when a frame's slot is reused, and
+ * frames larger than a slot must be rejected without touching the ring.
+ */
+
+#include "shm_ring.hpp"
+#include "test_codec.hpp"
+
+#include <algorithm>
+#include <cinttypes>
+#include <cstdio>
+#include <cstdlib>
+#include <deque>
+#include <optional>
+#include <stdexcept>
+#include <string_view>
+#include <variant>
+#include <vector>
+
+using namespace binaryprotocol;
+using namespace binaryprotocol::testing;
+
+namespace {
+
+struct Options {
+    uint64_t iterations = 20000;
+    uint64_t seed = 1;
+};
+
+bool fail(const char* test, const char* check, const Options& options, uint64_t iteration) {
+    std::fprintf(stderr, "FAIL %s: %s (seed %" PRIu64 ", iteration %" PRIu64 ")\n", test, check, options.seed, iteration);
+    return false;
+}
+
+/// Larger frames are redrawn
+constexpr uint32_t SLOT_SIZE = 2048;
+
+std::vector<uint8_t> frameOf(ProtocolHeader header, const Message& message) {
+    return std::visit([&](const auto& value) {
+        const std::vector<uint8_t> payload = serialize(value);
+        header.magic = ProtocolHeader::MAGIC;
+        header.command_id = MessageTraits<std::decay_t<decltype(value)>>::COMMAND_ID;
+        header.payload_length = static_cast<decltype(header.payload_length)>(payload.size());
+        sealFrame(header, payload);
+        std::vector<uint8_t> frame = serialize(header);
+        frame.insert(frame.end(), payload.begin(), payload.end());
+        return frame;
+    }, message);
+}
+
+/// Publishes a random frame that fits a slot through publish() or publishFrame(); returns the bytes readers should see
+std::vector<uint8_t> publishRandom(ShmRingWriter& writer, Random& rng) {
+    while (true) {
+        const ProtocolHeader header = CodecTraits<ProtocolHeader>::random(rng);
+        const Message message = randomMessage(rng);
+        std::vector<uint8_t> frame = frameOf(header, message);
+        if (frame.size() > writer.slotSize()) continue;
+        if (rng.boolean()) {
+            std::visit([&](const auto& value) { writer.publish(header, value); }, message);
+        } else {
+            writer.publishFrame(frame);
+        }
+        return frame;
+    }
+}
+
+/// Returns the name of the first failed check of a frame read back, or nullptr
+const char* checkFrame(const ShmRingReader& reader, const ShmRead& read, uint64_t sequence, const std::vector<uint8_t>& expected) {
+    if (read.status == ShmReadStatus::Pending) return "published frame reported Pending";
+    if (read.status == ShmReadStatus::Overrun) return "frame still in the ring reported Overrun";
+    if (read.frame.sequence != sequence) return "frame has the wrong sequence number";
+    if (!std::ranges::equal(read.frame.bytes, expected)) return "frame bytes differ from the frame published";
+    if (!(read.frame.header == deserializeProtocolHeader(expected.data(), ProtocolHeader::ENCODED_SIZE))) return "header differs from the frame published";
+    if (read.frame.payload.data() != read.frame.bytes.data() + ProtocolHeader::ENCODED_SIZE
+        || read.frame.payload.size() != expected.size() - ProtocolHeader::ENCODED_SIZE) {
+        return "payload is not the rest of the frame";
+    }
+    if (!reader.valid(read.frame)) return "valid() is false for a frame still in the ring";
+    return nullptr;
+}
+
+/// Two readers that keep up see every frame in order, the second from the point it attached
+bool runOrder(const Options& options) {
+    Random rng(options.seed);
+    ShmRingWriter writer = ShmRingWriter::createAnonymous({.slotCount = 64, .slotSize = SLOT_SIZE});
+    ShmRingReader first = ShmRingReader::fromFd(writer.fd());
+    std::optional<ShmRingReader> late;
+    // The last slotCount frames, ending at published() - 1
+    std::deque<std::vector<uint8_t>> frames;
+
+    for (uint64_t round = 0; writer.published() < options.iterations; round++) {
+        for (uint64_t burst = 1 + rng.below(writer.slotCount()); burst > 0; burst--) {
+            const uint64_t sequence = writer.published();
+            frames.push_back(publishRandom(writer, rng));
+            if (frames.size() > writer.slotCount()) frames.pop_front();
+            if (writer.published() != sequence + 1) return fail("order", "published() did not advance by one", options, sequence);
+        }
+        if (round == 1) {
+            late.emplace(ShmRingReader::fromFd(writer.fd()));
+            if (late->position() != writer.published()) return fail("order", "a new reader does not start at published()", options, round);
+        }
+
+        for (ShmRingReader* reader : {&first, late ? &*late : nullptr}) {
+            if (!reader) continue;
+            while (reader->position() < writer.published()) {
+                const uint64_t sequence = reader->position();
+                const std::vector<uint8_t>& expected = frames[sequence - (writer.published() - frames.size())];
+                if (const char* failure = checkFrame(*reader, reader->next(), sequence, expected)) return fail("order", failure, options, sequence);
+            }
+            if (reader->next().status != ShmReadStatus::Pending) return fail("order", "next() at published() is not Pending", options, round);
+            if (reader->position() != writer.published()) return fail("order", "Pending moved the position", options, round);
+            if (reader->stats().overruns != 0) return fail("order", "a reader that keeps up was overrun", options, round);
+        }
+
+        // read() reaches any frame still in the ring without moving the position
+        const uint64_t back = rng.below(frames.size());
+        const uint64_t sequence = writer.published() - 1 - back;
+        if (const char* failure = checkFrame(first, first.read(sequence), sequence, frames[frames.size() - 1 - back])) {
+            return fail("order", failure, options, sequence);
+        }
+        if (first.position() != writer.published()) return fail("order", "read() moved the position", options, round);
+    }
+    if (first.stats().frames != writer.published()) return fail("order", "stats().frames != frames published", options, 0);
+    return true;
+}
+
+/// A reader lapped by the writer reports Overrun, skips to the oldest frame left and counts the frames lost
+bool runOverrun(const Options& options) {
+    constexpr uint32_t SLOTS = 8;
+    Random rng(options.seed);
+    ShmRingWriter writer = ShmRingWriter::createAnonymous({.slotCount = SLOTS, .slotSize = SLOT_SIZE});
+    ShmRingReader reader = ShmRingReader::fromFd(writer.fd());
+    std::deque<std::vector<uint8_t>> frames;
+    uint64_t position = 0;
+    ShmReaderStats expected;
+
+    for (uint64_t i = 0; i < options.iterations / 8; i++) {
+        for (uint64_t count = rng.below(3 * SLOTS); count > 0; count--) {
+            frames.push_back(publishRandom(writer, rng));
+            if (frames.size() > SLOTS) frames.pop_front();
+        }
+        const uint64_t published = writer.published();
+        for (uint64_t count = rng.below(2 * SLOTS); count > 0; count--) {
+            const ShmRead read = reader.next();
+            if (position == published) {
+                if (read.status != ShmReadStatus::Pending) return fail("overrun", "next() at published() is not Pending", options, i);
+            } else if (position + SLOTS < published) {
+                // The frame's slot now holds a later one
+                if (read.status != ShmReadStatus::Overrun) return fail("overrun", "next() of an overwritten frame is not Overrun", options, i);
+                const uint64_t resume = std::max(published - SLOTS + 1, position + 1);
+                expected.overruns++;
+                expected.lostFrames += resume - position;
+                position = resume;
+            } else {
+                const std::vector<uint8_t>& frame = frames[position - (published - frames.size())];
+                if (const char* failure = checkFrame(reader, read, position, frame)) return fail("overrun", failure, options, i);
+                expected.frames++;
+                position++;
+            }
+            if (reader.position() != position) return fail("overrun", "position() differs from the model", options, i);
+            if (reader.stats().frames != expected.frames) return fail("overrun", "stats().frames differs from the model", options, i);
+            if (reader.stats().overruns != expected.overruns) return fail("overrun", "stats().overruns differs from the model", options, i);
+            if (reader.stats().lostFrames != expected.lostFrames) return fail("overrun", "stats().lostFrames differs from the model", options, i);
+        }
+    }
+    if (options.iterations >= 64 && expected.overruns == 0) return fail("overrun", "the writer never lapped the reader", options, 0);
+    return true;
+}
+
+/// valid() holds for a frame until the writer reuses its slot
+bool runValid(const Options& options) {
+    constexpr uint32_t SLOTS = 4;
+    Random rng(options.seed);
+    ShmRingWriter writer = ShmRingWriter::createAnonymous({.slotCount = SLOTS, .slotSize = SLOT_SIZE});
+    ShmRingReader reader = ShmRingReader::fromFd(writer.fd());
+
+    for (uint64_t i = 0; i < options.iterations / 16; i++) {
+        reader.seekLatest();
+        const uint64_t sequence = writer.published();
+        const std::vector<uint8_t> expected = publishRandom(writer, rng);
+        const ShmRead read = reader.next();
+        if (const char* failure = checkFrame(reader, read, sequence, expected)) return fail("valid", failure, options, i);
+
+        for (uint32_t later = 1; later < SLOTS; later++) {
+            publishRandom(writer, rng);
+            if (!reader.valid(read.frame)) return fail("valid", "valid() turned false before the slot was reused", options, i);
+        }
+        publishRandom(writer, rng);
+        if (reader.valid(read.frame)) return fail("valid", "valid() still true after the slot was reused", options, i);
+        if (reader.read(sequence).status != ShmReadStatus::Overrun) return fail("valid", "read() of an overwritten frame is not Overrun", options, i);
+    }
+    return true;
+}
+
+#if defined(__cpp_exceptions)
+/// Frames larger than a slot are rejected before the ring is touched, as are unusable ring options
+bool runOversized(const Options& options) {
+    constexpr uint32_t SMALL_SLOT = ProtocolHeader::ENCODED_SIZE + 64;
+    Random rng(options.seed);
+    ShmRingWriter writer = ShmRingWriter::createAnonymous({.slotCount = 4, .slotSize = SMALL_SLOT});
+    ShmRingReader reader = ShmRingReader::fromFd(writer.fd());
+
+    // Exactly one slot
+    ProtocolHeader header{};
+    header.magic = ProtocolHeader::MAGIC;
+    header.payload_length = SMALL_SLOT - ProtocolHeader::ENCODED_SIZE;
+    std::vector<uint8_t> last = serialize(header);
+    last.resize(SMALL_SLOT);
+    writer.publishFrame(last);
+
+    for (uint64_t i = 0; i < options.iterations / 16; i++) {
+        const ProtocolHeader random = CodecTraits<ProtocolHeader>::random(rng);
+        const Message message = randomMessage(rng);
+        const std::vector<uint8_t> frame = frameOf(random, message);
+        const uint64_t published = writer.published();
+        bool rejected = false;
+        try {
+            if (rng.boolean()) {
+                std::visit([&](const auto& value) { writer.publish(random, value); }, message);
+            } else {
+                writer.publishFrame(frame);
+            }
+        } catch (const std::length_error&) {
+            rejected = true;
+        }
+
+        if (rejected != (frame.size() > SMALL_SLOT)) {
+            return fail("oversized", rejected ? "a frame that fits was rejected" : "a frame larger than a slot was published", options, i);
+        }
+        if (!rejected) {
+            last = frame;
+            continue;
+        }
+        if (writer.published() != published) return fail("oversized", "a rejected frame was counted as published", options, i);
+        // Neither the newest frame nor the slot a rejected frame would have taken may change
+        if (const char* failure = checkFrame(reader, reader.read(published - 1), published - 1, last)) return fail("oversized", failure, options, i);
+        if (published >= 4) {
+            const ShmRead oldest = reader.read(published - 4);
+            if (!oldest || !reader.valid(oldest.frame)) return fail("oversized", "a rejected frame disturbed the slot it would have used", options, i);
+        }
+    }
+
+    for (const ShmRingOptions bad : {ShmRingOptions{0, SLOT_SIZE}, ShmRingOptions{3, SLOT_SIZE}, ShmRingOptions{4, ProtocolHeader::ENCODED_SIZE - 1}}) {
+        try {
+            (void)ShmRingWriter::createAnonymous(bad);
+            return fail("oversized", "createAnonymous accepted unusable options", options, 0);
+        } catch (const std::invalid_argument&) {
+        }
+    }
+    return true;
+}
+#endif
+
+} // namespace
+
+int main(int argc, char** argv) {
+    Options options;
+    for (int i = 1; i < argc; i++) {
+        const std::string_view arg = argv[i];
+        if (arg == "--iterations" && i + 1 < argc) {
+            options.iterations = std::strtoull(argv[++i], nullptr, 10);
+        } else if (arg == "--seed" && i + 1 < argc) {
+            options.seed = std::strtoull(argv[++i], nullptr, 10);
+        } else {
+            std::fprintf(stderr, "usage: %s [--iterations N] [--seed S]\n", argv[0]);
+            return 2;
+        }
+    }
+
+    bool ok = runOrder(options);
+    ok = runOverrun(options) && ok;
+    ok = runValid(options) && ok;
+#if defined(__cpp_exceptions)
+    ok = runOversized(options) && ok;
+#endif
+    return ok ? 0 : 1;
+}
@@ -0,0 +1,487 @@
+/**
+ * Auto-generated transport test
+ *
+ *     test_transport [--iterations N] [--seed S]
+ *
+ * Drives Client against DeviceSimulator over socketpairs and TCP loopback:
+ * concurrent calls of every command answered out of order, frames queued in
+ * one iteration leaving in one write, timeouts and late responses, peers that
+ * disconnect with calls pending, and connections that close or are removed
+ * from inside their own callbacks.
+ */
+
+#include "transport.hpp"
+#include "test_codec.hpp"
+
+#if BINARY_PROTOCOL_HAS_EPOLL
+
+#include <algorithm>
+#include <array>
+#include <chrono>
+#include <cinttypes>
+#include <coroutine>
+#include <cstdio>
+#include <cstdlib>
+#include <deque>
+#include <memory>
+#include <optional>
+#include <string_view>
+#include <vector>
+
+#include <sys/socket.h>
+
+using namespace binaryprotocol;
+using namespace binaryprotocol::testing;
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+using std::chrono::milliseconds;
+
+/// Command of the tests that do not depend on the payload
+using Request = PingCommand;
+using Reply = ResponseOf<Request>::type;
+
+/// Longest a test waits for the loop before failing
+constexpr Clock::duration DEADLINE = std::chrono::seconds(10);
+
+/// Most calls spawned in one iteration
+constexpr size_t CONCURRENCY = 64;
+
+struct Options {
+    uint64_t iterations = 2000;
+    uint64_t seed = 1;
+};
+
+bool fail(const char* test, const char* check, const Options& options, uint64_t iteration) {
+    std::fprintf(stderr, "FAIL %s: %s (seed %" PRIu64 ", iteration %" PRIu64 ")\n", test, check, options.seed, iteration);
+    return false;
+}
+
+/// Connected AF_UNIX stream sockets; each end is handed to a Connection, which closes it
+struct SocketPair {
+    int client = -1;
+    int server = -1;
+};
+
+std::optional<SocketPair> socketPair() {
+    std::array<int, 2> fds;
+    if (::socketpair(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0, fds.data()) < 0) return std::nullopt;
+    return SocketPair{fds[0], fds[1]};
+}
+
+/// Keeps runOnce() from blocking for longer than a tick while a test waits on it
+class Heartbeat : private detail::Ticker {
+public:
+    explicit Heartbeat(EventLoop& loop) : loop_(loop) { loop_.addTicker(this); }
+    ~Heartbeat() { loop_.removeTicker(this); }
+
+    Heartbeat(const Heartbeat&) = delete;
+    Heartbeat& operator=(const Heartbeat&) = delete;
+
+private:
+    bool ticking() const override { return true; }
+    void onTick(Clock::time_point) override {}
+
+    EventLoop& loop_;
+};
+
+/// Runs the loop until done() holds; false if DEADLINE passes first
+template<typename Done>
+bool runUntil(EventLoop& loop, Done done) {
+    Heartbeat heartbeat(loop);
+    const Clock::time_point deadline = Clock::now() + DEADLINE;
+    while (!done()) {
+        if (Clock::now() > deadline) return false;
+        loop.runOnce();
+    }
+    return true;
+}
+
+void runIterations(EventLoop& loop, int count) {
+    Heartbeat heartbeat(loop);
+    for (int i = 0; i < count; i++) {
+        loop.runOnce();
+    }
+}
+
+/// Resumes the awaiting coroutine on the loop's next iteration
+struct NextIteration {
+    EventLoop& loop;
+
+    bool await_ready() const noexcept { return false; }
+    void await_suspend(std::coroutine_handle<> handle) { loop.schedule(handle); }
+    void await_resume() const noexcept {}
+};
+
+/// Handler body that answers after delay iterations
+template<typename Response>
+Task<Response> later(EventLoop& loop, Response response, uint64_t delay) {
+    for (; delay > 0; delay--) {
+        co_await NextIteration{loop};
+    }
+    co_return std::move(response);
+}
+
+template<typename Response>
+using Outcome = std::optional<CallResult<Response>>;
+
+/// Stores the result of one call; touches nothing but outcome once the call completes
+template<typename Command>
+Task<void> callInto(Client& client, Command command, Outcome<typename ResponseOf<Command>::type>* outcome,
+                    std::optional<Clock::duration> timeout = std::nullopt) {
+    outcome->emplace(co_await client.call(std::move(command), timeout));
+}
+
+template<typename Response>
+bool allDone(const std::vector<Outcome<Response>>& outcomes) {
+    return std::ranges::all_of(outcomes, [](const Outcome<Response>& outcome) { return outcome.has_value(); });
+}
+
+template<typename Response>
+bool allFailedWith(const std::vector<Outcome<Response>>& outcomes, CallError error) {
+    return std::ranges::all_of(outcomes, [error](const Outcome<Response>& outcome) {
+        return outcome && !*outcome && outcome->error() == error;
+    });
+}
+
+/// A random value whose frame a default FrameDecoder accepts
+template<typename T>
+T randomFitting(Random& rng) {
+    while (true) {
+        T value = CodecTraits<T>::random(rng);
+        if (encodedSize(value) <= FrameDecoder::DEFAULT_MAX_PAYLOAD) return value;
+    }
+}
+
+/// Peer that records the headers it receives and answers only when told to
+class RawPeer : public Connection {
+public:
+    using Connection::Connection;
+
+    std::vector<ProtocolHeader> received;
+    /// Closes the connection from inside the first onFrame()
+    bool closeOnFrame = false;
+
+protected:
+    void onFrame(const Frame& frame) override {
+        received.push_back(frame.header);
+        if (closeOnFrame) close();
+    }
+};
+
+/// Rounds of concurrent calls on one connection, answered after random delays so responses overtake each other
+template<typename Command>
+bool runConcurrent(const char* name, const Options& options) {
+    using Response = typename ResponseOf<Command>::type;
+    struct Step {
+        Command command;
+        Response response;
+        uint64_t delay;
+    };
+
+    Random rng(options.seed);
+    const std::optional<SocketPair> sockets = socketPair();
+    if (!sockets) return fail(name, "socketpair failed", options, 0);
+    EventLoop loop;
+    DeviceSimulator simulator(loop);
+    std::deque<Step> plan;
+    uint64_t wrongCommands = 0;
+    simulator.on<Command>([&loop, &plan, &wrongCommands](const Command& command) {
+        Step step = std::move(plan.front());
+        plan.pop_front();
+        if (!(command == step.command)) wrongCommands++;
+        return later(loop, std::move(step.response), step.delay);
+    });
+    simulator.serve(sockets->server);
+    Client client(loop, sockets->client);
+
+    std::vector<Response> expected;
+    std::vector<Outcome<Response>> outcomes;
+    uint64_t calls = 0;
+    for (uint64_t round = 0; calls < options.iterations; round++) {
+        const size_t count = 1 + rng.below(CONCURRENCY);
+        expected.clear();
+        outcomes.assign(count, std::nullopt);
+        for (size_t i = 0; i < count; i++) {
+            Command command = randomFitting<Command>(rng);
+            expected.push_back(randomFitting<Response>(rng));
+            plan.push_back({command, expected.back(), rng.below(8)});
+            spawn(callInto(client, std::move(command), &outcomes[i]));
+        }
+        if (client.inFlight() != count) return fail(name, "inFlight() != calls spawned", options, round);
+        if (!runUntil(loop, [&outcomes] { return allDone(outcomes); })) return fail(name, "calls did not complete", options, round);
+
+        for (size_t i = 0; i < count; i++) {
+            const CallResult<Response>& result = *outcomes[i];
+            if (!result) return fail(name, toString(result.error()), options, round);
+            if (!(*result == expected[i])) return fail(name, "response of another call", options, round);
+        }
+        if (wrongCommands != 0) return fail(name, "server decoded a different command", options, round);
+        if (!plan.empty()) return fail(name, "server did not handle every call", options, round);
+        calls += count;
+    }
+
+    const TransportStats stats = client.stats();
+    if (client.inFlight() != 0) return fail(name, "calls left in flight", options, 0);
+    if (stats.framesOut != calls || stats.framesIn != calls) return fail(name, "client frame counts", options, 0);
+    if (stats.writes > stats.framesOut) return fail(name, "more writes than frames", options, 0);
+    if (stats.corruptFrames != 0 || stats.droppedFrames != 0) return fail(name, "client dropped frames", options, 0);
+    if (client.correlation().matched != calls) return fail(name, "correlation().matched != calls", options, 0);
+    const TransportStats served = simulator.stats();
+    if (served.framesIn != calls || served.framesOut != calls) return fail(name, "server frame counts", options, 0);
+    if (served.corruptFrames != 0 || served.droppedFrames != 0) return fail(name, "server dropped frames", options, 0);
+    return true;
+}
+
+struct PairRun {
+    const char* name;
+    bool (*run)(const char* name, const Options& options);
+};
+
+constexpr PairRun PAIRS[] = {
+    {"PingCommand", runConcurrent<PingCommand>},
+    {"GetDeviceInfoCommand", runConcurrent<GetDeviceInfoCommand>},
+    {"SendDataCommand", runConcurrent<SendDataCommand>},
+    {"SetConfigCommand", runConcurrent<SetConfigCommand>},
+    {"BatchCommand", runConcurrent<BatchCommand>},
+};
+
+/// Frames queued in one iteration leave in one write, and the server answers them with one write
+bool runBatching(const Options& options) {
+    Random rng(options.seed);
+    const std::optional<SocketPair> sockets = socketPair();
+    if (!sockets) return fail("batching", "socketpair failed", options, 0);
+    EventLoop loop;
+    DeviceSimulator simulator(loop);
+    simulator.serve(sockets->server);
+    Client client(loop, sockets->client);
+
+    std::vector<Outcome<Reply>> outcomes;
+    for (uint64_t round = 0; round < std::max<uint64_t>(1, options.iterations / 100); round++) {
+        const size_t count = 2 + rng.below(CONCURRENCY);
+        const TransportStats sent = client.stats();
+        const TransportStats answered = simulator.stats();
+        outcomes.assign(count, std::nullopt);
+        for (size_t i = 0; i < count; i++) {
+            spawn(callInto(client, Request{}, &outcomes[i]));
+        }
+        if (!runUntil(loop, [&outcomes] { return allDone(outcomes); })) return fail("batching", "calls did not complete", options, round);
+
+        for (const Outcome<Reply>& outcome : outcomes) {
+            if (!*outcome) return fail("batching", toString(outcome->error()), options, round);
+            if (!(**outcome == Reply{})) return fail("batching", "DeviceSimulator answered a non-default response", options, round);
+        }
+        if (client.stats().framesOut - sent.framesOut != count) return fail("batching", "client frame count", options, round);
+        if (client.stats().writes - sent.writes != 1) return fail("batching", "client requests took more than one write", options, round);
+        if (simulator.stats().framesOut - answered.framesOut != count) return fail("batching", "server frame count", options, round);
+        if (simulator.stats().writes - answered.writes != 1) return fail("batching", "server responses took more than one write", options, round);
+    }
+    return true;
+}
+
+/// Several clients of one listening server; closing them removes their server connections
+bool runTcp(const Options& options) {
+    constexpr size_t CLIENTS = 4;
+    Random rng(options.seed);
+    EventLoop loop;
+    DeviceSimulator simulator(loop);
+    const int listenFd = listenTcp(0);
+    simulator.listen(listenFd);
+
+    std::vector<std::unique_ptr<Client>> clients;
+    for (size_t i = 0; i < CLIENTS; i++) {
+        clients.push_back(std::make_unique<Client>(loop, connectTcp("127.0.0.1", localPort(listenFd))));
+    }
+    std::vector<Outcome<Reply>> outcomes(CLIENTS * 8);
+    for (size_t i = 0; i < outcomes.size(); i++) {
+        spawn(callInto(*clients[rng.below(CLIENTS)], Request{}, &outcomes[i]));
+    }
+    if (!runUntil(loop, [&outcomes] { return allDone(outcomes); })) return fail("tcp", "calls did not complete", options, 0);
+    for (const Outcome<Reply>& outcome : outcomes) {
+        if (!*outcome) return fail("tcp", toString(outcome->error()), options, 0);
+    }
+    if (simulator.connections() != CLIENTS) return fail("tcp", "server did not accept every client", options, 0);
+
+    clients.clear();
+    if (!runUntil(loop, [&simulator] { return simulator.connections() == 0; })) {
+        return fail("tcp", "server kept closed connections", options, 0);
+    }
+    // Counters of removed connections are kept
+    if (simulator.stats().framesIn != outcomes.size()) return fail("tcp", "server lost the stats of closed connections", options, 0);
+    return true;
+}
+
+/// Calls time out after their own or the client's timeout, and responses arriving later are dropped
+bool runTimeout(const Options& options) {
+    const std::optional<SocketPair> sockets = socketPair();
+    if (!sockets) return fail("timeout", "socketpair failed", options, 0);
+    EventLoop loop;
+    RawPeer peer(loop, sockets->server);
+    ClientOptions clientOptions;
+    clientOptions.timeout = milliseconds(20);
+    Client client(loop, sockets->client, clientOptions);
+
+    Outcome<Reply> defaulted;
+    Outcome<Reply> shorter;
+    Outcome<Reply> answered;
+    const Clock::time_point start = Clock::now();
+    spawn(callInto(client, Request{}, &defaulted));
+    spawn(callInto(client, Request{}, &shorter, milliseconds(5)));
+    spawn(callInto(client, Request{}, &answered, std::chrono::seconds(5)));
+    if (!runUntil(loop, [&peer] { return peer.received.size() == 3; })) return fail("timeout", "requests not received", options, 0);
+    peer.send(peer.received[2], Reply{});
+
+    if (!runUntil(loop, [&defaulted] { return defaulted.has_value(); })) return fail("timeout", "call never timed out", options, 0);
+    // Deadlines count whole Correlator ticks (1 ms) from the tick the call started in
+    if (Clock::now() - start < clientOptions.timeout - milliseconds(1)) return fail("timeout", "call timed out before ClientOptions::timeout", options, 0);
+    if (!runUntil(loop, [&] { return shorter && answered; })) return fail("timeout", "calls did not complete", options, 0);
+    if (*defaulted || defaulted->error() != CallError::Timeout) return fail("timeout", "default timeout did not fail with Timeout", options, 0);
+    if (*shorter || shorter->error() != CallError::Timeout) return fail("timeout", "per-call timeout did not fail with Timeout", options, 0);
+    if (!*answered) return fail("timeout", "answered call failed", options, 0);
+    if (client.correlation().timedOut != 2) return fail("timeout", "correlation().timedOut != 2", options, 0);
+
+    peer.send(peer.received[0], Reply{});
+    peer.send(peer.received[1], Reply{});
+    if (!runUntil(loop, [&client] { return client.stats().framesIn == 3; })) return fail("timeout", "late responses not received", options, 0);
+    if (client.stats().droppedFrames != 2) return fail("timeout", "late responses were not dropped", options, 0);
+    if (client.inFlight() != 0) return fail("timeout", "calls left in flight", options, 0);
+    return true;
+}
+
+/// Pending calls fail with Disconnected when the peer closes or the client is destroyed
+bool runDisconnect(const Options& options) {
+    constexpr size_t CALLS = 8;
+    {
+        const std::optional<SocketPair> sockets = socketPair();
+        if (!sockets) return fail("disconnect", "socketpair failed", options, 0);
+        EventLoop loop;
+        RawPeer peer(loop, sockets->server);
+        Client client(loop, sockets->client);
+        std::vector<Outcome<Reply>> outcomes(CALLS);
+        for (Outcome<Reply>& outcome : outcomes) {
+            spawn(callInto(client, Request{}, &outcome));
+        }
+        if (!runUntil(loop, [&peer] { return peer.received.size() == CALLS; })) return fail("disconnect", "requests not received", options, 0);
+        peer.close();
+
+        if (!runUntil(loop, [&outcomes] { return allDone(outcomes); })) return fail("disconnect", "calls did not complete", options, 0);
+        if (!allFailedWith(outcomes, CallError::Disconnected)) return fail("disconnect", "peer close did not fail calls with Disconnected", options, 0);
+        if (!client.closed() || client.inFlight() != 0) return fail("disconnect", "client still open", options, 0);
+        const CallResult<Reply> after = loop.run(client.call(Request{}));
+        if (after || after.error() != CallError::Disconnected) return fail("disconnect", "call on a closed client did not fail", options, 0);
+    }
+    {
+        const std::optional<SocketPair> sockets = socketPair();
+        if (!sockets) return fail("disconnect", "socketpair failed", options, 1);
+        EventLoop loop;
+        RawPeer peer(loop, sockets->server);
+        auto client = std::make_unique<Client>(loop, sockets->client);
+        std::vector<Outcome<Reply>> outcomes(CALLS);
+        for (Outcome<Reply>& outcome : outcomes) {
+            spawn(callInto(*client, Request{}, &outcome));
+        }
+        if (!runUntil(loop, [&peer] { return peer.received.size() == CALLS; })) return fail("disconnect", "requests not received", options, 1);
+        client.reset();
+
+        if (!runUntil(loop, [&outcomes] { return allDone(outcomes); })) return fail("disconnect", "calls did not complete", options, 1);
+        if (!allFailedWith(outcomes, CallError::Disconnected)) return fail("disconnect", "~Client did not fail calls with Disconnected", options, 1);
+        if (!runUntil(loop, [&peer] { return peer.closed(); })) return fail("disconnect", "peer did not see the close", options, 1);
+    }
+    return true;
+}
+
+/// Connections closed or removed from inside their own callbacks, with handlers still running
+bool runLifecycle(const Options& options) {
+    // close() in onFrame() drops the rest of the frames from the same read
+    {
+        const std::optional<SocketPair> sockets = socketPair();
+        if (!sockets) return fail("lifecycle", "socketpair failed", options, 0);
+        EventLoop loop;
+        RawPeer peer(loop, sockets->server);
+        peer.closeOnFrame = true;
+        Client client(loop, sockets->client);
+        std::vector<Outcome<Reply>> outcomes(3);
+        for (Outcome<Reply>& outcome : outcomes) {
+            spawn(callInto(client, Request{}, &outcome));
+        }
+        if (!runUntil(loop, [&outcomes] { return allDone(outcomes); })) return fail("lifecycle", "calls did not complete", options, 0);
+        if (peer.received.size() != 1) return fail("lifecycle", "onFrame() ran after close()", options, 0);
+        if (!allFailedWith(outcomes, CallError::Disconnected)) return fail("lifecycle", "calls did not fail with Disconnected", options, 0);
+    }
+    // The client leaves while its handler runs: the server connection removes itself from its own onIo()
+    {
+        const std::optional<SocketPair> sockets = socketPair();
+        if (!sockets) return fail("lifecycle", "socketpair failed", options, 1);
+        EventLoop loop;
+        DeviceSimulator simulator(loop);
+        simulator.on<Request>([&loop](const Request&) { return later(loop, Reply{}, 4); });
+        simulator.serve(sockets->server);
+        auto client = std::make_unique<Client>(loop, sockets->client);
+        Outcome<Reply> outcome;
+        spawn(callInto(*client, Request{}, &outcome));
+        if (!runUntil(loop, [&simulator] { return simulator.stats().framesIn == 1; })) return fail("lifecycle", "request not received", options, 1);
+        client.reset();
+
+        if (!runUntil(loop, [&simulator] { return simulator.connections() == 0; })) return fail("lifecycle", "server kept a closed connection", options, 1);
+        runIterations(loop, 8);
+        if (!outcome || *outcome || outcome->error() != CallError::Disconnected) return fail("lifecycle", "call did not fail with Disconnected", options, 1);
+        if (simulator.stats().framesOut != 0) return fail("lifecycle", "response sent on a closed connection", options, 1);
+    }
+    // The server is destroyed while a handler runs; the handler finishes on a detached connection
+    {
+        const std::optional<SocketPair> sockets = socketPair();
+        if (!sockets) return fail("lifecycle", "socketpair failed", options, 2);
+        EventLoop loop;
+        auto simulator = std::make_unique<DeviceSimulator>(loop);
+        simulator->on<Request>([&loop](const Request&) { return later(loop, Reply{}, 4); });
+        simulator->serve(sockets->server);
+        Client client(loop, sockets->client);
+        Outcome<Reply> outcome;
+        spawn(callInto(client, Request{}, &outcome));
+        if (!runUntil(loop, [&simulator] { return simulator->stats().framesIn == 1; })) return fail("lifecycle", "request not received", options, 2);
+        simulator.reset();
+
+        if (!runUntil(loop, [&outcome] { return outcome.has_value(); })) return fail("lifecycle", "call did not complete", options, 2);
+        runIterations(loop, 8);
+        if (*outcome || outcome->error() != CallError::Disconnected) return fail("lifecycle", "call did not fail with Disconnected", options, 2);
+    }
+    return true;
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    Options options;
+    for (int i = 1; i < argc; i++) {
+        const std::string_view arg = argv[i];
+        if (arg == "--iterations" && i + 1 < argc) {
+            options.iterations = std::strtoull(argv[++i], nullptr, 10);
+        } else if (arg == "--seed" && i + 1 < argc) {
+            options.seed = std::strtoull(argv[++i], nullptr, 10);
+        } else {
+            std::fprintf(stderr, "usage: %s [--iterations N] [--seed S]\n", argv[0]);
+            return 2;
+        }
+    }
+
+    bool ok = true;
+    for (const PairRun& pair : PAIRS) {
+        ok = pair.run(pair.name, options) && ok;
+    }
+    ok = runBatching(options) && ok;
+    ok = runTcp(options) && ok;
+    ok = runTimeout(options) && ok;
+    ok = runDisconnect(options) && ok;
+    ok = runLifecycle(options) && ok;
+    return ok ? 0 : 1;
+}
+
+#else
+
+int main() {
+    // The transport needs epoll
+    return 0;
+}
+
+#endif // BINARY_PROTOCOL_HAS_EPOLL
@@ -0,0 +1,412 @@
+/**
+ * Auto-generated asynchronous transport implementation
+ */
+
+#include "transport.hpp"
+
+#if BINARY_PROTOCOL_HAS_EPOLL
+
+#include <algorithm>
+#include <cerrno>
+#include <system_error>
+
+#include <arpa/inet.h>
+#include <fcntl.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <sys/epoll.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+namespace binaryprotocol {
+
+namespace {
+
+constexpr size_t READ_CHUNK = 64 * 1024;
+
+[[noreturn]] void throwErrno(const char* what) {
+    BINARY_PROTOCOL_THROW(std::system_error(errno, std::generic_category(), what));
+}
+
+void setNonBlocking(int fd) {
+    const int flags = ::fcntl(fd, F_GETFL, 0);
+    if (flags < 0 || ::fcntl(fd, F_SETFL, flags | O_NONBLOCK) < 0) throwErrno("fcntl(O_NONBLOCK)");
+}
+
+} // namespace
+
+// ============================================
+// EventLoop
+// ============================================
+
+EventLoop::EventLoop(Clock::duration tick) : tick_(tick) {
+    epoll_ = ::epoll_create1(EPOLL_CLOEXEC);
+    if (epoll_ < 0) throwErrno("epoll_create1");
+}
+
+EventLoop::~EventLoop() {
+    ::close(epoll_);
+}
+
+void EventLoop::run() {
+    stopping_ = false;
+    while (!stopping_) {
+        iterate();
+    }
+}
+
+void EventLoop::iterate() {
+    // Only block when nothing is runnable or waiting to be written
+    int timeout = -1;
+    if (!ready_.empty() || !flushes_.empty() || stopping_) {
+        timeout = 0;
+    } else if (std::any_of(tickers_.begin(), tickers_.end(), [](const detail::Ticker* t) { return t->ticking(); })) {
+        timeout = static_cast<int>(std::max<int64_t>(1, std::chrono::ceil<std::chrono::milliseconds>(tick_).count()));
+    }
+
+    std::array<epoll_event, MAX_EVENTS> events;
+    const int count = ::epoll_wait(epoll_, events.data(), static_cast<int>(events.size()), timeout);
+    if (count < 0 && errno != EINTR) throwErrno("epoll_wait");
+
+    dispatchingCount_ = static_cast<size_t>(std::max(count, 0));
+    for (size_t i = 0; i < dispatchingCount_; i++) {
+        dispatching_[i] = static_cast<detail::IoHandler*>(events[i].data.ptr);
+        dispatchingEvents_[i] = events[i].events;
+    }
+    for (size_t i = 0; i < dispatchingCount_; i++) {
+        if (dispatching_[i]) dispatching_[i]->onIo(dispatchingEvents_[i]);
+    }
+    dispatchingCount_ = 0;
+
+    const Clock::time_point now = Clock::now();
+    for (size_t i = 0; i < tickers_.size(); i++) {
+        if (tickers_[i]->ticking()) tickers_[i]->onTick(now);
+    }
+
+    // Coroutines scheduled while these run wait for the next iteration
+    running_.swap(ready_);
+    for (std::coroutine_handle<> handle : running_) {
+        handle.resume();
+    }
+    running_.clear();
+
+    // One write per connection for everything queued in this iteration
+    for (size_t i = 0; i < flushes_.size(); i++) {
+        if (flushes_[i]) flushes_[i]->flush();
+    }
+    flushes_.clear();
+    released_.clear();
+}
+
+void EventLoop::watch(int fd, uint32_t events, detail::IoHandler* handler) {
+    epoll_event event{};
+    event.events = events;
+    event.data.ptr = handler;
+    if (::epoll_ctl(epoll_, EPOLL_CTL_ADD, fd, &event) < 0) throwErrno("epoll_ctl(ADD)");
+}
+
+void EventLoop::modify(int fd, uint32_t events, detail::IoHandler* handler) {
+    epoll_event event{};
+    event.events = events;
+    event.data.ptr = handler;
+    if (::epoll_ctl(epoll_, EPOLL_CTL_MOD, fd, &event) < 0) throwErrno("epoll_ctl(MOD)");
+}
+
+void EventLoop::unwatch(int fd, detail::IoHandler* handler) {
+    ::epoll_ctl(epoll_, EPOLL_CTL_DEL, fd, nullptr);
+    // Events already returned for this handler must not reach it
+    for (size_t i = 0; i < dispatchingCount_; i++) {
+        if (dispatching_[i] == handler) dispatching_[i] = nullptr;
+    }
+}
+
+void EventLoop::addTicker(detail::Ticker* ticker) {
+    tickers_.push_back(ticker);
+}
+
+void EventLoop::removeTicker(detail::Ticker* ticker) {
+    tickers_.erase(std::remove(tickers_.begin(), tickers_.end(), ticker), tickers_.end());
+}
+
+void EventLoop::cancelFlush(detail::Flusher* flusher) {
+    std::replace(flushes_.begin(), flushes_.end(), flusher, static_cast<detail::Flusher*>(nullptr));
+}
+
+// ============================================
+// Connection
+// ============================================
+
+Connection::Connection(EventLoop& loop, int fd, size_t maxPayload)
+    : loop_(loop), fd_(fd), decoder_(maxPayload), readBuffer_(READ_CHUNK) {
+    setNonBlocking(fd_);
+    loop_.watch(fd_, EPOLLIN | EPOLLRDHUP, this);
+}
+
+Connection::~Connection() {
+    if (fd_ >= 0) {
+        loop_.unwatch(fd_, this);
+        ::close(fd_);
+    }
+    loop_.cancelFlush(this);
+}
+
+void Connection::close() {
+    if (fd_ < 0) return;
+    loop_.unwatch(fd_, this);
+    ::close(fd_);
+    fd_ = -1;
+    outbox_.clear();
+    written_ = 0;
+    onClosed();
+}
+
+void Connection::requestFlush() {
+    if (flushRequested_ || waitingWritable_) return;
+    flushRequested_ = true;
+    loop_.requestFlush(this);
+}
+
+void Connection::flush() {
+    flushRequested_ = false;
+    while (fd_ >= 0 && written_ < outbox_.size()) {
+        const ssize_t sent = ::send(fd_, outbox_.data() + written_, outbox_.size() - written_, MSG_NOSIGNAL);
+        if (sent < 0) {
+            if (errno == EINTR) continue;
+            if (errno == EAGAIN || errno == EWOULDBLOCK) {
+                // Finish once the socket drains; frames queued meanwhile join this write
+                if (!waitingWritable_) {
+                    waitingWritable_ = true;
+                    loop_.modify(fd_, EPOLLIN | EPOLLRDHUP | EPOLLOUT, this);
+                }
+                return;
+            }
+            close();
+            return;
+        }
+        stats_.writes++;
+        written_ += static_cast<size_t>(sent);
+    }
+    outbox_.clear();
+    written_ = 0;
+    if (waitingWritable_ && fd_ >= 0) {
+        waitingWritable_ = false;
+        loop_.modify(fd_, EPOLLIN | EPOLLRDHUP, this);
+    }
+}
+
+void Connection::onIo(uint32_t events) {
+    if (events & EPOLLOUT) {
+        flush();
+    }
+    if (!(events & (EPOLLIN | EPOLLRDHUP | EPOLLHUP | EPOLLERR))) return;
+
+    while (fd_ >= 0) {
+        const ssize_t received = ::recv(fd_, readBuffer_.data(), readBuffer_.size(), 0);
+        if (received < 0) {
+            if (errno == EINTR) continue;
+            if (errno != EAGAIN && errno != EWOULDBLOCK) close();
+            return;
+        }
+        if (received == 0) {
+            close();
+            return;
+        }
+        decoder_.feed({readBuffer_.data(), static_cast<size_t>(received)}, [this](const Frame& frame) {
+            if (fd_ < 0) return;
+            stats_.framesIn++;
+            if (!verifyFrame(frame.bytes)) {
+                stats_.corruptFrames++;
+                return;
+            }
+            onFrame(frame);
+        });
+        if (static_cast<size_t>(received) < readBuffer_.size()) return;
+    }
+}
+
+// ============================================
+// Client
+// ============================================
+
+Client::Client(EventLoop& loop, int fd, ClientOptions options)
+    : Connection(loop, fd, options.maxPayload), options_(options), pending_(options.maxInFlight) {
+    loop.addTicker(this);
+}
+
+Client::~Client() {
+    loop().removeTicker(this);
+    onClosed();
+}
+
+SequenceId Client::nextSequence() {
+    // Skip IDs still in flight after a wrap-around
+    do {
+        sequence_++;
+    } while (pending_.contains(sequence_));
+    return sequence_;
+}
+
+void Client::complete(detail::PendingCallBase* call, std::optional<CallError> error) {
+    if (error) call->error = error;
+    call->done = true;
+    if (call->handle) loop().schedule(call->handle);
+}
+
+void Client::onFrame(const Frame& frame) {
+    std::optional<detail::PendingCallBase*> call = pending_.match(frame.header);
+    if (!call) {
+        stats_.droppedFrames++;
+        return;
+    }
+    (*call)->deliver(**call, frame.payload);
+    complete(*call, std::nullopt);
+}
+
+void Client::onTick(std::chrono::steady_clock::time_point now) {
+    pending_.expire(now, [this](ExpiredRequest<detail::PendingCallBase*>&& request) {
+        complete(request.context, CallError::Timeout);
+    });
+}
+
+void Client::onClosed() {
+    pending_.cancelAll([this](SequenceId, uint8_t, detail::PendingCallBase* call) {
+        complete(call, CallError::Disconnected);
+    });
+}
+
+// ============================================
+// Server
+// ============================================
+
+Server::Server(EventLoop& loop, size_t maxPayload)
+    : loop_(loop), maxPayload_(maxPayload) {}
+
+Server::~Server() {
+    if (listenFd_ >= 0) {
+        loop_.unwatch(listenFd_, this);
+        ::close(listenFd_);
+    }
+    // Handlers still running keep their connection alive but can no longer reach the server
+    for (const std::shared_ptr<ServerConnection>& connection : connections_) {
+        connection->detach();
+        connection->close();
+    }
+}
+
+void Server::serve(int fd) {
+    connections_.push_back(std::make_shared<ServerConnection>(*this, fd));
+}
+
+void Server::listen(int listenFd) {
+    setNonBlocking(listenFd);
+    listenFd_ = listenFd;
+    loop_.watch(listenFd_, EPOLLIN, this);
+}
+
+void Server::onIo(uint32_t) {
+    while (true) {
+        const int fd = ::accept4(listenFd_, nullptr, nullptr, SOCK_CLOEXEC);
+        if (fd < 0) {
+            if (errno == EINTR || errno == ECONNABORTED) continue;
+            return;
+        }
+        const int noDelay = 1;
+        ::setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &noDelay, sizeof(noDelay));
+        serve(fd);
+    }
+}
+
+void Server::route(const std::shared_ptr<ServerConnection>& connection, const Frame& frame) {
+    const Route& route = routes_[frame.header.command_id];
+    if (!route) {
+        connection->countDropped();
+        return;
+    }
+    route(connection, frame.header, frame.payload);
+}
+
+void Server::remove(ServerConnection* connection) {
+    const auto it = std::find_if(connections_.begin(), connections_.end(),
+        [connection](const std::shared_ptr<ServerConnection>& c) { return c.get() == connection; });
+    if (it == connections_.end()) return;
+
+    const TransportStats& stats = connection->stats();
+    closedStats_.framesIn += stats.framesIn;
+    closedStats_.framesOut += stats.framesOut;
+    closedStats_.writes += stats.writes;
+    closedStats_.corruptFrames += stats.corruptFrames;
+    closedStats_.droppedFrames += stats.droppedFrames;
+
+    // Called from the connection's own onIo(), so it is destroyed after this iteration
+    loop_.release(std::move(*it));
+    *it = std::move(connections_.back());
+    connections_.pop_back();
+}
+
+TransportStats Server::stats() const {
+    TransportStats total = closedStats_;
+    for (const std::shared_ptr<ServerConnection>& connection : connections_) {
+        const TransportStats& stats = connection->stats();
+        total.framesIn += stats.framesIn;
+        total.framesOut += stats.framesOut;
+        total.writes += stats.writes;
+        total.corruptFrames += stats.corruptFrames;
+        total.droppedFrames += stats.droppedFrames;
+    }
+    return total;
+}
+
+// ============================================
+// Sockets
+// ============================================
+
+int listenTcp(uint16_t port, const char* address) {
+    sockaddr_in addr{};
+    addr.sin_family = AF_INET;
+    addr.sin_port = htons(port);
+    if (::inet_pton(AF_INET, address, &addr.sin_addr) != 1) {
+        BINARY_PROTOCOL_THROW(std::invalid_argument("Invalid IPv4 address"));
+    }
+    const int fd = ::socket(AF_INET, SOCK_STREAM | SOCK_CLOEXEC, 0);
+    if (fd < 0) throwErrno("socket");
+    const int reuse = 1;
+    ::setsockopt(fd, SOL_SOCKET, SO_REUSEADDR, &reuse, sizeof(reuse));
+    if (::bind(fd, reinterpret_cast<const sockaddr*>(&addr), sizeof(addr)) < 0 || ::listen(fd, SOMAXCONN) < 0) {
+        const int error = errno;
+        ::close(fd);
+        errno = error;
+        throwErrno("bind/listen");
+    }
+    return fd;
+}
+
+int connectTcp(const char* address, uint16_t port) {
+    sockaddr_in addr{};
+    addr.sin_family = AF_INET;
+    addr.sin_port = htons(port);
+    if (::inet_pton(AF_INET, address, &addr.sin_addr) != 1) {
+        BINARY_PROTOCOL_THROW(std::invalid_argument("Invalid IPv4 address"));
+    }
+    const int fd = ::socket(AF_INET, SOCK_STREAM | SOCK_CLOEXEC, 0);
+    if (fd < 0) throwErrno("socket");
+    if (::connect(fd, reinterpret_cast<const sockaddr*>(&addr), sizeof(addr)) < 0) {
+        const int error = errno;
+        ::close(fd);
+        errno = error;
+        throwErrno("connect");
+    }
+    const int noDelay = 1;
+    ::setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &noDelay, sizeof(noDelay));
+    return fd;
+}
+
+uint16_t localPort(int fd) {
+    sockaddr_in addr{};
+    socklen_t length = sizeof(addr);
+    if (::getsockname(fd, reinterpret_cast<sockaddr*>(&addr), &length) < 0) throwErrno("getsockname");
+    return ntohs(addr.sin_port);
+}
+
+} // namespace binaryprotocol
+
+#endif // BINARY_PROTOCOL_HAS_EPOLL
\ No newline at end of file
@@ -0,0 +1,694 @@
+/**
+ * Auto-generated asynchronous transport (C++20 coroutines over epoll, Linux only)
+ *
+ *     EventLoop loop;
+ *     Client client(loop, connectTcp("127.0.0.1", port));
+ *     CallResult<PingResponse> pong = loop.run(client.call(PingCommand{...}));
+ *
+ * Inside a coroutine: auto pong = co_await client.call(PingCommand{...});
+ */
+
+#ifndef BINARY_PROTOCOL_TRANSPORT_HPP
+#define BINARY_PROTOCOL_TRANSPORT_HPP
+
+#include "protocol.hpp"
+#include "correlation.hpp"
+#include "frame_decoder.hpp"
+
+#if __has_include(<sys/epoll.h>)
+#define BINARY_PROTOCOL_HAS_EPOLL 1
+#else
+#define BINARY_PROTOCOL_HAS_EPOLL 0
+#endif
+
+#if BINARY_PROTOCOL_HAS_EPOLL
+
+#include <array>
+#include <chrono>
+#include <coroutine>
+#include <cstdint>
+#include <exception>
+#include <functional>
+#include <memory>
+#include <optional>
+#include <span>
+#include <type_traits>
+#include <utility>
+#include <variant>
+#include <vector>
+
+namespace binaryprotocol {
+
+// ============================================
+// Coroutines
+// ============================================
+
+template<typename T = void>
+class Task;
+
+namespace detail {
+
+struct TaskPromiseBase {
+    std::coroutine_handle<> continuation;
+#if BINARY_PROTOCOL_EXCEPTIONS
+    std::exception_ptr exception;
+#endif
+
+    std::suspend_always initial_suspend() noexcept { return {}; }
+
+    /// Resumes whoever awaited the task
+    struct FinalAwaiter {
+        bool await_ready() noexcept { return false; }
+        template<typename Promise>
+        std::coroutine_handle<> await_suspend(std::coroutine_handle<Promise> handle) noexcept {
+            std::coroutine_handle<> continuation = handle.promise().continuation;
+            return continuation ? continuation : std::noop_coroutine();
+        }
+        void await_resume() noexcept {}
+    };
+
+    FinalAwaiter final_suspend() noexcept { return {}; }
+
+    void unhandled_exception() {
+#if BINARY_PROTOCOL_EXCEPTIONS
+        exception = std::current_exception();
+#else
+        std::terminate();
+#endif
+    }
+
+    void rethrow() {
+#if BINARY_PROTOCOL_EXCEPTIONS
+        if (exception) std::rethrow_exception(exception);
+#endif
+    }
+};
+
+template<typename T>
+struct TaskPromise : TaskPromiseBase {
+    std::optional<T> value;
+
+    Task<T> get_return_object();
+    template<typename U>
+    void return_value(U&& result) { value.emplace(std::forward<U>(result)); }
+    T take() {
+        rethrow();
+        return std::move(*value);
+    }
+};
+
+template<>
+struct TaskPromise<void> : TaskPromiseBase {
+    Task<void> get_return_object();
+    void return_void() {}
+    void take() { rethrow(); }
+};
+
+} // namespace detail
+
+/**
+ * Lazily started coroutine; it runs when awaited and resumes the awaiter when done.
+ * Coroutine parameters are copied into the frame, so pass arguments by value.
+ */
+template<typename T>
+class [[nodiscard]] Task {
+public:
+    using promise_type = detail::TaskPromise<T>;
+
+    Task(Task&& other) noexcept : handle_(std::exchange(other.handle_, {})) {}
+    Task& operator=(Task other) noexcept {
+        std::swap(handle_, other.handle_);
+        return *this;
+    }
+    ~Task() {
+        if (handle_) handle_.destroy();
+    }
+
+    bool await_ready() const noexcept { return false; }
+    std::coroutine_handle<> await_suspend(std::coroutine_handle<> awaiter) noexcept {
+        handle_.promise().continuation = awaiter;
+        return handle_;
+    }
+    T await_resume() { return handle_.promise().take(); }
+
+private:
+    friend promise_type;
+    explicit Task(std::coroutine_handle<promise_type> handle) : handle_(handle) {}
+
+    std::coroutine_handle<promise_type> handle_;
+};
+
+namespace detail {
+
+template<typename T>
+Task<T> TaskPromise<T>::get_return_object() {
+    return Task<T>(std::coroutine_handle<TaskPromise<T>>::from_promise(*this));
+}
+
+inline Task<void> TaskPromise<void>::get_return_object() {
+    return Task<void>(std::coroutine_handle<TaskPromise<void>>::from_promise(*this));
+}
+
+/// Eagerly started, self-destroying coroutine behind spawn()
+struct DetachedTask {
+    struct promise_type {
+        DetachedTask get_return_object() noexcept { return {}; }
+        std::suspend_never initial_suspend() noexcept { return {}; }
+        std::suspend_never final_suspend() noexcept { return {}; }
+        void return_void() noexcept {}
+        void unhandled_exception() noexcept { std::terminate(); }
+    };
+};
+
+inline DetachedTask runDetached(Task<void> task) {
+    co_await std::move(task);
+}
+
+} // namespace detail
+
+/// Starts task now without awaiting it; an exception escaping it terminates
+inline void spawn(Task<void> task) {
+    detail::runDetached(std::move(task));
+}
+
+// ============================================
+// Event loop
+// ============================================
+
+class EventLoop;
+
+namespace detail {
+
+/// A file descriptor registered with an EventLoop
+class IoHandler {
+public:
+    virtual void onIo(uint32_t events) = 0;
+
+protected:
+    ~IoHandler() = default;
+};
+
+/// Called every loop iteration while ticking() is true, and at least once per tick
+class Ticker {
+public:
+    virtual bool ticking() const = 0;
+    virtual void onTick(std::chrono::steady_clock::time_point now) = 0;
+
+protected:
+    ~Ticker() = default;
+};
+
+/// Deferred write of a connection, run once per loop iteration
+class Flusher {
+public:
+    virtual void flush() = 0;
+
+protected:
+    ~Flusher() = default;
+};
+
+} // namespace detail
+
+/**
+ * Single-threaded epoll loop. Each iteration waits for I/O (no longer than a
+ * tick while a Ticker is active), runs the tickers, resumes scheduled
+ * coroutines and then flushes every connection that queued frames during the
+ * iteration with one write each.
+ */
+class EventLoop {
+public:
+    using Clock = std::chrono::steady_clock;
+
+    explicit EventLoop(Clock::duration tick = std::chrono::milliseconds(1));
+    ~EventLoop();
+
+    EventLoop(const EventLoop&) = delete;
+    EventLoop& operator=(const EventLoop&) = delete;
+
+    /// Runs until stop()
+    void run();
+
+    /// Runs until task completes and returns its result
+    template<typename T>
+    T run(Task<T> task);
+
+    /// Runs a single iteration, blocking until there is work
+    void runOnce() { iterate(); }
+
+    void stop() { stopping_ = true; }
+
+    /// Resumes handle on the next iteration
+    void schedule(std::coroutine_handle<> handle) { ready_.push_back(handle); }
+
+    /// Keeps object alive until the current iteration ends (for handlers that close themselves)
+    void release(std::shared_ptr<void> object) { released_.push_back(std::move(object)); }
+
+    void watch(int fd, uint32_t events, detail::IoHandler* handler);
+    void modify(int fd, uint32_t events, detail::IoHandler* handler);
+    void unwatch(int fd, detail::IoHandler* handler);
+
+    void addTicker(detail::Ticker* ticker);
+    void removeTicker(detail::Ticker* ticker);
+
+    void requestFlush(detail::Flusher* flusher) { flushes_.push_back(flusher); }
+    void cancelFlush(detail::Flusher* flusher);
+
+private:
+    void iterate();
+
+    static constexpr size_t MAX_EVENTS = 64;
+
+    int epoll_ = -1;
+    Clock::duration tick_;
+    bool stopping_ = false;
+    std::vector<std::coroutine_handle<>> ready_;
+    std::vector<std::coroutine_handle<>> running_;
+    std::vector<detail::Flusher*> flushes_;
+    std::vector<detail::Ticker*> tickers_;
+    std::vector<std::shared_ptr<void>> released_;
+    /// Handlers of the batch being dispatched, cleared by unwatch()
+    std::array<detail::IoHandler*, MAX_EVENTS> dispatching_{};
+    std::array<uint32_t, MAX_EVENTS> dispatchingEvents_{};
+    size_t dispatchingCount_ = 0;
+};
+
+namespace detail {
+
+template<typename T>
+struct RunState {
+    std::optional<std::conditional_t<std::is_void_v<T>, std::monostate, T>> result;
+#if BINARY_PROTOCOL_EXCEPTIONS
+    std::exception_ptr exception;
+#endif
+    bool done = false;
+};
+
+/// Owns the state so a task abandoned by stop() can still finish safely
+template<typename T>
+Task<void> runInto(std::shared_ptr<RunState<T>> state, Task<T> task) {
+#if BINARY_PROTOCOL_EXCEPTIONS
+    try {
+#endif
+        if constexpr (std::is_void_v<T>) {
+            co_await std::move(task);
+            state->result.emplace();
+        } else {
+            state->result.emplace(co_await std::move(task));
+        }
+#if BINARY_PROTOCOL_EXCEPTIONS
+    } catch (...) {
+        state->exception = std::current_exception();
+    }
+#endif
+    state->done = true;
+}
+
+} // namespace detail
+
+template<typename T>
+T EventLoop::run(Task<T> task) {
+    auto state = std::make_shared<detail::RunState<T>>();
+    spawn(detail::runInto(state, std::move(task)));
+    stopping_ = false;
+    while (!state->done && !stopping_) {
+        iterate();
+    }
+#if BINARY_PROTOCOL_EXCEPTIONS
+    if (state->exception) std::rethrow_exception(state->exception);
+#endif
+    if (!state->done) BINARY_PROTOCOL_THROW(std::runtime_error("EventLoop stopped before the task completed"));
+    if constexpr (!std::is_void_v<T>) return std::move(*state->result);
+}
+
+// ============================================
+// Connections
+// ============================================
+
+struct TransportStats {
+    uint64_t framesIn = 0;
+    uint64_t framesOut = 0;
+    /// send() calls; fewer than framesOut when frames were batched
+    uint64_t writes = 0;
+    /// Frames dropped because their checksum did not verify
+    uint64_t corruptFrames = 0;
+    /// Frames that could not be decoded, or had no route or pending call
+    uint64_t droppedFrames = 0;
+};
+
+/**
+ * Non-blocking socket carrying ProtocolHeader-framed messages. Outgoing frames are
+ * appended to one buffer and written once per loop iteration; incoming bytes
+ * are reassembled by a FrameDecoder and handed to onFrame().
+ */
+class Connection : private detail::IoHandler, private detail::Flusher {
+public:
+    /// Takes ownership of a connected socket and makes it non-blocking
+    Connection(EventLoop& loop, int fd, size_t maxPayload = FrameDecoder::DEFAULT_MAX_PAYLOAD);
+    virtual ~Connection();
+
+    Connection(const Connection&) = delete;
+    Connection& operator=(const Connection&) = delete;
+
+    /// Queues a frame; magic, command_id, payload_length and checksum are filled in
+    template<typename T>
+    void send(ProtocolHeader header, const T& message);
+
+    void close();
+    bool closed() const { return fd_ < 0; }
+    int fd() const { return fd_; }
+    EventLoop& loop() { return loop_; }
+    const TransportStats& stats() const { return stats_; }
+
+protected:
+    virtual void onFrame(const Frame& frame) = 0;
+    virtual void onClosed() {}
+
+    TransportStats stats_;
+
+private:
+    void onIo(uint32_t events) override;
+    void flush() override;
+    void requestFlush();
+
+    EventLoop& loop_;
+    int fd_;
+    FrameDecoder decoder_;
+    std::vector<uint8_t> readBuffer_;
+    std::vector<uint8_t> outbox_;
+    size_t written_ = 0;
+    bool flushRequested_ = false;
+    bool waitingWritable_ = false;
+};
+
+template<typename T>
+void Connection::send(ProtocolHeader header, const T& message) {
+    if (closed()) return;
+    checkLengthPrefixes(message);
+    const size_t payloadSize = encodedSize(message);
+    const size_t start = outbox_.size();
+    outbox_.resize(start + ProtocolHeader::ENCODED_SIZE + payloadSize);
+    const std::span<uint8_t> frame(outbox_.data() + start, ProtocolHeader::ENCODED_SIZE + payloadSize);
+
+    header.magic = ProtocolHeader::MAGIC;
+    header.command_id = MessageTraits<T>::COMMAND_ID;
+    header.payload_length = static_cast<decltype(header.payload_length)>(payloadSize);
+    serializeInto(header, frame.first(ProtocolHeader::ENCODED_SIZE));
+    serializeInto(message, frame.subspan(ProtocolHeader::ENCODED_SIZE));
+    sealFrame(frame);
+    stats_.framesOut++;
+    requestFlush();
+}
+
+// ============================================
+// Client
+// ============================================
+
+enum class CallError : uint8_t {
+    /// No response within the call's timeout
+    Timeout,
+    /// The connection closed before the response arrived
+    Disconnected,
+    /// The response payload did not decode
+    BadResponse,
+    /// ClientOptions::maxInFlight calls are already pending
+    TooManyInFlight,
+};
+
+constexpr const char* toString(CallError error) {
+    switch (error) {
+    case CallError::Timeout: return "Call timed out";
+    case CallError::Disconnected: return "Connection closed";
+    case CallError::BadResponse: return "Malformed response";
+    case CallError::TooManyInFlight: return "Too many calls in flight";
+    }
+    return "Unknown call error";
+}
+
+/// Response or CallError, with the same interface as DecodeResult
+template<typename T>
+class CallResult {
+public:
+    CallResult(T value) : storage_(std::in_place_index<0>, std::move(value)) {}
+    CallResult(CallError error) : storage_(std::in_place_index<1>, error) {}
+
+    bool has_value() const noexcept { return storage_.index() == 0; }
+    explicit operator bool() const noexcept { return has_value(); }
+
+    /// Checked access; throws (or aborts without exceptions) on an error
+    T& value() & { check(); return *std::get_if<0>(&storage_); }
+    const T& value() const& { check(); return *std::get_if<0>(&storage_); }
+    T&& value() && { check(); return std::move(*std::get_if<0>(&storage_)); }
+
+    T& operator*() & noexcept { return *std::get_if<0>(&storage_); }
+    const T& operator*() const& noexcept { return *std::get_if<0>(&storage_); }
+    T* operator->() noexcept { return std::get_if<0>(&storage_); }
+    const T* operator->() const noexcept { return std::get_if<0>(&storage_); }
+
+    CallError error() const noexcept { return *std::get_if<1>(&storage_); }
+
+private:
+    void check() const {
+        if (!has_value()) BINARY_PROTOCOL_THROW(std::runtime_error(toString(error())));
+    }
+
+    std::variant<T, CallError> storage_;
+};
+
+struct ClientOptions {
+    /// Most calls pending at once
+    size_t maxInFlight = 65536;
+    /// Timeout of calls that do not pass their own
+    std::chrono::steady_clock::duration timeout = std::chrono::seconds(5);
+    size_t maxPayload = FrameDecoder::DEFAULT_MAX_PAYLOAD;
+    /// ProtocolHeader::version of every request
+    uint8_t version = 1;
+};
+
+namespace detail {
+
+/// A suspended call; the response is decoded straight from the receive buffer
+struct PendingCallBase {
+    std::coroutine_handle<> handle;
+    bool done = false;
+    std::optional<CallError> error;
+    void (*deliver)(PendingCallBase&, std::span<const uint8_t>) = nullptr;
+
+    PendingCallBase() = default;
+    PendingCallBase(const PendingCallBase&) = delete;
+    PendingCallBase& operator=(const PendingCallBase&) = delete;
+
+    struct Awaiter {
+        PendingCallBase& call;
+
+        bool await_ready() const noexcept { return call.done; }
+        void await_suspend(std::coroutine_handle<> awaiter) noexcept { call.handle = awaiter; }
+        void await_resume() const noexcept {}
+    };
+
+    /// Suspends until the Client completes this call
+    Awaiter wait() noexcept { return {*this}; }
+};
+
+template<typename Response>
+struct PendingCall : PendingCallBase {
+    std::optional<Response> response;
+
+    PendingCall() {
+        deliver = [](PendingCallBase& base, std::span<const uint8_t> payload) {
+            PendingCall& self = static_cast<PendingCall&>(base);
+            DecodeResult<Response> decoded = MessageTraits<Response>::tryDecode(payload.data(), payload.size());
+            if (decoded) {
+                self.response.emplace(std::move(*decoded));
+            } else {
+                self.error = CallError::BadResponse;
+            }
+        };
+    }
+};
+
+} // namespace detail
+
+/**
+ * Client side of a connection. Any number of call()s may be outstanding;
+ * responses are matched by sequence_id in any order. The client must outlive
+ * its calls' coroutines only until they are resumed: destroying it fails the
+ * pending ones with CallError::Disconnected.
+ */
+class Client : public Connection, private detail::Ticker {
+public:
+    Client(EventLoop& loop, int fd, ClientOptions options = {});
+    ~Client() override;
+
+    /// Sends command and completes with its response
+    template<typename Command>
+    Task<CallResult<typename ResponseOf<Command>::type>> call(Command command, std::optional<std::chrono::steady_clock::duration> timeout = std::nullopt);
+
+    size_t inFlight() const { return pending_.size(); }
+    const CorrelatorStats& correlation() const { return pending_.stats(); }
+
+protected:
+    void onFrame(const Frame& frame) override;
+    void onClosed() override;
+
+private:
+    bool ticking() const override { return pending_.size() > 0; }
+    void onTick(std::chrono::steady_clock::time_point now) override;
+    SequenceId nextSequence();
+    void complete(detail::PendingCallBase* call, std::optional<CallError> error);
+
+    ClientOptions options_;
+    Correlator<detail::PendingCallBase*> pending_;
+    SequenceId sequence_ = 0;
+};
+
+template<typename Command>
+Task<CallResult<typename ResponseOf<Command>::type>> Client::call(Command command, std::optional<std::chrono::steady_clock::duration> timeout) {
+    using Response = typename ResponseOf<Command>::type;
+    if (closed()) co_return CallError::Disconnected;
+
+    detail::PendingCall<Response> pending;
+    ProtocolHeader header{};
+    header.version = options_.version;
+    header.command_id = Command::COMMAND_ID;
+    header.sequence_id = nextSequence();
+    if (pending_.track(header, timeout.value_or(options_.timeout), &pending) != TrackResult::Tracked) {
+        co_return CallError::TooManyInFlight;
+    }
+    send(header, command);
+
+    // Resumed by onFrame(), onTick() or onClosed(); this frame must not touch the client afterwards
+    co_await pending.wait();
+    if (pending.error) co_return *pending.error;
+    co_return std::move(*pending.response);
+}
+
+// ============================================
+// Server
+// ============================================
+
+/**
+ * Serves connections by routing each command to the handler registered for
+ * its COMMAND_ID. Handlers take the command and return its response, either
+ * directly or as a Task; the response goes back with the request's
+ * sequence_id. Handlers of one connection run concurrently when they suspend.
+ */
+class Server : private detail::IoHandler {
+public:
+    explicit Server(EventLoop& loop, size_t maxPayload = FrameDecoder::DEFAULT_MAX_PAYLOAD);
+    ~Server();
+
+    Server(const Server&) = delete;
+    Server& operator=(const Server&) = delete;
+
+    /// Registers handler(const Command&) -> Response or Task<Response>, replacing any previous one
+    template<typename Command, typename Handler>
+    void on(Handler handler);
+
+    /// Serves an already connected socket (accepted TCP connection, socketpair end)
+    void serve(int fd);
+
+    /// Accepts and serves connections from a listening socket until the server is destroyed
+    void listen(int listenFd);
+
+    size_t connections() const { return connections_.size(); }
+    /// Totals over all current and closed connections
+    TransportStats stats() const;
+
+private:
+    class ServerConnection;
+    using Route = std::function<void(const std::shared_ptr<ServerConnection>&, const ProtocolHeader&, std::span<const uint8_t>)>;
+
+    template<typename Command, typename Handler>
+    static Task<void> respond(std::shared_ptr<ServerConnection> connection, ProtocolHeader header, Command command, std::shared_ptr<Handler> handler);
+
+    void onIo(uint32_t events) override;
+    void route(const std::shared_ptr<ServerConnection>& connection, const Frame& frame);
+    void remove(ServerConnection* connection);
+
+    EventLoop& loop_;
+    size_t maxPayload_;
+    int listenFd_ = -1;
+    std::array<Route, 256> routes_;
+    std::vector<std::shared_ptr<ServerConnection>> connections_;
+    TransportStats closedStats_;
+};
+
+class Server::ServerConnection : public Connection, public std::enable_shared_from_this<ServerConnection> {
+public:
+    ServerConnection(Server& server, int fd)
+        : Connection(server.loop_, fd, server.maxPayload_), server_(&server) {}
+
+    void detach() { server_ = nullptr; }
+    void countDropped() { stats_.droppedFrames++; }
+
+protected:
+    void onFrame(const Frame& frame) override {
+        if (server_) server_->route(shared_from_this(), frame);
+    }
+    void onClosed() override {
+        if (server_) server_->remove(this);
+    }
+
+private:
+    Server* server_;
+};
+
+template<typename Command, typename Handler>
+void Server::on(Handler handler) {
+    auto shared = std::make_shared<Handler>(std::move(handler));
+    routes_[Command::COMMAND_ID] = [shared](const std::shared_ptr<ServerConnection>& connection, const ProtocolHeader& header, std::span<const uint8_t> payload) {
+        DecodeResult<Command> command = MessageTraits<Command>::tryDecode(payload.data(), payload.size());
+        if (!command) {
+            connection->countDropped();
+            return;
+        }
+        spawn(respond<Command, Handler>(connection, header, std::move(*command), shared));
+    };
+}
+
+template<typename Command, typename Handler>
+Task<void> Server::respond(std::shared_ptr<ServerConnection> connection, ProtocolHeader header, Command command, std::shared_ptr<Handler> handler) {
+    using Response = typename ResponseOf<Command>::type;
+    using Result = std::invoke_result_t<Handler&, const Command&>;
+    if constexpr (std::is_same_v<std::remove_cvref_t<Result>, Response>) {
+        connection->send(header, (*handler)(command));
+    } else {
+        Response response = co_await (*handler)(command);
+        connection->send(header, response);
+    }
+    co_return;
+}
+
+/**
+ * Server that answers every command with a default-constructed response, for
+ * exercising clients over loopback or a socketpair. Override individual
+ * commands with on<Command>().
+ */
+class DeviceSimulator : public Server {
+public:
+    explicit DeviceSimulator(EventLoop& loop) : Server(loop) {
+        on<PingCommand>([](const PingCommand&) { return PingResponse{}; });
+        on<GetDeviceInfoCommand>([](const GetDeviceInfoCommand&) { return DeviceInfoResponse{}; });
+        on<SendDataCommand>([](const SendDataCommand&) { return SendDataResponse{}; });
+        on<SetConfigCommand>([](const SetConfigCommand&) { return SetConfigResponse{}; });
+        on<BatchCommand>([](const BatchCommand&) { return BatchResponse{}; });
+    }
+};
+
+// ============================================
+// Sockets
+// ============================================
+
+/// Listening TCP socket on address:port (port 0 picks a free one; see localPort())
+int listenTcp(uint16_t port, const char* address = "127.0.0.1");
+
+/// Connected TCP socket with TCP_NODELAY set
+int connectTcp(const char* address, uint16_t port);
+
+uint16_t localPort(int fd);
+
+} // namespace binaryprotocol
+
+#endif // BINARY_PROTOCOL_HAS_EPOLL
+
+#endif // BINARY_PROTOCOL_TRANSPORT_HPP
\ No newline at end of file
@@ -10,7 +10,7 @@ import { Parser } from '../parser/index.js';
 import { TypeScriptGenerator } from '../generators/typescript/index.js';
 import { CppGenerator } from '../generators/cpp/index.js';
 import { RustGenerator } from '../generators/rust/index.js';
-import { SchemaIR } from '../ir/index.js';
+import { SchemaIR, encodeSchemaDescriptor } from '../ir/index.js';
 
 interface GenerateOptions {
   input: string;
@@ -26,11 +26,13 @@ TypeSpec Binary Serializer - Code Generator
 Usage:
   tbs generate [options]
   tbs parse <input-file>     Parse and show IR
+  tbs descriptor [options]   Write the binary schema descriptor
   tbs help                   Show this help
 
 Commands:
   generate    Generate code from TypeSpec schema
   parse       Parse TypeSpec and output intermediate representation
+  descriptor  Write <output>/<schema>.tbsd for runtime-loaded codecs (dynamic_codec.hpp)
   help        Show help information
 
 Generate Options:
@@ -44,6 +46,7 @@ Examples:
   tbs generate
   tbs generate -i schema.tsp -o ./generated -l typescript,rust
   tbs parse schema.tsp
+  tbs descriptor -i schema.tsp -o ./generated
 `);
 }
 
@@ -200,6 +203,24 @@ async function main(): Promise<void> {
       break;
     }
 
+    case 'descriptor':
+    case 'd': {
+      try {
+        const source = loadSchema(options.input);
+        const ir = parseSchema(source, options.input);
+        const outputDir = path.resolve(options.output);
+        ensureDirectory(outputDir);
+        const filePath = path.join(outputDir, `${path.basename(options.input, path.extname(options.input))}.tbsd`);
+        const descriptor = encodeSchemaDescriptor(ir);
+        fs.writeFileSync(filePath, descriptor);
+        console.log(`✓ Wrote ${filePath} (${descriptor.length} bytes)`);
+      } catch (error) {
+        console.error('Error:', error instanceof Error ? error.message : error);
+        process.exit(1);
+      }
+      break;
+    }
+
     case 'help':
     case 'h':
     case '--help':
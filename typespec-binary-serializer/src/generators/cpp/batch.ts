@@ -0,0 +1,269 @@
+/**
+ * C++ バッチビルダー/イテレーター生成
+ * @batch フィールドはサブメッセージ [command_id u8][length u16][payload] の連続として扱う
+ */
+
+import { SchemaIR, ModelDefinition, FieldDefinition, PRIMITIVE_SIZES } from '../../ir/types.js';
+
+/**
+ * @batch フィールドの構成
+ */
+export interface BatchLayout {
+  model: ModelDefinition;
+  field: FieldDefinition;
+  /** 件数フィールド（1つなら総数、2つなら成功数/失敗数） */
+  countFields: FieldDefinition[];
+  /** 件数フィールドのオフセット（countFields と同順） */
+  countOffsets: number[];
+  /** 長さプレフィックスのオフセット */
+  prefixOffset: number;
+}
+
+/**
+ * @batch フィールドを持つモデルを列挙（レイアウト制約を検証）
+ */
+export function findBatchLayouts(ir: SchemaIR): BatchLayout[] {
+  const layouts: BatchLayout[] = [];
+  for (const model of ir.models) {
+    const index = model.fields.findIndex(f => f.decorators.some(d => d.name === 'batch'));
+    if (index < 0) continue;
+
+    const field = model.fields[index];
+    const where = `${model.name}.${field.name}`;
+    if (field.type.name !== 'bytes' || !field.size.lengthPrefixType) {
+      throw new Error(`@batch requires a length-prefixed bytes field: ${where}`);
+    }
+    // ビルダーは本体を末尾に追記するため、バッチフィールドは最後に置く
+    if (index !== model.fields.length - 1) {
+      throw new Error(`@batch field must be the last field: ${where}`);
+    }
+
+    const names = field.decorators.find(d => d.name === 'batch')!.args.map(String);
+    if (names.length < 1 || names.length > 2) {
+      throw new Error(`@batch takes a count field or success/failure count fields: ${where}`);
+    }
+    const countFields: FieldDefinition[] = [];
+    const countOffsets: number[] = [];
+    let offset = 0;
+    for (const other of model.fields.slice(0, index)) {
+      if (!names.includes(other.name) || other.size.fixedSize === undefined) {
+        throw new Error(`@batch model may only contain its count fields before ${field.name}: ${model.name}.${other.name}`);
+      }
+      offset += other.size.fixedSize;
+    }
+    for (const name of names) {
+      const countField = model.fields.find(f => f.name === name);
+      if (!countField) {
+        throw new Error(`@batch count field not found: ${model.name}.${name}`);
+      }
+      countFields.push(countField);
+      countOffsets.push(fieldOffset(model, name));
+    }
+    if (countFields.some(f => f.type.name !== countFields[0].type.name)) {
+      throw new Error(`@batch count fields must share one type: ${where}`);
+    }
+    layouts.push({ model, field, countFields, countOffsets, prefixOffset: offset });
+  }
+  return layouts;
+}
+
+function fieldOffset(model: ModelDefinition, name: string): number {
+  let offset = 0;
+  for (const field of model.fields) {
+    if (field.name === name) return offset;
+    offset += field.size.fixedSize ?? 0;
+  }
+  return offset;
+}
+
+/**
+ * バッチ共通部（エントリーとイテレーター）と各モデルのビルダー
+ */
+export function generateBatchHeader(layouts: BatchLayout[]): string {
+  const sections: string[] = [];
+
+  sections.push(`// ============================================
+// Batches
+// ============================================
+
+/// Each sub-message of a batch field is [command_id u8][length u16][payload]
+inline constexpr size_t BATCH_ENTRY_HEADER_SIZE = 3;
+
+/// One sub-message of a batch field; payload borrows from the batch bytes
+struct BatchEntry {
+    uint8_t commandId;
+    std::span<const uint8_t> payload;
+
+    template<typename T>
+    T as() const {
+        if (commandId != MessageTraits<T>::COMMAND_ID) BINARY_PROTOCOL_THROW(std::runtime_error("Batch entry command ID mismatch"));
+        return MessageTraits<T>::decode(payload.data(), payload.size());
+    }
+
+    /// as() for untrusted input: UnknownCommand when the entry holds another command
+    template<typename T>
+    DecodeResult<T> tryAs() const {
+        if (commandId != MessageTraits<T>::COMMAND_ID) return DecodeError::UnknownCommand;
+        return MessageTraits<T>::tryDecode(payload.data(), payload.size());
+    }
+
+    std::optional<Message> decode() const { return decodeMessage(commandId, payload); }
+};
+
+/**
+ * Walks the sub-messages of a batch field in place.
+ * Entry headers are validated as the iterator reaches them; a truncated entry throws.
+ * tryDeserialize runs validate() first, so entries of a batch it accepted never throw.
+ */
+template<Endian E>
+class BasicBatchEntries {
+public:
+    class Iterator {
+    public:
+        Iterator(const uint8_t* position, const uint8_t* end) : position_(position), end_(end) { load(); }
+        const BatchEntry& operator*() const { return entry_; }
+        const BatchEntry* operator->() const { return &entry_; }
+        Iterator& operator++() {
+            position_ = entry_.payload.data() + entry_.payload.size();
+            load();
+            return *this;
+        }
+        bool operator==(const Iterator& other) const { return position_ == other.position_; }
+        bool operator!=(const Iterator& other) const { return position_ != other.position_; }
+
+    private:
+        void load() {
+            if (position_ == end_) return;
+            const size_t available = static_cast<size_t>(end_ - position_);
+            if (available < BATCH_ENTRY_HEADER_SIZE) BINARY_PROTOCOL_THROW(std::runtime_error("Truncated batch entry"));
+            const size_t length = detail::load<E, uint16_t>(position_ + 1);
+            if (available - BATCH_ENTRY_HEADER_SIZE < length) BINARY_PROTOCOL_THROW(std::runtime_error("Truncated batch entry"));
+            entry_ = {position_[0], {position_ + BATCH_ENTRY_HEADER_SIZE, length}};
+        }
+
+        const uint8_t* position_;
+        const uint8_t* end_;
+        BatchEntry entry_{};
+    };
+
+    explicit BasicBatchEntries(std::span<const uint8_t> bytes) : bytes_(bytes) {}
+
+    Iterator begin() const { return Iterator(bytes_.data(), bytes_.data() + bytes_.size()); }
+    Iterator end() const { return Iterator(bytes_.data() + bytes_.size(), bytes_.data() + bytes_.size()); }
+    std::span<const uint8_t> bytes() const { return bytes_; }
+
+    /// Checks the framing of every entry without decoding payloads
+    std::optional<DecodeError> validate() const {
+        const uint8_t* position = bytes_.data();
+        const uint8_t* const end = position + bytes_.size();
+        while (position != end) {
+            const size_t available = static_cast<size_t>(end - position);
+            if (available < BATCH_ENTRY_HEADER_SIZE) return DecodeError::Truncated;
+            const size_t length = detail::load<E, uint16_t>(position + 1);
+            if (available - BATCH_ENTRY_HEADER_SIZE < length) return DecodeError::Truncated;
+            position += BATCH_ENTRY_HEADER_SIZE + length;
+        }
+        return std::nullopt;
+    }
+
+private:
+    std::span<const uint8_t> bytes_;
+};
+
+namespace detail {
+
+/// Batch results without a success field count as successes
+template<typename T>
+constexpr bool batchResultSucceeded(const T& result) {
+    if constexpr (requires { result.success; }) {
+        return result.success;
+    } else {
+        return true;
+    }
+}
+
+} // namespace detail`);
+
+  for (const layout of layouts) {
+    sections.push(generateBuilder(layout));
+  }
+  return sections.join('\n\n');
+}
+
+function generateBuilder(layout: BatchLayout): string {
+  const { model, field, countFields, countOffsets, prefixOffset } = layout;
+  const endian = model.endian === 'big' ? 'Endian::Big' : 'Endian::Little';
+  const prefixType = `${layout.field.size.lengthPrefixType}_t`;
+  const bodyOffset = prefixOffset + PRIMITIVE_SIZES[layout.field.size.lengthPrefixType! as keyof typeof PRIMITIVE_SIZES];
+  const counters = countFields.map(f => ({ member: `${f.name}_`, type: `decltype(${model.name}::${f.name})`, field: f }));
+
+  // 成功数/失敗数に分かれている場合は結果の success フィールドで振り分ける
+  let countStep: string;
+  if (counters.length === 1) {
+    countStep = `        if (${counters[0].member} == std::numeric_limits<${counters[0].type}>::max()) {
+            BINARY_PROTOCOL_THROW(std::runtime_error("Too many ${model.name} entries"));
+        }
+        ++${counters[0].member};`;
+  } else {
+    countStep = `        ${counters[0].type}& counter = detail::batchResultSucceeded(message) ? ${counters[0].member} : ${counters[1].member};
+        if (counter == std::numeric_limits<${counters[0].type}>::max()) {
+            BINARY_PROTOCOL_THROW(std::runtime_error("Too many ${model.name} entries"));
+        }
+        ++counter;`;
+  }
+
+  const patches = counters.map((c, i) =>
+    `        writer_.template patch<${c.type}, ${endian}>(start_ + ${countOffsets[i]}, ${c.member});`);
+  patches.push(`        writer_.template patch<${prefixType}, ${endian}>(start_ + ${prefixOffset}, static_cast<${prefixType}>(bodySize_));`);
+
+  const accessors = counters.map(c => `    ${c.type} ${c.field.name}() const { return ${c.member}; }`);
+  const members = counters.map(c => `    ${c.type} ${c.member} = 0;`);
+
+  return `/**
+ * Builds a ${model.name} in place at the end of a writer's buffer.
+ * Sub-messages are encoded straight into ${field.name}; finish() back-patches
+ * ${countFields.map(f => f.name).join(', ')} and the length prefix.
+ */
+template<Endian E, typename Alloc>
+class ${model.name}Builder {
+public:
+    explicit ${model.name}Builder(BasicBinaryWriter<E, Alloc>& writer) : writer_(writer), start_(writer.size()) {
+        writer_.allocate(BODY_OFFSET);
+    }
+
+    template<typename T>
+    ${model.name}Builder& add(const T& message) {
+        checkLengthPrefixes(message);
+        const size_t size = encodedSize(message);
+        if (bodySize_ + BATCH_ENTRY_HEADER_SIZE + size > std::numeric_limits<${prefixType}>::max() ||
+            size > std::numeric_limits<uint16_t>::max()) {
+            BINARY_PROTOCOL_THROW(std::runtime_error("${model.name} too large"));
+        }
+${countStep}
+        std::span<uint8_t> out = writer_.allocate(BATCH_ENTRY_HEADER_SIZE + size);
+        out[0] = MessageTraits<T>::COMMAND_ID;
+        detail::store<${endian}>(out.data() + 1, static_cast<uint16_t>(size));
+        serializeInto(message, out.subspan(BATCH_ENTRY_HEADER_SIZE));
+        bodySize_ += BATCH_ENTRY_HEADER_SIZE + size;
+        return *this;
+    }
+
+    /// Writes the counts and length prefix; returns the encoded ${model.name} size
+    size_t finish() {
+${patches.join('\n')}
+        return BODY_OFFSET + bodySize_;
+    }
+
+${accessors.join('\n')}
+
+private:
+    static constexpr size_t BODY_OFFSET = ${bodyOffset};
+
+    BasicBinaryWriter<E, Alloc>& writer_;
+    size_t start_;
+    size_t bodySize_ = 0;
+${members.join('\n')}
+};
+
+using ${model.name}Entries = BasicBatchEntries<${endian}>;`;
+}
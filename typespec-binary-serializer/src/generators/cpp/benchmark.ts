@@ -0,0 +1,634 @@
+/**
+ * C++ ベンチマークスイート生成（Google Benchmark）
+ * 全モデルのシリアライズ/デシリアライズを計測し、割り当て回数も報告する
+ */
+
+import { SchemaIR, ModelDefinition, FieldDefinition, PRIMITIVE_SIZES } from '../../ir/types.js';
+import { findModel, flattenFixedFields, isBulkCopyModel, isEnumType } from './layout.js';
+import { CompactField, findCompactFields } from './compact.js';
+
+const INDENT = '    ';
+
+/** 配列フィールドの要素数 */
+const ARRAY_COUNTS = [1, 16, 64, 255];
+/** バイト列フィールドの長さ */
+const BYTE_LENGTHS = [0, 64, 1024, 16384];
+/** チェックサム計測のバッファ長 */
+const CHECKSUM_LENGTHS = [64, 1024, 65536];
+
+export interface BenchmarkOptions {
+  /** @checksum が有効な場合のチェックサムクラス */
+  checksumClasses: string[];
+  /** sealFrame/verifyFrame を生成している場合のフレームヘッダーモデル名 */
+  frameHeader?: string;
+}
+
+export function generateBenchmarkSuite(ir: SchemaIR, ns: string, options: BenchmarkOptions): string {
+  const lines: string[] = [];
+
+  lines.push('/**');
+  lines.push(' * Auto-generated Google Benchmark suite');
+  lines.push(' * Measures ns/message, bytes/sec and heap allocations per operation for every model.');
+  lines.push(' *');
+  lines.push(' * JSON results for comparing generator versions:');
+  lines.push(' *   cmake --build <build-dir> --target bench_json');
+  lines.push(' */');
+  lines.push('');
+  lines.push('#include "protocol.hpp"');
+  lines.push('#include "dynamic_codec.hpp"');
+  lines.push('');
+  lines.push('#include <benchmark/benchmark.h>');
+  lines.push('');
+  lines.push('#include <atomic>');
+  lines.push('#include <cmath>');
+  lines.push('#include <cstdlib>');
+  lines.push('#include <new>');
+  lines.push('#include <vector>');
+  lines.push('');
+  lines.push(`using namespace ${ns};`);
+  lines.push('');
+  lines.push(ALLOCATION_TRACKING);
+  lines.push('');
+  lines.push('namespace {');
+  lines.push('');
+  lines.push(COMMON_BENCHMARKS);
+  lines.push('');
+  lines.push(DYNAMIC_BENCHMARKS);
+
+  for (const model of dependencyOrder(ir)) {
+    lines.push('');
+    lines.push(generateBenchTraits(ir, model));
+  }
+
+  const bulkModels = ir.models.filter(m => isBulkCopyModel(ir, m));
+  if (bulkModels.length > 0) {
+    lines.push('');
+    lines.push('// Field-by-field reference codec, the baseline for the bulk memcpy path');
+    for (const model of bulkModels) {
+      lines.push('');
+      lines.push(generateReferenceEncode(ir, model));
+      lines.push('');
+      lines.push(generateReferenceDecode(ir, model));
+    }
+    lines.push('');
+    lines.push(FIELDWISE_BENCHMARKS);
+  }
+
+  const compactFields = findCompactFields(ir);
+  if (compactFields.length > 0) {
+    lines.push('');
+    lines.push(SERIES_BENCHMARKS);
+    for (const compact of compactFields) {
+      lines.push('');
+      lines.push(generateSeriesTraits(ir, compact));
+    }
+  }
+
+  if (options.checksumClasses.length > 0) {
+    lines.push('');
+    lines.push(CHECKSUM_BENCHMARKS);
+  }
+  if (options.frameHeader) {
+    lines.push('');
+    lines.push(verifyFrameBenchmark(options.frameHeader));
+  }
+
+  lines.push('');
+  lines.push('} // namespace');
+  lines.push('');
+
+  for (const model of ir.models) {
+    const args = benchmarkArgs(ir, model);
+    const suffix = args.map(arg => `->Arg(${arg})`).join('');
+    lines.push(`BENCHMARK_TEMPLATE(BM_Serialize, ${model.name})${suffix};`);
+    lines.push(`BENCHMARK_TEMPLATE(BM_SerializeInto, ${model.name})${suffix};`);
+    lines.push(`BENCHMARK_TEMPLATE(BM_SerializeWriter, ${model.name})${suffix};`);
+    lines.push(`BENCHMARK_TEMPLATE(BM_Deserialize, ${model.name})${suffix};`);
+    lines.push(`BENCHMARK_TEMPLATE(BM_DynamicEncode, ${model.name})${suffix};`);
+    lines.push(`BENCHMARK_TEMPLATE(BM_DynamicDecode, ${model.name})${suffix};`);
+    if (model.hasVariableLength) {
+      lines.push(`BENCHMARK_TEMPLATE(BM_View, ${model.name})${suffix};`);
+      lines.push(`BENCHMARK_TEMPLATE(BM_SerializeGather, ${model.name})${suffix};`);
+    }
+  }
+  for (const { model } of compactFields) {
+    const suffix = benchmarkArgs(ir, model).map(arg => `->Arg(${arg})`).join('');
+    for (const compact of ['false', 'true']) {
+      lines.push(`BENCHMARK_TEMPLATE(BM_SeriesEncode, ${model.name}, ${compact})${suffix};`);
+      lines.push(`BENCHMARK_TEMPLATE(BM_SeriesDecode, ${model.name}, ${compact})${suffix};`);
+    }
+  }
+  for (const model of bulkModels) {
+    lines.push(`BENCHMARK_TEMPLATE(BM_SerializeFieldwise, ${model.name});`);
+    lines.push(`BENCHMARK_TEMPLATE(BM_DeserializeFieldwise, ${model.name});`);
+  }
+  const checksumArgs = CHECKSUM_LENGTHS.map(length => `->Arg(${length})`).join('');
+  for (const checksumClass of options.checksumClasses) {
+    lines.push(`BENCHMARK_TEMPLATE(BM_Checksum, ${checksumClass})${checksumArgs};`);
+  }
+  if (options.frameHeader) {
+    lines.push(`BENCHMARK(BM_VerifyFrame)${checksumArgs};`);
+  }
+  lines.push('');
+  lines.push('BENCHMARK_MAIN();');
+
+  return lines.join('\n');
+}
+
+/**
+ * ネスト/配列要素のモデルが先に来る順序（特殊化の定義順）
+ */
+function dependencyOrder(ir: SchemaIR): ModelDefinition[] {
+  const ordered: ModelDefinition[] = [];
+  const visit = (model: ModelDefinition) => {
+    if (ordered.includes(model)) return;
+    for (const field of model.fields) {
+      const dependency = findModel(ir, field.type.elementType?.name ?? field.type.name);
+      if (dependency && dependency !== model) visit(dependency);
+    }
+    ordered.push(model);
+  };
+  ir.models.forEach(visit);
+  return ordered;
+}
+
+/**
+ * 可変長モデルの計測パラメータ（配列なら要素数、バイト列なら長さ）
+ */
+function benchmarkArgs(ir: SchemaIR, model: ModelDefinition): number[] {
+  if (!model.hasVariableLength) return [];
+  const variable = model.fields.filter(f => f.size.lengthPrefixType);
+  const prefixMax = Math.min(...variable.map(f => 2 ** (8 * prefixSize(f)) - 1));
+  const array = variable.find(f => f.type.kind === 'array');
+  if (array) {
+    const element = findModel(ir, array.type.elementType?.name ?? '');
+    const maxCount = Math.floor(prefixMax / (element?.fixedSize ?? 1));
+    return ARRAY_COUNTS.filter(count => count <= maxCount);
+  }
+  return BYTE_LENGTHS.filter(length => length <= prefixMax);
+}
+
+function prefixSize(field: FieldDefinition): number {
+  return PRIMITIVE_SIZES[field.size.lengthPrefixType as keyof typeof PRIMITIVE_SIZES] ?? 1;
+}
+
+/**
+ * モデルごとのサンプル生成とデコード関数
+ */
+function generateBenchTraits(ir: SchemaIR, model: ModelDefinition): string {
+  const name = model.name;
+  const lines: string[] = [];
+  lines.push('template<>');
+  lines.push(`struct BenchTraits<${name}> {`);
+  lines.push(`${INDENT}static constexpr Endian ENDIAN = ${endianConstant(model)};`);
+  lines.push(`${INDENT}static constexpr const char* NAME = "${name}";`);
+  lines.push('');
+  lines.push(`${INDENT}static ${name} make([[maybe_unused]] const benchmark::State& state) {`);
+  if (model.hasVariableLength) {
+    lines.push(`${INDENT}${INDENT}const size_t n = static_cast<size_t>(state.range(0));`);
+  }
+  lines.push(`${INDENT}${INDENT}${name} sample{};`);
+  model.fields.forEach((field, index) => {
+    for (const assignment of sampleFieldAssignments(ir, field, index, 'sample')) {
+      lines.push(`${INDENT}${INDENT}${assignment}`);
+    }
+  });
+  lines.push(`${INDENT}${INDENT}return sample;`);
+  lines.push(`${INDENT}}`);
+  lines.push('');
+  lines.push(`${INDENT}static ${name} decode(const uint8_t* data, size_t size) { return deserialize${name}(data, size); }`);
+  if (model.hasVariableLength) {
+    lines.push(`${INDENT}static ${name}View view(const uint8_t* data, size_t size) { return view${name}(data, size); }`);
+  }
+  lines.push('};');
+  return lines.join('\n');
+}
+
+/**
+ * @compact 比較用の時系列サンプル（隣接要素が相関する値）
+ */
+function generateSeriesTraits(ir: SchemaIR, { model, field, element }: CompactField): string {
+  const name = model.name;
+  const updates = flattenFixedFields(ir, element).flatMap(leaf => {
+    const target = `row.${leaf.path}`;
+    const typeName = leaf.field.type.name;
+    if (typeName === 'float32' || typeName === 'float64') {
+      const cast = typeName === 'float32' ? 'float' : 'double';
+      // 緩やかな変化に測定ノイズを重ねる
+      return [`${target} = static_cast<${cast}>(${target} + 0.5 * std::sin(static_cast<double>(i) * 0.05) + 0.001 * static_cast<double>((i * 7919) % 101));`];
+    }
+    if (typeName === 'uint64' || typeName === 'int64') {
+      return [`${target} += static_cast<${typeName}_t>(i * 1000 + (i * 7919) % 13);`];
+    }
+    if (typeName === 'bool') {
+      return [`${target} = (i / 16) % 2 == 0;`];
+    }
+    if (isEnumType(ir, typeName) || typeName === 'string' || typeName === 'bytes') {
+      return [];
+    }
+    return [`${target} = static_cast<${typeName}_t>(${target} + i % 4);`];
+  });
+
+  const lines: string[] = [];
+  lines.push('template<>');
+  lines.push(`struct SeriesTraits<${name}> {`);
+  lines.push(`${INDENT}static ${name} make(const benchmark::State& state) {`);
+  lines.push(`${INDENT}${INDENT}${name} sample = BenchTraits<${name}>::make(state);`);
+  lines.push(`${INDENT}${INDENT}for (size_t i = 0; i < sample.${field.name}.size(); i++) {`);
+  lines.push(`${INDENT}${INDENT}${INDENT}auto& row = sample.${field.name}[i];`);
+  lines.push(...updates.map(update => `${INDENT}${INDENT}${INDENT}${update}`));
+  lines.push(`${INDENT}${INDENT}}`);
+  lines.push(`${INDENT}${INDENT}return sample;`);
+  lines.push(`${INDENT}}`);
+  lines.push('');
+  lines.push(`${INDENT}static size_t rows(const ${name}& sample) { return sample.${field.name}.size(); }`);
+  lines.push(`${INDENT}static ${name} decodeCompact(const uint8_t* data, size_t size) { return deserializeCompact${name}(data, size); }`);
+  lines.push('};');
+  return lines.join('\n');
+}
+
+function generateReferenceEncode(ir: SchemaIR, model: ModelDefinition): string {
+  const lines: string[] = [];
+  lines.push(`void referenceEncode(BasicSpanWriter<${endianConstant(model)}>& writer, const ${model.name}& data) {`);
+  for (const field of model.fields) {
+    lines.push(`${INDENT}${referenceWrite(ir, field)}`);
+  }
+  lines.push('}');
+  return lines.join('\n');
+}
+
+function generateReferenceDecode(ir: SchemaIR, model: ModelDefinition): string {
+  const lines: string[] = [];
+  lines.push(`void referenceDecode(BasicBinaryReader<${endianConstant(model)}>& reader, ${model.name}& result) {`);
+  for (const field of model.fields) {
+    lines.push(`${INDENT}${referenceRead(ir, field)}`);
+  }
+  lines.push('}');
+  return lines.join('\n');
+}
+
+function referenceWrite(ir: SchemaIR, field: FieldDefinition): string {
+  const accessor = `data.${field.name}`;
+  const typeName = field.type.name;
+  if (typeName === 'string') return `writer.writeFixedString(${accessor});`;
+  if (typeName === 'bytes') return `writer.writeBytes(${accessor});`;
+  if (isEnumType(ir, typeName)) return `writer.writeUint8(static_cast<uint8_t>(${accessor}));`;
+  if (findModel(ir, typeName)) return `referenceEncode(writer, ${accessor});`;
+  return `writer.write${pascal(typeName)}(${accessor});`;
+}
+
+function referenceRead(ir: SchemaIR, field: FieldDefinition): string {
+  const accessor = `result.${field.name}`;
+  const typeName = field.type.name;
+  if (typeName === 'string') return `${accessor} = reader.readFixedString<${field.size.fixedSize}>();`;
+  if (typeName === 'bytes') return `${accessor} = reader.readFixedBytes<${field.size.fixedSize}>();`;
+  if (isEnumType(ir, typeName)) return `${accessor} = static_cast<${typeName}>(reader.readUint8());`;
+  if (findModel(ir, typeName)) return `referenceDecode(reader, ${accessor});`;
+  return `${accessor} = reader.read${pascal(typeName)}();`;
+}
+
+/**
+ * ベンチマーク用のサンプル値代入文を生成（固定長フィールドのみ）
+ */
+export function sampleAssignments(ir: SchemaIR, model: ModelDefinition, target: string): string[] {
+  const assignments: string[] = [];
+  model.fields.forEach((field, index) => {
+    assignments.push(...sampleFieldAssignments(ir, field, index, target));
+  });
+  return assignments;
+}
+
+/**
+ * フィールド1つ分の代入文（可変長フィールドはベンチマーク引数 n で長さを決める）
+ */
+function sampleFieldAssignments(ir: SchemaIR, field: FieldDefinition, index: number, target: string): string[] {
+  const accessor = `${target}.${field.name}`;
+  const typeName = field.type.name;
+
+  if (field.size.lengthPrefixType) {
+    if (field.type.kind === 'array') {
+      return [`${accessor}.assign(n, BenchTraits<${field.type.elementType?.name}>::make(state));`];
+    }
+    return [`${accessor}.assign(n, ${typeName === 'string' ? "'a'" : '0x5A'});`];
+  }
+
+  const nested = findModel(ir, typeName);
+  if (nested) {
+    return sampleAssignments(ir, nested, accessor);
+  }
+  if (typeName === 'string' || typeName === 'bytes') {
+    return [`${accessor}.fill(${typeName === 'string' ? "'a'" : '0x5A'});`];
+  }
+  if (isEnumType(ir, typeName)) {
+    return [`${accessor} = static_cast<${typeName}>(1);`];
+  }
+  return [`${accessor} = ${sampleScalar(typeName, index)};`];
+}
+
+function sampleScalar(typeName: string, seed: number): string {
+  switch (typeName) {
+    case 'bool':
+      return 'true';
+    case 'float32':
+      return `${seed + 1}.25f`;
+    case 'float64':
+      return `${seed + 1}.5`;
+    case 'uint64':
+    case 'int64':
+      return `${1700000000000 + seed}`;
+    default:
+      return `${(seed * 37 + 11) % 100}`;
+  }
+}
+
+function endianConstant(model: ModelDefinition): string {
+  return model.endian === 'big' ? 'Endian::Big' : 'Endian::Little';
+}
+
+function pascal(typeName: string): string {
+  return typeName.charAt(0).toUpperCase() + typeName.slice(1);
+}
+
+const ALLOCATION_TRACKING = `// Counts every heap allocation so benchmarks can report allocs/op
+namespace {
+std::atomic<uint64_t> g_allocations{0};
+} // namespace
+
+void* operator new(std::size_t size) {
+    g_allocations.fetch_add(1, std::memory_order_relaxed);
+    if (void* memory = std::malloc(size == 0 ? 1 : size)) {
+        return memory;
+    }
+    throw std::bad_alloc();
+}
+
+// Kept out of line so GCC does not pair the inlined free() with operator new
+// and raise a spurious -Wmismatched-new-delete
+[[gnu::noinline]] void operator delete(void* memory) noexcept { std::free(memory); }
+[[gnu::noinline]] void operator delete(void* memory, std::size_t) noexcept { std::free(memory); }`;
+
+const COMMON_BENCHMARKS = `/// Reports the heap allocations made while the benchmark loop ran
+class AllocationCounter {
+public:
+    explicit AllocationCounter(benchmark::State& state)
+        : state_(state), start_(g_allocations.load(std::memory_order_relaxed)) {}
+
+    ~AllocationCounter() {
+        const double allocations = static_cast<double>(g_allocations.load(std::memory_order_relaxed) - start_);
+        state_.counters["allocs/op"] = benchmark::Counter(allocations, benchmark::Counter::kAvgIterations);
+    }
+
+private:
+    benchmark::State& state_;
+    uint64_t start_;
+};
+
+template<typename T>
+struct BenchTraits;
+
+template<typename T>
+void setThroughput(benchmark::State& state, const T& sample) {
+    state.SetItemsProcessed(state.iterations());
+    state.SetBytesProcessed(state.iterations() * static_cast<int64_t>(encodedSize(sample)));
+}
+
+/// serialize(): allocates a fresh vector per message
+template<typename T>
+void BM_Serialize(benchmark::State& state) {
+    const T sample = BenchTraits<T>::make(state);
+    {
+        AllocationCounter allocations(state);
+        for (auto _ : state) {
+            std::vector<uint8_t> bytes = serialize(sample);
+            benchmark::DoNotOptimize(bytes.data());
+        }
+    }
+    setThroughput(state, sample);
+}
+
+/// serializeInto(): caller-provided buffer
+template<typename T>
+void BM_SerializeInto(benchmark::State& state) {
+    const T sample = BenchTraits<T>::make(state);
+    std::vector<uint8_t> buffer(encodedSize(sample));
+    {
+        AllocationCounter allocations(state);
+        for (auto _ : state) {
+            benchmark::DoNotOptimize(serializeInto(sample, buffer));
+            benchmark::ClobberMemory();
+        }
+    }
+    setThroughput(state, sample);
+}
+
+/// serialize(message, writer): one long-lived writer cleared per message
+template<typename T>
+void BM_SerializeWriter(benchmark::State& state) {
+    const T sample = BenchTraits<T>::make(state);
+    BinaryWriter writer;
+    writer.reserve(encodedSize(sample));
+    {
+        AllocationCounter allocations(state);
+        for (auto _ : state) {
+            writer.clear();
+            benchmark::DoNotOptimize(serialize(sample, writer));
+            benchmark::ClobberMemory();
+        }
+    }
+    setThroughput(state, sample);
+}
+
+/// serializeGather(): fixed fields inline, variable-length fields referenced in place
+template<typename T>
+void BM_SerializeGather(benchmark::State& state) {
+    const T sample = BenchTraits<T>::make(state);
+    GatherList list;
+    {
+        AllocationCounter allocations(state);
+        for (auto _ : state) {
+            list.clear();
+            serializeGather(sample, list);
+            benchmark::DoNotOptimize(list.segments().data());
+            benchmark::ClobberMemory();
+        }
+    }
+    setThroughput(state, sample);
+}
+
+template<typename T>
+void BM_Deserialize(benchmark::State& state) {
+    const T sample = BenchTraits<T>::make(state);
+    const std::vector<uint8_t> bytes = serialize(sample);
+    {
+        AllocationCounter allocations(state);
+        for (auto _ : state) {
+            T result = BenchTraits<T>::decode(bytes.data(), bytes.size());
+            benchmark::DoNotOptimize(result);
+        }
+    }
+    setThroughput(state, sample);
+}
+
+/// Zero-copy view decode of variable-length models
+template<typename T>
+void BM_View(benchmark::State& state) {
+    const T sample = BenchTraits<T>::make(state);
+    const std::vector<uint8_t> bytes = serialize(sample);
+    {
+        AllocationCounter allocations(state);
+        for (auto _ : state) {
+            auto result = BenchTraits<T>::view(bytes.data(), bytes.size());
+            benchmark::DoNotOptimize(result);
+        }
+    }
+    setThroughput(state, sample);
+}`;
+
+const DYNAMIC_BENCHMARKS = `/// The table-driven codec on the built-in descriptor; compare with BM_SerializeInto and BM_Deserialize
+const dynamic::Schema& builtinSchema() {
+    static const dynamic::Schema schema = dynamic::Schema::load(dynamic::builtinSchemaDescriptor());
+    return schema;
+}
+
+template<typename T>
+void BM_DynamicEncode(benchmark::State& state) {
+    const T sample = BenchTraits<T>::make(state);
+    const std::vector<uint8_t> bytes = serialize(sample);
+    const dynamic::Model& model = *builtinSchema().model(BenchTraits<T>::NAME);
+    dynamic::Record record;
+    if (model.decodeInto(bytes, record)) {
+        state.SkipWithError("sample does not decode");
+        return;
+    }
+    std::vector<uint8_t> buffer(bytes.size());
+    {
+        AllocationCounter allocations(state);
+        for (auto _ : state) {
+            benchmark::DoNotOptimize(model.encodeInto(record, buffer));
+            benchmark::ClobberMemory();
+        }
+    }
+    setThroughput(state, sample);
+}
+
+/// Decodes into one reused Record, so only the first iteration allocates
+template<typename T>
+void BM_DynamicDecode(benchmark::State& state) {
+    const T sample = BenchTraits<T>::make(state);
+    const std::vector<uint8_t> bytes = serialize(sample);
+    const dynamic::Model& model = *builtinSchema().model(BenchTraits<T>::NAME);
+    dynamic::Record record(model);
+    {
+        AllocationCounter allocations(state);
+        for (auto _ : state) {
+            benchmark::DoNotOptimize(model.decodeInto(bytes, record));
+            benchmark::ClobberMemory();
+        }
+    }
+    setThroughput(state, sample);
+}`;
+
+const FIELDWISE_BENCHMARKS = `template<typename T>
+void BM_SerializeFieldwise(benchmark::State& state) {
+    const T sample = BenchTraits<T>::make(state);
+    std::array<uint8_t, T::ENCODED_SIZE> buffer{};
+    for (auto _ : state) {
+        BasicSpanWriter<BenchTraits<T>::ENDIAN> writer(buffer);
+        referenceEncode(writer, sample);
+        benchmark::DoNotOptimize(buffer.data());
+        benchmark::ClobberMemory();
+    }
+    setThroughput(state, sample);
+}
+
+template<typename T>
+void BM_DeserializeFieldwise(benchmark::State& state) {
+    const T sample = BenchTraits<T>::make(state);
+    const std::vector<uint8_t> bytes = serialize(sample);
+    for (auto _ : state) {
+        BasicBinaryReader<BenchTraits<T>::ENDIAN> reader(bytes.data(), bytes.size());
+        T result{};
+        referenceDecode(reader, result);
+        benchmark::DoNotOptimize(result);
+    }
+    setThroughput(state, sample);
+}`;
+
+const SERIES_BENCHMARKS = `/// Correlated time series for comparing the fixed layout with @compact
+template<typename T>
+struct SeriesTraits;
+
+template<typename T, bool Compact>
+void encodeSeries(const T& sample, std::vector<uint8_t>& out) {
+    out.clear();
+    if constexpr (Compact) {
+        serializeCompact(sample, out);
+    } else {
+        out.resize(encodedSize(sample));
+        serializeInto(sample, out);
+    }
+}
+
+/// items/s counts rows; wire_bytes is the encoded message size
+template<typename T>
+void setSeriesCounters(benchmark::State& state, const T& sample, size_t wireBytes) {
+    state.SetItemsProcessed(state.iterations() * static_cast<int64_t>(SeriesTraits<T>::rows(sample)));
+    state.SetBytesProcessed(state.iterations() * static_cast<int64_t>(wireBytes));
+    state.counters["wire_bytes"] = static_cast<double>(wireBytes);
+}
+
+template<typename T, bool Compact>
+void BM_SeriesEncode(benchmark::State& state) {
+    const T sample = SeriesTraits<T>::make(state);
+    std::vector<uint8_t> buffer;
+    encodeSeries<T, Compact>(sample, buffer);
+    {
+        AllocationCounter allocations(state);
+        for (auto _ : state) {
+            encodeSeries<T, Compact>(sample, buffer);
+            benchmark::DoNotOptimize(buffer.data());
+            benchmark::ClobberMemory();
+        }
+    }
+    setSeriesCounters(state, sample, buffer.size());
+}
+
+template<typename T, bool Compact>
+void BM_SeriesDecode(benchmark::State& state) {
+    const T sample = SeriesTraits<T>::make(state);
+    std::vector<uint8_t> bytes;
+    encodeSeries<T, Compact>(sample, bytes);
+    {
+        AllocationCounter allocations(state);
+        for (auto _ : state) {
+            T result = Compact
+                ? SeriesTraits<T>::decodeCompact(bytes.data(), bytes.size())
+                : BenchTraits<T>::decode(bytes.data(), bytes.size());
+            benchmark::DoNotOptimize(result);
+        }
+    }
+    setSeriesCounters(state, sample, bytes.size());
+}`;
+
+const CHECKSUM_BENCHMARKS = `template<typename Checksum>
+void BM_Checksum(benchmark::State& state) {
+    std::vector<uint8_t> data(static_cast<size_t>(state.range(0)));
+    for (size_t i = 0; i < data.size(); ++i) {
+        data[i] = static_cast<uint8_t>(i * 131);
+    }
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(Checksum::compute(data));
+    }
+    state.SetBytesProcessed(state.iterations() * state.range(0));
+}`;
+
+function verifyFrameBenchmark(header: string): string {
+  return `void BM_VerifyFrame(benchmark::State& state) {
+    std::vector<uint8_t> frame(${header}::ENCODED_SIZE + static_cast<size_t>(state.range(0)), 0x5A);
+    sealFrame(frame);
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(verifyFrame(frame));
+    }
+    state.SetBytesProcessed(state.iterations() * static_cast<int64_t>(frame.size()));
+}`;
+}
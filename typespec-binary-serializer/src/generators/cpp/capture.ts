@@ -0,0 +1,905 @@
+/**
+ * C++ キャプチャファイル（記録済みトラフィック）生成
+ * フレームを [タイムスタンプ][ヘッダー][ペイロード] として追記し、close() で疎インデックスを書き出す
+ */
+
+import { SchemaIR, ModelDefinition, PRIMITIVE_SIZES } from '../../ir/types.js';
+import { FrameHeaderLayout, findModel, flattenFixedFields } from './layout.js';
+
+/**
+ * メッセージ自身が持つタイムスタンプの位置
+ */
+interface TimestampSource {
+  model: ModelDefinition;
+  /** ペイロード先頭からのオフセット（配列の場合は先頭要素内のオフセットを含む） */
+  offset: number;
+  /** 配列の先頭要素から読む場合の長さプレフィックス */
+  arrayPrefix?: { offset: number; type: string; elementSize: number };
+}
+
+/**
+ * uint64 の timestamp フィールド（直下、または可変長配列の先頭要素）を持つメッセージを列挙
+ */
+function findTimestampSources(ir: SchemaIR): TimestampSource[] {
+  const sources: TimestampSource[] = [];
+  for (const model of ir.models) {
+    if (model.commandId === undefined) continue;
+
+    let offset = 0;
+    for (const field of model.fields) {
+      if (field.name === 'timestamp' && field.type.name === 'uint64') {
+        sources.push({ model, offset });
+        break;
+      }
+      const element = field.type.kind === 'array' && field.type.elementType
+        ? findModel(ir, field.type.elementType.name)
+        : undefined;
+      if (element && element.fixedSize !== undefined && field.size.lengthPrefixType) {
+        const stamp = flattenFixedFields(ir, element)
+          .find(f => f.path === 'timestamp' && f.field.type.name === 'uint64');
+        if (stamp) {
+          const prefixSize = PRIMITIVE_SIZES[field.size.lengthPrefixType as keyof typeof PRIMITIVE_SIZES];
+          sources.push({
+            model,
+            offset: offset + prefixSize + stamp.offset,
+            arrayPrefix: { offset, type: `${field.size.lengthPrefixType}_t`, elementSize: element.fixedSize },
+          });
+        }
+        break;
+      }
+      // 可変長フィールド以降はオフセットが定まらない
+      if (field.size.fixedSize === undefined) break;
+      offset += field.size.fixedSize;
+    }
+  }
+  return sources;
+}
+
+export function generateCaptureHeader(layout: FrameHeaderLayout, ns: string): string {
+  const header = layout.model.name;
+  const sealing = layout.checksum
+    ? `
+        sealFrame(frame);`
+    : '';
+
+  return `/**
+ * Auto-generated capture file writer and reader
+ * Records ${header}-framed traffic to disk and replays it through mmap.
+ */
+
+#ifndef BINARY_PROTOCOL_CAPTURE_HPP
+#define BINARY_PROTOCOL_CAPTURE_HPP
+
+#include "protocol.hpp"
+
+#include <cstdint>
+#include <optional>
+#include <span>
+#include <string>
+#include <vector>
+
+namespace ${ns} {
+
+/*
+ * Capture file layout (file-level integers are little-endian):
+ *
+ *   file header  "TBSCAP01", u32 version, u32 reserved
+ *   records      [u64 timestamp][${header}][payload], back to back
+ *   index        CaptureIndexEntry every indexInterval records
+ *   trailer      u64 index offset, u64 entry count, "TBSIDX01"
+ *
+ * The index and trailer are written by CaptureWriter::close(). A file without
+ * them (the writer did not close) stays readable: the reader rebuilds the index
+ * with one scan and ignores a truncated final record.
+ */
+inline constexpr uint32_t CAPTURE_VERSION = 1;
+inline constexpr size_t CAPTURE_FILE_HEADER_SIZE = 16;
+inline constexpr size_t CAPTURE_RECORD_HEADER_SIZE = 8;
+inline constexpr size_t CAPTURE_INDEX_ENTRY_SIZE = 24;
+inline constexpr size_t CAPTURE_TRAILER_SIZE = 24;
+
+/// Sparse index entry pointing at the record that starts a stride
+struct CaptureIndexEntry {
+    uint64_t timestamp;
+    /// File offset of the record
+    uint64_t offset;
+    uint32_t sequenceId;
+};
+
+struct CaptureOptions {
+    /// Records between sparse index entries
+    uint32_t indexInterval = 256;
+    /// Bytes buffered before they are written to the file
+    size_t bufferSize = 1 << 20;
+};
+
+/// Timestamp carried by the message itself, if its type has one
+std::optional<uint64_t> messageTimestamp(uint8_t commandId, std::span<const uint8_t> payload);
+
+/**
+ * Append-only capture writer.
+ *
+ * Records are encoded into one reused buffer and written in large chunks.
+ * A record's timestamp is the explicit argument if given, otherwise
+ * messageTimestamp(), otherwise the previous record's timestamp. One earlier
+ * than the previous record's (a late message, another device's clock) is
+ * raised to it, so that timestamps stay non-decreasing for seekTime().
+ */
+class CaptureWriter {
+public:
+    explicit CaptureWriter(const std::string& path, CaptureOptions options = {});
+    ~CaptureWriter();
+
+    CaptureWriter(const CaptureWriter&) = delete;
+    CaptureWriter& operator=(const CaptureWriter&) = delete;
+
+    /// Appends an encoded frame: ${header} followed by exactly payload_length bytes
+    void append(std::span<const uint8_t> frame, std::optional<uint64_t> timestamp = std::nullopt);
+
+    /// Encodes header and message straight into the write buffer; magic, command_id and payload_length are filled in
+    template<typename T>
+    void append(${header} header, const T& message, std::optional<uint64_t> timestamp = std::nullopt) {
+        checkLengthPrefixes(message);
+        const size_t payloadSize = encodedSize(message);
+        header.magic = ${header}::MAGIC;
+        header.command_id = MessageTraits<T>::COMMAND_ID;
+        header.payload_length = static_cast<decltype(header.payload_length)>(payloadSize);
+        std::span<uint8_t> frame = beginRecord(${header}::ENCODED_SIZE + payloadSize);
+        serializeInto(header, frame);
+        serializeInto(message, frame.subspan(${header}::ENCODED_SIZE));${sealing}
+        finishRecord(frame, timestamp);
+    }
+
+    /// Writes buffered records to the file
+    void flush();
+
+    /// Flushes and writes the index and trailer; further appends throw
+    void close();
+
+    uint64_t records() const { return records_; }
+
+private:
+    std::span<uint8_t> beginRecord(size_t frameSize);
+    void finishRecord(std::span<const uint8_t> frame, std::optional<uint64_t> timestamp);
+    void writeAll(std::span<const uint8_t> bytes);
+
+    int fd_ = -1;
+    CaptureOptions options_;
+    BinaryWriter buffer_;
+    std::vector<CaptureIndexEntry> index_;
+    /// Bytes already written to the file
+    uint64_t written_ = 0;
+    uint64_t records_ = 0;
+    uint64_t lastTimestamp_ = 0;
+};
+
+/// A recorded frame; spans borrow from the mapped file
+struct CapturedFrame {
+    uint64_t timestamp;
+    ${header} header;
+    std::span<const uint8_t> payload;
+    /// ${header} and payload as captured
+    std::span<const uint8_t> bytes;
+};
+
+/**
+ * Read-only view of a capture file through mmap.
+ *
+ * Iteration decodes only each ${header}; payloads are handed out in place.
+ * seekSequence() and seekTime() binary-search the sparse index and then step
+ * over at most one index stride of headers, assuming sequence IDs and
+ * timestamps are non-decreasing as written.
+ */
+class CaptureReader {
+public:
+    class Iterator {
+    public:
+        Iterator(const uint8_t* position, const uint8_t* end) : position_(position), end_(end) { load(); }
+        const CapturedFrame& operator*() const { return frame_; }
+        const CapturedFrame* operator->() const { return &frame_; }
+        Iterator& operator++() {
+            position_ = frame_.bytes.data() + frame_.bytes.size();
+            load();
+            return *this;
+        }
+        bool operator==(const Iterator& other) const { return position_ == other.position_; }
+        bool operator!=(const Iterator& other) const { return position_ != other.position_; }
+
+    private:
+        void load();
+
+        const uint8_t* position_;
+        const uint8_t* end_;
+        CapturedFrame frame_{};
+    };
+
+    explicit CaptureReader(const std::string& path);
+    ~CaptureReader();
+
+    CaptureReader(const CaptureReader&) = delete;
+    CaptureReader& operator=(const CaptureReader&) = delete;
+
+    Iterator begin() const { return Iterator(data_ + CAPTURE_FILE_HEADER_SIZE, data_ + recordsEnd_); }
+    Iterator end() const { return Iterator(data_ + recordsEnd_, data_ + recordsEnd_); }
+
+    /// First record whose sequence_id is >= sequenceId
+    Iterator seekSequence(uint32_t sequenceId) const;
+
+    /// First record whose timestamp is >= timestamp
+    Iterator seekTime(uint64_t timestamp) const;
+
+    std::span<const CaptureIndexEntry> index() const { return index_; }
+
+    /// False when the file had no trailer and the index was rebuilt by scanning
+    bool hasStoredIndex() const { return storedIndex_; }
+
+private:
+    Iterator at(uint64_t offset) const { return Iterator(data_ + offset, data_ + recordsEnd_); }
+    bool loadStoredIndex();
+    void rebuildIndex();
+
+    const uint8_t* data_ = nullptr;
+    size_t size_ = 0;
+    /// Offset one past the last complete record
+    size_t recordsEnd_ = 0;
+    std::vector<CaptureIndexEntry> index_;
+    bool storedIndex_ = false;
+};
+
+} // namespace ${ns}
+
+#endif // BINARY_PROTOCOL_CAPTURE_HPP`;
+}
+
+export function generateCaptureImpl(ir: SchemaIR, layout: FrameHeaderLayout, ns: string): string {
+  const header = layout.model.name;
+  const sequenceField = layout.model.fields.find(f => f.name === 'sequence_id')!.name;
+
+  const cases = findTimestampSources(ir).map(source => {
+    const endian = source.model.endian === 'big' ? 'Endian::Big' : 'Endian::Little';
+    const guard = source.arrayPrefix
+      ? `
+        if (payload.size() < ${source.arrayPrefix.offset} + sizeof(${source.arrayPrefix.type}) ||
+            detail::load<${endian}, ${source.arrayPrefix.type}>(payload.data() + ${source.arrayPrefix.offset}) < ${source.arrayPrefix.elementSize}) {
+            return std::nullopt;
+        }`
+      : '';
+    return `    case ${source.model.name}::COMMAND_ID: {${guard}
+        return loadTimestamp<${endian}>(payload, ${source.offset});
+    }`;
+  });
+
+  return `/**
+ * Auto-generated capture file implementation
+ */
+
+#include "capture.hpp"
+
+#include <algorithm>
+#include <array>
+#include <cerrno>
+#include <cstring>
+#include <stdexcept>
+#include <system_error>
+#include <utility>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace ${ns} {
+
+namespace {
+
+constexpr std::array<uint8_t, 8> FILE_MAGIC = {'T', 'B', 'S', 'C', 'A', 'P', '0', '1'};
+constexpr std::array<uint8_t, 8> TRAILER_MAGIC = {'T', 'B', 'S', 'I', 'D', 'X', '0', '1'};
+constexpr size_t HEADER_SIZE = ${header}::ENCODED_SIZE;
+
+template<Endian E>
+std::optional<uint64_t> loadTimestamp(std::span<const uint8_t> payload, size_t offset) {
+    if (payload.size() < offset + sizeof(uint64_t)) return std::nullopt;
+    return detail::load<E, uint64_t>(payload.data() + offset);
+}
+
+void encodeIndexEntry(uint8_t* out, const CaptureIndexEntry& entry) {
+    detail::store<Endian::Little>(out, entry.timestamp);
+    detail::store<Endian::Little>(out + 8, entry.offset);
+    detail::store<Endian::Little>(out + 16, entry.sequenceId);
+    detail::store<Endian::Little>(out + 20, uint32_t{0});
+}
+
+CaptureIndexEntry decodeIndexEntry(const uint8_t* in) {
+    return {
+        detail::load<Endian::Little, uint64_t>(in),
+        detail::load<Endian::Little, uint64_t>(in + 8),
+        detail::load<Endian::Little, uint32_t>(in + 16),
+    };
+}
+
+/// Size of the complete record at offset, or 0 if it is truncated
+size_t recordSize(const uint8_t* data, size_t offset, size_t end) {
+    const size_t available = end - offset;
+    if (available < CAPTURE_RECORD_HEADER_SIZE + HEADER_SIZE) return 0;
+    const ${header} header = deserialize${header}(data + offset + CAPTURE_RECORD_HEADER_SIZE, HEADER_SIZE);
+    const size_t size = CAPTURE_RECORD_HEADER_SIZE + HEADER_SIZE + header.payload_length;
+    return size <= available ? size : 0;
+}
+
+} // namespace
+
+std::optional<uint64_t> messageTimestamp(uint8_t commandId, std::span<const uint8_t> payload) {
+    switch (commandId) {
+${cases.join('\n')}
+    default:
+        return std::nullopt;
+    }
+}
+
+// ============================================
+// CaptureWriter
+// ============================================
+
+CaptureWriter::CaptureWriter(const std::string& path, CaptureOptions options) : options_(options) {
+    if (options_.indexInterval == 0) BINARY_PROTOCOL_THROW(std::invalid_argument("Capture index interval must be positive"));
+    fd_ = ::open(path.c_str(), O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, 0644);
+    if (fd_ < 0) BINARY_PROTOCOL_THROW(std::system_error(errno, std::generic_category(), "Failed to open capture file " + path));
+
+    buffer_.reserve(options_.bufferSize);
+    std::span<uint8_t> fileHeader = buffer_.allocate(CAPTURE_FILE_HEADER_SIZE);
+    std::memcpy(fileHeader.data(), FILE_MAGIC.data(), FILE_MAGIC.size());
+    detail::store<Endian::Little>(fileHeader.data() + 8, CAPTURE_VERSION);
+    detail::store<Endian::Little>(fileHeader.data() + 12, uint32_t{0});
+}
+
+CaptureWriter::~CaptureWriter() {
+    if (fd_ < 0) return;
+#if BINARY_PROTOCOL_EXCEPTIONS
+    try {
+        close();
+    } catch (...) {
+        // Destructors must not throw; an unclosed file is still readable
+        if (fd_ >= 0) ::close(fd_);
+    }
+#else
+    close();
+#endif
+}
+
+void CaptureWriter::append(std::span<const uint8_t> frame, std::optional<uint64_t> timestamp) {
+    if (frame.size() < HEADER_SIZE) BINARY_PROTOCOL_THROW(std::runtime_error("Captured frame shorter than ${header}"));
+    // Readers step from record to record by payload_length, so a mismatch would misparse the rest of the file
+    const ${header} header = deserialize${header}(frame.data(), HEADER_SIZE);
+    if (frame.size() != HEADER_SIZE + header.payload_length) {
+        BINARY_PROTOCOL_THROW(std::runtime_error("Captured frame size does not match its payload_length"));
+    }
+    std::span<uint8_t> out = beginRecord(frame.size());
+    std::memcpy(out.data(), frame.data(), frame.size());
+    finishRecord(out, timestamp);
+}
+
+std::span<uint8_t> CaptureWriter::beginRecord(size_t frameSize) {
+    if (fd_ < 0) BINARY_PROTOCOL_THROW(std::runtime_error("Capture file is closed"));
+    const size_t size = CAPTURE_RECORD_HEADER_SIZE + frameSize;
+    if (buffer_.size() > 0 && buffer_.size() + size > options_.bufferSize) {
+        flush();
+    }
+    return buffer_.allocate(size).subspan(CAPTURE_RECORD_HEADER_SIZE);
+}
+
+void CaptureWriter::finishRecord(std::span<const uint8_t> frame, std::optional<uint64_t> timestamp) {
+    const ${header} header = deserialize${header}(frame.data(), frame.size());
+    if (!timestamp) {
+        timestamp = messageTimestamp(header.command_id, frame.subspan(HEADER_SIZE));
+    }
+    lastTimestamp_ = std::max(lastTimestamp_, timestamp.value_or(lastTimestamp_));
+
+    // The record header sits directly in front of the frame in the buffer
+    const size_t record = static_cast<size_t>(frame.data() - buffer_.view().data()) - CAPTURE_RECORD_HEADER_SIZE;
+    buffer_.patch<uint64_t>(record, lastTimestamp_);
+    if (records_ % options_.indexInterval == 0) {
+        index_.push_back({lastTimestamp_, written_ + record, header.${sequenceField}});
+    }
+    records_++;
+}
+
+void CaptureWriter::flush() {
+    if (fd_ < 0 || buffer_.size() == 0) return;
+    writeAll(buffer_.view());
+    written_ += buffer_.size();
+    buffer_.clear();
+}
+
+void CaptureWriter::close() {
+    if (fd_ < 0) return;
+    flush();
+
+    const uint64_t indexOffset = written_;
+    std::vector<uint8_t> footer(index_.size() * CAPTURE_INDEX_ENTRY_SIZE + CAPTURE_TRAILER_SIZE);
+    for (size_t i = 0; i < index_.size(); i++) {
+        encodeIndexEntry(footer.data() + i * CAPTURE_INDEX_ENTRY_SIZE, index_[i]);
+    }
+    uint8_t* trailer = footer.data() + index_.size() * CAPTURE_INDEX_ENTRY_SIZE;
+    detail::store<Endian::Little>(trailer, indexOffset);
+    detail::store<Endian::Little>(trailer + 8, static_cast<uint64_t>(index_.size()));
+    std::memcpy(trailer + 16, TRAILER_MAGIC.data(), TRAILER_MAGIC.size());
+    writeAll(footer);
+
+    const int fd = fd_;
+    fd_ = -1;
+    if (::close(fd) != 0) BINARY_PROTOCOL_THROW(std::system_error(errno, std::generic_category(), "Failed to close capture file"));
+}
+
+void CaptureWriter::writeAll(std::span<const uint8_t> bytes) {
+    while (!bytes.empty()) {
+        const ssize_t n = ::write(fd_, bytes.data(), bytes.size());
+        if (n < 0) {
+            if (errno == EINTR) continue;
+            BINARY_PROTOCOL_THROW(std::system_error(errno, std::generic_category(), "Failed to write capture file"));
+        }
+        bytes = bytes.subspan(static_cast<size_t>(n));
+    }
+}
+
+// ============================================
+// CaptureReader
+// ============================================
+
+void CaptureReader::Iterator::load() {
+    if (position_ == end_) return;
+    if (recordSize(position_, 0, static_cast<size_t>(end_ - position_)) == 0) {
+        BINARY_PROTOCOL_THROW(std::runtime_error("Truncated capture record"));
+    }
+    const ${header} header = deserialize${header}(position_ + CAPTURE_RECORD_HEADER_SIZE, HEADER_SIZE);
+    const uint8_t* frame = position_ + CAPTURE_RECORD_HEADER_SIZE;
+    frame_ = {
+        detail::load<Endian::Little, uint64_t>(position_),
+        header,
+        {frame + HEADER_SIZE, header.payload_length},
+        {frame, HEADER_SIZE + header.payload_length},
+    };
+}
+
+CaptureReader::CaptureReader(const std::string& path) {
+    const int fd = ::open(path.c_str(), O_RDONLY | O_CLOEXEC);
+    if (fd < 0) BINARY_PROTOCOL_THROW(std::system_error(errno, std::generic_category(), "Failed to open capture file " + path));
+
+    struct stat info {};
+    if (::fstat(fd, &info) != 0) {
+        const int error = errno;
+        ::close(fd);
+        BINARY_PROTOCOL_THROW(std::system_error(error, std::generic_category(), "Failed to stat capture file " + path));
+    }
+    size_ = static_cast<size_t>(info.st_size);
+    if (size_ < CAPTURE_FILE_HEADER_SIZE) {
+        ::close(fd);
+        BINARY_PROTOCOL_THROW(std::runtime_error("Not a capture file: " + path));
+    }
+
+    void* mapped = ::mmap(nullptr, size_, PROT_READ, MAP_SHARED, fd, 0);
+    const int error = errno;
+    ::close(fd);
+    if (mapped == MAP_FAILED) BINARY_PROTOCOL_THROW(std::system_error(error, std::generic_category(), "Failed to map capture file " + path));
+    data_ = static_cast<const uint8_t*>(mapped);
+    ::madvise(mapped, size_, MADV_SEQUENTIAL);
+
+    if (std::memcmp(data_, FILE_MAGIC.data(), FILE_MAGIC.size()) != 0 ||
+        detail::load<Endian::Little, uint32_t>(data_ + 8) != CAPTURE_VERSION) {
+        ::munmap(mapped, size_);
+        BINARY_PROTOCOL_THROW(std::runtime_error("Not a capture file: " + path));
+    }
+
+#if BINARY_PROTOCOL_EXCEPTIONS
+    try {
+        if (!loadStoredIndex()) rebuildIndex();
+    } catch (...) {
+        // The destructor does not run for a constructor that throws
+        ::munmap(mapped, size_);
+        throw;
+    }
+#else
+    if (!loadStoredIndex()) rebuildIndex();
+#endif
+}
+
+CaptureReader::~CaptureReader() {
+    if (data_) ::munmap(const_cast<uint8_t*>(data_), size_);
+}
+
+bool CaptureReader::loadStoredIndex() {
+    // A stored index is trusted only if the trailer is intact and every entry points at a record
+    if (size_ < CAPTURE_FILE_HEADER_SIZE + CAPTURE_TRAILER_SIZE) return false;
+    const uint8_t* trailer = data_ + size_ - CAPTURE_TRAILER_SIZE;
+    const uint64_t indexOffset = detail::load<Endian::Little, uint64_t>(trailer);
+    const uint64_t entries = detail::load<Endian::Little, uint64_t>(trailer + 8);
+    if (std::memcmp(trailer + 16, TRAILER_MAGIC.data(), TRAILER_MAGIC.size()) != 0 ||
+        indexOffset < CAPTURE_FILE_HEADER_SIZE || indexOffset > size_ - CAPTURE_TRAILER_SIZE ||
+        entries > (size_ - CAPTURE_TRAILER_SIZE - indexOffset) / CAPTURE_INDEX_ENTRY_SIZE ||
+        indexOffset + entries * CAPTURE_INDEX_ENTRY_SIZE != size_ - CAPTURE_TRAILER_SIZE) {
+        return false;
+    }
+
+    std::vector<CaptureIndexEntry> index;
+    index.reserve(entries);
+    for (uint64_t i = 0; i < entries; i++) {
+        const CaptureIndexEntry entry = decodeIndexEntry(data_ + indexOffset + i * CAPTURE_INDEX_ENTRY_SIZE);
+        if (entry.offset < CAPTURE_FILE_HEADER_SIZE || entry.offset >= indexOffset ||
+            recordSize(data_, entry.offset, indexOffset) == 0) {
+            return false;
+        }
+        const ${header} header = deserialize${header}(data_ + entry.offset + CAPTURE_RECORD_HEADER_SIZE, HEADER_SIZE);
+        if (entry.timestamp != detail::load<Endian::Little, uint64_t>(data_ + entry.offset) ||
+            entry.sequenceId != header.${sequenceField}) {
+            return false;
+        }
+        if (!index.empty()) {
+            const CaptureIndexEntry& previous = index.back();
+            if (entry.offset <= previous.offset || entry.timestamp < previous.timestamp ||
+                entry.sequenceId < previous.sequenceId) {
+                return false;
+            }
+        }
+        index.push_back(entry);
+    }
+    index_ = std::move(index);
+    recordsEnd_ = indexOffset;
+    storedIndex_ = true;
+    return true;
+}
+
+void CaptureReader::rebuildIndex() {
+    size_t offset = CAPTURE_FILE_HEADER_SIZE;
+    uint64_t records = 0;
+    while (const size_t size = recordSize(data_, offset, size_)) {
+        if (records % CaptureOptions{}.indexInterval == 0) {
+            const ${header} header = deserialize${header}(data_ + offset + CAPTURE_RECORD_HEADER_SIZE, HEADER_SIZE);
+            index_.push_back({detail::load<Endian::Little, uint64_t>(data_ + offset), offset, header.${sequenceField}});
+        }
+        offset += size;
+        records++;
+    }
+    recordsEnd_ = offset;
+}
+
+CaptureReader::Iterator CaptureReader::seekSequence(uint32_t sequenceId) const {
+    // Start from the last stride that begins before sequenceId and step within it
+    auto stride = std::lower_bound(index_.begin(), index_.end(), sequenceId,
+        [](const CaptureIndexEntry& entry, uint32_t value) { return entry.sequenceId < value; });
+    Iterator it = stride == index_.begin() ? begin() : at(std::prev(stride)->offset);
+    const Iterator last = end();
+    while (it != last && it->header.${sequenceField} < sequenceId) ++it;
+    return it;
+}
+
+CaptureReader::Iterator CaptureReader::seekTime(uint64_t timestamp) const {
+    // Strides are keyed by their first timestamp; equal timestamps may span several,
+    // so start from the last stride that begins strictly earlier
+    auto stride = std::lower_bound(index_.begin(), index_.end(), timestamp,
+        [](const CaptureIndexEntry& entry, uint64_t value) { return entry.timestamp < value; });
+    Iterator it = stride == index_.begin() ? begin() : at(std::prev(stride)->offset);
+    const Iterator last = end();
+    while (it != last && it->timestamp < timestamp) ++it;
+    return it;
+}
+
+} // namespace ${ns}`;
+}
+
+/**
+ * キャプチャファイルの回帰テスト（test_capture.cpp）
+ * 書き込んだフレームの読み戻し、seekTime/seekSequence と線形走査の一致、
+ * 末尾の欠けたファイルや壊れたトレーラー/インデックスでの走査へのフォールバックを確認する
+ */
+export function generateCaptureTest(layout: FrameHeaderLayout, ns: string): string {
+  const header = layout.model.name;
+  const magic = layout.magicField.name;
+  const seal = layout.checksum
+    ? `
+        sealFrame(header, payload);`
+    : '';
+
+  return `/**
+ * Auto-generated capture file test
+ *
+ *     test_capture [--iterations N] [--seed S]
+ *
+ * Writes N random frames through both CaptureWriter::append overloads, with
+ * timestamps that sometimes run backwards, and reads them back: iteration must
+ * return every record intact and seekTime()/seekSequence() must agree with a
+ * linear scan. Damaged copies of the file (truncated before the trailer, a
+ * trailer or index entries pointing outside the records) must be read by
+ * scanning instead of trusting the stored index.
+ */
+
+#include "capture.hpp"
+#include "test_codec.hpp"
+
+#include <algorithm>
+#include <cinttypes>
+#include <cstdio>
+#include <cstdlib>
+#include <filesystem>
+#include <fstream>
+#include <iterator>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include <unistd.h>
+
+using namespace ${ns};
+using namespace ${ns}::testing;
+
+namespace {
+
+using Sequence = decltype(${header}::sequence_id);
+
+struct Options {
+    uint64_t iterations = 2000;
+    uint64_t seed = 1;
+};
+
+bool fail(const char* test, const char* check, const Options& options, uint64_t iteration) {
+    std::fprintf(stderr, "FAIL %s: %s (seed %" PRIu64 ", iteration %" PRIu64 ")\\n", test, check, options.seed, iteration);
+    return false;
+}
+
+/// Larger payloads are redrawn so the files stay small
+constexpr size_t MAX_TEST_PAYLOAD = 1024;
+
+/// What the reader should return for one record
+struct Record {
+    uint64_t timestamp;
+    Sequence sequence;
+    std::vector<uint8_t> frame;
+};
+
+/// File in the temporary directory, removed when the test is done with it
+class TempFile {
+public:
+    explicit TempFile(std::string_view name)
+        : path_((std::filesystem::temp_directory_path()
+                 / ("binary_protocol_" + std::to_string(::getpid()) + "_" + std::string(name) + ".cap")).string()) {}
+    ~TempFile() { std::remove(path_.c_str()); }
+
+    TempFile(const TempFile&) = delete;
+    TempFile& operator=(const TempFile&) = delete;
+
+    const std::string& path() const { return path_; }
+
+private:
+    std::string path_;
+};
+
+std::vector<uint8_t> readFile(const std::string& path) {
+    std::ifstream in(path, std::ios::binary);
+    return {std::istreambuf_iterator<char>(in), std::istreambuf_iterator<char>()};
+}
+
+void writeFile(const std::string& path, std::span<const uint8_t> bytes) {
+    std::ofstream out(path, std::ios::binary | std::ios::trunc);
+    out.write(reinterpret_cast<const char*>(bytes.data()), static_cast<std::streamsize>(bytes.size()));
+}
+
+/// Frame as the typed CaptureWriter::append encodes it
+std::vector<uint8_t> frameOf(${header} header, const Message& message) {
+    return std::visit([&](const auto& value) {
+        const std::vector<uint8_t> payload = serialize(value);
+        header.${magic} = ${header}::MAGIC;
+        header.command_id = MessageTraits<std::decay_t<decltype(value)>>::COMMAND_ID;
+        header.payload_length = static_cast<decltype(header.payload_length)>(payload.size());${seal}
+        std::vector<uint8_t> frame = serialize(header);
+        frame.insert(frame.end(), payload.begin(), payload.end());
+        return frame;
+    }, message);
+}
+
+std::vector<Record> writeCapture(const std::string& path, Random& rng, uint64_t count, uint32_t indexInterval) {
+    CaptureWriter writer(path, {.indexInterval = indexInterval, .bufferSize = 4096});
+    std::vector<Record> records;
+    uint64_t clock = 1000;
+    uint64_t last = 0;
+    Sequence sequence = 0;
+    for (uint64_t i = 0; i < count; i++) {
+        Message message;
+        std::vector<uint8_t> frame;
+        ${header} header{};
+        header.sequence_id = sequence;
+        do {
+            message = randomMessage(rng);
+            frame = frameOf(header, message);
+        } while (frame.size() > ${header}::ENCODED_SIZE + MAX_TEST_PAYLOAD);
+        const uint8_t commandId = deserialize${header}(frame.data(), ${header}::ENCODED_SIZE).command_id;
+        const std::span<const uint8_t> payload = std::span<const uint8_t>(frame).subspan(${header}::ENCODED_SIZE);
+
+        // Mostly advancing, sometimes late, and sometimes left to the writer when the message carries none
+        std::optional<uint64_t> timestamp;
+        const uint64_t choice = rng.below(8);
+        if (choice == 0 && !messageTimestamp(commandId, payload)) {
+            timestamp = std::nullopt;
+        } else if (choice == 1) {
+            timestamp = clock - rng.below(200);
+        } else {
+            clock += rng.below(20);
+            timestamp = clock;
+        }
+        last = std::max(last, timestamp.value_or(last));
+
+        if (rng.boolean()) {
+            std::visit([&](const auto& value) { writer.append(header, value, timestamp); }, message);
+        } else {
+            writer.append(frame, timestamp);
+        }
+        records.push_back({last, sequence, std::move(frame)});
+        sequence += static_cast<Sequence>(rng.below(3));
+    }
+    writer.close();
+    return records;
+}
+
+/// Iterator at records[index] of reader, or end() past the last record
+bool isAt(const CaptureReader& reader, const CaptureReader::Iterator& it, std::span<const uint8_t* const> positions, size_t index) {
+    return index == positions.size() ? it == reader.end() : it != reader.end() && it->bytes.data() == positions[index];
+}
+
+/// Every record intact and in order; exact also requires nothing after them
+bool checkRecords(const char* test, const CaptureReader& reader, const std::vector<Record>& records, bool exact,
+                  const Options& options, std::vector<const uint8_t*>& positions) {
+    positions.clear();
+    for (const CapturedFrame& frame : reader) {
+        if (positions.size() < records.size()) {
+            const Record& record = records[positions.size()];
+            if (frame.timestamp != record.timestamp) return fail(test, "record timestamp differs", options, positions.size());
+            if (!std::ranges::equal(frame.bytes, record.frame)) return fail(test, "record bytes differ", options, positions.size());
+        } else if (exact) {
+            return fail(test, "records after the last one written", options, positions.size());
+        }
+        positions.push_back(frame.bytes.data());
+    }
+    if (positions.size() < records.size()) return fail(test, "records missing", options, positions.size());
+    positions.resize(records.size());
+    return true;
+}
+
+/// seekTime() and seekSequence() against a linear scan of records
+bool checkSeeks(const char* test, const CaptureReader& reader, const std::vector<Record>& records,
+                std::span<const uint8_t* const> positions, Random& rng, const Options& options) {
+    const uint64_t lastTimestamp = records.empty() ? 0 : records.back().timestamp;
+    const uint64_t lastSequence = records.empty() ? 0 : records.back().sequence;
+    for (uint64_t i = 0; i < 200; i++) {
+        const uint64_t timestamp = rng.below(lastTimestamp + 2);
+        const size_t byTime = static_cast<size_t>(std::ranges::find_if(records,
+            [&](const Record& record) { return record.timestamp >= timestamp; }) - records.begin());
+        if (!isAt(reader, reader.seekTime(timestamp), positions, byTime)) return fail(test, "seekTime disagrees with a linear scan", options, i);
+
+        const Sequence sequence = static_cast<Sequence>(rng.below(lastSequence + 2));
+        const size_t bySequence = static_cast<size_t>(std::ranges::find_if(records,
+            [&](const Record& record) { return record.sequence >= sequence; }) - records.begin());
+        if (!isAt(reader, reader.seekSequence(sequence), positions, bySequence)) return fail(test, "seekSequence disagrees with a linear scan", options, i);
+    }
+    return true;
+}
+
+bool runRoundTrip(const Options& options, uint32_t indexInterval) {
+    const std::string name = "round trip, index interval " + std::to_string(indexInterval);
+    Random rng(options.seed + indexInterval);
+    TempFile file("round_trip");
+    const std::vector<Record> records = writeCapture(file.path(), rng, options.iterations, indexInterval);
+
+    CaptureReader reader(file.path());
+    if (!reader.hasStoredIndex()) return fail(name.c_str(), "stored index rejected", options, 0);
+    std::vector<const uint8_t*> positions;
+    return checkRecords(name.c_str(), reader, records, true, options, positions)
+        && checkSeeks(name.c_str(), reader, records, positions, rng, options);
+}
+
+/// Records written with earlier timestamps than their predecessors are raised to them
+bool runLateTimestamps(const Options& options) {
+    TempFile file("late");
+    {
+        CaptureWriter writer(file.path(), {.indexInterval = 2});
+        Sequence sequence = 0;
+        for (const uint64_t timestamp : {100, 200, 50, 60, 300, 310}) {
+            ${header} header{};
+            header.sequence_id = sequence++;
+            writer.append(frameOf(header, Message{}), timestamp);
+        }
+    }
+    CaptureReader reader(file.path());
+    const uint64_t expected[] = {100, 200, 200, 200, 300, 310};
+    size_t index = 0;
+    for (const CapturedFrame& frame : reader) {
+        if (index == std::size(expected) || frame.timestamp != expected[index]) return fail("late timestamps", "timestamp not clamped", options, index);
+        index++;
+    }
+    const CaptureReader::Iterator it = reader.seekTime(150);
+    if (it == reader.end() || it->timestamp != 200 || it->header.sequence_id != 1) {
+        return fail("late timestamps", "seekTime(150) did not find the first record at 200", options, 0);
+    }
+    return true;
+}
+
+/// Damaged copies of a good file must be read by scanning, never by trusting the damage
+bool runDamaged(const Options& options) {
+    Random rng(options.seed ^ 0xDA);
+    TempFile original("original");
+    const std::vector<Record> records = writeCapture(original.path(), rng, std::max<uint64_t>(options.iterations, 4), 2);
+    const std::vector<uint8_t> bytes = readFile(original.path());
+    const size_t trailer = bytes.size() - CAPTURE_TRAILER_SIZE;
+    const uint64_t indexOffset = detail::load<Endian::Little, uint64_t>(bytes.data() + trailer);
+    std::vector<const uint8_t*> positions;
+
+    // Cut inside the last record: no trailer, and the partial record is dropped
+    {
+        TempFile file("truncated");
+        writeFile(file.path(), std::span<const uint8_t>(bytes).first(static_cast<size_t>(indexOffset) - 1));
+        CaptureReader reader(file.path());
+        const std::vector<Record> complete(records.begin(), records.end() - 1);
+        if (reader.hasStoredIndex()) return fail("truncated", "index trusted without a trailer", options, 0);
+        if (!checkRecords("truncated", reader, complete, true, options, positions)) return false;
+        if (!checkSeeks("truncated", reader, complete, positions, rng, options)) return false;
+    }
+
+    struct Damage {
+        const char* name;
+        size_t offset;
+        uint64_t value;
+    };
+    const size_t secondEntry = static_cast<size_t>(indexOffset) + CAPTURE_INDEX_ENTRY_SIZE;
+    const Damage damages[] = {
+        // entries * CAPTURE_INDEX_ENTRY_SIZE wraps around to fit exactly
+        {"trailer past the index", trailer, bytes.size() - 8},
+        {"entry inside the index", secondEntry + 8, indexOffset + 8},
+        {"entry beyond the file", secondEntry + 8, uint64_t{1} << 62},
+        {"entry inside a record", secondEntry + 8, detail::load<Endian::Little, uint64_t>(bytes.data() + secondEntry + 8) + 1},
+        {"entry timestamp", secondEntry, ~uint64_t{0}},
+    };
+    for (const Damage& damage : damages) {
+        std::vector<uint8_t> damaged = bytes;
+        detail::store<Endian::Little>(damaged.data() + damage.offset, damage.value);
+        if (damage.offset == trailer) {
+            detail::store<Endian::Little>(damaged.data() + trailer + 8, (~uint64_t{0} - 15) / CAPTURE_INDEX_ENTRY_SIZE);
+        }
+        TempFile file("damaged");
+        writeFile(file.path(), damaged);
+        CaptureReader reader(file.path());
+        if (reader.hasStoredIndex()) return fail(damage.name, "damaged index trusted", options, 0);
+        // The scan also reads the index bytes as records, so only the written ones are compared
+        if (!checkRecords(damage.name, reader, records, false, options, positions)) return false;
+        for (uint64_t i = 0; i < 64; i++) {
+            (void)reader.seekSequence(static_cast<Sequence>(rng.next()));
+            (void)reader.seekTime(rng.next());
+        }
+    }
+    return true;
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    Options options;
+    for (int i = 1; i < argc; i++) {
+        const std::string_view arg = argv[i];
+        if (arg == "--iterations" && i + 1 < argc) {
+            options.iterations = std::strtoull(argv[++i], nullptr, 10);
+        } else if (arg == "--seed" && i + 1 < argc) {
+            options.seed = std::strtoull(argv[++i], nullptr, 10);
+        } else {
+            std::fprintf(stderr, "usage: %s [--iterations N] [--seed S]\\n", argv[0]);
+            return 2;
+        }
+    }
+
+    bool ok = true;
+    for (const uint32_t indexInterval : {1u, 7u, 256u}) {
+        ok = runRoundTrip(options, indexInterval) && ok;
+    }
+    Options empty = options;
+    empty.iterations = 0;
+    ok = runRoundTrip(empty, 1) && ok;
+    ok = runLateTimestamps(options) && ok;
+    ok = runDamaged(options) && ok;
+    return ok ? 0 : 1;
+}
+`;
+}
@@ -0,0 +1,140 @@
+/**
+ * C++ 出力用 CMake プロジェクト生成
+ */
+
+/** ctest に登録するテスト実行ファイル */
+export interface CMakeTest {
+  /** ctest 上のテスト名 */
+  name: string;
+  /** ソース（拡張子を除いた名前が実行ファイル名になる） */
+  source: string;
+  /** ctest から渡す引数 */
+  args: string;
+  /** CMakeLists.txt に添えるコメント */
+  comment?: string;
+}
+
+export interface CMakeOptions {
+  /** ライブラリに含める翻訳単位 */
+  sources: string[];
+  /** ベンチマークのソース */
+  benchmarkSource: string;
+  /** ctest で実行するテスト */
+  tests: CMakeTest[];
+  /** libFuzzer ターゲットのソース（モデルごとにビルド） */
+  fuzzSource: string;
+  /** ファズ対象のモデル名 */
+  fuzzTargets: string[];
+  /** フレーム分割のファズターゲットを作るか */
+  fuzzFrames: boolean;
+}
+
+export function generateCMakeLists(options: CMakeOptions): string {
+  const sources = options.sources.map(source => `  ${source}`).join('\n');
+  const tests = options.tests.map(test => {
+    const target = test.source.replace(/\.cpp$/, '');
+    const comment = test.comment ? `\n  # ${test.comment}` : '';
+    return `
+  add_executable(${target} ${test.source})
+  target_link_libraries(${target} PRIVATE binary_protocol)${comment}
+  add_test(NAME ${test.name} COMMAND ${target} ${test.args})`;
+  }).join('');
+  const fuzzModels = options.fuzzTargets.join(' ');
+  const fuzzFrames = options.fuzzFrames
+    ? `
+  add_executable(fuzz_frames ${options.fuzzSource})
+  target_compile_definitions(fuzz_frames PRIVATE BINARY_PROTOCOL_FUZZ_FRAMES=1)
+  target_compile_options(fuzz_frames PRIVATE \${BINARY_PROTOCOL_FUZZ_FLAGS})
+  target_link_options(fuzz_frames PRIVATE \${BINARY_PROTOCOL_FUZZ_FLAGS})
+  target_link_libraries(fuzz_frames PRIVATE binary_protocol_fuzz)`
+    : '';
+
+  return `# Auto-generated build for the binary protocol library and its benchmarks
+cmake_minimum_required(VERSION 3.20)
+project(binary_protocol LANGUAGES CXX)
+
+if(NOT CMAKE_BUILD_TYPE AND NOT CMAKE_CONFIGURATION_TYPES)
+  set(CMAKE_BUILD_TYPE Release)
+endif()
+
+option(BINARY_PROTOCOL_BUILD_BENCHMARKS "Build the Google Benchmark suite" ON)
+option(BINARY_PROTOCOL_INSTRUMENTATION "Record per-command encode/decode counters and latency histograms" OFF)
+option(BINARY_PROTOCOL_VARINT_SWAR "Decode @compact varints with branch-free SWAR/PEXT instead of a byte loop" OFF)
+option(BINARY_PROTOCOL_BUILD_TESTS "Build the randomized round-trip and regression tests" ON)
+option(BINARY_PROTOCOL_BUILD_FUZZERS "Build a libFuzzer target per model (Clang only)" OFF)
+set(BINARY_PROTOCOL_SANITIZE "" CACHE STRING "Sanitizers for the library, tests and benchmarks, e.g. address,undefined or thread")
+
+set(BINARY_PROTOCOL_SOURCES
+${sources}
+)
+
+add_library(binary_protocol \${BINARY_PROTOCOL_SOURCES})
+target_include_directories(binary_protocol PUBLIC \${CMAKE_CURRENT_SOURCE_DIR})
+target_compile_features(binary_protocol PUBLIC cxx_std_20)
+
+find_package(Threads REQUIRED)
+# shm_open lives in librt before glibc 2.34
+find_library(BINARY_PROTOCOL_RT_LIBRARY rt)
+if(NOT BINARY_PROTOCOL_RT_LIBRARY)
+  set(BINARY_PROTOCOL_RT_LIBRARY "")
+endif()
+target_link_libraries(binary_protocol PUBLIC Threads::Threads \${BINARY_PROTOCOL_RT_LIBRARY})
+
+if(BINARY_PROTOCOL_INSTRUMENTATION)
+  target_compile_definitions(binary_protocol PUBLIC BINARY_PROTOCOL_INSTRUMENTATION=1)
+endif()
+if(BINARY_PROTOCOL_VARINT_SWAR)
+  target_compile_definitions(binary_protocol PUBLIC BINARY_PROTOCOL_VARINT_SWAR=1)
+endif()
+
+if(BINARY_PROTOCOL_SANITIZE)
+  # PUBLIC so every executable linked against the library is instrumented too
+  target_compile_options(binary_protocol PUBLIC -fsanitize=\${BINARY_PROTOCOL_SANITIZE} -fno-omit-frame-pointer)
+  target_link_options(binary_protocol PUBLIC -fsanitize=\${BINARY_PROTOCOL_SANITIZE})
+endif()
+
+if(BINARY_PROTOCOL_BUILD_TESTS)
+  enable_testing()${tests}
+endif()
+
+if(BINARY_PROTOCOL_BUILD_FUZZERS)
+  if(NOT CMAKE_CXX_COMPILER_ID MATCHES "Clang")
+    message(FATAL_ERROR "BINARY_PROTOCOL_BUILD_FUZZERS requires Clang (libFuzzer)")
+  endif()
+  # A sanitized, coverage-instrumented copy of the library so findings inside the codec are caught where they happen
+  set(BINARY_PROTOCOL_FUZZ_FLAGS -fsanitize=fuzzer,address,undefined -fno-sanitize-recover=undefined)
+  add_library(binary_protocol_fuzz STATIC \${BINARY_PROTOCOL_SOURCES})
+  target_include_directories(binary_protocol_fuzz PUBLIC \${CMAKE_CURRENT_SOURCE_DIR})
+  target_compile_features(binary_protocol_fuzz PUBLIC cxx_std_20)
+  target_compile_options(binary_protocol_fuzz PRIVATE -fsanitize=fuzzer-no-link,address,undefined)
+  target_link_libraries(binary_protocol_fuzz PUBLIC Threads::Threads \${BINARY_PROTOCOL_RT_LIBRARY})
+  foreach(model ${fuzzModels})
+    add_executable(fuzz_\${model} ${options.fuzzSource})
+    target_compile_definitions(fuzz_\${model} PRIVATE BINARY_PROTOCOL_FUZZ_MODEL=\${model})
+    target_compile_options(fuzz_\${model} PRIVATE \${BINARY_PROTOCOL_FUZZ_FLAGS})
+    target_link_options(fuzz_\${model} PRIVATE \${BINARY_PROTOCOL_FUZZ_FLAGS})
+    target_link_libraries(fuzz_\${model} PRIVATE binary_protocol_fuzz)
+  endforeach()${fuzzFrames}
+endif()
+
+if(BINARY_PROTOCOL_BUILD_BENCHMARKS)
+  find_package(benchmark QUIET)
+  if(benchmark_FOUND)
+    add_executable(protocol_bench ${options.benchmarkSource})
+    target_link_libraries(protocol_bench PRIVATE binary_protocol benchmark::benchmark)
+
+    # Machine-readable results to diff between generator versions
+    # (e.g. with compare.py from the Google Benchmark tools)
+    add_custom_target(bench_json
+      COMMAND protocol_bench
+        --benchmark_out=\${CMAKE_BINARY_DIR}/protocol_bench.json
+        --benchmark_out_format=json
+      DEPENDS protocol_bench
+      USES_TERMINAL
+    )
+  else()
+    message(STATUS "Google Benchmark not found; skipping protocol_bench")
+  endif()
+endif()
+`;
+}
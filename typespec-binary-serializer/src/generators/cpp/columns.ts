@@ -0,0 +1,758 @@
+/**
+ * C++ カラムナー（SoA）コンテナ生成
+ * 固定長モデル配列を列ごとの 64 バイト境界バッファに展開し、mmap で読めるカラムファイルに書き出す
+ */
+
+import { SchemaIR, ModelDefinition, FieldDefinition, PRIMITIVE_SIZES } from '../../ir/types.js';
+import { FlatField, findModel, flattenFixedFields } from './layout.js';
+
+const COLUMN_TYPES: Record<string, string> = {
+  uint8: 'uint8_t',
+  uint16: 'uint16_t',
+  uint32: 'uint32_t',
+  uint64: 'uint64_t',
+  int8: 'int8_t',
+  int16: 'int16_t',
+  int32: 'int32_t',
+  int64: 'int64_t',
+  float32: 'float',
+  float64: 'double',
+  bool: 'bool',
+};
+
+interface Column {
+  /** C++ の列名（ネストは _ で連結、例: position_x） */
+  name: string;
+  type: string;
+  leaf: FlatField;
+}
+
+/**
+ * 列の元になる配列フィールドを持つメッセージ（配列より前は固定長フィールドのみ）
+ */
+interface ColumnSource {
+  message: ModelDefinition;
+  field: FieldDefinition;
+  /** 長さプレフィックスのペイロード先頭からのオフセット */
+  prefixOffset: number;
+  prefixType: string;
+}
+
+export interface ColumnarModel {
+  element: ModelDefinition;
+  columns: Column[];
+  sources: ColumnSource[];
+}
+
+/**
+ * メッセージ内で長さプレフィックス付き配列の要素になっている固定長モデルを列挙
+ */
+export function findColumnarModels(ir: SchemaIR): ColumnarModel[] {
+  const result = new Map<string, ColumnarModel>();
+  for (const message of ir.models) {
+    if (message.commandId === undefined) continue;
+
+    let offset = 0;
+    for (const field of message.fields) {
+      const element = field.type.kind === 'array' && field.type.elementType
+        ? findModel(ir, field.type.elementType.name)
+        : undefined;
+      if (element && element.fixedSize !== undefined && field.size.lengthPrefixType) {
+        const columns = columnsOf(ir, element);
+        if (columns) {
+          const entry = result.get(element.name) ?? { element, columns, sources: [] };
+          entry.sources.push({ message, field, prefixOffset: offset, prefixType: `${field.size.lengthPrefixType}_t` });
+          result.set(element.name, entry);
+        }
+      }
+      // 可変長フィールド以降はオフセットが定まらない
+      if (field.size.fixedSize === undefined) break;
+      offset += field.size.fixedSize;
+    }
+  }
+  return [...result.values()];
+}
+
+/**
+ * 列に展開できるモデルの列一覧（固定長文字列・バイト列を含む場合は対象外）
+ */
+function columnsOf(ir: SchemaIR, element: ModelDefinition): Column[] | undefined {
+  const columns: Column[] = [];
+  for (const leaf of flattenFixedFields(ir, element)) {
+    const typeName = leaf.field.type.name;
+    const type = ir.enums.some(e => e.name === typeName) ? typeName : COLUMN_TYPES[typeName];
+    if (!type) return undefined;
+    columns.push({ name: leaf.path.replace(/\./g, '_'), type, leaf });
+  }
+  return columns;
+}
+
+/**
+ * ワイヤ上の 1 要素から列の値を読む式
+ */
+function loadExpression(ir: SchemaIR, column: Column, base: string): string {
+  const typeName = column.leaf.field.type.name;
+  const at = column.leaf.offset === 0 ? base : `${base} + ${column.leaf.offset}`;
+  if (typeName === 'bool') return `${base}[${column.leaf.offset}] != 0`;
+  if (ir.enums.some(e => e.name === typeName)) return `static_cast<${typeName}>(${base}[${column.leaf.offset}])`;
+
+  const endian = column.leaf.owner.endian === 'big' ? 'Endian::Big' : 'Endian::Little';
+  const bits = `uint${(PRIMITIVE_SIZES[typeName as keyof typeof PRIMITIVE_SIZES] ?? 1) * 8}_t`;
+  const loaded = `detail::load<${endian}, ${bits}>(${at})`;
+  if (column.type === bits) return loaded;
+  return `${typeName.startsWith('float') ? 'std::bit_cast' : 'static_cast'}<${column.type}>(${loaded})`;
+}
+
+/**
+ * 列構成の識別子（FNV-1a 64）。型・順序の異なるファイルを開かないために使う
+ */
+function layoutId(model: ColumnarModel): string {
+  const signature = `${model.element.name};${model.columns.map(c => `${c.name}:${c.leaf.field.type.name}`).join(';')}`;
+  let hash = 0xcbf29ce484222325n;
+  for (const byte of Buffer.from(signature, 'utf8')) {
+    hash = ((hash ^ BigInt(byte)) * 0x100000001b3n) & 0xffffffffffffffffn;
+  }
+  return `0x${hash.toString(16).toUpperCase().padStart(16, '0')}ULL`;
+}
+
+function generateModelDecls(model: ColumnarModel): string {
+  const name = model.element.name;
+  const columns = model.columns;
+
+  const viewFields = columns.map(c => `    std::span<const ${c.type}> ${c.name};`).join('\n');
+  const accessors = columns.map(c => `    std::span<const ${c.type}> ${c.name}() const { return ${c.name}_.view(); }`).join('\n');
+  const members = columns.map(c => `    detail::AlignedColumn<${c.type}> ${c.name}_;`).join('\n');
+  const sourceDecls = model.sources.map(s =>
+    `    /// Appends the ${s.field.name} of an encoded ${s.message.name} payload
+    DecodeResult<size_t> append${s.message.name}(std::span<const uint8_t> payload);`).join('\n\n');
+  const writerSources = model.sources.map(s =>
+    `    DecodeResult<size_t> append${s.message.name}(std::span<const uint8_t> payload) {
+        DecodeResult<size_t> rows = pending_.append${s.message.name}(payload);
+        if (pending_.size() >= rowsPerChunk_) flush();
+        return rows;
+    }`).join('\n\n');
+
+  return `/// Columns of ${name} rows; spans borrow from the container or the mapped file
+struct ${name}ColumnsView {
+    size_t rows = 0;
+${viewFields}
+};
+
+/**
+ * ${name} rows stored column by column. Every column starts on a
+ * COLUMN_ALIGNMENT boundary and holds naturally aligned values, so analytics
+ * loops over one column vectorise without gathers.
+ */
+class ${name}Columns {
+public:
+    static constexpr size_t COLUMN_COUNT = ${columns.length};
+    static constexpr uint64_t LAYOUT_ID = ${layoutId(model)};
+    /// Bytes per value of each column, in declaration order
+    static constexpr std::array<size_t, COLUMN_COUNT> COLUMN_SIZES = {${columns.map(c => `sizeof(${c.type})`).join(', ')}};
+
+    size_t size() const { return size_; }
+    bool empty() const { return size_ == 0; }
+    void reserve(size_t rows);
+    void clear();
+
+${accessors}
+
+    ${name}ColumnsView view() const;
+    ${name} row(size_t index) const;
+
+    void append(const ${name}& row);
+    void append(std::span<const ${name}> rows);
+
+    /// Appends encoded ${name} elements (a multiple of ${name}::ENCODED_SIZE bytes) one column at a time
+    DecodeResult<size_t> appendEncoded(std::span<const uint8_t> bytes);
+
+${sourceDecls}
+
+private:
+    size_t size_ = 0;
+${members}
+};
+
+/**
+ * Streams ${name} rows to a column file. Rows are collected in a
+ * ${name}Columns and written as one chunk every rowsPerChunk rows.
+ */
+class ${name}ColumnWriter {
+public:
+    explicit ${name}ColumnWriter(const std::string& path, size_t rowsPerChunk = 1 << 16)
+        : file_(path, ${name}Columns::LAYOUT_ID, ${name}Columns::COLUMN_SIZES), rowsPerChunk_(rowsPerChunk) {
+        if (rowsPerChunk_ == 0) BINARY_PROTOCOL_THROW(std::invalid_argument("rowsPerChunk must be positive"));
+    }
+    ~${name}ColumnWriter() {
+        if (!file_.isOpen()) return;
+#if BINARY_PROTOCOL_EXCEPTIONS
+        try {
+            close();
+        } catch (...) {
+            // Destructors must not throw; chunks already written stay readable
+        }
+#else
+        close();
+#endif
+    }
+
+    void append(const ${name}& row) {
+        pending_.append(row);
+        if (pending_.size() >= rowsPerChunk_) flush();
+    }
+
+${writerSources}
+
+    /// Writes the pending rows as a chunk
+    void flush();
+
+    /// Flushes and writes the chunk directory; later flushes throw
+    void close() {
+        flush();
+        file_.close();
+    }
+
+    uint64_t rows() const { return file_.rows() + pending_.size(); }
+
+private:
+    detail::ColumnFileWriter file_;
+    ${name}Columns pending_;
+    size_t rowsPerChunk_;
+};
+
+/// Read-only, memory-mapped ${name} column file
+class ${name}ColumnFile {
+public:
+    explicit ${name}ColumnFile(const std::string& path)
+        : file_(path, ${name}Columns::LAYOUT_ID, ${name}Columns::COLUMN_SIZES) {}
+
+    size_t chunkCount() const { return file_.chunks().size(); }
+    uint64_t rows() const { return file_.rows(); }
+    /// False when the file had no directory and its chunks were found by scanning
+    bool hasStoredIndex() const { return file_.hasStoredIndex(); }
+
+    ${name}ColumnsView chunk(size_t index) const;
+
+private:
+    detail::ColumnFile file_;
+};`;
+}
+
+function generateModelImpl(ir: SchemaIR, model: ColumnarModel): string {
+  const name = model.element.name;
+  const columns = model.columns;
+
+  const each = (f: (c: Column) => string) => columns.map(c => `    ${f(c)}`).join('\n');
+  const viewInit = (source: (c: Column, index: number) => string) =>
+    columns.map((c, i) => `    view.${c.name} = ${source(c, i)};`).join('\n');
+
+  const decodeColumns = columns.map(c => `    {
+        ${c.type}* out = ${c.name}_.extend(rows);
+        for (size_t i = 0; i < rows; i++) {
+            out[i] = ${loadExpression(ir, c, `in + i * ${name}::ENCODED_SIZE`)};
+        }
+    }`).join('\n');
+
+  const sources = model.sources.map(s => {
+    const prefixSize = PRIMITIVE_SIZES[s.field.size.lengthPrefixType as keyof typeof PRIMITIVE_SIZES];
+    const endian = s.message.endian === 'big' ? 'Endian::Big' : 'Endian::Little';
+    const start = s.prefixOffset + prefixSize;
+    return `DecodeResult<size_t> ${name}Columns::append${s.message.name}(std::span<const uint8_t> payload) {
+    // Only the fields up to ${s.field.name} are read; the rest of the payload is not validated
+    if (payload.size() < ${start}) return DecodeError::Truncated;
+    const size_t length = detail::load<${endian}, ${s.prefixType}>(payload.data() + ${s.prefixOffset});
+    if (payload.size() - ${start} < length) return DecodeError::LengthOverflow;
+    return appendEncoded(payload.subspan(${start}, length));
+}`;
+  }).join('\n\n');
+
+  return `// ============================================
+// ${name}Columns
+// ============================================
+
+void ${name}Columns::reserve(size_t rows) {
+${each(c => `${c.name}_.reserve(rows);`)}
+}
+
+void ${name}Columns::clear() {
+${each(c => `${c.name}_.clear();`)}
+    size_ = 0;
+}
+
+${name}ColumnsView ${name}Columns::view() const {
+    ${name}ColumnsView view;
+    view.rows = size_;
+${viewInit(c => `${c.name}_.view()`)}
+    return view;
+}
+
+${name} ${name}Columns::row(size_t index) const {
+    ${name} row{};
+${each(c => `row.${c.leaf.path} = ${c.name}_[index];`)}
+    return row;
+}
+
+void ${name}Columns::append(const ${name}& row) {
+${each(c => `${c.name}_.push_back(row.${c.leaf.path});`)}
+    size_++;
+}
+
+void ${name}Columns::append(std::span<const ${name}> rows) {
+    reserve(size_ + rows.size());
+${columns.map(c => `    {
+        ${c.type}* out = ${c.name}_.extend(rows.size());
+        for (size_t i = 0; i < rows.size(); i++) out[i] = rows[i].${c.leaf.path};
+    }`).join('\n')}
+    size_ += rows.size();
+}
+
+DecodeResult<size_t> ${name}Columns::appendEncoded(std::span<const uint8_t> bytes) {
+    if (bytes.size() % ${name}::ENCODED_SIZE != 0) return DecodeError::BadArrayLength;
+    const size_t rows = bytes.size() / ${name}::ENCODED_SIZE;
+    const uint8_t* in = bytes.data();
+    reserve(size_ + rows);
+    // One strided pass per column keeps each inner loop a single load/store stream
+${decodeColumns}
+    size_ += rows;
+    return rows;
+}
+
+${sources}
+
+void ${name}ColumnWriter::flush() {
+    if (pending_.empty()) return;
+    const std::array<std::span<const uint8_t>, ${name}Columns::COLUMN_COUNT> columns = {
+${columns.map(c => `        columnBytes(pending_.${c.name}()),`).join('\n')}
+    };
+    file_.writeChunk(pending_.size(), columns);
+    pending_.clear();
+}
+
+${name}ColumnsView ${name}ColumnFile::chunk(size_t index) const {
+    const detail::ColumnChunk& chunk = file_.chunks()[index];
+    ${name}ColumnsView view;
+    view.rows = chunk.rows;
+${viewInit((c, i) => `{reinterpret_cast<const ${c.type}*>(file_.column(index, ${i})), chunk.rows}`)}
+    return view;
+}`;
+}
+
+export function generateColumnsHeader(models: ColumnarModel[], ns: string): string {
+  return `/**
+ * Auto-generated columnar (structure-of-arrays) containers and column files
+ */
+
+#ifndef BINARY_PROTOCOL_COLUMNS_HPP
+#define BINARY_PROTOCOL_COLUMNS_HPP
+
+#include "protocol.hpp"
+
+#include <algorithm>
+#include <array>
+#include <cstdint>
+#include <cstring>
+#include <new>
+#include <span>
+#include <stdexcept>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace ${ns} {
+
+inline constexpr size_t COLUMN_ALIGNMENT = 64;
+
+/*
+ * Column file layout (values in native byte order, which is checked on open):
+ *
+ *   file header  "TBSCOL01", u32 version, u32 byte-order tag, u64 layout ID,
+ *                u32 column count, padded to 64 bytes
+ *   chunks       u64 rows, "TBSCHK01", padded to 64 bytes, then every
+ *                column, each padded to 64 bytes
+ *   directory    ColumnChunk per chunk
+ *   trailer      u64 directory offset, u64 chunk count, "TBSCIX01"
+ *
+ * The directory and trailer are written by close(). Without them the reader
+ * finds the chunks by walking their headers and ignores a truncated last one.
+ */
+inline constexpr uint32_t COLUMN_FILE_VERSION = 1;
+
+namespace detail {
+
+/**
+ * Column storage aligned to COLUMN_ALIGNMENT. Capacity grows by at least half
+ * and is rounded up to whole CHUNK_ROWS, so appending a stream of small
+ * payloads reallocates rarely.
+ */
+template<typename T>
+class AlignedColumn {
+    static_assert(std::is_trivially_copyable_v<T>, "Column values must be trivially copyable");
+
+public:
+    static constexpr size_t CHUNK_ROWS = 4096;
+
+    AlignedColumn() = default;
+    AlignedColumn(AlignedColumn&& other) noexcept
+        : data_(std::exchange(other.data_, nullptr)),
+          size_(std::exchange(other.size_, 0)),
+          capacity_(std::exchange(other.capacity_, 0)) {}
+    AlignedColumn& operator=(AlignedColumn&& other) noexcept {
+        std::swap(data_, other.data_);
+        std::swap(size_, other.size_);
+        std::swap(capacity_, other.capacity_);
+        return *this;
+    }
+    AlignedColumn(const AlignedColumn&) = delete;
+    AlignedColumn& operator=(const AlignedColumn&) = delete;
+    ~AlignedColumn() { release(data_); }
+
+    size_t size() const { return size_; }
+    size_t capacity() const { return capacity_; }
+    std::span<const T> view() const { return {data_, size_}; }
+    const T& operator[](size_t index) const { return data_[index]; }
+
+    void reserve(size_t rows) {
+        if (rows <= capacity_) return;
+        const size_t wanted = std::max(rows, capacity_ + capacity_ / 2);
+        const size_t capacity = (wanted + CHUNK_ROWS - 1) / CHUNK_ROWS * CHUNK_ROWS;
+        T* data = static_cast<T*>(::operator new(capacity * sizeof(T), std::align_val_t{COLUMN_ALIGNMENT}));
+        if (size_ != 0) std::memcpy(data, data_, size_ * sizeof(T));
+        release(data_);
+        data_ = data;
+        capacity_ = capacity;
+    }
+
+    /// Grows the column by rows values, left for the caller to fill
+    T* extend(size_t rows) {
+        reserve(size_ + rows);
+        T* out = data_ + size_;
+        size_ += rows;
+        return out;
+    }
+
+    void push_back(T value) { *extend(1) = value; }
+    void clear() { size_ = 0; }
+
+private:
+    static void release(T* data) {
+        if (data) ::operator delete(data, std::align_val_t{COLUMN_ALIGNMENT});
+    }
+
+    T* data_ = nullptr;
+    size_t size_ = 0;
+    size_t capacity_ = 0;
+};
+
+struct ColumnChunk {
+    /// File offset of the chunk header
+    uint64_t offset;
+    uint64_t rows;
+};
+
+/// Type-independent part of the column file writer
+class ColumnFileWriter {
+public:
+    ColumnFileWriter(const std::string& path, uint64_t layoutId, std::span<const size_t> columnSizes);
+    ~ColumnFileWriter();
+
+    ColumnFileWriter(const ColumnFileWriter&) = delete;
+    ColumnFileWriter& operator=(const ColumnFileWriter&) = delete;
+
+    /// Writes one chunk; columns[i] holds rows values of columnSizes[i] bytes
+    void writeChunk(uint64_t rows, std::span<const std::span<const uint8_t>> columns);
+    void close();
+
+    bool isOpen() const { return fd_ >= 0; }
+    uint64_t rows() const { return rows_; }
+
+private:
+    void writeAll(std::span<const uint8_t> bytes);
+    void padToAlignment();
+
+    int fd_ = -1;
+    std::vector<size_t> columnSizes_;
+    std::vector<ColumnChunk> chunks_;
+    uint64_t written_ = 0;
+    uint64_t rows_ = 0;
+};
+
+/// Type-independent part of the column file reader
+class ColumnFile {
+public:
+    ColumnFile(const std::string& path, uint64_t layoutId, std::span<const size_t> columnSizes);
+    ~ColumnFile();
+
+    ColumnFile(const ColumnFile&) = delete;
+    ColumnFile& operator=(const ColumnFile&) = delete;
+
+    std::span<const ColumnChunk> chunks() const { return chunks_; }
+    uint64_t rows() const { return rows_; }
+    bool hasStoredIndex() const { return storedIndex_; }
+
+    /// First value of a column in a chunk, aligned to COLUMN_ALIGNMENT
+    const uint8_t* column(size_t chunk, size_t column) const;
+
+private:
+    /// Size of the complete chunk at offset, or 0 if it is truncated or not a chunk
+    uint64_t chunkSize(uint64_t offset, uint64_t limit, uint64_t& rows) const;
+    void scanChunks();
+
+    const uint8_t* data_ = nullptr;
+    size_t size_ = 0;
+    std::vector<size_t> columnSizes_;
+    std::vector<ColumnChunk> chunks_;
+    uint64_t rows_ = 0;
+    bool storedIndex_ = false;
+};
+
+} // namespace detail
+
+${models.map(generateModelDecls).join('\n\n')}
+
+} // namespace ${ns}
+
+#endif // BINARY_PROTOCOL_COLUMNS_HPP`;
+}
+
+export function generateColumnsImpl(ir: SchemaIR, models: ColumnarModel[], ns: string): string {
+  return `/**
+ * Auto-generated columnar container and column file implementation
+ */
+
+#include "columns.hpp"
+
+#include <cerrno>
+#include <system_error>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace ${ns} {
+
+namespace {
+
+constexpr std::array<uint8_t, 8> FILE_MAGIC = {'T', 'B', 'S', 'C', 'O', 'L', '0', '1'};
+constexpr std::array<uint8_t, 8> CHUNK_MAGIC = {'T', 'B', 'S', 'C', 'H', 'K', '0', '1'};
+constexpr std::array<uint8_t, 8> TRAILER_MAGIC = {'T', 'B', 'S', 'C', 'I', 'X', '0', '1'};
+constexpr uint32_t BYTE_ORDER_TAG = 0x01020304;
+constexpr size_t FILE_HEADER_SIZE = COLUMN_ALIGNMENT;
+constexpr size_t CHUNK_HEADER_SIZE = COLUMN_ALIGNMENT;
+constexpr size_t DIRECTORY_ENTRY_SIZE = 16;
+constexpr size_t TRAILER_SIZE = 24;
+
+constexpr uint64_t alignUp(uint64_t value) {
+    return (value + COLUMN_ALIGNMENT - 1) / COLUMN_ALIGNMENT * COLUMN_ALIGNMENT;
+}
+
+template<typename T>
+std::span<const uint8_t> columnBytes(std::span<const T> column) {
+    return {reinterpret_cast<const uint8_t*>(column.data()), column.size_bytes()};
+}
+
+} // namespace
+
+namespace detail {
+
+// ============================================
+// ColumnFileWriter
+// ============================================
+
+ColumnFileWriter::ColumnFileWriter(const std::string& path, uint64_t layoutId, std::span<const size_t> columnSizes)
+    : columnSizes_(columnSizes.begin(), columnSizes.end()) {
+    fd_ = ::open(path.c_str(), O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, 0644);
+    if (fd_ < 0) BINARY_PROTOCOL_THROW(std::system_error(errno, std::generic_category(), "Failed to open column file " + path));
+
+    std::array<uint8_t, FILE_HEADER_SIZE> header{};
+    std::memcpy(header.data(), FILE_MAGIC.data(), FILE_MAGIC.size());
+    std::memcpy(header.data() + 8, &COLUMN_FILE_VERSION, sizeof(uint32_t));
+    std::memcpy(header.data() + 12, &BYTE_ORDER_TAG, sizeof(uint32_t));
+    std::memcpy(header.data() + 16, &layoutId, sizeof(uint64_t));
+    const uint32_t columnCount = static_cast<uint32_t>(columnSizes_.size());
+    std::memcpy(header.data() + 24, &columnCount, sizeof(uint32_t));
+    writeAll(header);
+}
+
+ColumnFileWriter::~ColumnFileWriter() {
+    if (fd_ >= 0) ::close(fd_);
+}
+
+void ColumnFileWriter::writeChunk(uint64_t rows, std::span<const std::span<const uint8_t>> columns) {
+    if (fd_ < 0) BINARY_PROTOCOL_THROW(std::runtime_error("Column file is closed"));
+    if (columns.size() != columnSizes_.size()) BINARY_PROTOCOL_THROW(std::invalid_argument("Column count mismatch"));
+
+    chunks_.push_back({written_, rows});
+    std::array<uint8_t, CHUNK_HEADER_SIZE> header{};
+    std::memcpy(header.data(), &rows, sizeof(uint64_t));
+    std::memcpy(header.data() + 8, CHUNK_MAGIC.data(), CHUNK_MAGIC.size());
+    writeAll(header);
+    for (size_t i = 0; i < columns.size(); i++) {
+        if (columns[i].size() != rows * columnSizes_[i]) BINARY_PROTOCOL_THROW(std::invalid_argument("Column length mismatch"));
+        writeAll(columns[i]);
+        padToAlignment();
+    }
+    rows_ += rows;
+}
+
+void ColumnFileWriter::close() {
+    if (fd_ < 0) return;
+
+    const uint64_t directoryOffset = written_;
+    std::vector<uint8_t> footer(chunks_.size() * DIRECTORY_ENTRY_SIZE + TRAILER_SIZE);
+    for (size_t i = 0; i < chunks_.size(); i++) {
+        std::memcpy(footer.data() + i * DIRECTORY_ENTRY_SIZE, &chunks_[i].offset, sizeof(uint64_t));
+        std::memcpy(footer.data() + i * DIRECTORY_ENTRY_SIZE + 8, &chunks_[i].rows, sizeof(uint64_t));
+    }
+    uint8_t* trailer = footer.data() + chunks_.size() * DIRECTORY_ENTRY_SIZE;
+    const uint64_t chunkCount = chunks_.size();
+    std::memcpy(trailer, &directoryOffset, sizeof(uint64_t));
+    std::memcpy(trailer + 8, &chunkCount, sizeof(uint64_t));
+    std::memcpy(trailer + 16, TRAILER_MAGIC.data(), TRAILER_MAGIC.size());
+    writeAll(footer);
+
+    const int fd = fd_;
+    fd_ = -1;
+    if (::close(fd) != 0) BINARY_PROTOCOL_THROW(std::system_error(errno, std::generic_category(), "Failed to close column file"));
+}
+
+void ColumnFileWriter::writeAll(std::span<const uint8_t> bytes) {
+    written_ += bytes.size();
+    while (!bytes.empty()) {
+        const ssize_t n = ::write(fd_, bytes.data(), bytes.size());
+        if (n < 0) {
+            if (errno == EINTR) continue;
+            BINARY_PROTOCOL_THROW(std::system_error(errno, std::generic_category(), "Failed to write column file"));
+        }
+        bytes = bytes.subspan(static_cast<size_t>(n));
+    }
+}
+
+void ColumnFileWriter::padToAlignment() {
+    static constexpr std::array<uint8_t, COLUMN_ALIGNMENT> zeros{};
+    writeAll(std::span<const uint8_t>(zeros).first(alignUp(written_) - written_));
+}
+
+// ============================================
+// ColumnFile
+// ============================================
+
+ColumnFile::ColumnFile(const std::string& path, uint64_t layoutId, std::span<const size_t> columnSizes)
+    : columnSizes_(columnSizes.begin(), columnSizes.end()) {
+    const int fd = ::open(path.c_str(), O_RDONLY | O_CLOEXEC);
+    if (fd < 0) BINARY_PROTOCOL_THROW(std::system_error(errno, std::generic_category(), "Failed to open column file " + path));
+
+    struct stat info {};
+    if (::fstat(fd, &info) != 0) {
+        const int error = errno;
+        ::close(fd);
+        BINARY_PROTOCOL_THROW(std::system_error(error, std::generic_category(), "Failed to stat column file " + path));
+    }
+    size_ = static_cast<size_t>(info.st_size);
+    if (size_ < FILE_HEADER_SIZE) {
+        ::close(fd);
+        BINARY_PROTOCOL_THROW(std::runtime_error("Not a column file: " + path));
+    }
+
+    void* mapped = ::mmap(nullptr, size_, PROT_READ, MAP_SHARED, fd, 0);
+    const int error = errno;
+    ::close(fd);
+    if (mapped == MAP_FAILED) BINARY_PROTOCOL_THROW(std::system_error(error, std::generic_category(), "Failed to map column file " + path));
+    data_ = static_cast<const uint8_t*>(mapped);
+
+    uint32_t version;
+    uint32_t byteOrder;
+    uint64_t fileLayout;
+    uint32_t columnCount;
+    std::memcpy(&version, data_ + 8, sizeof(uint32_t));
+    std::memcpy(&byteOrder, data_ + 12, sizeof(uint32_t));
+    std::memcpy(&fileLayout, data_ + 16, sizeof(uint64_t));
+    std::memcpy(&columnCount, data_ + 24, sizeof(uint32_t));
+    const char* problem = nullptr;
+    if (std::memcmp(data_, FILE_MAGIC.data(), FILE_MAGIC.size()) != 0 || version != COLUMN_FILE_VERSION) {
+        problem = "Not a column file: ";
+    } else if (byteOrder != BYTE_ORDER_TAG) {
+        problem = "Column file was written with a different byte order: ";
+    } else if (fileLayout != layoutId || columnCount != columnSizes_.size()) {
+        problem = "Column file holds a different column layout: ";
+    }
+    if (problem) {
+        ::munmap(mapped, size_);
+        BINARY_PROTOCOL_THROW(std::runtime_error(problem + path));
+    }
+
+    // A stored directory is trusted only if the trailer is intact and every chunk checks out
+    if (size_ >= FILE_HEADER_SIZE + TRAILER_SIZE) {
+        const uint8_t* trailer = data_ + size_ - TRAILER_SIZE;
+        uint64_t directoryOffset;
+        uint64_t chunkCount;
+        std::memcpy(&directoryOffset, trailer, sizeof(uint64_t));
+        std::memcpy(&chunkCount, trailer + 8, sizeof(uint64_t));
+        if (std::memcmp(trailer + 16, TRAILER_MAGIC.data(), TRAILER_MAGIC.size()) == 0 &&
+            directoryOffset >= FILE_HEADER_SIZE &&
+            chunkCount <= (size_ - TRAILER_SIZE - directoryOffset) / DIRECTORY_ENTRY_SIZE &&
+            directoryOffset + chunkCount * DIRECTORY_ENTRY_SIZE == size_ - TRAILER_SIZE) {
+            bool valid = true;
+            for (uint64_t i = 0; i < chunkCount && valid; i++) {
+                ColumnChunk chunk;
+                std::memcpy(&chunk.offset, data_ + directoryOffset + i * DIRECTORY_ENTRY_SIZE, sizeof(uint64_t));
+                uint64_t rows = 0;
+                valid = chunk.offset % COLUMN_ALIGNMENT == 0 && chunkSize(chunk.offset, directoryOffset, rows) != 0;
+                chunk.rows = rows;
+                chunks_.push_back(chunk);
+                rows_ += rows;
+            }
+            if (valid) {
+                storedIndex_ = true;
+                return;
+            }
+            chunks_.clear();
+            rows_ = 0;
+        }
+    }
+    scanChunks();
+}
+
+ColumnFile::~ColumnFile() {
+    if (data_) ::munmap(const_cast<uint8_t*>(data_), size_);
+}
+
+const uint8_t* ColumnFile::column(size_t chunk, size_t column) const {
+    const ColumnChunk& entry = chunks_[chunk];
+    uint64_t offset = entry.offset + CHUNK_HEADER_SIZE;
+    for (size_t i = 0; i < column; i++) {
+        offset += alignUp(entry.rows * columnSizes_[i]);
+    }
+    return data_ + offset;
+}
+
+uint64_t ColumnFile::chunkSize(uint64_t offset, uint64_t limit, uint64_t& rows) const {
+    if (offset > limit || limit - offset < CHUNK_HEADER_SIZE) return 0;
+    if (std::memcmp(data_ + offset + 8, CHUNK_MAGIC.data(), CHUNK_MAGIC.size()) != 0) return 0;
+    std::memcpy(&rows, data_ + offset, sizeof(uint64_t));
+
+    uint64_t size = CHUNK_HEADER_SIZE;
+    for (size_t column : columnSizes_) {
+        if (rows > (limit - offset - size) / column) return 0;
+        size += alignUp(rows * column);
+        if (size > limit - offset) return 0;
+    }
+    return size;
+}
+
+void ColumnFile::scanChunks() {
+    uint64_t offset = FILE_HEADER_SIZE;
+    uint64_t rows = 0;
+    while (const uint64_t size = chunkSize(offset, size_, rows)) {
+        chunks_.push_back({offset, rows});
+        rows_ += rows;
+        offset += size;
+    }
+}
+
+} // namespace detail
+
+${models.map(m => generateModelImpl(ir, m)).join('\n\n')}
+
+} // namespace ${ns}`;
+}
@@ -0,0 +1,710 @@
+/**
+ * C++ リクエスト/レスポンス対応付け生成
+ * 応答のコマンドIDは要求のコマンドIDに 0x80 を立てたもの、sequence_id は要求と同じ
+ * 送信中の要求をオープンアドレス法のテーブル（sequence_id がキー）と階層タイミングホイールで管理する
+ */
+
+import { SchemaIR, ModelDefinition } from '../../ir/types.js';
+import { FrameHeaderLayout } from './layout.js';
+import { messageModels } from './dispatch.js';
+
+/** 応答のコマンドIDに立つビット */
+const RESPONSE_FLAG = 0x80;
+
+export interface CommandPair {
+  command: ModelDefinition;
+  response: ModelDefinition;
+}
+
+/**
+ * 要求/応答の組（応答 = 要求 | 0x80）
+ */
+export function findCommandPairs(ir: SchemaIR): CommandPair[] {
+  const messages = messageModels(ir);
+  return messages
+    .filter(m => (m.commandId! & RESPONSE_FLAG) === 0)
+    .flatMap(command => {
+      const response = messages.find(m => m.commandId === (command.commandId! | RESPONSE_FLAG));
+      return response ? [{ command, response }] : [];
+    });
+}
+
+/**
+ * 対応付けを生成できるか（sequence_id を持つフレームヘッダー、要求/応答の組、ErrorCode::Timeout が必要）
+ */
+export function canGenerateCorrelation(ir: SchemaIR, layout: FrameHeaderLayout | undefined): boolean {
+  return layout !== undefined
+    && layout.model.fields.some(f => f.name === 'sequence_id')
+    && ir.enums.some(e => e.name === 'ErrorCode' && e.members.some(m => m.name === 'Timeout'))
+    && findCommandPairs(ir).length > 0;
+}
+
+export function generateCorrelationHeader(ir: SchemaIR, layout: FrameHeaderLayout, ns: string): string {
+  const header = layout.model.name;
+  const pairs = findCommandPairs(ir);
+  const cases = pairs.map(p => `    case ${p.command.name}::COMMAND_ID:`).join('\n');
+  const responseOf = pairs.map(p => `template<>
+struct ResponseOf<${p.command.name}> {
+    using type = ${p.response.name};
+};`).join('\n\n');
+
+  return `/**
+ * Auto-generated request/response correlation
+ * A response carries its request's command ID with RESPONSE_FLAG set and the
+ * request's sequence_id.
+ */
+
+#ifndef BINARY_PROTOCOL_CORRELATION_HPP
+#define BINARY_PROTOCOL_CORRELATION_HPP
+
+#include "protocol.hpp"
+
+#include <algorithm>
+#include <array>
+#include <bit>
+#include <chrono>
+#include <cstdint>
+#include <limits>
+#include <optional>
+#include <stdexcept>
+#include <utility>
+#include <vector>
+
+namespace ${ns} {
+
+/// Set in the command ID of every response
+inline constexpr uint8_t RESPONSE_FLAG = 0x${RESPONSE_FLAG.toString(16).toUpperCase()};
+
+/// True for command IDs that have a paired response message
+constexpr bool expectsResponse(uint8_t commandId) {
+    switch (commandId) {
+${cases}
+        return true;
+    default:
+        return false;
+    }
+}
+
+/// Response message type of a command
+template<typename Command>
+struct ResponseOf;
+
+${responseOf}
+
+using SequenceId = decltype(${header}::sequence_id);
+
+enum class TrackResult : uint8_t {
+    Tracked,
+    /// A request with the same sequence_id is still in flight
+    DuplicateSequence,
+    /// capacity() requests are already in flight
+    Full,
+    /// The command has no paired response
+    NoResponse,
+};
+
+struct CorrelatorStats {
+    uint64_t tracked = 0;
+    uint64_t matched = 0;
+    uint64_t timedOut = 0;
+    /// Responses with no request in flight under their sequence_id (late, duplicate or unsolicited)
+    uint64_t unmatched = 0;
+    /// Responses whose sequence_id is in flight for a different command
+    uint64_t mismatched = 0;
+};
+
+/// A request that got no response in time; error is always ErrorCode::Timeout
+template<typename Context>
+struct ExpiredRequest {
+    SequenceId sequenceId;
+    uint8_t commandId;
+    ErrorCode error;
+    Context context;
+};
+
+/**
+ * In-flight requests of one connection, keyed by sequence_id. Not thread-safe.
+ *
+ * Requests live in a pool allocated once by the constructor. A linearly probed
+ * index, at most half full and with backward-shift deletion so no tombstones
+ * build up, finds them by sequence_id; each one is also linked into a bucket
+ * of a 4-level, 256-slot hierarchical timing wheel. track(), match(), cancel()
+ * and the expiry of each request are O(1) regardless of how many are in flight.
+ */
+template<typename Context>
+class Correlator {
+public:
+    using Clock = std::chrono::steady_clock;
+
+    /// capacity: most requests in flight at once; tick: timeout resolution
+    explicit Correlator(size_t capacity,
+                        Clock::duration tick = std::chrono::milliseconds(1),
+                        Clock::time_point start = Clock::now());
+
+    /// Starts tracking a request sent with header; it expires timeout after now, rounded up to a tick
+    TrackResult track(const ${header}& header, Clock::duration timeout, Context context,
+                      Clock::time_point now = Clock::now());
+
+    /// Completes the request answered by a response header; nullopt for non-responses and if nothing matches
+    std::optional<Context> match(const ${header}& header);
+
+    /// Stops tracking a request without completing it
+    std::optional<Context> cancel(SequenceId sequenceId);
+
+    /// Expires every request due at now, calling onTimeout(ExpiredRequest<Context>&&) for each
+    template<typename OnTimeout>
+    size_t expire(Clock::time_point now, OnTimeout&& onTimeout);
+
+    /// Stops tracking everything, calling onRequest(sequenceId, commandId, Context&&) for each request
+    template<typename OnRequest>
+    size_t cancelAll(OnRequest&& onRequest);
+
+    bool contains(SequenceId sequenceId) const { return find(sequenceId) != NO_SLOT; }
+    size_t size() const { return size_; }
+    size_t capacity() const { return entries_.size(); }
+    const CorrelatorStats& stats() const { return stats_; }
+
+private:
+    static constexpr uint32_t NONE = std::numeric_limits<uint32_t>::max();
+    static constexpr size_t NO_SLOT = std::numeric_limits<size_t>::max();
+    static constexpr unsigned WHEEL_BITS = 8;
+    static constexpr unsigned WHEEL_LEVELS = 4;
+    static constexpr uint64_t WHEEL_SLOTS = uint64_t{1} << WHEEL_BITS;
+    /// Longest timeout in ticks; longer ones are clamped
+    static constexpr uint64_t MAX_TIMEOUT_TICKS = (uint64_t{1} << (WHEEL_BITS * WHEEL_LEVELS)) - 1;
+
+    struct Entry {
+        uint64_t deadline = 0;
+        /// Wheel bucket neighbours; next also links the free list
+        uint32_t prev = NONE;
+        uint32_t next = NONE;
+        uint32_t bucket = 0;
+        SequenceId sequenceId = 0;
+        uint8_t commandId = 0;
+        std::optional<Context> context;
+    };
+
+    struct Slot {
+        SequenceId sequenceId = 0;
+        /// NONE when the slot is empty
+        uint32_t entry = NONE;
+    };
+
+    size_t home(SequenceId sequenceId) const {
+        return static_cast<size_t>((uint64_t{sequenceId} * 0x9E3779B97F4A7C15ULL) >> shift_);
+    }
+
+    size_t find(SequenceId sequenceId) const;
+    void erase(size_t slot);
+    void link(uint32_t index);
+    void unlink(uint32_t index);
+    void release(uint32_t index);
+    void cascade(unsigned level);
+    uint64_t tickOf(Clock::time_point time) const;
+
+    Clock::time_point start_;
+    Clock::duration tick_;
+    /// Last tick the wheel has processed
+    uint64_t now_ = 0;
+
+    std::vector<Entry> entries_;
+    uint32_t free_ = NONE;
+    size_t size_ = 0;
+
+    std::vector<Slot> slots_;
+    size_t mask_ = 0;
+    unsigned shift_ = 0;
+
+    /// Level l, slot s at index l * WHEEL_SLOTS + s
+    std::array<uint32_t, WHEEL_LEVELS * WHEEL_SLOTS> buckets_;
+    CorrelatorStats stats_;
+};
+
+template<typename Context>
+Correlator<Context>::Correlator(size_t capacity, Clock::duration tick, Clock::time_point start)
+    : start_(start), tick_(tick) {
+    if (capacity == 0 || capacity >= NONE) {
+        BINARY_PROTOCOL_THROW(std::invalid_argument("Correlator capacity must be between 1 and 2^32 - 2"));
+    }
+    if (tick <= Clock::duration::zero()) {
+        BINARY_PROTOCOL_THROW(std::invalid_argument("Correlator tick must be positive"));
+    }
+    entries_.resize(capacity);
+    for (size_t i = 0; i + 1 < capacity; i++) {
+        entries_[i].next = static_cast<uint32_t>(i + 1);
+    }
+    free_ = 0;
+
+    const size_t tableSize = std::bit_ceil(capacity * 2);
+    slots_.resize(tableSize);
+    mask_ = tableSize - 1;
+    shift_ = 64 - static_cast<unsigned>(std::countr_zero(tableSize));
+    buckets_.fill(NONE);
+}
+
+template<typename Context>
+TrackResult Correlator<Context>::track(const ${header}& header, Clock::duration timeout, Context context,
+                                       Clock::time_point now) {
+    if (!expectsResponse(header.command_id)) return TrackResult::NoResponse;
+
+    size_t slot = home(header.sequence_id);
+    while (slots_[slot].entry != NONE) {
+        if (slots_[slot].sequenceId == header.sequence_id) return TrackResult::DuplicateSequence;
+        slot = (slot + 1) & mask_;
+    }
+    if (free_ == NONE) return TrackResult::Full;
+
+    const uint32_t index = free_;
+    Entry& entry = entries_[index];
+    free_ = entry.next;
+
+    const uint64_t ticks = timeout <= Clock::duration::zero()
+        ? 1
+        : static_cast<uint64_t>((timeout + tick_ - Clock::duration(1)) / tick_);
+    // Never behind the wheel, so a late track() still expires on the next expire()
+    const uint64_t deadline = std::max(tickOf(now) + ticks, now_ + 1);
+    entry.deadline = std::min(deadline, now_ + MAX_TIMEOUT_TICKS);
+    entry.sequenceId = header.sequence_id;
+    entry.commandId = header.command_id;
+    entry.context.emplace(std::move(context));
+
+    slots_[slot] = {header.sequence_id, index};
+    link(index);
+    size_++;
+    stats_.tracked++;
+    return TrackResult::Tracked;
+}
+
+template<typename Context>
+std::optional<Context> Correlator<Context>::match(const ${header}& header) {
+    if ((header.command_id & RESPONSE_FLAG) == 0) return std::nullopt;
+
+    const size_t slot = find(header.sequence_id);
+    if (slot == NO_SLOT) {
+        stats_.unmatched++;
+        return std::nullopt;
+    }
+    const uint32_t index = slots_[slot].entry;
+    if ((entries_[index].commandId | RESPONSE_FLAG) != header.command_id) {
+        stats_.mismatched++;
+        return std::nullopt;
+    }
+
+    std::optional<Context> context = std::move(entries_[index].context);
+    erase(slot);
+    unlink(index);
+    release(index);
+    stats_.matched++;
+    return context;
+}
+
+template<typename Context>
+std::optional<Context> Correlator<Context>::cancel(SequenceId sequenceId) {
+    const size_t slot = find(sequenceId);
+    if (slot == NO_SLOT) return std::nullopt;
+
+    const uint32_t index = slots_[slot].entry;
+    std::optional<Context> context = std::move(entries_[index].context);
+    erase(slot);
+    unlink(index);
+    release(index);
+    return context;
+}
+
+template<typename Context>
+template<typename OnTimeout>
+size_t Correlator<Context>::expire(Clock::time_point now, OnTimeout&& onTimeout) {
+    const uint64_t target = tickOf(now);
+    size_t expired = 0;
+    while (now_ < target) {
+        if (size_ == 0) {
+            now_ = target;
+            break;
+        }
+        now_++;
+        // Move the next span of each coarser level down, coarsest first
+        for (unsigned level = WHEEL_LEVELS - 1; level > 0; level--) {
+            if ((now_ & ((uint64_t{1} << (WHEEL_BITS * level)) - 1)) == 0) cascade(level);
+        }
+
+        // Unlinked one at a time so onTimeout may track, match or cancel other requests
+        const size_t bucket = static_cast<size_t>(now_ & (WHEEL_SLOTS - 1));
+        while (buckets_[bucket] != NONE) {
+            const uint32_t index = buckets_[bucket];
+            Entry& entry = entries_[index];
+            ExpiredRequest<Context> request{entry.sequenceId, entry.commandId, ErrorCode::Timeout, std::move(*entry.context)};
+            erase(find(entry.sequenceId));
+            unlink(index);
+            release(index);
+            stats_.timedOut++;
+            expired++;
+            onTimeout(std::move(request));
+        }
+    }
+    return expired;
+}
+
+template<typename Context>
+template<typename OnRequest>
+size_t Correlator<Context>::cancelAll(OnRequest&& onRequest) {
+    size_t cancelled = 0;
+    for (size_t bucket = 0; bucket < buckets_.size(); bucket++) {
+        while (buckets_[bucket] != NONE) {
+            const uint32_t index = buckets_[bucket];
+            Entry& entry = entries_[index];
+            const SequenceId sequenceId = entry.sequenceId;
+            const uint8_t commandId = entry.commandId;
+            Context context = std::move(*entry.context);
+            erase(find(sequenceId));
+            unlink(index);
+            release(index);
+            cancelled++;
+            onRequest(sequenceId, commandId, std::move(context));
+        }
+    }
+    return cancelled;
+}
+
+template<typename Context>
+size_t Correlator<Context>::find(SequenceId sequenceId) const {
+    for (size_t slot = home(sequenceId); slots_[slot].entry != NONE; slot = (slot + 1) & mask_) {
+        if (slots_[slot].sequenceId == sequenceId) return slot;
+    }
+    return NO_SLOT;
+}
+
+template<typename Context>
+void Correlator<Context>::erase(size_t slot) {
+    // Backward-shift deletion: pull later members of the probe run into the gap
+    for (size_t next = (slot + 1) & mask_; slots_[next].entry != NONE; next = (next + 1) & mask_) {
+        const size_t wanted = home(slots_[next].sequenceId);
+        if (((next - wanted) & mask_) >= ((next - slot) & mask_)) {
+            slots_[slot] = slots_[next];
+            slot = next;
+        }
+    }
+    slots_[slot].entry = NONE;
+}
+
+template<typename Context>
+void Correlator<Context>::link(uint32_t index) {
+    Entry& entry = entries_[index];
+    // The level is the highest 8-bit digit in which the deadline differs from now
+    const uint64_t differing = entry.deadline ^ now_;
+    unsigned level = 0;
+    while (level + 1 < WHEEL_LEVELS && (differing >> (WHEEL_BITS * (level + 1))) != 0) {
+        level++;
+    }
+    entry.bucket = static_cast<uint32_t>(level * WHEEL_SLOTS + ((entry.deadline >> (WHEEL_BITS * level)) & (WHEEL_SLOTS - 1)));
+
+    uint32_t& head = buckets_[entry.bucket];
+    entry.prev = NONE;
+    entry.next = head;
+    if (head != NONE) entries_[head].prev = index;
+    head = index;
+}
+
+template<typename Context>
+void Correlator<Context>::unlink(uint32_t index) {
+    Entry& entry = entries_[index];
+    if (entry.prev != NONE) {
+        entries_[entry.prev].next = entry.next;
+    } else {
+        buckets_[entry.bucket] = entry.next;
+    }
+    if (entry.next != NONE) entries_[entry.next].prev = entry.prev;
+}
+
+template<typename Context>
+void Correlator<Context>::release(uint32_t index) {
+    Entry& entry = entries_[index];
+    entry.context.reset();
+    entry.next = free_;
+    free_ = index;
+    size_--;
+}
+
+template<typename Context>
+void Correlator<Context>::cascade(unsigned level) {
+    const size_t bucket = level * WHEEL_SLOTS + static_cast<size_t>((now_ >> (WHEEL_BITS * level)) & (WHEEL_SLOTS - 1));
+    uint32_t index = buckets_[bucket];
+    buckets_[bucket] = NONE;
+    while (index != NONE) {
+        const uint32_t next = entries_[index].next;
+        link(index);
+        index = next;
+    }
+}
+
+template<typename Context>
+uint64_t Correlator<Context>::tickOf(Clock::time_point time) const {
+    return time <= start_ ? 0 : static_cast<uint64_t>((time - start_) / tick_);
+}
+
+} // namespace ${ns}
+
+#endif // BINARY_PROTOCOL_CORRELATION_HPP`;
+}
+
+/**
+ * 対応付けの回帰テスト（test_correlation.cpp）
+ * track/match/cancel/expire のランダム列を std::map の参照モデルと突き合わせ、
+ * コールバックからの再入と大量の要求の期限切れも確認する
+ */
+export function generateCorrelationTest(ir: SchemaIR, layout: FrameHeaderLayout, ns: string): string {
+  const header = layout.model.name;
+  const commands = messageModels(ir).map(m => `    ${m.name}::COMMAND_ID,`).join('\n');
+  const requests = findCommandPairs(ir).map(p => `    ${p.command.name}::COMMAND_ID,`).join('\n');
+
+  return `/**
+ * Auto-generated request/response correlation test
+ *
+ *     test_correlation [--iterations N] [--seed S]
+ *
+ * Runs random track/match/cancel/expire sequences against a std::map reference
+ * model: with one slot, with many, with occasional huge timeouts and clock jumps,
+ * and with sparse sequence_ids. Then checks that expire() callbacks may call back
+ * into the correlator and that a large population expires exactly on time.
+ */
+
+#include "correlation.hpp"
+#include "test_codec.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <cinttypes>
+#include <cstdio>
+#include <cstdlib>
+#include <iterator>
+#include <map>
+#include <memory>
+#include <string_view>
+
+using namespace ${ns};
+using namespace ${ns}::testing;
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+using std::chrono::milliseconds;
+
+/// Every command ID of the protocol
+constexpr uint8_t COMMANDS[] = {
+${commands}
+};
+
+/// Command IDs with a paired response
+constexpr uint8_t REQUESTS[] = {
+${requests}
+};
+
+const Clock::time_point START = Clock::time_point{} + std::chrono::hours(1);
+
+struct Options {
+    uint64_t iterations = 100000;
+    uint64_t seed = 1;
+};
+
+bool fail(const char* test, const char* check, const Options& options, uint64_t iteration) {
+    std::fprintf(stderr, "FAIL %s: %s (seed %" PRIu64 ", iteration %" PRIu64 ")\\n", test, check, options.seed, iteration);
+    return false;
+}
+
+${header} headerOf(uint8_t commandId, SequenceId sequenceId) {
+    ${header} header{};
+    header.command_id = commandId;
+    header.sequence_id = sequenceId;
+    return header;
+}
+
+bool hasResponse(uint8_t commandId) {
+    return std::ranges::find(REQUESTS, commandId) != std::end(REQUESTS);
+}
+
+struct Round {
+    const char* name;
+    size_t capacity;
+    /// Sometimes track with a timeout of days and jump the clock by hours
+    bool longTimeouts;
+    /// Spacing of sequence_ids, so large ones spread over the whole index
+    SequenceId stride;
+};
+
+/// A request in flight in the reference model
+struct Pending {
+    /// Tick at which it expires
+    uint64_t deadline;
+    uint8_t commandId;
+    uint64_t context;
+};
+
+bool runModel(const Round& round, const Options& options) {
+    using Context = std::unique_ptr<uint64_t>;
+    Random rng(options.seed ^ std::hash<std::string_view>{}(round.name));
+    Correlator<Context> correlator(round.capacity, milliseconds(1), START);
+    std::map<SequenceId, Pending> model;
+    CorrelatorStats expected;
+    uint64_t now = 0;
+    const char* failure = nullptr;
+
+    for (uint64_t i = 0; i < options.iterations; i++) {
+        const uint64_t op = rng.below(10);
+        const SequenceId sequence = static_cast<SequenceId>(rng.below(3000) * round.stride);
+        const auto found = model.find(sequence);
+        if (op < 5) {
+            const uint8_t command = COMMANDS[rng.below(std::size(COMMANDS))];
+            const uint64_t timeout = round.longTimeouts && rng.below(50) == 0 ? rng.below(100000000) : rng.below(700);
+            const TrackResult result = correlator.track(headerOf(command, sequence), milliseconds(timeout),
+                                                        std::make_unique<uint64_t>(i), START + milliseconds(now));
+            const TrackResult want = !hasResponse(command) ? TrackResult::NoResponse
+                : found != model.end() ? TrackResult::DuplicateSequence
+                : model.size() == round.capacity ? TrackResult::Full
+                : TrackResult::Tracked;
+            if (result != want) return fail(round.name, "track result differs from the model", options, i);
+            if (want == TrackResult::Tracked) {
+                model[sequence] = {now + std::max<uint64_t>(timeout, 1), command, i};
+                expected.tracked++;
+            }
+        } else if (op < 7) {
+            // Mostly the response to the tracked request, otherwise any response
+            const uint8_t command = found != model.end() && rng.below(4) != 0
+                ? found->second.commandId
+                : REQUESTS[rng.below(std::size(REQUESTS))];
+            const std::optional<Context> context = correlator.match(headerOf(command | RESPONSE_FLAG, sequence));
+            if (found != model.end() && command == found->second.commandId) {
+                if (!context || **context != found->second.context) return fail(round.name, "match missed a tracked request", options, i);
+                model.erase(found);
+                expected.matched++;
+            } else if (context) {
+                return fail(round.name, "match completed the wrong request", options, i);
+            }
+        } else if (op < 8) {
+            const std::optional<Context> context = correlator.cancel(sequence);
+            if (found != model.end()) {
+                if (!context || **context != found->second.context) return fail(round.name, "cancel missed a tracked request", options, i);
+                model.erase(found);
+            } else if (context) {
+                return fail(round.name, "cancel returned an untracked request", options, i);
+            }
+        } else {
+            now += round.longTimeouts && rng.below(100) == 0 ? rng.below(5000000) : rng.below(40);
+            correlator.expire(START + milliseconds(now), [&](ExpiredRequest<Context>&& request) {
+                const auto it = model.find(request.sequenceId);
+                if (it == model.end() || it->second.deadline > now) {
+                    failure = "expired a request before its deadline";
+                } else if (request.commandId != it->second.commandId || *request.context != it->second.context
+                           || request.error != ErrorCode::Timeout) {
+                    failure = "expired request differs from the model";
+                } else {
+                    model.erase(it);
+                    expected.timedOut++;
+                }
+            });
+            if (failure) return fail(round.name, failure, options, i);
+            for (const auto& [id, pending] : model) {
+                if (pending.deadline <= now) return fail(round.name, "request outlived its deadline", options, i);
+            }
+        }
+        if (correlator.size() != model.size()) return fail(round.name, "size differs from the model", options, i);
+    }
+
+    const CorrelatorStats& stats = correlator.stats();
+    if (stats.tracked != expected.tracked || stats.matched != expected.matched || stats.timedOut != expected.timedOut) {
+        return fail(round.name, "stats differ from the model", options, options.iterations);
+    }
+
+    const size_t inFlight = model.size();
+    const size_t cancelled = correlator.cancelAll([&](SequenceId id, uint8_t commandId, Context&& context) {
+        const auto it = model.find(id);
+        if (it == model.end() || commandId != it->second.commandId || *context != it->second.context) {
+            failure = "cancelAll returned a request the model does not have";
+        } else {
+            model.erase(it);
+        }
+    });
+    if (failure) return fail(round.name, failure, options, options.iterations);
+    if (cancelled != inFlight || !model.empty() || correlator.size() != 0) {
+        return fail(round.name, "cancelAll left requests in flight", options, options.iterations);
+    }
+    return true;
+}
+
+/// The first expiry cancels every other request due in the same tick and tracks a new one
+bool runReentrant(const Options& options) {
+    const uint8_t command = REQUESTS[0];
+    Correlator<uint64_t> correlator(16, milliseconds(1), START);
+    for (SequenceId id = 0; id < 8; id++) {
+        correlator.track(headerOf(command, id), milliseconds(5), id, START);
+    }
+
+    bool ok = true;
+    const size_t expired = correlator.expire(START + milliseconds(5), [&](ExpiredRequest<uint64_t>&& request) {
+        for (SequenceId id = 0; id < 8; id++) {
+            if (id != request.sequenceId) ok = correlator.cancel(id).has_value() && ok;
+        }
+        ok = correlator.track(headerOf(command, 100), milliseconds(1), 100, START + milliseconds(5)) == TrackResult::Tracked && ok;
+    });
+    if (!ok || expired != 1 || correlator.size() != 1) return fail("reentrant", "callback could not modify the correlator", options, 0);
+    if (correlator.expire(START + milliseconds(6), [](ExpiredRequest<uint64_t>&&) {}) != 1) {
+        return fail("reentrant", "request tracked from a callback did not expire", options, 1);
+    }
+    return correlator.size() == 0 || fail("reentrant", "requests left after expiry", options, 1);
+}
+
+/// Many requests in flight: half are answered, the rest expire together
+bool runScale(const Options& options) {
+    const uint8_t command = REQUESTS[0];
+    const SequenceId count = 100000;
+    Correlator<uint64_t> correlator(count, milliseconds(1), START);
+    for (SequenceId id = 0; id < count; id++) {
+        if (correlator.track(headerOf(command, id * 7), milliseconds(1000 + id % 5000), id, START) != TrackResult::Tracked) {
+            return fail("scale", "track refused a request below capacity", options, id);
+        }
+    }
+    for (SequenceId id = 0; id < count; id += 2) {
+        const std::optional<uint64_t> context = correlator.match(headerOf(command | RESPONSE_FLAG, id * 7));
+        if (!context || *context != id) return fail("scale", "match missed a tracked request", options, id);
+    }
+    // The unanswered (odd) requests due last are those with id % 5000 == 4999
+    const size_t last = count / 5000;
+    if (correlator.expire(START + milliseconds(5998), [](ExpiredRequest<uint64_t>&&) {}) != count / 2 - last) {
+        return fail("scale", "expired the wrong number of requests", options, 0);
+    }
+    if (correlator.expire(START + milliseconds(5999), [](ExpiredRequest<uint64_t>&&) {}) != last || correlator.size() != 0) {
+        return fail("scale", "did not expire at the last deadline", options, 0);
+    }
+    return true;
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    Options options;
+    for (int i = 1; i < argc; i++) {
+        const std::string_view arg = argv[i];
+        if (arg == "--iterations" && i + 1 < argc) {
+            options.iterations = std::strtoull(argv[++i], nullptr, 10);
+        } else if (arg == "--seed" && i + 1 < argc) {
+            options.seed = std::strtoull(argv[++i], nullptr, 10);
+        } else {
+            std::fprintf(stderr, "usage: %s [--iterations N] [--seed S]\\n", argv[0]);
+            return 2;
+        }
+    }
+
+    const Round rounds[] = {
+        {"one slot", 1, false, 1},
+        {"many", 1000, false, 1},
+        {"long timeouts", 1000, true, 1},
+        {"sparse", 1000, false, 65536},
+    };
+    bool ok = true;
+    for (const Round& round : rounds) {
+        ok = runModel(round, options) && ok;
+    }
+    ok = runReentrant(options) && ok;
+    ok = runScale(options) && ok;
+    return ok ? 0 : 1;
+}
+`;
+}
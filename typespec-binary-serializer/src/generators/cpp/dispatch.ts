@@ -0,0 +1,151 @@
+/**
+ * C++ コマンドディスパッチャー生成
+ * COMMAND_ID をキーにしたコンパイル時ジャンプテーブルとメッセージ variant
+ */
+
+import { SchemaIR, ModelDefinition } from '../../ir/types.js';
+import { FrameHeaderLayout } from './layout.js';
+
+/**
+ * COMMAND_ID を持つモデル一覧（重複IDはエラー）
+ */
+export function messageModels(ir: SchemaIR): ModelDefinition[] {
+  const messages = ir.models.filter(m => m.commandId !== undefined);
+  const seen = new Map<number, string>();
+  for (const model of messages) {
+    const existing = seen.get(model.commandId!);
+    if (existing) {
+      throw new Error(`Duplicate command ID 0x${model.commandId!.toString(16)}: ${existing}, ${model.name}`);
+    }
+    seen.set(model.commandId!, model.name);
+  }
+  return messages;
+}
+
+export function generateDispatchHeader(ir: SchemaIR, frameHeader: FrameHeaderLayout | undefined): string {
+  const messages = messageModels(ir);
+  const lines: string[] = [];
+
+  lines.push('/**');
+  lines.push(' * Compile-time metadata for every message with a COMMAND_ID');
+  lines.push(' */');
+  lines.push('template<typename T>');
+  lines.push('struct MessageTraits;');
+  lines.push('');
+
+  for (const model of messages) {
+    lines.push('template<>');
+    lines.push(`struct MessageTraits<${model.name}> {`);
+    lines.push(`    static constexpr uint8_t COMMAND_ID = ${model.name}::COMMAND_ID;`);
+    lines.push(`    static constexpr const char* NAME = "${model.name}";`);
+    lines.push(`    static ${model.name} decode(const uint8_t* data, size_t size) { return deserialize${model.name}(data, size); }`);
+    lines.push(`    static DecodeResult<${model.name}> tryDecode(const uint8_t* data, size_t size) { return tryDeserialize${model.name}(data, size); }`);
+    lines.push('};');
+    lines.push('');
+  }
+
+  lines.push('/// Every command and response of the protocol');
+  lines.push('using Message = std::variant<');
+  messages.forEach((model, index) => {
+    lines.push(`    ${model.name}${index < messages.length - 1 ? ',' : ''}`);
+  });
+  lines.push('>;');
+  lines.push('');
+
+  lines.push(`namespace detail {
+
+template<typename Visitor>
+using DispatchFn = bool (*)(std::span<const uint8_t>, Visitor&);
+
+template<typename T, typename Visitor>
+bool dispatchAs(std::span<const uint8_t> payload, Visitor& visitor) {
+    visitor(MessageTraits<T>::decode(payload.data(), payload.size()));
+    return true;
+}
+
+template<typename Visitor>
+bool dispatchUnknown(std::span<const uint8_t>, Visitor&) {
+    return false;
+}
+
+template<typename Visitor, typename... Ts>
+constexpr std::array<DispatchFn<Visitor>, 256> makeDispatchTable() {
+    std::array<DispatchFn<Visitor>, 256> table{};
+    table.fill(&dispatchUnknown<Visitor>);
+    ((table[MessageTraits<Ts>::COMMAND_ID] = &dispatchAs<Ts, Visitor>), ...);
+    return table;
+}
+
+template<typename Visitor, typename Variant>
+struct DispatchTable;
+
+/// One 256-entry jump table per visitor type, built at compile time
+template<typename Visitor, typename... Ts>
+struct DispatchTable<Visitor, std::variant<Ts...>> {
+    static constexpr std::array<DispatchFn<Visitor>, 256> entries = makeDispatchTable<Visitor, Ts...>();
+};
+
+} // namespace detail
+
+/**
+ * Decode payload as the message selected by commandId and pass it to visitor,
+ * which must accept every Message alternative (a generic lambda works).
+ * Returns false for command IDs that are not part of the protocol.
+ */
+template<typename Visitor>
+bool dispatch(uint8_t commandId, std::span<const uint8_t> payload, Visitor&& visitor) {
+    using Table = detail::DispatchTable<std::remove_reference_t<Visitor>, Message>;
+    return Table::entries[commandId](payload, visitor);
+}
+`);
+
+  if (frameHeader) {
+    const header = frameHeader.model.name;
+    lines.push(`template<typename Visitor>
+bool dispatch(const ${header}& header, std::span<const uint8_t> payload, Visitor&& visitor) {
+    return dispatch(header.${frameHeader.commandIdField.name}, payload, std::forward<Visitor>(visitor));
+}
+`);
+  }
+
+  lines.push(`/// Decode payload into the Message alternative selected by commandId
+inline std::optional<Message> decodeMessage(uint8_t commandId, std::span<const uint8_t> payload) {
+    std::optional<Message> result;
+    dispatch(commandId, payload, [&result](auto&& message) { result.emplace(std::move(message)); });
+    return result;
+}
+
+namespace detail {
+
+using TryDecodeFn = DecodeResult<Message> (*)(std::span<const uint8_t>);
+
+template<typename T>
+DecodeResult<Message> tryDecodeAs(std::span<const uint8_t> payload) {
+    DecodeResult<T> result = MessageTraits<T>::tryDecode(payload.data(), payload.size());
+    if (!result) return result.error();
+    return Message(std::in_place_type<T>, std::move(*result));
+}
+
+inline DecodeResult<Message> tryDecodeUnknown(std::span<const uint8_t>) {
+    return DecodeError::UnknownCommand;
+}
+
+template<typename... Ts>
+constexpr std::array<TryDecodeFn, 256> makeTryDecodeTable(std::type_identity<std::variant<Ts...>>) {
+    std::array<TryDecodeFn, 256> table{};
+    table.fill(&tryDecodeUnknown);
+    ((table[MessageTraits<Ts>::COMMAND_ID] = &tryDecodeAs<Ts>), ...);
+    return table;
+}
+
+inline constexpr std::array<TryDecodeFn, 256> kTryDecodeTable = makeTryDecodeTable(std::type_identity<Message>{});
+
+} // namespace detail
+
+/// No-throw decodeMessage(); unknown command IDs yield DecodeError::UnknownCommand
+inline DecodeResult<Message> tryDecodeMessage(uint8_t commandId, std::span<const uint8_t> payload) {
+    return detail::kTryDecodeTable[commandId](payload);
+}`);
+
+  return lines.join('\n');
+}
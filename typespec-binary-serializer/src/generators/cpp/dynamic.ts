@@ -0,0 +1,1064 @@
+/**
+ * C++ 汎用（テーブル駆動）コーデック生成
+ * 実行時に読み込んだスキーマ記述子（src/ir/descriptor.ts）をデコード/エンコード計画に変換して解釈する
+ * 計画の作成時に、ホストと同じバイトオーダーで隣接する固定長フィールドを 1 回のコピー命令にまとめる
+ */
+
+import { SchemaIR } from '../../ir/types.js';
+import { encodeSchemaDescriptor } from '../../ir/descriptor.js';
+
+/**
+ * dynamic_codec.hpp を生成
+ */
+export function generateDynamicCodecHeader(ns: string): string {
+  return `/**
+ * Auto-generated table-driven codec for schemas loaded at runtime
+ *
+ *     dynamic::Schema schema = dynamic::Schema::load(descriptor);  // a .tbsd file, or builtinSchemaDescriptor()
+ *     const dynamic::Model& model = *schema.model("SensorDataResponse");
+ *     const dynamic::Field& count = *model.field("sensor_count");
+ *     dynamic::Record record;
+ *     if (auto error = model.decodeInto(bytes, record)) { ... }
+ *     uint8_t n = record.get<uint8_t>(count);
+ *
+ * Loading compiles every model into a flat list of plan operations. Runs of
+ * adjacent fixed-size fields already in host byte order collapse into one
+ * copy, so a record's fixed part mirrors the wire layout and a fixed-size
+ * model decodes as a single memcpy plus fixups (byte swaps, bool
+ * normalization, enum checks). Variable-length data lives in the record's
+ * arena, in host byte order.
+ */
+
+#ifndef BINARY_PROTOCOL_DYNAMIC_CODEC_HPP
+#define BINARY_PROTOCOL_DYNAMIC_CODEC_HPP
+
+#include "protocol.hpp"
+
+#include <array>
+#include <cstdint>
+#include <cstring>
+#include <memory>
+#include <optional>
+#include <span>
+#include <string>
+#include <string_view>
+#include <type_traits>
+#include <vector>
+
+namespace ${ns}::dynamic {
+
+/// Descriptor of the schema this library was generated from
+std::span<const uint8_t> builtinSchemaDescriptor();
+
+enum class FieldType : uint8_t {
+    UInt8, UInt16, UInt32, UInt64,
+    Int8, Int16, Int32, Int64,
+    Float32, Float64, Bool,
+    /// Held as its base integer type
+    Enum,
+    /// Fixed-size text, NUL-padded
+    FixedString,
+    FixedBytes,
+    /// Nested fixed-size model; its members are fields too, named "outer.inner"
+    Model,
+    String,
+    Bytes,
+    Array,
+};
+
+class Model;
+
+struct Field {
+    /// Field name, or "outer.inner" for members of nested models
+    std::string path;
+    FieldType type;
+    /// Offset in a record; String, Bytes and Array hold a Slice there
+    uint32_t slot;
+    /// Bytes at the slot; for String, Bytes and Array, bytes per element
+    uint32_t size;
+    /// Element type of an Array
+    FieldType elementType = FieldType::UInt8;
+    /// Nested model, or the element model of an Array of models
+    const Model* model = nullptr;
+
+    bool variable() const { return type >= FieldType::String; }
+};
+
+/// Location of a variable-length value in a record's arena
+struct Slice {
+    uint32_t offset;
+    uint32_t length;
+};
+
+namespace detail {
+
+enum class OpCode : uint8_t {
+    /// The segment needs size input bytes
+    Need,
+    /// size bytes are identical on the wire and in the record
+    Copy,
+    /// A width-byte scalar in the opposite byte order
+    Swap,
+    /// Any non-zero byte is true
+    Bool,
+    /// A width-byte value must be a member of enum table index
+    Enum,
+    /// A width-byte length prefix and that many bytes; ends the segment
+    Var,
+    /// A width-byte length prefix and size-byte elements fixed up by array plan index; ends the segment
+    Array,
+    /// Var whose bytes are batch entries [command_id u8][length u16][payload], framing checked on decode
+    Batch,
+};
+
+/// One plan step; wire is relative to the current segment, slot to the record (or element)
+struct Op {
+    OpCode code;
+    uint8_t width = 0;
+    bool bigEndian = false;
+    uint16_t index = 0;
+    uint32_t wire = 0;
+    uint32_t slot = 0;
+    uint32_t size = 0;
+};
+
+struct EnumTable {
+    uint8_t width = 1;
+    /// Membership of single-byte values
+    std::array<bool, 256> small{};
+    /// Sorted members of wider enums
+    std::vector<uint64_t> values;
+
+    bool contains(uint64_t value) const;
+};
+
+struct ArrayPlan {
+    uint32_t elementSize = 0;
+    /// Per-element fixups (Swap, Bool, Enum); empty when elements are copied verbatim
+    std::vector<Op> ops;
+};
+
+[[noreturn]] void fieldMismatch(const Field& field);
+
+template<typename T>
+void checkScalar(const Field& field) {
+    static_assert(std::is_arithmetic_v<T>, "Fields are read as arithmetic types (enums as their base integer)");
+    if (field.type >= FieldType::FixedString || field.size != sizeof(T)) fieldMismatch(field);
+}
+
+} // namespace detail
+
+/// A fixed-size element of an Array of models; invalidated when its record's arena grows
+class ElementRef {
+public:
+    ElementRef(const Model* model, uint8_t* data) : model_(model), data_(data) {}
+
+    const Model* model() const { return model_; }
+
+    template<typename T>
+    T get(const Field& field) const {
+        detail::checkScalar<T>(field);
+        check(field);
+        T value;
+        std::memcpy(&value, data_ + field.slot, sizeof(T));
+        return value;
+    }
+
+    template<typename T>
+    void set(const Field& field, T value) {
+        detail::checkScalar<T>(field);
+        check(field);
+        if constexpr (std::is_same_v<T, bool>) {
+            data_[field.slot] = value ? 1 : 0;
+        } else {
+            std::memcpy(data_ + field.slot, &value, sizeof(T));
+        }
+    }
+
+    /// Bytes of a FixedString, FixedBytes or nested Model field
+    std::span<uint8_t> bytes(const Field& field) const;
+
+private:
+    void check(const Field& field) const;
+
+    const Model* model_;
+    uint8_t* data_;
+};
+
+/**
+ * A message of a runtime-loaded model: the fixed part at the model's slots in
+ * host byte order, followed by an arena for variable-length values. Reusing
+ * one Record across decodes keeps its storage.
+ */
+class Record {
+public:
+    Record() = default;
+    explicit Record(const Model& model) { reset(model); }
+
+    /// Zeroes the fixed part for model and empties the arena, keeping capacity
+    void reset(const Model& model);
+
+    const Model* model() const { return model_; }
+
+    /// Scalar, bool or enum field; T must have the field's size
+    template<typename T>
+    T get(const Field& field) const {
+        detail::checkScalar<T>(field);
+        check(field);
+        T value;
+        std::memcpy(&value, storage_.data() + field.slot, sizeof(T));
+        return value;
+    }
+
+    template<typename T>
+    void set(const Field& field, T value) {
+        detail::checkScalar<T>(field);
+        check(field);
+        if constexpr (std::is_same_v<T, bool>) {
+            storage_[field.slot] = value ? 1 : 0;
+        } else {
+            std::memcpy(storage_.data() + field.slot, &value, sizeof(T));
+        }
+    }
+
+    /// Bytes of any non-scalar field; for an Array, its elements in host byte order
+    std::span<const uint8_t> bytes(const Field& field) const;
+    /// String or Bytes value; a FixedString ends at its first NUL
+    std::string_view string(const Field& field) const;
+    /// Replaces a String, Bytes or Array value (appended to the arena), or fills a fixed one and zeroes the rest
+    void setBytes(const Field& field, std::span<const uint8_t> data);
+    void setString(const Field& field, std::string_view text);
+
+    size_t count(const Field& array) const;
+    /// Element of an Array of scalars
+    template<typename T>
+    T at(const Field& array, size_t index) const {
+        static_assert(std::is_arithmetic_v<T>, "Array elements are read as arithmetic types");
+        if (array.type != FieldType::Array || array.model != nullptr || array.size != sizeof(T)) detail::fieldMismatch(array);
+        T value;
+        std::memcpy(&value, elementData(array, index), sizeof(T));
+        return value;
+    }
+    /// Element of an Array of models
+    ElementRef element(const Field& array, size_t index);
+    /// Replaces an array with count zeroed elements and returns their bytes
+    std::span<uint8_t> resize(const Field& array, size_t count);
+
+private:
+    friend class Model;
+
+    void check(const Field& field) const;
+    Slice slice(const Field& field) const;
+    void assign(const Field& field, Slice slice);
+    uint8_t* elementData(const Field& array, size_t index) const;
+
+    const Model* model_ = nullptr;
+    std::vector<uint8_t> storage_;
+};
+
+/**
+ * One model of a loaded schema: its fields and the plan that decodes and
+ * encodes it.
+ */
+class Model {
+public:
+    const std::string& name() const { return name_; }
+    std::optional<uint8_t> commandId() const { return commandId_; }
+    /// Wire size of a fixed-size model
+    std::optional<size_t> fixedSize() const { return fixedSize_; }
+    /// Bytes of a record's fixed part
+    size_t recordSize() const { return recordSize_; }
+
+    std::span<const Field> fields() const { return fields_; }
+    /// Field by name, or "outer.inner" inside nested models; nullptr if absent
+    const Field* field(std::string_view path) const;
+
+    /// Decodes bytes into out, which is reset to this model first
+    std::optional<DecodeError> decodeInto(std::span<const uint8_t> bytes, Record& out) const;
+    DecodeResult<Record> tryDecode(std::span<const uint8_t> bytes) const;
+
+    size_t encodedSize(const Record& record) const;
+    /// Encodes record, which must belong to this model, and returns the bytes written
+    size_t encodeInto(const Record& record, std::span<uint8_t> out) const;
+    /// Appends the encoding of record to out
+    void encode(const Record& record, std::vector<uint8_t>& out) const;
+
+private:
+    friend class Schema;
+    friend class Planner;
+
+    bool decodeElements(const detail::ArrayPlan& plan, const uint8_t* in, uint8_t* out, size_t count) const;
+    void encodeElements(const detail::ArrayPlan& plan, const uint8_t* in, uint8_t* out, size_t count) const;
+
+    std::string name_;
+    std::optional<uint8_t> commandId_;
+    std::optional<size_t> fixedSize_;
+    size_t recordSize_ = 0;
+    /// Wire bytes of all fixed fields and length prefixes
+    size_t fixedWireSize_ = 0;
+    std::vector<Field> fields_;
+    std::vector<detail::Op> ops_;
+    std::vector<detail::ArrayPlan> arrays_;
+    const std::vector<detail::EnumTable>* enums_ = nullptr;
+};
+
+/**
+ * A schema loaded from a binary descriptor (written by "tbs descriptor").
+ * Models stay valid while the Schema lives.
+ */
+class Schema {
+public:
+    /// Parses a descriptor and plans every model; throws std::runtime_error if it is malformed
+    static Schema load(std::span<const uint8_t> descriptor);
+
+    const Model* model(std::string_view name) const;
+    const Model* command(uint8_t commandId) const { return commands_[commandId]; }
+    std::span<const std::unique_ptr<Model>> models() const { return models_; }
+
+private:
+    friend class Planner;
+
+    Schema() = default;
+
+    std::vector<std::unique_ptr<Model>> models_;
+    std::unique_ptr<std::vector<detail::EnumTable>> enums_;
+    std::array<const Model*, 256> commands_{};
+};
+
+} // namespace ${ns}::dynamic
+
+#endif // BINARY_PROTOCOL_DYNAMIC_CODEC_HPP`;
+}
+
+/**
+ * dynamic_codec.cpp を生成（組み込みスキーマの記述子を埋め込む）
+ */
+export function generateDynamicCodecImpl(ir: SchemaIR, ns: string): string {
+  const descriptor = Array.from(encodeSchemaDescriptor(ir));
+  const rows: string[] = [];
+  for (let i = 0; i < descriptor.length; i += 16) {
+    rows.push('    ' + descriptor.slice(i, i + 16).map(b => `0x${b.toString(16).padStart(2, '0')},`).join(' '));
+  }
+  const sourceName = ir.metadata.sourceFile.split(/[\\/]/).pop();
+
+  return `/**
+ * Auto-generated table-driven codec implementation
+ */
+
+#include "dynamic_codec.hpp"
+
+#include <algorithm>
+#include <bit>
+#include <limits>
+#include <stdexcept>
+#include <utility>
+
+namespace ${ns}::dynamic {
+
+namespace {
+
+/// Descriptor of ${sourceName}; see src/ir/descriptor.ts for the format
+constexpr uint8_t BUILTIN_DESCRIPTOR[] = {
+${rows.join('\n')}
+};
+
+constexpr uint8_t DESCRIPTOR_VERSION = 1;
+constexpr uint8_t NONE_8 = 0xFF;
+constexpr uint32_t NONE_32 = 0xFFFFFFFF;
+
+enum class Kind : uint8_t { Primitive, Enum, Model, Array };
+
+/// Descriptor primitive codes, in order
+constexpr FieldType PRIMITIVE_TYPES[] = {
+    FieldType::UInt8, FieldType::UInt16, FieldType::UInt32, FieldType::UInt64,
+    FieldType::Int8, FieldType::Int16, FieldType::Int32, FieldType::Int64,
+    FieldType::Float32, FieldType::Float64, FieldType::Bool, FieldType::String, FieldType::Bytes,
+};
+constexpr uint32_t PRIMITIVE_SIZES[] = {1, 2, 4, 8, 1, 2, 4, 8, 4, 8, 1, 0, 0};
+constexpr uint8_t PRIMITIVE_COUNT = 13;
+constexpr uint8_t PRIMITIVE_FLOAT32 = 8;
+constexpr uint8_t PRIMITIVE_BOOL = 10;
+constexpr uint8_t PRIMITIVE_STRING = 11;
+constexpr uint8_t PRIMITIVE_BYTES = 12;
+
+constexpr bool HOST_BIG_ENDIAN = std::endian::native == std::endian::big;
+
+[[noreturn]] void malformed(const std::string& what) {
+    BINARY_PROTOCOL_THROW(std::runtime_error("Invalid schema descriptor: " + what));
+}
+
+uint64_t loadUnsigned(const uint8_t* p, size_t width, bool bigEndian) {
+    uint64_t value = 0;
+    for (size_t i = 0; i < width; i++) {
+        value |= static_cast<uint64_t>(p[i]) << (bigEndian ? 8 * (width - 1 - i) : 8 * i);
+    }
+    return value;
+}
+
+void storeUnsigned(uint8_t* p, uint64_t value, size_t width, bool bigEndian) {
+    for (size_t i = 0; i < width; i++) {
+        p[i] = static_cast<uint8_t>(value >> (bigEndian ? 8 * (width - 1 - i) : 8 * i));
+    }
+}
+
+void reverseCopy(uint8_t* out, const uint8_t* in, size_t width) {
+    for (size_t i = 0; i < width; i++) {
+        out[i] = in[width - 1 - i];
+    }
+}
+
+/// Every [command_id u8][length u16] entry header lies inside the bytes and so does its payload
+bool validBatch(const uint8_t* in, size_t length, bool bigEndian) {
+    size_t offset = 0;
+    while (offset != length) {
+        if (length - offset < 3) return false;
+        const size_t entry = static_cast<size_t>(loadUnsigned(in + offset + 1, 2, bigEndian));
+        if (length - offset - 3 < entry) return false;
+        offset += 3 + entry;
+    }
+    return true;
+}
+
+class DescriptorReader {
+public:
+    explicit DescriptorReader(std::span<const uint8_t> bytes) : bytes_(bytes) {}
+
+    uint8_t u8() { return static_cast<uint8_t>(read(1)); }
+    uint16_t u16() { return static_cast<uint16_t>(read(2)); }
+    uint32_t u32() { return static_cast<uint32_t>(read(4)); }
+    uint64_t u64() { return read(8); }
+
+    std::string str() {
+        const size_t length = u8();
+        if (bytes_.size() - offset_ < length) malformed("truncated");
+        std::string result(reinterpret_cast<const char*>(bytes_.data() + offset_), length);
+        offset_ += length;
+        return result;
+    }
+
+    bool done() const { return offset_ == bytes_.size(); }
+
+private:
+    uint64_t read(size_t width) {
+        if (bytes_.size() - offset_ < width) malformed("truncated");
+        const uint64_t value = loadUnsigned(bytes_.data() + offset_, width, false);
+        offset_ += width;
+        return value;
+    }
+
+    std::span<const uint8_t> bytes_;
+    size_t offset_ = 0;
+};
+
+struct RawField {
+    std::string name;
+    Kind kind;
+    uint8_t element;
+    uint8_t type;
+    uint16_t ref;
+    uint32_t fixedSize;
+    uint8_t prefix;
+    uint32_t offset;
+};
+
+struct RawModel {
+    std::string name;
+    uint8_t flags;
+    uint8_t commandId;
+    uint32_t fixedSize;
+    std::vector<RawField> fields;
+};
+
+/// A fixed-size scalar (or opaque run of bytes) at the same offset on the wire and in the record
+struct Leaf {
+    uint32_t offset;
+    uint32_t width;
+    bool bigEndian;
+    /// Multi-byte scalars are swapped when their byte order differs from the host
+    bool swappable;
+    bool boolean;
+    std::optional<uint16_t> enumIndex;
+};
+
+/// Enum checks, then one Copy per run of host-order leaves, then swaps and bool fixups
+void emitLeaves(const std::vector<Leaf>& leaves, uint32_t slotBase, bool copy, std::vector<detail::Op>& ops) {
+    using detail::Op;
+    using detail::OpCode;
+
+    for (const Leaf& leaf : leaves) {
+        if (leaf.enumIndex) {
+            ops.push_back(Op{OpCode::Enum, static_cast<uint8_t>(leaf.width), leaf.bigEndian, *leaf.enumIndex, leaf.offset});
+        }
+    }
+    if (copy) {
+        std::optional<Op> run;
+        for (const Leaf& leaf : leaves) {
+            if (leaf.swappable && leaf.bigEndian != HOST_BIG_ENDIAN) continue;
+            if (run && run->wire + run->size == leaf.offset) {
+                run->size += leaf.width;
+                continue;
+            }
+            if (run) ops.push_back(*run);
+            run = Op{OpCode::Copy, 0, false, 0, leaf.offset, slotBase + leaf.offset, leaf.width};
+        }
+        if (run) ops.push_back(*run);
+    }
+    for (const Leaf& leaf : leaves) {
+        if (leaf.swappable && leaf.bigEndian != HOST_BIG_ENDIAN) {
+            ops.push_back(Op{OpCode::Swap, static_cast<uint8_t>(leaf.width), false, 0, leaf.offset, slotBase + leaf.offset});
+        } else if (leaf.boolean) {
+            ops.push_back(Op{OpCode::Bool, 1, false, 0, leaf.offset, slotBase + leaf.offset});
+        }
+    }
+}
+
+} // namespace
+
+// ============================================
+// Planning
+// ============================================
+
+/// Turns raw descriptor models into plans; nested and element models are planned first
+class Planner {
+public:
+    Planner(Schema& schema, std::vector<RawModel> raw)
+        : schema_(schema), raw_(std::move(raw)), leaves_(raw_.size()), state_(raw_.size(), State::Pending) {}
+
+    void planAll() {
+        for (size_t i = 0; i < raw_.size(); i++) plan(i);
+    }
+
+private:
+    enum class State : uint8_t { Pending, Planning, Done };
+
+    void plan(size_t index);
+
+    /// A fixed-size model referenced by a field of another model
+    const Model& fixedModel(uint16_t index, const std::string& user) {
+        if (index >= raw_.size()) malformed("bad model reference in " + user);
+        plan(index);
+        const Model& model = *schema_.models_[index];
+        if (!model.fixedSize_) malformed(user + " nests variable-length model " + model.name_);
+        return model;
+    }
+
+    const detail::EnumTable& enumTable(uint16_t index, const std::string& user) {
+        if (index >= schema_.enums_->size()) malformed("bad enum reference in " + user);
+        return (*schema_.enums_)[index];
+    }
+
+    Schema& schema_;
+    std::vector<RawModel> raw_;
+    /// Leaves of each fixed-size model, relative to the model
+    std::vector<std::vector<Leaf>> leaves_;
+    std::vector<State> state_;
+};
+
+void Planner::plan(size_t index) {
+    using detail::Op;
+    using detail::OpCode;
+
+    if (state_[index] == State::Done) return;
+    const RawModel& raw = raw_[index];
+    if (state_[index] == State::Planning) malformed("model " + raw.name + " contains itself");
+    state_[index] = State::Planning;
+
+    Model& model = *schema_.models_[index];
+    const bool bigEndian = (raw.flags & 2) != 0;
+    model.enums_ = schema_.enums_.get();
+
+    // A segment is the fixed fields up to and including the next length prefix
+    std::vector<Leaf> segment;
+    uint32_t wire = 0;
+    uint32_t slotBase = 0;
+    bool variable = false;
+
+    const auto endSegment = [&](std::optional<Op> prefix) {
+        const uint32_t need = wire + (prefix ? prefix->width : 0);
+        if (need > 0) model.ops_.push_back(Op{OpCode::Need, 0, false, 0, 0, 0, need});
+        emitLeaves(segment, slotBase, true, model.ops_);
+        model.fixedWireSize_ += need;
+        // The record holds a Slice where the wire holds the prefix
+        slotBase += wire + (prefix ? sizeof(Slice) : 0);
+        if (prefix) model.ops_.push_back(*prefix);
+        segment.clear();
+        wire = 0;
+    };
+
+    for (const RawField& f : raw.fields) {
+        const std::string where = raw.name + "." + f.name;
+        if (f.offset != NONE_32 && (variable || f.offset != wire)) malformed("offset of " + where + " does not match its layout");
+        Field field{f.name, FieldType::UInt8, slotBase + wire, f.fixedSize};
+
+        if (f.prefix != NONE_8) {
+            if (f.prefix >= PRIMITIVE_FLOAT32 || PRIMITIVE_SIZES[f.prefix] > 4) malformed("bad length prefix type of " + where);
+            Op op{OpCode::Var, static_cast<uint8_t>(PRIMITIVE_SIZES[f.prefix]), bigEndian, 0, wire, slotBase + wire, 1};
+            field.size = 1;
+            if (f.kind == Kind::Array) {
+                detail::ArrayPlan array;
+                std::vector<Leaf> leaves;
+                if (f.element == static_cast<uint8_t>(Kind::Model)) {
+                    const Model& element = fixedModel(f.ref, where);
+                    field.elementType = FieldType::Model;
+                    field.model = &element;
+                    array.elementSize = static_cast<uint32_t>(*element.fixedSize_);
+                    leaves = leaves_[f.ref];
+                } else if (f.element == static_cast<uint8_t>(Kind::Enum)) {
+                    const detail::EnumTable& table = enumTable(f.ref, where);
+                    field.elementType = FieldType::Enum;
+                    array.elementSize = table.width;
+                    leaves.push_back(Leaf{0, table.width, bigEndian, table.width > 1, false, f.ref});
+                } else if (f.element == static_cast<uint8_t>(Kind::Primitive) && f.type < PRIMITIVE_STRING) {
+                    field.elementType = PRIMITIVE_TYPES[f.type];
+                    array.elementSize = PRIMITIVE_SIZES[f.type];
+                    leaves.push_back(Leaf{0, array.elementSize, bigEndian, array.elementSize > 1, f.type == PRIMITIVE_BOOL, std::nullopt});
+                } else {
+                    malformed("bad element type of " + where);
+                }
+                if (array.elementSize == 0) malformed("empty element type of " + where);
+                emitLeaves(leaves, 0, false, array.ops);
+                field.type = FieldType::Array;
+                field.size = array.elementSize;
+                op.code = OpCode::Array;
+                op.index = static_cast<uint16_t>(model.arrays_.size());
+                op.size = array.elementSize;
+                model.arrays_.push_back(std::move(array));
+            } else if (f.kind == Kind::Primitive && (f.type == PRIMITIVE_STRING || f.type == PRIMITIVE_BYTES)) {
+                field.type = f.type == PRIMITIVE_STRING ? FieldType::String : FieldType::Bytes;
+                if ((raw.flags & 4) != 0 && &f == &raw.fields.back()) {
+                    if (f.type != PRIMITIVE_BYTES) malformed("batch field " + where + " is not bytes");
+                    op.code = OpCode::Batch;
+                }
+            } else {
+                malformed(where + " has a length prefix but is not bytes, string or an array");
+            }
+            model.fields_.push_back(std::move(field));
+            endSegment(op);
+            variable = true;
+            continue;
+        }
+
+        switch (f.kind) {
+        case Kind::Primitive:
+            if (f.type >= PRIMITIVE_COUNT) malformed("bad type of " + where);
+            if (f.type == PRIMITIVE_STRING || f.type == PRIMITIVE_BYTES) {
+                if (f.fixedSize == 0) malformed(where + " has neither a size nor a length prefix");
+                field.type = f.type == PRIMITIVE_STRING ? FieldType::FixedString : FieldType::FixedBytes;
+                segment.push_back(Leaf{wire, f.fixedSize, bigEndian, false, false, std::nullopt});
+            } else {
+                if (f.fixedSize != PRIMITIVE_SIZES[f.type]) malformed("size of " + where + " does not match its type");
+                field.type = PRIMITIVE_TYPES[f.type];
+                segment.push_back(Leaf{wire, f.fixedSize, bigEndian, f.fixedSize > 1, f.type == PRIMITIVE_BOOL, std::nullopt});
+            }
+            model.fields_.push_back(std::move(field));
+            wire += f.fixedSize;
+            break;
+        case Kind::Enum: {
+            const detail::EnumTable& table = enumTable(f.ref, where);
+            if (f.fixedSize != table.width) malformed("size of " + where + " does not match its enum");
+            field.type = FieldType::Enum;
+            segment.push_back(Leaf{wire, table.width, bigEndian, table.width > 1, false, f.ref});
+            model.fields_.push_back(std::move(field));
+            wire += table.width;
+            break;
+        }
+        case Kind::Model: {
+            const Model& nested = fixedModel(f.ref, where);
+            if (f.fixedSize != 0 && f.fixedSize != *nested.fixedSize_) malformed("size of " + where + " does not match its model");
+            field.type = FieldType::Model;
+            field.size = static_cast<uint32_t>(*nested.fixedSize_);
+            field.model = &nested;
+            model.fields_.push_back(field);
+            // A fixed-size model's record is its wire layout, so its fields and leaves only shift
+            for (const Field& inner : nested.fields_) {
+                Field flattened = inner;
+                flattened.path = f.name + "." + inner.path;
+                flattened.slot += field.slot;
+                model.fields_.push_back(std::move(flattened));
+            }
+            for (Leaf leaf : leaves_[f.ref]) {
+                leaf.offset += wire;
+                segment.push_back(leaf);
+            }
+            wire += field.size;
+            break;
+        }
+        case Kind::Array:
+            malformed(where + " is an array without a length prefix");
+        }
+    }
+
+    if (!variable) leaves_[index] = segment;
+    endSegment(std::nullopt);
+    model.recordSize_ = slotBase;
+
+    if (raw.fixedSize != NONE_32) {
+        if (variable || raw.fixedSize != model.fixedWireSize_) malformed("fixed size of " + raw.name + " does not match its fields");
+        model.fixedSize_ = raw.fixedSize;
+    } else if (!variable) {
+        malformed(raw.name + " is marked variable-length but has no variable field");
+    }
+    state_[index] = State::Done;
+}
+
+// ============================================
+// Schema
+// ============================================
+
+bool detail::EnumTable::contains(uint64_t value) const {
+    if (width == 1) return small[value];
+    return std::binary_search(values.begin(), values.end(), value);
+}
+
+std::span<const uint8_t> builtinSchemaDescriptor() {
+    return BUILTIN_DESCRIPTOR;
+}
+
+Schema Schema::load(std::span<const uint8_t> descriptor) {
+    DescriptorReader reader(descriptor);
+    if (reader.u8() != 'T' || reader.u8() != 'B' || reader.u8() != 'S' || reader.u8() != 'D') malformed("bad magic");
+    if (reader.u8() != DESCRIPTOR_VERSION) malformed("unsupported version");
+    reader.u8(); // protocol default byte order; every model carries its own
+    const uint16_t enumCount = reader.u16();
+    const uint16_t modelCount = reader.u16();
+
+    Schema schema;
+    schema.enums_ = std::make_unique<std::vector<detail::EnumTable>>(enumCount);
+    for (detail::EnumTable& table : *schema.enums_) {
+        const std::string name = reader.str();
+        const uint8_t base = reader.u8();
+        if (base >= PRIMITIVE_FLOAT32) malformed("bad base type of enum " + name);
+        table.width = static_cast<uint8_t>(PRIMITIVE_SIZES[base]);
+        const uint64_t mask = table.width == 8 ? ~uint64_t{0} : (uint64_t{1} << (8 * table.width)) - 1;
+        for (uint16_t count = reader.u16(); count > 0; count--) {
+            reader.str();
+            // Negative members arrive sign-extended; compare them at the enum's width
+            const uint64_t value = reader.u64() & mask;
+            if (table.width == 1) {
+                table.small[value] = true;
+            } else {
+                table.values.push_back(value);
+            }
+        }
+        std::sort(table.values.begin(), table.values.end());
+    }
+
+    std::vector<RawModel> raw(modelCount);
+    for (RawModel& model : raw) {
+        model.name = reader.str();
+        model.flags = reader.u8();
+        model.commandId = reader.u8();
+        model.fixedSize = reader.u32();
+        model.fields.resize(reader.u16());
+        for (RawField& field : model.fields) {
+            field.name = reader.str();
+            const uint8_t kind = reader.u8();
+            if (kind > static_cast<uint8_t>(Kind::Array)) malformed("bad kind of " + model.name + "." + field.name);
+            field.kind = static_cast<Kind>(kind);
+            field.element = reader.u8();
+            field.type = reader.u8();
+            field.ref = reader.u16();
+            field.fixedSize = reader.u32();
+            field.prefix = reader.u8();
+            field.offset = reader.u32();
+        }
+    }
+    if (!reader.done()) malformed("trailing bytes");
+
+    for (const RawModel& model : raw) {
+        auto planned = std::make_unique<Model>();
+        planned->name_ = model.name;
+        if (model.flags & 1) {
+            if (schema.commands_[model.commandId]) malformed("duplicate command ID in " + model.name);
+            planned->commandId_ = model.commandId;
+            schema.commands_[model.commandId] = planned.get();
+        }
+        schema.models_.push_back(std::move(planned));
+    }
+    Planner(schema, std::move(raw)).planAll();
+    return schema;
+}
+
+const Model* Schema::model(std::string_view name) const {
+    for (const auto& model : models_) {
+        if (model->name() == name) return model.get();
+    }
+    return nullptr;
+}
+
+const Field* Model::field(std::string_view path) const {
+    for (const Field& field : fields_) {
+        if (field.path == path) return &field;
+    }
+    return nullptr;
+}
+
+// ============================================
+// Decoding
+// ============================================
+
+bool Model::decodeElements(const detail::ArrayPlan& plan, const uint8_t* in, uint8_t* out, size_t count) const {
+    using detail::OpCode;
+    for (size_t i = 0; i < count; i++, in += plan.elementSize, out += plan.elementSize) {
+        for (const detail::Op& op : plan.ops) {
+            switch (op.code) {
+            case OpCode::Swap: reverseCopy(out + op.slot, in + op.wire, op.width); break;
+            case OpCode::Bool: out[op.slot] = in[op.wire] != 0; break;
+            case OpCode::Enum:
+                if (!(*enums_)[op.index].contains(loadUnsigned(in + op.wire, op.width, op.bigEndian))) return false;
+                break;
+            default: break;
+            }
+        }
+    }
+    return true;
+}
+
+std::optional<DecodeError> Model::decodeInto(std::span<const uint8_t> bytes, Record& out) const {
+    using detail::OpCode;
+
+    out.reset(*this);
+    const uint8_t* in = bytes.data();
+    size_t remaining = bytes.size();
+    for (const detail::Op& op : ops_) {
+        switch (op.code) {
+        case OpCode::Need:
+            if (remaining < op.size) return DecodeError::Truncated;
+            break;
+        case OpCode::Copy:
+            std::memcpy(out.storage_.data() + op.slot, in + op.wire, op.size);
+            break;
+        case OpCode::Swap:
+            reverseCopy(out.storage_.data() + op.slot, in + op.wire, op.width);
+            break;
+        case OpCode::Bool:
+            out.storage_[op.slot] = in[op.wire] != 0;
+            break;
+        case OpCode::Enum:
+            if (!(*enums_)[op.index].contains(loadUnsigned(in + op.wire, op.width, op.bigEndian))) return DecodeError::BadEnumValue;
+            break;
+        case OpCode::Var:
+        case OpCode::Array:
+        case OpCode::Batch: {
+            const size_t length = static_cast<size_t>(loadUnsigned(in + op.wire, op.width, op.bigEndian));
+            in += op.wire + op.width;
+            remaining -= op.wire + op.width;
+            if (remaining < length) return DecodeError::LengthOverflow;
+            if (length % op.size != 0) return DecodeError::BadArrayLength;
+            if (op.code == OpCode::Batch && !validBatch(in, length, op.bigEndian)) return DecodeError::Truncated;
+            // Appending may move the storage, so the record is re-read through out
+            const size_t offset = out.storage_.size();
+            out.storage_.insert(out.storage_.end(), in, in + length);
+            const Slice slice{static_cast<uint32_t>(offset), static_cast<uint32_t>(length)};
+            std::memcpy(out.storage_.data() + op.slot, &slice, sizeof(Slice));
+            if (op.code == OpCode::Array && !arrays_[op.index].ops.empty()
+                && !decodeElements(arrays_[op.index], in, out.storage_.data() + offset, length / op.size)) {
+                return DecodeError::BadEnumValue;
+            }
+            in += length;
+            remaining -= length;
+            break;
+        }
+        }
+    }
+    return std::nullopt;
+}
+
+DecodeResult<Record> Model::tryDecode(std::span<const uint8_t> bytes) const {
+    Record record;
+    if (auto error = decodeInto(bytes, record)) return *error;
+    return record;
+}
+
+// ============================================
+// Encoding
+// ============================================
+
+void Model::encodeElements(const detail::ArrayPlan& plan, const uint8_t* in, uint8_t* out, size_t count) const {
+    using detail::OpCode;
+    for (size_t i = 0; i < count; i++, in += plan.elementSize, out += plan.elementSize) {
+        for (const detail::Op& op : plan.ops) {
+            if (op.code == OpCode::Swap) {
+                reverseCopy(out + op.wire, in + op.slot, op.width);
+            } else if (op.code == OpCode::Bool) {
+                out[op.wire] = in[op.slot] != 0;
+            }
+        }
+    }
+}
+
+size_t Model::encodedSize(const Record& record) const {
+    size_t size = fixedWireSize_;
+    for (const detail::Op& op : ops_) {
+        if (op.code == detail::OpCode::Var || op.code == detail::OpCode::Array || op.code == detail::OpCode::Batch) {
+            Slice slice;
+            std::memcpy(&slice, record.storage_.data() + op.slot, sizeof(Slice));
+            size += slice.length;
+        }
+    }
+    return size;
+}
+
+size_t Model::encodeInto(const Record& record, std::span<uint8_t> out) const {
+    using detail::OpCode;
+
+    if (record.model_ != this) BINARY_PROTOCOL_THROW(std::invalid_argument("Record belongs to another model"));
+    const size_t size = encodedSize(record);
+    if (out.size() < size) BINARY_PROTOCOL_THROW(std::runtime_error("Buffer overflow"));
+    const uint8_t* in = record.storage_.data();
+    uint8_t* p = out.data();
+    for (const detail::Op& op : ops_) {
+        switch (op.code) {
+        case OpCode::Need:
+        case OpCode::Enum:
+            break;
+        case OpCode::Copy:
+            std::memcpy(p + op.wire, in + op.slot, op.size);
+            break;
+        case OpCode::Swap:
+            reverseCopy(p + op.wire, in + op.slot, op.width);
+            break;
+        case OpCode::Bool:
+            p[op.wire] = in[op.slot] != 0;
+            break;
+        case OpCode::Var:
+        case OpCode::Array:
+        case OpCode::Batch: {
+            Slice slice;
+            std::memcpy(&slice, in + op.slot, sizeof(Slice));
+            if (op.width < 4 && slice.length >> (8 * op.width) != 0) {
+                BINARY_PROTOCOL_THROW(std::length_error("Length exceeds its prefix"));
+            }
+            storeUnsigned(p + op.wire, slice.length, op.width, op.bigEndian);
+            p += op.wire + op.width;
+            if (slice.length != 0) std::memcpy(p, in + slice.offset, slice.length);
+            if (op.code == OpCode::Array && !arrays_[op.index].ops.empty()) {
+                encodeElements(arrays_[op.index], in + slice.offset, p, slice.length / op.size);
+            }
+            p += slice.length;
+            break;
+        }
+        }
+    }
+    return size;
+}
+
+void Model::encode(const Record& record, std::vector<uint8_t>& out) const {
+    const size_t start = out.size();
+    out.resize(start + encodedSize(record));
+    encodeInto(record, std::span<uint8_t>(out).subspan(start));
+}
+
+// ============================================
+// Records
+// ============================================
+
+void detail::fieldMismatch(const Field& field) {
+    BINARY_PROTOCOL_THROW(std::invalid_argument("Field " + field.path + " does not hold the requested type"));
+}
+
+void Record::reset(const Model& model) {
+    model_ = &model;
+    storage_.assign(model.recordSize(), 0);
+}
+
+void Record::check(const Field& field) const {
+    const size_t size = field.variable() ? sizeof(Slice) : field.size;
+    if (model_ == nullptr || field.slot + size > model_->recordSize()) {
+        BINARY_PROTOCOL_THROW(std::invalid_argument("Field " + field.path + " does not belong to this record"));
+    }
+}
+
+Slice Record::slice(const Field& field) const {
+    check(field);
+    Slice slice;
+    std::memcpy(&slice, storage_.data() + field.slot, sizeof(Slice));
+    return slice;
+}
+
+void Record::assign(const Field& field, Slice slice) {
+    std::memcpy(storage_.data() + field.slot, &slice, sizeof(Slice));
+}
+
+std::span<const uint8_t> Record::bytes(const Field& field) const {
+    if (field.variable()) {
+        const Slice s = slice(field);
+        return {storage_.data() + s.offset, s.length};
+    }
+    if (field.type < FieldType::FixedString) detail::fieldMismatch(field);
+    check(field);
+    return {storage_.data() + field.slot, field.size};
+}
+
+std::string_view Record::string(const Field& field) const {
+    if (field.type != FieldType::String && field.type != FieldType::Bytes && field.type != FieldType::FixedString) {
+        detail::fieldMismatch(field);
+    }
+    const std::span<const uint8_t> data = bytes(field);
+    const std::string_view text(reinterpret_cast<const char*>(data.data()), data.size());
+    return field.type == FieldType::FixedString ? text.substr(0, text.find(char{})) : text;
+}
+
+void Record::setBytes(const Field& field, std::span<const uint8_t> data) {
+    check(field);
+    if (field.variable()) {
+        if (data.size() % field.size != 0) detail::fieldMismatch(field);
+        if (data.size() > std::numeric_limits<uint32_t>::max()) BINARY_PROTOCOL_THROW(std::length_error("Value too large"));
+        // The previous value stays in the arena until reset
+        const size_t offset = storage_.size();
+        storage_.insert(storage_.end(), data.begin(), data.end());
+        assign(field, Slice{static_cast<uint32_t>(offset), static_cast<uint32_t>(data.size())});
+        return;
+    }
+    if (field.type < FieldType::FixedString) detail::fieldMismatch(field);
+    if (data.size() > field.size) BINARY_PROTOCOL_THROW(std::length_error("Value exceeds the size of " + field.path));
+    uint8_t* slot = storage_.data() + field.slot;
+    if (!data.empty()) std::memcpy(slot, data.data(), data.size());
+    std::memset(slot + data.size(), 0, field.size - data.size());
+}
+
+void Record::setString(const Field& field, std::string_view text) {
+    setBytes(field, {reinterpret_cast<const uint8_t*>(text.data()), text.size()});
+}
+
+size_t Record::count(const Field& array) const {
+    if (array.type != FieldType::Array) detail::fieldMismatch(array);
+    return slice(array).length / array.size;
+}
+
+uint8_t* Record::elementData(const Field& array, size_t index) const {
+    const Slice s = slice(array);
+    if (index >= s.length / array.size) BINARY_PROTOCOL_THROW(std::out_of_range("Array index out of range"));
+    return const_cast<uint8_t*>(storage_.data()) + s.offset + index * array.size;
+}
+
+ElementRef Record::element(const Field& array, size_t index) {
+    if (array.type != FieldType::Array || array.model == nullptr) detail::fieldMismatch(array);
+    return ElementRef(array.model, elementData(array, index));
+}
+
+std::span<uint8_t> Record::resize(const Field& array, size_t count) {
+    if (array.type != FieldType::Array) detail::fieldMismatch(array);
+    check(array);
+    const size_t length = count * array.size;
+    if (length > std::numeric_limits<uint32_t>::max()) BINARY_PROTOCOL_THROW(std::length_error("Value too large"));
+    const size_t offset = storage_.size();
+    storage_.resize(offset + length);
+    assign(array, Slice{static_cast<uint32_t>(offset), static_cast<uint32_t>(length)});
+    return {storage_.data() + offset, length};
+}
+
+void ElementRef::check(const Field& field) const {
+    if (field.variable() || field.slot + field.size > model_->recordSize()) {
+        BINARY_PROTOCOL_THROW(std::invalid_argument("Field " + field.path + " does not belong to " + model_->name()));
+    }
+}
+
+std::span<uint8_t> ElementRef::bytes(const Field& field) const {
+    if (field.type < FieldType::FixedString) detail::fieldMismatch(field);
+    check(field);
+    return {data_ + field.slot, field.size};
+}
+
+} // namespace ${ns}::dynamic`;
+}
@@ -0,0 +1,307 @@
+/**
+ * C++ ストリームフレームデコーダー生成
+ * @frame_header モデルで区切られたバイトストリームを分割読み取りから再構成する
+ */
+
+import { FrameHeaderLayout, wireBytes } from './layout.js';
+
+export function generateFrameDecoderHeader(layout: FrameHeaderLayout, ns: string): string {
+  const header = layout.model.name;
+  const magicSize = layout.magicField.size.fixedSize ?? 0;
+  const magicBytes = wireBytes(layout.magicValue, magicSize, layout.model.endian)
+    .map(b => `0x${b.toString(16).toUpperCase().padStart(2, '0')}`)
+    .join(', ');
+
+  return `/**
+ * Auto-generated incremental frame decoder
+ * Reassembles ${header}-framed messages from arbitrary stream chunks.
+ */
+
+#ifndef BINARY_PROTOCOL_FRAME_DECODER_HPP
+#define BINARY_PROTOCOL_FRAME_DECODER_HPP
+
+#include "protocol.hpp"
+
+#include <algorithm>
+#include <array>
+#include <cstdint>
+#include <span>
+#include <vector>
+
+namespace ${ns} {
+
+/**
+ * A complete frame. The payload borrows either the caller's chunk or the
+ * decoder's reassembly buffer and is only valid inside the frame callback.
+ */
+struct Frame {
+    ${header} header;
+    std::span<const uint8_t> payload;
+    /// Header and payload as received
+    std::span<const uint8_t> bytes;
+};
+
+struct FrameDecoderStats {
+    uint64_t frames = 0;
+    /// Times the decoder lost sync (bad magic or oversized payload_length)
+    uint64_t resyncs = 0;
+    /// Bytes skipped while searching for the next magic number
+    uint64_t discardedBytes = 0;
+};
+
+namespace detail {
+
+/// ${header}::${layout.magicField.name} as it appears on the wire, FRAME_MAGIC_OFFSET bytes into a frame
+inline constexpr std::array<uint8_t, ${magicSize}> FRAME_MAGIC_BYTES = {${magicBytes}};
+inline constexpr size_t FRAME_MAGIC_OFFSET = ${layout.magicField.offset ?? 0};
+
+/**
+ * Offset of the first frame start at or after from whose magic number matches.
+ * A magic number cut off by the end of bytes counts as a match, since the rest
+ * may still arrive; with no match, the offset past which bytes cannot hold one.
+ */
+size_t findFrameMagic(std::span<const uint8_t> bytes, size_t from);
+
+} // namespace detail
+
+/**
+ * Incremental decoder for ${header}-framed byte streams.
+ *
+ * Complete frames inside a chunk are handed out in place; only the trailing
+ * partial frame of a chunk is copied, into a reassembly buffer whose size is
+ * bounded by HEADER_SIZE + maxPayload and allocated once up front.
+ */
+class FrameDecoder {
+public:
+    static constexpr size_t HEADER_SIZE = ${header}::ENCODED_SIZE;
+    static constexpr size_t DEFAULT_MAX_PAYLOAD = 64 * 1024;
+
+    explicit FrameDecoder(size_t maxPayload = DEFAULT_MAX_PAYLOAD);
+
+    /// Consume a chunk, invoking onFrame(const Frame&) for every complete frame
+    template<typename Handler>
+    void feed(std::span<const uint8_t> chunk, Handler&& onFrame);
+
+    /// Drop any partially buffered frame
+    void reset() { pending_.clear(); }
+
+    size_t buffered() const { return pending_.size(); }
+    size_t maxPayload() const { return maxPayload_; }
+    const FrameDecoderStats& stats() const { return stats_; }
+
+private:
+    enum class ProbeStatus { Complete, NeedMore, Invalid };
+
+    struct Probe {
+        ProbeStatus status;
+        size_t frameSize;
+    };
+
+    Probe probe(std::span<const uint8_t> bytes) const;
+    Frame frameAt(std::span<const uint8_t> bytes, size_t frameSize) const;
+    /// Offset of the next possible frame start after a sync loss
+    size_t resync(std::span<const uint8_t> bytes);
+    /// Bytes the pending frame still needs before it can be probed again
+    size_t pendingNeed() const;
+    void resyncPending();
+
+    size_t maxPayload_;
+    std::vector<uint8_t> pending_;
+    FrameDecoderStats stats_;
+};
+
+template<typename Handler>
+void FrameDecoder::feed(std::span<const uint8_t> chunk, Handler&& onFrame) {
+    // Finish the frame left over from the previous chunk, copying only the
+    // bytes it still needs
+    while (!pending_.empty() && !chunk.empty()) {
+        const size_t take = std::min(pendingNeed(), chunk.size());
+        pending_.insert(pending_.end(), chunk.begin(), chunk.begin() + take);
+        chunk = chunk.subspan(take);
+
+        const Probe result = probe(pending_);
+        if (result.status == ProbeStatus::Complete) {
+            stats_.frames++;
+            onFrame(frameAt(pending_, result.frameSize));
+            pending_.clear();
+        } else if (result.status == ProbeStatus::Invalid) {
+            resyncPending();
+        }
+    }
+
+    // Hand out complete frames straight from the caller's chunk
+    while (!chunk.empty()) {
+        const Probe result = probe(chunk);
+        if (result.status == ProbeStatus::Complete) {
+            stats_.frames++;
+            onFrame(frameAt(chunk, result.frameSize));
+            chunk = chunk.subspan(result.frameSize);
+        } else if (result.status == ProbeStatus::NeedMore) {
+            pending_.assign(chunk.begin(), chunk.end());
+            return;
+        } else {
+            chunk = chunk.subspan(resync(chunk));
+        }
+    }
+}
+
+} // namespace ${ns}
+
+#endif // BINARY_PROTOCOL_FRAME_DECODER_HPP
+`;
+}
+
+export function generateFrameDecoderImpl(layout: FrameHeaderLayout, ns: string): string {
+  const header = layout.model.name;
+  const magic = layout.magicField.name;
+  const magicConst = `${header}::${magic.toUpperCase()}`;
+  const payloadLength = layout.payloadLengthField.name;
+
+  return `/**
+ * Auto-generated incremental frame decoder implementation
+ */
+
+#include "frame_decoder.hpp"
+#include "instrumentation.hpp"
+
+#include <algorithm>
+#include <cstring>
+
+namespace ${ns} {
+
+FrameDecoder::FrameDecoder(size_t maxPayload)
+    : maxPayload_(maxPayload) {
+    pending_.reserve(HEADER_SIZE + maxPayload_);
+}
+
+FrameDecoder::Probe FrameDecoder::probe(std::span<const uint8_t> bytes) const {
+    // Reject a bad magic number as soon as its bytes are available
+    using detail::FRAME_MAGIC_BYTES;
+    using detail::FRAME_MAGIC_OFFSET;
+    const size_t magicAvailable = std::min(bytes.size() - std::min(bytes.size(), FRAME_MAGIC_OFFSET), FRAME_MAGIC_BYTES.size());
+    if (std::memcmp(bytes.data() + FRAME_MAGIC_OFFSET, FRAME_MAGIC_BYTES.data(), magicAvailable) != 0) {
+        BINARY_PROTOCOL_FRAME_ERROR(BadMagic);
+        return {ProbeStatus::Invalid, 0};
+    }
+    if (bytes.size() < HEADER_SIZE) {
+        return {ProbeStatus::NeedMore, 0};
+    }
+
+    const ${header} header = deserialize${header}(bytes.data(), HEADER_SIZE);
+    if (header.${magic} != ${magicConst}) {
+        BINARY_PROTOCOL_FRAME_ERROR(BadMagic);
+        return {ProbeStatus::Invalid, 0};
+    }
+    if (header.${payloadLength} > maxPayload_) {
+        BINARY_PROTOCOL_FRAME_ERROR(OversizedPayload);
+        return {ProbeStatus::Invalid, 0};
+    }
+
+    const size_t frameSize = HEADER_SIZE + header.${payloadLength};
+    if (bytes.size() < frameSize) {
+        return {ProbeStatus::NeedMore, 0};
+    }
+    return {ProbeStatus::Complete, frameSize};
+}
+
+Frame FrameDecoder::frameAt(std::span<const uint8_t> bytes, size_t frameSize) const {
+    Frame frame;
+    frame.header = deserialize${header}(bytes.data(), HEADER_SIZE);
+    frame.payload = bytes.subspan(HEADER_SIZE, frameSize - HEADER_SIZE);
+    frame.bytes = bytes.first(frameSize);
+    return frame;
+}
+
+size_t detail::findFrameMagic(std::span<const uint8_t> bytes, size_t from) {
+    size_t offset = from + FRAME_MAGIC_OFFSET;
+    while (offset < bytes.size()) {
+        const auto* hit = static_cast<const uint8_t*>(
+            std::memchr(bytes.data() + offset, FRAME_MAGIC_BYTES[0], bytes.size() - offset));
+        if (hit == nullptr) {
+            offset = bytes.size();
+            break;
+        }
+        offset = static_cast<size_t>(hit - bytes.data());
+        const size_t available = std::min(bytes.size() - offset, FRAME_MAGIC_BYTES.size());
+        if (std::memcmp(hit, FRAME_MAGIC_BYTES.data(), available) == 0) {
+            break;
+        }
+        offset++;
+    }
+
+    // A frame starts FRAME_MAGIC_OFFSET bytes before its magic number
+    return offset - FRAME_MAGIC_OFFSET;
+}
+
+size_t FrameDecoder::resync(std::span<const uint8_t> bytes) {
+    stats_.resyncs++;
+
+    // The current position is known bad; look for the next magic start
+    const size_t frameStart = detail::findFrameMagic(bytes, 1);
+    stats_.discardedBytes += frameStart;
+    return frameStart;
+}
+
+size_t FrameDecoder::pendingNeed() const {
+    if (pending_.size() < HEADER_SIZE) {
+        return HEADER_SIZE - pending_.size();
+    }
+    const ${header} header = deserialize${header}(pending_.data(), HEADER_SIZE);
+    return HEADER_SIZE + header.${payloadLength} - pending_.size();
+}
+
+void FrameDecoder::resyncPending() {
+    const size_t skip = resync(pending_);
+    pending_.erase(pending_.begin(), pending_.begin() + static_cast<std::ptrdiff_t>(skip));
+}
+
+} // namespace ${ns}
+`;
+}
+
+/**
+ * 定数式で組み立てるフレーム（protocol.hpp の末尾に置く）
+ */
+export function generateConstantFrames(layout: FrameHeaderLayout): string {
+  const header = layout.model.name;
+  const endian = layout.model.endian === 'big' ? 'Endian::Big' : 'Endian::Little';
+  const payloadLength = layout.payloadLengthField.name;
+
+  let offset = 0;
+  let checksumStore = '';
+  for (const field of layout.model.fields) {
+    if (layout.checksum && field === layout.checksum.field) {
+      checksumStore = `
+    detail::store<${endian}>(frame.data() + ${offset},
+        detail::frameChecksum(frame.data(), {frame.data() + ${header}::ENCODED_SIZE, N}));`;
+    }
+    offset += field.size.fixedSize ?? 0;
+  }
+
+  return `// ============================================
+// Compile-time frames
+// ============================================
+
+/**
+ * Frame around an encoded payload, usable as a constant expression.
+ * ${layout.magicField.name}, ${layout.commandIdField.name} and ${payloadLength} are filled in${layout.checksum ? ` and ${layout.checksum.field.name} is computed` : ''}.
+ */
+template<typename T, size_t N>
+constexpr std::array<uint8_t, ${header}::ENCODED_SIZE + N> makeFrame(${header} header, const std::array<uint8_t, N>& payload) {
+    header.${layout.magicField.name} = ${header}::MAGIC;
+    header.${layout.commandIdField.name} = MessageTraits<T>::COMMAND_ID;
+    header.${payloadLength} = static_cast<decltype(header.${payloadLength})>(N);
+    std::array<uint8_t, ${header}::ENCODED_SIZE + N> frame{};
+    const std::array<uint8_t, ${header}::ENCODED_SIZE> encodedHeader = serializeToArray(header);
+    std::copy(encodedHeader.begin(), encodedHeader.end(), frame.begin());
+    std::copy(payload.begin(), payload.end(), frame.begin() + ${header}::ENCODED_SIZE);${checksumStore}
+    return frame;
+}
+
+/// Frame for a fixed-size message, e.g. constexpr auto heartbeat = makeFrame(${header}{}, PingCommand{});
+template<typename T>
+    requires requires { T::ENCODED_SIZE; MessageTraits<T>::COMMAND_ID; }
+constexpr auto makeFrame(const ${header}& header, const T& message) {
+    return makeFrame<T>(header, serializeToArray(message));
+}`;
+}
@@ -0,0 +1,165 @@
+/**
+ * C++ スキャッター/ギャザー（iovec）エンコード生成
+ * 固定長部分と長さプレフィックスだけを小さなバッファに書き、可変長フィールドは呼び出し元のメモリを指す
+ */
+
+import { FrameHeaderLayout } from './layout.js';
+
+export function generateGatherListHeader(): string {
+  return `// ============================================
+// Scatter-gather encoding
+// ============================================
+
+/**
+ * Encoded message(s) as a list of segments for writev/sendmsg.
+ *
+ * Fixed fields and length prefixes are encoded into an inline buffer;
+ * variable-length fields of at least INLINE_COPY_LIMIT bytes are referenced
+ * in place, so the encoded messages must outlive the list. Several messages
+ * or frames can be appended before the list is written out; clear() reuses it.
+ */
+class GatherList {
+public:
+    static constexpr size_t MAX_SEGMENTS = 16;
+    static constexpr size_t INLINE_CAPACITY = 256;
+    /// Shorter fields are copied, since another segment costs more than the copy
+    static constexpr size_t INLINE_COPY_LIMIT = 64;
+
+    GatherList() = default;
+    // Segments point into this object's inline buffer
+    GatherList(const GatherList&) = delete;
+    GatherList& operator=(const GatherList&) = delete;
+
+    std::span<const std::span<const uint8_t>> segments() const { return {segments_.data(), count_}; }
+    /// Total encoded bytes across all segments
+    size_t size() const { return size_; }
+
+    void clear() {
+        count_ = 0;
+        size_ = 0;
+        inlineUsed_ = 0;
+        spill_.clear();
+    }
+
+    /// Encoded bytes in the inline buffer, extending the previous segment when contiguous
+    std::span<uint8_t> allocate(size_t n) {
+        if (n > INLINE_CAPACITY - inlineUsed_) BINARY_PROTOCOL_THROW(std::length_error("GatherList inline buffer full"));
+        uint8_t* bytes = inline_.data() + inlineUsed_;
+        inlineUsed_ += n;
+        append({bytes, n});
+        return {bytes, n};
+    }
+
+    /// Variable-length field: referenced in place unless it is short enough to copy
+    void appendBytes(std::span<const uint8_t> bytes) {
+        if (bytes.empty()) return;
+        if (bytes.size() < INLINE_COPY_LIMIT && bytes.size() <= INLINE_CAPACITY - inlineUsed_) {
+            std::memcpy(allocate(bytes.size()).data(), bytes.data(), bytes.size());
+        } else {
+            append(bytes);
+        }
+    }
+
+    /// Owned storage for fields that have to be converted (e.g. arrays in a foreign byte order)
+    std::span<uint8_t> spill(size_t n) {
+        std::vector<uint8_t>& buffer = spill_.emplace_back(n);
+        append({buffer.data(), n});
+        return buffer;
+    }
+
+    /// Calls fn with every byte range from the given offset onwards
+    template<typename Fn>
+    void visit(size_t from, Fn&& fn) const {
+        for (std::span<const uint8_t> segment : segments()) {
+            if (from >= segment.size()) {
+                from -= segment.size();
+                continue;
+            }
+            fn(segment.subspan(from));
+            from = 0;
+        }
+    }
+
+#if BINARY_PROTOCOL_HAS_IOVEC
+    /// Fills iov (room for segments().size() entries) for writev/sendmsg; returns the count
+    size_t toIovec(struct iovec* iov) const {
+        for (size_t i = 0; i < count_; i++) {
+            iov[i].iov_base = const_cast<uint8_t*>(segments_[i].data());
+            iov[i].iov_len = segments_[i].size();
+        }
+        return count_;
+    }
+#endif
+
+private:
+    void append(std::span<const uint8_t> bytes) {
+        size_ += bytes.size();
+        if (count_ > 0) {
+            std::span<const uint8_t>& last = segments_[count_ - 1];
+            if (last.data() + last.size() == bytes.data()) {
+                last = {last.data(), last.size() + bytes.size()};
+                return;
+            }
+        }
+        if (count_ == MAX_SEGMENTS) BINARY_PROTOCOL_THROW(std::length_error("GatherList has too many segments"));
+        segments_[count_++] = bytes;
+    }
+
+    std::array<uint8_t, INLINE_CAPACITY> inline_{};
+    size_t inlineUsed_ = 0;
+    std::array<std::span<const uint8_t>, MAX_SEGMENTS> segments_{};
+    size_t count_ = 0;
+    size_t size_ = 0;
+    std::vector<std::vector<uint8_t>> spill_;
+};
+
+/// Appends a message to the list; fixed-size messages are encoded inline
+template<typename T>
+    requires requires(const T& message, std::span<uint8_t> out) { serializeInto(message, out); }
+void serializeGather(const T& data, GatherList& out) {
+    serializeInto(data, out.allocate(encodedSize(data)));
+}`;
+}
+
+/**
+ * フレーム単位のギャザーエンコード（protocol.hpp の末尾に置く）
+ */
+export function generateFrameGather(layout: FrameHeaderLayout): string {
+  const header = layout.model.name;
+  const endian = layout.model.endian === 'big' ? 'Endian::Big' : 'Endian::Little';
+  const payloadLength = layout.payloadLengthField.name;
+
+  let offset = 0;
+  let checksumOffset = 0;
+  for (const field of layout.model.fields) {
+    if (layout.checksum && field === layout.checksum.field) checksumOffset = offset;
+    offset += field.size.fixedSize ?? 0;
+  }
+
+  // チェックサムはペイロードの各セグメントを順に読んで計算（コピーはしない）
+  const sealing = layout.checksum
+    ? `
+    serializeInto(header, head);
+    FrameChecksum checksum;
+    checksum.update(head.first(${checksumOffset}));
+    checksum.update(head.subspan(${checksumOffset + layout.checksum.field.size.fixedSize!}));
+    out.visit(start + ${header}::ENCODED_SIZE, [&](std::span<const uint8_t> bytes) { checksum.update(bytes); });
+    detail::store<${endian}>(head.data() + ${checksumOffset}, checksum.value());`
+    : `
+    serializeInto(header, head);`;
+
+  return `/**
+ * Appends a frame: ${header} in the inline buffer followed by the message
+ * segments. ${layout.magicField.name}, ${layout.commandIdField.name} and ${payloadLength} are filled in${layout.checksum ? `, and ${layout.checksum.field.name}\n * is computed over the segments without copying them` : ''}.
+ */
+template<typename T>
+    requires requires { MessageTraits<T>::COMMAND_ID; }
+void serializeGather(${header} header, const T& message, GatherList& out) {
+    const size_t start = out.size();
+    const std::span<uint8_t> head = out.allocate(${header}::ENCODED_SIZE);
+    serializeGather(message, out);
+    header.${layout.magicField.name} = ${header}::MAGIC;
+    header.${layout.commandIdField.name} = MessageTraits<T>::COMMAND_ID;
+    header.${payloadLength} = static_cast<decltype(header.${payloadLength})>(out.size() - start - ${header}::ENCODED_SIZE);${sealing}
+}`;
+}
@@ -8,8 +8,35 @@ import {
   EnumDefinition,
   FieldDefinition,
   TypeInfo,
+  PRIMITIVE_SIZES,
 } from '../../ir/types.js';
 import { BaseGenerator, GeneratedFile, GeneratorOptions } from '../base.js';
+import {
+  FlatField,
+  elementWireSize,
+  findFrameHeader,
+  flattenFixedFields,
+  isBulkCopyModel,
+} from './layout.js';
+import { generateBenchmarkSuite } from './benchmark.js';
+import { CMakeTest, generateCMakeLists } from './cmake.js';
+import { generateMessageRingHeader, generateMessageRingTest } from './ring.js';
+import { generateCaptureHeader, generateCaptureImpl, generateCaptureTest } from './capture.js';
+import { generateParallelDecodeHeader, generateParallelDecodeImpl, generateParallelDecodeTest } from './parallel.js';
+import { findColumnarModels, generateColumnsHeader, generateColumnsImpl } from './columns.js';
+import { generateInstrumentationHeader, generateInstrumentationImpl } from './instrumentation.js';
+import { generateConstantFrames, generateFrameDecoderHeader, generateFrameDecoderImpl } from './frame.js';
+import { generateDispatchHeader } from './dispatch.js';
+import { findBatchLayouts, generateBatchHeader } from './batch.js';
+import { generateChecksumHeader, generateFrameChecksumDecls, generateFrameChecksumImpl } from './checksum.js';
+import { generateDecodeResultHeader, generateThrowMacro } from './result.js';
+import { generateFrameGather, generateGatherListHeader } from './gather.js';
+import { canGenerateCorrelation, generateCorrelationHeader, generateCorrelationTest } from './correlation.js';
+import { generateTransportHeader, generateTransportImpl, generateTransportTest } from './transport.js';
+import { generateDynamicCodecHeader, generateDynamicCodecImpl } from './dynamic.js';
+import { generateShmRingHeader, generateShmRingImpl, generateShmRingTest } from './shm.js';
+import { generateFuzzTarget, generateRoundTripHarness, generateTestSupportHeader, testedModels } from './testing.js';
+import { CompactField, compactElements, findCompactFields, generateCompactArrayCodec, generateCompactRuntime } from './compact.js';
 
 export class CppGenerator extends BaseGenerator {
   protected getLanguageName(): string {
@@ -31,13 +58,216 @@ export class CppGenerator extends BaseGenerator {
       content: this.generateImplementation(),
     });
 
+    // チェックサムアルゴリズム（@checksum がある場合）
+    const frameHeader = findFrameHeader(this.ir);
+    if (frameHeader?.checksum) {
+      files.push({
+        filename: 'checksum.hpp',
+        content: generateChecksumHeader(this.namespaceName()),
+      });
+    }
+
+    // コンパイル時に有効化する計測フック
+    files.push({
+      filename: 'instrumentation.hpp',
+      content: generateInstrumentationHeader(this.ir, this.namespaceName()),
+    });
+    files.push({
+      filename: 'instrumentation.cpp',
+      content: generateInstrumentationImpl(this.ir, this.namespaceName()),
+    });
+
+    // ストリーム用フレームデコーダー（@frame_header がある場合）
+    if (frameHeader) {
+      files.push({
+        filename: 'frame_decoder.hpp',
+        content: generateFrameDecoderHeader(frameHeader, this.namespaceName()),
+      });
+      files.push({
+        filename: 'frame_decoder.cpp',
+        content: generateFrameDecoderImpl(frameHeader, this.namespaceName()),
+      });
+    }
+
+    // 記録済みトラフィックのキャプチャファイル（sequence_id でインデックスを張る）
+    if (frameHeader && frameHeader.model.fields.some(f => f.name === 'sequence_id')) {
+      files.push({
+        filename: 'capture.hpp',
+        content: generateCaptureHeader(frameHeader, this.namespaceName()),
+      });
+      files.push({
+        filename: 'capture.cpp',
+        content: generateCaptureImpl(this.ir, frameHeader, this.namespaceName()),
+      });
+      // 大きなキャプチャを複数スレッドでデコード（sequence_id 順の配送に対応）
+      files.push({
+        filename: 'parallel_decode.hpp',
+        content: generateParallelDecodeHeader(frameHeader, this.namespaceName()),
+      });
+      files.push({
+        filename: 'parallel_decode.cpp',
+        content: generateParallelDecodeImpl(frameHeader, this.namespaceName()),
+      });
+    }
+
+    // sequence_id による要求/応答の対応付けとタイムアウト
+    if (frameHeader && canGenerateCorrelation(this.ir, frameHeader)) {
+      files.push({
+        filename: 'correlation.hpp',
+        content: generateCorrelationHeader(this.ir, frameHeader, this.namespaceName()),
+      });
+
+      // コルーチンによる非同期クライアント/サーバー（epoll）
+      files.push({
+        filename: 'transport.hpp',
+        content: generateTransportHeader(this.ir, frameHeader, this.namespaceName()),
+      });
+      files.push({
+        filename: 'transport.cpp',
+        content: generateTransportImpl(frameHeader, this.namespaceName()),
+      });
+    }
+
+    // 同一ホストのプロセス間で共有メモリのリングにフレームをブロードキャスト
+    if (frameHeader) {
+      files.push({
+        filename: 'shm_ring.hpp',
+        content: generateShmRingHeader(frameHeader, this.namespaceName()),
+      });
+      files.push({
+        filename: 'shm_ring.cpp',
+        content: generateShmRingImpl(frameHeader, this.namespaceName()),
+      });
+    }
+
+    // 固定長モデル配列の列指向（SoA）コンテナとカラムファイル
+    const columnarModels = findColumnarModels(this.ir);
+    if (columnarModels.length > 0) {
+      files.push({
+        filename: 'columns.hpp',
+        content: generateColumnsHeader(columnarModels, this.namespaceName()),
+      });
+      files.push({
+        filename: 'columns.cpp',
+        content: generateColumnsImpl(this.ir, columnarModels, this.namespaceName()),
+      });
+    }
+
+    // スレッド間受け渡し用のロックフリーリング
+    files.push({
+      filename: 'message_ring.hpp',
+      content: generateMessageRingHeader(this.namespaceName()),
+    });
+
+    // 実行時に読み込むスキーマ記述子用のテーブル駆動コーデック
+    files.push({
+      filename: 'dynamic_codec.hpp',
+      content: generateDynamicCodecHeader(this.namespaceName()),
+    });
+    files.push({
+      filename: 'dynamic_codec.cpp',
+      content: generateDynamicCodecImpl(this.ir, this.namespaceName()),
+    });
+
+    // Google Benchmark スイートと CMake プロジェクト
+    files.push({
+      filename: 'bench_protocol.cpp',
+      content: generateBenchmarkSuite(this.ir, this.namespaceName(), {
+        checksumClasses: frameHeader?.checksum ? ['Crc16Ccitt', 'Crc32c'] : [],
+        frameHeader: frameHeader?.checksum ? frameHeader.model.name : undefined,
+      }),
+    });
+
+    // 往復ストレステストとモデルごとの libFuzzer ターゲット
+    files.push({
+      filename: 'test_codec.hpp',
+      content: generateTestSupportHeader(this.ir, this.namespaceName(), frameHeader),
+    });
+    files.push({
+      filename: 'test_roundtrip.cpp',
+      content: generateRoundTripHarness(this.ir, this.namespaceName(), frameHeader),
+    });
+    files.push({
+      filename: 'test_rings.cpp',
+      content: generateMessageRingTest(this.namespaceName()),
+    });
+
+    const tests: CMakeTest[] = [
+      {
+        name: 'roundtrip',
+        source: 'test_roundtrip.cpp',
+        args: '--iterations 20000',
+        comment: 'Quick enough for every build; run it by hand with --iterations 10000000 before landing a fast path',
+      },
+      { name: 'rings', source: 'test_rings.cpp', args: '--iterations 100000' },
+    ];
+    // 対応付け・キャプチャ・並列デコード・トランスポート・共有メモリリングのテスト（生成した場合のみ）
+    if (files.some(f => f.filename === 'correlation.hpp')) {
+      files.push({
+        filename: 'test_correlation.cpp',
+        content: generateCorrelationTest(this.ir, frameHeader!, this.namespaceName()),
+      });
+      tests.push({ name: 'correlation', source: 'test_correlation.cpp', args: '--iterations 100000' });
+    }
+    if (files.some(f => f.filename === 'capture.hpp')) {
+      files.push({
+        filename: 'test_capture.cpp',
+        content: generateCaptureTest(frameHeader!, this.namespaceName()),
+      });
+      tests.push({ name: 'capture', source: 'test_capture.cpp', args: '--iterations 2000' });
+    }
+    if (files.some(f => f.filename === 'parallel_decode.hpp')) {
+      files.push({
+        filename: 'test_parallel_decode.cpp',
+        content: generateParallelDecodeTest(this.ir, frameHeader!, this.namespaceName()),
+      });
+      tests.push({ name: 'parallel_decode', source: 'test_parallel_decode.cpp', args: '--iterations 20000' });
+    }
+    if (files.some(f => f.filename === 'transport.hpp')) {
+      files.push({
+        filename: 'test_transport.cpp',
+        content: generateTransportTest(this.ir, frameHeader!, this.namespaceName()),
+      });
+      tests.push({ name: 'transport', source: 'test_transport.cpp', args: '--iterations 2000' });
+    }
+    if (files.some(f => f.filename === 'shm_ring.hpp')) {
+      files.push({
+        filename: 'test_shm_ring.cpp',
+        content: generateShmRingTest(frameHeader!, this.namespaceName()),
+      });
+      tests.push({ name: 'shm_ring', source: 'test_shm_ring.cpp', args: '--iterations 20000' });
+    }
+    files.push({
+      filename: 'fuzz_protocol.cpp',
+      content: generateFuzzTarget(this.namespaceName(), frameHeader),
+    });
+
+    files.push({
+      filename: 'CMakeLists.txt',
+      content: generateCMakeLists({
+        sources: files.map(f => f.filename).filter(name => name.endsWith('.cpp') && !/^(bench|test|fuzz)_/.test(name)),
+        benchmarkSource: 'bench_protocol.cpp',
+        tests,
+        fuzzSource: 'fuzz_protocol.cpp',
+        fuzzTargets: testedModels(this.ir).map(m => m.name),
+        fuzzFrames: frameHeader !== undefined,
+      }),
+    });
+
     return files;
   }
 
+  /**
+   * C++ 名前空間名
+   */
+  private namespaceName(): string {
+    return this.ir.namespace.replace(/\./g, '_').toLowerCase() || 'binary_protocol';
+  }
+
   private generateHeader(): string {
     const lines: string[] = [];
     const guardName = 'BINARY_PROTOCOL_HPP';
-    const ns = this.ir.namespace.replace(/\./g, '_').toLowerCase() || 'binary_protocol';
+    const ns = this.namespaceName();
 
     lines.push('/**');
     lines.push(' * Auto-generated binary protocol types');
@@ -48,12 +278,43 @@ export class CppGenerator extends BaseGenerator {
     lines.push(`#ifndef ${guardName}`);
     lines.push(`#define ${guardName}`);
     lines.push('');
+    lines.push('#include <algorithm>');
+    lines.push('#include <bit>');
     lines.push('#include <cstdint>');
+    lines.push('#include <cstdio>');
+    lines.push('#include <cstdlib>');
     lines.push('#include <cstring>');
+    lines.push('#include <limits>');
+    lines.push('#include <memory>');
+    lines.push('#include <memory_resource>');
     lines.push('#include <string>');
     lines.push('#include <vector>');
     lines.push('#include <array>');
+    lines.push('#include <optional>');
+    lines.push('#include <span>');
     lines.push('#include <stdexcept>');
+    lines.push('#include <type_traits>');
+    lines.push('#include <utility>');
+    lines.push('#include <variant>');
+    if (findFrameHeader(this.ir)?.checksum) {
+      lines.push('');
+      lines.push('#include "checksum.hpp"');
+    }
+    lines.push('');
+    if (findCompactFields(this.ir).length > 0) {
+      lines.push('#if defined(__BMI2__)');
+      lines.push('#include <immintrin.h>');
+      lines.push('#endif');
+      lines.push('');
+    }
+    lines.push('#if __has_include(<sys/uio.h>)');
+    lines.push('#include <sys/uio.h>');
+    lines.push('#define BINARY_PROTOCOL_HAS_IOVEC 1');
+    lines.push('#else');
+    lines.push('#define BINARY_PROTOCOL_HAS_IOVEC 0');
+    lines.push('#endif');
+    lines.push('');
+    lines.push(generateThrowMacro(ns));
     lines.push('');
     lines.push(`namespace ${ns} {`);
     lines.push('');
@@ -70,27 +331,122 @@ export class CppGenerator extends BaseGenerator {
     }
     lines.push('');
 
-    // 構造体定義
+    // 構造体定義（可変長モデルにはゼロコピーのビュー型を併記）
     for (const model of this.ir.models) {
       lines.push(this.generateStruct(model));
       lines.push('');
+      if (this.isArrayElementModel(model)) {
+        lines.push(this.generateArrayView(model));
+        lines.push('');
+      }
+      if (model.hasVariableLength) {
+        lines.push(this.generateViewStruct(model));
+        lines.push('');
+      }
     }
 
+    // 例外を投げないデコードの結果型
+    lines.push(generateDecodeResultHeader());
+    lines.push('');
+
+    // バイトオーダー変換
+    lines.push(this.generateByteOrderHeader());
+    lines.push('');
+
     // BinaryWriter クラス
     lines.push(this.generateBinaryWriterHeader());
     lines.push('');
 
+    // SpanWriter クラス
+    lines.push(this.generateSpanWriterHeader());
+    lines.push('');
+
     // BinaryReader クラス
     lines.push(this.generateBinaryReaderHeader());
     lines.push('');
 
+    // スキャッター/ギャザー用セグメントリスト
+    lines.push(generateGatherListHeader());
+    lines.push('');
+
+    // 圧縮エンコードの varint（@compact）
+    const compactFields = findCompactFields(this.ir);
+    if (compactFields.length > 0) {
+      lines.push(generateCompactRuntime());
+      lines.push('');
+    }
+
+    // エンコードサイズ（constexpr）
+    for (const model of this.ir.models) {
+      lines.push(this.generateEncodedSize(model));
+    }
+    lines.push('');
+
+    // 長さプレフィックスの上限検証（encodedSize は上限を超えたバイトも数える）
+    lines.push('/// Throws std::length_error when a variable-length field does not fit its length prefix.');
+    lines.push('/// Encoders call this before writing anything, so a rejected message leaves no partial output.');
+    for (const model of this.ir.models) {
+      lines.push(this.generateLengthPrefixCheck(model));
+    }
+    lines.push('');
+
     // シリアライザー関数宣言
     for (const model of this.ir.models) {
+      lines.push(`size_t serializeInto(const ${model.name}& data, std::span<uint8_t> out);`);
       lines.push(`std::vector<uint8_t> serialize(const ${model.name}& data);`);
       lines.push(`${model.name} deserialize${model.name}(const uint8_t* data, size_t size);`);
+      lines.push(`DecodeResult<${model.name}> tryDeserialize${model.name}(const uint8_t* data, size_t size);`);
+      if (model.hasVariableLength) {
+        lines.push(`${model.name}View view${model.name}(const uint8_t* data, size_t size);`);
+        lines.push(`void serializeGather(const ${model.name}& data, GatherList& out);`);
+      }
+    }
+    lines.push('');
+
+    // 圧縮エンコード（@compact）
+    for (const { model, field } of compactFields) {
+      lines.push(`/// ${model.name} with ${field.name} compact-encoded (@compact); not wire-compatible with serialize()`);
+      lines.push(`void serializeCompact(const ${model.name}& data, std::vector<uint8_t>& out);`);
+      lines.push(`std::vector<uint8_t> serializeCompact(const ${model.name}& data);`);
+      lines.push(`${model.name} deserializeCompact${model.name}(const uint8_t* data, size_t size);`);
+      lines.push(`DecodeResult<${model.name}> tryDeserializeCompact${model.name}(const uint8_t* data, size_t size);`);
+      lines.push('');
     }
+
+    // 再利用可能なライター向けオーバーロード
+    lines.push(this.generateWriterSerialize());
     lines.push('');
 
+    // 定数式で使えるエンコーダー（std::array を返す）
+    lines.push(this.generateConstantEncoders());
+    lines.push('');
+
+    // COMMAND_ID ディスパッチ
+    lines.push(generateDispatchHeader(this.ir, findFrameHeader(this.ir)));
+    lines.push('');
+
+    // バッチビルダー/イテレーター（@batch）
+    const batchLayouts = findBatchLayouts(this.ir);
+    if (batchLayouts.length > 0) {
+      lines.push(generateBatchHeader(batchLayouts));
+      lines.push('');
+    }
+
+    // フレームチェックサム（@checksum）
+    const frameHeader = findFrameHeader(this.ir);
+    if (frameHeader?.checksum) {
+      lines.push(generateFrameChecksumDecls(frameHeader));
+      lines.push('');
+    }
+
+    // 定数式で組み立てるフレームとギャザーエンコード（@frame_header）
+    if (frameHeader) {
+      lines.push(generateConstantFrames(frameHeader));
+      lines.push('');
+      lines.push(generateFrameGather(frameHeader));
+      lines.push('');
+    }
+
     lines.push(`} // namespace ${ns}`);
     lines.push('');
     lines.push(`#endif // ${guardName}`);
@@ -130,7 +486,11 @@ export class CppGenerator extends BaseGenerator {
       lines.push(`// Command ID: 0x${model.commandId.toString(16).toUpperCase().padStart(2, '0')}`);
     }
 
-    lines.push('#pragma pack(push, 1)');
+    // 可変長モデルは std::vector 等を持つためパックしない（メンバーのアライメントを保つ）
+    const packed = model.fixedSize !== undefined;
+    if (packed) {
+      lines.push('#pragma pack(push, 1)');
+    }
     lines.push(`struct ${model.name} {`);
 
     for (const field of model.fields) {
@@ -147,13 +507,39 @@ export class CppGenerator extends BaseGenerator {
       lines.push(`${this.indent(1)}static constexpr uint8_t COMMAND_ID = 0x${model.commandId.toString(16).toUpperCase().padStart(2, '0')};`);
     }
 
+    // エンコード後の固定サイズ
+    if (model.fixedSize !== undefined) {
+      if (model.commandId === undefined) {
+        lines.push('');
+      }
+      lines.push(`${this.indent(1)}static constexpr size_t ENCODED_SIZE = ${model.fixedSize};`);
+    }
+
+    // フレーム同期用の固定値（@magic）
+    for (const field of model.fields) {
+      const magic = field.decorators.find(d => d.name === 'magic');
+      if (magic && typeof magic.args[0] === 'number') {
+        const hex = magic.args[0].toString(16).toUpperCase();
+        lines.push(`${this.indent(1)}static constexpr ${this.mapTypeToCpp(field)} ${field.name.toUpperCase()} = 0x${hex};`);
+      }
+    }
+
+    // メンバー単位の比較（往復テストで使用）
+    lines.push('');
+    lines.push(`${this.indent(1)}bool operator==(const ${model.name}&) const = default;`);
+
     lines.push('};');
-    lines.push('#pragma pack(pop)');
+    if (packed) {
+      lines.push('#pragma pack(pop)');
+    }
 
     // サイズ情報
     if (model.fixedSize !== undefined) {
       lines.push(`static_assert(sizeof(${model.name}) == ${model.fixedSize}, "Size mismatch for ${model.name}");`);
     }
+    if (isBulkCopyModel(this.ir, model)) {
+      lines.push(`static_assert(std::is_trivially_copyable_v<${model.name}>, "${model.name} must be trivially copyable");`);
+    }
 
     return lines.join('\n');
   }
@@ -219,35 +605,303 @@ export class CppGenerator extends BaseGenerator {
     }
   }
 
+  /**
+   * バイトオーダー変換ヘルパー（コンパイル時に選択）
+   */
+  private generateByteOrderHeader(): string {
+    const lines: string[] = [];
+
+    // スキーマが Endian を宣言していない場合は組み込みで定義
+    if (!this.ir.enums.some(e => e.name === 'Endian')) {
+      lines.push('enum class Endian : uint8_t {');
+      lines.push(`${this.indent(1)}Little = 0,`);
+      lines.push(`${this.indent(1)}Big = 1,`);
+      lines.push('};');
+      lines.push('');
+    }
+
+    lines.push(`/// Byte order of the host, resolved at compile time
+inline constexpr Endian kNativeEndian =
+    std::endian::native == std::endian::little ? Endian::Little : Endian::Big;
+
+namespace detail {
+
+template<typename T>
+constexpr T byteswap(T value) {
+    static_assert(std::is_unsigned_v<T>, "byteswap requires an unsigned type");
+#if defined(__GNUC__) || defined(__clang__)
+    if constexpr (sizeof(T) == 1) {
+        return value;
+    } else if constexpr (sizeof(T) == 2) {
+        return __builtin_bswap16(value);
+    } else if constexpr (sizeof(T) == 4) {
+        return __builtin_bswap32(value);
+    } else {
+        return __builtin_bswap64(value);
+    }
+#else
+    T result = 0;
+    for (size_t i = 0; i < sizeof(T); i++) {
+        result = static_cast<T>((result << 8) | ((value >> (i * 8)) & 0xFF));
+    }
+    return result;
+#endif
+}
+
+/// Convert between host and wire byte order; a no-op when they match
+template<Endian E, typename T>
+constexpr T toWire(T value) {
+    if constexpr (E == kNativeEndian) {
+        return value;
+    } else {
+        return byteswap(value);
+    }
+}
+
+// memcpy is not usable in constant evaluation; copy byte-wise there instead
+template<Endian E, typename T>
+constexpr void store(uint8_t* out, T value) {
+    value = toWire<E>(value);
+    if (std::is_constant_evaluated()) {
+        const auto bytes = std::bit_cast<std::array<uint8_t, sizeof(T)>>(value);
+        for (size_t i = 0; i < sizeof(T); i++) {
+            out[i] = bytes[i];
+        }
+    } else {
+        std::memcpy(out, &value, sizeof(T));
+    }
+}
+
+template<Endian E, typename T>
+constexpr T load(const uint8_t* in) {
+    if (std::is_constant_evaluated()) {
+        std::array<uint8_t, sizeof(T)> bytes{};
+        for (size_t i = 0; i < sizeof(T); i++) {
+            bytes[i] = in[i];
+        }
+        return toWire<E>(std::bit_cast<T>(bytes));
+    }
+    T value;
+    std::memcpy(&value, in, sizeof(T));
+    return toWire<E>(value);
+}
+
+} // namespace detail`);
+
+    return lines.join('\n');
+  }
+
+  /**
+   * BinaryWriter に追記する serialize（serializeInto を確保済み領域に直接適用）
+   */
+  /**
+   * 定数式で評価可能な serializeToArray（固定長モデルはサイズ自明、可変長モデルはサイズを指定）
+   */
+  private generateConstantEncoders(): string {
+    const sections: string[] = [];
+
+    sections.push(`// ============================================
+// Compile-time encoding
+// ============================================`);
+
+    for (const model of this.ir.models) {
+      const lines: string[] = [];
+      if (model.fixedSize !== undefined) {
+        lines.push(`constexpr std::array<uint8_t, ${model.name}::ENCODED_SIZE> serializeToArray(const ${model.name}& data) {`);
+        lines.push(`${this.indent(1)}std::array<uint8_t, ${model.name}::ENCODED_SIZE> out{};`);
+        for (const leaf of flattenFixedFields(this.ir, model)) {
+          lines.push(`${this.indent(1)}${this.flatStore(leaf, 'out.data()', `data.${leaf.path}`, true)}`);
+        }
+        lines.push(`${this.indent(1)}return out;`);
+        lines.push('}');
+        sections.push(lines.join('\n'));
+        continue;
+      }
+
+      // 可変長モデルは長さプレフィックス付きフィールドのみ対応
+      if (model.fields.some(f => f.size.fixedSize === undefined && !f.size.lengthPrefixType &&
+          this.fixedWireSize(f) === 0)) {
+        continue;
+      }
+      lines.push(`/// N must equal encodedSize(data); the message owns vectors, so call this inside a constexpr lambda`);
+      lines.push('template<size_t N>');
+      lines.push(`constexpr std::array<uint8_t, N> serializeToArray(const ${model.name}& data) {`);
+      lines.push(`${this.indent(1)}checkLengthPrefixes(data);`);
+      lines.push(`${this.indent(1)}if (encodedSize(data) != N) BINARY_PROTOCOL_THROW(std::length_error("serializeToArray size does not match encodedSize"));`);
+      lines.push(`${this.indent(1)}std::array<uint8_t, N> out{};`);
+      lines.push(`${this.indent(1)}uint8_t* p = out.data();`);
+
+      let segment: FieldDefinition[] = [];
+      for (const field of model.fields) {
+        if (!field.size.lengthPrefixType) {
+          segment.push(field);
+          continue;
+        }
+        const fixedSize = segment.reduce((total, f) => total + this.fixedWireSize(f), 0);
+        for (const leaf of this.segmentLeaves(model, segment)) {
+          lines.push(`${this.indent(1)}${this.flatStore(leaf, 'p', `data.${leaf.path}`, true)}`);
+        }
+        segment = [];
+
+        const prefixType = this.mapPrimitiveTypeToCpp(field.size.lengthPrefixType);
+        const prefixSize = PRIMITIVE_SIZES[field.size.lengthPrefixType as keyof typeof PRIMITIVE_SIZES];
+        const accessor = `data.${field.name}`;
+        if (field.type.kind === 'array') {
+          const element = this.arrayElementModel(field);
+          lines.push(`${this.indent(1)}detail::store<${this.endianConstant(model)}>(p + ${fixedSize}, static_cast<${prefixType}>(${accessor}.size() * ${element.name}::ENCODED_SIZE));`);
+          lines.push(`${this.indent(1)}p += ${fixedSize + prefixSize};`);
+          lines.push(`${this.indent(1)}for (const ${element.name}& element : ${accessor}) {`);
+          for (const leaf of flattenFixedFields(this.ir, element)) {
+            lines.push(`${this.indent(2)}${this.flatStore(leaf, 'p', `element.${leaf.path}`, true)}`);
+          }
+          lines.push(`${this.indent(2)}p += ${element.name}::ENCODED_SIZE;`);
+          lines.push(`${this.indent(1)}}`);
+        } else {
+          lines.push(`${this.indent(1)}detail::store<${this.endianConstant(model)}>(p + ${fixedSize}, static_cast<${prefixType}>(${accessor}.size()));`);
+          lines.push(`${this.indent(1)}p += ${fixedSize + prefixSize};`);
+          lines.push(`${this.indent(1)}p = std::copy(${accessor}.begin(), ${accessor}.end(), p);`);
+        }
+      }
+      for (const leaf of this.segmentLeaves(model, segment)) {
+        lines.push(`${this.indent(1)}${this.flatStore(leaf, 'p', `data.${leaf.path}`, true)}`);
+      }
+      lines.push(`${this.indent(1)}return out;`);
+      lines.push('}');
+      sections.push(lines.join('\n'));
+    }
+
+    return sections.join('\n\n');
+  }
+
+  /**
+   * ギャザーエンコード（可変長フィールドはコピーせずセグメントとして参照）
+   */
+  private generateGatherSerializer(model: ModelDefinition): string {
+    const lines: string[] = [];
+    let declared = false;
+
+    lines.push(`void serializeGather(const ${model.name}& data, GatherList& out) {`);
+    lines.push(`${this.indent(1)}checkLengthPrefixes(data);`);
+    let segment: FieldDefinition[] = [];
+    const flush = (prefixed: FieldDefinition | undefined) => {
+      const fixedSize = segment.reduce((total, f) => total + this.fixedWireSize(f), 0);
+      const prefixSize = prefixed
+        ? PRIMITIVE_SIZES[prefixed.size.lengthPrefixType! as keyof typeof PRIMITIVE_SIZES]
+        : 0;
+      if (fixedSize + prefixSize === 0) return;
+      lines.push(`${this.indent(1)}${declared ? '' : 'uint8_t* '}p = out.allocate(${fixedSize + prefixSize}).data();`);
+      declared = true;
+      for (const leaf of this.segmentLeaves(model, segment)) {
+        lines.push(`${this.indent(1)}${this.flatStore(leaf, 'p', `data.${leaf.path}`)}`);
+      }
+      if (prefixed) {
+        const prefixType = this.mapPrimitiveTypeToCpp(prefixed.size.lengthPrefixType!);
+        const accessor = `data.${prefixed.name}`;
+        if (prefixed.type.kind === 'array') {
+          const element = this.arrayElementModel(prefixed);
+          const byteLength = `${accessor}.size() * ${element.name}::ENCODED_SIZE`;
+          lines.push(`${this.indent(1)}detail::store<${this.endianConstant(model)}>(p + ${fixedSize}, static_cast<${prefixType}>(${byteLength}));`);
+          const convert = [
+            `if (!${accessor}.empty()) {`,
+            `${this.indent(1)}encode${element.name}Array(${accessor}, out.spill(${byteLength}).data());`,
+            '}',
+          ];
+          if (isBulkCopyModel(this.ir, element)) {
+            lines.push(`${this.indent(1)}if constexpr (kNativeEndian == ${this.endianConstant(element)}) {`);
+            lines.push(`${this.indent(2)}out.appendBytes({reinterpret_cast<const uint8_t*>(${accessor}.data()), ${byteLength}});`);
+            lines.push(`${this.indent(1)}} else {`);
+            lines.push(...convert.map(line => this.indent(2) + line));
+            lines.push(`${this.indent(1)}}`);
+          } else {
+            lines.push(...convert.map(line => this.indent(1) + line));
+          }
+        } else {
+          lines.push(`${this.indent(1)}detail::store<${this.endianConstant(model)}>(p + ${fixedSize}, static_cast<${prefixType}>(${accessor}.size()));`);
+          lines.push(`${this.indent(1)}out.appendBytes(${accessor});`);
+        }
+      }
+      segment = [];
+    };
+    for (const field of model.fields) {
+      if (field.size.lengthPrefixType) {
+        flush(field);
+      } else {
+        segment.push(field);
+      }
+    }
+    flush(undefined);
+    lines.push('}');
+    return lines.join('\n');
+  }
+
+  private generateWriterSerialize(): string {
+    return `/**
+ * Appends the encoded message to writer and returns the number of bytes written.
+ * The message is encoded in place in the writer's buffer, so a long-lived writer
+ * that is cleared between messages encodes without allocating.
+ */
+template<typename T, Endian E, typename Alloc>
+    requires requires(const T& message, std::span<uint8_t> out) { serializeInto(message, out); }
+size_t serialize(const T& data, BasicBinaryWriter<E, Alloc>& writer) {
+    checkLengthPrefixes(data);
+    return serializeInto(data, writer.allocate(encodedSize(data)));
+}`;
+  }
+
   private generateBinaryWriterHeader(): string {
     return `/**
- * Binary data writer
+ * Growable binary data writer.
+ * The buffer is allocated through Alloc (e.g. std::pmr::polymorphic_allocator
+ * for arena backing) or borrowed from the caller. clear() keeps the capacity,
+ * so one writer per thread can encode any number of messages without
+ * reallocating once it has grown to the largest message.
  */
-class BinaryWriter {
+template<Endian E, typename Alloc = std::allocator<uint8_t>>
+class BasicBinaryWriter {
 public:
-    void writeUint8(uint8_t value);
-    void writeUint16(uint16_t value);
-    void writeUint32(uint32_t value);
-    void writeUint64(uint64_t value);
-    void writeInt8(int8_t value);
-    void writeInt16(int16_t value);
-    void writeInt32(int32_t value);
-    void writeInt64(int64_t value);
-    void writeFloat32(float value);
-    void writeFloat64(double value);
-    void writeBool(bool value);
+    using buffer_type = std::vector<uint8_t, Alloc>;
+
+    BasicBinaryWriter() : buffer_(&owned_) {}
+    explicit BasicBinaryWriter(const Alloc& alloc) : owned_(alloc), buffer_(&owned_) {}
+    /// Appends to a caller-owned buffer, which must outlive the writer
+    explicit BasicBinaryWriter(buffer_type& external) : buffer_(&external) {}
+
+    BasicBinaryWriter(BasicBinaryWriter&& other) noexcept
+        : owned_(std::move(other.owned_)), buffer_(other.buffer_ == &other.owned_ ? &owned_ : other.buffer_) {
+        other.buffer_ = &other.owned_;
+    }
+    BasicBinaryWriter(const BasicBinaryWriter&) = delete;
+    BasicBinaryWriter& operator=(const BasicBinaryWriter&) = delete;
+    BasicBinaryWriter& operator=(BasicBinaryWriter&&) = delete;
+
+    void writeUint8(uint8_t value) { buffer_->push_back(value); }
+    void writeUint16(uint16_t value) { append(value); }
+    void writeUint32(uint32_t value) { append(value); }
+    void writeUint64(uint64_t value) { append(value); }
+    void writeInt8(int8_t value) { writeUint8(static_cast<uint8_t>(value)); }
+    void writeInt16(int16_t value) { append(static_cast<uint16_t>(value)); }
+    void writeInt32(int32_t value) { append(static_cast<uint32_t>(value)); }
+    void writeInt64(int64_t value) { append(static_cast<uint64_t>(value)); }
+    void writeFloat32(float value) { append(std::bit_cast<uint32_t>(value)); }
+    void writeFloat64(double value) { append(std::bit_cast<uint64_t>(value)); }
+    void writeBool(bool value) { writeUint8(value ? 1 : 0); }
 
     template<size_t N>
     void writeFixedString(const std::array<char, N>& value) {
-        buffer_.insert(buffer_.end(), value.begin(), value.end());
+        buffer_->insert(buffer_->end(), value.begin(), value.end());
+    }
+
+    void writeBytes(const uint8_t* data, size_t size) {
+        buffer_->insert(buffer_->end(), data, data + size);
     }
 
-    void writeBytes(const uint8_t* data, size_t size);
-    void writeBytes(const std::vector<uint8_t>& data);
+    void writeBytes(const std::vector<uint8_t>& data) {
+        buffer_->insert(buffer_->end(), data.begin(), data.end());
+    }
 
     template<size_t N>
     void writeBytes(const std::array<uint8_t, N>& data) {
-        buffer_.insert(buffer_.end(), data.begin(), data.end());
+        buffer_->insert(buffer_->end(), data.begin(), data.end());
     }
 
     template<typename LengthT>
@@ -262,52 +916,171 @@ public:
         writeBytes(data);
     }
 
-    const std::vector<uint8_t>& data() const { return buffer_; }
-    size_t size() const { return buffer_.size(); }
+    /// Grows the buffer by size bytes and returns them for in-place encoding
+    std::span<uint8_t> allocate(size_t size) {
+        const size_t offset = buffer_->size();
+        buffer_->resize(offset + size);
+        return {buffer_->data() + offset, size};
+    }
+
+    /// Overwrites an already written value, e.g. a length known only after the body
+    template<typename T, Endian Order = E>
+    void patch(size_t offset, T value) {
+        if (offset + sizeof(T) > buffer_->size()) BINARY_PROTOCOL_THROW(std::runtime_error("Patch out of range"));
+        detail::store<Order>(buffer_->data() + offset, value);
+    }
+
+    void reserve(size_t capacity) { buffer_->reserve(capacity); }
+    /// Drops the written bytes but keeps the capacity
+    void clear() { buffer_->clear(); }
+    /// Same as clear(); mirrors FrameDecoder::reset()
+    void reset() { clear(); }
+
+    /// Moves the written bytes out; the writer starts over with an empty buffer
+    buffer_type release() {
+        buffer_type result = std::move(*buffer_);
+        buffer_->clear();
+        return result;
+    }
+
+    const buffer_type& data() const { return *buffer_; }
+    std::span<const uint8_t> view() const { return {buffer_->data(), buffer_->size()}; }
+    size_t size() const { return buffer_->size(); }
+    size_t capacity() const { return buffer_->capacity(); }
+
+private:
+    template<typename T>
+    void append(T value) {
+        const size_t offset = buffer_->size();
+        buffer_->resize(offset + sizeof(T));
+        detail::store<E>(buffer_->data() + offset, value);
+    }
+
+    buffer_type owned_;
+    buffer_type* buffer_;
+};
+
+using BinaryWriter = BasicBinaryWriter<Endian::Little>;
+using PmrBinaryWriter = BasicBinaryWriter<Endian::Little, std::pmr::polymorphic_allocator<uint8_t>>;`;
+  }
+
+  private generateSpanWriterHeader(): string {
+    return `/**
+ * Binary data writer over a caller-owned buffer.
+ * Performs no bounds checks and never allocates; serializeInto() validates
+ * the total encoded size once before any field is written.
+ */
+template<Endian E>
+class BasicSpanWriter {
+public:
+    explicit BasicSpanWriter(std::span<uint8_t> buffer) : buffer_(buffer) {}
+
+    void writeUint8(uint8_t value) { buffer_[offset_++] = value; }
+    void writeUint16(uint16_t value) { put(value); }
+    void writeUint32(uint32_t value) { put(value); }
+    void writeUint64(uint64_t value) { put(value); }
+    void writeInt8(int8_t value) { writeUint8(static_cast<uint8_t>(value)); }
+    void writeInt16(int16_t value) { put(static_cast<uint16_t>(value)); }
+    void writeInt32(int32_t value) { put(static_cast<uint32_t>(value)); }
+    void writeInt64(int64_t value) { put(static_cast<uint64_t>(value)); }
+    void writeFloat32(float value) { put(std::bit_cast<uint32_t>(value)); }
+    void writeFloat64(double value) { put(std::bit_cast<uint64_t>(value)); }
+    void writeBool(bool value) { writeUint8(value ? 1 : 0); }
+
+    template<size_t N>
+    void writeFixedString(const std::array<char, N>& value) {
+        std::memcpy(buffer_.data() + offset_, value.data(), N);
+        offset_ += N;
+    }
+
+    void writeBytes(std::span<const uint8_t> data) {
+        if (!data.empty()) {
+            std::memcpy(buffer_.data() + offset_, data.data(), data.size());
+        }
+        offset_ += data.size();
+    }
+
+    template<typename LengthT>
+    void writeLengthPrefixedBytes(std::span<const uint8_t> data) {
+        if constexpr (sizeof(LengthT) == 1) {
+            writeUint8(static_cast<uint8_t>(data.size()));
+        } else if constexpr (sizeof(LengthT) == 2) {
+            writeUint16(static_cast<uint16_t>(data.size()));
+        } else if constexpr (sizeof(LengthT) == 4) {
+            writeUint32(static_cast<uint32_t>(data.size()));
+        }
+        writeBytes(data);
+    }
+
+    /// Unwritten tail of the buffer, used to encode nested models in place
+    std::span<uint8_t> remaining() const { return buffer_.subspan(offset_); }
+    void skip(size_t length) { offset_ += length; }
+
+    size_t position() const { return offset_; }
 
 private:
-    std::vector<uint8_t> buffer_;
-};`;
+    template<typename T>
+    void put(T value) {
+        detail::store<E>(buffer_.data() + offset_, value);
+        offset_ += sizeof(T);
+    }
+
+    std::span<uint8_t> buffer_;
+    size_t offset_ = 0;
+};
+
+using SpanWriter = BasicSpanWriter<Endian::Little>;`;
   }
 
   private generateBinaryReaderHeader(): string {
     return `/**
  * Binary data reader
  */
-class BinaryReader {
+template<Endian E>
+class BasicBinaryReader {
 public:
-    BinaryReader(const uint8_t* data, size_t size);
-
-    uint8_t readUint8();
-    uint16_t readUint16();
-    uint32_t readUint32();
-    uint64_t readUint64();
-    int8_t readInt8();
-    int16_t readInt16();
-    int32_t readInt32();
-    int64_t readInt64();
-    float readFloat32();
-    double readFloat64();
-    bool readBool();
+    BasicBinaryReader(const uint8_t* data, size_t size)
+        : data_(data), size_(size), offset_(0) {}
+
+    uint8_t readUint8() {
+        if (offset_ + 1 > size_) BINARY_PROTOCOL_THROW(std::runtime_error("Buffer underflow"));
+        return data_[offset_++];
+    }
+
+    uint16_t readUint16() { return take<uint16_t>(); }
+    uint32_t readUint32() { return take<uint32_t>(); }
+    uint64_t readUint64() { return take<uint64_t>(); }
+    int8_t readInt8() { return static_cast<int8_t>(readUint8()); }
+    int16_t readInt16() { return static_cast<int16_t>(take<uint16_t>()); }
+    int32_t readInt32() { return static_cast<int32_t>(take<uint32_t>()); }
+    int64_t readInt64() { return static_cast<int64_t>(take<uint64_t>()); }
+    float readFloat32() { return std::bit_cast<float>(take<uint32_t>()); }
+    double readFloat64() { return std::bit_cast<double>(take<uint64_t>()); }
+    bool readBool() { return readUint8() != 0; }
 
     template<size_t N>
     std::array<char, N> readFixedString() {
         std::array<char, N> result{};
         if (offset_ + N > size_) {
-            throw std::runtime_error("Buffer underflow");
+            BINARY_PROTOCOL_THROW(std::runtime_error("Buffer underflow"));
         }
         std::memcpy(result.data(), data_ + offset_, N);
         offset_ += N;
         return result;
     }
 
-    std::vector<uint8_t> readBytes(size_t length);
+    std::vector<uint8_t> readBytes(size_t length) {
+        if (offset_ + length > size_) BINARY_PROTOCOL_THROW(std::runtime_error("Buffer underflow"));
+        std::vector<uint8_t> result(data_ + offset_, data_ + offset_ + length);
+        offset_ += length;
+        return result;
+    }
 
     template<size_t N>
     std::array<uint8_t, N> readFixedBytes() {
         std::array<uint8_t, N> result{};
         if (offset_ + N > size_) {
-            throw std::runtime_error("Buffer underflow");
+            BINARY_PROTOCOL_THROW(std::runtime_error("Buffer underflow"));
         }
         std::memcpy(result.data(), data_ + offset_, N);
         offset_ += N;
@@ -316,222 +1089,340 @@ public:
 
     template<typename LengthT>
     std::vector<uint8_t> readLengthPrefixedBytes() {
-        size_t length;
-        if constexpr (sizeof(LengthT) == 1) {
-            length = readUint8();
-        } else if constexpr (sizeof(LengthT) == 2) {
-            length = readUint16();
-        } else if constexpr (sizeof(LengthT) == 4) {
-            length = readUint32();
-        }
-        return readBytes(length);
+        return readBytes(readLength<LengthT>());
+    }
+
+    /// Borrow the next length bytes without copying
+    std::span<const uint8_t> readBytesView(size_t length) {
+        if (offset_ + length > size_) BINARY_PROTOCOL_THROW(std::runtime_error("Buffer underflow"));
+        std::span<const uint8_t> result(data_ + offset_, length);
+        offset_ += length;
+        return result;
+    }
+
+    template<typename LengthT>
+    std::span<const uint8_t> readLengthPrefixedView() {
+        return readBytesView(readLength<LengthT>());
     }
 
+    void skip(size_t length) {
+        if (offset_ + length > size_) BINARY_PROTOCOL_THROW(std::runtime_error("Buffer underflow"));
+        offset_ += length;
+    }
+
+    const uint8_t* current() const { return data_ + offset_; }
     size_t position() const { return offset_; }
     size_t remaining() const { return size_ - offset_; }
 
 private:
+    template<typename T>
+    T take() {
+        if (offset_ + sizeof(T) > size_) BINARY_PROTOCOL_THROW(std::runtime_error("Buffer underflow"));
+        T value = detail::load<E, T>(data_ + offset_);
+        offset_ += sizeof(T);
+        return value;
+    }
+
+    template<typename LengthT>
+    size_t readLength() {
+        if constexpr (sizeof(LengthT) == 1) {
+            return readUint8();
+        } else if constexpr (sizeof(LengthT) == 2) {
+            return readUint16();
+        } else {
+            return readUint32();
+        }
+    }
+
     const uint8_t* data_;
     size_t size_;
     size_t offset_ = 0;
-};`;
+};
+
+using BinaryReader = BasicBinaryReader<Endian::Little>;`;
   }
 
   private generateImplementation(): string {
     const lines: string[] = [];
-    const ns = this.ir.namespace.replace(/\./g, '_').toLowerCase() || 'binary_protocol';
+    const ns = this.namespaceName();
 
     lines.push('/**');
     lines.push(' * Auto-generated binary protocol implementation');
     lines.push(' */');
     lines.push('');
     lines.push('#include "protocol.hpp"');
+    lines.push('#include "instrumentation.hpp"');
     lines.push('');
     lines.push(`namespace ${ns} {`);
     lines.push('');
 
-    // BinaryWriter実装
-    lines.push(this.generateBinaryWriterImpl());
-    lines.push('');
+    // 配列要素の一括コーデックと列挙値の検証
+    const arrayElements = this.ir.models.filter(m => this.isArrayElementModel(m));
+    if (arrayElements.length > 0 || this.ir.enums.length > 0) {
+      lines.push('namespace {');
+      lines.push('');
+      for (const model of arrayElements) {
+        lines.push(this.generateArrayCodec(model));
+        lines.push('');
+      }
+      for (const enumDef of this.ir.enums) {
+        lines.push(this.generateEnumValidator(enumDef));
+        lines.push('');
+      }
+      for (const element of compactElements(findCompactFields(this.ir))) {
+        lines.push(generateCompactArrayCodec(this.ir, element));
+        lines.push('');
+      }
+      lines.push('} // namespace');
+      lines.push('');
+    }
 
-    // BinaryReader実装
-    lines.push(this.generateBinaryReaderImpl());
-    lines.push('');
+    // 配列ビューの要素アクセス
+    for (const model of this.ir.models) {
+      if (this.isArrayElementModel(model)) {
+        lines.push(this.generateArrayViewImpl(model));
+        lines.push('');
+      }
+    }
 
     // 各モデルのシリアライザー
     for (const model of this.ir.models) {
-      lines.push(this.generateModelSerializer(model));
+      lines.push(this.instrument(model, this.generateModelSerializer(model), 'Encode', 'encodedSize(data)'));
+      lines.push('');
+      lines.push(this.instrument(model, this.generateModelDeserializer(model), 'Decode', 'size'));
       lines.push('');
-      lines.push(this.generateModelDeserializer(model));
+      lines.push(this.instrument(model, this.generateTryDeserializer(model), 'Decode', 'size'));
       lines.push('');
+      if (model.hasVariableLength) {
+        lines.push(this.generateViewDeserializer(model));
+        lines.push('');
+        lines.push(this.generateGatherSerializer(model));
+        lines.push('');
+      }
     }
 
-    lines.push(`} // namespace ${ns}`);
-
-    return lines.join('\n');
-  }
-
-  private generateBinaryWriterImpl(): string {
-    return `// BinaryWriter implementation
-void BinaryWriter::writeUint8(uint8_t value) {
-    buffer_.push_back(value);
-}
-
-void BinaryWriter::writeUint16(uint16_t value) {
-    buffer_.push_back(value & 0xFF);
-    buffer_.push_back((value >> 8) & 0xFF);
-}
-
-void BinaryWriter::writeUint32(uint32_t value) {
-    buffer_.push_back(value & 0xFF);
-    buffer_.push_back((value >> 8) & 0xFF);
-    buffer_.push_back((value >> 16) & 0xFF);
-    buffer_.push_back((value >> 24) & 0xFF);
-}
-
-void BinaryWriter::writeUint64(uint64_t value) {
-    for (int i = 0; i < 8; i++) {
-        buffer_.push_back((value >> (i * 8)) & 0xFF);
+    for (const compact of findCompactFields(this.ir)) {
+      lines.push(this.generateCompactSerializer(compact));
+      lines.push('');
     }
-}
-
-void BinaryWriter::writeInt8(int8_t value) {
-    writeUint8(static_cast<uint8_t>(value));
-}
-
-void BinaryWriter::writeInt16(int16_t value) {
-    writeUint16(static_cast<uint16_t>(value));
-}
 
-void BinaryWriter::writeInt32(int32_t value) {
-    writeUint32(static_cast<uint32_t>(value));
-}
+    const frameHeader = findFrameHeader(this.ir);
+    if (frameHeader?.checksum) {
+      lines.push(generateFrameChecksumImpl(frameHeader));
+      lines.push('');
+    }
 
-void BinaryWriter::writeInt64(int64_t value) {
-    writeUint64(static_cast<uint64_t>(value));
-}
+    lines.push(`} // namespace ${ns}`);
 
-void BinaryWriter::writeFloat32(float value) {
-    uint32_t bits;
-    std::memcpy(&bits, &value, sizeof(bits));
-    writeUint32(bits);
-}
+    return lines.join('\n');
+  }
 
-void BinaryWriter::writeFloat64(double value) {
-    uint64_t bits;
-    std::memcpy(&bits, &value, sizeof(bits));
-    writeUint64(bits);
+  /**
+   * 圧縮エンコードのシリアライザー/デシリアライザー（@compact）
+   * 先頭の固定長フィールドは通常どおり、長さプレフィックスには圧縮ブロックのバイト数を入れる
+   */
+  private generateCompactSerializer({ model, field, element }: CompactField): string {
+    const name = model.name;
+    const prefix = model.fields.slice(0, -1);
+    const leaves = this.segmentLeaves(model, prefix);
+    const prefixOffset = prefix.reduce((total, f) => total + this.fixedWireSize(f), 0);
+    const prefixType = this.mapPrimitiveTypeToCpp(field.size.lengthPrefixType!);
+    const headerSize = prefixOffset + PRIMITIVE_SIZES[field.size.lengthPrefixType! as keyof typeof PRIMITIVE_SIZES];
+    const endian = this.endianConstant(model);
+    const i1 = this.indent(1);
+    const i2 = this.indent(2);
+    const decodePrefix = [
+      ...this.enumChecks(leaves, 'data').map(line => i1 + line),
+      `${i1}${name} result{};`,
+      ...leaves.map(leaf => `${i1}${this.flatLoad(leaf, 'data', `result.${leaf.path}`)}`),
+    ];
+
+    return `void serializeCompact(const ${name}& data, std::vector<uint8_t>& out) {
+${i1}const size_t start = out.size();
+${i1}out.resize(start + ${headerSize} + compact${element.name}ArrayBound(data.${field.name}.size()));
+${i1}uint8_t* const message = out.data() + start;
+${leaves.map(leaf => `${i1}${this.flatStore(leaf, 'message', `data.${leaf.path}`)}`).join('\n')}
+${i1}uint8_t* const block = message + ${headerSize};
+${i1}const size_t length = static_cast<size_t>(encodeCompact${element.name}Array(data.${field.name}, block) - block);
+${i1}if (length > std::numeric_limits<${prefixType}>::max()) {
+${i2}out.resize(start);
+${i2}BINARY_PROTOCOL_THROW(std::length_error("Compact encoding of ${field.name} exceeds the ${field.size.lengthPrefixType} length prefix"));
+${i1}}
+${i1}detail::store<${endian}>(message + ${prefixOffset}, static_cast<${prefixType}>(length));
+${i1}out.resize(start + ${headerSize} + length);
 }
 
-void BinaryWriter::writeBool(bool value) {
-    writeUint8(value ? 1 : 0);
+std::vector<uint8_t> serializeCompact(const ${name}& data) {
+${i1}std::vector<uint8_t> buffer;
+${i1}serializeCompact(data, buffer);
+${i1}return buffer;
 }
 
-void BinaryWriter::writeBytes(const uint8_t* data, size_t size) {
-    buffer_.insert(buffer_.end(), data, data + size);
+${name} deserializeCompact${name}(const uint8_t* data, size_t size) {
+${i1}DecodeResult<${name}> result = tryDeserializeCompact${name}(data, size);
+${i1}if (!result) BINARY_PROTOCOL_THROW(std::runtime_error(toString(result.error())));
+${i1}return std::move(result).value();
 }
 
-void BinaryWriter::writeBytes(const std::vector<uint8_t>& data) {
-    buffer_.insert(buffer_.end(), data.begin(), data.end());
+DecodeResult<${name}> tryDeserializeCompact${name}(const uint8_t* data, size_t size) {
+${i1}if (size < ${headerSize}) return DecodeError::Truncated;
+${decodePrefix.join('\n')}
+${i1}const size_t length = detail::load<${endian}, ${prefixType}>(data + ${prefixOffset});
+${i1}if (size - ${headerSize} < length) return DecodeError::LengthOverflow;
+${i1}if (const auto error = decodeCompact${element.name}Array({data + ${headerSize}, length}, result.${field.name})) return *error;
+${i1}return result;
 }`;
   }
 
-  private generateBinaryReaderImpl(): string {
-    return `// BinaryReader implementation
-BinaryReader::BinaryReader(const uint8_t* data, size_t size)
-    : data_(data), size_(size), offset_(0) {}
-
-uint8_t BinaryReader::readUint8() {
-    if (offset_ + 1 > size_) throw std::runtime_error("Buffer underflow");
-    return data_[offset_++];
-}
-
-uint16_t BinaryReader::readUint16() {
-    if (offset_ + 2 > size_) throw std::runtime_error("Buffer underflow");
-    uint16_t value = data_[offset_] | (data_[offset_ + 1] << 8);
-    offset_ += 2;
-    return value;
-}
+  /**
+   * COMMAND_ID を持つモデルのエンコード/デコード関数に計測プローブを挿入
+   * （BINARY_PROTOCOL_INSTRUMENTATION が無効なら空のマクロになる）
+   */
+  private instrument(model: ModelDefinition, body: string, operation: 'Encode' | 'Decode', bytes: string): string {
+    if (model.commandId === undefined) return body;
+    const [signature, ...rest] = body.split('\n');
+    const probe = `${this.indent(1)}BINARY_PROTOCOL_PROBE(${operation}, ${model.name}::COMMAND_ID, ${bytes});`;
+    return [signature, probe, ...rest].join('\n')
+      .replace(/return (DecodeError::\w+);/g, 'return BINARY_PROTOCOL_PROBE_FAIL($1);');
+  }
 
-uint32_t BinaryReader::readUint32() {
-    if (offset_ + 4 > size_) throw std::runtime_error("Buffer underflow");
-    uint32_t value = data_[offset_] | (data_[offset_ + 1] << 8) |
-                     (data_[offset_ + 2] << 16) | (data_[offset_ + 3] << 24);
-    offset_ += 4;
-    return value;
-}
+  private generateModelSerializer(model: ModelDefinition): string {
+    const lines: string[] = [];
 
-uint64_t BinaryReader::readUint64() {
-    if (offset_ + 8 > size_) throw std::runtime_error("Buffer underflow");
-    uint64_t value = 0;
-    for (int i = 0; i < 8; i++) {
-        value |= static_cast<uint64_t>(data_[offset_ + i]) << (i * 8);
+    lines.push(`size_t serializeInto(const ${model.name}& data, std::span<uint8_t> out) {`);
+    if (model.fixedSize === undefined) {
+      lines.push(`${this.indent(1)}checkLengthPrefixes(data);`);
+    }
+    lines.push(`${this.indent(1)}const size_t size = encodedSize(data);`);
+    lines.push(`${this.indent(1)}if (out.size() < size) BINARY_PROTOCOL_THROW(std::runtime_error("Buffer overflow"));`);
+
+    if (isBulkCopyModel(this.ir, model)) {
+      // ホストのバイトオーダーがワイヤと一致する場合は packed 構造体を一括コピー
+      lines.push(`${this.indent(1)}if constexpr (kNativeEndian == ${this.endianConstant(model)}) {`);
+      lines.push(`${this.indent(2)}std::memcpy(out.data(), &data, size);`);
+      lines.push(`${this.indent(1)}} else {`);
+      lines.push(`${this.indent(2)}${this.spanWriterType(model)} writer(out);`);
+      for (const field of model.fields) {
+        lines.push(this.indentBlock(this.generateFieldSerializerCpp(field), 1));
+      }
+      lines.push(`${this.indent(1)}}`);
+    } else {
+      lines.push(`${this.indent(1)}${this.spanWriterType(model)} writer(out);`);
+      for (const field of model.fields) {
+        lines.push(this.generateFieldSerializerCpp(field));
+      }
     }
-    offset_ += 8;
-    return value;
-}
 
-int8_t BinaryReader::readInt8() {
-    return static_cast<int8_t>(readUint8());
-}
+    lines.push(`${this.indent(1)}return size;`);
+    lines.push('}');
+    lines.push('');
+    lines.push(`std::vector<uint8_t> serialize(const ${model.name}& data) {`);
+    lines.push(`${this.indent(1)}std::vector<uint8_t> buffer(encodedSize(data));`);
+    lines.push(`${this.indent(1)}serializeInto(data, buffer);`);
+    lines.push(`${this.indent(1)}return buffer;`);
+    lines.push('}');
 
-int16_t BinaryReader::readInt16() {
-    return static_cast<int16_t>(readUint16());
-}
+    return lines.join('\n');
+  }
 
-int32_t BinaryReader::readInt32() {
-    return static_cast<int32_t>(readUint32());
-}
+  /**
+   * モデルのバイトオーダーに対応する C++ 定数
+   */
+  private endianConstant(model: ModelDefinition): string {
+    return model.endian === 'big' ? 'Endian::Big' : 'Endian::Little';
+  }
 
-int64_t BinaryReader::readInt64() {
-    return static_cast<int64_t>(readUint64());
-}
+  private spanWriterType(model: ModelDefinition): string {
+    return model.endian === 'big' ? 'BasicSpanWriter<Endian::Big>' : 'SpanWriter';
+  }
 
-float BinaryReader::readFloat32() {
-    uint32_t bits = readUint32();
-    float value;
-    std::memcpy(&value, &bits, sizeof(value));
-    return value;
-}
+  private readerType(model: ModelDefinition): string {
+    return model.endian === 'big' ? 'BasicBinaryReader<Endian::Big>' : 'BinaryReader';
+  }
 
-double BinaryReader::readFloat64() {
-    uint64_t bits = readUint64();
-    double value;
-    std::memcpy(&value, &bits, sizeof(value));
-    return value;
-}
+  /**
+   * 生成済みコード片のインデントを深くする
+   */
+  private indentBlock(code: string, level: number): string {
+    return code
+      .split('\n')
+      .map(line => (line.length > 0 ? this.indent(level) + line : line))
+      .join('\n');
+  }
 
-bool BinaryReader::readBool() {
-    return readUint8() != 0;
-}
+  /**
+   * constexpr なエンコードサイズ関数を生成
+   */
+  private generateEncodedSize(model: ModelDefinition): string {
+    if (model.fixedSize !== undefined) {
+      return `constexpr size_t encodedSize(const ${model.name}&) { return ${model.name}::ENCODED_SIZE; }`;
+    }
 
-std::vector<uint8_t> BinaryReader::readBytes(size_t length) {
-    if (offset_ + length > size_) throw std::runtime_error("Buffer underflow");
-    std::vector<uint8_t> result(data_ + offset_, data_ + offset_ + length);
-    offset_ += length;
-    return result;
-}`;
-  }
+    let fixedBytes = 0;
+    const terms: string[] = [];
+    for (const field of model.fields) {
+      if (field.size.lengthPrefixType) {
+        fixedBytes += PRIMITIVE_SIZES[field.size.lengthPrefixType] ?? 0;
+        terms.push(this.variableFieldSizeExpr(field, `data.${field.name}`));
+      } else if (field.size.fixedSize !== undefined) {
+        fixedBytes += field.size.fixedSize;
+      } else {
+        terms.push(`encodedSize(data.${field.name})`);
+      }
+    }
 
-  private generateModelSerializer(model: ModelDefinition): string {
-    const lines: string[] = [];
+    const expr = [String(fixedBytes), ...terms].join(' + ');
+    return `constexpr size_t encodedSize(const ${model.name}& data) { return ${expr}; }`;
+  }
 
-    lines.push(`std::vector<uint8_t> serialize(const ${model.name}& data) {`);
-    lines.push(`${this.indent(1)}BinaryWriter writer;`);
+  /**
+   * 長さプレフィックス付きフィールドがプレフィックスの最大値に収まるかを検証する関数
+   */
+  private generateLengthPrefixCheck(model: ModelDefinition): string {
+    if (model.fixedSize !== undefined) {
+      return `constexpr void checkLengthPrefixes(const ${model.name}&) {}`;
+    }
 
+    const checks: string[] = [];
     for (const field of model.fields) {
-      lines.push(this.generateFieldSerializerCpp(field));
+      const accessor = `data.${field.name}`;
+      if (field.size.lengthPrefixType) {
+        const prefixType = this.mapPrimitiveTypeToCpp(field.size.lengthPrefixType);
+        checks.push(`if (${this.variableFieldSizeExpr(field, accessor)} > std::numeric_limits<${prefixType}>::max()) {`);
+        checks.push(`${this.indent(1)}BINARY_PROTOCOL_THROW(std::length_error("${model.name}.${field.name} exceeds its ${field.size.lengthPrefixType} length prefix"));`);
+        checks.push('}');
+      } else if (field.size.fixedSize === undefined) {
+        checks.push(`checkLengthPrefixes(${accessor});`);
+      }
     }
+    return [
+      `constexpr void checkLengthPrefixes(const ${model.name}& data) {`,
+      ...checks.map(line => this.indent(1) + line),
+      '}',
+    ].join('\n');
+  }
 
-    lines.push(`${this.indent(1)}return writer.data();`);
-    lines.push('}');
-
-    return lines.join('\n');
+  /**
+   * 可変長フィールドのペイロードサイズ式（長さプレフィックスを除く）
+   */
+  private variableFieldSizeExpr(field: FieldDefinition, accessor: string): string {
+    if (field.type.kind === 'array' && field.type.elementType) {
+      const elementSize = elementWireSize(this.ir, field.type.elementType);
+      if (elementSize !== undefined && elementSize !== 1) {
+        return `${accessor}.size() * ${elementSize}`;
+      }
+    }
+    return `${accessor}.size()`;
   }
 
   private generateFieldSerializerCpp(field: FieldDefinition): string {
     const accessor = `data.${field.name}`;
 
+    // 固定長モデルの配列
+    if (field.type.kind === 'array' && field.size.lengthPrefixType) {
+      return this.generateArraySerializerCpp(field, accessor);
+    }
+
     // 長さプレフィックス付きバイト列
     if (field.size.lengthPrefixType) {
       const lengthType = this.mapPrimitiveTypeToCpp(field.size.lengthPrefixType);
@@ -579,20 +1470,483 @@ std::vector<uint8_t> BinaryReader::readBytes(size_t length) {
         }
         // ネストしたモデル
         if (this.ir.models.find(m => m.name === field.type.name)) {
-          return `${this.indent(1)}{\n${this.indent(2)}auto nested = serialize(${accessor});\n${this.indent(2)}writer.writeBytes(nested);\n${this.indent(1)}}`;
+          return `${this.indent(1)}writer.skip(serializeInto(${accessor}, writer.remaining()));`;
         }
         return `${this.indent(1)}// TODO: serialize ${field.name}`;
     }
   }
 
+  /**
+   * 配列の要素モデル（固定長モデルのみ対応）
+   */
+  private arrayElementModel(field: FieldDefinition): ModelDefinition {
+    const element = this.ir.models.find(m => m.name === field.type.elementType?.name);
+    if (!element || element.fixedSize === undefined) {
+      throw new Error(`Unsupported array element type for ${field.name}: ${field.type.name}`);
+    }
+    return element;
+  }
+
+  /**
+   * 配列のシリアライズ（長さプレフィックスはバイト長）
+   */
+  private generateArraySerializerCpp(field: FieldDefinition, accessor: string): string {
+    const element = this.arrayElementModel(field);
+    const prefixType = field.size.lengthPrefixType!;
+    const prefixMethod = prefixType.charAt(0).toUpperCase() + prefixType.slice(1);
+    const byteLength = `${accessor}.size() * ${element.name}::ENCODED_SIZE`;
+    const lines: string[] = [];
+
+    lines.push(`${this.indent(1)}writer.write${prefixMethod}(static_cast<${this.mapPrimitiveTypeToCpp(prefixType)}>(${byteLength}));`);
+    if (isBulkCopyModel(this.ir, element)) {
+      lines.push(`${this.indent(1)}if constexpr (kNativeEndian == ${this.endianConstant(element)}) {`);
+      lines.push(`${this.indent(2)}writer.writeBytes({reinterpret_cast<const uint8_t*>(${accessor}.data()), ${byteLength}});`);
+      lines.push(`${this.indent(1)}} else {`);
+      lines.push(`${this.indent(2)}encode${element.name}Array(${accessor}, writer.remaining().data());`);
+      lines.push(`${this.indent(2)}writer.skip(${byteLength});`);
+      lines.push(`${this.indent(1)}}`);
+    } else {
+      lines.push(`${this.indent(1)}encode${element.name}Array(${accessor}, writer.remaining().data());`);
+      lines.push(`${this.indent(1)}writer.skip(${byteLength});`);
+    }
+    return lines.join('\n');
+  }
+
+  /**
+   * 配列のデシリアライズ（バイト長が要素サイズの倍数であることを検証）
+   */
+  private generateArrayDeserializerCpp(field: FieldDefinition, accessor: string): string {
+    const element = this.arrayElementModel(field);
+    const prefixType = this.mapPrimitiveTypeToCpp(field.size.lengthPrefixType!);
+    const lines: string[] = [];
+
+    lines.push(`${this.indent(1)}{`);
+    lines.push(`${this.indent(2)}const std::span<const uint8_t> bytes = reader.readLengthPrefixedView<${prefixType}>();`);
+    lines.push(`${this.indent(2)}if (bytes.size() % ${element.name}::ENCODED_SIZE != 0) {`);
+    lines.push(`${this.indent(3)}BINARY_PROTOCOL_THROW(std::runtime_error("Invalid ${element.name} array length"));`);
+    lines.push(`${this.indent(2)}}`);
+    lines.push(`${this.indent(2)}${accessor}.resize(bytes.size() / ${element.name}::ENCODED_SIZE);`);
+    if (isBulkCopyModel(this.ir, element)) {
+      lines.push(`${this.indent(2)}if constexpr (kNativeEndian == ${this.endianConstant(element)}) {`);
+      lines.push(`${this.indent(3)}if (!bytes.empty()) {`);
+      lines.push(`${this.indent(4)}std::memcpy(${accessor}.data(), bytes.data(), bytes.size());`);
+      lines.push(`${this.indent(3)}}`);
+      lines.push(`${this.indent(2)}} else {`);
+      lines.push(`${this.indent(3)}decode${element.name}Array(bytes.data(), ${accessor});`);
+      lines.push(`${this.indent(2)}}`);
+    } else {
+      lines.push(`${this.indent(2)}decode${element.name}Array(bytes.data(), ${accessor});`);
+    }
+    lines.push(`${this.indent(1)}}`);
+    return lines.join('\n');
+  }
+
+  /**
+   * 配列要素の一括コーデック（固定オフセットのロード/ストアのみのループ）
+   */
+  private generateArrayCodec(model: ModelDefinition): string {
+    const flat = flattenFixedFields(this.ir, model);
+    const lines: string[] = [];
+
+    lines.push(`// Fixed-stride ${model.name} array codec; callers validate the byte length`);
+    lines.push(`void encode${model.name}Array(std::span<const ${model.name}> elements, uint8_t* out) {`);
+    lines.push(`${this.indent(1)}for (const ${model.name}& element : elements) {`);
+    for (const leaf of flat) {
+      lines.push(`${this.indent(2)}${this.flatStore(leaf, 'out', `element.${leaf.path}`)}`);
+    }
+    lines.push(`${this.indent(2)}out += ${model.name}::ENCODED_SIZE;`);
+    lines.push(`${this.indent(1)}}`);
+    lines.push('}');
+    lines.push('');
+    lines.push(`void decode${model.name}Array(const uint8_t* in, std::span<${model.name}> elements) {`);
+    lines.push(`${this.indent(1)}for (${model.name}& element : elements) {`);
+    for (const leaf of flat) {
+      lines.push(`${this.indent(2)}${this.flatLoad(leaf, 'in', `element.${leaf.path}`)}`);
+    }
+    lines.push(`${this.indent(2)}in += ${model.name}::ENCODED_SIZE;`);
+    lines.push(`${this.indent(1)}}`);
+    lines.push('}');
+    return lines.join('\n');
+  }
+
+  /**
+   * 末端フィールドのストア文（constant が真なら定数式で評価可能な形にする）
+   */
+  private flatStore(leaf: FlatField, base: string, value: string, constant = false): string {
+    const typeName = leaf.field.type.name;
+    if (typeName === 'string' || typeName === 'bytes') {
+      return constant
+        ? `std::copy_n(${value}.data(), ${leaf.field.size.fixedSize}, ${base} + ${leaf.offset});`
+        : `std::memcpy(${base} + ${leaf.offset}, ${value}.data(), ${leaf.field.size.fixedSize});`;
+    }
+    if (typeName === 'bool') {
+      return `${base}[${leaf.offset}] = ${value} ? 1 : 0;`;
+    }
+    if (this.ir.enums.find(e => e.name === typeName)) {
+      return `${base}[${leaf.offset}] = static_cast<uint8_t>(${value});`;
+    }
+    const bits = this.wireIntegerType(typeName);
+    const converted = this.mapPrimitiveTypeToCpp(typeName) === bits
+      ? value
+      : typeName.startsWith('float')
+        // パック構造体のメンバーを参照で束縛しないよう値をコピーしてから変換
+        ? `std::bit_cast<${bits}>(${this.mapPrimitiveTypeToCpp(typeName)}{${value}})`
+        : `static_cast<${bits}>(${value})`;
+    return `detail::store<${this.endianConstant(leaf.owner)}>(${base} + ${leaf.offset}, ${converted});`;
+  }
+
+  private flatLoad(leaf: FlatField, base: string, target: string): string {
+    const typeName = leaf.field.type.name;
+    if (typeName === 'string' || typeName === 'bytes') {
+      return `std::memcpy(${target}.data(), ${base} + ${leaf.offset}, ${leaf.field.size.fixedSize});`;
+    }
+    if (typeName === 'bool') {
+      return `${target} = ${base}[${leaf.offset}] != 0;`;
+    }
+    if (this.ir.enums.find(e => e.name === typeName)) {
+      return `${target} = static_cast<${typeName}>(${base}[${leaf.offset}]);`;
+    }
+    const bits = this.wireIntegerType(typeName);
+    const loaded = `detail::load<${this.endianConstant(leaf.owner)}, ${bits}>(${base} + ${leaf.offset})`;
+    const cppType = this.mapPrimitiveTypeToCpp(typeName);
+    if (cppType === bits) {
+      return `${target} = ${loaded};`;
+    }
+    const cast = typeName.startsWith('float') ? 'std::bit_cast' : 'static_cast';
+    return `${target} = ${cast}<${cppType}>(${loaded});`;
+  }
+
+  /**
+   * プリミティブ型と同じ幅の符号なし整数型
+   */
+  private wireIntegerType(typeName: string): string {
+    const size = PRIMITIVE_SIZES[typeName as keyof typeof PRIMITIVE_SIZES] ?? 1;
+    return `uint${size * 8}_t`;
+  }
+
   private generateModelDeserializer(model: ModelDefinition): string {
     const lines: string[] = [];
 
     lines.push(`${model.name} deserialize${model.name}(const uint8_t* data, size_t size) {`);
-    lines.push(`${this.indent(1)}BinaryReader reader(data, size);`);
+
+    if (isBulkCopyModel(this.ir, model)) {
+      lines.push(`${this.indent(1)}if constexpr (kNativeEndian == ${this.endianConstant(model)}) {`);
+      lines.push(`${this.indent(2)}if (size < ${model.name}::ENCODED_SIZE) BINARY_PROTOCOL_THROW(std::runtime_error("Buffer underflow"));`);
+      lines.push(`${this.indent(2)}${model.name} result;`);
+      lines.push(`${this.indent(2)}std::memcpy(&result, data, ${model.name}::ENCODED_SIZE);`);
+      lines.push(`${this.indent(2)}return result;`);
+      lines.push(`${this.indent(1)}} else {`);
+      lines.push(`${this.indent(2)}${this.readerType(model)} reader(data, size);`);
+      lines.push(`${this.indent(2)}${model.name} result{};`);
+      for (const field of model.fields) {
+        lines.push(this.indentBlock(this.generateFieldDeserializerCpp(field), 1));
+      }
+      lines.push(`${this.indent(2)}return result;`);
+      lines.push(`${this.indent(1)}}`);
+    } else {
+      lines.push(`${this.indent(1)}${this.readerType(model)} reader(data, size);`);
+      lines.push(`${this.indent(1)}${model.name} result{};`);
+      for (const field of model.fields) {
+        lines.push(this.generateFieldDeserializerCpp(field));
+      }
+      lines.push(`${this.indent(1)}return result;`);
+    }
+
+    lines.push('}');
+
+    return lines.join('\n');
+  }
+
+  /**
+   * 例外を投げないデシリアライザー
+   * 固定長フィールドと長さプレフィックスの連続区間ごとに一度だけ残りバイト数を検証する
+   */
+  private generateTryDeserializer(model: ModelDefinition): string {
+    const lines: string[] = [];
+
+    lines.push(`DecodeResult<${model.name}> tryDeserialize${model.name}(const uint8_t* data, size_t size) {`);
+
+    if (model.fixedSize !== undefined) {
+      const leaves = flattenFixedFields(this.ir, model);
+      lines.push(`${this.indent(1)}if (size < ${model.name}::ENCODED_SIZE) return DecodeError::Truncated;`);
+      lines.push(...this.enumChecks(leaves, 'data').map(line => this.indent(1) + line));
+      if (isBulkCopyModel(this.ir, model)) {
+        lines.push(`${this.indent(1)}${model.name} result;`);
+        lines.push(`${this.indent(1)}if constexpr (kNativeEndian == ${this.endianConstant(model)}) {`);
+        lines.push(`${this.indent(2)}std::memcpy(&result, data, ${model.name}::ENCODED_SIZE);`);
+        lines.push(`${this.indent(1)}} else {`);
+        for (const leaf of leaves) {
+          lines.push(`${this.indent(2)}${this.flatLoad(leaf, 'data', `result.${leaf.path}`)}`);
+        }
+        lines.push(`${this.indent(1)}}`);
+      } else {
+        lines.push(`${this.indent(1)}${model.name} result{};`);
+        for (const leaf of leaves) {
+          lines.push(`${this.indent(1)}${this.flatLoad(leaf, 'data', `result.${leaf.path}`)}`);
+        }
+      }
+      lines.push(`${this.indent(1)}return result;`);
+      lines.push('}');
+      return lines.join('\n');
+    }
+
+    lines.push(`${this.indent(1)}const uint8_t* in = data;`);
+    lines.push(`${this.indent(1)}size_t remaining = size;`);
     lines.push(`${this.indent(1)}${model.name} result{};`);
 
+    // 固定長フィールドの連続区間（末尾が長さプレフィックス付きフィールドなら本体の直前まで）
+    let segment: FieldDefinition[] = [];
+    const flush = (prefixed: FieldDefinition | undefined, last: boolean) => {
+      const leaves = this.segmentLeaves(model, segment);
+      const fixedSize = segment.reduce((total, f) => total + this.fixedWireSize(f), 0);
+      const prefixSize = prefixed
+        ? PRIMITIVE_SIZES[prefixed.size.lengthPrefixType! as keyof typeof PRIMITIVE_SIZES]
+        : 0;
+      const segmentSize = fixedSize + prefixSize;
+      if (segmentSize > 0) {
+        lines.push(`${this.indent(1)}if (remaining < ${segmentSize}) return DecodeError::Truncated;`);
+      }
+      lines.push(...this.enumChecks(leaves, 'in').map(line => this.indent(1) + line));
+      for (const leaf of leaves) {
+        lines.push(`${this.indent(1)}${this.flatLoad(leaf, 'in', `result.${leaf.path}`)}`);
+      }
+      if (prefixed) {
+        const prefixType = this.mapPrimitiveTypeToCpp(prefixed.size.lengthPrefixType!);
+        const length = `${prefixed.name}Length`;
+        lines.push(`${this.indent(1)}const size_t ${length} = detail::load<${this.endianConstant(model)}, ${prefixType}>(in + ${fixedSize});`);
+        lines.push(`${this.indent(1)}in += ${segmentSize};`);
+        lines.push(`${this.indent(1)}remaining -= ${segmentSize};`);
+        lines.push(`${this.indent(1)}if (remaining < ${length}) return DecodeError::LengthOverflow;`);
+        lines.push(this.generateTryBodyCpp(prefixed, length));
+        if (!last) {
+          lines.push(`${this.indent(1)}in += ${length};`);
+          lines.push(`${this.indent(1)}remaining -= ${length};`);
+        }
+      }
+      segment = [];
+    };
+    model.fields.forEach((field, index) => {
+      if (field.size.lengthPrefixType) {
+        flush(field, index === model.fields.length - 1);
+      } else {
+        segment.push(field);
+      }
+    });
+    if (segment.length > 0) {
+      flush(undefined, true);
+    }
+
+    lines.push(`${this.indent(1)}return result;`);
+    lines.push('}');
+    return lines.join('\n');
+  }
+
+  /**
+   * 長さプレフィックス付きフィールドの本体（in から length バイト、長さは検証済み）
+   */
+  private generateTryBodyCpp(field: FieldDefinition, length: string): string {
+    const accessor = `result.${field.name}`;
+    const lines: string[] = [];
+
+    if (field.type.kind !== 'array') {
+      // バッチは各エントリーの枠を検証しておき、受理した値のイテレーターが例外を投げないようにする
+      if (field.decorators.some(d => d.name === 'batch')) {
+        const owner = this.ir.models.find(m => m.fields.includes(field))!;
+        lines.push(`${this.indent(1)}if (${owner.name}Entries({in, ${length}}).validate()) return DecodeError::Truncated;`);
+      }
+      lines.push(`${this.indent(1)}${accessor}.assign(in, in + ${length});`);
+      return lines.join('\n');
+    }
+
+    const element = this.arrayElementModel(field);
+    lines.push(`${this.indent(1)}if (${length} % ${element.name}::ENCODED_SIZE != 0) return DecodeError::BadArrayLength;`);
+    const checks = this.enumChecks(flattenFixedFields(this.ir, element), 'element');
+    if (checks.length > 0) {
+      lines.push(`${this.indent(1)}for (const uint8_t* element = in; element != in + ${length}; element += ${element.name}::ENCODED_SIZE) {`);
+      lines.push(...checks.map(line => this.indent(2) + line));
+      lines.push(`${this.indent(1)}}`);
+    }
+    lines.push(`${this.indent(1)}${accessor}.resize(${length} / ${element.name}::ENCODED_SIZE);`);
+    if (isBulkCopyModel(this.ir, element)) {
+      lines.push(`${this.indent(1)}if constexpr (kNativeEndian == ${this.endianConstant(element)}) {`);
+      lines.push(`${this.indent(2)}if (${length} != 0) {`);
+      lines.push(`${this.indent(3)}std::memcpy(${accessor}.data(), in, ${length});`);
+      lines.push(`${this.indent(2)}}`);
+      lines.push(`${this.indent(1)}} else {`);
+      lines.push(`${this.indent(2)}decode${element.name}Array(in, ${accessor});`);
+      lines.push(`${this.indent(1)}}`);
+    } else {
+      lines.push(`${this.indent(1)}decode${element.name}Array(in, ${accessor});`);
+    }
+    return lines.join('\n');
+  }
+
+  /**
+   * モデル内の固定長フィールド列をネストを展開して列挙（区間先頭からのオフセット）
+   */
+  private segmentLeaves(model: ModelDefinition, fields: FieldDefinition[]): FlatField[] {
+    const leaves: FlatField[] = [];
+    let offset = 0;
+    for (const field of fields) {
+      const nested = this.ir.models.find(m => m.name === field.type.name);
+      if (nested && nested.fixedSize !== undefined) {
+        leaves.push(...flattenFixedFields(this.ir, nested, offset, field.name));
+      } else {
+        leaves.push({ path: field.name, offset, field, owner: model });
+      }
+      offset += this.fixedWireSize(field);
+    }
+    return leaves;
+  }
+
+  private fixedWireSize(field: FieldDefinition): number {
+    const nested = this.ir.models.find(m => m.name === field.type.name);
+    return nested?.fixedSize ?? field.size.fixedSize ?? 0;
+  }
+
+  /**
+   * 列挙型フィールドの生の値を検証する文
+   */
+  private enumChecks(leaves: FlatField[], base: string): string[] {
+    return leaves
+      .filter(leaf => this.ir.enums.some(e => e.name === leaf.field.type.name))
+      .map(leaf => `if (!isValid${leaf.field.type.name}(${base}[${leaf.offset}])) return DecodeError::BadEnumValue;`);
+  }
+
+  private generateEnumValidator(enumDef: EnumDefinition): string {
+    const cases = enumDef.members.map(member => `    case ${member.value}:`);
+    return `constexpr bool isValid${enumDef.name}(uint8_t value) {
+    switch (value) {
+${cases.join('\n')}
+        return true;
+    default:
+        return false;
+    }
+}`;
+  }
+
+  /**
+   * 固定長モデルの配列要素として使われているか
+   */
+  private isArrayElementModel(model: ModelDefinition): boolean {
+    if (model.fixedSize === undefined) return false;
+    return this.ir.models.some(m =>
+      m.fields.some(f => f.type.kind === 'array' && f.type.elementType?.name === model.name)
+    );
+  }
+
+  /**
+   * 固定長モデル配列の遅延デコードビューを生成
+   */
+  private generateArrayView(model: ModelDefinition): string {
+    const name = `${model.name}ArrayView`;
+    return `/**
+ * Lazily decoded, non-owning view over an encoded ${model.name} array.
+ * Elements are decoded on access; the underlying buffer must outlive the view.
+ */
+class ${name} {
+public:
+    class Iterator {
+    public:
+        Iterator(const ${name}* view, size_t index) : view_(view), index_(index) {}
+        ${model.name} operator*() const { return (*view_)[index_]; }
+        Iterator& operator++() { ++index_; return *this; }
+        bool operator==(const Iterator& other) const { return index_ == other.index_; }
+        bool operator!=(const Iterator& other) const { return index_ != other.index_; }
+
+    private:
+        const ${name}* view_;
+        size_t index_;
+    };
+
+    ${name}() = default;
+    explicit ${name}(std::span<const uint8_t> bytes);
+
+    size_t size() const { return bytes_.size() / ${model.name}::ENCODED_SIZE; }
+    bool empty() const { return bytes_.empty(); }
+    ${model.name} operator[](size_t index) const;
+    std::span<const uint8_t> bytes() const { return bytes_; }
+
+    Iterator begin() const { return Iterator(this, 0); }
+    Iterator end() const { return Iterator(this, size()); }
+
+private:
+    std::span<const uint8_t> bytes_;
+};`;
+  }
+
+  private generateArrayViewImpl(model: ModelDefinition): string {
+    const name = `${model.name}ArrayView`;
+    return `${name}::${name}(std::span<const uint8_t> bytes)
+    : bytes_(bytes) {
+    if (bytes.size() % ${model.name}::ENCODED_SIZE != 0) {
+        BINARY_PROTOCOL_THROW(std::runtime_error("Invalid ${model.name} array length"));
+    }
+}
+
+${model.name} ${name}::operator[](size_t index) const {
+    const uint8_t* element = bytes_.data() + index * ${model.name}::ENCODED_SIZE;
+    return deserialize${model.name}(element, ${model.name}::ENCODED_SIZE);
+}`;
+  }
+
+  /**
+   * 可変長モデルのゼロコピービュー構造体を生成
+   */
+  private generateViewStruct(model: ModelDefinition): string {
+    const lines: string[] = [];
+
+    lines.push('/**');
+    lines.push(` * Zero-copy view of ${model.name}.`);
+    lines.push(' * Variable-length fields borrow from the receive buffer, which must outlive the view.');
+    lines.push(' */');
+    lines.push(`struct ${model.name}View {`);
+
     for (const field of model.fields) {
+      lines.push(`${this.indent(1)}${this.mapViewTypeToCpp(field)} ${field.name};`);
+    }
+
+    if (model.commandId !== undefined) {
+      lines.push('');
+      lines.push(`${this.indent(1)}static constexpr uint8_t COMMAND_ID = ${model.name}::COMMAND_ID;`);
+    }
+
+    lines.push('};');
+    return lines.join('\n');
+  }
+
+  private mapViewTypeToCpp(field: FieldDefinition): string {
+    if (field.size.lengthPrefixType) {
+      if (field.type.kind === 'array' && field.type.elementType) {
+        const element = this.ir.models.find(m => m.name === field.type.elementType!.name);
+        if (element && element.fixedSize !== undefined) {
+          return `${element.name}ArrayView`;
+        }
+      }
+      return 'std::span<const uint8_t>';
+    }
+    return this.mapTypeToCpp(field);
+  }
+
+  private generateViewDeserializer(model: ModelDefinition): string {
+    const lines: string[] = [];
+
+    lines.push(`${model.name}View view${model.name}(const uint8_t* data, size_t size) {`);
+    lines.push(`${this.indent(1)}${this.readerType(model)} reader(data, size);`);
+    lines.push(`${this.indent(1)}${model.name}View result{};`);
+
+    for (const field of model.fields) {
+      if (field.size.lengthPrefixType) {
+        const lengthType = this.mapPrimitiveTypeToCpp(field.size.lengthPrefixType);
+        const viewType = this.mapViewTypeToCpp(field);
+        const read = `reader.readLengthPrefixedView<${lengthType}>()`;
+        if (viewType.endsWith('ArrayView')) {
+          lines.push(`${this.indent(1)}result.${field.name} = ${viewType}(${read});`);
+        } else {
+          lines.push(`${this.indent(1)}result.${field.name} = ${read};`);
+        }
+        continue;
+      }
       lines.push(this.generateFieldDeserializerCpp(field));
     }
 
@@ -605,6 +1959,11 @@ std::vector<uint8_t> BinaryReader::readBytes(size_t length) {
   private generateFieldDeserializerCpp(field: FieldDefinition): string {
     const accessor = `result.${field.name}`;
 
+    // 固定長モデルの配列
+    if (field.type.kind === 'array' && field.size.lengthPrefixType) {
+      return this.generateArrayDeserializerCpp(field, accessor);
+    }
+
     // 長さプレフィックス付きバイト列
     if (field.size.lengthPrefixType) {
       const lengthType = this.mapPrimitiveTypeToCpp(field.size.lengthPrefixType);
@@ -653,7 +2012,7 @@ std::vector<uint8_t> BinaryReader::readBytes(size_t length) {
         // ネストしたモデル
         const nestedModel = this.ir.models.find(m => m.name === field.type.name);
         if (nestedModel && nestedModel.fixedSize) {
-          return `${this.indent(1)}{\n${this.indent(2)}auto nested = reader.readBytes(${nestedModel.fixedSize});\n${this.indent(2)}${accessor} = deserialize${field.type.name}(nested.data(), nested.size());\n${this.indent(1)}}`;
+          return `${this.indent(1)}${accessor} = deserialize${field.type.name}(reader.current(), reader.remaining());\n${this.indent(1)}reader.skip(${nestedModel.fixedSize});`;
         }
         return `${this.indent(1)}// TODO: deserialize ${field.name}`;
     }
@@ -0,0 +1,377 @@
+/**
+ * C++ 計測フック生成
+ * BINARY_PROTOCOL_INSTRUMENTATION が有効な場合のみ、コマンドごとの件数・バイト数・エラー数・レイテンシ分布を記録する
+ */
+
+import { SchemaIR } from '../../ir/types.js';
+import { messageModels } from './dispatch.js';
+
+/** DecodeError の列挙子数（result.ts と一致させる） */
+const DECODE_ERROR_COUNT = 6;
+
+export function generateInstrumentationHeader(ir: SchemaIR, ns: string): string {
+  const messages = messageModels(ir);
+  const indexEntries = messages
+    .map((model, index) => `    index[${model.name}::COMMAND_ID] = ${index};`)
+    .join('\n');
+
+  return `/**
+ * Auto-generated encode/decode instrumentation
+ *
+ * Build with BINARY_PROTOCOL_INSTRUMENTATION=1 (the CMake option of the same
+ * name) to count calls, bytes, failures and latency per COMMAND_ID. Otherwise
+ * the probes expand to nothing and this header declares no API.
+ */
+
+#ifndef BINARY_PROTOCOL_INSTRUMENTATION_HPP
+#define BINARY_PROTOCOL_INSTRUMENTATION_HPP
+
+#include "protocol.hpp"
+
+#ifndef BINARY_PROTOCOL_INSTRUMENTATION
+#define BINARY_PROTOCOL_INSTRUMENTATION 0
+#endif
+
+#if BINARY_PROTOCOL_INSTRUMENTATION
+
+#include <array>
+#include <bit>
+#include <chrono>
+#include <cstdint>
+#include <exception>
+#include <vector>
+
+namespace ${ns}::instrumentation {
+
+enum class Operation : uint8_t {
+    Encode,
+    Decode,
+};
+
+/// Framing problems seen by FrameDecoder and verifyFrame()
+enum class FrameError : uint8_t {
+    BadMagic,
+    OversizedPayload,
+    ChecksumMismatch,
+};
+
+inline constexpr size_t OPERATION_COUNT = 2;
+inline constexpr size_t DECODE_ERROR_COUNT = ${DECODE_ERROR_COUNT};
+inline constexpr size_t FRAME_ERROR_COUNT = 3;
+inline constexpr size_t COMMAND_COUNT = ${messages.length};
+
+/// Dense index of each message's COMMAND_ID; NO_COMMAND for IDs outside the protocol
+inline constexpr uint8_t NO_COMMAND = 0xFF;
+inline constexpr std::array<uint8_t, 256> COMMAND_INDEX = [] {
+    std::array<uint8_t, 256> index{};
+    index.fill(NO_COMMAND);
+${indexEntries}
+    return index;
+}();
+
+/**
+ * Latency histogram in nanoseconds with HDR-style log-linear buckets:
+ * exact below SUB_BUCKETS, then SUB_BUCKETS buckets per power of two up to
+ * 2^MAX_EXPONENT ns, so a recorded value is off by at most 1/SUB_BUCKETS.
+ */
+struct LatencyHistogram {
+    static constexpr unsigned SUB_BUCKET_BITS = 3;
+    static constexpr uint64_t SUB_BUCKETS = uint64_t{1} << SUB_BUCKET_BITS;
+    static constexpr unsigned MAX_EXPONENT = 36;
+    static constexpr size_t BUCKETS = (MAX_EXPONENT - SUB_BUCKET_BITS + 1) * SUB_BUCKETS;
+
+    static constexpr size_t bucketOf(uint64_t nanos) {
+        if (nanos < SUB_BUCKETS) return static_cast<size_t>(nanos);
+        const unsigned exponent = static_cast<unsigned>(std::bit_width(nanos)) - 1;
+        if (exponent >= MAX_EXPONENT) return BUCKETS - 1;
+        const uint64_t mantissa = (nanos >> (exponent - SUB_BUCKET_BITS)) & (SUB_BUCKETS - 1);
+        return static_cast<size_t>((exponent - SUB_BUCKET_BITS + 1) * SUB_BUCKETS + mantissa);
+    }
+
+    /// Smallest value that falls into bucket
+    static constexpr uint64_t bucketLowerBound(size_t bucket) {
+        if (bucket < SUB_BUCKETS) return bucket;
+        const unsigned exponent = static_cast<unsigned>(bucket / SUB_BUCKETS) - 1 + SUB_BUCKET_BITS;
+        return (SUB_BUCKETS + bucket % SUB_BUCKETS) << (exponent - SUB_BUCKET_BITS);
+    }
+
+    std::array<uint64_t, BUCKETS> counts{};
+
+    uint64_t count() const;
+    /// Upper bound of the bucket holding the given percentile (0-100); 0 when empty
+    uint64_t percentile(double percent) const;
+};
+
+static_assert(LatencyHistogram::bucketOf(UINT64_MAX) < LatencyHistogram::BUCKETS);
+static_assert(LatencyHistogram::bucketOf((uint64_t{1} << LatencyHistogram::MAX_EXPONENT) - 1) == LatencyHistogram::BUCKETS - 1);
+
+struct OperationStats {
+    uint64_t calls = 0;
+    /// Encoded bytes of successful calls
+    uint64_t bytes = 0;
+    /// Calls that threw or returned a DecodeError
+    uint64_t failures = 0;
+    uint64_t totalNanos = 0;
+    LatencyHistogram latency;
+};
+
+struct CommandStats {
+    uint8_t commandId;
+    const char* name;
+    std::array<OperationStats, OPERATION_COUNT> operations;
+    /// tryDeserialize failures by DecodeError
+    std::array<uint64_t, DECODE_ERROR_COUNT> decodeErrors{};
+
+    const OperationStats& encode() const { return operations[static_cast<size_t>(Operation::Encode)]; }
+    const OperationStats& decode() const { return operations[static_cast<size_t>(Operation::Decode)]; }
+};
+
+/**
+ * Totals since process start. Counters only grow, so the activity over an
+ * interval is the difference of two snapshots.
+ */
+struct Snapshot {
+    std::vector<CommandStats> commands;
+    std::array<uint64_t, FRAME_ERROR_COUNT> frameErrors{};
+    /// Per-thread slots summed (a slot is reused after its thread exits)
+    size_t slots = 0;
+};
+
+/// Sums every thread's slot without stopping the threads that update them
+Snapshot snapshot();
+
+void countFrameError(FrameError error) noexcept;
+
+/**
+ * Times one encode or decode call and records it in the calling thread's
+ * slot when it goes out of scope. A call that leaves by exception, or whose
+ * result went through fail(), counts as a failure.
+ */
+class Probe {
+public:
+    Probe(Operation operation, uint8_t commandId, size_t bytes) noexcept
+        : start_(std::chrono::steady_clock::now()),
+          bytes_(bytes),
+          exceptions_(std::uncaught_exceptions()),
+          operation_(operation),
+          command_(COMMAND_INDEX[commandId]) {}
+    ~Probe() { finish(); }
+
+    Probe(const Probe&) = delete;
+    Probe& operator=(const Probe&) = delete;
+
+    DecodeError fail(DecodeError error) noexcept {
+        error_ = static_cast<uint8_t>(static_cast<uint8_t>(error) + 1);
+        return error;
+    }
+
+private:
+    void finish() noexcept;
+
+    std::chrono::steady_clock::time_point start_;
+    size_t bytes_;
+    int exceptions_;
+    Operation operation_;
+    uint8_t command_;
+    /// DecodeError + 1, or 0 while the call has not failed
+    uint8_t error_ = 0;
+};
+
+} // namespace ${ns}::instrumentation
+
+#define BINARY_PROTOCOL_PROBE(operation, commandId, bytes) \\
+    ::${ns}::instrumentation::Probe binaryProtocolProbe(::${ns}::instrumentation::Operation::operation, commandId, bytes)
+#define BINARY_PROTOCOL_PROBE_FAIL(error) binaryProtocolProbe.fail(error)
+#define BINARY_PROTOCOL_FRAME_ERROR(kind) \\
+    ::${ns}::instrumentation::countFrameError(::${ns}::instrumentation::FrameError::kind)
+
+#else
+
+#define BINARY_PROTOCOL_PROBE(operation, commandId, bytes) ((void)0)
+#define BINARY_PROTOCOL_PROBE_FAIL(error) (error)
+#define BINARY_PROTOCOL_FRAME_ERROR(kind) ((void)0)
+
+#endif // BINARY_PROTOCOL_INSTRUMENTATION
+
+#endif // BINARY_PROTOCOL_INSTRUMENTATION_HPP`;
+}
+
+export function generateInstrumentationImpl(ir: SchemaIR, ns: string): string {
+  const messages = messageModels(ir);
+  const commands = messages
+    .map(model => `    {${model.name}::COMMAND_ID, MessageTraits<${model.name}>::NAME},`)
+    .join('\n');
+
+  return `/**
+ * Auto-generated encode/decode instrumentation implementation
+ */
+
+#include "instrumentation.hpp"
+
+#if BINARY_PROTOCOL_INSTRUMENTATION
+
+#include <atomic>
+#include <cmath>
+#include <new>
+
+namespace ${ns}::instrumentation {
+
+namespace {
+
+struct CommandInfo {
+    uint8_t commandId;
+    const char* name;
+};
+
+constexpr std::array<CommandInfo, COMMAND_COUNT> COMMANDS = {{
+${commands}
+}};
+
+struct OperationCounters {
+    std::atomic<uint64_t> calls{0};
+    std::atomic<uint64_t> bytes{0};
+    std::atomic<uint64_t> failures{0};
+    std::atomic<uint64_t> totalNanos{0};
+    std::array<std::atomic<uint64_t>, LatencyHistogram::BUCKETS> latency{};
+};
+
+struct alignas(64) CommandCounters {
+    std::array<OperationCounters, OPERATION_COUNT> operations;
+    std::array<std::atomic<uint64_t>, DECODE_ERROR_COUNT> decodeErrors{};
+};
+
+/**
+ * Counters written by one thread at a time. The owner updates with plain
+ * relaxed load/store pairs instead of read-modify-write operations, which
+ * keeps the hot path free of locked instructions; snapshot() reads them with
+ * relaxed loads. Slots are padded so two threads never share a cache line.
+ */
+struct alignas(64) ThreadSlot {
+    std::array<CommandCounters, COMMAND_COUNT> commands;
+    alignas(64) std::array<std::atomic<uint64_t>, FRAME_ERROR_COUNT> frameErrors{};
+    std::atomic<bool> inUse{true};
+    ThreadSlot* next = nullptr;
+};
+
+/// Every slot ever created; slots are never freed, so their totals survive their threads
+std::atomic<ThreadSlot*> slots{nullptr};
+
+inline void bump(std::atomic<uint64_t>& counter, uint64_t amount) noexcept {
+    counter.store(counter.load(std::memory_order_relaxed) + amount, std::memory_order_relaxed);
+}
+
+/// nullptr if a new slot cannot be allocated; callers run inside noexcept probes
+ThreadSlot* acquireSlot() noexcept {
+    for (ThreadSlot* slot = slots.load(std::memory_order_acquire); slot != nullptr; slot = slot->next) {
+        bool idle = false;
+        if (slot->inUse.compare_exchange_strong(idle, true, std::memory_order_acquire)) return slot;
+    }
+    ThreadSlot* slot = new (std::nothrow) ThreadSlot();
+    if (!slot) return nullptr;
+    slot->next = slots.load(std::memory_order_relaxed);
+    while (!slots.compare_exchange_weak(slot->next, slot, std::memory_order_release, std::memory_order_relaxed)) {
+    }
+    return slot;
+}
+
+/// Hands the slot back for reuse when the owning thread exits
+struct SlotLease {
+    ThreadSlot* slot = nullptr;
+    ~SlotLease() {
+        if (slot) slot->inUse.store(false, std::memory_order_release);
+    }
+};
+
+/// The calling thread's slot, or nullptr while none can be allocated (the sample is then dropped)
+ThreadSlot* currentSlot() noexcept {
+    thread_local SlotLease lease;
+    if (!lease.slot) lease.slot = acquireSlot();
+    return lease.slot;
+}
+
+} // namespace
+
+uint64_t LatencyHistogram::count() const {
+    uint64_t total = 0;
+    for (uint64_t bucket : counts) total += bucket;
+    return total;
+}
+
+uint64_t LatencyHistogram::percentile(double percent) const {
+    const uint64_t total = count();
+    if (total == 0) return 0;
+    const double wanted = std::ceil(percent / 100.0 * static_cast<double>(total));
+    const uint64_t rank = wanted < 1.0 ? 1 : static_cast<uint64_t>(wanted);
+    uint64_t seen = 0;
+    for (size_t bucket = 0; bucket < BUCKETS; bucket++) {
+        seen += counts[bucket];
+        if (seen >= rank) {
+            return bucket + 1 < BUCKETS ? bucketLowerBound(bucket + 1) - 1 : UINT64_MAX;
+        }
+    }
+    return UINT64_MAX;
+}
+
+void Probe::finish() noexcept {
+    const auto elapsed = std::chrono::steady_clock::now() - start_;
+    const uint64_t nanos = static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(elapsed).count());
+
+    ThreadSlot* slot = currentSlot();
+    if (!slot) return;
+    CommandCounters& command = slot->commands[command_];
+    OperationCounters& counters = command.operations[static_cast<size_t>(operation_)];
+    bump(counters.calls, 1);
+    bump(counters.totalNanos, nanos);
+    bump(counters.latency[LatencyHistogram::bucketOf(nanos)], 1);
+    if (error_ != 0) {
+        bump(counters.failures, 1);
+        bump(command.decodeErrors[error_ - 1], 1);
+    } else if (std::uncaught_exceptions() > exceptions_) {
+        bump(counters.failures, 1);
+    } else {
+        bump(counters.bytes, bytes_);
+    }
+}
+
+void countFrameError(FrameError error) noexcept {
+    if (ThreadSlot* slot = currentSlot()) bump(slot->frameErrors[static_cast<size_t>(error)], 1);
+}
+
+Snapshot snapshot() {
+    Snapshot result;
+    result.commands.resize(COMMAND_COUNT);
+    for (size_t i = 0; i < COMMAND_COUNT; i++) {
+        result.commands[i].commandId = COMMANDS[i].commandId;
+        result.commands[i].name = COMMANDS[i].name;
+    }
+
+    for (const ThreadSlot* slot = slots.load(std::memory_order_acquire); slot != nullptr; slot = slot->next) {
+        result.slots++;
+        for (size_t i = 0; i < COMMAND_COUNT; i++) {
+            CommandStats& stats = result.commands[i];
+            for (size_t op = 0; op < OPERATION_COUNT; op++) {
+                const OperationCounters& counters = slot->commands[i].operations[op];
+                OperationStats& out = stats.operations[op];
+                out.calls += counters.calls.load(std::memory_order_relaxed);
+                out.bytes += counters.bytes.load(std::memory_order_relaxed);
+                out.failures += counters.failures.load(std::memory_order_relaxed);
+                out.totalNanos += counters.totalNanos.load(std::memory_order_relaxed);
+                for (size_t bucket = 0; bucket < LatencyHistogram::BUCKETS; bucket++) {
+                    out.latency.counts[bucket] += counters.latency[bucket].load(std::memory_order_relaxed);
+                }
+            }
+            for (size_t error = 0; error < DECODE_ERROR_COUNT; error++) {
+                stats.decodeErrors[error] += slot->commands[i].decodeErrors[error].load(std::memory_order_relaxed);
+            }
+        }
+        for (size_t error = 0; error < FRAME_ERROR_COUNT; error++) {
+            result.frameErrors[error] += slot->frameErrors[error].load(std::memory_order_relaxed);
+        }
+    }
+    return result;
+}
+
+} // namespace ${ns}::instrumentation
+
+#endif // BINARY_PROTOCOL_INSTRUMENTATION`;
+}
@@ -0,0 +1,165 @@
+/**
+ * C++ジェネレーター共通のレイアウト判定ヘルパー
+ */
+
+import {
+  SchemaIR,
+  ModelDefinition,
+  FieldDefinition,
+  TypeInfo,
+  PRIMITIVE_SIZES,
+  CHECKSUM_SIZES,
+  ChecksumAlgorithm,
+  getChecksumDecorator,
+  isPrimitiveType,
+} from '../../ir/types.js';
+
+/**
+ * 名前からモデル定義を検索
+ */
+export function findModel(ir: SchemaIR, name: string): ModelDefinition | undefined {
+  return ir.models.find(m => m.name === name);
+}
+
+/**
+ * 型名が列挙型かどうかを判定
+ */
+export function isEnumType(ir: SchemaIR, name: string): boolean {
+  return ir.enums.some(e => e.name === name);
+}
+
+/**
+ * 配列要素のワイヤサイズ（固定長でない場合は undefined）
+ */
+export function elementWireSize(ir: SchemaIR, elementType: TypeInfo): number | undefined {
+  if (isPrimitiveType(elementType.name)) {
+    return PRIMITIVE_SIZES[elementType.name];
+  }
+  if (isEnumType(ir, elementType.name)) {
+    return 1;
+  }
+  return findModel(ir, elementType.name)?.fixedSize;
+}
+
+/**
+ * packed 構造体のメモリ表現がそのままワイヤ形式になるかを判定
+ * （固定長、bool のような値域制約のあるフィールドを含まず、
+ *   ネストしたモデルも同じバイトオーダー）
+ */
+export function isBulkCopyModel(ir: SchemaIR, model: ModelDefinition): boolean {
+  if (model.fixedSize === undefined) return false;
+  return model.fields.every(field => isBulkCopyField(ir, field, model));
+}
+
+function isBulkCopyField(ir: SchemaIR, field: FieldDefinition, owner: ModelDefinition): boolean {
+  if (field.size.lengthPrefixType || field.type.kind === 'array') return false;
+
+  const typeName = field.type.name;
+  if (typeName === 'bool') return false;
+  if (typeName === 'string' || typeName === 'bytes') return field.size.fixedSize !== undefined;
+  if (isPrimitiveType(typeName)) return PRIMITIVE_SIZES[typeName] === field.size.fixedSize;
+  if (isEnumType(ir, typeName)) return true;
+
+  const nested = findModel(ir, typeName);
+  return nested !== undefined && nested.endian === owner.endian && isBulkCopyModel(ir, nested);
+}
+
+/**
+ * フレームヘッダー（@frame_header）の構成
+ */
+export interface FrameHeaderLayout {
+  model: ModelDefinition;
+  magicField: FieldDefinition;
+  magicValue: number;
+  commandIdField: FieldDefinition;
+  payloadLengthField: FieldDefinition;
+  checksum?: FrameChecksumLayout;
+}
+
+/**
+ * フレームチェックサム（@checksum）の配置
+ */
+export interface FrameChecksumLayout {
+  field: FieldDefinition;
+  /** ヘッダー先頭からのバイトオフセット */
+  offset: number;
+  algorithm: ChecksumAlgorithm;
+}
+
+/**
+ * @frame_header モデルを検索し、フレーミングに必要なフィールドを解決
+ */
+export function findFrameHeader(ir: SchemaIR): FrameHeaderLayout | undefined {
+  const model = ir.models.find(m => m.decorators.some(d => d.name === 'frame_header'));
+  if (!model || model.fixedSize === undefined) return undefined;
+
+  const magicField = model.fields.find(f => f.decorators.some(d => d.name === 'magic'));
+  const commandIdField = model.fields.find(f => f.name === 'command_id');
+  const payloadLengthField = model.fields.find(f => f.name === 'payload_length');
+  if (!magicField || !commandIdField || !payloadLengthField) return undefined;
+
+  const magicValue = magicField.decorators.find(d => d.name === 'magic')!.args[0] as number;
+  return { model, magicField, magicValue, commandIdField, payloadLengthField, checksum: findChecksum(model) };
+}
+
+/**
+ * @checksum フィールドを解決（チェックサム幅とフィールド幅の一致を検証）
+ */
+function findChecksum(model: ModelDefinition): FrameChecksumLayout | undefined {
+  let offset = 0;
+  for (const field of model.fields) {
+    const algorithm = getChecksumDecorator(field.decorators);
+    if (algorithm) {
+      if (field.size.fixedSize !== CHECKSUM_SIZES[algorithm]) {
+        throw new Error(`@checksum(${algorithm}) requires a ${CHECKSUM_SIZES[algorithm]}-byte field: ${model.name}.${field.name}`);
+      }
+      return { field, offset, algorithm };
+    }
+    offset += field.size.fixedSize ?? 0;
+  }
+  return undefined;
+}
+
+/**
+ * 固定値をワイヤ上のバイト列に変換
+ */
+export function wireBytes(value: number, size: number, endian: ModelDefinition['endian']): number[] {
+  const bytes: number[] = [];
+  for (let i = 0; i < size; i++) {
+    bytes.push(Math.floor(value / 2 ** (8 * i)) & 0xff);
+  }
+  return endian === 'big' ? bytes.reverse() : bytes;
+}
+
+/**
+ * 固定長モデルを平坦化した末端フィールド
+ */
+export interface FlatField {
+  /** C++ のメンバーアクセス式（例: position.x） */
+  path: string;
+  /** モデル先頭からのバイトオフセット */
+  offset: number;
+  field: FieldDefinition;
+  /** フィールドを所有するモデル（バイトオーダーの決定に使う） */
+  owner: ModelDefinition;
+}
+
+/**
+ * 固定長モデルのフィールドをネストを展開して列挙
+ */
+export function flattenFixedFields(ir: SchemaIR, model: ModelDefinition, baseOffset = 0, prefix = ''): FlatField[] {
+  const result: FlatField[] = [];
+  let offset = baseOffset;
+  for (const field of model.fields) {
+    const path = prefix ? `${prefix}.${field.name}` : field.name;
+    const nested = findModel(ir, field.type.name);
+    if (nested && nested.fixedSize !== undefined) {
+      result.push(...flattenFixedFields(ir, nested, offset, path));
+      offset += nested.fixedSize;
+      continue;
+    }
+    result.push({ path, offset, field, owner: model });
+    offset += field.size.fixedSize ?? 0;
+  }
+  return result;
+}
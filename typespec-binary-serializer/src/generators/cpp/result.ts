@@ -0,0 +1,104 @@
+/**
+ * C++ エラー処理の共通部生成
+ * 例外を使わないビルド（-fno-exceptions）向けのマクロと、例外を投げないデコード結果型
+ */
+
+/**
+ * 例外送出マクロ（名前空間の外、インクルード直後に置く）
+ */
+export function generateThrowMacro(ns: string): string {
+  return `// Every throw site goes through BINARY_PROTOCOL_THROW. Without exceptions
+// (-fno-exceptions) it aborts with the message instead; use the
+// tryDeserialize functions to handle malformed input in such builds.
+#if defined(__cpp_exceptions) || defined(__EXCEPTIONS) || defined(_CPPUNWIND)
+#define BINARY_PROTOCOL_EXCEPTIONS 1
+#define BINARY_PROTOCOL_THROW(exception) throw exception
+#else
+#define BINARY_PROTOCOL_EXCEPTIONS 0
+#define BINARY_PROTOCOL_THROW(exception) ::${ns}::detail::abortWith((exception).what())
+#endif`;
+}
+
+/**
+ * DecodeError と DecodeResult<T>
+ */
+export function generateDecodeResultHeader(): string {
+  return `// ============================================
+// No-throw decoding
+// ============================================
+
+namespace detail {
+
+[[noreturn]] inline void abortWith(const char* message) noexcept {
+    std::fputs(message, stderr);
+    std::fputc('\\n', stderr);
+    std::abort();
+}
+
+} // namespace detail
+
+enum class DecodeError : uint8_t {
+    /// Input ends inside a fixed-size field or length prefix
+    Truncated,
+    /// An enum field holds a value that is not a member of the enum
+    BadEnumValue,
+    /// A length prefix claims more bytes than remain
+    LengthOverflow,
+    /// An array's byte length is not a multiple of its element size
+    BadArrayLength,
+    /// The command ID does not belong to any message
+    UnknownCommand,
+    /// A compact-encoded varint is over-long or out of range for its field
+    BadVarint,
+};
+
+constexpr const char* toString(DecodeError error) {
+    switch (error) {
+    case DecodeError::Truncated: return "Truncated input";
+    case DecodeError::BadEnumValue: return "Invalid enum value";
+    case DecodeError::LengthOverflow: return "Length prefix exceeds input";
+    case DecodeError::BadArrayLength: return "Invalid array length";
+    case DecodeError::UnknownCommand: return "Unknown command ID";
+    case DecodeError::BadVarint: return "Invalid varint";
+    }
+    return "Unknown decode error";
+}
+
+/**
+ * Value or DecodeError returned by the tryDeserialize functions.
+ * Mirrors the std::expected interface so it can be swapped for it once C++23 is required.
+ */
+template<typename T>
+class DecodeResult {
+public:
+    DecodeResult(T value) : storage_(std::in_place_index<0>, std::move(value)) {}
+    DecodeResult(DecodeError error) : storage_(std::in_place_index<1>, error) {}
+
+    bool has_value() const noexcept { return storage_.index() == 0; }
+    explicit operator bool() const noexcept { return has_value(); }
+
+    /// Checked access; throws (or aborts without exceptions) on an error
+    T& value() & { check(); return *std::get_if<0>(&storage_); }
+    const T& value() const& { check(); return *std::get_if<0>(&storage_); }
+    T&& value() && { check(); return std::move(*std::get_if<0>(&storage_)); }
+
+    T& operator*() & noexcept { return *std::get_if<0>(&storage_); }
+    const T& operator*() const& noexcept { return *std::get_if<0>(&storage_); }
+    T* operator->() noexcept { return std::get_if<0>(&storage_); }
+    const T* operator->() const noexcept { return std::get_if<0>(&storage_); }
+
+    DecodeError error() const noexcept { return *std::get_if<1>(&storage_); }
+
+    template<typename U>
+    T value_or(U&& fallback) const& {
+        return has_value() ? **this : static_cast<T>(std::forward<U>(fallback));
+    }
+
+private:
+    void check() const {
+        if (!has_value()) BINARY_PROTOCOL_THROW(std::runtime_error(toString(error())));
+    }
+
+    std::variant<T, DecodeError> storage_;
+};`;
+}
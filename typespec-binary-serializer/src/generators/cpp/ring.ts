@@ -0,0 +1,583 @@
+/**
+ * C++ ロックフリーメッセージリング生成
+ * エンコード済みメッセージを連続領域にインラインで格納し、スレッド間で受け渡す
+ */
+
+export function generateMessageRingHeader(ns: string): string {
+  return `/**
+ * Auto-generated lock-free message rings
+ * Encoded messages are stored inline as [length u32][bytes], 8-byte aligned, in one
+ * contiguous cache-line-aligned region. Producers encode straight into reserved space
+ * and consumers receive zero-copy views.
+ */
+
+#ifndef BINARY_PROTOCOL_MESSAGE_RING_HPP
+#define BINARY_PROTOCOL_MESSAGE_RING_HPP
+
+#include "protocol.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <bit>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <limits>
+#include <memory>
+#include <new>
+#include <optional>
+#include <span>
+#include <stdexcept>
+
+namespace ${ns} {
+
+namespace detail {
+
+inline constexpr size_t kCacheLineSize = 64;
+inline constexpr size_t kRingRecordAlignment = 8;
+inline constexpr size_t kRingRecordHeaderSize = sizeof(uint32_t);
+/// Record header marking the unused tail of the region; the next record starts at offset 0
+inline constexpr uint32_t kRingWrapMarker = 0xFFFFFFFFu;
+/// Set in the header of a committed MPSC record, so that zero means "not yet written"
+inline constexpr uint32_t kRingCommittedBit = 0x80000000u;
+
+constexpr size_t ringRecordSize(size_t payloadSize) {
+    return (kRingRecordHeaderSize + payloadSize + kRingRecordAlignment - 1) & ~(kRingRecordAlignment - 1);
+}
+
+/// Records are limited to half the ring so that one always fits after a wrap
+inline void checkRingRecord(size_t record, size_t capacity) {
+    if (record > capacity / 2) BINARY_PROTOCOL_THROW(std::length_error("Message larger than half the ring capacity"));
+}
+
+struct RingStorageDeleter {
+    void operator()(uint8_t* memory) const {
+        ::operator delete(memory, std::align_val_t{kCacheLineSize});
+    }
+};
+
+using RingStorage = std::unique_ptr<uint8_t[], RingStorageDeleter>;
+
+inline RingStorage allocateRing(size_t capacity) {
+    if (capacity < kCacheLineSize || !std::has_single_bit(capacity)) {
+        BINARY_PROTOCOL_THROW(std::invalid_argument("Ring capacity must be a power of two of at least 64 bytes"));
+    }
+    auto* memory = static_cast<uint8_t*>(::operator new(capacity, std::align_val_t{kCacheLineSize}));
+    std::memset(memory, 0, capacity);
+    return RingStorage(memory);
+}
+
+} // namespace detail
+
+/**
+ * Single-producer single-consumer message ring.
+ *
+ * Producer writes are staged until publish(), and consume() hands out every
+ * visible message before releasing the space, so a batch of messages costs one
+ * release store on each side.
+ */
+class SpscMessageRing {
+public:
+    /// capacity is the size of the inline region in bytes and must be a power of two
+    explicit SpscMessageRing(size_t capacity)
+        : storage_(detail::allocateRing(capacity)), capacity_(capacity), mask_(capacity - 1) {}
+
+    SpscMessageRing(const SpscMessageRing&) = delete;
+    SpscMessageRing& operator=(const SpscMessageRing&) = delete;
+
+    // ---- Producer ----
+
+    /// Reserves space for one message of exactly size bytes; empty if the ring is full.
+    /// Throws std::length_error for messages that can never fit.
+    std::optional<std::span<uint8_t>> tryReserve(size_t size) {
+        const size_t record = detail::ringRecordSize(size);
+        const size_t offset = staged_ & mask_;
+        const size_t skip = offset + record > capacity_ ? capacity_ - offset : 0;
+        detail::checkRingRecord(record, capacity_);
+        if (staged_ + skip + record - cachedTail_ > capacity_) {
+            cachedTail_ = tail_.value.load(std::memory_order_acquire);
+            if (staged_ + skip + record - cachedTail_ > capacity_) return std::nullopt;
+        }
+        if (skip > 0) {
+            storeHeader(offset, detail::kRingWrapMarker);
+            staged_ += skip;
+        }
+        uint8_t* base = storage_.get() + (staged_ & mask_);
+        storeHeader(staged_ & mask_, static_cast<uint32_t>(size));
+        staged_ += record;
+        return std::span<uint8_t>(base + detail::kRingRecordHeaderSize, size);
+    }
+
+    /// Stages an encoded message; false if the ring is full
+    template<typename T>
+    bool tryPush(const T& message) {
+        checkLengthPrefixes(message);
+        const std::optional<std::span<uint8_t>> slot = tryReserve(encodedSize(message));
+        if (!slot) return false;
+        serializeInto(message, *slot);
+        return true;
+    }
+
+    /// Stages a copy of already encoded bytes, e.g. Frame::bytes
+    bool tryPushBytes(std::span<const uint8_t> bytes) {
+        const std::optional<std::span<uint8_t>> slot = tryReserve(bytes.size());
+        if (!slot) return false;
+        if (!bytes.empty()) std::memcpy(slot->data(), bytes.data(), bytes.size());
+        return true;
+    }
+
+    /// Makes every staged message visible to the consumer
+    void publish() { head_.value.store(staged_, std::memory_order_release); }
+
+    // ---- Consumer ----
+
+    /**
+     * Calls onMessage(std::span<const uint8_t>) for up to maxMessages published
+     * messages, then releases their space. Views are valid only inside the callback.
+     */
+    template<typename F>
+    size_t consume(F&& onMessage, size_t maxMessages = std::numeric_limits<size_t>::max()) {
+        const size_t head = head_.value.load(std::memory_order_acquire);
+        size_t position = consumed_;
+        size_t count = 0;
+        while (position != head && count < maxMessages) {
+            const size_t offset = position & mask_;
+            const uint32_t header = loadHeader(offset);
+            if (header == detail::kRingWrapMarker) {
+                position += capacity_ - offset;
+                continue;
+            }
+            onMessage(std::span<const uint8_t>(storage_.get() + offset + detail::kRingRecordHeaderSize, header));
+            position += detail::ringRecordSize(header);
+            ++count;
+        }
+        if (position != consumed_) {
+            consumed_ = position;
+            tail_.value.store(position, std::memory_order_release);
+        }
+        return count;
+    }
+
+    size_t capacity() const { return capacity_; }
+
+private:
+    struct alignas(detail::kCacheLineSize) Cursor {
+        std::atomic<size_t> value{0};
+    };
+
+    void storeHeader(size_t offset, uint32_t value) { std::memcpy(storage_.get() + offset, &value, sizeof(value)); }
+    uint32_t loadHeader(size_t offset) const {
+        uint32_t value;
+        std::memcpy(&value, storage_.get() + offset, sizeof(value));
+        return value;
+    }
+
+    detail::RingStorage storage_;
+    size_t capacity_;
+    size_t mask_;
+
+    Cursor head_;
+    Cursor tail_;
+    // Producer-local state
+    alignas(detail::kCacheLineSize) size_t staged_ = 0;
+    size_t cachedTail_ = 0;
+    // Consumer-local state
+    alignas(detail::kCacheLineSize) size_t consumed_ = 0;
+};
+
+/**
+ * Multi-producer single-consumer message ring.
+ *
+ * Producers claim space with one CAS on the head cursor and publish each record by
+ * storing its header with release semantics, so slow producers never block others
+ * from reserving. tryPush() with several messages claims space for all of them at once.
+ * The consumer zeroes consumed space before handing it back, which keeps unwritten
+ * headers reading as zero.
+ */
+class MpscMessageRing {
+public:
+    /// A claimed record; the payload becomes visible to the consumer on commit()
+    class Reservation {
+    public:
+        std::span<uint8_t> data() const { return {header_ + detail::kRingRecordHeaderSize, size_}; }
+
+        void commit() {
+            std::atomic_ref<uint32_t>(*reinterpret_cast<uint32_t*>(header_))
+                .store(static_cast<uint32_t>(size_) | detail::kRingCommittedBit, std::memory_order_release);
+        }
+
+    private:
+        friend class MpscMessageRing;
+        Reservation(uint8_t* header, size_t size) : header_(header), size_(size) {}
+
+        uint8_t* header_;
+        size_t size_;
+    };
+
+    /// capacity is the size of the inline region in bytes and must be a power of two
+    explicit MpscMessageRing(size_t capacity)
+        : storage_(detail::allocateRing(capacity)), capacity_(capacity), mask_(capacity - 1) {}
+
+    MpscMessageRing(const MpscMessageRing&) = delete;
+    MpscMessageRing& operator=(const MpscMessageRing&) = delete;
+
+    // ---- Producers (any thread) ----
+
+    /// Claims space for one message of exactly size bytes; empty if the ring is full.
+    /// Throws std::length_error for messages that can never fit.
+    std::optional<Reservation> tryReserve(size_t size) {
+        const std::optional<size_t> position = claim(detail::ringRecordSize(size));
+        if (!position) return std::nullopt;
+        return Reservation(storage_.get() + (*position & mask_), size);
+    }
+
+    /// Encodes and publishes the messages, claiming space for all of them with one CAS
+    template<typename... Ts>
+    bool tryPush(const Ts&... messages) {
+        // A claimed record that is never committed would stall the consumer, so reject before claiming
+        (checkLengthPrefixes(messages), ...);
+        const size_t total = (detail::ringRecordSize(encodedSize(messages)) + ...);
+        const std::optional<size_t> position = claim(total);
+        if (!position) return false;
+        uint8_t* cursor = storage_.get() + (*position & mask_);
+        (emplace(cursor, messages), ...);
+        return true;
+    }
+
+    /// Publishes a copy of already encoded bytes, e.g. Frame::bytes
+    bool tryPushBytes(std::span<const uint8_t> bytes) {
+        std::optional<Reservation> slot = tryReserve(bytes.size());
+        if (!slot) return false;
+        if (!bytes.empty()) std::memcpy(slot->data().data(), bytes.data(), bytes.size());
+        slot->commit();
+        return true;
+    }
+
+    // ---- Consumer (one thread) ----
+
+    /**
+     * Calls onMessage(std::span<const uint8_t>) for up to maxMessages committed
+     * messages in order, stopping at the first record that is claimed but not yet
+     * committed. Views are valid only inside the callback.
+     */
+    template<typename F>
+    size_t consume(F&& onMessage, size_t maxMessages = std::numeric_limits<size_t>::max()) {
+        size_t position = consumed_;
+        size_t count = 0;
+        // Space read in this call is zeroed only by release(), so a full ring must not wrap onto it
+        while (count < maxMessages && position - consumed_ < capacity_) {
+            const size_t offset = position & mask_;
+            const uint32_t header = headerAt(offset).load(std::memory_order_acquire);
+            if (header == 0) break;
+            if (header == detail::kRingWrapMarker) {
+                position += capacity_ - offset;
+                continue;
+            }
+            const size_t size = header & ~detail::kRingCommittedBit;
+            onMessage(std::span<const uint8_t>(storage_.get() + offset + detail::kRingRecordHeaderSize, size));
+            position += detail::ringRecordSize(size);
+            ++count;
+        }
+        release(position);
+        return count;
+    }
+
+    size_t capacity() const { return capacity_; }
+
+private:
+    struct alignas(detail::kCacheLineSize) Cursor {
+        std::atomic<size_t> value{0};
+    };
+
+    std::atomic_ref<uint32_t> headerAt(size_t offset) const {
+        return std::atomic_ref<uint32_t>(*reinterpret_cast<uint32_t*>(storage_.get() + offset));
+    }
+
+    /// Claims record bytes, prefixed by a wrap marker when they would straddle the end
+    std::optional<size_t> claim(size_t record) {
+        detail::checkRingRecord(record, capacity_);
+        size_t head = head_.value.load(std::memory_order_relaxed);
+        for (;;) {
+            const size_t offset = head & mask_;
+            const size_t skip = offset + record > capacity_ ? capacity_ - offset : 0;
+            const size_t tail = tail_.value.load(std::memory_order_acquire);
+            if (head + skip + record - tail > capacity_) return std::nullopt;
+            if (head_.value.compare_exchange_weak(head, head + skip + record, std::memory_order_relaxed)) {
+                if (skip > 0) {
+                    headerAt(offset).store(detail::kRingWrapMarker, std::memory_order_release);
+                }
+                return head + skip;
+            }
+        }
+    }
+
+    template<typename T>
+    static void emplace(uint8_t*& cursor, const T& message) {
+        const size_t size = encodedSize(message);
+        Reservation slot(cursor, size);
+        serializeInto(message, slot.data());
+        slot.commit();
+        cursor += detail::ringRecordSize(size);
+    }
+
+    /// Zeroes consumed space so stale headers never look committed, then hands it back
+    void release(size_t position) {
+        if (position == consumed_) return;
+        size_t from = consumed_ & mask_;
+        size_t remaining = position - consumed_;
+        while (remaining > 0) {
+            const size_t chunk = std::min(remaining, capacity_ - from);
+            std::memset(storage_.get() + from, 0, chunk);
+            remaining -= chunk;
+            from = 0;
+        }
+        consumed_ = position;
+        tail_.value.store(position, std::memory_order_release);
+    }
+
+    detail::RingStorage storage_;
+    size_t capacity_;
+    size_t mask_;
+
+    Cursor head_;
+    Cursor tail_;
+    // Consumer-local state
+    alignas(detail::kCacheLineSize) size_t consumed_ = 0;
+};
+
+} // namespace ${ns}
+
+#endif // BINARY_PROTOCOL_MESSAGE_RING_HPP`;
+}
+
+/**
+ * リングの回帰テスト（単一スレッドの参照モデル比較と、複数スレッドのストレス）
+ */
+export function generateMessageRingTest(ns: string): string {
+  return `/**
+ * Auto-generated message ring regression test
+ *
+ *     test_rings [--iterations N] [--seed S]
+ *
+ * Drives SpscMessageRing and MpscMessageRing from one thread against a std::deque
+ * reference, including rings filled to exactly their capacity, then runs producer
+ * threads against one consumer and requires every message to arrive once, intact
+ * and in per-producer order. Configure with -DBINARY_PROTOCOL_SANITIZE=thread to
+ * run the producers under ThreadSanitizer.
+ */
+
+#include "message_ring.hpp"
+#include "test_codec.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cinttypes>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <deque>
+#include <limits>
+#include <string_view>
+#include <thread>
+#include <vector>
+
+using namespace ${ns};
+using namespace ${ns}::testing;
+
+namespace {
+
+struct Options {
+    uint64_t iterations = 100000;
+    uint64_t seed = 1;
+};
+
+bool fail(const char* test, const char* check, const Options& options, uint64_t iteration) {
+    std::fprintf(stderr, "FAIL %s: %s (seed %" PRIu64 ", iteration %" PRIu64 ")\\n", test, check, options.seed, iteration);
+    return false;
+}
+
+/// Message number sequence from producer: both ids, then bytes derived from them
+void fillMessage(std::vector<uint8_t>& bytes, uint32_t producer, uint32_t sequence, size_t size) {
+    bytes.resize(size);
+    std::memcpy(bytes.data(), &producer, sizeof(producer));
+    std::memcpy(bytes.data() + 4, &sequence, sizeof(sequence));
+    for (size_t i = 8; i < size; i++) bytes[i] = static_cast<uint8_t>(producer * 131 + sequence + i);
+}
+
+bool readMessage(std::span<const uint8_t> view, uint32_t& producer, uint32_t& sequence) {
+    if (view.size() < 8) return false;
+    std::memcpy(&producer, view.data(), sizeof(producer));
+    std::memcpy(&sequence, view.data() + 4, sizeof(sequence));
+    for (size_t i = 8; i < view.size(); i++) {
+        if (view[i] != static_cast<uint8_t>(producer * 131 + sequence + i)) return false;
+    }
+    return true;
+}
+
+template<typename Ring>
+bool push(Ring& ring, std::span<const uint8_t> bytes) {
+    if (!ring.tryPushBytes(bytes)) return false;
+    if constexpr (requires { ring.publish(); }) ring.publish();
+    return true;
+}
+
+/// Fills the ring to exactly its capacity and drains it, over enough rounds for the cursors to wrap
+template<typename Ring>
+bool runFull(const char* name, const Options& options) {
+    Ring ring(64);
+    uint64_t round = 0;
+    for (const size_t payload : {size_t{4}, size_t{12}, size_t{28}}) {
+        for (int repeat = 0; repeat < 8; repeat++, round++) {
+            const std::vector<uint8_t> bytes(payload, static_cast<uint8_t>(round));
+            size_t pushed = 0;
+            while (push(ring, bytes)) pushed++;
+            if (pushed != ring.capacity() / detail::ringRecordSize(payload)) {
+                return fail(name, "ring did not fill to exactly its capacity", options, round);
+            }
+            // One more than was pushed, so re-delivery fails here instead of spinning forever
+            size_t delivered = 0;
+            bool intact = true;
+            ring.consume([&](std::span<const uint8_t> view) {
+                delivered++;
+                intact = intact && std::ranges::equal(view, bytes);
+            }, pushed + 1);
+            if (delivered != pushed || !intact) {
+                return fail(name, "consume of a full ring did not deliver each message once", options, round);
+            }
+            if (ring.consume([](std::span<const uint8_t>) {}) != 0) {
+                return fail(name, "consume of a drained ring delivered messages", options, round);
+            }
+        }
+    }
+    std::printf("%-24s ok\\n", name);
+    return true;
+}
+
+/// Random pushes and partial consumes from one thread, checked against a reference queue
+template<typename Ring>
+bool runModel(const char* name, const Options& options) {
+    Random rng(options.seed ^ std::hash<std::string_view>{}(name));
+    for (const size_t capacity : {size_t{64}, size_t{256}, size_t{4096}}) {
+        Ring ring(capacity);
+        std::deque<std::vector<uint8_t>> expected;
+        std::vector<uint8_t> bytes;
+        uint32_t sequence = 0;
+        for (uint64_t i = 0; i < options.iterations; i++) {
+            if (rng.below(3) != 0) {
+                // Up to the largest record the ring accepts, half its capacity
+                fillMessage(bytes, 0, sequence, 8 + rng.below(capacity / 2 - 11));
+                if (push(ring, bytes)) {
+                    expected.push_back(bytes);
+                    sequence++;
+                }
+                continue;
+            }
+            const size_t limit = rng.boolean() ? std::numeric_limits<size_t>::max() : rng.below(4);
+            size_t seen = 0;
+            bool ok = true;
+            const size_t count = ring.consume([&](std::span<const uint8_t> view) {
+                seen++;
+                if (expected.empty() || !std::ranges::equal(view, expected.front())) {
+                    ok = false;
+                } else {
+                    expected.pop_front();
+                }
+            }, limit);
+            if (!ok || count != seen || count > limit) {
+                return fail(name, "consume delivered a message twice, out of order or corrupted", options, i);
+            }
+            if (limit == std::numeric_limits<size_t>::max() && !expected.empty()) {
+                return fail(name, "consume left committed messages behind", options, i);
+            }
+        }
+    }
+    std::printf("%-24s ok\\n", name);
+    return true;
+}
+
+/// Producer threads push numbered messages of random sizes while this thread consumes them
+template<typename Ring>
+bool runThreads(const char* name, const Options& options, uint32_t producers) {
+    Ring ring(4096);
+    std::atomic<bool> stop{false};
+    std::vector<std::thread> threads;
+    for (uint32_t p = 0; p < producers; p++) {
+        threads.emplace_back([&, p] {
+            Random rng(options.seed + p);
+            std::vector<uint8_t> bytes;
+            for (uint32_t sequence = 0; sequence < options.iterations && !stop.load(std::memory_order_relaxed);) {
+                fillMessage(bytes, p, sequence, 8 + rng.below(120));
+                if (push(ring, bytes)) {
+                    sequence++;
+                } else {
+                    std::this_thread::yield();
+                }
+            }
+        });
+    }
+
+    Random rng(options.seed);
+    std::vector<uint32_t> next(producers, 0);
+    const uint64_t total = options.iterations * producers;
+    uint64_t received = 0;
+    const char* failure = nullptr;
+    auto lastProgress = std::chrono::steady_clock::now();
+    while (received < total && !failure) {
+        const size_t count = ring.consume([&](std::span<const uint8_t> view) {
+            uint32_t producer = 0;
+            uint32_t sequence = 0;
+            if (!readMessage(view, producer, sequence) || producer >= producers) {
+                failure = "consume delivered a corrupted message";
+            } else if (sequence != next[producer]) {
+                failure = "consume lost, repeated or reordered a message";
+            } else {
+                next[producer]++;
+            }
+            received++;
+        }, 1 + rng.below(64));
+        if (count > 0) {
+            lastProgress = std::chrono::steady_clock::now();
+        } else if (std::chrono::steady_clock::now() - lastProgress > std::chrono::seconds(10)) {
+            failure = "consumer made no progress for 10 s";
+        } else {
+            std::this_thread::yield();
+        }
+    }
+    stop.store(true, std::memory_order_relaxed);
+    for (std::thread& thread : threads) thread.join();
+
+    if (!failure && ring.consume([](std::span<const uint8_t>) {}) != 0) {
+        failure = "consume delivered more messages than were pushed";
+    }
+    if (failure) return fail(name, failure, options, received);
+    std::printf("%-24s ok (%" PRIu64 " messages)\\n", name, total);
+    return true;
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    Options options;
+    for (int i = 1; i < argc; i++) {
+        const std::string_view arg = argv[i];
+        if (arg == "--iterations" && i + 1 < argc) {
+            options.iterations = std::strtoull(argv[++i], nullptr, 10);
+        } else if (arg == "--seed" && i + 1 < argc) {
+            options.seed = std::strtoull(argv[++i], nullptr, 10);
+        } else {
+            std::fprintf(stderr, "usage: %s [--iterations N] [--seed S]\\n", argv[0]);
+            return 2;
+        }
+    }
+
+    bool ok = true;
+    ok = runFull<SpscMessageRing>("spsc full", options) && ok;
+    ok = runFull<MpscMessageRing>("mpsc full", options) && ok;
+    ok = runModel<SpscMessageRing>("spsc model", options) && ok;
+    ok = runModel<MpscMessageRing>("mpsc model", options) && ok;
+    ok = runThreads<SpscMessageRing>("spsc threads", options, 1) && ok;
+    ok = runThreads<MpscMessageRing>("mpsc threads", options, 4) && ok;
+    return ok ? 0 : 1;
+}`;
+}
@@ -0,0 +1,825 @@
+/**
+ * C++ 共有メモリ IPC（プロセス間ブロードキャストリング）生成
+ * memfd / shm_open 領域の固定長スロットにフレームを直接エンコードし、
+ * 複数の読み手プロセスがシーケンス番号でゼロコピー参照する（スロットごとのシーケンスロックで上書きを検出）
+ */
+
+import { FrameHeaderLayout } from './layout.js';
+
+export function generateShmRingHeader(layout: FrameHeaderLayout, ns: string): string {
+  const header = layout.model.name;
+  const sealing = layout.checksum
+    ? `
+    sealFrame(frame);`
+    : '';
+
+  return `/**
+ * Auto-generated shared-memory broadcast ring for ${header}-framed messages
+ *
+ * One writer process encodes each frame straight into a slot of a memfd or
+ * shm_open region; any number of reader processes map the region read-only
+ * and read frames in place by ring sequence number. Fan-out to N readers
+ * costs one encode and no copies, and a slow reader never blocks the writer:
+ * it detects that its frame was overwritten and skips ahead.
+ *
+ *     // writer                                    // each reader
+ *     auto ring = ShmRingWriter::create("/telemetry");  ShmRingReader reader = ShmRingReader::open("/telemetry");
+ *     ring.publish(${header}{}, response);             while (auto read = reader.next()) {
+ *                                                          auto view = viewSensorDataResponse(read.frame.payload.data(), ...);
+ *                                                          ...
+ *                                                          if (!reader.valid(read.frame)) { ... discard, it was overwritten }
+ *                                                      }
+ */
+
+#ifndef BINARY_PROTOCOL_SHM_RING_HPP
+#define BINARY_PROTOCOL_SHM_RING_HPP
+
+#include "protocol.hpp"
+
+#include <atomic>
+#include <cstdint>
+#include <span>
+#include <string>
+
+namespace ${ns} {
+
+/*
+ * Region layout (host byte order; every process shares the host):
+ *
+ *   header  "TBSSHM01", u32 version, u32 slot count, u32 slot size, u32 reserved,
+ *           then on its own cache line u64 published (frames ever published)
+ *   slots   slot count x stride (16 + slot size, rounded up to 64):
+ *           u64 state, u32 frame length, u32 reserved, frame bytes
+ *
+ * Frame s lives in slot s % slot count. The writer sets the slot's state to
+ * SHM_SLOT_WRITING before touching its bytes and to s + 1 once the frame is
+ * complete, then advances published. A reader owns frame s only while the
+ * state reads s + 1 both before and after it looks at the bytes (a seqlock),
+ * so views must be checked with ShmRingReader::valid() before they are trusted.
+ */
+inline constexpr uint32_t SHM_RING_VERSION = 1;
+inline constexpr size_t SHM_RING_HEADER_SIZE = 128;
+inline constexpr size_t SHM_SLOT_HEADER_SIZE = 16;
+inline constexpr uint64_t SHM_SLOT_WRITING = ~uint64_t{0};
+
+static_assert(std::atomic_ref<uint64_t>::is_always_lock_free, "Shared-memory rings need lock-free 64-bit atomics");
+
+struct ShmRingOptions {
+    /// Frames kept before the oldest is overwritten; a power of two
+    uint32_t slotCount = 1024;
+    /// Largest frame (${header} and payload) a slot holds
+    uint32_t slotSize = 4096;
+};
+
+struct ShmFrame {
+    /// Ring sequence number, counting every frame the writer published
+    uint64_t sequence;
+    ${header} header;
+    std::span<const uint8_t> payload;
+    /// ${header} and payload as published
+    std::span<const uint8_t> bytes;
+};
+
+enum class ShmReadStatus : uint8_t {
+    Ok,
+    /// The frame has not been published yet
+    Pending,
+    /// The writer has already reused the frame's slot
+    Overrun,
+};
+
+struct ShmRead {
+    ShmReadStatus status;
+    /// Set when status is Ok
+    ShmFrame frame{};
+
+    explicit operator bool() const { return status == ShmReadStatus::Ok; }
+};
+
+struct ShmReaderStats {
+    uint64_t frames = 0;
+    /// Times next() found its frame overwritten and skipped ahead
+    uint64_t overruns = 0;
+    /// Frames skipped because of overruns
+    uint64_t lostFrames = 0;
+};
+
+namespace detail {
+
+/// A mapped ring region; unmapped on destruction
+class ShmMapping {
+public:
+    ShmMapping() = default;
+    ShmMapping(uint8_t* data, size_t size) : data_(data), size_(size) {}
+    ~ShmMapping();
+
+    ShmMapping(ShmMapping&& other) noexcept;
+    ShmMapping& operator=(ShmMapping&& other) noexcept;
+
+    uint8_t* data() const { return data_; }
+    size_t size() const { return size_; }
+
+private:
+    uint8_t* data_ = nullptr;
+    size_t size_ = 0;
+};
+
+constexpr size_t shmSlotStride(uint32_t slotSize) {
+    return (SHM_SLOT_HEADER_SIZE + slotSize + 63) & ~size_t{63};
+}
+
+inline std::atomic_ref<uint64_t> shmWord(const uint8_t* address) {
+    // Readers map the region read-only; they only ever load through this reference
+    return std::atomic_ref<uint64_t>(*reinterpret_cast<uint64_t*>(const_cast<uint8_t*>(address)));
+}
+
+} // namespace detail
+
+/**
+ * The single writer of a ring. Frames are encoded in place, sealed and
+ * published with a release store; publish() never waits for readers.
+ */
+class ShmRingWriter {
+public:
+    /// Creates (or replaces) the POSIX shared-memory object name, e.g. "/telemetry"
+    static ShmRingWriter create(const std::string& name, ShmRingOptions options = {});
+    /// Creates an anonymous memfd region; hand fd() to readers by fork() or SCM_RIGHTS
+    static ShmRingWriter createAnonymous(ShmRingOptions options = {});
+    /// Removes a shared-memory object name; mapped rings stay usable
+    static void unlink(const std::string& name);
+
+    ~ShmRingWriter();
+    ShmRingWriter(ShmRingWriter&& other) noexcept;
+    ShmRingWriter& operator=(ShmRingWriter&& other) noexcept;
+
+    /// Encodes a frame into the next slot and returns its ring sequence number.
+    /// magic, command_id and payload_length are filled in${layout.checksum ? ' and the frame is sealed' : ''}.
+    template<typename T>
+    uint64_t publish(${header} header, const T& message);
+
+    /// Publishes an already framed message, e.g. one handed out by FrameDecoder
+    uint64_t publishFrame(std::span<const uint8_t> frame);
+
+    uint64_t published() const { return next_; }
+    uint32_t slotCount() const { return slotCount_; }
+    uint32_t slotSize() const { return slotSize_; }
+    /// Region file descriptor, kept open for sharing with readers
+    int fd() const { return fd_; }
+
+private:
+    ShmRingWriter(int fd, detail::ShmMapping mapping, ShmRingOptions options);
+    static ShmRingWriter createFromFd(int fd, ShmRingOptions options);
+
+    /// Marks the next slot as being written and returns its frame bytes
+    std::span<uint8_t> beginSlot(size_t frameSize);
+    uint64_t commitSlot(size_t frameSize);
+
+    int fd_ = -1;
+    detail::ShmMapping mapping_;
+    uint32_t slotCount_ = 0;
+    uint32_t slotSize_ = 0;
+    size_t stride_ = 0;
+    uint64_t next_ = 0;
+};
+
+/**
+ * One reader of a ring, usually in another process. The region is mapped
+ * read-only; frames are handed out in place and stay intact until the writer
+ * wraps around to their slot.
+ */
+class ShmRingReader {
+public:
+    /// Attaches to a ring created with ShmRingWriter::create(name)
+    static ShmRingReader open(const std::string& name);
+    /// Attaches to a ring through a descriptor received from the writer; fd stays owned by the caller
+    static ShmRingReader fromFd(int fd);
+
+    /// Reads the frame at the reader's position and advances past it. On an
+    /// overrun the position jumps to the oldest frame still in the ring.
+    ShmRead next();
+
+    /// Reads any frame still in the ring without moving the position
+    ShmRead read(uint64_t sequence) const;
+
+    /// True while frame's slot still holds it; check after reading through views
+    bool valid(const ShmFrame& frame) const;
+
+    uint64_t position() const { return position_; }
+    void seek(uint64_t sequence) { position_ = sequence; }
+    /// Skips to the next frame to be published
+    void seekLatest() { position_ = published(); }
+
+    uint64_t published() const;
+    /// Oldest frame that is not being overwritten
+    uint64_t oldest() const;
+    uint32_t slotCount() const { return slotCount_; }
+    const ShmReaderStats& stats() const { return stats_; }
+
+private:
+    explicit ShmRingReader(detail::ShmMapping mapping);
+
+    detail::ShmMapping mapping_;
+    uint32_t slotCount_ = 0;
+    uint32_t slotSize_ = 0;
+    size_t stride_ = 0;
+    uint64_t position_ = 0;
+    ShmReaderStats stats_;
+};
+
+template<typename T>
+uint64_t ShmRingWriter::publish(${header} header, const T& message) {
+    checkLengthPrefixes(message);
+    const size_t payloadSize = encodedSize(message);
+    const std::span<uint8_t> frame = beginSlot(${header}::ENCODED_SIZE + payloadSize);
+
+    header.magic = ${header}::MAGIC;
+    header.command_id = MessageTraits<T>::COMMAND_ID;
+    header.payload_length = static_cast<decltype(header.payload_length)>(payloadSize);
+    serializeInto(header, frame.first(${header}::ENCODED_SIZE));
+    serializeInto(message, frame.subspan(${header}::ENCODED_SIZE));${sealing}
+    return commitSlot(frame.size());
+}
+
+} // namespace ${ns}
+
+#endif // BINARY_PROTOCOL_SHM_RING_HPP`;
+}
+
+export function generateShmRingImpl(layout: FrameHeaderLayout, ns: string): string {
+  const header = layout.model.name;
+  const payloadLength = layout.payloadLengthField.name;
+
+  return `/**
+ * Auto-generated shared-memory broadcast ring implementation
+ */
+
+#include "shm_ring.hpp"
+
+#include <algorithm>
+#include <array>
+#include <bit>
+#include <cerrno>
+#include <cstring>
+#include <stdexcept>
+#include <system_error>
+#include <utility>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace ${ns} {
+
+namespace {
+
+/// "TBSSHM01", stored as one word so that readers can wait for it atomically
+constexpr uint64_t RING_MAGIC = std::bit_cast<uint64_t>(std::array<char, 8>{'T', 'B', 'S', 'S', 'H', 'M', '0', '1'});
+constexpr size_t MAGIC_OFFSET = 0;
+constexpr size_t VERSION_OFFSET = 8;
+constexpr size_t SLOT_COUNT_OFFSET = 12;
+constexpr size_t SLOT_SIZE_OFFSET = 16;
+/// Separate cache line from the read-mostly fields above
+constexpr size_t PUBLISHED_OFFSET = 64;
+constexpr size_t SLOT_LENGTH_OFFSET = 8;
+
+[[noreturn]] void throwErrno(int error, const std::string& what) {
+    BINARY_PROTOCOL_THROW(std::system_error(error, std::generic_category(), what));
+}
+
+size_t regionSize(uint32_t slotCount, uint32_t slotSize) {
+    return SHM_RING_HEADER_SIZE + static_cast<size_t>(slotCount) * detail::shmSlotStride(slotSize);
+}
+
+/// Maps fd, closing it first when closeFd is set; the mapping keeps the region alive
+detail::ShmMapping mapRegion(int fd, size_t size, int protection, bool closeFd) {
+    void* mapped = ::mmap(nullptr, size, protection, MAP_SHARED, fd, 0);
+    const int error = errno;
+    if (closeFd) ::close(fd);
+    if (mapped == MAP_FAILED) throwErrno(error, "Failed to map shared-memory ring");
+    return detail::ShmMapping(static_cast<uint8_t*>(mapped), size);
+}
+
+detail::ShmMapping mapReadOnly(int fd, bool closeFd) {
+    struct stat info {};
+    if (::fstat(fd, &info) != 0) {
+        const int error = errno;
+        if (closeFd) ::close(fd);
+        throwErrno(error, "Failed to stat shared-memory ring");
+    }
+    const size_t size = static_cast<size_t>(info.st_size);
+    if (size < SHM_RING_HEADER_SIZE) {
+        if (closeFd) ::close(fd);
+        BINARY_PROTOCOL_THROW(std::runtime_error("Not a shared-memory ring"));
+    }
+    return mapRegion(fd, size, PROT_READ, closeFd);
+}
+
+} // namespace
+
+// ============================================
+// Mapping
+// ============================================
+
+detail::ShmMapping::~ShmMapping() {
+    if (data_ != nullptr) ::munmap(data_, size_);
+}
+
+detail::ShmMapping::ShmMapping(ShmMapping&& other) noexcept
+    : data_(std::exchange(other.data_, nullptr)), size_(std::exchange(other.size_, 0)) {}
+
+detail::ShmMapping& detail::ShmMapping::operator=(ShmMapping&& other) noexcept {
+    if (this != &other) {
+        if (data_ != nullptr) ::munmap(data_, size_);
+        data_ = std::exchange(other.data_, nullptr);
+        size_ = std::exchange(other.size_, 0);
+    }
+    return *this;
+}
+
+// ============================================
+// Writer
+// ============================================
+
+ShmRingWriter ShmRingWriter::create(const std::string& name, ShmRingOptions options) {
+    const int fd = ::shm_open(name.c_str(), O_RDWR | O_CREAT | O_TRUNC | O_CLOEXEC, 0600);
+    if (fd < 0) throwErrno(errno, "Failed to create shared memory " + name);
+    return createFromFd(fd, options);
+}
+
+ShmRingWriter ShmRingWriter::createAnonymous(ShmRingOptions options) {
+    const int fd = ::memfd_create("${ns}-shm-ring", MFD_CLOEXEC);
+    if (fd < 0) throwErrno(errno, "Failed to create memfd");
+    return createFromFd(fd, options);
+}
+
+void ShmRingWriter::unlink(const std::string& name) {
+    if (::shm_unlink(name.c_str()) != 0 && errno != ENOENT) throwErrno(errno, "Failed to unlink shared memory " + name);
+}
+
+ShmRingWriter ShmRingWriter::createFromFd(int fd, ShmRingOptions options) {
+    if (options.slotCount == 0 || !std::has_single_bit(options.slotCount)) {
+        ::close(fd);
+        BINARY_PROTOCOL_THROW(std::invalid_argument("Shared-memory ring slot count must be a power of two"));
+    }
+    if (options.slotSize < ${header}::ENCODED_SIZE) {
+        ::close(fd);
+        BINARY_PROTOCOL_THROW(std::invalid_argument("Shared-memory ring slots must hold at least a ${header}"));
+    }
+    const size_t size = regionSize(options.slotCount, options.slotSize);
+    if (::ftruncate(fd, static_cast<off_t>(size)) != 0) {
+        const int error = errno;
+        ::close(fd);
+        throwErrno(error, "Failed to size shared-memory ring");
+    }
+    void* mapped = ::mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    if (mapped == MAP_FAILED) {
+        const int error = errno;
+        ::close(fd);
+        throwErrno(error, "Failed to map shared-memory ring");
+    }
+    return ShmRingWriter(fd, detail::ShmMapping(static_cast<uint8_t*>(mapped), size), options);
+}
+
+ShmRingWriter::ShmRingWriter(int fd, detail::ShmMapping mapping, ShmRingOptions options)
+    : fd_(fd), mapping_(std::move(mapping)), slotCount_(options.slotCount), slotSize_(options.slotSize),
+      stride_(detail::shmSlotStride(options.slotSize)) {
+    // The region starts zeroed: no frame published, every slot state 0 (empty)
+    uint8_t* base = mapping_.data();
+    std::memcpy(base + VERSION_OFFSET, &SHM_RING_VERSION, sizeof(SHM_RING_VERSION));
+    std::memcpy(base + SLOT_COUNT_OFFSET, &slotCount_, sizeof(slotCount_));
+    std::memcpy(base + SLOT_SIZE_OFFSET, &slotSize_, sizeof(slotSize_));
+    // Readers treat the region as initialized once they see the magic
+    detail::shmWord(base + MAGIC_OFFSET).store(RING_MAGIC, std::memory_order_release);
+}
+
+ShmRingWriter::~ShmRingWriter() {
+    if (fd_ >= 0) ::close(fd_);
+}
+
+ShmRingWriter::ShmRingWriter(ShmRingWriter&& other) noexcept
+    : fd_(std::exchange(other.fd_, -1)), mapping_(std::move(other.mapping_)), slotCount_(other.slotCount_),
+      slotSize_(other.slotSize_), stride_(other.stride_), next_(other.next_) {}
+
+ShmRingWriter& ShmRingWriter::operator=(ShmRingWriter&& other) noexcept {
+    if (this != &other) {
+        if (fd_ >= 0) ::close(fd_);
+        fd_ = std::exchange(other.fd_, -1);
+        mapping_ = std::move(other.mapping_);
+        slotCount_ = other.slotCount_;
+        slotSize_ = other.slotSize_;
+        stride_ = other.stride_;
+        next_ = other.next_;
+    }
+    return *this;
+}
+
+std::span<uint8_t> ShmRingWriter::beginSlot(size_t frameSize) {
+    if (frameSize > slotSize_) BINARY_PROTOCOL_THROW(std::length_error("Frame larger than the shared-memory ring slot size"));
+    uint8_t* slot = mapping_.data() + SHM_RING_HEADER_SIZE + (next_ & (slotCount_ - 1)) * stride_;
+    detail::shmWord(slot).store(SHM_SLOT_WRITING, std::memory_order_relaxed);
+    // Orders the state change before the frame bytes that follow
+    std::atomic_thread_fence(std::memory_order_release);
+    return {slot + SHM_SLOT_HEADER_SIZE, frameSize};
+}
+
+uint64_t ShmRingWriter::commitSlot(size_t frameSize) {
+    uint8_t* slot = mapping_.data() + SHM_RING_HEADER_SIZE + (next_ & (slotCount_ - 1)) * stride_;
+    const uint32_t length = static_cast<uint32_t>(frameSize);
+    std::memcpy(slot + SLOT_LENGTH_OFFSET, &length, sizeof(length));
+    const uint64_t sequence = next_++;
+    detail::shmWord(slot).store(sequence + 1, std::memory_order_release);
+    detail::shmWord(mapping_.data() + PUBLISHED_OFFSET).store(next_, std::memory_order_release);
+    return sequence;
+}
+
+uint64_t ShmRingWriter::publishFrame(std::span<const uint8_t> frame) {
+    const std::span<uint8_t> slot = beginSlot(frame.size());
+    if (!frame.empty()) std::memcpy(slot.data(), frame.data(), frame.size());
+    return commitSlot(frame.size());
+}
+
+// ============================================
+// Reader
+// ============================================
+
+ShmRingReader ShmRingReader::open(const std::string& name) {
+    const int fd = ::shm_open(name.c_str(), O_RDONLY | O_CLOEXEC, 0);
+    if (fd < 0) throwErrno(errno, "Failed to open shared memory " + name);
+    return ShmRingReader(mapReadOnly(fd, true));
+}
+
+ShmRingReader ShmRingReader::fromFd(int fd) {
+    return ShmRingReader(mapReadOnly(fd, false));
+}
+
+ShmRingReader::ShmRingReader(detail::ShmMapping mapping) : mapping_(std::move(mapping)) {
+    const uint8_t* base = mapping_.data();
+    const bool magic = detail::shmWord(base + MAGIC_OFFSET).load(std::memory_order_acquire) == RING_MAGIC;
+    uint32_t version;
+    std::memcpy(&version, base + VERSION_OFFSET, sizeof(version));
+    std::memcpy(&slotCount_, base + SLOT_COUNT_OFFSET, sizeof(slotCount_));
+    std::memcpy(&slotSize_, base + SLOT_SIZE_OFFSET, sizeof(slotSize_));
+    if (!magic || version != SHM_RING_VERSION || slotCount_ == 0 || !std::has_single_bit(slotCount_)
+        || mapping_.size() < regionSize(slotCount_, slotSize_)) {
+        BINARY_PROTOCOL_THROW(std::runtime_error("Not a shared-memory ring"));
+    }
+    stride_ = detail::shmSlotStride(slotSize_);
+    position_ = published();
+}
+
+uint64_t ShmRingReader::published() const {
+    return detail::shmWord(mapping_.data() + PUBLISHED_OFFSET).load(std::memory_order_acquire);
+}
+
+uint64_t ShmRingReader::oldest() const {
+    const uint64_t end = published();
+    // The slot of frame end may already be in the middle of being rewritten
+    return end < slotCount_ ? 0 : end - slotCount_ + 1;
+}
+
+ShmRead ShmRingReader::read(uint64_t sequence) const {
+    if (sequence >= published()) return {ShmReadStatus::Pending};
+    const uint8_t* slot = mapping_.data() + SHM_RING_HEADER_SIZE + (sequence & (slotCount_ - 1)) * stride_;
+    if (detail::shmWord(slot).load(std::memory_order_acquire) != sequence + 1) return {ShmReadStatus::Overrun};
+
+    uint32_t length;
+    std::memcpy(&length, slot + SLOT_LENGTH_OFFSET, sizeof(length));
+    const uint8_t* frame = slot + SHM_SLOT_HEADER_SIZE;
+    ShmRead result{ShmReadStatus::Ok};
+    result.frame.sequence = sequence;
+    if (length >= ${header}::ENCODED_SIZE && length <= slotSize_) {
+        result.frame.header = deserialize${header}(frame, ${header}::ENCODED_SIZE);
+    }
+    result.frame.bytes = {frame, length};
+    // Checked against the slot so that a torn header never points past it
+    if (length < ${header}::ENCODED_SIZE || length > slotSize_
+        || result.frame.header.${payloadLength} > length - ${header}::ENCODED_SIZE || !valid(result.frame)) {
+        return {ShmReadStatus::Overrun};
+    }
+    result.frame.payload = {frame + ${header}::ENCODED_SIZE, result.frame.header.${payloadLength}};
+    return result;
+}
+
+bool ShmRingReader::valid(const ShmFrame& frame) const {
+    // Orders every earlier read of the frame before the state is checked again
+    std::atomic_thread_fence(std::memory_order_acquire);
+    const uint8_t* slot = mapping_.data() + SHM_RING_HEADER_SIZE + (frame.sequence & (slotCount_ - 1)) * stride_;
+    return detail::shmWord(slot).load(std::memory_order_relaxed) == frame.sequence + 1;
+}
+
+ShmRead ShmRingReader::next() {
+    const ShmRead result = read(position_);
+    if (result.status == ShmReadStatus::Ok) {
+        position_++;
+        stats_.frames++;
+    } else if (result.status == ShmReadStatus::Overrun) {
+        const uint64_t resume = std::max(oldest(), position_ + 1);
+        stats_.overruns++;
+        stats_.lostFrames += resume - position_;
+        position_ = resume;
+    }
+    return result;
+}
+
+} // namespace ${ns}`;
+}
+
+/**
+ * 共有メモリリングのテスト（createAnonymous + fromFd、順序、周回遅れの検出、valid()、スロット超過の拒否）
+ */
+export function generateShmRingTest(layout: FrameHeaderLayout, ns: string): string {
+  const header = layout.model.name;
+  const payloadLength = layout.payloadLengthField.name;
+  const seal = layout.checksum
+    ? `
+        sealFrame(header, payload);`
+    : '';
+
+  return `/**
+ * Auto-generated shared-memory ring test
+ *
+ *     test_shm_ring [--iterations N] [--seed S]
+ *
+ * Publishes random frames through publish() and publishFrame() into memfd
+ * rings and reads them back through readers attached with fromFd(). Readers
+ * that keep up see every frame in order and intact; a reader the writer laps
+ * must report Overrun, skip to the oldest frame left and count the overrun and
+ * the frames lost, as predicted by a model of which slots still hold their
+ * frame. valid() must turn false exactly when a frame's slot is reused, and
+ * frames larger than a slot must be rejected without touching the ring.
+ */
+
+#include "shm_ring.hpp"
+#include "test_codec.hpp"
+
+#include <algorithm>
+#include <cinttypes>
+#include <cstdio>
+#include <cstdlib>
+#include <deque>
+#include <optional>
+#include <stdexcept>
+#include <string_view>
+#include <variant>
+#include <vector>
+
+using namespace ${ns};
+using namespace ${ns}::testing;
+
+namespace {
+
+struct Options {
+    uint64_t iterations = 20000;
+    uint64_t seed = 1;
+};
+
+bool fail(const char* test, const char* check, const Options& options, uint64_t iteration) {
+    std::fprintf(stderr, "FAIL %s: %s (seed %" PRIu64 ", iteration %" PRIu64 ")\\n", test, check, options.seed, iteration);
+    return false;
+}
+
+/// Larger frames are redrawn
+constexpr uint32_t SLOT_SIZE = 2048;
+
+std::vector<uint8_t> frameOf(${header} header, const Message& message) {
+    return std::visit([&](const auto& value) {
+        const std::vector<uint8_t> payload = serialize(value);
+        header.magic = ${header}::MAGIC;
+        header.command_id = MessageTraits<std::decay_t<decltype(value)>>::COMMAND_ID;
+        header.${payloadLength} = static_cast<decltype(header.${payloadLength})>(payload.size());${seal}
+        std::vector<uint8_t> frame = serialize(header);
+        frame.insert(frame.end(), payload.begin(), payload.end());
+        return frame;
+    }, message);
+}
+
+/// Publishes a random frame that fits a slot through publish() or publishFrame(); returns the bytes readers should see
+std::vector<uint8_t> publishRandom(ShmRingWriter& writer, Random& rng) {
+    while (true) {
+        const ${header} header = CodecTraits<${header}>::random(rng);
+        const Message message = randomMessage(rng);
+        std::vector<uint8_t> frame = frameOf(header, message);
+        if (frame.size() > writer.slotSize()) continue;
+        if (rng.boolean()) {
+            std::visit([&](const auto& value) { writer.publish(header, value); }, message);
+        } else {
+            writer.publishFrame(frame);
+        }
+        return frame;
+    }
+}
+
+/// Returns the name of the first failed check of a frame read back, or nullptr
+const char* checkFrame(const ShmRingReader& reader, const ShmRead& read, uint64_t sequence, const std::vector<uint8_t>& expected) {
+    if (read.status == ShmReadStatus::Pending) return "published frame reported Pending";
+    if (read.status == ShmReadStatus::Overrun) return "frame still in the ring reported Overrun";
+    if (read.frame.sequence != sequence) return "frame has the wrong sequence number";
+    if (!std::ranges::equal(read.frame.bytes, expected)) return "frame bytes differ from the frame published";
+    if (!(read.frame.header == deserialize${header}(expected.data(), ${header}::ENCODED_SIZE))) return "header differs from the frame published";
+    if (read.frame.payload.data() != read.frame.bytes.data() + ${header}::ENCODED_SIZE
+        || read.frame.payload.size() != expected.size() - ${header}::ENCODED_SIZE) {
+        return "payload is not the rest of the frame";
+    }
+    if (!reader.valid(read.frame)) return "valid() is false for a frame still in the ring";
+    return nullptr;
+}
+
+/// Two readers that keep up see every frame in order, the second from the point it attached
+bool runOrder(const Options& options) {
+    Random rng(options.seed);
+    ShmRingWriter writer = ShmRingWriter::createAnonymous({.slotCount = 64, .slotSize = SLOT_SIZE});
+    ShmRingReader first = ShmRingReader::fromFd(writer.fd());
+    std::optional<ShmRingReader> late;
+    // The last slotCount frames, ending at published() - 1
+    std::deque<std::vector<uint8_t>> frames;
+
+    for (uint64_t round = 0; writer.published() < options.iterations; round++) {
+        for (uint64_t burst = 1 + rng.below(writer.slotCount()); burst > 0; burst--) {
+            const uint64_t sequence = writer.published();
+            frames.push_back(publishRandom(writer, rng));
+            if (frames.size() > writer.slotCount()) frames.pop_front();
+            if (writer.published() != sequence + 1) return fail("order", "published() did not advance by one", options, sequence);
+        }
+        if (round == 1) {
+            late.emplace(ShmRingReader::fromFd(writer.fd()));
+            if (late->position() != writer.published()) return fail("order", "a new reader does not start at published()", options, round);
+        }
+
+        for (ShmRingReader* reader : {&first, late ? &*late : nullptr}) {
+            if (!reader) continue;
+            while (reader->position() < writer.published()) {
+                const uint64_t sequence = reader->position();
+                const std::vector<uint8_t>& expected = frames[sequence - (writer.published() - frames.size())];
+                if (const char* failure = checkFrame(*reader, reader->next(), sequence, expected)) return fail("order", failure, options, sequence);
+            }
+            if (reader->next().status != ShmReadStatus::Pending) return fail("order", "next() at published() is not Pending", options, round);
+            if (reader->position() != writer.published()) return fail("order", "Pending moved the position", options, round);
+            if (reader->stats().overruns != 0) return fail("order", "a reader that keeps up was overrun", options, round);
+        }
+
+        // read() reaches any frame still in the ring without moving the position
+        const uint64_t back = rng.below(frames.size());
+        const uint64_t sequence = writer.published() - 1 - back;
+        if (const char* failure = checkFrame(first, first.read(sequence), sequence, frames[frames.size() - 1 - back])) {
+            return fail("order", failure, options, sequence);
+        }
+        if (first.position() != writer.published()) return fail("order", "read() moved the position", options, round);
+    }
+    if (first.stats().frames != writer.published()) return fail("order", "stats().frames != frames published", options, 0);
+    return true;
+}
+
+/// A reader lapped by the writer reports Overrun, skips to the oldest frame left and counts the frames lost
+bool runOverrun(const Options& options) {
+    constexpr uint32_t SLOTS = 8;
+    Random rng(options.seed);
+    ShmRingWriter writer = ShmRingWriter::createAnonymous({.slotCount = SLOTS, .slotSize = SLOT_SIZE});
+    ShmRingReader reader = ShmRingReader::fromFd(writer.fd());
+    std::deque<std::vector<uint8_t>> frames;
+    uint64_t position = 0;
+    ShmReaderStats expected;
+
+    for (uint64_t i = 0; i < options.iterations / 8; i++) {
+        for (uint64_t count = rng.below(3 * SLOTS); count > 0; count--) {
+            frames.push_back(publishRandom(writer, rng));
+            if (frames.size() > SLOTS) frames.pop_front();
+        }
+        const uint64_t published = writer.published();
+        for (uint64_t count = rng.below(2 * SLOTS); count > 0; count--) {
+            const ShmRead read = reader.next();
+            if (position == published) {
+                if (read.status != ShmReadStatus::Pending) return fail("overrun", "next() at published() is not Pending", options, i);
+            } else if (position + SLOTS < published) {
+                // The frame's slot now holds a later one
+                if (read.status != ShmReadStatus::Overrun) return fail("overrun", "next() of an overwritten frame is not Overrun", options, i);
+                const uint64_t resume = std::max(published - SLOTS + 1, position + 1);
+                expected.overruns++;
+                expected.lostFrames += resume - position;
+                position = resume;
+            } else {
+                const std::vector<uint8_t>& frame = frames[position - (published - frames.size())];
+                if (const char* failure = checkFrame(reader, read, position, frame)) return fail("overrun", failure, options, i);
+                expected.frames++;
+                position++;
+            }
+            if (reader.position() != position) return fail("overrun", "position() differs from the model", options, i);
+            if (reader.stats().frames != expected.frames) return fail("overrun", "stats().frames differs from the model", options, i);
+            if (reader.stats().overruns != expected.overruns) return fail("overrun", "stats().overruns differs from the model", options, i);
+            if (reader.stats().lostFrames != expected.lostFrames) return fail("overrun", "stats().lostFrames differs from the model", options, i);
+        }
+    }
+    if (options.iterations >= 64 && expected.overruns == 0) return fail("overrun", "the writer never lapped the reader", options, 0);
+    return true;
+}
+
+/// valid() holds for a frame until the writer reuses its slot
+bool runValid(const Options& options) {
+    constexpr uint32_t SLOTS = 4;
+    Random rng(options.seed);
+    ShmRingWriter writer = ShmRingWriter::createAnonymous({.slotCount = SLOTS, .slotSize = SLOT_SIZE});
+    ShmRingReader reader = ShmRingReader::fromFd(writer.fd());
+
+    for (uint64_t i = 0; i < options.iterations / 16; i++) {
+        reader.seekLatest();
+        const uint64_t sequence = writer.published();
+        const std::vector<uint8_t> expected = publishRandom(writer, rng);
+        const ShmRead read = reader.next();
+        if (const char* failure = checkFrame(reader, read, sequence, expected)) return fail("valid", failure, options, i);
+
+        for (uint32_t later = 1; later < SLOTS; later++) {
+            publishRandom(writer, rng);
+            if (!reader.valid(read.frame)) return fail("valid", "valid() turned false before the slot was reused", options, i);
+        }
+        publishRandom(writer, rng);
+        if (reader.valid(read.frame)) return fail("valid", "valid() still true after the slot was reused", options, i);
+        if (reader.read(sequence).status != ShmReadStatus::Overrun) return fail("valid", "read() of an overwritten frame is not Overrun", options, i);
+    }
+    return true;
+}
+
+#if defined(__cpp_exceptions)
+/// Frames larger than a slot are rejected before the ring is touched, as are unusable ring options
+bool runOversized(const Options& options) {
+    constexpr uint32_t SMALL_SLOT = ${header}::ENCODED_SIZE + 64;
+    Random rng(options.seed);
+    ShmRingWriter writer = ShmRingWriter::createAnonymous({.slotCount = 4, .slotSize = SMALL_SLOT});
+    ShmRingReader reader = ShmRingReader::fromFd(writer.fd());
+
+    // Exactly one slot
+    ${header} header{};
+    header.magic = ${header}::MAGIC;
+    header.${payloadLength} = SMALL_SLOT - ${header}::ENCODED_SIZE;
+    std::vector<uint8_t> last = serialize(header);
+    last.resize(SMALL_SLOT);
+    writer.publishFrame(last);
+
+    for (uint64_t i = 0; i < options.iterations / 16; i++) {
+        const ${header} random = CodecTraits<${header}>::random(rng);
+        const Message message = randomMessage(rng);
+        const std::vector<uint8_t> frame = frameOf(random, message);
+        const uint64_t published = writer.published();
+        bool rejected = false;
+        try {
+            if (rng.boolean()) {
+                std::visit([&](const auto& value) { writer.publish(random, value); }, message);
+            } else {
+                writer.publishFrame(frame);
+            }
+        } catch (const std::length_error&) {
+            rejected = true;
+        }
+
+        if (rejected != (frame.size() > SMALL_SLOT)) {
+            return fail("oversized", rejected ? "a frame that fits was rejected" : "a frame larger than a slot was published", options, i);
+        }
+        if (!rejected) {
+            last = frame;
+            continue;
+        }
+        if (writer.published() != published) return fail("oversized", "a rejected frame was counted as published", options, i);
+        // Neither the newest frame nor the slot a rejected frame would have taken may change
+        if (const char* failure = checkFrame(reader, reader.read(published - 1), published - 1, last)) return fail("oversized", failure, options, i);
+        if (published >= 4) {
+            const ShmRead oldest = reader.read(published - 4);
+            if (!oldest || !reader.valid(oldest.frame)) return fail("oversized", "a rejected frame disturbed the slot it would have used", options, i);
+        }
+    }
+
+    for (const ShmRingOptions bad : {ShmRingOptions{0, SLOT_SIZE}, ShmRingOptions{3, SLOT_SIZE}, ShmRingOptions{4, ${header}::ENCODED_SIZE - 1}}) {
+        try {
+            (void)ShmRingWriter::createAnonymous(bad);
+            return fail("oversized", "createAnonymous accepted unusable options", options, 0);
+        } catch (const std::invalid_argument&) {
+        }
+    }
+    return true;
+}
+#endif
+
+} // namespace
+
+int main(int argc, char** argv) {
+    Options options;
+    for (int i = 1; i < argc; i++) {
+        const std::string_view arg = argv[i];
+        if (arg == "--iterations" && i + 1 < argc) {
+            options.iterations = std::strtoull(argv[++i], nullptr, 10);
+        } else if (arg == "--seed" && i + 1 < argc) {
+            options.seed = std::strtoull(argv[++i], nullptr, 10);
+        } else {
+            std::fprintf(stderr, "usage: %s [--iterations N] [--seed S]\\n", argv[0]);
+            return 2;
+        }
+    }
+
+    bool ok = runOrder(options);
+    ok = runOverrun(options) && ok;
+    ok = runValid(options) && ok;
+#if defined(__cpp_exceptions)
+    ok = runOversized(options) && ok;
+#endif
+    return ok ? 0 : 1;
+}
+`;
+}
@@ -0,0 +1,807 @@
+/**
+ * C++ コーデック検証コード生成
+ * ランダムなインスタンスによる往復（serialize → deserialize → 比較）ストレステストと、
+ * モデルごとの libFuzzer ターゲットが共有するチェックを出力する
+ */
+
+import { SchemaIR, ModelDefinition, FieldDefinition, PRIMITIVE_SIZES } from '../../ir/types.js';
+import { FrameHeaderLayout, elementWireSize, findModel } from './layout.js';
+import { findCompactFields } from './compact.js';
+import { findBatchLayouts } from './batch.js';
+import { messageModels } from './dispatch.js';
+
+const INDENT = '    ';
+
+/**
+ * 検証対象のモデル（ネスト/配列要素のモデルが先）
+ */
+export function testedModels(ir: SchemaIR): ModelDefinition[] {
+  const ordered: ModelDefinition[] = [];
+  const visit = (model: ModelDefinition) => {
+    if (ordered.includes(model)) return;
+    for (const field of model.fields) {
+      const dependency = findModel(ir, field.type.elementType?.name ?? field.type.name);
+      if (dependency && dependency !== model) visit(dependency);
+    }
+    ordered.push(model);
+  };
+  ir.models.forEach(visit);
+  return ordered;
+}
+
+export function generateTestSupportHeader(ir: SchemaIR, ns: string, frameHeader?: FrameHeaderLayout): string {
+  const compactModels = new Set(findCompactFields(ir).map(c => c.model.name));
+  const traits = testedModels(ir).map(model => generateCodecTraits(ir, model, compactModels.has(model.name)));
+  const batchHelper = findBatchLayouts(ir).length > 0 ? `
+
+/// Batch field bytes framed as tryDeserialize requires: entries with random command IDs and payloads
+template<Endian E>
+std::vector<uint8_t> randomBatch(Random& rng, size_t limit) {
+    std::vector<uint8_t> bytes;
+    for (uint64_t entries = rng.below(8); entries > 0; entries--) {
+        const size_t length = rng.length(std::min<size_t>(limit, std::numeric_limits<uint16_t>::max()));
+        if (bytes.size() + BATCH_ENTRY_HEADER_SIZE + length > limit) break;
+        const size_t offset = bytes.size();
+        bytes.resize(offset + BATCH_ENTRY_HEADER_SIZE + length);
+        bytes[offset] = rng.integer<uint8_t>();
+        detail::store<E>(bytes.data() + offset + 1, static_cast<uint16_t>(length));
+        std::span<uint8_t> payload = std::span<uint8_t>(bytes).subspan(offset + BATCH_ENTRY_HEADER_SIZE);
+        rng.fill(payload);
+    }
+    return bytes;
+}` : '';
+
+  const messages = messageModels(ir);
+  const messageHelper = messages.length > 0 ? `
+
+/// A random instance of a random message type
+inline Message randomMessage(Random& rng) {
+    switch (rng.below(${messages.length})) {
+${messages.map((m, i) => i === messages.length - 1
+    ? `    default: return CodecTraits<${m.name}>::random(rng);`
+    : `    case ${i}: return CodecTraits<${m.name}>::random(rng);`).join('\n')}
+    }
+}` : '';
+
+  return `/**
+ * Auto-generated codec checks shared by test_roundtrip and the fuzz targets
+ *
+ * checkRoundTrip() encodes a value through every encoder and decodes it through
+ * every decoder, requiring identical bytes and equal values throughout.
+ * checkDecode() takes arbitrary bytes and requires that whatever tryDeserialize
+ * accepts re-encodes to a fixpoint that every other decoder agrees on. Both also
+ * run the bytes through the table-driven dynamic codec, which must accept and
+ * reject exactly the same inputs and re-encode them byte for byte.
+ */
+
+#ifndef BINARY_PROTOCOL_TEST_CODEC_HPP
+#define BINARY_PROTOCOL_TEST_CODEC_HPP
+
+#include "dynamic_codec.hpp"
+#include "protocol.hpp"${frameHeader ? '\n#include "frame_decoder.hpp"' : ''}
+
+#include <algorithm>
+#include <bit>
+#include <cstdint>
+#include <cstring>
+#include <functional>
+#include <initializer_list>
+#include <limits>
+#include <span>
+#include <type_traits>
+#include <vector>
+
+namespace ${ns}::testing {
+
+/// xoshiro256** seeded through splitmix64; deterministic for a given seed on every platform
+class Random {
+public:
+    explicit Random(uint64_t seed) {
+        for (uint64_t& word : state_) {
+            seed += 0x9E3779B97F4A7C15ull;
+            uint64_t z = seed;
+            z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ull;
+            z = (z ^ (z >> 27)) * 0x94D049BB133111EBull;
+            word = z ^ (z >> 31);
+        }
+    }
+
+    uint64_t next() {
+        const uint64_t result = std::rotl(state_[1] * 5, 7) * 9;
+        const uint64_t t = state_[1] << 17;
+        state_[2] ^= state_[0];
+        state_[3] ^= state_[1];
+        state_[1] ^= state_[2];
+        state_[0] ^= state_[3];
+        state_[2] ^= t;
+        state_[3] = std::rotl(state_[3], 45);
+        return result;
+    }
+
+    /// Uniform in [0, bound)
+    uint64_t below(uint64_t bound) { return bound == 0 ? 0 : next() % bound; }
+
+    bool boolean() { return (next() & 1) != 0; }
+
+    template<typename T>
+    T integer() { return static_cast<T>(next()); }
+
+    /// Any bit pattern except NaN, so values compare equal to themselves
+    template<typename T>
+    T real() {
+        using Bits = std::conditional_t<sizeof(T) == 4, uint32_t, uint64_t>;
+        const T value = std::bit_cast<T>(static_cast<Bits>(next()));
+        return value == value ? value : T(0);
+    }
+
+    /// Mostly short lengths, sometimes the limit itself
+    size_t length(size_t limit) {
+        switch (next() % 8) {
+        case 0: return 0;
+        case 1: return limit;
+        case 2: return static_cast<size_t>(below(limit + 1));
+        default: return static_cast<size_t>(below(std::min<size_t>(limit, 64) + 1));
+        }
+    }
+
+    template<typename T>
+    T pick(std::initializer_list<T> values) { return values.begin()[below(values.size())]; }
+
+    template<typename Container>
+    void fill(Container& bytes) {
+        for (auto& byte : bytes) byte = static_cast<std::remove_reference_t<decltype(byte)>>(next());
+    }
+
+private:
+    uint64_t state_[4];
+};${batchHelper}
+
+/**
+ * Deep comparison between an owning value, a view or a re-decoded copy.
+ * Floats and models compare by their encoding so NaN payloads from fuzz
+ * inputs still match themselves.
+ */
+template<typename A, typename B>
+bool matches(const A& a, const B& b) {
+    if constexpr (std::is_floating_point_v<A> && std::is_same_v<A, B>) {
+        using Bits = std::conditional_t<sizeof(A) == 4, uint32_t, uint64_t>;
+        return std::bit_cast<Bits>(a) == std::bit_cast<Bits>(b);
+    } else if constexpr (std::is_same_v<A, B> && requires { serializeToArray(a); }) {
+        return serializeToArray(a) == serializeToArray(b);
+    } else if constexpr (std::is_same_v<A, B> && requires { serialize(a); }) {
+        return serialize(a) == serialize(b);
+    } else if constexpr (std::is_integral_v<A> && std::is_integral_v<B> && sizeof(A) == 1 && sizeof(B) == 1) {
+        return static_cast<uint8_t>(a) == static_cast<uint8_t>(b);
+    } else if constexpr (requires { a.size(); a.begin(); b.size(); b[0]; } && !std::is_same_v<A, B>) {
+        // View (span or ArrayView) against its owning container
+        if (a.size() != b.size()) return false;
+        size_t index = 0;
+        for (auto&& element : a) {
+            if (!matches(element, b[index++])) return false;
+        }
+        return true;
+    } else if constexpr (requires { a.size(); a[0]; b[0]; }) {
+        if (a.size() != b.size()) return false;
+        for (size_t i = 0; i < a.size(); i++) {
+            if (!matches(a[i], b[i])) return false;
+        }
+        return true;
+    } else {
+        return a == b;
+    }
+}
+
+/// Per-model entry points and random instances
+template<typename T>
+struct CodecTraits;
+
+${traits.join('\n\n')}${messageHelper}
+
+// ============================================
+// Checks
+// ============================================
+
+/// builtinSchemaDescriptor() loaded once into the table-driven codec
+inline const dynamic::Schema& dynamicSchema() {
+    static const dynamic::Schema schema = dynamic::Schema::load(dynamic::builtinSchemaDescriptor());
+    return schema;
+}
+
+/// The dynamic codec must agree with the generated tryDecode result for the same bytes
+template<typename T>
+const char* checkDynamic(const uint8_t* data, size_t size, const DecodeResult<T>& generated) {
+    static const dynamic::Model* const model = dynamicSchema().model(CodecTraits<T>::NAME);
+    if (!model) return "model missing from builtinSchemaDescriptor()";
+    const DecodeResult<dynamic::Record> record = model->tryDecode({data, size});
+    if (record.has_value() != generated.has_value()) return "dynamic tryDecode disagrees with tryDeserialize";
+    if (!record) return record.error() == generated.error() ? nullptr : "dynamic tryDecode reports a different error";
+
+    const std::vector<uint8_t> expected = serialize(*generated);
+    if (model->encodedSize(*record) != expected.size()) return "dynamic encodedSize != encodedSize";
+    std::vector<uint8_t> encoded;
+    model->encode(*record, encoded);
+    if (encoded != expected) return "dynamic encode != serialize";
+    return nullptr;
+}
+
+/// Returns the name of the first failed check, or nullptr
+template<typename T>
+const char* checkRoundTrip(const T& value, std::vector<uint8_t>& scratch) {
+    using Traits = CodecTraits<T>;
+    const std::vector<uint8_t> bytes = serialize(value);
+    if (bytes.size() != encodedSize(value)) return "serialize size != encodedSize";
+
+    // Reference encodings built independently of serializeInto()
+    if constexpr (requires { serializeToArray(value); }) {
+        const auto reference = serializeToArray(value);
+        if (!std::ranges::equal(reference, bytes)) return "serialize != serializeToArray";
+    } else {
+        GatherList list;
+        serializeGather(value, list);
+        scratch.clear();
+        for (std::span<const uint8_t> segment : list.segments()) {
+            scratch.insert(scratch.end(), segment.begin(), segment.end());
+        }
+        if (scratch != bytes) return "serialize != serializeGather";
+    }
+
+    // serializeInto() must write exactly encodedSize() bytes
+    scratch.assign(bytes.size() + 1, 0xA5);
+    if (serializeInto(value, std::span<uint8_t>(scratch.data(), bytes.size())) != bytes.size()) return "serializeInto size";
+    if (scratch.back() != 0xA5) return "serializeInto wrote past encodedSize";
+    scratch.pop_back();
+    if (scratch != bytes) return "serializeInto != serialize";
+
+    BinaryWriter writer;
+    writer.writeUint8(0xA5);
+    serialize(value, writer);
+    if (!std::ranges::equal(writer.view().subspan(1), bytes)) return "serialize(writer) != serialize";
+
+    const DecodeResult<T> decoded = Traits::tryDecode(bytes.data(), bytes.size());
+    if (!decoded) return "tryDeserialize rejected a valid encoding";
+    if (!(*decoded == value)) return "tryDeserialize != original";
+    if (const char* failure = checkDynamic<T>(bytes.data(), bytes.size(), decoded)) return failure;
+    if (!(Traits::decode(bytes.data(), bytes.size()) == value)) return "deserialize != original";
+    if constexpr (Traits::HAS_VIEW) {
+        if (!Traits::viewMatches(Traits::view(bytes.data(), bytes.size()), value)) return "view != original";
+    }
+    if constexpr (Traits::HAS_COMMAND) {
+        const DecodeResult<Message> message = tryDecodeMessage(T::COMMAND_ID, bytes);
+        if (!message || !std::holds_alternative<T>(*message) || !(std::get<T>(*message) == value)) return "tryDecodeMessage != original";
+    }
+
+    // Every strict prefix is truncated
+    if (!bytes.empty()) {
+        const size_t cut = static_cast<size_t>(std::hash<size_t>{}(bytes.size() * 31 + bytes.front()) % bytes.size());
+        if (Traits::tryDecode(bytes.data(), cut)) return "tryDeserialize accepted a truncated encoding";
+    }
+
+    if constexpr (Traits::HAS_COMPACT) {
+        // A @compact row is at most twice its fixed size, so this always fits the length prefix
+        if (2 * bytes.size() + detail::MAX_VARINT_SIZE <= std::numeric_limits<uint16_t>::max()) {
+            const std::vector<uint8_t> compact = serializeCompact(value);
+            const DecodeResult<T> expanded = Traits::tryDecodeCompact(compact.data(), compact.size());
+            if (!expanded) return "tryDeserializeCompact rejected a valid encoding";
+            if (!(*expanded == value)) return "compact round trip != original";
+        }
+    }
+    return nullptr;
+}
+
+/// Invariants for arbitrary input bytes; returns the name of the first failed check, or nullptr
+template<typename T>
+const char* checkDecode(const uint8_t* data, size_t size) {
+    using Traits = CodecTraits<T>;
+    const DecodeResult<T> decoded = Traits::tryDecode(data, size);
+    if (const char* failure = checkDynamic<T>(data, size, decoded)) return failure;
+    if (decoded) {
+        // Accepted input re-encodes to a canonical form that decodes to the same value
+        const std::vector<uint8_t> bytes = serialize(*decoded);
+        const DecodeResult<T> again = Traits::tryDecode(bytes.data(), bytes.size());
+        if (!again) return "tryDeserialize rejected its own re-encoding";
+        if (serialize(*again) != bytes) return "re-encoding is not a fixpoint";
+        if (!matches(*again, *decoded)) return "re-decoded value differs";
+        if (!matches(Traits::decode(data, size), *decoded)) return "deserialize disagrees with tryDeserialize";
+        if constexpr (Traits::HAS_VIEW) {
+            if (!Traits::viewMatches(Traits::view(data, size), *decoded)) return "view disagrees with tryDeserialize";
+        }
+    }
+    if constexpr (Traits::HAS_COMPACT) {
+        const DecodeResult<T> expanded = Traits::tryDecodeCompact(data, size);
+        if (expanded && 2 * encodedSize(*expanded) + detail::MAX_VARINT_SIZE <= std::numeric_limits<uint16_t>::max()) {
+            const std::vector<uint8_t> compact = serializeCompact(*expanded);
+            const DecodeResult<T> again = Traits::tryDecodeCompact(compact.data(), compact.size());
+            if (!again) return "tryDeserializeCompact rejected its own re-encoding";
+            if (!matches(*again, *expanded)) return "compact re-decoded value differs";
+        }
+    }
+    return nullptr;
+}
+${frameHeader ? generateFrameCheck(frameHeader) : ''}
+} // namespace ${ns}::testing
+
+#endif // BINARY_PROTOCOL_TEST_CODEC_HPP`;
+}
+
+function generateFrameCheck(layout: FrameHeaderLayout): string {
+  return `
+/**
+ * FrameDecoder must yield the same frames however the stream is chunked.
+ * The first input byte seeds the chunk sizes.
+ */
+inline const char* checkFrames(const uint8_t* data, size_t size) {
+    if (size == 0) return nullptr;
+    const std::span<const uint8_t> stream(data + 1, size - 1);
+    const size_t maxPayload = 4096;
+
+    std::vector<std::vector<uint8_t>> whole;
+    FrameDecoder oneShot(maxPayload);
+    oneShot.feed(stream, [&](const Frame& frame) {
+        whole.emplace_back(frame.bytes.begin(), frame.bytes.end());
+        if (frame.payload.size() != frame.header.${layout.payloadLengthField.name}) return;
+        (void)tryDecodeMessage(frame.header.${layout.commandIdField.name}, frame.payload);${layout.checksum ? '\n        (void)verifyFrame(frame.bytes);' : ''}
+    });
+
+    std::vector<std::vector<uint8_t>> chunked;
+    FrameDecoder incremental(maxPayload);
+    Random chunks(data[0]);
+    for (size_t offset = 0; offset < stream.size();) {
+        const size_t take = std::min<size_t>(stream.size() - offset, 1 + chunks.below(32));
+        incremental.feed(stream.subspan(offset, take), [&](const Frame& frame) {
+            chunked.emplace_back(frame.bytes.begin(), frame.bytes.end());
+        });
+        offset += take;
+    }
+    if (whole != chunked) return "chunked FrameDecoder output differs";
+    return nullptr;
+}
+`;
+}
+
+/**
+ * モデルごとの CodecTraits 特殊化
+ */
+function generateCodecTraits(ir: SchemaIR, model: ModelDefinition, compact: boolean): string {
+  const name = model.name;
+  const lines: string[] = [];
+  lines.push('template<>');
+  lines.push(`struct CodecTraits<${name}> {`);
+  lines.push(`${INDENT}static constexpr const char* NAME = "${name}";`);
+  lines.push(`${INDENT}static constexpr bool HAS_COMMAND = ${model.commandId !== undefined};`);
+  lines.push(`${INDENT}static constexpr bool HAS_VIEW = ${model.hasVariableLength};`);
+  lines.push(`${INDENT}static constexpr bool HAS_COMPACT = ${compact};`);
+  lines.push('');
+  lines.push(`${INDENT}static ${name} decode(const uint8_t* data, size_t size) { return deserialize${name}(data, size); }`);
+  lines.push(`${INDENT}static DecodeResult<${name}> tryDecode(const uint8_t* data, size_t size) { return tryDeserialize${name}(data, size); }`);
+  if (model.hasVariableLength) {
+    lines.push(`${INDENT}static ${name}View view(const uint8_t* data, size_t size) { return view${name}(data, size); }`);
+    lines.push('');
+    lines.push(`${INDENT}static bool viewMatches(const ${name}View& view, const ${name}& value) {`);
+    const comparisons = model.fields
+      .filter(field => viewComparable(ir, field))
+      .map(field => `matches(view.${field.name}, value.${field.name})`);
+    lines.push(`${INDENT}${INDENT}return ${comparisons.length > 0 ? comparisons.join(`\n${INDENT}${INDENT}${INDENT}&& `) : 'true'};`);
+    lines.push(`${INDENT}}`);
+  }
+  if (compact) {
+    lines.push(`${INDENT}static DecodeResult<${name}> tryDecodeCompact(const uint8_t* data, size_t size) { return tryDeserializeCompact${name}(data, size); }`);
+  }
+  lines.push('');
+  lines.push(`${INDENT}static ${name} random([[maybe_unused]] Random& rng) {`);
+  lines.push(`${INDENT}${INDENT}${name} value{};`);
+  for (const field of model.fields) {
+    lines.push(...randomAssignments(ir, model, field).map(line => `${INDENT}${INDENT}${line}`));
+  }
+  lines.push(`${INDENT}${INDENT}return value;`);
+  lines.push(`${INDENT}}`);
+  const oversized = oversizedAssignments(ir, model);
+  if (oversized.length > 0) {
+    lines.push('');
+    lines.push(`${INDENT}/// A random value with one variable-length field one element past its length prefix`);
+    lines.push(`${INDENT}static ${name} oversized(Random& rng) {`);
+    lines.push(`${INDENT}${INDENT}${name} value = random(rng);`);
+    if (oversized.length === 1) {
+      lines.push(`${INDENT}${INDENT}${oversized[0]}`);
+    } else {
+      lines.push(`${INDENT}${INDENT}switch (rng.below(${oversized.length})) {`);
+      oversized.forEach((assignment, i) => {
+        lines.push(`${INDENT}${INDENT}${i === oversized.length - 1 ? 'default' : `case ${i}`}: ${assignment} break;`);
+      });
+      lines.push(`${INDENT}${INDENT}}`);
+    }
+    lines.push(`${INDENT}${INDENT}return value;`);
+    lines.push(`${INDENT}}`);
+  }
+  lines.push('};');
+  return lines.join('\n');
+}
+
+/**
+ * 長さプレフィックス付きフィールドを上限 + 1 要素にする代入文（フィールドごとに1つ）
+ */
+function oversizedAssignments(ir: SchemaIR, model: ModelDefinition): string[] {
+  // u32 プレフィックスを超えるには 4 GiB 必要なので対象外
+  return model.fields
+    .filter(field => field.size.lengthPrefixType && (PRIMITIVE_SIZES[field.size.lengthPrefixType] ?? 4) < 4)
+    .map(field => {
+      const prefixMax = 2 ** (8 * (PRIMITIVE_SIZES[field.size.lengthPrefixType!] ?? 1)) - 1;
+      const elementSize = field.type.kind === 'array' && field.type.elementType
+        ? elementWireSize(ir, field.type.elementType) ?? 1
+        : 1;
+      return `value.${field.name}.resize(${Math.floor(prefixMax / elementSize) + 1});`;
+    });
+}
+
+/**
+ * ビューのフィールドを所有型と比較できるか（固定長モデル以外の配列はバイト列ビューなので対象外）
+ */
+function viewComparable(ir: SchemaIR, field: FieldDefinition): boolean {
+  if (field.type.kind !== 'array') return true;
+  const element = findModel(ir, field.type.elementType?.name ?? '');
+  return element !== undefined && element.fixedSize !== undefined;
+}
+
+function randomAssignments(ir: SchemaIR, model: ModelDefinition, field: FieldDefinition): string[] {
+  const accessor = `value.${field.name}`;
+  const typeName = field.type.name;
+
+  if (field.size.lengthPrefixType) {
+    const prefixMax = 2 ** (8 * (PRIMITIVE_SIZES[field.size.lengthPrefixType] ?? 1)) - 1;
+    // tryDeserialize はバッチのエントリー枠を検証するので、正しく枠付けしたバイト列を作る
+    if (field.decorators.some(d => d.name === 'batch')) {
+      const endian = model.endian === 'big' ? 'Endian::Big' : 'Endian::Little';
+      return [`${accessor} = randomBatch<${endian}>(rng, ${prefixMax});`];
+    }
+    if (field.type.kind === 'array' && field.type.elementType) {
+      const element = field.type.elementType;
+      const maxCount = Math.floor(prefixMax / (elementWireSize(ir, element) ?? 1));
+      return [
+        `${accessor}.resize(rng.length(${maxCount}));`,
+        `for (auto& element : ${accessor}) element = ${randomScalar(ir, element.name)};`,
+      ];
+    }
+    return [`${accessor}.resize(rng.length(${prefixMax}));`, `rng.fill(${accessor});`];
+  }
+
+  if (typeName === 'string' || typeName === 'bytes') {
+    return [`rng.fill(${accessor});`];
+  }
+  return [`${accessor} = ${randomScalar(ir, typeName)};`];
+}
+
+function randomScalar(ir: SchemaIR, typeName: string): string {
+  if (findModel(ir, typeName)) return `CodecTraits<${typeName}>::random(rng)`;
+  const enumDef = ir.enums.find(e => e.name === typeName);
+  if (enumDef) {
+    return `rng.pick({${enumDef.members.map(m => `${typeName}::${m.name}`).join(', ')}})`;
+  }
+  switch (typeName) {
+    case 'bool':
+      return 'rng.boolean()';
+    case 'float32':
+      return 'rng.real<float>()';
+    case 'float64':
+      return 'rng.real<double>()';
+    default:
+      return `rng.integer<${typeName}_t>()`;
+  }
+}
+
+export function generateRoundTripHarness(ir: SchemaIR, ns: string, frameHeader?: FrameHeaderLayout): string {
+  const models = testedModels(ir);
+  const registrations = models.map(m => `    {"${m.name}", runModel<${m.name}>},`).join('\n');
+
+  return `/**
+ * Auto-generated randomized round-trip stress test
+ *
+ *     test_roundtrip [--iterations N] [--seed S] [--model NAME]
+ *
+ * For every model: N random instances through checkRoundTrip(), values with a
+ * field past its length prefix through checkOversized(), N / 4 mutated encodings
+ * through checkDecode(), then the serializeInto/tryDeserialize round trip timed
+ * over a batch of the instances. Both checks compare the dynamic codec against
+ * the generated one; "descriptor" feeds Schema::load() damaged descriptors.
+ * Exits non-zero on the first failure and prints the seed and bytes needed to
+ * reproduce it.
+ */
+
+#include "test_codec.hpp"
+
+#include <chrono>
+#include <cinttypes>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <optional>
+#include <stdexcept>
+#include <string_view>
+
+using namespace ${ns};
+using namespace ${ns}::testing;
+
+namespace {
+
+struct Options {
+    uint64_t iterations = 100000;
+    uint64_t seed = 1;
+    const char* model = nullptr;
+};
+
+void dump(std::span<const uint8_t> bytes) {
+    const size_t shown = std::min<size_t>(bytes.size(), 256);
+    for (size_t i = 0; i < shown; i++) {
+        std::fprintf(stderr, "%02x%s", bytes[i], (i + 1) % 32 == 0 ? "\\n" : " ");
+    }
+    std::fprintf(stderr, "%s(%zu bytes)\\n", shown % 32 == 0 ? "" : "\\n", bytes.size());
+}
+
+bool fail(const char* model, const char* check, const Options& options, uint64_t iteration, std::span<const uint8_t> bytes) {
+    std::fprintf(stderr, "FAIL %s: %s (seed %" PRIu64 ", iteration %" PRIu64 ")\\n", model, check, options.seed, iteration);
+    dump(bytes);
+    return false;
+}
+
+/// Flips, overwrites, truncates or extends a valid encoding
+void mutate(std::vector<uint8_t>& bytes, Random& rng) {
+    const uint64_t edits = 1 + rng.below(4);
+    for (uint64_t e = 0; e < edits; e++) {
+        switch (rng.below(4)) {
+        case 0:
+            if (!bytes.empty()) bytes[rng.below(bytes.size())] ^= static_cast<uint8_t>(1u << rng.below(8));
+            break;
+        case 1:
+            if (!bytes.empty()) bytes[rng.below(bytes.size())] = rng.integer<uint8_t>();
+            break;
+        case 2:
+            bytes.resize(rng.below(bytes.size() + 1));
+            break;
+        default:
+            bytes.push_back(rng.integer<uint8_t>());
+            break;
+        }
+    }
+}
+
+#if defined(__cpp_exceptions)
+/// Every encoder must reject a field longer than its length prefix before writing anything
+template<typename T>
+const char* checkOversized(const T& value) {
+    const auto rejects = [](auto&& encode) {
+        try {
+            encode();
+        } catch (const std::length_error&) {
+            return true;
+        }
+        return false;
+    };
+    std::vector<uint8_t> buffer(encodedSize(value));
+    if (!rejects([&] { serializeInto(value, buffer); })) {
+        return "serializeInto accepted a field longer than its length prefix";
+    }
+    BinaryWriter writer;
+    if (!rejects([&] { serialize(value, writer); }) || writer.size() != 0) {
+        return "serialize(writer) did not reject a field longer than its length prefix up front";
+    }
+    if constexpr (CodecTraits<T>::HAS_VIEW) {
+        GatherList gather;
+        if (!rejects([&] { serializeGather(value, gather); }) || gather.size() != 0) {
+            return "serializeGather did not reject a field longer than its length prefix up front";
+        }
+    }
+    return nullptr;
+}
+#endif
+
+template<typename T>
+bool runModel(const Options& options) {
+    const char* name = CodecTraits<T>::NAME;
+    Random rng(options.seed ^ std::hash<std::string_view>{}(name));
+    std::vector<uint8_t> scratch;
+
+    for (uint64_t i = 0; i < options.iterations; i++) {
+        const T value = CodecTraits<T>::random(rng);
+        if (const char* failure = checkRoundTrip(value, scratch)) {
+            return fail(name, failure, options, i, serialize(value));
+        }
+    }
+
+#if defined(__cpp_exceptions)
+    if constexpr (requires { CodecTraits<T>::oversized(rng); }) {
+        for (uint64_t i = 0; i < 8; i++) {
+            if (const char* failure = checkOversized(CodecTraits<T>::oversized(rng))) {
+                return fail(name, failure, options, i, {});
+            }
+        }
+    }
+#endif
+
+    for (uint64_t i = 0; i < options.iterations / 4; i++) {
+        std::vector<uint8_t> bytes = serialize(CodecTraits<T>::random(rng));
+        mutate(bytes, rng);
+        if (const char* failure = checkDecode<T>(bytes.data(), bytes.size())) {
+            return fail(name, failure, options, i, bytes);
+        }
+    }
+
+    // Throughput of the hot path alone, over a batch that fits in cache
+    std::vector<T> batch;
+    size_t batchBytes = 0;
+    for (size_t i = 0; i < 256; i++) {
+        batch.push_back(CodecTraits<T>::random(rng));
+        batchBytes += encodedSize(batch.back());
+    }
+    const uint64_t rounds = std::max<uint64_t>(1, options.iterations / batch.size());
+    scratch.resize(batchBytes);
+    uint64_t checksum = 0;
+    const auto start = std::chrono::steady_clock::now();
+    for (uint64_t round = 0; round < rounds; round++) {
+        size_t offset = 0;
+        for (const T& value : batch) {
+            const size_t size = serializeInto(value, std::span<uint8_t>(scratch).subspan(offset));
+            const DecodeResult<T> decoded = CodecTraits<T>::tryDecode(scratch.data() + offset, size);
+            checksum += decoded.has_value();
+            offset += size;
+        }
+    }
+    const double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    if (checksum != rounds * batch.size()) {
+        return fail(name, "tryDeserialize rejected a valid encoding while timing", options, 0, {});
+    }
+
+    const double messages = static_cast<double>(rounds * batch.size());
+    std::printf("%-24s %10.2f M round trips/s %10.1f MB/s\\n", name,
+        messages / seconds / 1e6, static_cast<double>(rounds * batchBytes) / seconds / 1e6);
+    return true;
+}
+${frameHeader ? `
+bool runFrames(const Options& options) {
+    Random rng(options.seed);
+    std::vector<uint8_t> stream;
+    for (uint64_t i = 0; i < options.iterations / 16; i++) {
+        stream.assign(1, rng.integer<uint8_t>());
+        const uint64_t frames = rng.below(8);
+        for (uint64_t f = 0; f < frames; f++) {
+            ${frameHeader.model.name} header = CodecTraits<${frameHeader.model.name}>::random(rng);
+            header.${frameHeader.magicField.name} = ${frameHeader.model.name}::MAGIC;
+            std::vector<uint8_t> payload(rng.length(512));
+            rng.fill(payload);
+            header.${frameHeader.payloadLengthField.name} = static_cast<decltype(header.${frameHeader.payloadLengthField.name})>(payload.size());
+            const std::vector<uint8_t> head = serialize(header);
+            stream.insert(stream.end(), head.begin(), head.end());
+            stream.insert(stream.end(), payload.begin(), payload.end());
+        }
+        if (rng.boolean()) mutate(stream, rng);
+        if (const char* failure = checkFrames(stream.data(), stream.size())) {
+            return fail("frames", failure, options, i, stream);
+        }
+    }
+    std::printf("%-24s ok\\n", "frames");
+    return true;
+}
+` : ''}
+#if defined(__cpp_exceptions)
+/// Schema::load() rejects malformed descriptors, and whatever damaged one it accepts decodes arbitrary bytes safely
+bool runDescriptor(const Options& options) {
+    Random rng(options.seed);
+    const std::span<const uint8_t> descriptor = dynamic::builtinSchemaDescriptor();
+    const auto rejects = [](std::span<const uint8_t> bytes) {
+        try {
+            (void)dynamic::Schema::load(bytes);
+        } catch (const std::runtime_error&) {
+            return true;
+        }
+        return false;
+    };
+
+    for (size_t size = 0; size < descriptor.size(); size++) {
+        if (!rejects(descriptor.first(size))) {
+            return fail("descriptor", "Schema::load accepted a truncated descriptor", options, size, descriptor.first(size));
+        }
+    }
+    std::vector<uint8_t> bytes(descriptor.begin(), descriptor.end());
+    bytes.push_back(0);
+    if (!rejects(bytes)) return fail("descriptor", "Schema::load accepted trailing bytes", options, 0, bytes);
+    // Magic and version
+    for (const size_t offset : {size_t{0}, size_t{4}}) {
+        bytes.assign(descriptor.begin(), descriptor.end());
+        bytes[offset] ^= 0xFF;
+        if (!rejects(bytes)) return fail("descriptor", "Schema::load accepted a bad magic or version", options, offset, bytes);
+    }
+
+    std::vector<uint8_t> input;
+    for (uint64_t i = 0; i < options.iterations / 16; i++) {
+        bytes.assign(descriptor.begin(), descriptor.end());
+        for (uint64_t edits = 1 + rng.below(3); edits > 0; edits--) {
+            bytes[rng.below(bytes.size())] = rng.integer<uint8_t>();
+        }
+        std::optional<dynamic::Schema> schema;
+        try {
+            schema.emplace(dynamic::Schema::load(bytes));
+        } catch (const std::runtime_error&) {
+            continue;
+        }
+        for (const auto& model : schema->models()) {
+            input.resize(rng.length(256));
+            rng.fill(input);
+            dynamic::Record record;
+            (void)model->decodeInto(input, record);
+        }
+    }
+    std::printf("%-24s ok\\n", "descriptor");
+    return true;
+}
+#endif
+
+struct ModelRun {
+    const char* name;
+    bool (*run)(const Options&);
+};
+
+constexpr ModelRun MODELS[] = {
+${registrations}${frameHeader ? '\n    {"frames", runFrames},' : ''}
+#if defined(__cpp_exceptions)
+    {"descriptor", runDescriptor},
+#endif
+};
+
+} // namespace
+
+int main(int argc, char** argv) {
+    Options options;
+    for (int i = 1; i < argc; i++) {
+        const std::string_view arg = argv[i];
+        if (arg == "--iterations" && i + 1 < argc) {
+            options.iterations = std::strtoull(argv[++i], nullptr, 10);
+        } else if (arg == "--seed" && i + 1 < argc) {
+            options.seed = std::strtoull(argv[++i], nullptr, 10);
+        } else if (arg == "--model" && i + 1 < argc) {
+            options.model = argv[++i];
+        } else {
+            std::fprintf(stderr, "usage: %s [--iterations N] [--seed S] [--model NAME]\\n", argv[0]);
+            return 2;
+        }
+    }
+
+    bool ok = true;
+    for (const ModelRun& model : MODELS) {
+        if (options.model && std::strcmp(options.model, model.name) != 0) continue;
+        ok = model.run(options) && ok;
+    }
+    return ok ? 0 : 1;
+}`;
+}
+
+export function generateFuzzTarget(ns: string, frameHeader?: FrameHeaderLayout): string {
+  return `/**
+ * Auto-generated libFuzzer target, built once per model:
+ *
+ *     clang++ -fsanitize=fuzzer,address,undefined -DBINARY_PROTOCOL_FUZZ_MODEL=SensorDataResponse ...
+ *
+ * (cmake -DBINARY_PROTOCOL_BUILD_FUZZERS=ON builds fuzz_<Model> for every model${frameHeader ? ' plus fuzz_frames' : ''}.)
+ */
+
+#include "test_codec.hpp"
+
+#include <cstdio>
+#include <cstdlib>
+
+#if !defined(BINARY_PROTOCOL_FUZZ_MODEL)${frameHeader ? ' && !defined(BINARY_PROTOCOL_FUZZ_FRAMES)' : ''}
+#error "Define BINARY_PROTOCOL_FUZZ_MODEL to the model to fuzz${frameHeader ? ' (or BINARY_PROTOCOL_FUZZ_FRAMES)' : ''}"
+#endif
+
+extern "C" int LLVMFuzzerTestOneInput(const uint8_t* data, size_t size) {
+    using namespace ${ns};
+#if ${frameHeader ? 'defined(BINARY_PROTOCOL_FUZZ_FRAMES)' : '0'}
+    const char* failure = testing::checkFrames(data, size);
+    const char* name = "frames";
+#else
+    const char* failure = testing::checkDecode<BINARY_PROTOCOL_FUZZ_MODEL>(data, size);
+    const char* name = testing::CodecTraits<BINARY_PROTOCOL_FUZZ_MODEL>::NAME;
+#endif
+    if (failure) {
+        std::fprintf(stderr, "%s: %s\\n", name, failure);
+        std::abort();
+    }
+    return 0;
+}`;
+}
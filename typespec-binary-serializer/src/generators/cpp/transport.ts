@@ -0,0 +1,1626 @@
+/**
+ * C++ 非同期トランスポート生成（C++20 コルーチン + epoll、Linux のみ）
+ * クライアントは sequence_id で応答を対応付けて複数要求をパイプライン化し、サーバーは COMMAND_ID でハンドラーに振り分ける
+ * 送信はイベントループの 1 周ごとに接続単位でまとめて書き込む
+ */
+
+import { SchemaIR } from '../../ir/types.js';
+import { FrameHeaderLayout } from './layout.js';
+import { findCommandPairs } from './correlation.js';
+
+export function generateTransportHeader(ir: SchemaIR, layout: FrameHeaderLayout, ns: string): string {
+  const header = layout.model.name;
+  const hasVersion = layout.model.fields.some(f => f.name === 'version');
+  const versionOption = hasVersion
+    ? `
+    /// ${header}::version of every request
+    uint8_t version = 1;`
+    : '';
+  const versionAssign = hasVersion ? `
+    header.version = options_.version;` : '';
+  const simulatorRoutes = findCommandPairs(ir)
+    .map(p => `        on<${p.command.name}>([](const ${p.command.name}&) { return ${p.response.name}{}; });`)
+    .join('\n');
+
+  return `/**
+ * Auto-generated asynchronous transport (C++20 coroutines over epoll, Linux only)
+ *
+ *     EventLoop loop;
+ *     Client client(loop, connectTcp("127.0.0.1", port));
+ *     CallResult<PingResponse> pong = loop.run(client.call(PingCommand{...}));
+ *
+ * Inside a coroutine: auto pong = co_await client.call(PingCommand{...});
+ */
+
+#ifndef BINARY_PROTOCOL_TRANSPORT_HPP
+#define BINARY_PROTOCOL_TRANSPORT_HPP
+
+#include "protocol.hpp"
+#include "correlation.hpp"
+#include "frame_decoder.hpp"
+
+#if __has_include(<sys/epoll.h>)
+#define BINARY_PROTOCOL_HAS_EPOLL 1
+#else
+#define BINARY_PROTOCOL_HAS_EPOLL 0
+#endif
+
+#if BINARY_PROTOCOL_HAS_EPOLL
+
+#include <array>
+#include <chrono>
+#include <coroutine>
+#include <cstdint>
+#include <exception>
+#include <functional>
+#include <memory>
+#include <optional>
+#include <span>
+#include <type_traits>
+#include <utility>
+#include <variant>
+#include <vector>
+
+namespace ${ns} {
+
+// ============================================
+// Coroutines
+// ============================================
+
+template<typename T = void>
+class Task;
+
+namespace detail {
+
+struct TaskPromiseBase {
+    std::coroutine_handle<> continuation;
+#if BINARY_PROTOCOL_EXCEPTIONS
+    std::exception_ptr exception;
+#endif
+
+    std::suspend_always initial_suspend() noexcept { return {}; }
+
+    /// Resumes whoever awaited the task
+    struct FinalAwaiter {
+        bool await_ready() noexcept { return false; }
+        template<typename Promise>
+        std::coroutine_handle<> await_suspend(std::coroutine_handle<Promise> handle) noexcept {
+            std::coroutine_handle<> continuation = handle.promise().continuation;
+            return continuation ? continuation : std::noop_coroutine();
+        }
+        void await_resume() noexcept {}
+    };
+
+    FinalAwaiter final_suspend() noexcept { return {}; }
+
+    void unhandled_exception() {
+#if BINARY_PROTOCOL_EXCEPTIONS
+        exception = std::current_exception();
+#else
+        std::terminate();
+#endif
+    }
+
+    void rethrow() {
+#if BINARY_PROTOCOL_EXCEPTIONS
+        if (exception) std::rethrow_exception(exception);
+#endif
+    }
+};
+
+template<typename T>
+struct TaskPromise : TaskPromiseBase {
+    std::optional<T> value;
+
+    Task<T> get_return_object();
+    template<typename U>
+    void return_value(U&& result) { value.emplace(std::forward<U>(result)); }
+    T take() {
+        rethrow();
+        return std::move(*value);
+    }
+};
+
+template<>
+struct TaskPromise<void> : TaskPromiseBase {
+    Task<void> get_return_object();
+    void return_void() {}
+    void take() { rethrow(); }
+};
+
+} // namespace detail
+
+/**
+ * Lazily started coroutine; it runs when awaited and resumes the awaiter when done.
+ * Coroutine parameters are copied into the frame, so pass arguments by value.
+ */
+template<typename T>
+class [[nodiscard]] Task {
+public:
+    using promise_type = detail::TaskPromise<T>;
+
+    Task(Task&& other) noexcept : handle_(std::exchange(other.handle_, {})) {}
+    Task& operator=(Task other) noexcept {
+        std::swap(handle_, other.handle_);
+        return *this;
+    }
+    ~Task() {
+        if (handle_) handle_.destroy();
+    }
+
+    bool await_ready() const noexcept { return false; }
+    std::coroutine_handle<> await_suspend(std::coroutine_handle<> awaiter) noexcept {
+        handle_.promise().continuation = awaiter;
+        return handle_;
+    }
+    T await_resume() { return handle_.promise().take(); }
+
+private:
+    friend promise_type;
+    explicit Task(std::coroutine_handle<promise_type> handle) : handle_(handle) {}
+
+    std::coroutine_handle<promise_type> handle_;
+};
+
+namespace detail {
+
+template<typename T>
+Task<T> TaskPromise<T>::get_return_object() {
+    return Task<T>(std::coroutine_handle<TaskPromise<T>>::from_promise(*this));
+}
+
+inline Task<void> TaskPromise<void>::get_return_object() {
+    return Task<void>(std::coroutine_handle<TaskPromise<void>>::from_promise(*this));
+}
+
+/// Eagerly started, self-destroying coroutine behind spawn()
+struct DetachedTask {
+    struct promise_type {
+        DetachedTask get_return_object() noexcept { return {}; }
+        std::suspend_never initial_suspend() noexcept { return {}; }
+        std::suspend_never final_suspend() noexcept { return {}; }
+        void return_void() noexcept {}
+        void unhandled_exception() noexcept { std::terminate(); }
+    };
+};
+
+inline DetachedTask runDetached(Task<void> task) {
+    co_await std::move(task);
+}
+
+} // namespace detail
+
+/// Starts task now without awaiting it; an exception escaping it terminates
+inline void spawn(Task<void> task) {
+    detail::runDetached(std::move(task));
+}
+
+// ============================================
+// Event loop
+// ============================================
+
+class EventLoop;
+
+namespace detail {
+
+/// A file descriptor registered with an EventLoop
+class IoHandler {
+public:
+    virtual void onIo(uint32_t events) = 0;
+
+protected:
+    ~IoHandler() = default;
+};
+
+/// Called every loop iteration while ticking() is true, and at least once per tick
+class Ticker {
+public:
+    virtual bool ticking() const = 0;
+    virtual void onTick(std::chrono::steady_clock::time_point now) = 0;
+
+protected:
+    ~Ticker() = default;
+};
+
+/// Deferred write of a connection, run once per loop iteration
+class Flusher {
+public:
+    virtual void flush() = 0;
+
+protected:
+    ~Flusher() = default;
+};
+
+} // namespace detail
+
+/**
+ * Single-threaded epoll loop. Each iteration waits for I/O (no longer than a
+ * tick while a Ticker is active), runs the tickers, resumes scheduled
+ * coroutines and then flushes every connection that queued frames during the
+ * iteration with one write each.
+ */
+class EventLoop {
+public:
+    using Clock = std::chrono::steady_clock;
+
+    explicit EventLoop(Clock::duration tick = std::chrono::milliseconds(1));
+    ~EventLoop();
+
+    EventLoop(const EventLoop&) = delete;
+    EventLoop& operator=(const EventLoop&) = delete;
+
+    /// Runs until stop()
+    void run();
+
+    /// Runs until task completes and returns its result
+    template<typename T>
+    T run(Task<T> task);
+
+    /// Runs a single iteration, blocking until there is work
+    void runOnce() { iterate(); }
+
+    void stop() { stopping_ = true; }
+
+    /// Resumes handle on the next iteration
+    void schedule(std::coroutine_handle<> handle) { ready_.push_back(handle); }
+
+    /// Keeps object alive until the current iteration ends (for handlers that close themselves)
+    void release(std::shared_ptr<void> object) { released_.push_back(std::move(object)); }
+
+    void watch(int fd, uint32_t events, detail::IoHandler* handler);
+    void modify(int fd, uint32_t events, detail::IoHandler* handler);
+    void unwatch(int fd, detail::IoHandler* handler);
+
+    void addTicker(detail::Ticker* ticker);
+    void removeTicker(detail::Ticker* ticker);
+
+    void requestFlush(detail::Flusher* flusher) { flushes_.push_back(flusher); }
+    void cancelFlush(detail::Flusher* flusher);
+
+private:
+    void iterate();
+
+    static constexpr size_t MAX_EVENTS = 64;
+
+    int epoll_ = -1;
+    Clock::duration tick_;
+    bool stopping_ = false;
+    std::vector<std::coroutine_handle<>> ready_;
+    std::vector<std::coroutine_handle<>> running_;
+    std::vector<detail::Flusher*> flushes_;
+    std::vector<detail::Ticker*> tickers_;
+    std::vector<std::shared_ptr<void>> released_;
+    /// Handlers of the batch being dispatched, cleared by unwatch()
+    std::array<detail::IoHandler*, MAX_EVENTS> dispatching_{};
+    std::array<uint32_t, MAX_EVENTS> dispatchingEvents_{};
+    size_t dispatchingCount_ = 0;
+};
+
+namespace detail {
+
+template<typename T>
+struct RunState {
+    std::optional<std::conditional_t<std::is_void_v<T>, std::monostate, T>> result;
+#if BINARY_PROTOCOL_EXCEPTIONS
+    std::exception_ptr exception;
+#endif
+    bool done = false;
+};
+
+/// Owns the state so a task abandoned by stop() can still finish safely
+template<typename T>
+Task<void> runInto(std::shared_ptr<RunState<T>> state, Task<T> task) {
+#if BINARY_PROTOCOL_EXCEPTIONS
+    try {
+#endif
+        if constexpr (std::is_void_v<T>) {
+            co_await std::move(task);
+            state->result.emplace();
+        } else {
+            state->result.emplace(co_await std::move(task));
+        }
+#if BINARY_PROTOCOL_EXCEPTIONS
+    } catch (...) {
+        state->exception = std::current_exception();
+    }
+#endif
+    state->done = true;
+}
+
+} // namespace detail
+
+template<typename T>
+T EventLoop::run(Task<T> task) {
+    auto state = std::make_shared<detail::RunState<T>>();
+    spawn(detail::runInto(state, std::move(task)));
+    stopping_ = false;
+    while (!state->done && !stopping_) {
+        iterate();
+    }
+#if BINARY_PROTOCOL_EXCEPTIONS
+    if (state->exception) std::rethrow_exception(state->exception);
+#endif
+    if (!state->done) BINARY_PROTOCOL_THROW(std::runtime_error("EventLoop stopped before the task completed"));
+    if constexpr (!std::is_void_v<T>) return std::move(*state->result);
+}
+
+// ============================================
+// Connections
+// ============================================
+
+struct TransportStats {
+    uint64_t framesIn = 0;
+    uint64_t framesOut = 0;
+    /// send() calls; fewer than framesOut when frames were batched
+    uint64_t writes = 0;
+    /// Frames dropped because their checksum did not verify
+    uint64_t corruptFrames = 0;
+    /// Frames that could not be decoded, or had no route or pending call
+    uint64_t droppedFrames = 0;
+};
+
+/**
+ * Non-blocking socket carrying ${header}-framed messages. Outgoing frames are
+ * appended to one buffer and written once per loop iteration; incoming bytes
+ * are reassembled by a FrameDecoder and handed to onFrame().
+ */
+class Connection : private detail::IoHandler, private detail::Flusher {
+public:
+    /// Takes ownership of a connected socket and makes it non-blocking
+    Connection(EventLoop& loop, int fd, size_t maxPayload = FrameDecoder::DEFAULT_MAX_PAYLOAD);
+    virtual ~Connection();
+
+    Connection(const Connection&) = delete;
+    Connection& operator=(const Connection&) = delete;
+
+    /// Queues a frame; magic, command_id, payload_length${layout.checksum ? ' and checksum' : ''} are filled in
+    template<typename T>
+    void send(${header} header, const T& message);
+
+    void close();
+    bool closed() const { return fd_ < 0; }
+    int fd() const { return fd_; }
+    EventLoop& loop() { return loop_; }
+    const TransportStats& stats() const { return stats_; }
+
+protected:
+    virtual void onFrame(const Frame& frame) = 0;
+    virtual void onClosed() {}
+
+    TransportStats stats_;
+
+private:
+    void onIo(uint32_t events) override;
+    void flush() override;
+    void requestFlush();
+
+    EventLoop& loop_;
+    int fd_;
+    FrameDecoder decoder_;
+    std::vector<uint8_t> readBuffer_;
+    std::vector<uint8_t> outbox_;
+    size_t written_ = 0;
+    bool flushRequested_ = false;
+    bool waitingWritable_ = false;
+};
+
+template<typename T>
+void Connection::send(${header} header, const T& message) {
+    if (closed()) return;
+    checkLengthPrefixes(message);
+    const size_t payloadSize = encodedSize(message);
+    const size_t start = outbox_.size();
+    outbox_.resize(start + ${header}::ENCODED_SIZE + payloadSize);
+    const std::span<uint8_t> frame(outbox_.data() + start, ${header}::ENCODED_SIZE + payloadSize);
+
+    header.${layout.magicField.name} = ${header}::MAGIC;
+    header.${layout.commandIdField.name} = MessageTraits<T>::COMMAND_ID;
+    header.${layout.payloadLengthField.name} = static_cast<decltype(header.${layout.payloadLengthField.name})>(payloadSize);
+    serializeInto(header, frame.first(${header}::ENCODED_SIZE));
+    serializeInto(message, frame.subspan(${header}::ENCODED_SIZE));${layout.checksum ? `
+    sealFrame(frame);` : ''}
+    stats_.framesOut++;
+    requestFlush();
+}
+
+// ============================================
+// Client
+// ============================================
+
+enum class CallError : uint8_t {
+    /// No response within the call's timeout
+    Timeout,
+    /// The connection closed before the response arrived
+    Disconnected,
+    /// The response payload did not decode
+    BadResponse,
+    /// ClientOptions::maxInFlight calls are already pending
+    TooManyInFlight,
+};
+
+constexpr const char* toString(CallError error) {
+    switch (error) {
+    case CallError::Timeout: return "Call timed out";
+    case CallError::Disconnected: return "Connection closed";
+    case CallError::BadResponse: return "Malformed response";
+    case CallError::TooManyInFlight: return "Too many calls in flight";
+    }
+    return "Unknown call error";
+}
+
+/// Response or CallError, with the same interface as DecodeResult
+template<typename T>
+class CallResult {
+public:
+    CallResult(T value) : storage_(std::in_place_index<0>, std::move(value)) {}
+    CallResult(CallError error) : storage_(std::in_place_index<1>, error) {}
+
+    bool has_value() const noexcept { return storage_.index() == 0; }
+    explicit operator bool() const noexcept { return has_value(); }
+
+    /// Checked access; throws (or aborts without exceptions) on an error
+    T& value() & { check(); return *std::get_if<0>(&storage_); }
+    const T& value() const& { check(); return *std::get_if<0>(&storage_); }
+    T&& value() && { check(); return std::move(*std::get_if<0>(&storage_)); }
+
+    T& operator*() & noexcept { return *std::get_if<0>(&storage_); }
+    const T& operator*() const& noexcept { return *std::get_if<0>(&storage_); }
+    T* operator->() noexcept { return std::get_if<0>(&storage_); }
+    const T* operator->() const noexcept { return std::get_if<0>(&storage_); }
+
+    CallError error() const noexcept { return *std::get_if<1>(&storage_); }
+
+private:
+    void check() const {
+        if (!has_value()) BINARY_PROTOCOL_THROW(std::runtime_error(toString(error())));
+    }
+
+    std::variant<T, CallError> storage_;
+};
+
+struct ClientOptions {
+    /// Most calls pending at once
+    size_t maxInFlight = 65536;
+    /// Timeout of calls that do not pass their own
+    std::chrono::steady_clock::duration timeout = std::chrono::seconds(5);
+    size_t maxPayload = FrameDecoder::DEFAULT_MAX_PAYLOAD;${versionOption}
+};
+
+namespace detail {
+
+/// A suspended call; the response is decoded straight from the receive buffer
+struct PendingCallBase {
+    std::coroutine_handle<> handle;
+    bool done = false;
+    std::optional<CallError> error;
+    void (*deliver)(PendingCallBase&, std::span<const uint8_t>) = nullptr;
+
+    PendingCallBase() = default;
+    PendingCallBase(const PendingCallBase&) = delete;
+    PendingCallBase& operator=(const PendingCallBase&) = delete;
+
+    struct Awaiter {
+        PendingCallBase& call;
+
+        bool await_ready() const noexcept { return call.done; }
+        void await_suspend(std::coroutine_handle<> awaiter) noexcept { call.handle = awaiter; }
+        void await_resume() const noexcept {}
+    };
+
+    /// Suspends until the Client completes this call
+    Awaiter wait() noexcept { return {*this}; }
+};
+
+template<typename Response>
+struct PendingCall : PendingCallBase {
+    std::optional<Response> response;
+
+    PendingCall() {
+        deliver = [](PendingCallBase& base, std::span<const uint8_t> payload) {
+            PendingCall& self = static_cast<PendingCall&>(base);
+            DecodeResult<Response> decoded = MessageTraits<Response>::tryDecode(payload.data(), payload.size());
+            if (decoded) {
+                self.response.emplace(std::move(*decoded));
+            } else {
+                self.error = CallError::BadResponse;
+            }
+        };
+    }
+};
+
+} // namespace detail
+
+/**
+ * Client side of a connection. Any number of call()s may be outstanding;
+ * responses are matched by sequence_id in any order. The client must outlive
+ * its calls' coroutines only until they are resumed: destroying it fails the
+ * pending ones with CallError::Disconnected.
+ */
+class Client : public Connection, private detail::Ticker {
+public:
+    Client(EventLoop& loop, int fd, ClientOptions options = {});
+    ~Client() override;
+
+    /// Sends command and completes with its response
+    template<typename Command>
+    Task<CallResult<typename ResponseOf<Command>::type>> call(Command command, std::optional<std::chrono::steady_clock::duration> timeout = std::nullopt);
+
+    size_t inFlight() const { return pending_.size(); }
+    const CorrelatorStats& correlation() const { return pending_.stats(); }
+
+protected:
+    void onFrame(const Frame& frame) override;
+    void onClosed() override;
+
+private:
+    bool ticking() const override { return pending_.size() > 0; }
+    void onTick(std::chrono::steady_clock::time_point now) override;
+    SequenceId nextSequence();
+    void complete(detail::PendingCallBase* call, std::optional<CallError> error);
+
+    ClientOptions options_;
+    Correlator<detail::PendingCallBase*> pending_;
+    SequenceId sequence_ = 0;
+};
+
+template<typename Command>
+Task<CallResult<typename ResponseOf<Command>::type>> Client::call(Command command, std::optional<std::chrono::steady_clock::duration> timeout) {
+    using Response = typename ResponseOf<Command>::type;
+    if (closed()) co_return CallError::Disconnected;
+
+    detail::PendingCall<Response> pending;
+    ${header} header{};${versionAssign}
+    header.${layout.commandIdField.name} = Command::COMMAND_ID;
+    header.sequence_id = nextSequence();
+    if (pending_.track(header, timeout.value_or(options_.timeout), &pending) != TrackResult::Tracked) {
+        co_return CallError::TooManyInFlight;
+    }
+    send(header, command);
+
+    // Resumed by onFrame(), onTick() or onClosed(); this frame must not touch the client afterwards
+    co_await pending.wait();
+    if (pending.error) co_return *pending.error;
+    co_return std::move(*pending.response);
+}
+
+// ============================================
+// Server
+// ============================================
+
+/**
+ * Serves connections by routing each command to the handler registered for
+ * its COMMAND_ID. Handlers take the command and return its response, either
+ * directly or as a Task; the response goes back with the request's
+ * sequence_id. Handlers of one connection run concurrently when they suspend.
+ */
+class Server : private detail::IoHandler {
+public:
+    explicit Server(EventLoop& loop, size_t maxPayload = FrameDecoder::DEFAULT_MAX_PAYLOAD);
+    ~Server();
+
+    Server(const Server&) = delete;
+    Server& operator=(const Server&) = delete;
+
+    /// Registers handler(const Command&) -> Response or Task<Response>, replacing any previous one
+    template<typename Command, typename Handler>
+    void on(Handler handler);
+
+    /// Serves an already connected socket (accepted TCP connection, socketpair end)
+    void serve(int fd);
+
+    /// Accepts and serves connections from a listening socket until the server is destroyed
+    void listen(int listenFd);
+
+    size_t connections() const { return connections_.size(); }
+    /// Totals over all current and closed connections
+    TransportStats stats() const;
+
+private:
+    class ServerConnection;
+    using Route = std::function<void(const std::shared_ptr<ServerConnection>&, const ${header}&, std::span<const uint8_t>)>;
+
+    template<typename Command, typename Handler>
+    static Task<void> respond(std::shared_ptr<ServerConnection> connection, ${header} header, Command command, std::shared_ptr<Handler> handler);
+
+    void onIo(uint32_t events) override;
+    void route(const std::shared_ptr<ServerConnection>& connection, const Frame& frame);
+    void remove(ServerConnection* connection);
+
+    EventLoop& loop_;
+    size_t maxPayload_;
+    int listenFd_ = -1;
+    std::array<Route, 256> routes_;
+    std::vector<std::shared_ptr<ServerConnection>> connections_;
+    TransportStats closedStats_;
+};
+
+class Server::ServerConnection : public Connection, public std::enable_shared_from_this<ServerConnection> {
+public:
+    ServerConnection(Server& server, int fd)
+        : Connection(server.loop_, fd, server.maxPayload_), server_(&server) {}
+
+    void detach() { server_ = nullptr; }
+    void countDropped() { stats_.droppedFrames++; }
+
+protected:
+    void onFrame(const Frame& frame) override {
+        if (server_) server_->route(shared_from_this(), frame);
+    }
+    void onClosed() override {
+        if (server_) server_->remove(this);
+    }
+
+private:
+    Server* server_;
+};
+
+template<typename Command, typename Handler>
+void Server::on(Handler handler) {
+    auto shared = std::make_shared<Handler>(std::move(handler));
+    routes_[Command::COMMAND_ID] = [shared](const std::shared_ptr<ServerConnection>& connection, const ${header}& header, std::span<const uint8_t> payload) {
+        DecodeResult<Command> command = MessageTraits<Command>::tryDecode(payload.data(), payload.size());
+        if (!command) {
+            connection->countDropped();
+            return;
+        }
+        spawn(respond<Command, Handler>(connection, header, std::move(*command), shared));
+    };
+}
+
+template<typename Command, typename Handler>
+Task<void> Server::respond(std::shared_ptr<ServerConnection> connection, ${header} header, Command command, std::shared_ptr<Handler> handler) {
+    using Response = typename ResponseOf<Command>::type;
+    using Result = std::invoke_result_t<Handler&, const Command&>;
+    if constexpr (std::is_same_v<std::remove_cvref_t<Result>, Response>) {
+        connection->send(header, (*handler)(command));
+    } else {
+        Response response = co_await (*handler)(command);
+        connection->send(header, response);
+    }
+    co_return;
+}
+
+/**
+ * Server that answers every command with a default-constructed response, for
+ * exercising clients over loopback or a socketpair. Override individual
+ * commands with on<Command>().
+ */
+class DeviceSimulator : public Server {
+public:
+    explicit DeviceSimulator(EventLoop& loop) : Server(loop) {
+${simulatorRoutes}
+    }
+};
+
+// ============================================
+// Sockets
+// ============================================
+
+/// Listening TCP socket on address:port (port 0 picks a free one; see localPort())
+int listenTcp(uint16_t port, const char* address = "127.0.0.1");
+
+/// Connected TCP socket with TCP_NODELAY set
+int connectTcp(const char* address, uint16_t port);
+
+uint16_t localPort(int fd);
+
+} // namespace ${ns}
+
+#endif // BINARY_PROTOCOL_HAS_EPOLL
+
+#endif // BINARY_PROTOCOL_TRANSPORT_HPP`;
+}
+
+export function generateTransportImpl(layout: FrameHeaderLayout, ns: string): string {
+  const header = layout.model.name;
+  const verify = layout.checksum
+    ? `
+            if (!verifyFrame(frame.bytes)) {
+                stats_.corruptFrames++;
+                return;
+            }`
+    : '';
+
+  return `/**
+ * Auto-generated asynchronous transport implementation
+ */
+
+#include "transport.hpp"
+
+#if BINARY_PROTOCOL_HAS_EPOLL
+
+#include <algorithm>
+#include <cerrno>
+#include <system_error>
+
+#include <arpa/inet.h>
+#include <fcntl.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <sys/epoll.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+namespace ${ns} {
+
+namespace {
+
+constexpr size_t READ_CHUNK = 64 * 1024;
+
+[[noreturn]] void throwErrno(const char* what) {
+    BINARY_PROTOCOL_THROW(std::system_error(errno, std::generic_category(), what));
+}
+
+void setNonBlocking(int fd) {
+    const int flags = ::fcntl(fd, F_GETFL, 0);
+    if (flags < 0 || ::fcntl(fd, F_SETFL, flags | O_NONBLOCK) < 0) throwErrno("fcntl(O_NONBLOCK)");
+}
+
+} // namespace
+
+// ============================================
+// EventLoop
+// ============================================
+
+EventLoop::EventLoop(Clock::duration tick) : tick_(tick) {
+    epoll_ = ::epoll_create1(EPOLL_CLOEXEC);
+    if (epoll_ < 0) throwErrno("epoll_create1");
+}
+
+EventLoop::~EventLoop() {
+    ::close(epoll_);
+}
+
+void EventLoop::run() {
+    stopping_ = false;
+    while (!stopping_) {
+        iterate();
+    }
+}
+
+void EventLoop::iterate() {
+    // Only block when nothing is runnable or waiting to be written
+    int timeout = -1;
+    if (!ready_.empty() || !flushes_.empty() || stopping_) {
+        timeout = 0;
+    } else if (std::any_of(tickers_.begin(), tickers_.end(), [](const detail::Ticker* t) { return t->ticking(); })) {
+        timeout = static_cast<int>(std::max<int64_t>(1, std::chrono::ceil<std::chrono::milliseconds>(tick_).count()));
+    }
+
+    std::array<epoll_event, MAX_EVENTS> events;
+    const int count = ::epoll_wait(epoll_, events.data(), static_cast<int>(events.size()), timeout);
+    if (count < 0 && errno != EINTR) throwErrno("epoll_wait");
+
+    dispatchingCount_ = static_cast<size_t>(std::max(count, 0));
+    for (size_t i = 0; i < dispatchingCount_; i++) {
+        dispatching_[i] = static_cast<detail::IoHandler*>(events[i].data.ptr);
+        dispatchingEvents_[i] = events[i].events;
+    }
+    for (size_t i = 0; i < dispatchingCount_; i++) {
+        if (dispatching_[i]) dispatching_[i]->onIo(dispatchingEvents_[i]);
+    }
+    dispatchingCount_ = 0;
+
+    const Clock::time_point now = Clock::now();
+    for (size_t i = 0; i < tickers_.size(); i++) {
+        if (tickers_[i]->ticking()) tickers_[i]->onTick(now);
+    }
+
+    // Coroutines scheduled while these run wait for the next iteration
+    running_.swap(ready_);
+    for (std::coroutine_handle<> handle : running_) {
+        handle.resume();
+    }
+    running_.clear();
+
+    // One write per connection for everything queued in this iteration
+    for (size_t i = 0; i < flushes_.size(); i++) {
+        if (flushes_[i]) flushes_[i]->flush();
+    }
+    flushes_.clear();
+    released_.clear();
+}
+
+void EventLoop::watch(int fd, uint32_t events, detail::IoHandler* handler) {
+    epoll_event event{};
+    event.events = events;
+    event.data.ptr = handler;
+    if (::epoll_ctl(epoll_, EPOLL_CTL_ADD, fd, &event) < 0) throwErrno("epoll_ctl(ADD)");
+}
+
+void EventLoop::modify(int fd, uint32_t events, detail::IoHandler* handler) {
+    epoll_event event{};
+    event.events = events;
+    event.data.ptr = handler;
+    if (::epoll_ctl(epoll_, EPOLL_CTL_MOD, fd, &event) < 0) throwErrno("epoll_ctl(MOD)");
+}
+
+void EventLoop::unwatch(int fd, detail::IoHandler* handler) {
+    ::epoll_ctl(epoll_, EPOLL_CTL_DEL, fd, nullptr);
+    // Events already returned for this handler must not reach it
+    for (size_t i = 0; i < dispatchingCount_; i++) {
+        if (dispatching_[i] == handler) dispatching_[i] = nullptr;
+    }
+}
+
+void EventLoop::addTicker(detail::Ticker* ticker) {
+    tickers_.push_back(ticker);
+}
+
+void EventLoop::removeTicker(detail::Ticker* ticker) {
+    tickers_.erase(std::remove(tickers_.begin(), tickers_.end(), ticker), tickers_.end());
+}
+
+void EventLoop::cancelFlush(detail::Flusher* flusher) {
+    std::replace(flushes_.begin(), flushes_.end(), flusher, static_cast<detail::Flusher*>(nullptr));
+}
+
+// ============================================
+// Connection
+// ============================================
+
+Connection::Connection(EventLoop& loop, int fd, size_t maxPayload)
+    : loop_(loop), fd_(fd), decoder_(maxPayload), readBuffer_(READ_CHUNK) {
+    setNonBlocking(fd_);
+    loop_.watch(fd_, EPOLLIN | EPOLLRDHUP, this);
+}
+
+Connection::~Connection() {
+    if (fd_ >= 0) {
+        loop_.unwatch(fd_, this);
+        ::close(fd_);
+    }
+    loop_.cancelFlush(this);
+}
+
+void Connection::close() {
+    if (fd_ < 0) return;
+    loop_.unwatch(fd_, this);
+    ::close(fd_);
+    fd_ = -1;
+    outbox_.clear();
+    written_ = 0;
+    onClosed();
+}
+
+void Connection::requestFlush() {
+    if (flushRequested_ || waitingWritable_) return;
+    flushRequested_ = true;
+    loop_.requestFlush(this);
+}
+
+void Connection::flush() {
+    flushRequested_ = false;
+    while (fd_ >= 0 && written_ < outbox_.size()) {
+        const ssize_t sent = ::send(fd_, outbox_.data() + written_, outbox_.size() - written_, MSG_NOSIGNAL);
+        if (sent < 0) {
+            if (errno == EINTR) continue;
+            if (errno == EAGAIN || errno == EWOULDBLOCK) {
+                // Finish once the socket drains; frames queued meanwhile join this write
+                if (!waitingWritable_) {
+                    waitingWritable_ = true;
+                    loop_.modify(fd_, EPOLLIN | EPOLLRDHUP | EPOLLOUT, this);
+                }
+                return;
+            }
+            close();
+            return;
+        }
+        stats_.writes++;
+        written_ += static_cast<size_t>(sent);
+    }
+    outbox_.clear();
+    written_ = 0;
+    if (waitingWritable_ && fd_ >= 0) {
+        waitingWritable_ = false;
+        loop_.modify(fd_, EPOLLIN | EPOLLRDHUP, this);
+    }
+}
+
+void Connection::onIo(uint32_t events) {
+    if (events & EPOLLOUT) {
+        flush();
+    }
+    if (!(events & (EPOLLIN | EPOLLRDHUP | EPOLLHUP | EPOLLERR))) return;
+
+    while (fd_ >= 0) {
+        const ssize_t received = ::recv(fd_, readBuffer_.data(), readBuffer_.size(), 0);
+        if (received < 0) {
+            if (errno == EINTR) continue;
+            if (errno != EAGAIN && errno != EWOULDBLOCK) close();
+            return;
+        }
+        if (received == 0) {
+            close();
+            return;
+        }
+        decoder_.feed({readBuffer_.data(), static_cast<size_t>(received)}, [this](const Frame& frame) {
+            if (fd_ < 0) return;
+            stats_.framesIn++;${verify}
+            onFrame(frame);
+        });
+        if (static_cast<size_t>(received) < readBuffer_.size()) return;
+    }
+}
+
+// ============================================
+// Client
+// ============================================
+
+Client::Client(EventLoop& loop, int fd, ClientOptions options)
+    : Connection(loop, fd, options.maxPayload), options_(options), pending_(options.maxInFlight) {
+    loop.addTicker(this);
+}
+
+Client::~Client() {
+    loop().removeTicker(this);
+    onClosed();
+}
+
+SequenceId Client::nextSequence() {
+    // Skip IDs still in flight after a wrap-around
+    do {
+        sequence_++;
+    } while (pending_.contains(sequence_));
+    return sequence_;
+}
+
+void Client::complete(detail::PendingCallBase* call, std::optional<CallError> error) {
+    if (error) call->error = error;
+    call->done = true;
+    if (call->handle) loop().schedule(call->handle);
+}
+
+void Client::onFrame(const Frame& frame) {
+    std::optional<detail::PendingCallBase*> call = pending_.match(frame.header);
+    if (!call) {
+        stats_.droppedFrames++;
+        return;
+    }
+    (*call)->deliver(**call, frame.payload);
+    complete(*call, std::nullopt);
+}
+
+void Client::onTick(std::chrono::steady_clock::time_point now) {
+    pending_.expire(now, [this](ExpiredRequest<detail::PendingCallBase*>&& request) {
+        complete(request.context, CallError::Timeout);
+    });
+}
+
+void Client::onClosed() {
+    pending_.cancelAll([this](SequenceId, uint8_t, detail::PendingCallBase* call) {
+        complete(call, CallError::Disconnected);
+    });
+}
+
+// ============================================
+// Server
+// ============================================
+
+Server::Server(EventLoop& loop, size_t maxPayload)
+    : loop_(loop), maxPayload_(maxPayload) {}
+
+Server::~Server() {
+    if (listenFd_ >= 0) {
+        loop_.unwatch(listenFd_, this);
+        ::close(listenFd_);
+    }
+    // Handlers still running keep their connection alive but can no longer reach the server
+    for (const std::shared_ptr<ServerConnection>& connection : connections_) {
+        connection->detach();
+        connection->close();
+    }
+}
+
+void Server::serve(int fd) {
+    connections_.push_back(std::make_shared<ServerConnection>(*this, fd));
+}
+
+void Server::listen(int listenFd) {
+    setNonBlocking(listenFd);
+    listenFd_ = listenFd;
+    loop_.watch(listenFd_, EPOLLIN, this);
+}
+
+void Server::onIo(uint32_t) {
+    while (true) {
+        const int fd = ::accept4(listenFd_, nullptr, nullptr, SOCK_CLOEXEC);
+        if (fd < 0) {
+            if (errno == EINTR || errno == ECONNABORTED) continue;
+            return;
+        }
+        const int noDelay = 1;
+        ::setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &noDelay, sizeof(noDelay));
+        serve(fd);
+    }
+}
+
+void Server::route(const std::shared_ptr<ServerConnection>& connection, const Frame& frame) {
+    const Route& route = routes_[frame.header.${layout.commandIdField.name}];
+    if (!route) {
+        connection->countDropped();
+        return;
+    }
+    route(connection, frame.header, frame.payload);
+}
+
+void Server::remove(ServerConnection* connection) {
+    const auto it = std::find_if(connections_.begin(), connections_.end(),
+        [connection](const std::shared_ptr<ServerConnection>& c) { return c.get() == connection; });
+    if (it == connections_.end()) return;
+
+    const TransportStats& stats = connection->stats();
+    closedStats_.framesIn += stats.framesIn;
+    closedStats_.framesOut += stats.framesOut;
+    closedStats_.writes += stats.writes;
+    closedStats_.corruptFrames += stats.corruptFrames;
+    closedStats_.droppedFrames += stats.droppedFrames;
+
+    // Called from the connection's own onIo(), so it is destroyed after this iteration
+    loop_.release(std::move(*it));
+    *it = std::move(connections_.back());
+    connections_.pop_back();
+}
+
+TransportStats Server::stats() const {
+    TransportStats total = closedStats_;
+    for (const std::shared_ptr<ServerConnection>& connection : connections_) {
+        const TransportStats& stats = connection->stats();
+        total.framesIn += stats.framesIn;
+        total.framesOut += stats.framesOut;
+        total.writes += stats.writes;
+        total.corruptFrames += stats.corruptFrames;
+        total.droppedFrames += stats.droppedFrames;
+    }
+    return total;
+}
+
+// ============================================
+// Sockets
+// ============================================
+
+int listenTcp(uint16_t port, const char* address) {
+    sockaddr_in addr{};
+    addr.sin_family = AF_INET;
+    addr.sin_port = htons(port);
+    if (::inet_pton(AF_INET, address, &addr.sin_addr) != 1) {
+        BINARY_PROTOCOL_THROW(std::invalid_argument("Invalid IPv4 address"));
+    }
+    const int fd = ::socket(AF_INET, SOCK_STREAM | SOCK_CLOEXEC, 0);
+    if (fd < 0) throwErrno("socket");
+    const int reuse = 1;
+    ::setsockopt(fd, SOL_SOCKET, SO_REUSEADDR, &reuse, sizeof(reuse));
+    if (::bind(fd, reinterpret_cast<const sockaddr*>(&addr), sizeof(addr)) < 0 || ::listen(fd, SOMAXCONN) < 0) {
+        const int error = errno;
+        ::close(fd);
+        errno = error;
+        throwErrno("bind/listen");
+    }
+    return fd;
+}
+
+int connectTcp(const char* address, uint16_t port) {
+    sockaddr_in addr{};
+    addr.sin_family = AF_INET;
+    addr.sin_port = htons(port);
+    if (::inet_pton(AF_INET, address, &addr.sin_addr) != 1) {
+        BINARY_PROTOCOL_THROW(std::invalid_argument("Invalid IPv4 address"));
+    }
+    const int fd = ::socket(AF_INET, SOCK_STREAM | SOCK_CLOEXEC, 0);
+    if (fd < 0) throwErrno("socket");
+    if (::connect(fd, reinterpret_cast<const sockaddr*>(&addr), sizeof(addr)) < 0) {
+        const int error = errno;
+        ::close(fd);
+        errno = error;
+        throwErrno("connect");
+    }
+    const int noDelay = 1;
+    ::setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &noDelay, sizeof(noDelay));
+    return fd;
+}
+
+uint16_t localPort(int fd) {
+    sockaddr_in addr{};
+    socklen_t length = sizeof(addr);
+    if (::getsockname(fd, reinterpret_cast<sockaddr*>(&addr), &length) < 0) throwErrno("getsockname");
+    return ntohs(addr.sin_port);
+}
+
+} // namespace ${ns}
+
+#endif // BINARY_PROTOCOL_HAS_EPOLL`;
+}
+
+/**
+ * トランスポートのテスト（DeviceSimulator と socketpair / TCP ループバック上の Client）
+ */
+export function generateTransportTest(ir: SchemaIR, layout: FrameHeaderLayout, ns: string): string {
+  const header = layout.model.name;
+  const pairs = findCommandPairs(ir);
+  const pairRuns = pairs.map(p => `    {"${p.command.name}", runConcurrent<${p.command.name}>},`).join('\n');
+
+  return `/**
+ * Auto-generated transport test
+ *
+ *     test_transport [--iterations N] [--seed S]
+ *
+ * Drives Client against DeviceSimulator over socketpairs and TCP loopback:
+ * concurrent calls of every command answered out of order, frames queued in
+ * one iteration leaving in one write, timeouts and late responses, peers that
+ * disconnect with calls pending, and connections that close or are removed
+ * from inside their own callbacks.
+ */
+
+#include "transport.hpp"
+#include "test_codec.hpp"
+
+#if BINARY_PROTOCOL_HAS_EPOLL
+
+#include <algorithm>
+#include <array>
+#include <chrono>
+#include <cinttypes>
+#include <coroutine>
+#include <cstdio>
+#include <cstdlib>
+#include <deque>
+#include <memory>
+#include <optional>
+#include <string_view>
+#include <vector>
+
+#include <sys/socket.h>
+
+using namespace ${ns};
+using namespace ${ns}::testing;
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+using std::chrono::milliseconds;
+
+/// Command of the tests that do not depend on the payload
+using Request = ${pairs[0].command.name};
+using Reply = ResponseOf<Request>::type;
+
+/// Longest a test waits for the loop before failing
+constexpr Clock::duration DEADLINE = std::chrono::seconds(10);
+
+/// Most calls spawned in one iteration
+constexpr size_t CONCURRENCY = 64;
+
+struct Options {
+    uint64_t iterations = 2000;
+    uint64_t seed = 1;
+};
+
+bool fail(const char* test, const char* check, const Options& options, uint64_t iteration) {
+    std::fprintf(stderr, "FAIL %s: %s (seed %" PRIu64 ", iteration %" PRIu64 ")\\n", test, check, options.seed, iteration);
+    return false;
+}
+
+/// Connected AF_UNIX stream sockets; each end is handed to a Connection, which closes it
+struct SocketPair {
+    int client = -1;
+    int server = -1;
+};
+
+std::optional<SocketPair> socketPair() {
+    std::array<int, 2> fds;
+    if (::socketpair(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0, fds.data()) < 0) return std::nullopt;
+    return SocketPair{fds[0], fds[1]};
+}
+
+/// Keeps runOnce() from blocking for longer than a tick while a test waits on it
+class Heartbeat : private detail::Ticker {
+public:
+    explicit Heartbeat(EventLoop& loop) : loop_(loop) { loop_.addTicker(this); }
+    ~Heartbeat() { loop_.removeTicker(this); }
+
+    Heartbeat(const Heartbeat&) = delete;
+    Heartbeat& operator=(const Heartbeat&) = delete;
+
+private:
+    bool ticking() const override { return true; }
+    void onTick(Clock::time_point) override {}
+
+    EventLoop& loop_;
+};
+
+/// Runs the loop until done() holds; false if DEADLINE passes first
+template<typename Done>
+bool runUntil(EventLoop& loop, Done done) {
+    Heartbeat heartbeat(loop);
+    const Clock::time_point deadline = Clock::now() + DEADLINE;
+    while (!done()) {
+        if (Clock::now() > deadline) return false;
+        loop.runOnce();
+    }
+    return true;
+}
+
+void runIterations(EventLoop& loop, int count) {
+    Heartbeat heartbeat(loop);
+    for (int i = 0; i < count; i++) {
+        loop.runOnce();
+    }
+}
+
+/// Resumes the awaiting coroutine on the loop's next iteration
+struct NextIteration {
+    EventLoop& loop;
+
+    bool await_ready() const noexcept { return false; }
+    void await_suspend(std::coroutine_handle<> handle) { loop.schedule(handle); }
+    void await_resume() const noexcept {}
+};
+
+/// Handler body that answers after delay iterations
+template<typename Response>
+Task<Response> later(EventLoop& loop, Response response, uint64_t delay) {
+    for (; delay > 0; delay--) {
+        co_await NextIteration{loop};
+    }
+    co_return std::move(response);
+}
+
+template<typename Response>
+using Outcome = std::optional<CallResult<Response>>;
+
+/// Stores the result of one call; touches nothing but outcome once the call completes
+template<typename Command>
+Task<void> callInto(Client& client, Command command, Outcome<typename ResponseOf<Command>::type>* outcome,
+                    std::optional<Clock::duration> timeout = std::nullopt) {
+    outcome->emplace(co_await client.call(std::move(command), timeout));
+}
+
+template<typename Response>
+bool allDone(const std::vector<Outcome<Response>>& outcomes) {
+    return std::ranges::all_of(outcomes, [](const Outcome<Response>& outcome) { return outcome.has_value(); });
+}
+
+template<typename Response>
+bool allFailedWith(const std::vector<Outcome<Response>>& outcomes, CallError error) {
+    return std::ranges::all_of(outcomes, [error](const Outcome<Response>& outcome) {
+        return outcome && !*outcome && outcome->error() == error;
+    });
+}
+
+/// A random value whose frame a default FrameDecoder accepts
+template<typename T>
+T randomFitting(Random& rng) {
+    while (true) {
+        T value = CodecTraits<T>::random(rng);
+        if (encodedSize(value) <= FrameDecoder::DEFAULT_MAX_PAYLOAD) return value;
+    }
+}
+
+/// Peer that records the headers it receives and answers only when told to
+class RawPeer : public Connection {
+public:
+    using Connection::Connection;
+
+    std::vector<${header}> received;
+    /// Closes the connection from inside the first onFrame()
+    bool closeOnFrame = false;
+
+protected:
+    void onFrame(const Frame& frame) override {
+        received.push_back(frame.header);
+        if (closeOnFrame) close();
+    }
+};
+
+/// Rounds of concurrent calls on one connection, answered after random delays so responses overtake each other
+template<typename Command>
+bool runConcurrent(const char* name, const Options& options) {
+    using Response = typename ResponseOf<Command>::type;
+    struct Step {
+        Command command;
+        Response response;
+        uint64_t delay;
+    };
+
+    Random rng(options.seed);
+    const std::optional<SocketPair> sockets = socketPair();
+    if (!sockets) return fail(name, "socketpair failed", options, 0);
+    EventLoop loop;
+    DeviceSimulator simulator(loop);
+    std::deque<Step> plan;
+    uint64_t wrongCommands = 0;
+    simulator.on<Command>([&loop, &plan, &wrongCommands](const Command& command) {
+        Step step = std::move(plan.front());
+        plan.pop_front();
+        if (!(command == step.command)) wrongCommands++;
+        return later(loop, std::move(step.response), step.delay);
+    });
+    simulator.serve(sockets->server);
+    Client client(loop, sockets->client);
+
+    std::vector<Response> expected;
+    std::vector<Outcome<Response>> outcomes;
+    uint64_t calls = 0;
+    for (uint64_t round = 0; calls < options.iterations; round++) {
+        const size_t count = 1 + rng.below(CONCURRENCY);
+        expected.clear();
+        outcomes.assign(count, std::nullopt);
+        for (size_t i = 0; i < count; i++) {
+            Command command = randomFitting<Command>(rng);
+            expected.push_back(randomFitting<Response>(rng));
+            plan.push_back({command, expected.back(), rng.below(8)});
+            spawn(callInto(client, std::move(command), &outcomes[i]));
+        }
+        if (client.inFlight() != count) return fail(name, "inFlight() != calls spawned", options, round);
+        if (!runUntil(loop, [&outcomes] { return allDone(outcomes); })) return fail(name, "calls did not complete", options, round);
+
+        for (size_t i = 0; i < count; i++) {
+            const CallResult<Response>& result = *outcomes[i];
+            if (!result) return fail(name, toString(result.error()), options, round);
+            if (!(*result == expected[i])) return fail(name, "response of another call", options, round);
+        }
+        if (wrongCommands != 0) return fail(name, "server decoded a different command", options, round);
+        if (!plan.empty()) return fail(name, "server did not handle every call", options, round);
+        calls += count;
+    }
+
+    const TransportStats stats = client.stats();
+    if (client.inFlight() != 0) return fail(name, "calls left in flight", options, 0);
+    if (stats.framesOut != calls || stats.framesIn != calls) return fail(name, "client frame counts", options, 0);
+    if (stats.writes > stats.framesOut) return fail(name, "more writes than frames", options, 0);
+    if (stats.corruptFrames != 0 || stats.droppedFrames != 0) return fail(name, "client dropped frames", options, 0);
+    if (client.correlation().matched != calls) return fail(name, "correlation().matched != calls", options, 0);
+    const TransportStats served = simulator.stats();
+    if (served.framesIn != calls || served.framesOut != calls) return fail(name, "server frame counts", options, 0);
+    if (served.corruptFrames != 0 || served.droppedFrames != 0) return fail(name, "server dropped frames", options, 0);
+    return true;
+}
+
+struct PairRun {
+    const char* name;
+    bool (*run)(const char* name, const Options& options);
+};
+
+constexpr PairRun PAIRS[] = {
+${pairRuns}
+};
+
+/// Frames queued in one iteration leave in one write, and the server answers them with one write
+bool runBatching(const Options& options) {
+    Random rng(options.seed);
+    const std::optional<SocketPair> sockets = socketPair();
+    if (!sockets) return fail("batching", "socketpair failed", options, 0);
+    EventLoop loop;
+    DeviceSimulator simulator(loop);
+    simulator.serve(sockets->server);
+    Client client(loop, sockets->client);
+
+    std::vector<Outcome<Reply>> outcomes;
+    for (uint64_t round = 0; round < std::max<uint64_t>(1, options.iterations / 100); round++) {
+        const size_t count = 2 + rng.below(CONCURRENCY);
+        const TransportStats sent = client.stats();
+        const TransportStats answered = simulator.stats();
+        outcomes.assign(count, std::nullopt);
+        for (size_t i = 0; i < count; i++) {
+            spawn(callInto(client, Request{}, &outcomes[i]));
+        }
+        if (!runUntil(loop, [&outcomes] { return allDone(outcomes); })) return fail("batching", "calls did not complete", options, round);
+
+        for (const Outcome<Reply>& outcome : outcomes) {
+            if (!*outcome) return fail("batching", toString(outcome->error()), options, round);
+            if (!(**outcome == Reply{})) return fail("batching", "DeviceSimulator answered a non-default response", options, round);
+        }
+        if (client.stats().framesOut - sent.framesOut != count) return fail("batching", "client frame count", options, round);
+        if (client.stats().writes - sent.writes != 1) return fail("batching", "client requests took more than one write", options, round);
+        if (simulator.stats().framesOut - answered.framesOut != count) return fail("batching", "server frame count", options, round);
+        if (simulator.stats().writes - answered.writes != 1) return fail("batching", "server responses took more than one write", options, round);
+    }
+    return true;
+}
+
+/// Several clients of one listening server; closing them removes their server connections
+bool runTcp(const Options& options) {
+    constexpr size_t CLIENTS = 4;
+    Random rng(options.seed);
+    EventLoop loop;
+    DeviceSimulator simulator(loop);
+    const int listenFd = listenTcp(0);
+    simulator.listen(listenFd);
+
+    std::vector<std::unique_ptr<Client>> clients;
+    for (size_t i = 0; i < CLIENTS; i++) {
+        clients.push_back(std::make_unique<Client>(loop, connectTcp("127.0.0.1", localPort(listenFd))));
+    }
+    std::vector<Outcome<Reply>> outcomes(CLIENTS * 8);
+    for (size_t i = 0; i < outcomes.size(); i++) {
+        spawn(callInto(*clients[rng.below(CLIENTS)], Request{}, &outcomes[i]));
+    }
+    if (!runUntil(loop, [&outcomes] { return allDone(outcomes); })) return fail("tcp", "calls did not complete", options, 0);
+    for (const Outcome<Reply>& outcome : outcomes) {
+        if (!*outcome) return fail("tcp", toString(outcome->error()), options, 0);
+    }
+    if (simulator.connections() != CLIENTS) return fail("tcp", "server did not accept every client", options, 0);
+
+    clients.clear();
+    if (!runUntil(loop, [&simulator] { return simulator.connections() == 0; })) {
+        return fail("tcp", "server kept closed connections", options, 0);
+    }
+    // Counters of removed connections are kept
+    if (simulator.stats().framesIn != outcomes.size()) return fail("tcp", "server lost the stats of closed connections", options, 0);
+    return true;
+}
+
+/// Calls time out after their own or the client's timeout, and responses arriving later are dropped
+bool runTimeout(const Options& options) {
+    const std::optional<SocketPair> sockets = socketPair();
+    if (!sockets) return fail("timeout", "socketpair failed", options, 0);
+    EventLoop loop;
+    RawPeer peer(loop, sockets->server);
+    ClientOptions clientOptions;
+    clientOptions.timeout = milliseconds(20);
+    Client client(loop, sockets->client, clientOptions);
+
+    Outcome<Reply> defaulted;
+    Outcome<Reply> shorter;
+    Outcome<Reply> answered;
+    const Clock::time_point start = Clock::now();
+    spawn(callInto(client, Request{}, &defaulted));
+    spawn(callInto(client, Request{}, &shorter, milliseconds(5)));
+    spawn(callInto(client, Request{}, &answered, std::chrono::seconds(5)));
+    if (!runUntil(loop, [&peer] { return peer.received.size() == 3; })) return fail("timeout", "requests not received", options, 0);
+    peer.send(peer.received[2], Reply{});
+
+    if (!runUntil(loop, [&defaulted] { return defaulted.has_value(); })) return fail("timeout", "call never timed out", options, 0);
+    // Deadlines count whole Correlator ticks (1 ms) from the tick the call started in
+    if (Clock::now() - start < clientOptions.timeout - milliseconds(1)) return fail("timeout", "call timed out before ClientOptions::timeout", options, 0);
+    if (!runUntil(loop, [&] { return shorter && answered; })) return fail("timeout", "calls did not complete", options, 0);
+    if (*defaulted || defaulted->error() != CallError::Timeout) return fail("timeout", "default timeout did not fail with Timeout", options, 0);
+    if (*shorter || shorter->error() != CallError::Timeout) return fail("timeout", "per-call timeout did not fail with Timeout", options, 0);
+    if (!*answered) return fail("timeout", "answered call failed", options, 0);
+    if (client.correlation().timedOut != 2) return fail("timeout", "correlation().timedOut != 2", options, 0);
+
+    peer.send(peer.received[0], Reply{});
+    peer.send(peer.received[1], Reply{});
+    if (!runUntil(loop, [&client] { return client.stats().framesIn == 3; })) return fail("timeout", "late responses not received", options, 0);
+    if (client.stats().droppedFrames != 2) return fail("timeout", "late responses were not dropped", options, 0);
+    if (client.inFlight() != 0) return fail("timeout", "calls left in flight", options, 0);
+    return true;
+}
+
+/// Pending calls fail with Disconnected when the peer closes or the client is destroyed
+bool runDisconnect(const Options& options) {
+    constexpr size_t CALLS = 8;
+    {
+        const std::optional<SocketPair> sockets = socketPair();
+        if (!sockets) return fail("disconnect", "socketpair failed", options, 0);
+        EventLoop loop;
+        RawPeer peer(loop, sockets->server);
+        Client client(loop, sockets->client);
+        std::vector<Outcome<Reply>> outcomes(CALLS);
+        for (Outcome<Reply>& outcome : outcomes) {
+            spawn(callInto(client, Request{}, &outcome));
+        }
+        if (!runUntil(loop, [&peer] { return peer.received.size() == CALLS; })) return fail("disconnect", "requests not received", options, 0);
+        peer.close();
+
+        if (!runUntil(loop, [&outcomes] { return allDone(outcomes); })) return fail("disconnect", "calls did not complete", options, 0);
+        if (!allFailedWith(outcomes, CallError::Disconnected)) return fail("disconnect", "peer close did not fail calls with Disconnected", options, 0);
+        if (!client.closed() || client.inFlight() != 0) return fail("disconnect", "client still open", options, 0);
+        const CallResult<Reply> after = loop.run(client.call(Request{}));
+        if (after || after.error() != CallError::Disconnected) return fail("disconnect", "call on a closed client did not fail", options, 0);
+    }
+    {
+        const std::optional<SocketPair> sockets = socketPair();
+        if (!sockets) return fail("disconnect", "socketpair failed", options, 1);
+        EventLoop loop;
+        RawPeer peer(loop, sockets->server);
+        auto client = std::make_unique<Client>(loop, sockets->client);
+        std::vector<Outcome<Reply>> outcomes(CALLS);
+        for (Outcome<Reply>& outcome : outcomes) {
+            spawn(callInto(*client, Request{}, &outcome));
+        }
+        if (!runUntil(loop, [&peer] { return peer.received.size() == CALLS; })) return fail("disconnect", "requests not received", options, 1);
+        client.reset();
+
+        if (!runUntil(loop, [&outcomes] { return allDone(outcomes); })) return fail("disconnect", "calls did not complete", options, 1);
+        if (!allFailedWith(outcomes, CallError::Disconnected)) return fail("disconnect", "~Client did not fail calls with Disconnected", options, 1);
+        if (!runUntil(loop, [&peer] { return peer.closed(); })) return fail("disconnect", "peer did not see the close", options, 1);
+    }
+    return true;
+}
+
+/// Connections closed or removed from inside their own callbacks, with handlers still running
+bool runLifecycle(const Options& options) {
+    // close() in onFrame() drops the rest of the frames from the same read
+    {
+        const std::optional<SocketPair> sockets = socketPair();
+        if (!sockets) return fail("lifecycle", "socketpair failed", options, 0);
+        EventLoop loop;
+        RawPeer peer(loop, sockets->server);
+        peer.closeOnFrame = true;
+        Client client(loop, sockets->client);
+        std::vector<Outcome<Reply>> outcomes(3);
+        for (Outcome<Reply>& outcome : outcomes) {
+            spawn(callInto(client, Request{}, &outcome));
+        }
+        if (!runUntil(loop, [&outcomes] { return allDone(outcomes); })) return fail("lifecycle", "calls did not complete", options, 0);
+        if (peer.received.size() != 1) return fail("lifecycle", "onFrame() ran after close()", options, 0);
+        if (!allFailedWith(outcomes, CallError::Disconnected)) return fail("lifecycle", "calls did not fail with Disconnected", options, 0);
+    }
+    // The client leaves while its handler runs: the server connection removes itself from its own onIo()
+    {
+        const std::optional<SocketPair> sockets = socketPair();
+        if (!sockets) return fail("lifecycle", "socketpair failed", options, 1);
+        EventLoop loop;
+        DeviceSimulator simulator(loop);
+        simulator.on<Request>([&loop](const Request&) { return later(loop, Reply{}, 4); });
+        simulator.serve(sockets->server);
+        auto client = std::make_unique<Client>(loop, sockets->client);
+        Outcome<Reply> outcome;
+        spawn(callInto(*client, Request{}, &outcome));
+        if (!runUntil(loop, [&simulator] { return simulator.stats().framesIn == 1; })) return fail("lifecycle", "request not received", options, 1);
+        client.reset();
+
+        if (!runUntil(loop, [&simulator] { return simulator.connections() == 0; })) return fail("lifecycle", "server kept a closed connection", options, 1);
+        runIterations(loop, 8);
+        if (!outcome || *outcome || outcome->error() != CallError::Disconnected) return fail("lifecycle", "call did not fail with Disconnected", options, 1);
+        if (simulator.stats().framesOut != 0) return fail("lifecycle", "response sent on a closed connection", options, 1);
+    }
+    // The server is destroyed while a handler runs; the handler finishes on a detached connection
+    {
+        const std::optional<SocketPair> sockets = socketPair();
+        if (!sockets) return fail("lifecycle", "socketpair failed", options, 2);
+        EventLoop loop;
+        auto simulator = std::make_unique<DeviceSimulator>(loop);
+        simulator->on<Request>([&loop](const Request&) { return later(loop, Reply{}, 4); });
+        simulator->serve(sockets->server);
+        Client client(loop, sockets->client);
+        Outcome<Reply> outcome;
+        spawn(callInto(client, Request{}, &outcome));
+        if (!runUntil(loop, [&simulator] { return simulator->stats().framesIn == 1; })) return fail("lifecycle", "request not received", options, 2);
+        simulator.reset();
+
+        if (!runUntil(loop, [&outcome] { return outcome.has_value(); })) return fail("lifecycle", "call did not complete", options, 2);
+        runIterations(loop, 8);
+        if (*outcome || outcome->error() != CallError::Disconnected) return fail("lifecycle", "call did not fail with Disconnected", options, 2);
+    }
+    return true;
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    Options options;
+    for (int i = 1; i < argc; i++) {
+        const std::string_view arg = argv[i];
+        if (arg == "--iterations" && i + 1 < argc) {
+            options.iterations = std::strtoull(argv[++i], nullptr, 10);
+        } else if (arg == "--seed" && i + 1 < argc) {
+            options.seed = std::strtoull(argv[++i], nullptr, 10);
+        } else {
+            std::fprintf(stderr, "usage: %s [--iterations N] [--seed S]\\n", argv[0]);
+            return 2;
+        }
+    }
+
+    bool ok = true;
+    for (const PairRun& pair : PAIRS) {
+        ok = pair.run(pair.name, options) && ok;
+    }
+    ok = runBatching(options) && ok;
+    ok = runTcp(options) && ok;
+    ok = runTimeout(options) && ok;
+    ok = runDisconnect(options) && ok;
+    ok = runLifecycle(options) && ok;
+    return ok ? 0 : 1;
+}
+
+#else
+
+int main() {
+    // The transport needs epoll
+    return 0;
+}
+
+#endif // BINARY_PROTOCOL_HAS_EPOLL
+`;
+}
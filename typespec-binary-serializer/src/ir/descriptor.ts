@@ -0,0 +1,149 @@
+/**
+ * IR のバイナリ記述子（スキーマ記述子）エンコーダー
+ * 実行時にスキーマを読み込む汎用コーデック向けに、列挙型・モデル・フィールドの
+ * 型、サイズ、オフセット、長さプレフィックス幅、コマンドIDを詰めて出力する
+ *
+ * 形式（整数はすべてリトルエンディアン、文字列は u8 長 + UTF-8）:
+ *   header : "TBSD" u8 version u8 endian(0=little,1=big) u16 enumCount u16 modelCount
+ *   enum   : str name, u8 baseType, u16 memberCount, { str name, u64 value }*
+ *   model  : str name, u8 flags(bit0=command, bit1=big endian, bit2=最後のフィールドが @batch), u8 commandId,
+ *            u32 fixedSize(0xFFFFFFFF=可変長), u16 fieldCount, field*
+ *   field  : str name, u8 kind, u8 element, u8 type, u16 ref, u32 fixedSize, u8 prefix, u32 offset
+ *            kind: 0=primitive 1=enum 2=model 3=array
+ *            element: 配列の要素の kind（配列以外は 0xFF）
+ *            type: プリミティブ型コード（配列は要素型、なければ 0xFF）
+ *            ref : 列挙型/モデルのインデックス（配列は要素型、なければ 0xFFFF）
+ *            prefix: 長さプレフィックスの型コード（なければ 0xFF）
+ *            offset: 先頭からのワイヤオフセット（可変長フィールドより後は 0xFFFFFFFF）
+ */
+
+import { SchemaIR, FieldDefinition, PrimitiveType, TypeInfo } from './types.js';
+
+export const DESCRIPTOR_MAGIC = 'TBSD';
+export const DESCRIPTOR_VERSION = 1;
+
+/** 記述子内のプリミティブ型コード（配列の添字） */
+export const DESCRIPTOR_PRIMITIVES: PrimitiveType[] = [
+  'uint8', 'uint16', 'uint32', 'uint64',
+  'int8', 'int16', 'int32', 'int64',
+  'float32', 'float64', 'bool', 'string', 'bytes',
+];
+
+const FIELD_KINDS: Record<TypeInfo['kind'], number> = {
+  primitive: 0,
+  enum: 1,
+  model: 2,
+  array: 3,
+};
+
+const NONE_8 = 0xff;
+const NONE_16 = 0xffff;
+const NONE_32 = 0xffffffff;
+
+class ByteWriter {
+  private bytes: number[] = [];
+
+  u8(value: number): void {
+    this.bytes.push(value & 0xff);
+  }
+
+  u16(value: number): void {
+    this.u8(value);
+    this.u8(value >>> 8);
+  }
+
+  u32(value: number): void {
+    this.u16(value & 0xffff);
+    this.u16(Math.floor(value / 0x10000) & 0xffff);
+  }
+
+  u64(value: number): void {
+    const big = BigInt.asUintN(64, BigInt(value));
+    for (let i = 0n; i < 8n; i++) {
+      this.u8(Number((big >> (8n * i)) & 0xffn));
+    }
+  }
+
+  str(value: string): void {
+    const encoded = new TextEncoder().encode(value);
+    if (encoded.length > 255) {
+      throw new Error(`Name too long for schema descriptor: ${value}`);
+    }
+    this.u8(encoded.length);
+    encoded.forEach(byte => this.u8(byte));
+  }
+
+  result(): Uint8Array {
+    return Uint8Array.from(this.bytes);
+  }
+}
+
+/**
+ * スキーマ IR をバイナリ記述子にエンコード
+ */
+export function encodeSchemaDescriptor(ir: SchemaIR): Uint8Array {
+  const writer = new ByteWriter();
+  const enumIndex = new Map(ir.enums.map((e, i) => [e.name, i]));
+  const modelIndex = new Map(ir.models.map((m, i) => [m.name, i]));
+
+  for (const char of DESCRIPTOR_MAGIC) writer.u8(char.charCodeAt(0));
+  writer.u8(DESCRIPTOR_VERSION);
+  writer.u8(ir.endian === 'big' ? 1 : 0);
+  writer.u16(ir.enums.length);
+  writer.u16(ir.models.length);
+
+  for (const enumDef of ir.enums) {
+    writer.str(enumDef.name);
+    writer.u8(primitiveCode(enumDef.baseType));
+    writer.u16(enumDef.members.length);
+    for (const member of enumDef.members) {
+      writer.str(member.name);
+      writer.u64(member.value);
+    }
+  }
+
+  for (const model of ir.models) {
+    writer.str(model.name);
+    const batch = model.fields.at(-1)?.decorators.some(d => d.name === 'batch') ?? false;
+    writer.u8((model.commandId !== undefined ? 1 : 0) | (model.endian === 'big' ? 2 : 0) | (batch ? 4 : 0));
+    writer.u8(model.commandId ?? 0);
+    writer.u32(model.fixedSize ?? NONE_32);
+    writer.u16(model.fields.length);
+
+    // IR は列挙型の参照も kind: 'model' で表すため、名前で種別を決める
+    const kindOf = (type: TypeInfo): number =>
+      isPrimitive(type.name) ? FIELD_KINDS.primitive : enumIndex.has(type.name) ? FIELD_KINDS.enum : FIELD_KINDS.model;
+
+    let variableSeen = false;
+    for (const field of model.fields) {
+      const type = field.type.kind === 'array' ? field.type.elementType : field.type;
+      writer.str(field.name);
+      const kind = type && kindOf(type);
+      writer.u8(field.type.kind === 'array' ? FIELD_KINDS.array : kind ?? NONE_8);
+      writer.u8(field.type.kind === 'array' ? kind ?? NONE_8 : NONE_8);
+      writer.u8(type && isPrimitive(type.name) ? primitiveCode(type.name) : NONE_8);
+      const ref = kind === FIELD_KINDS.enum ? enumIndex.get(type!.name) : kind === FIELD_KINDS.model ? modelIndex.get(type!.name) : undefined;
+      writer.u16(ref ?? NONE_16);
+      writer.u32(field.size.lengthPrefixType ? 0 : field.size.fixedSize ?? 0);
+      writer.u8(field.size.lengthPrefixType ? primitiveCode(field.size.lengthPrefixType) : NONE_8);
+      writer.u32(variableSeen || field.offset === undefined ? NONE_32 : field.offset);
+      variableSeen ||= isVariable(field);
+    }
+  }
+
+  return writer.result();
+}
+
+function isVariable(field: FieldDefinition): boolean {
+  return field.size.lengthPrefixType !== undefined || field.size.fixedSize === undefined;
+}
+
+function isPrimitive(name: string): name is PrimitiveType {
+  return (DESCRIPTOR_PRIMITIVES as string[]).includes(name);
+}
+
+function primitiveCode(type: PrimitiveType): number {
+  const code = DESCRIPTOR_PRIMITIVES.indexOf(type);
+  if (code < 0) throw new Error(`Unknown primitive type: ${type}`);
+  return code;
+}
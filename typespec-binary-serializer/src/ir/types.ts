@@ -22,6 +22,24 @@ export type PrimitiveType =
   | 'string'
   | 'bytes';
 
+/**
+ * ワイヤ上のバイトオーダー
+ */
+export type ByteOrder = 'little' | 'big';
+
+/**
+ * フレームチェックサムのアルゴリズム
+ */
+export type ChecksumAlgorithm = 'crc16_ccitt' | 'crc32c';
+
+/**
+ * チェックサムアルゴリズムの出力幅（バイト数）
+ */
+export const CHECKSUM_SIZES: Record<ChecksumAlgorithm, number> = {
+  crc16_ccitt: 2,
+  crc32c: 4,
+};
+
 /**
  * 型情報
  */
@@ -116,6 +134,8 @@ export interface ModelDefinition {
   fixedSize?: number;
   /** 可変長フィールドを含むか */
   hasVariableLength: boolean;
+  /** バイトオーダー（@endian、未指定時はプロトコル既定値） */
+  endian: ByteOrder;
 }
 
 /**
@@ -140,6 +160,8 @@ export interface SchemaIR {
   enums: EnumDefinition[];
   /** モデル定義 */
   models: ModelDefinition[];
+  /** プロトコル既定のバイトオーダー（namespace の @endian） */
+  endian: ByteOrder;
   /** メタ情報 */
   metadata: SchemaMetadata;
 }
@@ -196,6 +218,35 @@ export function isFixedSizeField(field: FieldDefinition): boolean {
   return field.size.fixedSize !== undefined && field.size.lengthPrefixType === undefined;
 }
 
+/**
+ * @endian デコレータからバイトオーダーを取得
+ */
+export function getEndianDecorator(decorators: Decorator[]): ByteOrder | undefined {
+  const value = getDecoratorValue<string | undefined>(decorators, 'endian', undefined);
+  if (value === undefined) return undefined;
+  switch (value.toLowerCase()) {
+    case 'little':
+      return 'little';
+    case 'big':
+      return 'big';
+    default:
+      throw new Error(`Invalid @endian value: ${value}`);
+  }
+}
+
+/**
+ * @checksum デコレータからアルゴリズムを取得
+ */
+export function getChecksumDecorator(decorators: Decorator[]): ChecksumAlgorithm | undefined {
+  const value = getDecoratorValue<string | undefined>(decorators, 'checksum', undefined);
+  if (value === undefined) return undefined;
+  const algorithm = value.toLowerCase();
+  if (!(algorithm in CHECKSUM_SIZES)) {
+    throw new Error(`Invalid @checksum value: ${value}`);
+  }
+  return algorithm as ChecksumAlgorithm;
+}
+
 /**
  * デコレータから特定の値を取得
  */
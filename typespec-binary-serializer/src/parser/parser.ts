@@ -14,6 +14,7 @@ import {
   SizeInfo,
   PrimitiveType,
   isPrimitiveType,
+  getEndianDecorator,
   PRIMITIVE_SIZES,
 } from '../ir/types.js';
 
@@ -31,6 +32,7 @@ export class Parser {
       namespace: '',
       enums: [],
       models: [],
+      endian: 'little',
       metadata: {
         sourceFile,
         parsedAt: new Date().toISOString(),
@@ -41,6 +43,11 @@ export class Parser {
       this.parseTopLevel(ir);
     }
 
+    // モデル単位のバイトオーダーを解決
+    for (const model of ir.models) {
+      model.endian = getEndianDecorator(model.decorators) ?? ir.endian;
+    }
+
     // モデルのサイズを計算
     this.calculateModelSizes(ir);
 
@@ -104,6 +111,7 @@ export class Parser {
     // 名前空間
     if (this.check(TokenType.Namespace)) {
       ir.namespace = this.parseNamespace();
+      ir.endian = getEndianDecorator(decorators) ?? ir.endian;
       return;
     }
 
@@ -272,6 +280,7 @@ export class Parser {
       decorators,
       commandId,
       hasVariableLength: false, // 後で計算
+      endian: 'little',         // 後で解決
     };
   }
 